@@ -4,12 +4,18 @@
  */
 
 #include <olib.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
+#include <windows.h>
 #define strcasecmp _stricmp
+#else
+#include <pthread.h>
+#include <strings.h>
+#include <unistd.h>
 #endif
 
 static const char *format_names[] = {
@@ -17,9 +23,9 @@ static const char *format_names[] = {
     "json-binary",
     "yaml",
     "xml",
+    "binary",
     "toml",
-    "txt",
-    "binary"
+    "txt"
 };
 
 static const char *format_extensions[] = {
@@ -27,17 +33,25 @@ static const char *format_extensions[] = {
     ".jsonb",
     ".yaml",
     ".xml",
+    ".bin",
     ".toml",
-    ".txt",
-    ".bin"
+    ".txt"
 };
 
 static void print_usage(const char *program_name) {
     printf("olib-convert - Convert between serialization formats\n\n");
-    printf("Usage: %s [options] <input-file> <output-file>\n\n", program_name);
+    printf("Usage: %s [options] <input-file> <output-file>\n", program_name);
+    printf("       %s --merge [options] <input-file>... <output-file>\n\n", program_name);
     printf("Options:\n");
     printf("  -i, --input-format <format>   Input format (auto-detected from extension if not specified)\n");
     printf("  -o, --output-format <format>  Output format (auto-detected from extension if not specified)\n");
+    printf("      --perf                    Report timing and hardware counters for the parse and serialize phases\n");
+    printf("      --split <count>           Write a top-level list into <count> shards named <output>.<n><ext>\n");
+    printf("      --max-bytes <size>        Write a top-level list into shards of about <size> bytes (K, M, G suffixes)\n");
+    printf("      --merge                   Merge every input into one list written to the last file\n");
+    printf("      --emit-c <name>           Write C source embedding the input as static data, returned by <name>()\n");
+    printf("      --size-report             Convert and rank the key paths by the bytes they take in the output\n");
+    printf("      --top <count>             Rows of the size report (default 20, 0 for every path)\n");
     printf("  -h, --help                    Show this help message\n");
     printf("  -v, --version                 Show version information\n\n");
     printf("Supported formats:\n");
@@ -52,6 +66,10 @@ static void print_usage(const char *program_name) {
     printf("  %s data.json data.yaml\n", program_name);
     printf("  %s -i json -o xml input.txt output.txt\n", program_name);
     printf("  %s config.toml config.json\n", program_name);
+    printf("  %s --split 8 events.bin events.json\n", program_name);
+    printf("  %s --merge events.0.bin events.1.bin events.bin\n", program_name);
+    printf("  %s --emit-c default_config defaults.json defaults.c\n", program_name);
+    printf("  %s --size-report --top 10 events.json events.yaml\n", program_name);
 }
 
 static void print_version(void) {
@@ -110,11 +128,502 @@ static const char *format_to_string(olib_format_t format) {
     return "unknown";
 }
 
-int main(int argc, char *argv[]) {
-    const char *input_file = NULL;
-    const char *output_file = NULL;
+static bool read_file_data(const char *path, uint8_t **out_data, size_t *out_size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(file);
+        return false;
+    }
+    uint8_t *data = malloc((size_t)size);
+    if (data == NULL || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    *out_data = data;
+    *out_size = (size_t)size;
+    return true;
+}
+
+static void print_perf_result(const char *phase, const olib_perf_result_t *result) {
+    printf("%s: %zu bytes, %zu nodes, %.3f ms\n", phase, result->bytes, result->nodes, result->wall_ns / 1e6);
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        const char *name = olib_perf_counter_to_string((olib_perf_counter_t)i);
+        if (!result->available[i]) {
+            printf("  %-14s unavailable\n", name);
+            continue;
+        }
+        printf("  %-14s %14llu  %10.3f/byte  %10.3f/node\n", name,
+               (unsigned long long)result->counts[i], result->per_byte[i], result->per_node[i]);
+    }
+}
+
+// Convert through the measured phase helpers instead of olib_convert_file_path
+static bool convert_with_perf(olib_format_t input_format, const char *input_file,
+                              olib_format_t output_format, const char *output_file) {
+    uint8_t *input = NULL;
+    size_t input_size = 0;
+    if (!read_file_data(input_file, &input, &input_size)) {
+        return false;
+    }
+
+    olib_perf_t *perf = olib_perf_new();
+    olib_perf_result_t parse_result;
+    olib_perf_result_t serialize_result;
+    uint8_t *output = NULL;
+    size_t output_size = 0;
+
+    olib_object_t *obj = perf ? olib_perf_read(perf, input_format, input, input_size, &parse_result) : NULL;
+    bool success = obj != NULL &&
+                   olib_perf_write(perf, output_format, obj, &output, &output_size, &serialize_result);
+
+    if (success) {
+        FILE *file = fopen(output_file, "wb");
+        success = file != NULL && fwrite(output, 1, output_size, file) == output_size;
+        if (file != NULL) {
+            success = fclose(file) == 0 && success;
+        }
+    }
+    if (success) {
+        print_perf_result("parse", &parse_result);
+        print_perf_result("serialize", &serialize_result);
+    }
+
+    olib_free(output);
+    olib_object_free(obj);
+    olib_perf_free(perf);
+    free(input);
+    return success;
+}
+
+// Write the input as C source defining a frozen tree
+static bool emit_c_file(olib_format_t input_format, const char *input_file, const char *name,
+                        const char *output_file) {
+    olib_object_t *obj = olib_format_read_file_path(input_format, input_file);
+    char *source = NULL;
+    bool success = obj != NULL && olib_frozen_emit_c(obj, name, &source);
+    if (success) {
+        FILE *file = fopen(output_file, "wb");
+        success = file != NULL && fputs(source, file) >= 0;
+        if (file != NULL) {
+            success = fclose(file) == 0 && success;
+        }
+    }
+    olib_free(source);
+    olib_object_free(obj);
+    return success;
+}
+
+// Convert, then print how the output's bytes split over the key paths
+static bool convert_with_size_report(olib_format_t input_format, const char *input_file,
+                                     olib_format_t output_format, const char *output_file, size_t top) {
+    olib_object_t *obj = olib_format_read_file_path(input_format, input_file);
+    olib_serializer_t *serializer = olib_format_serializer(output_format);
+    bool success = obj != NULL && serializer != NULL;
+    if (success) {
+        olib_size_report_t *report = olib_size_report_new(serializer, obj);
+        success = report != NULL && olib_size_report_print(report, stdout, top);
+        olib_size_report_free(report);
+    }
+    if (success) {
+        success = olib_serializer_write_file_path(serializer, obj, output_file);
+    }
+    olib_serializer_free(serializer);
+    olib_object_free(obj);
+    return success;
+}
+
+// #############################################################################
+// Splitting and merging
+// #############################################################################
+
+// Parse a byte count with an optional K, M or G suffix (powers of 1024)
+static bool parse_size(const char *str, size_t *out_size) {
+    char *end = NULL;
+    unsigned long long value = strtoull(str, &end, 10);
+    if (end == str || str[0] == '-') {
+        return false;
+    }
+    unsigned long long scale = 1;
+    if (*end == 'K' || *end == 'k') {
+        scale = 1024ULL;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        scale = 1024ULL * 1024ULL;
+        end++;
+    } else if (*end == 'G' || *end == 'g') {
+        scale = 1024ULL * 1024ULL * 1024ULL;
+        end++;
+    }
+    if (*end != '\0' || value == 0 || value > (unsigned long long)SIZE_MAX / scale) {
+        return false;
+    }
+    *out_size = (size_t)(value * scale);
+    return true;
+}
+
+// Build "<stem>.<index><ext>" with the index zero-padded to the width of the last shard
+static char *make_shard_path(const char *path, size_t index, size_t count) {
+    const char *dot = strrchr(path, '.');
+    const char *slash = strrchr(path, '/');
+    const char *backslash = strrchr(path, '\\');
+    if (backslash != NULL && (slash == NULL || backslash > slash)) {
+        slash = backslash;
+    }
+    if (dot == NULL || (slash != NULL && dot < slash)) {
+        dot = path + strlen(path);
+    }
+
+    // Digits of the last index, a size_t has at most 20
+    int width = 1;
+    for (size_t last = count > 0 ? count - 1 : 0; last >= 10 && width < 20; last /= 10) {
+        width++;
+    }
+
+    size_t stem_len = (size_t)(dot - path);
+    size_t path_size = strlen(path) + 32;
+    if (stem_len > INT_MAX) {
+        return NULL;
+    }
+    char *shard_path = malloc(path_size);
+    if (shard_path == NULL) {
+        return NULL;
+    }
+    int written = snprintf(shard_path, path_size, "%.*s.%0*zu%s", (int)stem_len, path, width, index, dot);
+    if (written < 0 || (size_t)written >= path_size) {
+        free(shard_path);
+        return NULL;
+    }
+    return shard_path;
+}
+
+// Binary encoded size of a value, used as a format independent weight for sharding
+static size_t estimate_size(olib_object_t *obj) {
+    switch (olib_object_get_type(obj)) {
+        case OLIB_OBJECT_TYPE_INT:
+        case OLIB_OBJECT_TYPE_UINT:
+        case OLIB_OBJECT_TYPE_FLOAT:
+            return 9;
+        case OLIB_OBJECT_TYPE_BOOL:
+            return 2;
+        case OLIB_OBJECT_TYPE_STRING: {
+            const char *str = olib_object_get_string(obj);
+            return 5 + (str != NULL ? strlen(str) : 0);
+        }
+        case OLIB_OBJECT_TYPE_LIST: {
+            size_t size = 5;
+            for (size_t i = 0; i < olib_object_list_size(obj); i++) {
+                size += estimate_size(olib_object_list_get(obj, i));
+            }
+            return size;
+        }
+        case OLIB_OBJECT_TYPE_STRUCT: {
+            size_t size = 5;
+            for (size_t i = 0; i < olib_object_struct_size(obj); i++) {
+                size += 4 + strlen(olib_object_struct_key_at(obj, i));
+                size += estimate_size(olib_object_struct_value_at(obj, i));
+            }
+            return size;
+        }
+        case OLIB_OBJECT_TYPE_MAP: {
+            size_t size = 2;
+            for (size_t i = 0; i < olib_object_map_size(obj); i++) {
+                size += 2 + estimate_size(olib_object_map_value_at(obj, i));
+            }
+            return size;
+        }
+        default:
+            return 1;
+    }
+}
+
+typedef struct {
+    olib_object_t *list;
+    olib_format_t format;
+    char *path;
+    bool ok;
+} shard_job_t;
+
+typedef struct {
+    shard_job_t *jobs;
+    size_t job_count;
+    size_t first;
+    size_t stride;
+} shard_worker_t;
+
+// Workers take every stride-th shard, so no state is shared between them
+static void run_shard_worker(shard_worker_t *worker) {
+    for (size_t i = worker->first; i < worker->job_count; i += worker->stride) {
+        shard_job_t *job = &worker->jobs[i];
+        job->ok = olib_format_write_file_path(job->format, job->list, job->path);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI shard_worker_main(LPVOID arg) {
+    run_shard_worker((shard_worker_t *)arg);
+    return 0;
+}
+#else
+static void *shard_worker_main(void *arg) {
+    run_shard_worker((shard_worker_t *)arg);
+    return NULL;
+}
+#endif
+
+static size_t cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 4;
+#endif
+}
+
+// Write every job on a pool of worker threads, shards whose worker fails to start
+// are written on the calling thread instead
+static void write_shards(shard_job_t *jobs, size_t job_count) {
+    size_t worker_count = cpu_count();
+    if (worker_count > job_count) {
+        worker_count = job_count;
+    }
+    shard_worker_t *workers = calloc(worker_count, sizeof(shard_worker_t));
+#ifdef _WIN32
+    HANDLE *threads = calloc(worker_count, sizeof(HANDLE));
+#else
+    pthread_t *threads = calloc(worker_count, sizeof(pthread_t));
+#endif
+    bool *started = calloc(worker_count, sizeof(bool));
+    if (workers == NULL || threads == NULL || started == NULL) {
+        shard_worker_t worker = {jobs, job_count, 0, 1};
+        run_shard_worker(&worker);
+        free(workers);
+        free(threads);
+        free(started);
+        return;
+    }
+
+    for (size_t i = 0; i < worker_count; i++) {
+        workers[i].jobs = jobs;
+        workers[i].job_count = job_count;
+        workers[i].first = i;
+        workers[i].stride = worker_count;
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, shard_worker_main, &workers[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = pthread_create(&threads[i], NULL, shard_worker_main, &workers[i]) == 0;
+#endif
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+        if (!started[i]) {
+            run_shard_worker(&workers[i]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    free(workers);
+    free(threads);
+    free(started);
+}
+
+// Pick shard boundaries so each shard is about max_bytes once written. Item weights
+// are binary sizes scaled by the output/binary ratio measured on a leading sample.
+static size_t *plan_max_bytes(olib_object_t *list, olib_format_t output_format, size_t max_bytes, size_t *out_shard_count) {
+    size_t item_count = olib_object_list_size(list);
+    size_t *weights = malloc((item_count + 1) * sizeof(size_t));
+    if (weights == NULL) {
+        return NULL;
+    }
+    size_t sample_count = item_count < 256 ? item_count : 256;
+    size_t sample_weight = 0;
+    for (size_t i = 0; i < item_count; i++) {
+        weights[i] = estimate_size(olib_object_list_get(list, i));
+        if (i < sample_count) {
+            sample_weight += weights[i];
+        }
+    }
+
+    double ratio = 1.0;
+    olib_object_t *rest = olib_object_list_split(list, sample_count);
+    if (rest == NULL) {
+        free(weights);
+        return NULL;
+    }
+    uint8_t *sample = NULL;
+    size_t sample_size = 0;
+    bool measured = false;
+    olib_serializer_t *serializer = olib_format_serializer(output_format);
+    if (serializer != NULL && olib_serializer_is_text_based(serializer)) {
+        char *text = NULL;
+        measured = olib_format_write_string(output_format, list, &text);
+        sample = (uint8_t *)text;
+        sample_size = measured ? strlen(text) : 0;
+    } else if (serializer != NULL) {
+        measured = olib_format_write(output_format, list, &sample, &sample_size);
+    }
+    olib_serializer_free(serializer);
+    olib_free(sample);
+    if (!olib_object_list_concat(list, rest)) {
+        olib_object_free(rest);
+        free(weights);
+        return NULL;
+    }
+    olib_object_free(rest);
+    if (measured && sample_weight > 0) {
+        ratio = (double)sample_size / (double)sample_weight;
+    }
+
+    // Boundaries are rewritten in place over the weights, shard s spans
+    // [bounds[s], bounds[s + 1]); every shard holds at least one item
+    size_t *bounds = weights;
+    size_t shard_count = 0;
+    double used = 0.0;
+    for (size_t i = 0; i < item_count; i++) {
+        double weight = (double)weights[i] * ratio;
+        if (i == 0 || (used > 0.0 && used + weight > (double)max_bytes)) {
+            bounds[shard_count++] = i;
+            used = 0.0;
+        }
+        used += weight;
+    }
+    if (shard_count == 0) {
+        bounds[shard_count++] = 0;
+    }
+    bounds[shard_count] = item_count;
+    *out_shard_count = shard_count;
+    return bounds;
+}
+
+// Read a top-level list and write it as shards, either split_count even shards or
+// shards of about max_bytes each
+static bool split_file(olib_format_t input_format, const char *input_file,
+                       olib_format_t output_format, const char *output_file,
+                       size_t split_count, size_t max_bytes) {
+    olib_object_t *list = olib_format_read_file_path(input_format, input_file);
+    if (list == NULL) {
+        return false;
+    }
+    if (!olib_object_is_type(list, OLIB_OBJECT_TYPE_LIST)) {
+        fprintf(stderr, "Error: Splitting needs a top-level list in %s\n", input_file);
+        olib_object_free(list);
+        return false;
+    }
+
+    // More shards than items would leave some of them empty, every shard gets an item
+    size_t item_count = olib_object_list_size(list);
+    size_t shard_count = split_count < item_count ? split_count : (item_count > 0 ? item_count : 1);
+    size_t *bounds = NULL;
+    if (max_bytes > 0) {
+        bounds = plan_max_bytes(list, output_format, max_bytes, &shard_count);
+    } else {
+        bounds = malloc((shard_count + 1) * sizeof(size_t));
+        for (size_t s = 0; bounds != NULL && s <= shard_count; s++) {
+            bounds[s] = (size_t)((unsigned long long)item_count * s / shard_count);
+        }
+    }
+    shard_job_t *jobs = bounds != NULL ? calloc(shard_count, sizeof(shard_job_t)) : NULL;
+    if (jobs == NULL) {
+        free(bounds);
+        olib_object_free(list);
+        return false;
+    }
+
+    // Cut shards off the back so each split moves only the shard's own items
+    bool success = true;
+    for (size_t s = shard_count; s-- > 1 && success;) {
+        jobs[s].list = olib_object_list_split(list, bounds[s]);
+        success = jobs[s].list != NULL;
+    }
+    jobs[0].list = list;
+    for (size_t s = 0; s < shard_count && success; s++) {
+        jobs[s].format = output_format;
+        jobs[s].path = make_shard_path(output_file, s, shard_count);
+        success = jobs[s].path != NULL;
+    }
+
+    if (success) {
+        printf("Writing %zu items into %zu shards\n", item_count, shard_count);
+        write_shards(jobs, shard_count);
+    }
+    for (size_t s = 0; s < shard_count; s++) {
+        if (success && !jobs[s].ok) {
+            fprintf(stderr, "Error: Failed to write shard %s\n", jobs[s].path);
+            success = false;
+        }
+        olib_object_free(jobs[s].list);
+        free(jobs[s].path);
+    }
+    free(jobs);
+    free(bounds);
+    return success;
+}
+
+// Merge every input into one list; binary inputs are spliced without a tree
+static bool merge_files(olib_format_t input_format, const char **input_files, size_t input_count,
+                        olib_format_t output_format, const char *output_file) {
+    uint8_t **inputs = calloc(input_count, sizeof(uint8_t *));
+    size_t *sizes = calloc(input_count, sizeof(size_t));
+    bool success = inputs != NULL && sizes != NULL;
+    for (size_t i = 0; i < input_count && success; i++) {
+        success = read_file_data(input_files[i], &inputs[i], &sizes[i]);
+        if (!success) {
+            fprintf(stderr, "Error: Failed to read %s\n", input_files[i]);
+        }
+    }
+
+    uint8_t *output = NULL;
+    size_t output_size = 0;
+    if (success) {
+        success = olib_convert_merge(input_format, (const uint8_t *const *)inputs, sizes, input_count,
+                                     output_format, &output, &output_size);
+    }
+    if (success) {
+        FILE *file = fopen(output_file, "wb");
+        success = file != NULL && fwrite(output, 1, output_size, file) == output_size;
+        if (file != NULL) {
+            success = fclose(file) == 0 && success;
+        }
+    }
+
+    olib_free(output);
+    for (size_t i = 0; inputs != NULL && i < input_count; i++) {
+        free(inputs[i]);
+    }
+    free(inputs);
+    free(sizes);
+    return success;
+}
+
+// Parse the arguments and run the command, positional arguments are collected in files
+static int run(int argc, char *argv[], const char **files) {
+    size_t file_count = 0;
     olib_format_t input_format = (olib_format_t)-1;
     olib_format_t output_format = (olib_format_t)-1;
+    bool perf = false;
+    bool merge = false;
+    const char *emit_c = NULL;
+    bool size_report = false;
+    size_t top = 20;
+    size_t split_count = 0;
+    size_t max_bytes = 0;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -144,28 +653,73 @@ int main(int argc, char *argv[]) {
                 fprintf(stderr, "Error: Unknown output format '%s'\n", argv[i]);
                 return 1;
             }
+        } else if (strcmp(argv[i], "--split") == 0 || strcmp(argv[i], "--max-bytes") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing argument for %s\n", argv[i]);
+                return 1;
+            }
+            bool is_split = strcmp(argv[i], "--split") == 0;
+            size_t value = 0;
+            if (!parse_size(argv[i + 1], &value) || (is_split && strpbrk(argv[i + 1], "KkMmGg") != NULL)) {
+                fprintf(stderr, "Error: Invalid value '%s' for %s\n", argv[i + 1], argv[i]);
+                return 1;
+            }
+            i++;
+            if (is_split) {
+                split_count = value;
+            } else {
+                max_bytes = value;
+            }
+        } else if (strcmp(argv[i], "--merge") == 0) {
+            merge = true;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        } else if (strcmp(argv[i], "--emit-c") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing argument for %s\n", argv[i]);
+                return 1;
+            }
+            emit_c = argv[++i];
+        } else if (strcmp(argv[i], "--size-report") == 0) {
+            size_report = true;
+        } else if (strcmp(argv[i], "--top") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing argument for %s\n", argv[i]);
+                return 1;
+            }
+            if (strcmp(argv[i + 1], "0") == 0) {
+                top = 0;
+            } else if (!parse_size(argv[i + 1], &top) || strpbrk(argv[i + 1], "KkMmGg") != NULL) {
+                fprintf(stderr, "Error: Invalid value '%s' for %s\n", argv[i + 1], argv[i]);
+                return 1;
+            }
+            i++;
         } else if (argv[i][0] == '-') {
             fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
             return 1;
         } else {
             // Positional argument
-            if (input_file == NULL) {
-                input_file = argv[i];
-            } else if (output_file == NULL) {
-                output_file = argv[i];
-            } else {
-                fprintf(stderr, "Error: Too many arguments\n");
-                return 1;
-            }
+            files[file_count++] = argv[i];
         }
     }
 
     // Validate arguments
-    if (input_file == NULL || output_file == NULL) {
+    if ((split_count > 0) + (max_bytes > 0) + merge + perf + (emit_c != NULL) + size_report > 1) {
+        fprintf(stderr, "Error: --split, --max-bytes, --merge, --perf, --emit-c and --size-report cannot be combined\n");
+        return 1;
+    }
+    if (file_count < 2) {
         fprintf(stderr, "Error: Both input and output files are required\n\n");
         print_usage(argv[0]);
         return 1;
     }
+    if (file_count > 2 && !merge) {
+        fprintf(stderr, "Error: Too many arguments\n");
+        return 1;
+    }
+    const char *input_file = files[0];
+    const char *output_file = files[file_count - 1];
+    size_t input_count = file_count - 1;
 
     // Auto-detect formats if not specified
     if ((int)input_format == -1) {
@@ -174,6 +728,12 @@ int main(int argc, char *argv[]) {
             fprintf(stderr, "Error: Cannot detect input format from extension. Use -i to specify format.\n");
             return 1;
         }
+        for (size_t i = 1; i < input_count; i++) {
+            if (detect_format_from_extension(files[i]) != input_format) {
+                fprintf(stderr, "Error: Inputs have different formats. Use -i to specify format.\n");
+                return 1;
+            }
+        }
     }
 
     if ((int)output_format == -1) {
@@ -185,11 +745,29 @@ int main(int argc, char *argv[]) {
     }
 
     // Perform conversion
-    printf("Converting %s (%s) -> %s (%s)\n",
-           input_file, format_to_string(input_format),
-           output_file, format_to_string(output_format));
-
-    bool success = olib_convert_file_path(input_format, input_file, output_format, output_file);
+    bool success;
+    if (merge) {
+        printf("Merging %zu files (%s) -> %s (%s)\n",
+               input_count, format_to_string(input_format),
+               output_file, format_to_string(output_format));
+        success = merge_files(input_format, files, input_count, output_format, output_file);
+    } else if (emit_c != NULL) {
+        printf("Embedding %s (%s) -> %s as %s()\n", input_file, format_to_string(input_format), output_file, emit_c);
+        success = emit_c_file(input_format, input_file, emit_c, output_file);
+    } else {
+        printf("Converting %s (%s) -> %s (%s)\n",
+               input_file, format_to_string(input_format),
+               output_file, format_to_string(output_format));
+        if (split_count > 0 || max_bytes > 0) {
+            success = split_file(input_format, input_file, output_format, output_file, split_count, max_bytes);
+        } else if (perf) {
+            success = convert_with_perf(input_format, input_file, output_format, output_file);
+        } else if (size_report) {
+            success = convert_with_size_report(input_format, input_file, output_format, output_file, top);
+        } else {
+            success = olib_convert_file_path(input_format, input_file, output_format, output_file);
+        }
+    }
 
     if (!success) {
         fprintf(stderr, "Error: Conversion failed\n");
@@ -199,3 +777,14 @@ int main(int argc, char *argv[]) {
     printf("Conversion successful!\n");
     return 0;
 }
+
+int main(int argc, char *argv[]) {
+    const char **files = calloc((size_t)argc, sizeof(const char *));
+    if (files == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 1;
+    }
+    int result = run(argc, argv, files);
+    free(files);
+    return result;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file replay.c
+ * @brief CLI utility for replaying captured olib traces as a benchmark
+ */
+
+#include <olib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *format_names[] = {
+    "json",
+    "json-binary",
+    "yaml",
+    "xml",
+    "binary",
+    "toml",
+    "txt"
+};
+
+static void print_usage(const char *program_name) {
+    printf("olib-replay - Replay a captured trace and report throughput and latency\n\n");
+    printf("Usage: %s [options] <trace-file>\n\n", program_name);
+    printf("Options:\n");
+    printf("  -t, --threads <count>         Replay the trace on <count> threads side by side (default 1)\n");
+    printf("  -n, --iterations <count>      Passes over the trace per thread (default 1)\n");
+    printf("      --list                    Print the records instead of replaying them\n");
+    printf("  -h, --help                    Show this help message\n");
+    printf("  -v, --version                 Show version information\n\n");
+    printf("Traces are recorded with olib_trace_capture_start and olib_trace_capture_stop.\n\n");
+    printf("Examples:\n");
+    printf("  %s traffic.oltr\n", program_name);
+    printf("  %s --threads 8 --iterations 10 traffic.oltr\n", program_name);
+}
+
+static void print_version(void) {
+    printf("olib-replay version 1.0.0\n");
+    printf("Part of the olib serialization library\n");
+}
+
+static const char *format_to_string(olib_format_t format) {
+    if (format >= 0 && format < sizeof(format_names) / sizeof(format_names[0])) {
+        return format_names[format];
+    }
+    return "unknown";
+}
+
+// Positive decimal count
+static bool parse_count(const char *text, size_t *out_value) {
+    char *end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || value == 0 || text[0] == '-') {
+        return false;
+    }
+    *out_value = (size_t)value;
+    return true;
+}
+
+static void list_records(olib_trace_t *trace) {
+    for (size_t i = 0; i < olib_trace_size(trace); i++) {
+        olib_trace_record_t record;
+        olib_trace_get(trace, i, &record);
+        if (record.op == OLIB_TRACE_READ) {
+            printf("%8zu  %-8s %-12s %12zu bytes\n", i, olib_trace_op_to_string(record.op),
+                   format_to_string(record.src_format), record.size);
+        } else if (record.op == OLIB_TRACE_WRITE) {
+            printf("%8zu  %-8s %-12s %12zu bytes (tree)\n", i, olib_trace_op_to_string(record.op),
+                   format_to_string(record.dst_format), record.size);
+        } else {
+            printf("%8zu  %-8s %-12s %12zu bytes -> %s\n", i, olib_trace_op_to_string(record.op),
+                   format_to_string(record.src_format), record.size, format_to_string(record.dst_format));
+        }
+    }
+}
+
+static void print_result(const olib_trace_replay_result_t *result, size_t threads, size_t iterations) {
+    printf("Threads:     %zu x %zu pass%s\n", threads, iterations, iterations == 1 ? "" : "es");
+    printf("Calls:       %zu (%zu reads, %zu writes, %zu conversions), %zu failed\n", result->ops,
+           result->ops_by_kind[OLIB_TRACE_READ], result->ops_by_kind[OLIB_TRACE_WRITE],
+           result->ops_by_kind[OLIB_TRACE_CONVERT], result->failures);
+    printf("Wall time:   %.3f ms\n", result->wall_ns / 1e6);
+    printf("Throughput:  %.1f calls/s, %.2f MB/s\n", result->ops_per_sec, result->bytes_per_sec / 1e6);
+    printf("Latency us:  mean %.2f  p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+           result->mean_ns / 1e3, result->p50_ns / 1e3, result->p90_ns / 1e3, result->p99_ns / 1e3,
+           result->p999_ns / 1e3, result->max_ns / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+    const char *trace_file = NULL;
+    size_t threads = 1;
+    size_t iterations = 1;
+    bool list = false;
+
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
+            print_version();
+            return 0;
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0 ||
+                   strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--iterations") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing argument for %s\n", argv[i]);
+                return 1;
+            }
+            bool is_threads = argv[i][1] == 't' || strcmp(argv[i], "--threads") == 0;
+            size_t value = 0;
+            if (!parse_count(argv[i + 1], &value)) {
+                fprintf(stderr, "Error: Invalid value '%s' for %s\n", argv[i + 1], argv[i]);
+                return 1;
+            }
+            i++;
+            if (is_threads) {
+                threads = value;
+            } else {
+                iterations = value;
+            }
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list = true;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            return 1;
+        } else if (trace_file == NULL) {
+            trace_file = argv[i];
+        } else {
+            fprintf(stderr, "Error: Too many arguments\n");
+            return 1;
+        }
+    }
+
+    if (trace_file == NULL) {
+        fprintf(stderr, "Error: A trace file is required\n\n");
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    olib_trace_t *trace = olib_trace_load(trace_file);
+    if (trace == NULL) {
+        fprintf(stderr, "Error: Failed to load trace %s\n", trace_file);
+        return 1;
+    }
+
+    printf("Trace:       %s, %zu records\n", trace_file, olib_trace_size(trace));
+    if (list) {
+        list_records(trace);
+        olib_trace_free(trace);
+        return 0;
+    }
+
+    olib_trace_replay_config_t config = {threads, iterations};
+    olib_trace_replay_result_t result;
+    bool success = olib_trace_replay(trace, &config, &result);
+    olib_trace_free(trace);
+    if (!success) {
+        fprintf(stderr, "Error: Replay failed\n");
+        return 1;
+    }
+    print_result(&result, threads, iterations);
+    return 0;
+}
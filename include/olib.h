@@ -24,8 +24,20 @@ SOFTWARE.
 
 #pragma once
 
+#include "olib/olib_arena.h"
+#include "olib/olib_arrow.h"
 #include "olib/olib_base.h"
 #include "olib/olib_formats.h"
+#include "olib/olib_frozen.h"
 #include "olib/olib_helpers.h"
 #include "olib/olib_object.h"
-#include "olib/olib_serializer.h"
\ No newline at end of file
+#include "olib/olib_observer.h"
+#include "olib/olib_perf.h"
+#include "olib/olib_schema.h"
+#include "olib/olib_serializer.h"
+#include "olib/olib_size.h"
+#include "olib/olib_store.h"
+#include "olib/olib_stream.h"
+#include "olib/olib_template.h"
+#include "olib/olib_trace.h"
+#include "olib/olib_txn.h"
\ No newline at end of file
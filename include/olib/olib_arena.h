@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_base.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// File-mapped arena for out-of-core object trees.
+// The arena reserves a large range of address space and maps a backing file into
+// it as it grows, so nodes, keys and strings live in file pages that the kernel can
+// write back and drop under memory pressure. Trees larger than RAM can then be
+// built and transformed at disk speed instead of failing in malloc.
+// Block headers and free lists use 32-bit offsets in 16-byte units, which caps an
+// arena at 64 GiB. Available on Linux and macOS, olib_mmap_arena_new returns NULL
+// elsewhere.
+
+typedef struct olib_mmap_arena_t olib_mmap_arena_t;
+
+// Access pattern hint passed to madvise for the mapped range
+typedef enum olib_mmap_advice_t {
+  OLIB_MMAP_ADVICE_NORMAL,
+  OLIB_MMAP_ADVICE_SEQUENTIAL,  // Trees are built or walked front to back, read ahead aggressively
+  OLIB_MMAP_ADVICE_RANDOM,      // Scattered lookups, do not read ahead
+} olib_mmap_advice_t;
+
+typedef struct olib_mmap_arena_options_t {
+  const char* directory;      // Where the backing file is created (NULL uses TMPDIR, then /tmp)
+  size_t reserve_size;        // Address space reserved up front, the arena cannot grow past it (0 = 64 GiB, 512 MiB on 32-bit)
+  size_t grow_size;           // The backing file grows in steps of this size (0 = 64 MiB)
+  olib_mmap_advice_t advice;  // Initial access pattern hint
+} olib_mmap_arena_options_t;
+
+// Create an arena, NULL options use the defaults (caller must free with olib_mmap_arena_free).
+// The backing file is unlinked right away, so nothing is left behind if the process dies.
+OLIB_API olib_mmap_arena_t* olib_mmap_arena_new(const olib_mmap_arena_options_t* options);
+
+// Release the mapping and the backing file. Everything allocated from the arena becomes
+// invalid. If the arena is in use, it is detached first.
+OLIB_API void olib_mmap_arena_free(olib_mmap_arena_t* arena);
+
+// Route olib_malloc/free/calloc/realloc to arena, NULL detaches it and restores the
+// memory functions that were installed before. Blocks allocated before the switch are
+// still freed and reallocated by those functions. Free arena blocks before switching
+// back, or drop them all at once with olib_mmap_arena_free. Like olib_set_memory_fns, call it while no other thread
+// uses the library.
+OLIB_API void olib_mmap_arena_use(olib_mmap_arena_t* arena);
+
+// Change the access pattern hint for everything mapped so far and for future growth
+OLIB_API void olib_mmap_arena_advise(olib_mmap_arena_t* arena, olib_mmap_advice_t advice);
+
+// Bytes in live blocks, including block headers
+OLIB_API size_t olib_mmap_arena_used(olib_mmap_arena_t* arena);
+
+// Bytes of the backing file mapped so far
+OLIB_API size_t olib_mmap_arena_mapped(olib_mmap_arena_t* arena);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Apache Arrow IPC stream support for record lists.
+// A record list is an OLIB_OBJECT_TYPE_LIST of flat structs; each struct key
+// becomes a column and each list item a row. Keys missing from a row are written
+// as nulls, and null values are omitted from the structs produced when reading.
+
+// #############################################################################
+// Writing
+// #############################################################################
+
+// Write a record list as an Arrow IPC stream: schema message, one record batch and
+// the end-of-stream marker (caller must free out_data with olib_free).
+// Column types come from the first row that has the key: INT -> int64, UINT -> uint64,
+// FLOAT -> float64, BOOL -> bool, STRING -> utf8. Fails if a key changes type between
+// rows or holds a list or struct.
+OLIB_API bool olib_arrow_write(olib_object_t* records, uint8_t** out_data, size_t* out_size);
+
+// #############################################################################
+// Reading
+// #############################################################################
+
+// Read every record batch of an Arrow IPC stream into a single record list. Fails on a
+// schema with duplicate field names, the column views below still read those by index
+// (caller must free returned object with olib_object_free)
+OLIB_API olib_object_t* olib_arrow_read(const uint8_t* data, size_t size);
+
+// #############################################################################
+// Column views - zero-copy access to record batches
+// #############################################################################
+
+typedef enum olib_arrow_type_t {
+  OLIB_ARROW_TYPE_NULL,    // No values, every row is null
+  OLIB_ARROW_TYPE_INT,     // Signed integers of bit_width bits
+  OLIB_ARROW_TYPE_UINT,    // Unsigned integers of bit_width bits
+  OLIB_ARROW_TYPE_FLOAT,   // float (32) or double (64)
+  OLIB_ARROW_TYPE_BOOL,    // Bit-packed booleans, LSB first
+  OLIB_ARROW_TYPE_STRING,  // UTF-8 bytes addressed by offsets
+  OLIB_ARROW_TYPE_BINARY,  // Raw bytes addressed by offsets
+} olib_arrow_type_t;
+
+typedef struct olib_arrow_column_t {
+  const char* name;
+  olib_arrow_type_t type;
+  size_t bit_width;         // Bits per value (1 for BOOL, 0 for NULL/STRING/BINARY)
+  size_t length;            // Number of rows in the batch
+  size_t null_count;
+  const uint8_t* validity;  // LSB-first bitmap, row i is valid if bit i is set (NULL when no nulls)
+  const void* values;       // Fixed-width values, packed bools, or string/binary bytes
+  const int32_t* offsets;   // STRING/BINARY only: length + 1 offsets into values
+} olib_arrow_column_t;
+
+typedef struct olib_arrow_reader_t olib_arrow_reader_t;
+
+// Open an Arrow IPC stream and parse its schema (caller must free with olib_arrow_reader_free).
+// Views point into data, which must stay alive and unchanged while the reader is used.
+// If data is not 8-byte aligned the reader keeps an aligned copy instead.
+OLIB_API olib_arrow_reader_t* olib_arrow_reader_new(const uint8_t* data, size_t size);
+OLIB_API void olib_arrow_reader_free(olib_arrow_reader_t* reader);
+
+// Schema access, valid as soon as the reader is created
+OLIB_API size_t olib_arrow_reader_column_count(olib_arrow_reader_t* reader);
+OLIB_API const char* olib_arrow_reader_column_name(olib_arrow_reader_t* reader, size_t index);
+
+// Advance to the next record batch and validate its buffers.
+// Returns false at the end of the stream or if the batch is malformed or unsupported
+// (compressed bodies, dictionary encoding, nested types).
+OLIB_API bool olib_arrow_reader_next_batch(olib_arrow_reader_t* reader);
+
+// Check whether olib_arrow_reader_next_batch stopped on an error rather than the end of the stream
+OLIB_API bool olib_arrow_reader_failed(olib_arrow_reader_t* reader);
+
+// Current batch access, valid after olib_arrow_reader_next_batch returned true
+OLIB_API size_t olib_arrow_reader_row_count(olib_arrow_reader_t* reader);
+OLIB_API bool olib_arrow_reader_column(olib_arrow_reader_t* reader, size_t index, olib_arrow_column_t* out_column);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
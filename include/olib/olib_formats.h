@@ -53,6 +53,32 @@ OLIB_API olib_serializer_t* olib_serializer_new_binary();
 OLIB_API olib_serializer_t* olib_serializer_new_toml();
 OLIB_API olib_serializer_t* olib_serializer_new_txt();
 
+// Options for olib_serializer_new_binary_ex
+typedef struct olib_binary_options_t {
+  // Write lists whose elements are all INT, all UINT or all FLOAT compressed:
+  // integers as delta-of-delta varints, floats with Gorilla XOR encoding.
+  // A list stays plain if packing would not make it smaller.
+  bool pack_numeric_lists;
+  size_t pack_min_count;  // Shorter lists stay plain (0 uses the default of 8)
+} olib_binary_options_t;
+
+// Binary serializer with options, NULL behaves like olib_serializer_new_binary.
+// Every binary serializer reads packed lists regardless of its options.
+OLIB_API olib_serializer_t* olib_serializer_new_binary_ex(const olib_binary_options_t* options);
+
+// Options for olib_serializer_new_json_text_ex
+typedef struct olib_json_text_options_t {
+  // Inputs of at least this many bytes are first scanned in parallel for quotes,
+  // brackets, commas and colons. The parser then takes list sizes and string
+  // bounds from that index instead of rescanning the input.
+  // 0 uses the default of 1 MiB, SIZE_MAX never builds the index.
+  size_t index_min_size;
+  size_t index_threads;  // Threads scanning the input (0 uses one per CPU, and no index on one CPU)
+} olib_json_text_options_t;
+
+// JSON text serializer with options, NULL behaves like olib_serializer_new_json_text
+OLIB_API olib_serializer_t* olib_serializer_new_json_text_ex(const olib_json_text_options_t* options);
+
 // #############################################################################
 OLIB_HEADER_END;
 // #############################################################################
\ No newline at end of file
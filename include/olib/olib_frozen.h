@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Frozen trees: documents compiled into a program as static const data.
+// olib_frozen_emit_c generates C source that lays a tree out with the node layout
+// below, so the compiler places it in read-only data. The generated accessor returns
+// the root as a regular olib_object_t, ready without parsing or allocating. Frozen
+// nodes work with every getter, olib_object_dupe and the writers, but must never be
+// mutated, observed, used in a transaction or freed.
+
+// Bumped whenever the node layout or the map hash changes. Generated sources check it
+// and must be regenerated when it no longer matches.
+#define OLIB_FROZEN_VERSION 1
+
+typedef struct olib_frozen_t olib_frozen_t;
+
+typedef struct olib_frozen_entry_t {
+  const char* key;
+  const olib_frozen_t* value;
+} olib_frozen_entry_t;
+
+typedef struct olib_frozen_map_entry_t {
+  int64_t key;
+  const olib_frozen_t* value;
+} olib_frozen_map_entry_t;
+
+// Same layout as olib_object_t
+struct olib_frozen_t {
+  olib_object_type_t type;
+  uint32_t observer;  // Always 0
+  union {
+    int64_t int_val;
+    uint64_t uint_val;
+    double float_val;
+    bool bool_val;
+    struct {
+      const char* data;
+      size_t capacity;  // Length including the null terminator
+    } string;
+    struct {
+      const olib_frozen_t* const* items;
+      size_t size;
+      size_t capacity;
+    } list;
+    struct {
+      const olib_frozen_entry_t* entries;
+      size_t size;
+      size_t capacity;
+    } object;
+    struct {
+      const olib_frozen_map_entry_t* entries;  // Followed by 2 * capacity hash slots
+      size_t size;
+      size_t capacity;
+    } map;
+  } data;
+};
+
+// Initializers used by the generated sources
+#define OLIB_FROZEN_INT(value)     {OLIB_OBJECT_TYPE_INT, 0, {.int_val = (value)}}
+#define OLIB_FROZEN_UINT(value)    {OLIB_OBJECT_TYPE_UINT, 0, {.uint_val = (value)}}
+#define OLIB_FROZEN_FLOAT(value)   {OLIB_OBJECT_TYPE_FLOAT, 0, {.float_val = (value)}}
+#define OLIB_FROZEN_BOOL(value)    {OLIB_OBJECT_TYPE_BOOL, 0, {.bool_val = (value)}}
+#define OLIB_FROZEN_STRING(value)  {OLIB_OBJECT_TYPE_STRING, 0, {.string = {(value), sizeof(value)}}}
+#define OLIB_FROZEN_LIST(items, size)       {OLIB_OBJECT_TYPE_LIST, 0, {.list = {(items), (size), (size)}}}
+#define OLIB_FROZEN_STRUCT(entries, size)   {OLIB_OBJECT_TYPE_STRUCT, 0, {.object = {(entries), (size), (size)}}}
+#define OLIB_FROZEN_MAP(entries, size, capacity) {OLIB_OBJECT_TYPE_MAP, 0, {.map = {(entries), (size), (capacity)}}}
+
+// View a frozen node as an object. The result is read-only even though the
+// getters take a non-const pointer.
+static inline olib_object_t* olib_frozen_object(const olib_frozen_t* node) {
+  return (olib_object_t*)node;
+}
+
+// Generate C source defining obj as static const frozen nodes, plus a function
+// `olib_object_t* <name>(void)` returning its root (caller must free out_source with
+// olib_free). name must be a C identifier; the data symbols are static and prefixed
+// with it. Fails for an invalid name or when out of memory.
+OLIB_API bool olib_frozen_emit_c(olib_object_t* obj, const char* name, char** out_source);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -69,6 +69,19 @@ OLIB_API olib_object_t* olib_format_read_file(olib_format_t format, FILE* file);
 // Read object from file path (caller must free returned object with olib_object_free)
 OLIB_API olib_object_t* olib_format_read_file_path(olib_format_t format, const char* file_path);
 
+// #############################################################################
+// Filtered helpers - route the encoded bytes through a stream filter chain
+// #############################################################################
+
+// Same as the helpers above, with the chain applied between the format and the buffer or file.
+// Work with every format, text or binary. A NULL chain passes data through unchanged.
+OLIB_API bool olib_format_write_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, uint8_t** out_data, size_t* out_size);
+OLIB_API bool olib_format_write_file_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, FILE* file);
+OLIB_API bool olib_format_write_file_path_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, const char* file_path);
+OLIB_API olib_object_t* olib_format_read_filtered(olib_format_t format, olib_stream_chain_t* chain, const uint8_t* data, size_t size);
+OLIB_API olib_object_t* olib_format_read_file_filtered(olib_format_t format, olib_stream_chain_t* chain, FILE* file);
+OLIB_API olib_object_t* olib_format_read_file_path_filtered(olib_format_t format, olib_stream_chain_t* chain, const char* file_path);
+
 // #############################################################################
 // Conversion helpers - convert between formats directly
 // #############################################################################
@@ -106,6 +119,17 @@ OLIB_API bool olib_convert_file_path(
     olib_format_t dst_format,
     const char* dst_path);
 
+// Merge several inputs of one format into a single list (caller must free out_data with olib_free)
+// A list input contributes its elements, any other value is appended as one element
+OLIB_API bool olib_convert_merge(
+    olib_format_t src_format,
+    const uint8_t* const* src_data,
+    const size_t* src_sizes,
+    size_t src_count,
+    olib_format_t dst_format,
+    uint8_t** out_data,
+    size_t* out_size);
+
 // #############################################################################
 OLIB_HEADER_END;
 // #############################################################################
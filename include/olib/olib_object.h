@@ -38,6 +38,7 @@ typedef enum olib_object_type_t {
   OLIB_OBJECT_TYPE_FLOAT,
   OLIB_OBJECT_TYPE_STRING,
   OLIB_OBJECT_TYPE_BOOL,
+  OLIB_OBJECT_TYPE_MAP,
   OLIB_OBJECT_TYPE_MAX,
 } olib_object_type_t;
 
@@ -52,6 +53,12 @@ OLIB_API olib_object_t* olib_object_new(olib_object_type_t type);  // Value is e
 OLIB_API olib_object_t* olib_object_dupe(olib_object_t* obj);
 OLIB_API void olib_object_free(olib_object_t* obj);
 
+// Deep comparison and hashing. Struct and map entries are compared in order (sort maps with
+// olib_object_map_sort to compare them by content) and floats by bit pattern. Equal trees
+// have equal hashes.
+OLIB_API bool olib_object_equal(olib_object_t* a, olib_object_t* b);
+OLIB_API uint64_t olib_object_hash(olib_object_t* obj);
+
 // Helper getters
 OLIB_API olib_object_type_t olib_object_get_type(olib_object_t* obj);
 OLIB_API bool olib_object_is_type(olib_object_t* obj, olib_object_type_t type);
@@ -71,6 +78,12 @@ OLIB_API bool olib_object_list_remove(olib_object_t* obj, size_t index);
 OLIB_API bool olib_object_list_push(olib_object_t* obj, olib_object_t* value);
 OLIB_API bool olib_object_list_pop(olib_object_t* obj);
 
+// List moves (no elements are copied)
+// Split moves elements [index, size) into a new list (caller must free with olib_object_free)
+// Concat moves every element of src to the end of obj, leaving src empty
+OLIB_API olib_object_t* olib_object_list_split(olib_object_t* obj, size_t index);
+OLIB_API bool olib_object_list_concat(olib_object_t* obj, olib_object_t* src);
+
 // #############################################################################
 
 // Struct getters
@@ -87,6 +100,26 @@ OLIB_API bool olib_object_struct_remove(olib_object_t* obj, const char* key);
 
 // #############################################################################
 
+// Maps are keyed by int64 (uint64 ids are stored through their two's-complement value) and
+// backed by a hash table, so lookups never compare strings. Entries are kept in insertion
+// order until a removal moves the last entry into the freed position; olib_object_map_sort
+// orders them by key when ordered iteration is needed.
+
+// Map getters
+OLIB_API size_t olib_object_map_size(olib_object_t* obj);
+OLIB_API bool olib_object_map_has(olib_object_t* obj, int64_t key);
+OLIB_API olib_object_t* olib_object_map_get(olib_object_t* obj, int64_t key);
+OLIB_API int64_t olib_object_map_key_at(olib_object_t* obj, size_t index);  // Returns 0 if index is out of range
+OLIB_API olib_object_t* olib_object_map_value_at(olib_object_t* obj, size_t index);
+
+// Map setters
+OLIB_API bool olib_object_map_add(olib_object_t* obj, int64_t key, olib_object_t* value);  // Fails if key exists
+OLIB_API bool olib_object_map_set(olib_object_t* obj, int64_t key, olib_object_t* value);  // Overwrites existing key, if it does not exist it is created
+OLIB_API bool olib_object_map_remove(olib_object_t* obj, int64_t key);
+OLIB_API bool olib_object_map_sort(olib_object_t* obj);  // Orders entries by ascending key (fails inside a transaction)
+
+// #############################################################################
+
 // Value getters - return value stored in the object
 // For string getter: returns pointer to internal null-terminated string (do not free)
 // Returns appropriate default values if object is NULL or wrong type
@@ -105,6 +138,23 @@ OLIB_API bool olib_object_set_float(olib_object_t* obj, double value);
 OLIB_API bool olib_object_set_string(olib_object_t* obj, const char* value);  // Makes copy of string
 OLIB_API bool olib_object_set_bool(olib_object_t* obj, bool value);
 
+// #############################################################################
+
+// Parallel variants for huge trees. Containers with at least min_children children are split
+// into chunks, which a pool of worker threads steal from each other as they run out of work.
+// Results match the serial functions and every container keeps its child order. Trees
+// without such a container stay on the calling thread and never start the pool.
+typedef struct olib_parallel_config_t {
+  size_t threads;       // Threads including the caller (0 uses every CPU, 1 stays serial)
+  size_t min_children;  // Smallest container that is split (0 uses 4096)
+} olib_parallel_config_t;
+
+// config may be NULL for the defaults
+OLIB_API olib_object_t* olib_object_dupe_parallel(olib_object_t* obj, const olib_parallel_config_t* config);
+OLIB_API void olib_object_free_parallel(olib_object_t* obj, const olib_parallel_config_t* config);
+OLIB_API bool olib_object_equal_parallel(olib_object_t* a, olib_object_t* b, const olib_parallel_config_t* config);
+OLIB_API uint64_t olib_object_hash_parallel(olib_object_t* obj, const olib_parallel_config_t* config);
+
 // #############################################################################
 OLIB_HEADER_END;
 // #############################################################################
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_base.h"
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Mutation observers.
+// An observer watches one tree and reports changes made through the olib_object_set_*,
+// olib_object_list_* and olib_object_struct_* mutators to subscribers of key-path
+// prefixes, so consumers handle what changed instead of diffing the whole tree.
+// Paths join struct keys with '.' and list indices with "[i]", for example
+// "users[2].name". The root itself has the empty path.
+// Trees without an observer pay a single compare per mutation. Changes made by
+// olib_serializer_read_into and other bulk loaders are not reported.
+
+typedef struct olib_observer_t olib_observer_t;
+typedef struct olib_subscription_t olib_subscription_t;
+
+typedef enum olib_change_kind_t {
+  OLIB_CHANGE_SET,     // A value was overwritten, or a struct key, map key or list item was replaced
+  OLIB_CHANGE_INSERT,  // A struct key, map key or list item was added
+  OLIB_CHANGE_REMOVE,  // A struct key, map key or list item was removed
+} olib_change_kind_t;
+
+typedef struct olib_change_t {
+  olib_change_kind_t kind;
+  const char* path;           // Path of the value that changed, as it was when the change was made
+  olib_object_t* old_value;   // Copy of the previous value, NULL for inserts
+  olib_object_t* new_value;   // Copy of the new value, NULL for removes
+} olib_change_t;
+
+// Receives the changes of one batch that match the subscription, in the order they were
+// made. The changes and their values are only valid during the call. Callbacks must not
+// mutate the observed tree.
+typedef void (*olib_observer_fn)(void* ctx, const olib_change_t* changes, size_t count);
+
+// Start observing the tree under root (caller must free with olib_observer_free).
+// Returns NULL if any node of the tree is already observed. Every node of the tree,
+// including ones added later, is tracked until it leaves the tree.
+OLIB_API olib_observer_t* olib_observer_new(olib_object_t* root);
+
+// Stop observing, pending changes of an open batch are dropped
+OLIB_API void olib_observer_free(olib_observer_t* observer);
+
+// Call fn with the changes at prefix, below it, or to any value containing it. "user"
+// matches "user", "user.name" and "user[0]", and a replacement of the root, but not
+// "username". The subscription is freed by olib_observer_unsubscribe or olib_observer_free.
+OLIB_API olib_subscription_t* olib_observer_subscribe(olib_observer_t* observer, const char* prefix,
+                                                      olib_observer_fn fn, void* ctx);
+OLIB_API void olib_observer_unsubscribe(olib_observer_t* observer, olib_subscription_t* subscription);
+
+// Collect changes until the matching batch_end, which delivers them in one call per
+// subscriber. Batches nest, only the outermost end delivers. Outside a batch, every
+// change is delivered on its own.
+OLIB_API void olib_observer_batch_begin(olib_observer_t* observer);
+OLIB_API void olib_observer_batch_end(olib_observer_t* observer);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
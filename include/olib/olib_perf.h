@@ -0,0 +1,150 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_formats.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Hardware performance counters around parse and serialize phases.
+// Counters are read through perf_event_open on Linux and only cover the calling
+// thread in user space. Counters that cannot be opened (other platforms, containers,
+// restrictive perf_event_paranoid settings) are reported as unavailable; wall time
+// is always measured.
+
+typedef enum olib_perf_counter_t {
+  OLIB_PERF_CYCLES,
+  OLIB_PERF_INSTRUCTIONS,
+  OLIB_PERF_BRANCH_MISSES,
+  OLIB_PERF_L1D_MISSES,    // L1 data cache read misses
+  OLIB_PERF_LLC_MISSES,    // Last level cache read misses
+  OLIB_PERF_DTLB_MISSES,   // Data TLB read misses
+  OLIB_PERF_COUNTER_MAX,
+} olib_perf_counter_t;
+
+OLIB_API const char* olib_perf_counter_to_string(olib_perf_counter_t counter);
+
+typedef struct olib_perf_result_t {
+  double wall_ns;
+  size_t bytes;                                // Bytes parsed or produced, set by olib_perf_normalize
+  size_t nodes;                                // Objects in the tree, set by olib_perf_normalize
+  bool available[OLIB_PERF_COUNTER_MAX];       // Whether the counter was read
+  uint64_t counts[OLIB_PERF_COUNTER_MAX];      // Scaled when the kernel multiplexed the counter
+  double per_byte[OLIB_PERF_COUNTER_MAX];      // counts / bytes (0 when bytes is 0)
+  double per_node[OLIB_PERF_COUNTER_MAX];      // counts / nodes (0 when nodes is 0)
+} olib_perf_result_t;
+
+typedef struct olib_perf_t olib_perf_t;
+
+// Open every counter the platform allows (caller must free with olib_perf_free)
+OLIB_API olib_perf_t* olib_perf_new(void);
+OLIB_API void olib_perf_free(olib_perf_t* perf);
+
+// Check whether a counter could be opened
+OLIB_API bool olib_perf_is_available(olib_perf_t* perf, olib_perf_counter_t counter);
+
+// Measure an arbitrary section of code on the calling thread
+OLIB_API bool olib_perf_begin(olib_perf_t* perf);
+OLIB_API bool olib_perf_end(olib_perf_t* perf, olib_perf_result_t* out_result);
+
+// Fill bytes, nodes and the normalized values of a result
+OLIB_API void olib_perf_normalize(olib_perf_result_t* result, size_t bytes, size_t nodes);
+
+// #############################################################################
+// Phase helpers - measure one parse or serialize and normalize the result
+// #############################################################################
+
+// Parse data in the given format (caller must free returned object with olib_object_free)
+// Text formats are copied to a null-terminated buffer before the measurement starts
+OLIB_API olib_object_t* olib_perf_read(
+    olib_perf_t* perf,
+    olib_format_t format,
+    const uint8_t* data,
+    size_t size,
+    olib_perf_result_t* out_result);
+
+// Serialize obj in the given format (caller must free out_data with olib_free)
+// Text formats produce a null-terminated buffer, out_size excludes the terminator
+OLIB_API bool olib_perf_write(
+    olib_perf_t* perf,
+    olib_format_t format,
+    olib_object_t* obj,
+    uint8_t** out_data,
+    size_t* out_size,
+    olib_perf_result_t* out_result);
+
+// #############################################################################
+// Slow operation hook - report pathological inputs from the helper functions
+// #############################################################################
+
+// The olib_format_read*, olib_format_write* and olib_convert* helpers time themselves
+// while a hook is installed. An operation that crosses a threshold is passed to the
+// callback with enough detail to find and replay the input. Nested helper calls (the
+// read and write inside a conversion) are reported once, as part of the outer call.
+
+typedef enum olib_slow_op_kind_t {
+  OLIB_SLOW_OP_READ,
+  OLIB_SLOW_OP_WRITE,
+  OLIB_SLOW_OP_CONVERT,
+} olib_slow_op_kind_t;
+
+typedef struct olib_slow_op_info_t {
+  olib_slow_op_kind_t kind;
+  olib_format_t src_format;  // Format parsed (the written format for writes)
+  olib_format_t dst_format;  // Format produced (the parsed format for reads)
+  size_t input_size;         // Bytes parsed (0 for writes)
+  size_t output_size;        // Bytes produced (0 for reads)
+  size_t nodes;              // Objects in the tree, 0 when converted without one
+  uint64_t fingerprint;      // FNV-1a 64 of the input, of the output for writes
+  double read_ns;            // Parse phase
+  double write_ns;           // Serialize phase
+  double total_ns;           // Whole call, including conversions without a tree
+  const uint8_t* prefix;     // First bytes of the input (output for writes), only valid during the callback
+  size_t prefix_size;
+} olib_slow_op_info_t;
+
+typedef void (*olib_slow_op_fn)(const olib_slow_op_info_t* info, void* user_data);
+
+typedef struct olib_slow_op_config_t {
+  olib_slow_op_fn callback;
+  void* user_data;
+  double threshold_ns;     // Report calls taking at least this long (0 disables the time check)
+  size_t node_threshold;   // Report calls on at least this many objects (0 disables the node check)
+  size_t max_prefix;       // Bytes passed as prefix (0 passes none)
+  double min_interval_ns;  // Minimum time between two reports, reports in between are dropped
+} olib_slow_op_config_t;
+
+// Install the hook for all threads, NULL or a NULL callback removes it.
+// The callback runs on the thread that made the call. Helpers it calls are not reported.
+OLIB_API void olib_set_slow_op_hook(const olib_slow_op_config_t* config);
+
+// Reports dropped by the rate limit since the hook was installed
+OLIB_API uint64_t olib_slow_op_dropped(void);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Schema-bound binary encoding.
+// When both sides agree on a schema, values are written in schema order with no
+// type tags and no key names: INT as a zigzag varint, UINT as a varint, FLOAT as
+// 8 little-endian bytes, BOOL as one byte, STRING as a varint length and bytes,
+// LIST as a varint count and elements. A STRUCT starts with a presence bitmap
+// (one bit per optional field, LSB first) followed by the present fields.
+
+typedef struct olib_schema_t olib_schema_t;
+
+// #############################################################################
+// Building
+// #############################################################################
+
+// Create a schema node for a type (caller must free with olib_schema_free).
+// A LIST has no element schema until one is set and only matches empty lists.
+OLIB_API olib_schema_t* olib_schema_new(olib_object_type_t type);
+OLIB_API void olib_schema_free(olib_schema_t* schema);
+
+// Compile a schema from an example object (caller must free with olib_schema_free).
+// List elements are merged into one element schema: struct fields missing from
+// some elements become optional. Fails if list elements have different types.
+OLIB_API olib_schema_t* olib_schema_from_object(olib_object_t* example);
+
+// Append a field to a STRUCT schema. The schema takes ownership of field, which
+// must not be modified afterwards. Fails if the key is already present.
+OLIB_API bool olib_schema_struct_add(olib_schema_t* schema, const char* key, olib_schema_t* field, bool optional);
+
+// Set the element schema of a LIST schema, replacing any previous one.
+// The schema takes ownership of element, which must not be modified afterwards.
+OLIB_API bool olib_schema_list_set_element(olib_schema_t* schema, olib_schema_t* element);
+
+// Inspection
+OLIB_API olib_object_type_t olib_schema_get_type(olib_schema_t* schema);
+OLIB_API size_t olib_schema_struct_size(olib_schema_t* schema);
+OLIB_API const char* olib_schema_struct_key_at(olib_schema_t* schema, size_t index);
+OLIB_API olib_schema_t* olib_schema_struct_field_at(olib_schema_t* schema, size_t index);
+OLIB_API bool olib_schema_struct_optional_at(olib_schema_t* schema, size_t index);
+OLIB_API olib_schema_t* olib_schema_list_element(olib_schema_t* schema);
+
+// #############################################################################
+// Encoding
+// #############################################################################
+
+// Encode obj against schema (caller must free out_data with olib_free).
+// Fails if a type differs from the schema, a required field is missing, or a
+// struct has keys the schema does not know.
+OLIB_API bool olib_schema_encode(olib_schema_t* schema, olib_object_t* obj, uint8_t** out_data, size_t* out_size);
+
+// Decode data produced by olib_schema_encode with the same schema
+// (caller must free returned object with olib_object_free)
+OLIB_API olib_object_t* olib_schema_decode(olib_schema_t* schema, const uint8_t* data, size_t size);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -25,12 +25,34 @@ SOFTWARE.
 #pragma once
 
 #include "olib_object.h"
+#include "olib_stream.h"
 
 // #############################################################################
 OLIB_HEADER_BEGIN;
 // #############################################################################
 
 typedef struct olib_serializer_t olib_serializer_t;
+typedef struct olib_output_buffer_t olib_output_buffer_t;
+
+// How a serializer hands its encoded output to the caller
+typedef enum olib_output_mode_t {
+  OLIB_OUTPUT_HANDOFF = 0,  // Hand the write buffer itself to the caller (default)
+  OLIB_OUTPUT_RETAIN,       // Keep the write buffer for the next write and hand out an exact-size copy
+} olib_output_mode_t;
+
+// Value produced by the optional read_value callback. Scalars are fully decoded; for
+// lists, structs and maps only the type is set and nothing is consumed, so the driver
+// continues with read_list_begin / read_struct_begin / read_map_begin.
+typedef struct olib_value_t {
+  olib_object_type_t type;
+  union {
+    int64_t int_val;
+    uint64_t uint_val;
+    double float_val;
+    const char* string_val;  // Valid until next read
+    bool bool_val;
+  } data;
+} olib_value_t;
 
 typedef struct olib_serializer_config_t {
   // Internal user data pointer for serializer context
@@ -46,6 +68,7 @@ typedef struct olib_serializer_config_t {
   bool (*finish_write)(void* ctx, uint8_t** out_data, size_t* out_size);  // Get write buffer (caller frees)
   bool (*init_read)(void* ctx, const uint8_t* data, size_t size);         // Set up read buffer
   bool (*finish_read)(void* ctx);                                         // Cleanup after reading
+  olib_output_buffer_t* (*output_buffer)(void* ctx);                      // Optional: shared write buffer of the built-in formats
 
   // Write callbacks (return false on error)
   bool (*write_int)(void* ctx, int64_t value);
@@ -59,8 +82,19 @@ typedef struct olib_serializer_config_t {
   bool (*write_struct_key)(void* ctx, const char* key);
   bool (*write_struct_end)(void* ctx);
 
+  // Optional integer-keyed map callbacks (write_map_begin, write_map_key, write_map_end). Serializers
+  // without them write maps as structs with decimal keys
+  bool (*write_map_begin)(void* ctx, size_t size);
+  bool (*write_map_key)(void* ctx, int64_t key);
+  bool (*write_map_end)(void* ctx);
+
+  // Optional, writes one string value delivered in pieces: first is set on the first call and
+  // last on the final one. Serializers without it get the pieces joined through write_string
+  bool (*write_string_chunk)(void* ctx, const char* chunk, size_t size, bool first, bool last);
+
   // Read callbacks (return false on error or end-of-container)
   olib_object_type_t (*read_peek)(void* ctx);  // Peek next type without consuming
+  bool (*read_value)(void* ctx, olib_value_t* out);  // Optional: classify and decode the next value in one pass (preferred over peek + read_*)
   bool (*read_int)(void* ctx, int64_t* value);
   bool (*read_uint)(void* ctx, uint64_t* value);
   bool (*read_float)(void* ctx, double* value);
@@ -71,6 +105,16 @@ typedef struct olib_serializer_config_t {
   bool (*read_struct_begin)(void* ctx);
   bool (*read_struct_key)(void* ctx, const char** key);  // Returns false when no more keys
   bool (*read_struct_end)(void* ctx);
+
+  // Optional, needed when read_peek / read_value can report OLIB_OBJECT_TYPE_MAP
+  bool (*read_map_begin)(void* ctx, size_t* size);
+  bool (*read_map_key)(void* ctx, int64_t* key);
+  bool (*read_map_end)(void* ctx);
+
+  // Optional, reads the next string value in pieces of at most max_size bytes. The first call
+  // consumes the start of the value and *last is set on the piece that ends it. A piece stays
+  // valid until the next read. Serializers without it decode the whole value with read_string
+  bool (*read_string_chunk)(void* ctx, size_t max_size, const char** chunk, size_t* size, bool* last);
 } olib_serializer_config_t;
 
 // Serializer management
@@ -80,6 +124,39 @@ OLIB_API void olib_serializer_free(olib_serializer_t* serializer);
 // Check if a serializer is configured as text-based
 OLIB_API bool olib_serializer_is_text_based(olib_serializer_t* serializer);
 
+// Output buffer
+// The built-in formats size each new write buffer from the running average of previous outputs.
+// olib_serializer_set_output_mode: Choose how output is handed over (returns false for serializers
+// without a shared output buffer)
+OLIB_API bool olib_serializer_set_output_mode(olib_serializer_t* serializer, olib_output_mode_t mode);
+
+// olib_serializer_recycle_output: Give the buffer returned by the most recent write back to the
+// serializer, which then reuses it for the next write instead of allocating. Takes ownership of
+// `data`; buffers that cannot be reused are freed
+OLIB_API void olib_serializer_recycle_output(olib_serializer_t* serializer, void* data);
+
+// Streaming strings
+// Huge string values can be moved between the document and the caller in pieces instead of
+// through the tree, so they are never held in memory in one piece.
+
+// Receives consecutive pieces of one string value; last is set on the final one, which may be
+// empty. node is the string node that stands in for the value. Return false to abort the read
+typedef bool (*olib_string_sink_fn)(void* ctx, olib_object_t* node, const char* chunk, size_t size, bool last);
+
+// Supplies the next piece of the value written for node, setting *last on the final one. A piece
+// must stay valid until the next call. Return false to abort the write
+typedef bool (*olib_string_source_fn)(void* ctx, olib_object_t* node, const char** chunk, size_t* size, bool* last);
+
+// olib_serializer_set_string_sink: While reading, string values longer than chunk_size bytes are
+// passed to fn in pieces of at most chunk_size bytes and their node is left empty. Shorter values
+// are stored as usual. Fails for a chunk_size below 16. A NULL fn turns streaming off
+OLIB_API bool olib_serializer_set_string_sink(olib_serializer_t* serializer, size_t chunk_size, olib_string_sink_fn fn,
+                                              void* ctx);
+
+// olib_serializer_set_string_source: While writing, the value of every empty string node is
+// taken from fn. A NULL fn turns streaming off
+OLIB_API bool olib_serializer_set_string_source(olib_serializer_t* serializer, olib_string_source_fn fn, void* ctx);
+
 // #############################################################################
 
 // Writing objects
@@ -102,12 +179,28 @@ OLIB_API olib_object_t* olib_serializer_read(olib_serializer_t* serializer, cons
 // olib_serializer_read_string: For text-based serializers only (returns NULL if serializer is binary)
 OLIB_API olib_object_t* olib_serializer_read_string(olib_serializer_t* serializer, const char* string);
 
+// olib_serializer_read_into: Works with both text and binary serializers. Parses into an existing tree,
+// reusing its nodes, string buffers and container arrays where the shape matches (returns false on error,
+// leaving the tree valid but partially updated)
+OLIB_API bool olib_serializer_read_into(olib_serializer_t* serializer, const uint8_t* data, size_t size, olib_object_t* existing);
+
 // olib_serializer_read_file: Works with both text and binary serializers (reads file in appropriate mode)
 OLIB_API olib_object_t* olib_serializer_read_file(olib_serializer_t* serializer, FILE* file);
 
 // olib_serializer_read_file_path: Works with both text and binary serializers (opens file in appropriate mode)
 OLIB_API olib_object_t* olib_serializer_read_file_path(olib_serializer_t* serializer, const char* file_path);
 
+// Filtered I/O
+// Work with both text and binary serializers. Encoded output is pushed through the chain on its way
+// to the buffer or file, and input is pushed through the chain before it is decoded, one block at a
+// time. A NULL chain passes data through unchanged. Filtered files are always opened in binary mode.
+OLIB_API bool olib_serializer_write_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, uint8_t** out_data, size_t* out_size);
+OLIB_API bool olib_serializer_write_file_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, FILE* file);
+OLIB_API bool olib_serializer_write_file_path_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, const char* file_path);
+OLIB_API olib_object_t* olib_serializer_read_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, const uint8_t* data, size_t size);
+OLIB_API olib_object_t* olib_serializer_read_file_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, FILE* file);
+OLIB_API olib_object_t* olib_serializer_read_file_path_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, const char* file_path);
+
 // #############################################################################
 OLIB_HEADER_END;
 // #############################################################################
\ No newline at end of file
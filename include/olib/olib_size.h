@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_object.h"
+#include "olib_serializer.h"
+#include <stdio.h>
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Encoded-size attribution.
+// A size report writes a tree with one of the built-in formats and charges every output byte
+// to the key path that produced it, split into key text, value tokens, framing and
+// whitespace. Paths are normalized: list indices and map keys collapse to "[]", so all
+// elements of a list share one entry ("users[].name"). Ranked by bytes, the report shows
+// which fields are worth compacting, dictionary coding or moving out of the schema.
+
+typedef enum olib_size_class_t {
+  OLIB_SIZE_KEY,         // Key text, quoted and escaped as written
+  OLIB_SIZE_VALUE,       // Scalar tokens, quoted and escaped as written
+  OLIB_SIZE_FRAMING,     // Type tags, lengths, brackets, separators and markup
+  OLIB_SIZE_WHITESPACE,  // Indentation and line breaks of text formats
+  OLIB_SIZE_CLASS_MAX,
+} olib_size_class_t;
+
+OLIB_API const char* olib_size_class_to_string(olib_size_class_t size_class);
+
+typedef struct olib_size_entry_t {
+  const char* path;                     // Normalized key path, "" for the root
+  uint64_t count;                       // Values written at this path
+  uint64_t bytes[OLIB_SIZE_CLASS_MAX];  // Bytes of the values themselves (their keys included), by class
+  uint64_t total;                       // Sum of bytes
+  uint64_t subtree;                     // total plus the totals of every path below this one
+} olib_size_entry_t;
+
+typedef struct olib_size_report_t olib_size_report_t;
+
+// Write obj with serializer and attribute the output. Only built-in formats can be analyzed,
+// custom serializers and failed writes return NULL. String sources are not consulted.
+OLIB_API olib_size_report_t* olib_size_report_new(olib_serializer_t* serializer, olib_object_t* obj);
+OLIB_API void olib_size_report_free(olib_size_report_t* report);
+
+// Encoded size, equal to the sum of all entries
+OLIB_API uint64_t olib_size_report_total(olib_size_report_t* report);
+OLIB_API uint64_t olib_size_report_class_total(olib_size_report_t* report, olib_size_class_t size_class);
+
+// Entries ranked by total, largest first
+OLIB_API size_t olib_size_report_count(olib_size_report_t* report);
+OLIB_API const olib_size_entry_t* olib_size_report_get(olib_size_report_t* report, size_t index);
+
+// Print the ranked table, at most limit rows (0 prints every entry)
+OLIB_API bool olib_size_report_print(olib_size_report_t* report, FILE* file, size_t limit);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,89 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_base.h"
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Embedded document store keyed by string id.
+// Documents are kept in the compact binary encoding in append-only segment files,
+// and an open-addressing hash index maps each id to the segment and offset of its
+// latest record. Segments and the index are memory-mapped, so a point lookup is one
+// hash probe plus one decode straight out of the mapping, without any file system
+// calls. Overwrites and deletes leave dead records behind that compaction reclaims,
+// either on a background thread or on request.
+// Available on Linux and macOS, olib_store_open returns NULL elsewhere.
+
+typedef struct olib_store_t olib_store_t;
+
+typedef struct olib_store_options_t {
+  size_t segment_size;     // Size of each segment file, larger documents get a segment of their own (0 = 64 MiB)
+  double compact_ratio;    // A sealed segment is compacted once this fraction of it is dead (0 = 0.5)
+  bool manual_compaction;  // Only compact in olib_store_compact, never on a background thread
+} olib_store_options_t;
+
+// Open the store in directory, creating it if needed. NULL options use the defaults
+// (caller must close with olib_store_close). If the store was not closed cleanly, the
+// index is rebuilt from the segments. Segments left due for compaction by earlier
+// sessions are compacted in the background right away. Only one store may have a
+// directory open at a time.
+OLIB_API olib_store_t* olib_store_open(const char* directory, const olib_store_options_t* options);
+
+// Wait until background compaction has compacted every due segment, flush everything to
+// disk and close the store
+OLIB_API void olib_store_close(olib_store_t* store);
+
+// Insert or replace the document stored under id
+OLIB_API bool olib_store_put(olib_store_t* store, const char* id, olib_object_t* obj);
+
+// Decode the document stored under id (caller must free), NULL if there is none
+OLIB_API olib_object_t* olib_store_get(olib_store_t* store, const char* id);
+
+// Remove the document stored under id, false if there was none
+OLIB_API bool olib_store_delete(olib_store_t* store, const char* id);
+
+// Decode the documents stored under count ids into out (caller frees each), in one
+// pass over the segments in file order. Missing ids get NULL. Returns how many were found.
+OLIB_API size_t olib_store_get_batch(olib_store_t* store, const char* const* ids, size_t count, olib_object_t** out);
+
+// Number of documents in the store
+OLIB_API size_t olib_store_count(olib_store_t* store);
+
+// Number of segment files, including the one being appended to
+OLIB_API size_t olib_store_segment_count(olib_store_t* store);
+
+// Compact every sealed segment that reached the compaction ratio, returns how many were compacted
+OLIB_API size_t olib_store_compact(olib_store_t* store);
+
+// Flush segments and index to disk
+OLIB_API bool olib_store_sync(olib_store_t* store);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_base.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Byte-stream filters placed between the format encoders/decoders and the final
+// sink or source. A chain pushes data through its filters in order, one block at
+// a time, so every transform runs in the same pass without intermediate buffers.
+
+// Size of the blocks fed into the first filter of a chain
+#define OLIB_STREAM_BLOCK_SIZE 65536
+
+// Receives the output of a filter, return false to abort the stream
+typedef bool (*olib_stream_emit_fn)(void* emit_ctx, const uint8_t* data, size_t size);
+
+typedef struct olib_stream_filter_t olib_stream_filter_t;
+typedef struct olib_stream_chain_t olib_stream_chain_t;
+
+typedef struct olib_stream_filter_config_t {
+  // Internal user data pointer for filter context
+  void* user_data;
+
+  // Lifecycle callbacks
+  void (*free_ctx)(void* ctx);  // Called when the filter is freed (optional)
+  bool (*reset)(void* ctx);     // Called before every stream (optional)
+
+  // Transform a block and pass the output to emit, any number of times (return false on error)
+  bool (*process)(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx);
+  // Emit whatever is still buffered at the end of the stream (optional)
+  bool (*finish)(void* ctx, olib_stream_emit_fn emit, void* emit_ctx);
+} olib_stream_filter_config_t;
+
+// #############################################################################
+// Filters
+// #############################################################################
+
+// Filter management (caller must free with olib_stream_filter_free unless added to a chain)
+OLIB_API olib_stream_filter_t* olib_stream_filter_new(olib_stream_filter_config_t* config);
+OLIB_API void olib_stream_filter_free(olib_stream_filter_t* filter);
+
+// Bytes that entered and left the filter during the last stream
+OLIB_API uint64_t olib_stream_filter_bytes_in(olib_stream_filter_t* filter);
+OLIB_API uint64_t olib_stream_filter_bytes_out(olib_stream_filter_t* filter);
+
+// Built-in filters
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_counter();        // Passes data through, only counts bytes
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_crc32();          // Passes data through, computes a CRC-32 (IEEE)
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_base64_encode();  // Standard alphabet with padding, no line breaks
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_base64_decode();  // Skips whitespace, fails on anything else
+
+// CRC-32 of the data that passed through a crc32 filter during the last stream
+OLIB_API uint32_t olib_stream_filter_crc32_value(olib_stream_filter_t* filter);
+
+// #############################################################################
+// Chains
+// #############################################################################
+
+// Chain management (caller must free with olib_stream_chain_free)
+OLIB_API olib_stream_chain_t* olib_stream_chain_new();
+OLIB_API void olib_stream_chain_free(olib_stream_chain_t* chain);
+
+// Append a filter, the chain takes ownership of it
+OLIB_API bool olib_stream_chain_push(olib_stream_chain_t* chain, olib_stream_filter_t* filter);
+OLIB_API size_t olib_stream_chain_size(olib_stream_chain_t* chain);
+OLIB_API olib_stream_filter_t* olib_stream_chain_get(olib_stream_chain_t* chain, size_t index);
+
+// Run a stream: begin resets every filter and sets the final sink, write pushes
+// data through the filters in OLIB_STREAM_BLOCK_SIZE blocks, end flushes them.
+OLIB_API bool olib_stream_chain_begin(olib_stream_chain_t* chain, olib_stream_emit_fn sink, void* sink_ctx);
+OLIB_API bool olib_stream_chain_write(olib_stream_chain_t* chain, const uint8_t* data, size_t size);
+OLIB_API bool olib_stream_chain_end(olib_stream_chain_t* chain);
+
+// Run a whole buffer through the chain into a new buffer (caller must free out_data with olib_free)
+OLIB_API bool olib_stream_chain_apply(olib_stream_chain_t* chain, const uint8_t* data, size_t size, uint8_t** out_data, size_t* out_size);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
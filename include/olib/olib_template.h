@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_formats.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Precompiled write templates for fixed-shape output.
+// A template is compiled once from a shape object for a text format. The keys,
+// nesting, separators and indentation the writer would emit are stored as static
+// byte fragments, and every scalar in the shape becomes a slot. Rendering copies
+// the fragments and formats only the slot values, producing the same bytes as
+// writing the values object with the format's serializer.
+
+typedef struct olib_template_t olib_template_t;
+
+// Compile a template from shape for a text format (caller must free with
+// olib_template_free). The scalar values in shape are ignored, only types, list
+// sizes and keys matter. Fails for binary formats and shapes the writer rejects.
+OLIB_API olib_template_t* olib_template_compile(olib_object_t* shape, olib_format_t format);
+OLIB_API void olib_template_free(olib_template_t* tmpl);
+
+// Number of scalar slots filled by each render
+OLIB_API size_t olib_template_slot_count(olib_template_t* tmpl);
+
+// Render values, which must have the shape the template was compiled from: the same
+// types, list sizes and keys in the same order (caller must free out_data with
+// olib_free). The output is null-terminated, out_size does not include the terminator.
+OLIB_API bool olib_template_render(olib_template_t* tmpl, olib_object_t* values, uint8_t** out_data, size_t* out_size);
+
+// Same as olib_template_render, returning the output as a string (caller must free with olib_free)
+OLIB_API bool olib_template_render_string(olib_template_t* tmpl, olib_object_t* values, char** out_string);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,125 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_formats.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Capture and replay of production workloads.
+// While a capture runs, every top-level read, write and conversion is appended to a
+// trace file with its formats and input. This covers the olib_format_*, olib_convert*
+// helpers and direct calls on the built-in serializers. Nested calls (the read inside a
+// conversion) are part of the outer record. A trace can be replayed later, on any number
+// of threads, to benchmark library changes against recorded traffic.
+
+typedef enum olib_trace_op_t {
+  OLIB_TRACE_READ,
+  OLIB_TRACE_WRITE,
+  OLIB_TRACE_CONVERT,
+  OLIB_TRACE_OP_MAX,
+} olib_trace_op_t;
+
+OLIB_API const char* olib_trace_op_to_string(olib_trace_op_t op);
+
+// #############################################################################
+// Capture
+// #############################################################################
+
+typedef struct olib_trace_capture_config_t {
+  bool anonymize;      // Rewrite inputs with the same shape but scrambled strings, keys and numbers
+  uint64_t seed;       // Salt for anonymized values, equal values map to equal values under one seed
+  uint64_t max_bytes;  // Stop recording once the trace reaches this size (0 for no limit)
+} olib_trace_capture_config_t;
+
+// Start recording every thread into a new trace file, replacing the capture in progress.
+// config may be NULL for a plain capture without a size limit.
+OLIB_API bool olib_trace_capture_start(const char* file_path, const olib_trace_capture_config_t* config);
+
+// Stop recording and close the file. Returns false when a record could not be written.
+OLIB_API bool olib_trace_capture_stop(void);
+
+// Records written by the current or last capture
+OLIB_API uint64_t olib_trace_capture_count(void);
+
+// #############################################################################
+// Reading traces
+// #############################################################################
+
+typedef struct olib_trace_record_t {
+  olib_trace_op_t op;
+  olib_format_t src_format;  // Format of data for reads and conversions, the written format for writes
+  olib_format_t dst_format;  // Format produced (the parsed format for reads)
+  const uint8_t* data;       // Input for reads and conversions, the written tree in OLIB_FORMAT_BINARY for writes
+  size_t size;               // data is null-terminated one byte past size
+} olib_trace_record_t;
+
+typedef struct olib_trace_t olib_trace_t;
+
+// Load a whole trace into memory (caller must free with olib_trace_free)
+OLIB_API olib_trace_t* olib_trace_load(const char* file_path);
+OLIB_API void olib_trace_free(olib_trace_t* trace);
+
+OLIB_API size_t olib_trace_size(olib_trace_t* trace);
+
+// Record at index, its data is owned by the trace
+OLIB_API bool olib_trace_get(olib_trace_t* trace, size_t index, olib_trace_record_t* out_record);
+
+// #############################################################################
+// Replay
+// #############################################################################
+
+typedef struct olib_trace_replay_config_t {
+  size_t threads;     // Threads replaying the trace side by side (0 runs on the calling thread only)
+  size_t iterations;  // Passes over the trace per thread (0 means 1)
+} olib_trace_replay_config_t;
+
+typedef struct olib_trace_replay_result_t {
+  size_t ops;                          // Calls made across all threads
+  size_t failures;                     // Calls that returned an error
+  size_t ops_by_kind[OLIB_TRACE_OP_MAX];
+  uint64_t bytes;                      // Bytes parsed by reads and conversions plus bytes produced by writes
+  double wall_ns;                      // From the first call to the last thread finishing
+  double ops_per_sec;
+  double bytes_per_sec;
+  double mean_ns;                      // Latency of one call
+  double p50_ns;
+  double p90_ns;
+  double p99_ns;
+  double p999_ns;
+  double max_ns;
+} olib_trace_replay_result_t;
+
+// Re-execute every record in order through the helpers. Each thread replays the whole
+// trace on its own copies of the written trees, so runs are repeatable. Trees are decoded
+// before the clock starts. config may be NULL for one pass on the calling thread.
+OLIB_API bool olib_trace_replay(olib_trace_t* trace, const olib_trace_replay_config_t* config,
+                                olib_trace_replay_result_t* out_result);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "olib_base.h"
+#include "olib_object.h"
+
+// #############################################################################
+OLIB_HEADER_BEGIN;
+// #############################################################################
+
+// Transactions over a tree.
+// While a transaction is open, the olib_object_set_*, olib_object_list_* and
+// olib_object_struct_* mutators log compact undo entries: old scalar values, and the
+// children and keys they displace, which are kept alive instead of freed. Rollback
+// replays the log in reverse, commit frees what was displaced. Both cost the size of
+// the edit rather than a copy of the tree.
+// Transactions use the node marking of an observer, so the root must have one. Then
+// olib_txn_begin is constant time, the edits to the observed nodes are logged whichever
+// thread makes them, and the observer's subscribers get the changes of a committed
+// transaction as one batch, and nothing for a rolled back one.
+// olib_object_list_split and olib_object_list_concat fail on lists in an open
+// transaction. Nodes of the tree must not be freed directly while it is open.
+
+typedef struct olib_txn_t olib_txn_t;
+
+// Open a transaction on the tree under root. Returns NULL if root has no observer, if
+// the tree already has an open transaction, or if root is inside a tree observed from a
+// different root.
+OLIB_API olib_txn_t* olib_txn_begin(olib_object_t* root);
+
+// Keep every change and release the transaction
+OLIB_API void olib_txn_commit(olib_txn_t* txn);
+
+// Undo every change in reverse order and release the transaction
+OLIB_API void olib_txn_rollback(olib_txn_t* txn);
+
+// Number of undo entries logged so far
+OLIB_API size_t olib_txn_undo_count(olib_txn_t* txn);
+
+// #############################################################################
+OLIB_HEADER_END;
+// #############################################################################
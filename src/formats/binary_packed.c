@@ -0,0 +1,340 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "binary_packed.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define PACKED_TAG_INT   0x01
+#define PACKED_TAG_UINT  0x02
+#define PACKED_TAG_FLOAT 0x03
+
+// #############################################################################
+// Bit helpers
+// #############################################################################
+
+// Leading and trailing zero counts, x must not be zero
+static unsigned packed_clz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_clzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanReverse64(&index, x);
+  return 63u - (unsigned)index;
+#else
+  unsigned n = 0;
+  while (!(x & (1ULL << 63))) {
+    x <<= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+static unsigned packed_ctz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return (unsigned)index;
+#else
+  unsigned n = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+static uint64_t packed_load_u64(const uint8_t* p) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= (uint64_t)p[i] << (i * 8);
+  }
+  return value;
+}
+
+static uint64_t packed_zigzag(uint64_t value) {
+  return (value << 1) ^ (0 - (value >> 63));
+}
+
+static uint64_t packed_unzigzag(uint64_t value) {
+  return (value >> 1) ^ (0 - (value & 1));
+}
+
+// MSB-first bit writer; acc holds fewer than 8 pending bits between calls
+typedef struct {
+  uint8_t* out;
+  size_t capacity;
+  size_t pos;
+  uint64_t acc;
+  unsigned bits;
+} packed_bit_writer_t;
+
+static bool packed_put_bits(packed_bit_writer_t* w, uint64_t value, unsigned n) {
+  if (n > 32) {
+    if (!packed_put_bits(w, value >> 32, n - 32)) return false;
+    n = 32;
+  }
+  w->acc = (w->acc << n) | (value & ((1ULL << n) - 1));
+  w->bits += n;
+  while (w->bits >= 8) {
+    if (w->pos == w->capacity) return false;
+    w->bits -= 8;
+    w->out[w->pos++] = (uint8_t)(w->acc >> w->bits);
+  }
+  w->acc &= (1ULL << w->bits) - 1;
+  return true;
+}
+
+static bool packed_flush_bits(packed_bit_writer_t* w) {
+  if (w->bits == 0) return true;
+  return packed_put_bits(w, 0, 8 - w->bits);
+}
+
+// MSB-first bit reader, reads of up to 32 bits
+typedef struct {
+  const uint8_t* data;
+  size_t len;
+  size_t pos;
+  uint64_t acc;
+  unsigned bits;
+} packed_bit_reader_t;
+
+static bool packed_get_bits(packed_bit_reader_t* r, unsigned n, uint64_t* out) {
+  while (r->bits <= 56 && r->pos < r->len) {
+    r->acc = (r->acc << 8) | r->data[r->pos++];
+    r->bits += 8;
+  }
+  if (r->bits < n) return false;
+  r->bits -= n;
+  *out = (r->acc >> r->bits) & ((1ULL << n) - 1);
+  return true;
+}
+
+static bool packed_get_u64(packed_bit_reader_t* r, unsigned n, uint64_t* out) {
+  uint64_t high = 0;
+  uint64_t low;
+  if (n > 32) {
+    if (!packed_get_bits(r, n - 32, &high)) return false;
+    n = 32;
+  }
+  if (!packed_get_bits(r, n, &low)) return false;
+  *out = (high << 32) | low;
+  return true;
+}
+
+// #############################################################################
+// Delta-of-delta varints (INT, UINT)
+// #############################################################################
+
+static bool packed_encode_dod(const uint8_t* elems, size_t count, size_t stride,
+                              uint8_t* out, size_t capacity, size_t* out_len) {
+  size_t pos = 0;
+  uint64_t prev = 0;
+  uint64_t prev_delta = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t value = packed_load_u64(elems + i * stride + 1);
+    uint64_t delta = value - prev;
+    uint64_t zz = packed_zigzag(delta - prev_delta);
+    while (zz >= 0x80) {
+      if (pos == capacity) return false;
+      out[pos++] = (uint8_t)(zz | 0x80);
+      zz >>= 7;
+    }
+    if (pos == capacity) return false;
+    out[pos++] = (uint8_t)zz;
+    prev = value;
+    prev_delta = i == 0 ? 0 : delta;
+  }
+  *out_len = pos;
+  return true;
+}
+
+static bool packed_decode_dod(const uint8_t* data, size_t len, size_t count, uint64_t* out) {
+  size_t pos = 0;
+  uint64_t prev = 0;
+  uint64_t prev_delta = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t zz;
+    // Regular series are mostly single-byte deltas-of-deltas
+    if (pos < len && data[pos] < 0x80) {
+      zz = data[pos++];
+    } else {
+      zz = 0;
+      for (unsigned shift = 0;; shift += 7) {
+        if (pos == len || shift > 63) return false;
+        uint8_t byte = data[pos++];
+        if (shift == 63 && byte > 1) return false;
+        zz |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+      }
+    }
+    uint64_t delta = prev_delta + packed_unzigzag(zz);
+    prev += delta;
+    out[i] = prev;
+    prev_delta = i == 0 ? 0 : delta;
+  }
+  return pos == len;
+}
+
+// #############################################################################
+// Gorilla XOR (FLOAT)
+// #############################################################################
+
+// Control bits after the first value: '0' same value, '10' meaningful bits in the
+// previous window, '11' 5-bit leading zero count, 6-bit length - 1, meaningful bits
+static bool packed_encode_gorilla(const uint8_t* elems, size_t count, size_t stride,
+                                  uint8_t* out, size_t capacity, size_t* out_len) {
+  packed_bit_writer_t w = {out, capacity, 0, 0, 0};
+  uint64_t prev = 0;
+  unsigned lead = 0;
+  unsigned trail = 0;
+  bool has_window = false;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t value = packed_load_u64(elems + i * stride + 1);
+    if (i == 0) {
+      if (!packed_put_bits(&w, value, 64)) return false;
+      prev = value;
+      continue;
+    }
+    uint64_t x = value ^ prev;
+    prev = value;
+    if (x == 0) {
+      if (!packed_put_bits(&w, 0, 1)) return false;
+      continue;
+    }
+    unsigned x_lead = packed_clz(x);
+    unsigned x_trail = packed_ctz(x);
+    if (x_lead > 31) x_lead = 31;
+    if (has_window && x_lead >= lead && x_trail >= trail) {
+      if (!packed_put_bits(&w, 2, 2)) return false;
+      if (!packed_put_bits(&w, x >> trail, 64 - lead - trail)) return false;
+      continue;
+    }
+    lead = x_lead;
+    trail = x_trail;
+    has_window = true;
+    unsigned sig = 64 - lead - trail;
+    if (!packed_put_bits(&w, 3, 2)) return false;
+    if (!packed_put_bits(&w, lead, 5)) return false;
+    if (!packed_put_bits(&w, sig - 1, 6)) return false;
+    if (!packed_put_bits(&w, x >> trail, sig)) return false;
+  }
+  if (!packed_flush_bits(&w)) return false;
+  *out_len = w.pos;
+  return true;
+}
+
+static bool packed_decode_gorilla(const uint8_t* data, size_t len, size_t count, uint64_t* out) {
+  packed_bit_reader_t r = {data, len, 0, 0, 0};
+  uint64_t prev = 0;
+  unsigned lead = 0;
+  unsigned trail = 0;
+  bool has_window = false;
+  for (size_t i = 0; i < count; i++) {
+    if (i == 0) {
+      if (!packed_get_u64(&r, 64, &prev)) return false;
+      out[0] = prev;
+      continue;
+    }
+    uint64_t bit;
+    if (!packed_get_bits(&r, 1, &bit)) return false;
+    if (bit) {
+      if (!packed_get_bits(&r, 1, &bit)) return false;
+      if (bit) {
+        uint64_t new_lead;
+        uint64_t sig;
+        if (!packed_get_bits(&r, 5, &new_lead) || !packed_get_bits(&r, 6, &sig)) return false;
+        if (new_lead + sig + 1 > 64) return false;
+        lead = (unsigned)new_lead;
+        trail = 64 - lead - (unsigned)(sig + 1);
+        has_window = true;
+      } else if (!has_window) {
+        return false;
+      }
+      uint64_t meaningful;
+      if (!packed_get_u64(&r, 64 - lead - trail, &meaningful)) return false;
+      prev ^= meaningful << trail;
+    }
+    out[i] = prev;
+  }
+  // Only the zero padding of the last byte may be left
+  return r.pos == len && r.bits < 8 && (r.acc & ((1ULL << r.bits) - 1)) == 0;
+}
+
+// #############################################################################
+// Public functions
+// #############################################################################
+
+bool binary_packed_encode(uint8_t tag, const uint8_t* elems, size_t count, size_t stride,
+                          uint8_t* out, size_t out_capacity, size_t* out_len) {
+  if (!elems || !out || !out_len || count == 0) {
+    return false;
+  }
+  switch (tag) {
+    case PACKED_TAG_INT:
+    case PACKED_TAG_UINT:
+      return packed_encode_dod(elems, count, stride, out, out_capacity, out_len);
+    case PACKED_TAG_FLOAT:
+      return packed_encode_gorilla(elems, count, stride, out, out_capacity, out_len);
+    default:
+      return false;
+  }
+}
+
+size_t binary_packed_max_count(uint8_t tag, size_t len) {
+  switch (tag) {
+    case PACKED_TAG_INT:
+    case PACKED_TAG_UINT:
+      return len;  // At least one byte per value
+    case PACKED_TAG_FLOAT:
+      // 64 bits for the first value, at least one bit for each one after it
+      if (len < 8) return 0;
+      if (len - 8 > (SIZE_MAX - 1) / 8) return SIZE_MAX;
+      return 1 + (len - 8) * 8;
+    default:
+      return 0;
+  }
+}
+
+bool binary_packed_decode(uint8_t tag, const uint8_t* data, size_t len, size_t count, uint64_t* out) {
+  if (!data || !out || count == 0 || count > binary_packed_max_count(tag, len)) {
+    return false;
+  }
+  switch (tag) {
+    case PACKED_TAG_INT:
+    case PACKED_TAG_UINT:
+      return packed_decode_dod(data, len, count, out);
+    case PACKED_TAG_FLOAT:
+      return packed_decode_gorilla(data, len, count, out);
+    default:
+      return false;
+  }
+}
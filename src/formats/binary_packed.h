@@ -0,0 +1,59 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Packed numeric lists for OLIB_FORMAT_BINARY. A list whose elements are all INT,
+// all UINT or all FLOAT can be written as tag 0x08, the element tag (1 byte), the
+// element count (4 bytes), the payload length (4 bytes) and the payload:
+//   INT/UINT: zigzag varints of the delta-of-delta of each value (the first value
+//             and the first delta are stored as is), wrapping mod 2^64
+//   FLOAT:    Gorilla XOR compression, bits written MSB first, zero padded
+
+#define BINARY_PACKED_HEADER_SIZE 10
+
+// #############################################################################
+// Encoding
+// #############################################################################
+
+// Encode count values read as little-endian u64 at elems + i * stride into out.
+// Fails (without writing past out_capacity) if the payload does not fit, so a
+// capacity below the plain size stops early on data that does not compress.
+bool binary_packed_encode(uint8_t tag, const uint8_t* elems, size_t count, size_t stride,
+                          uint8_t* out, size_t out_capacity, size_t* out_len);
+
+// #############################################################################
+// Decoding
+// #############################################################################
+
+// Largest count a payload of len bytes can hold, used to reject headers before allocating
+size_t binary_packed_max_count(uint8_t tag, size_t len);
+
+// Decode exactly count values from a payload of exactly len bytes into out (raw u64 bits)
+bool binary_packed_decode(uint8_t tag, const uint8_t* data, size_t len, size_t count, uint64_t* out);
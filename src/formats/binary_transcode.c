@@ -0,0 +1,267 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "binary_transcode.h"
+#include <string.h>
+
+// #############################################################################
+// Wire format
+// #############################################################################
+
+#define TRANSCODE_TAG_INT    0x01  // int64 (8 bytes)
+#define TRANSCODE_TAG_UINT   0x02  // uint64 (8 bytes)
+#define TRANSCODE_TAG_FLOAT  0x03  // double (8 bytes)
+#define TRANSCODE_TAG_STRING 0x04  // 4-byte length + bytes
+#define TRANSCODE_TAG_BOOL   0x05  // 1 byte
+#define TRANSCODE_TAG_LIST   0x06  // 4-byte count + elements
+#define TRANSCODE_TAG_STRUCT 0x07  // (4-byte key length + key + value)*, 4-byte zero
+
+// Open container on the walk stack
+typedef struct {
+  uint32_t remaining;  // Items left in a list
+  bool is_struct;
+} transcode_frame_t;
+
+typedef struct {
+  const uint8_t* src;
+  size_t size;
+  size_t pos;
+  uint8_t* out;
+  size_t copied;  // Source bytes already copied to out
+
+  transcode_frame_t* stack;
+  size_t depth;
+  size_t stack_capacity;
+} transcode_ctx_t;
+
+static uint32_t transcode_u32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool transcode_push(transcode_ctx_t* c, uint32_t remaining, bool is_struct) {
+  if (c->depth == c->stack_capacity) {
+    size_t new_capacity = c->stack_capacity ? c->stack_capacity * 2 : 32;
+    transcode_frame_t* new_stack = olib_realloc(c->stack, new_capacity * sizeof(transcode_frame_t));
+    if (!new_stack) return false;
+    c->stack = new_stack;
+    c->stack_capacity = new_capacity;
+  }
+  c->stack[c->depth].remaining = remaining;
+  c->stack[c->depth].is_struct = is_struct;
+  c->depth++;
+  return true;
+}
+
+// Copy the pending source run up to (not including) pos into the output
+static void transcode_flush(transcode_ctx_t* c, size_t pos) {
+  memcpy(c->out + c->copied, c->src + c->copied, pos - c->copied);
+  c->copied = pos;
+}
+
+// #############################################################################
+// Walk
+// #############################################################################
+
+// Skip one value header (and the payload of scalars). Containers are pushed onto
+// the stack; out_complete reports whether the value is finished after this step.
+static bool transcode_value(transcode_ctx_t* c, bool* out_complete) {
+  size_t left = c->size - c->pos;
+  if (left < 1) return false;
+
+  *out_complete = true;
+  switch (c->src[c->pos]) {
+    case TRANSCODE_TAG_INT:
+    case TRANSCODE_TAG_UINT:
+    case TRANSCODE_TAG_FLOAT:
+      if (left < 9) return false;
+      c->pos += 9;
+      return true;
+    case TRANSCODE_TAG_STRING: {
+      if (left < 5) return false;
+      uint32_t len = transcode_u32(c->src + c->pos + 1);
+      if (len > left - 5) return false;
+      c->pos += 5 + (size_t)len;
+      return true;
+    }
+    case TRANSCODE_TAG_BOOL: {
+      if (left < 2) return false;
+      size_t payload = c->pos + 1;
+      if (c->src[payload] > 1) {
+        transcode_flush(c, payload);
+        c->out[payload] = 1;
+        c->copied = payload + 1;
+      }
+      c->pos += 2;
+      return true;
+    }
+    case TRANSCODE_TAG_LIST: {
+      if (left < 5) return false;
+      uint32_t count = transcode_u32(c->src + c->pos + 1);
+      c->pos += 5;
+      if (count == 0) return true;
+      *out_complete = false;
+      return transcode_push(c, count, false);
+    }
+    case TRANSCODE_TAG_STRUCT:
+      c->pos += 1;
+      *out_complete = false;
+      return transcode_push(c, 0, true);
+    default:
+      return false;
+  }
+}
+
+// After a value (or a struct header), close finished containers and position pos
+// at the next value. Returns false on malformed input, sets out_done at the end.
+static bool transcode_advance(transcode_ctx_t* c, bool* out_done) {
+  while (c->depth > 0) {
+    transcode_frame_t* top = &c->stack[c->depth - 1];
+    if (top->is_struct) {
+      if (c->size - c->pos < 4) return false;
+      uint32_t len = transcode_u32(c->src + c->pos);
+      c->pos += 4;
+      if (len == 0) {
+        c->depth--;
+        continue;
+      }
+      if (len > c->size - c->pos) return false;
+      c->pos += len;
+      return true;
+    }
+    if (--top->remaining > 0) {
+      return true;
+    }
+    c->depth--;
+  }
+  *out_done = true;
+  return true;
+}
+
+// #############################################################################
+// Public functions
+// #############################################################################
+
+bool binary_transcode_supported(olib_format_t src_format, olib_format_t dst_format) {
+  bool src_binary = src_format == OLIB_FORMAT_BINARY || src_format == OLIB_FORMAT_JSON_BINARY;
+  bool dst_binary = dst_format == OLIB_FORMAT_BINARY || dst_format == OLIB_FORMAT_JSON_BINARY;
+  return src_binary && dst_binary;
+}
+
+bool binary_transcode_into(const uint8_t* data, size_t size, uint8_t* out, size_t* out_size) {
+  if (!data || size == 0 || !out || !out_size) {
+    return false;
+  }
+
+  transcode_ctx_t c = {0};
+  c.src = data;
+  c.size = size;
+  c.out = out;
+
+  // Lists with a huge count still fail on the first missing byte, so the walk is
+  // bounded by the input size; the stack grows with nesting depth only
+  bool done = false;
+  bool ok = true;
+  while (ok && !done) {
+    bool complete;
+    ok = transcode_value(&c, &complete);
+    if (ok && (complete || c.stack[c.depth - 1].is_struct)) {
+      ok = transcode_advance(&c, &done);
+    }
+  }
+  olib_free(c.stack);
+
+  if (!ok) {
+    return false;
+  }
+
+  transcode_flush(&c, c.pos);
+  *out_size = c.pos;
+  return true;
+}
+
+bool binary_transcode(const uint8_t* data, size_t size, uint8_t** out_data, size_t* out_size) {
+  if (!data || size == 0 || !out_data || !out_size) {
+    return false;
+  }
+
+  uint8_t* out = olib_malloc(size);
+  if (!out) {
+    return false;
+  }
+  if (!binary_transcode_into(data, size, out, out_size)) {
+    olib_free(out);
+    return false;
+  }
+  *out_data = out;
+  return true;
+}
+
+bool binary_transcode_merge(const uint8_t* const* data, const size_t* sizes, size_t count, uint8_t** out_data, size_t* out_size) {
+  if (!data || !sizes || !out_data || !out_size) {
+    return false;
+  }
+
+  // Every input shrinks or stays the same size, so one allocation covers the output
+  size_t capacity = 5;
+  for (size_t i = 0; i < count; i++) {
+    if (sizes[i] > SIZE_MAX - capacity) return false;
+    capacity += sizes[i];
+  }
+  uint8_t* out = olib_malloc(capacity);
+  if (!out) {
+    return false;
+  }
+
+  size_t pos = 5;
+  uint64_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t len;
+    if (!binary_transcode_into(data[i], sizes[i], out + pos, &len)) {
+      olib_free(out);
+      return false;
+    }
+    if (out[pos] == TRANSCODE_TAG_LIST) {
+      // Drop the list header, the elements follow it directly
+      total += transcode_u32(out + pos + 1);
+      memmove(out + pos, out + pos + 5, len - 5);
+      len -= 5;
+    } else {
+      total += 1;
+    }
+    if (total > UINT32_MAX) {
+      olib_free(out);
+      return false;
+    }
+    pos += len;
+  }
+
+  out[0] = TRANSCODE_TAG_LIST;
+  out[1] = (uint8_t)total;
+  out[2] = (uint8_t)(total >> 8);
+  out[3] = (uint8_t)(total >> 16);
+  out[4] = (uint8_t)(total >> 24);
+  *out_data = out;
+  *out_size = pos;
+  return true;
+}
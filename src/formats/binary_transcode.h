@@ -0,0 +1,53 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// OLIB_FORMAT_BINARY and OLIB_FORMAT_JSON_BINARY use the same tags and the same
+// framing on the wire, so converting between them never needs an object tree.
+
+// #############################################################################
+// Transcoding
+// #############################################################################
+
+// Check whether data in src_format can be transcoded to dst_format with binary_transcode
+bool binary_transcode_supported(olib_format_t src_format, olib_format_t dst_format);
+
+// Validate the value at the start of data in a single linear pass and copy it to a new
+// buffer (caller must free out_data with olib_free). Bytes past the value are dropped
+// and bool payloads are normalized to 0/1, matching what a read/write round trip emits.
+bool binary_transcode(const uint8_t* data, size_t size, uint8_t** out_data, size_t* out_size);
+
+// Same as binary_transcode but writes to out, which must hold at least size bytes
+bool binary_transcode_into(const uint8_t* data, size_t size, uint8_t* out, size_t* out_size);
+
+// Splice several inputs into one list value without building a tree (caller must free
+// out_data with olib_free). A list input contributes its elements, any other value is
+// appended as a single element. Every input is validated like binary_transcode.
+bool binary_transcode_merge(const uint8_t* const* data, const size_t* sizes, size_t count, uint8_t** out_data, size_t* out_size);
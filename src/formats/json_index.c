@@ -0,0 +1,398 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "json_index.h"
+#include "../olib_thread.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// Input is classified 64 bytes at a time into one bit per byte
+#define JSON_BLOCK_SIZE 64
+
+typedef struct {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t structural;  // { } [ ] , :
+} json_block_t;
+
+typedef struct {
+  size_t begin;
+  size_t end;
+  bool escaped;    // First byte is escaped by a backslash run in the previous chunk
+  bool odd_quotes;
+  size_t counts[2];  // Structurals emitted when starting outside / inside a string
+  bool in_string;    // Set by the prefix pass
+  size_t offset;     // Where the chunk writes into the index
+} json_chunk_t;
+
+typedef struct {
+  const char* data;
+  json_chunk_t* chunks;
+  size_t* positions;
+} json_scan_t;
+
+// #############################################################################
+// Bit helpers
+// #############################################################################
+
+static unsigned json_popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_popcountll(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Trailing zero count, x must not be zero
+static unsigned json_ctz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return (unsigned)index;
+#else
+  unsigned n = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+static uint64_t json_load_u64(const uint8_t* p) {
+  return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+         ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+#define JSON_ONES 0x0101010101010101ULL
+#define JSON_LOW7 0x7F7F7F7F7F7F7F7FULL
+
+// 0x80 in every byte of word equal to c, exact (no carries between bytes)
+static uint64_t json_match(uint64_t word, uint8_t c) {
+  uint64_t t = word ^ (JSON_ONES * c);
+  return ~(((t & JSON_LOW7) + JSON_LOW7) | t | JSON_LOW7);
+}
+
+// Gather the high bit of every byte into the low 8 bits, byte i to bit i
+static uint64_t json_gather(uint64_t high_bits) {
+  return ((high_bits >> 7) * 0x0102040810204080ULL) >> 56 & 0xFF;
+}
+
+// Bit i set when an odd number of bits at or below i are set
+static uint64_t json_prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+// #############################################################################
+// Block classification
+// #############################################################################
+
+static void json_classify(const uint8_t* block, json_block_t* out) {
+  out->quote = 0;
+  out->backslash = 0;
+  out->structural = 0;
+  for (unsigned i = 0; i < JSON_BLOCK_SIZE; i += 8) {
+    uint64_t word = json_load_u64(block + i);
+    out->quote |= json_gather(json_match(word, '"')) << i;
+    out->backslash |= json_gather(json_match(word, '\\')) << i;
+    // '[' and ']' differ from '{' and '}' only in bit 5
+    uint64_t folded = word | (JSON_ONES * 0x20);
+    uint64_t hits = json_match(folded, '{') | json_match(folded, '}') | json_match(word, ',') | json_match(word, ':');
+    out->structural |= json_gather(hits) << i;
+  }
+}
+
+// Classify the block at pos, padding past end with spaces
+static void json_classify_at(const uint8_t* data, size_t pos, size_t end, json_block_t* out) {
+  if (end - pos >= JSON_BLOCK_SIZE) {
+    json_classify(data + pos, out);
+    return;
+  }
+  uint8_t padded[JSON_BLOCK_SIZE];
+  memset(padded, ' ', sizeof(padded));
+  memcpy(padded, data + pos, end - pos);
+  json_classify(padded, out);
+}
+
+// Bytes escaped by a backslash. Every backslash escapes the next byte unless it is
+// escaped itself, carry holds whether the first byte of the next block is escaped.
+static uint64_t json_escaped(uint64_t backslash, bool* carry) {
+  uint64_t escaped = *carry ? 1 : 0;
+  backslash &= ~escaped;
+  *carry = false;
+  while (backslash) {
+    uint64_t bit = backslash & (~backslash + 1);
+    if (bit >> 63) {
+      *carry = true;
+    }
+    escaped |= bit << 1;
+    backslash &= ~(bit | (bit << 1));
+  }
+  return escaped;
+}
+
+// #############################################################################
+// Stage 1: per-chunk scans
+// #############################################################################
+
+// A chunk starts escaped when it is preceded by an odd run of backslashes
+static bool json_starts_escaped(const char* data, size_t begin) {
+  size_t run = 0;
+  while (run < begin && data[begin - run - 1] == '\\') {
+    run++;
+  }
+  return (run & 1) != 0;
+}
+
+// First pass: the quote parity of the chunk, and how many structurals the second
+// pass will find for either in-string state at the chunk start
+static void json_count_structurals(void* ctx, size_t index) {
+  json_scan_t* scan = (json_scan_t*)ctx;
+  json_chunk_t* chunk = &scan->chunks[index];
+  const uint8_t* data = (const uint8_t*)scan->data;
+
+  chunk->escaped = json_starts_escaped(scan->data, chunk->begin);
+  bool carry = chunk->escaped;
+  uint64_t in_string = 0;  // Assuming the chunk starts outside a string
+  size_t outside = 0;
+  size_t inside = 0;
+  for (size_t pos = chunk->begin; pos < chunk->end; pos += JSON_BLOCK_SIZE) {
+    json_block_t block;
+    json_classify_at(data, pos, chunk->end, &block);
+    uint64_t escaped = json_escaped(block.backslash, &carry);
+    uint64_t quote = block.quote & ~escaped;
+    uint64_t string_mask = json_prefix_xor(quote) ^ in_string;
+    in_string = (uint64_t)((int64_t)string_mask >> 63);
+    uint64_t structural = block.structural & ~escaped;
+    unsigned quotes = json_popcount(quote);
+    outside += quotes + json_popcount(structural & ~string_mask);
+    inside += quotes + json_popcount(structural & string_mask);
+  }
+  chunk->odd_quotes = in_string != 0;
+  chunk->counts[0] = outside;
+  chunk->counts[1] = inside;
+}
+
+// Second pass: write the structural offsets of the chunk into its slice of the index
+static void json_emit_structurals(void* ctx, size_t index) {
+  json_scan_t* scan = (json_scan_t*)ctx;
+  json_chunk_t* chunk = &scan->chunks[index];
+  const uint8_t* data = (const uint8_t*)scan->data;
+
+  bool carry = chunk->escaped;
+  uint64_t in_string = chunk->in_string ? ~0ULL : 0;
+  size_t* out = scan->positions + chunk->offset;
+  for (size_t pos = chunk->begin; pos < chunk->end; pos += JSON_BLOCK_SIZE) {
+    json_block_t block;
+    json_classify_at(data, pos, chunk->end, &block);
+    uint64_t escaped = json_escaped(block.backslash, &carry);
+    uint64_t quote = block.quote & ~escaped;
+
+    // Inside a string from the opening quote up to, not including, the closing one
+    uint64_t string_mask = json_prefix_xor(quote) ^ in_string;
+    in_string = (uint64_t)((int64_t)string_mask >> 63);
+    uint64_t bits = (block.structural & ~string_mask & ~escaped) | quote;
+    while (bits) {
+      *out++ = pos + json_ctz(bits);
+      bits &= bits - 1;
+    }
+  }
+}
+
+// #############################################################################
+// Bracket matching
+// #############################################################################
+
+typedef struct {
+  size_t list;  // Slot in index->lists, SIZE_MAX for structs
+  size_t commas;
+  bool has_content;
+} json_open_t;
+
+// A list without nested values may still hold scalars, which are not structural
+static bool json_has_scalar(const char* data, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    char ch = data[i];
+    if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r' && ch != ',') {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool json_count_lists(json_index_t* index, const char* data) {
+  json_open_t* stack = NULL;
+  size_t depth = 0;
+  size_t stack_capacity = 0;
+  size_t list_capacity = 0;
+
+  for (size_t i = 0; i < index->count; i++) {
+    size_t pos = index->positions[i];
+    char ch = data[pos];
+    json_open_t* top = depth > 0 ? &stack[depth - 1] : NULL;
+
+    if (ch == ',') {
+      if (top) top->commas++;
+      continue;
+    }
+    if (ch == ':') {
+      continue;
+    }
+    if (ch == '"') {
+      if (top) top->has_content = true;
+      i++;  // Skip the closing quote
+      continue;
+    }
+    if (ch == '[' || ch == '{') {
+      if (top) top->has_content = true;
+      if (depth == stack_capacity) {
+        size_t new_capacity = stack_capacity ? stack_capacity * 2 : 64;
+        json_open_t* new_stack = olib_realloc(stack, new_capacity * sizeof(json_open_t));
+        if (!new_stack) {
+          olib_free(stack);
+          return false;
+        }
+        stack = new_stack;
+        stack_capacity = new_capacity;
+      }
+      json_open_t* open = &stack[depth++];
+      open->list = SIZE_MAX;
+      open->commas = 0;
+      open->has_content = false;
+      if (ch == '[') {
+        if (index->list_count == list_capacity) {
+          size_t new_capacity = list_capacity ? list_capacity * 2 : 256;
+          json_index_list_t* new_lists = olib_realloc(index->lists, new_capacity * sizeof(json_index_list_t));
+          if (!new_lists) {
+            olib_free(stack);
+            return false;
+          }
+          index->lists = new_lists;
+          list_capacity = new_capacity;
+        }
+        open->list = index->list_count++;
+        index->lists[open->list].pos = pos;
+        index->lists[open->list].count = 0;
+      }
+      continue;
+    }
+
+    // Closing bracket, unbalanced input is left for the parser to reject
+    if (!top) {
+      continue;
+    }
+    depth--;
+    if (top->list != SIZE_MAX) {
+      json_index_list_t* list = &index->lists[top->list];
+      bool has_content = top->has_content || json_has_scalar(data, list->pos + 1, pos);
+      list->count = top->commas + (has_content ? 1 : 0);
+    }
+  }
+
+  // Lists left open are counted up to the end of the input
+  while (depth > 0) {
+    json_open_t* top = &stack[--depth];
+    if (top->list != SIZE_MAX) {
+      index->lists[top->list].count = top->commas + (top->has_content ? 1 : 0);
+    }
+  }
+  olib_free(stack);
+  return true;
+}
+
+// #############################################################################
+// Public functions
+// #############################################################################
+
+bool json_index_build(json_index_t* index, const char* data, size_t size, size_t thread_count) {
+  if (!index || !data) {
+    return false;
+  }
+  size_t chunk_count = size / JSON_INDEX_MIN_CHUNK;
+  if (chunk_count > thread_count) chunk_count = thread_count;
+  if (chunk_count == 0) chunk_count = 1;
+
+  json_chunk_t* chunks = olib_calloc(chunk_count, sizeof(json_chunk_t));
+  if (!chunks) {
+    return false;
+  }
+  size_t chunk_size = size / chunk_count;
+  for (size_t i = 0; i < chunk_count; i++) {
+    chunks[i].begin = i * chunk_size;
+    chunks[i].end = i + 1 == chunk_count ? size : (i + 1) * chunk_size;
+  }
+  json_scan_t scan = {data, chunks, NULL};
+
+  // Prefix pass: the in-string state and output offset of every chunk
+  olib_thread_parallel_for(chunk_count, json_count_structurals, &scan);
+  bool in_string = false;
+  size_t total = 0;
+  for (size_t i = 0; i < chunk_count; i++) {
+    chunks[i].in_string = in_string;
+    chunks[i].offset = total;
+    total += chunks[i].counts[in_string ? 1 : 0];
+    in_string ^= chunks[i].odd_quotes;
+  }
+
+  index->positions = olib_malloc((total ? total : 1) * sizeof(size_t));
+  if (index->positions) {
+    scan.positions = index->positions;
+    index->count = total;
+    olib_thread_parallel_for(chunk_count, json_emit_structurals, &scan);
+  }
+  olib_free(chunks);
+
+  if (!index->positions || !json_count_lists(index, data)) {
+    json_index_free(index);
+    return false;
+  }
+  return true;
+}
+
+void json_index_free(json_index_t* index) {
+  if (!index) {
+    return;
+  }
+  olib_free(index->positions);
+  olib_free(index->lists);
+  memset(index, 0, sizeof(*index));
+}
@@ -0,0 +1,58 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Structural index for OLIB_FORMAT_JSON_TEXT. Stage 1 splits the input into chunks
+// and scans them in parallel, 64 bytes at a time as bit masks: a first pass finds the
+// quote parity of every chunk and its structural count for either in-string state at
+// its start, a prefix pass fixes up the state and output offset of every chunk, and a
+// second pass writes the offsets of every unescaped quote and of every { } [ ] , :
+// outside strings. A serial pass over the offsets then pairs up brackets and counts
+// list elements. The parser (stage 2) uses the index for list sizes and string bounds
+// instead of rescanning the bytes.
+
+// Inputs are split into chunks of at least this many bytes, one per thread
+#define JSON_INDEX_MIN_CHUNK (256 * 1024)
+
+typedef struct {
+  size_t pos;    // Offset of the '['
+  size_t count;  // Number of elements, counted like the scanning parser does
+} json_index_list_t;
+
+typedef struct {
+  size_t* positions;  // Offsets of structural characters, ascending
+  size_t count;
+  json_index_list_t* lists;  // Every list in document order
+  size_t list_count;
+} json_index_t;
+
+// Build the index with up to thread_count threads (must start zeroed, free with json_index_free)
+bool json_index_build(json_index_t* index, const char* data, size_t size, size_t thread_count);
+void json_index_free(json_index_t* index);
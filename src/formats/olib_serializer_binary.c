@@ -23,6 +23,9 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
+#include "binary_packed.h"
 #include <string.h>
 
 // #############################################################################
@@ -36,71 +39,83 @@ SOFTWARE.
 #define BINARY_TAG_BOOL   0x05
 #define BINARY_TAG_LIST  0x06
 #define BINARY_TAG_STRUCT 0x07
+#define BINARY_TAG_PACKED 0x08  // Packed numeric list, see binary_packed.h
+#define BINARY_TAG_MAP    0x09  // Varint count, then zigzag varint key / value pairs
+
+#define BINARY_PACK_MIN_COUNT 8
 
 // #############################################################################
 // Context structure for binary serialization
 // #############################################################################
 
+// Open container while writing with pack_lists enabled
+typedef struct {
+  size_t start;      // Offset of the list tag
+  uint8_t elem_tag;  // Tag shared by every element so far, 0 before the first
+  bool packable;     // List whose elements are all the same numeric type
+} binary_frame_t;
+
 typedef struct {
   // Write mode
-  uint8_t* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
+
+  // Packed numeric lists, write mode
+  bool pack_lists;
+  size_t pack_min_count;
+  binary_frame_t* frames;
+  size_t frame_count;
+  size_t frame_capacity;
+  uint8_t* pack_buffer;
+  size_t pack_capacity;
+
+  // Length field of the string being written in pieces
+  size_t chunk_start;
 
   // Read mode
   const uint8_t* read_buffer;
   size_t read_size;
   size_t read_pos;
 
+  // Bytes left of the string being read in pieces
+  size_t chunk_remaining;
+  bool chunk_active;
+
   // Temporary string storage for read_string/read_struct_key
   char* temp_string;
   size_t temp_string_capacity;
+
+  // Packed list being read, read_list_begin decodes every value up front
+  uint64_t* packed_values;
+  size_t packed_capacity;
+  size_t packed_count;
+  size_t packed_pos;
+  uint8_t packed_tag;
+  bool packed_active;
 } binary_ctx_t;
 
 // #############################################################################
 // Endian-independent encoding helpers (little-endian wire format)
 // #############################################################################
 
-static bool binary_ensure_write_capacity(binary_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  uint8_t* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool binary_write_u8(binary_ctx_t* ctx, uint8_t value) {
-  if (!binary_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = value;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = value;
   return true;
 }
 
 static bool binary_write_u32(binary_ctx_t* ctx, uint32_t value) {
-  if (!binary_ensure_write_capacity(ctx, 4)) return false;
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)(value & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 8) & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 16) & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 24) & 0xFF);
+  if (!olib_output_buffer_reserve(&ctx->write, 4)) return false;
+  ctx->write.data[ctx->write.size++] = (uint8_t)(value & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 8) & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 16) & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 24) & 0xFF);
   return true;
 }
 
 static bool binary_write_u64(binary_ctx_t* ctx, uint64_t value) {
-  if (!binary_ensure_write_capacity(ctx, 8)) return false;
+  if (!olib_output_buffer_reserve(&ctx->write, 8)) return false;
   for (int i = 0; i < 8; i++) {
-    ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> (i * 8)) & 0xFF);
+    ctx->write.data[ctx->write.size++] = (uint8_t)((value >> (i * 8)) & 0xFF);
   }
   return true;
 }
@@ -116,12 +131,27 @@ static bool binary_write_f64(binary_ctx_t* ctx, double value) {
 }
 
 static bool binary_write_bytes(binary_ctx_t* ctx, const uint8_t* data, size_t len) {
-  if (!binary_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, data, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, data, len);
+  ctx->write.size += len;
   return true;
 }
 
+// LEB128 varint, zigzag mapped for signed values so small negative keys stay short
+static bool binary_write_varint(binary_ctx_t* ctx, uint64_t value) {
+  if (!olib_output_buffer_reserve(&ctx->write, 10)) return false;
+  while (value >= 0x80) {
+    ctx->write.data[ctx->write.size++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  ctx->write.data[ctx->write.size++] = (uint8_t)value;
+  return true;
+}
+
+static bool binary_write_zigzag(binary_ctx_t* ctx, int64_t value) {
+  return binary_write_varint(ctx, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
 // #############################################################################
 // Endian-independent decoding helpers
 // #############################################################################
@@ -166,58 +196,181 @@ static bool binary_read_f64(binary_ctx_t* ctx, double* out) {
   return true;
 }
 
+static bool binary_read_varint(binary_ctx_t* ctx, uint64_t* out) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t byte;
+    if (!binary_read_u8(ctx, &byte)) return false;
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *out = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool binary_read_zigzag(binary_ctx_t* ctx, int64_t* out) {
+  uint64_t value;
+  if (!binary_read_varint(ctx, &value)) return false;
+  *out = (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+  return true;
+}
+
+// #############################################################################
+// Packed list writing
+// #############################################################################
+
+// Record the tag of a value written into the innermost open container
+static void binary_note_element(binary_ctx_t* c, uint8_t tag) {
+  if (c->frame_count == 0) return;
+  binary_frame_t* frame = &c->frames[c->frame_count - 1];
+  if (!frame->packable) return;
+  bool numeric = tag == BINARY_TAG_INT || tag == BINARY_TAG_UINT || tag == BINARY_TAG_FLOAT;
+  if (!numeric || (frame->elem_tag != 0 && frame->elem_tag != tag)) {
+    frame->packable = false;
+    return;
+  }
+  frame->elem_tag = tag;
+}
+
+static bool binary_push_frame(binary_ctx_t* c, bool packable) {
+  if (c->frame_count == c->frame_capacity) {
+    size_t new_capacity = c->frame_capacity ? c->frame_capacity * 2 : 16;
+    binary_frame_t* new_frames = olib_realloc(c->frames, new_capacity * sizeof(binary_frame_t));
+    if (!new_frames) return false;
+    c->frames = new_frames;
+    c->frame_capacity = new_capacity;
+  }
+  binary_frame_t* frame = &c->frames[c->frame_count++];
+  frame->start = c->write.size;
+  frame->elem_tag = 0;
+  frame->packable = packable;
+  return true;
+}
+
+// Rewrite a finished list of plain tagged numbers in place as a packed list,
+// keeping the plain form when packing would not make it smaller
+static bool binary_pack_list(binary_ctx_t* c, const binary_frame_t* frame) {
+  size_t plain_size = c->write.size - frame->start;
+  size_t count = (plain_size - 5) / 9;
+  if (!frame->packable || frame->elem_tag == 0 || count < c->pack_min_count) return true;
+  if (plain_size <= BINARY_PACKED_HEADER_SIZE + 1) return true;
+
+  size_t capacity = plain_size - BINARY_PACKED_HEADER_SIZE - 1;
+  if (capacity > c->pack_capacity) {
+    uint8_t* new_buffer = olib_realloc(c->pack_buffer, capacity);
+    if (!new_buffer) return false;
+    c->pack_buffer = new_buffer;
+    c->pack_capacity = capacity;
+  }
+  size_t len;
+  uint8_t* elems = c->write.data + frame->start + 5;
+  if (!binary_packed_encode(frame->elem_tag, elems, count, 9, c->pack_buffer, capacity, &len) || len > UINT32_MAX) {
+    return true;
+  }
+
+  // The rewritten elements are marked as one value, size attribution moves them to the items
+  c->write.size = frame->start;
+  if (!binary_write_u8(c, BINARY_TAG_PACKED) || !binary_write_u8(c, frame->elem_tag) ||
+      !binary_write_u32(c, (uint32_t)count) || !binary_write_u32(c, (uint32_t)len)) {
+    return false;
+  }
+  olib_output_buffer_mark_value(&c->write);
+  return binary_write_bytes(c, c->pack_buffer, len);
+}
+
 // #############################################################################
 // Write callbacks
 // #############################################################################
 
 static bool binary_write_int(void* ctx, int64_t value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) binary_note_element(c, BINARY_TAG_INT);
   if (!binary_write_u8(c, BINARY_TAG_INT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return binary_write_i64(c, value);
 }
 
 static bool binary_write_uint(void* ctx, uint64_t value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) binary_note_element(c, BINARY_TAG_UINT);
   if (!binary_write_u8(c, BINARY_TAG_UINT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return binary_write_u64(c, value);
 }
 
 static bool binary_write_float(void* ctx, double value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) binary_note_element(c, BINARY_TAG_FLOAT);
   if (!binary_write_u8(c, BINARY_TAG_FLOAT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return binary_write_f64(c, value);
 }
 
 static bool binary_write_string(void* ctx, const char* value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) binary_note_element(c, BINARY_TAG_STRING);
   if (!binary_write_u8(c, BINARY_TAG_STRING)) return false;
   uint32_t len = value ? (uint32_t)strlen(value) : 0;
   if (!binary_write_u32(c, len)) return false;
+  olib_output_buffer_mark_value(&c->write);
   if (len > 0) {
     if (!binary_write_bytes(c, (const uint8_t*)value, len)) return false;
   }
   return true;
 }
 
+// The length is patched in once the last piece is known
+static bool binary_write_string_chunk(void* ctx, const char* chunk, size_t size, bool first, bool last) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (first) {
+    if (c->pack_lists) binary_note_element(c, BINARY_TAG_STRING);
+    if (!binary_write_u8(c, BINARY_TAG_STRING)) return false;
+    c->chunk_start = c->write.size;
+    if (!binary_write_u32(c, 0)) return false;
+  }
+  if (size > 0 && !binary_write_bytes(c, (const uint8_t*)chunk, size)) return false;
+  if (last) {
+    size_t len = c->write.size - c->chunk_start - 4;
+    if (len > UINT32_MAX) return false;
+    for (int i = 0; i < 4; i++) {
+      c->write.data[c->chunk_start + i] = (uint8_t)((len >> (i * 8)) & 0xFF);
+    }
+  }
+  return true;
+}
+
 static bool binary_write_bool(void* ctx, bool value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) binary_note_element(c, BINARY_TAG_BOOL);
   if (!binary_write_u8(c, BINARY_TAG_BOOL)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return binary_write_u8(c, value ? 1 : 0);
 }
 
 static bool binary_write_list_begin(void* ctx, size_t size) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) {
+    binary_note_element(c, BINARY_TAG_LIST);
+    if (!binary_push_frame(c, true)) return false;
+  }
   if (!binary_write_u8(c, BINARY_TAG_LIST)) return false;
   return binary_write_u32(c, (uint32_t)size);
 }
 
 static bool binary_write_list_end(void* ctx) {
-  (void)ctx;
-  return true;
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (!c->pack_lists || c->frame_count == 0) return true;
+  return binary_pack_list(c, &c->frames[--c->frame_count]);
 }
 
 static bool binary_write_struct_begin(void* ctx) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists) {
+    binary_note_element(c, BINARY_TAG_STRUCT);
+    if (!binary_push_frame(c, false)) return false;
+  }
   return binary_write_u8(c, BINARY_TAG_STRUCT);
 }
 
@@ -228,40 +381,110 @@ static bool binary_write_struct_key(void* ctx, const char* key) {
   if (len > 0) {
     if (!binary_write_bytes(c, (const uint8_t*)key, len)) return false;
   }
+  olib_output_buffer_mark_key(&c->write, c->write.size - len);
   return true;
 }
 
 static bool binary_write_struct_end(void* ctx) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists && c->frame_count > 0) c->frame_count--;
   // Write zero-length key to mark end of struct
   return binary_write_u32(c, 0);
 }
 
-// #############################################################################
-// Read callbacks
-// #############################################################################
-
-static olib_object_type_t binary_read_peek(void* ctx) {
+static bool binary_write_map_begin(void* ctx, size_t size) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
-  if (c->read_pos >= c->read_size) {
-    return OLIB_OBJECT_TYPE_MAX;
+  if (c->pack_lists) {
+    binary_note_element(c, BINARY_TAG_MAP);
+    if (!binary_push_frame(c, false)) return false;
   }
+  return binary_write_u8(c, BINARY_TAG_MAP) && binary_write_varint(c, size);
+}
 
-  uint8_t tag = c->read_buffer[c->read_pos];
+static bool binary_write_map_key(void* ctx, int64_t key) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  size_t key_begin = c->write.size;
+  if (!binary_write_zigzag(c, key)) return false;
+  olib_output_buffer_mark_key(&c->write, key_begin);
+  return true;
+}
+
+static bool binary_write_map_end(void* ctx) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->pack_lists && c->frame_count > 0) c->frame_count--;
+  return true;
+}
+
+// #############################################################################
+// Packed list reading
+// #############################################################################
+
+static olib_object_type_t binary_tag_type(uint8_t tag) {
   switch (tag) {
     case BINARY_TAG_INT:    return OLIB_OBJECT_TYPE_INT;
     case BINARY_TAG_UINT:   return OLIB_OBJECT_TYPE_UINT;
     case BINARY_TAG_FLOAT:  return OLIB_OBJECT_TYPE_FLOAT;
     case BINARY_TAG_STRING: return OLIB_OBJECT_TYPE_STRING;
     case BINARY_TAG_BOOL:   return OLIB_OBJECT_TYPE_BOOL;
-    case BINARY_TAG_LIST:  return OLIB_OBJECT_TYPE_LIST;
+    case BINARY_TAG_LIST:   return OLIB_OBJECT_TYPE_LIST;
+    case BINARY_TAG_PACKED: return OLIB_OBJECT_TYPE_LIST;
     case BINARY_TAG_STRUCT: return OLIB_OBJECT_TYPE_STRUCT;
+    case BINARY_TAG_MAP:    return OLIB_OBJECT_TYPE_MAP;
     default:                return OLIB_OBJECT_TYPE_MAX;
   }
 }
 
+// Take the next decoded value of the packed list being read if it has the given tag
+static bool binary_take_packed(binary_ctx_t* c, uint8_t tag, uint64_t* out) {
+  if (c->packed_tag != tag || c->packed_pos >= c->packed_count) return false;
+  *out = c->packed_values[c->packed_pos++];
+  return true;
+}
+
+// Parse a packed list header (after the tag) and decode its payload
+static bool binary_read_packed(binary_ctx_t* c, size_t* size) {
+  uint8_t tag;
+  uint32_t count;
+  uint32_t len;
+  if (!binary_read_u8(c, &tag) || !binary_read_u32(c, &count) || !binary_read_u32(c, &len)) return false;
+  if (len > c->read_size - c->read_pos) return false;
+  if (count == 0 || count > binary_packed_max_count(tag, len)) return false;
+
+  if (count > c->packed_capacity) {
+    uint64_t* new_values = olib_realloc(c->packed_values, (size_t)count * sizeof(uint64_t));
+    if (!new_values) return false;
+    c->packed_values = new_values;
+    c->packed_capacity = count;
+  }
+  if (!binary_packed_decode(tag, c->read_buffer + c->read_pos, len, count, c->packed_values)) return false;
+
+  c->read_pos += len;
+  c->packed_tag = tag;
+  c->packed_count = count;
+  c->packed_pos = 0;
+  c->packed_active = true;
+  *size = count;
+  return true;
+}
+
+// #############################################################################
+// Read callbacks
+// #############################################################################
+
+static olib_object_type_t binary_read_peek(void* ctx) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) {
+    return c->packed_pos < c->packed_count ? binary_tag_type(c->packed_tag) : OLIB_OBJECT_TYPE_MAX;
+  }
+  if (c->read_pos >= c->read_size) {
+    return OLIB_OBJECT_TYPE_MAX;
+  }
+  return binary_tag_type(c->read_buffer[c->read_pos]);
+}
+
 static bool binary_read_int(void* ctx, int64_t* value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return binary_take_packed(c, BINARY_TAG_INT, (uint64_t*)value);
   uint8_t tag;
   if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_INT) return false;
   return binary_read_i64(c, value);
@@ -269,6 +492,7 @@ static bool binary_read_int(void* ctx, int64_t* value) {
 
 static bool binary_read_uint(void* ctx, uint64_t* value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return binary_take_packed(c, BINARY_TAG_UINT, value);
   uint8_t tag;
   if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_UINT) return false;
   return binary_read_u64(c, value);
@@ -276,6 +500,12 @@ static bool binary_read_uint(void* ctx, uint64_t* value) {
 
 static bool binary_read_float(void* ctx, double* value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) {
+    uint64_t bits;
+    if (!binary_take_packed(c, BINARY_TAG_FLOAT, &bits)) return false;
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
   uint8_t tag;
   if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_FLOAT) return false;
   return binary_read_f64(c, value);
@@ -295,29 +525,54 @@ static bool binary_ensure_temp_string(binary_ctx_t* ctx, size_t len) {
   return true;
 }
 
-static bool binary_read_string(void* ctx, const char** value) {
-  binary_ctx_t* c = (binary_ctx_t*)ctx;
-  uint8_t tag;
-  if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_STRING) return false;
-
+// Read a length-prefixed string payload (after the tag) into temp_string
+static bool binary_read_string_payload(binary_ctx_t* c, const char** value) {
   uint32_t len;
   if (!binary_read_u32(c, &len)) return false;
+  if (len > c->read_size - c->read_pos) return false;
 
   if (!binary_ensure_temp_string(c, len)) return false;
 
-  if (len > 0) {
-    if (c->read_pos + len > c->read_size) return false;
-    memcpy(c->temp_string, c->read_buffer + c->read_pos, len);
-    c->read_pos += len;
-  }
+  memcpy(c->temp_string, c->read_buffer + c->read_pos, len);
+  c->read_pos += len;
   c->temp_string[len] = '\0';
 
   *value = c->temp_string;
   return true;
 }
 
+static bool binary_read_string(void* ctx, const char** value) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return false;
+  uint8_t tag;
+  if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_STRING) return false;
+  return binary_read_string_payload(c, value);
+}
+
+// Pieces point straight into the input, nothing is copied
+static bool binary_read_string_chunk(void* ctx, size_t max_size, const char** chunk, size_t* size, bool* last) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (!c->chunk_active) {
+    uint8_t tag;
+    uint32_t len;
+    if (c->packed_active || !binary_read_u8(c, &tag) || tag != BINARY_TAG_STRING) return false;
+    if (!binary_read_u32(c, &len) || len > c->read_size - c->read_pos) return false;
+    c->chunk_remaining = len;
+    c->chunk_active = true;
+  }
+  size_t n = c->chunk_remaining < max_size ? c->chunk_remaining : max_size;
+  *chunk = (const char*)c->read_buffer + c->read_pos;
+  *size = n;
+  c->read_pos += n;
+  c->chunk_remaining -= n;
+  *last = c->chunk_remaining == 0;
+  c->chunk_active = !*last;
+  return true;
+}
+
 static bool binary_read_bool(void* ctx, bool* value) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return false;
   uint8_t tag;
   if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_BOOL) return false;
   uint8_t b;
@@ -326,10 +581,67 @@ static bool binary_read_bool(void* ctx, bool* value) {
   return true;
 }
 
+static bool binary_read_value(void* ctx, olib_value_t* out) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) {
+    if (c->packed_pos >= c->packed_count) return false;
+    out->type = binary_tag_type(c->packed_tag);
+    out->data.uint_val = c->packed_values[c->packed_pos++];
+    return true;
+  }
+  if (c->read_pos >= c->read_size) {
+    return false;
+  }
+
+  // Containers are left unconsumed for read_list_begin / read_struct_begin / read_map_begin
+  uint8_t tag = c->read_buffer[c->read_pos];
+  switch (tag) {
+    case BINARY_TAG_LIST:
+    case BINARY_TAG_PACKED:
+      out->type = OLIB_OBJECT_TYPE_LIST;
+      return true;
+    case BINARY_TAG_STRUCT:
+      out->type = OLIB_OBJECT_TYPE_STRUCT;
+      return true;
+    case BINARY_TAG_MAP:
+      out->type = OLIB_OBJECT_TYPE_MAP;
+      return true;
+    default:
+      break;
+  }
+
+  c->read_pos++;
+  switch (tag) {
+    case BINARY_TAG_INT:
+      out->type = OLIB_OBJECT_TYPE_INT;
+      return binary_read_i64(c, &out->data.int_val);
+    case BINARY_TAG_UINT:
+      out->type = OLIB_OBJECT_TYPE_UINT;
+      return binary_read_u64(c, &out->data.uint_val);
+    case BINARY_TAG_FLOAT:
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      return binary_read_f64(c, &out->data.float_val);
+    case BINARY_TAG_STRING:
+      out->type = OLIB_OBJECT_TYPE_STRING;
+      return binary_read_string_payload(c, &out->data.string_val);
+    case BINARY_TAG_BOOL: {
+      uint8_t b;
+      if (!binary_read_u8(c, &b)) return false;
+      out->type = OLIB_OBJECT_TYPE_BOOL;
+      out->data.bool_val = (b != 0);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
 static bool binary_read_list_begin(void* ctx, size_t* size) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
   uint8_t tag;
-  if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_LIST) return false;
+  if (c->packed_active || !binary_read_u8(c, &tag)) return false;
+  if (tag == BINARY_TAG_PACKED) return binary_read_packed(c, size);
+  if (tag != BINARY_TAG_LIST) return false;
   uint32_t count;
   if (!binary_read_u32(c, &count)) return false;
   *size = count;
@@ -337,12 +649,17 @@ static bool binary_read_list_begin(void* ctx, size_t* size) {
 }
 
 static bool binary_read_list_end(void* ctx) {
-  (void)ctx;
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) {
+    if (c->packed_pos != c->packed_count) return false;
+    c->packed_active = false;
+  }
   return true;
 }
 
 static bool binary_read_struct_begin(void* ctx) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return false;
   uint8_t tag;
   if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_STRUCT) return false;
   return true;
@@ -379,21 +696,47 @@ static bool binary_read_struct_end(void* ctx) {
   return (len == 0);
 }
 
+static bool binary_read_map_begin(void* ctx, size_t* size) {
+  binary_ctx_t* c = (binary_ctx_t*)ctx;
+  if (c->packed_active) return false;
+  uint8_t tag;
+  uint64_t count;
+  if (!binary_read_u8(c, &tag) || tag != BINARY_TAG_MAP || !binary_read_varint(c, &count)) return false;
+  // Every entry takes at least a key byte and a tagged value, so a corrupt count
+  // cannot make the reader reserve far beyond the input
+  if (count > (c->read_size - c->read_pos) / 2) return false;
+  *size = (size_t)count;
+  return true;
+}
+
+static bool binary_read_map_key(void* ctx, int64_t* key) {
+  return binary_read_zigzag((binary_ctx_t*)ctx, key);
+}
+
+static bool binary_read_map_end(void* ctx) {
+  (void)ctx;
+  return true;
+}
+
 // #############################################################################
 // Lifecycle callbacks
 // #############################################################################
 
 static void binary_free_ctx(void* ctx) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   if (c->temp_string) olib_free(c->temp_string);
+  olib_free(c->frames);
+  olib_free(c->pack_buffer);
+  olib_free(c->packed_values);
   olib_free(c);
 }
 
 static bool binary_init_write(void* ctx) {
   binary_ctx_t* c = (binary_ctx_t*)ctx;
   // Reset write state for new serialization
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
+  c->frame_count = 0;
   return true;
 }
 
@@ -402,14 +745,8 @@ static bool binary_finish_write(void* ctx, uint8_t** out_data, size_t* out_size)
   if (!out_data || !out_size) {
     return false;
   }
-  // Transfer ownership of the buffer to caller
-  *out_data = c->write_buffer;
-  *out_size = c->write_size;
-  // Reset write state (buffer is now owned by caller)
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  // Transfer ownership of the buffer to caller, or a copy when it is retained
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool binary_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -417,6 +754,8 @@ static bool binary_init_read(void* ctx, const uint8_t* data, size_t size) {
   c->read_buffer = data;
   c->read_size = size;
   c->read_pos = 0;
+  c->packed_active = false;
+  c->chunk_active = false;
   return true;
 }
 
@@ -426,18 +765,32 @@ static bool binary_finish_read(void* ctx) {
   c->read_buffer = NULL;
   c->read_size = 0;
   c->read_pos = 0;
+  c->packed_active = false;
+  c->chunk_active = false;
   return true;
 }
 
+static olib_output_buffer_t* binary_output_buffer(void* ctx) {
+  return &((binary_ctx_t*)ctx)->write;
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
 
 OLIB_API olib_serializer_t* olib_serializer_new_binary() {
+  return olib_serializer_new_binary_ex(NULL);
+}
+
+OLIB_API olib_serializer_t* olib_serializer_new_binary_ex(const olib_binary_options_t* options) {
   binary_ctx_t* ctx = olib_calloc(1, sizeof(binary_ctx_t));
   if (!ctx) {
     return NULL;
   }
+  if (options && options->pack_numeric_lists) {
+    ctx->pack_lists = true;
+    ctx->pack_min_count = options->pack_min_count ? options->pack_min_count : BINARY_PACK_MIN_COUNT;
+  }
 
   olib_serializer_config_t config = {
     .user_data = ctx,
@@ -447,6 +800,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_binary() {
     .finish_write = binary_finish_write,
     .init_read = binary_init_read,
     .finish_read = binary_finish_read,
+    .output_buffer = binary_output_buffer,
 
     .write_int = binary_write_int,
     .write_uint = binary_write_uint,
@@ -458,8 +812,13 @@ OLIB_API olib_serializer_t* olib_serializer_new_binary() {
     .write_struct_begin = binary_write_struct_begin,
     .write_struct_key = binary_write_struct_key,
     .write_struct_end = binary_write_struct_end,
+    .write_map_begin = binary_write_map_begin,
+    .write_map_key = binary_write_map_key,
+    .write_map_end = binary_write_map_end,
+    .write_string_chunk = binary_write_string_chunk,
 
     .read_peek = binary_read_peek,
+    .read_value = binary_read_value,
     .read_int = binary_read_int,
     .read_uint = binary_read_uint,
     .read_float = binary_read_float,
@@ -470,6 +829,10 @@ OLIB_API olib_serializer_t* olib_serializer_new_binary() {
     .read_struct_begin = binary_read_struct_begin,
     .read_struct_key = binary_read_struct_key,
     .read_struct_end = binary_read_struct_end,
+    .read_map_begin = binary_read_map_begin,
+    .read_map_key = binary_read_map_key,
+    .read_map_end = binary_read_map_end,
+    .read_string_chunk = binary_read_string_chunk,
   };
 
   olib_serializer_t* serializer = olib_serializer_new(&config);
@@ -477,6 +840,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_binary() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_BINARY);
 
   return serializer;
 }
@@ -23,6 +23,8 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include <string.h>
 
 // #############################################################################
@@ -43,9 +45,7 @@ SOFTWARE.
 
 typedef struct {
   // Write mode
-  uint8_t* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
 
   // Read mode
   const uint8_t* read_buffer;
@@ -61,46 +61,25 @@ typedef struct {
 // Endian-independent encoding helpers (little-endian wire format)
 // #############################################################################
 
-static bool jsonb_ensure_write_capacity(jsonb_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  uint8_t* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool jsonb_write_u8(jsonb_ctx_t* ctx, uint8_t value) {
-  if (!jsonb_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = value;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = value;
   return true;
 }
 
 static bool jsonb_write_u32(jsonb_ctx_t* ctx, uint32_t value) {
-  if (!jsonb_ensure_write_capacity(ctx, 4)) return false;
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)(value & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 8) & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 16) & 0xFF);
-  ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> 24) & 0xFF);
+  if (!olib_output_buffer_reserve(&ctx->write, 4)) return false;
+  ctx->write.data[ctx->write.size++] = (uint8_t)(value & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 8) & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 16) & 0xFF);
+  ctx->write.data[ctx->write.size++] = (uint8_t)((value >> 24) & 0xFF);
   return true;
 }
 
 static bool jsonb_write_u64(jsonb_ctx_t* ctx, uint64_t value) {
-  if (!jsonb_ensure_write_capacity(ctx, 8)) return false;
+  if (!olib_output_buffer_reserve(&ctx->write, 8)) return false;
   for (int i = 0; i < 8; i++) {
-    ctx->write_buffer[ctx->write_size++] = (uint8_t)((value >> (i * 8)) & 0xFF);
+    ctx->write.data[ctx->write.size++] = (uint8_t)((value >> (i * 8)) & 0xFF);
   }
   return true;
 }
@@ -116,9 +95,9 @@ static bool jsonb_write_f64(jsonb_ctx_t* ctx, double value) {
 }
 
 static bool jsonb_write_bytes(jsonb_ctx_t* ctx, const uint8_t* data, size_t len) {
-  if (!jsonb_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, data, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, data, len);
+  ctx->write.size += len;
   return true;
 }
 
@@ -173,18 +152,21 @@ static bool jsonb_read_f64(jsonb_ctx_t* ctx, double* out) {
 static bool jsonb_write_int(void* ctx, int64_t value) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   if (!jsonb_write_u8(c, JSONB_TAG_INT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return jsonb_write_i64(c, value);
 }
 
 static bool jsonb_write_uint(void* ctx, uint64_t value) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   if (!jsonb_write_u8(c, JSONB_TAG_UINT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return jsonb_write_u64(c, value);
 }
 
 static bool jsonb_write_float(void* ctx, double value) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   if (!jsonb_write_u8(c, JSONB_TAG_FLOAT)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return jsonb_write_f64(c, value);
 }
 
@@ -193,6 +175,7 @@ static bool jsonb_write_string(void* ctx, const char* value) {
   if (!jsonb_write_u8(c, JSONB_TAG_STRING)) return false;
   uint32_t len = value ? (uint32_t)strlen(value) : 0;
   if (!jsonb_write_u32(c, len)) return false;
+  olib_output_buffer_mark_value(&c->write);
   if (len > 0) {
     if (!jsonb_write_bytes(c, (const uint8_t*)value, len)) return false;
   }
@@ -202,6 +185,7 @@ static bool jsonb_write_string(void* ctx, const char* value) {
 static bool jsonb_write_bool(void* ctx, bool value) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   if (!jsonb_write_u8(c, JSONB_TAG_BOOL)) return false;
+  olib_output_buffer_mark_value(&c->write);
   return jsonb_write_u8(c, value ? 1 : 0);
 }
 
@@ -228,6 +212,7 @@ static bool jsonb_write_struct_key(void* ctx, const char* key) {
   if (len > 0) {
     if (!jsonb_write_bytes(c, (const uint8_t*)key, len)) return false;
   }
+  olib_output_buffer_mark_key(&c->write, c->write.size - len);
   return true;
 }
 
@@ -295,27 +280,29 @@ static bool jsonb_ensure_temp_string(jsonb_ctx_t* ctx, size_t len) {
   return true;
 }
 
-static bool jsonb_read_string(void* ctx, const char** value) {
-  jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
-  uint8_t tag;
-  if (!jsonb_read_u8(c, &tag) || tag != JSONB_TAG_STRING) return false;
-
+// Read a length-prefixed string payload (after the tag) into temp_string
+static bool jsonb_read_string_payload(jsonb_ctx_t* c, const char** value) {
   uint32_t len;
   if (!jsonb_read_u32(c, &len)) return false;
+  if (len > c->read_size - c->read_pos) return false;
 
   if (!jsonb_ensure_temp_string(c, len)) return false;
 
-  if (len > 0) {
-    if (c->read_pos + len > c->read_size) return false;
-    memcpy(c->temp_string, c->read_buffer + c->read_pos, len);
-    c->read_pos += len;
-  }
+  memcpy(c->temp_string, c->read_buffer + c->read_pos, len);
+  c->read_pos += len;
   c->temp_string[len] = '\0';
 
   *value = c->temp_string;
   return true;
 }
 
+static bool jsonb_read_string(void* ctx, const char** value) {
+  jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
+  uint8_t tag;
+  if (!jsonb_read_u8(c, &tag) || tag != JSONB_TAG_STRING) return false;
+  return jsonb_read_string_payload(c, value);
+}
+
 static bool jsonb_read_bool(void* ctx, bool* value) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   uint8_t tag;
@@ -326,6 +313,51 @@ static bool jsonb_read_bool(void* ctx, bool* value) {
   return true;
 }
 
+static bool jsonb_read_value(void* ctx, olib_value_t* out) {
+  jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
+  if (c->read_pos >= c->read_size) {
+    return false;
+  }
+
+  // Containers are left unconsumed for read_list_begin / read_struct_begin
+  uint8_t tag = c->read_buffer[c->read_pos];
+  switch (tag) {
+    case JSONB_TAG_LIST:
+      out->type = OLIB_OBJECT_TYPE_LIST;
+      return true;
+    case JSONB_TAG_STRUCT:
+      out->type = OLIB_OBJECT_TYPE_STRUCT;
+      return true;
+    default:
+      break;
+  }
+
+  c->read_pos++;
+  switch (tag) {
+    case JSONB_TAG_INT:
+      out->type = OLIB_OBJECT_TYPE_INT;
+      return jsonb_read_i64(c, &out->data.int_val);
+    case JSONB_TAG_UINT:
+      out->type = OLIB_OBJECT_TYPE_UINT;
+      return jsonb_read_u64(c, &out->data.uint_val);
+    case JSONB_TAG_FLOAT:
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      return jsonb_read_f64(c, &out->data.float_val);
+    case JSONB_TAG_STRING:
+      out->type = OLIB_OBJECT_TYPE_STRING;
+      return jsonb_read_string_payload(c, &out->data.string_val);
+    case JSONB_TAG_BOOL: {
+      uint8_t b;
+      if (!jsonb_read_u8(c, &b)) return false;
+      out->type = OLIB_OBJECT_TYPE_BOOL;
+      out->data.bool_val = (b != 0);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
 static bool jsonb_read_list_begin(void* ctx, size_t* size) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   uint8_t tag;
@@ -385,7 +417,7 @@ static bool jsonb_read_struct_end(void* ctx) {
 
 static void jsonb_free_ctx(void* ctx) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   if (c->temp_string) olib_free(c->temp_string);
   olib_free(c);
 }
@@ -393,7 +425,7 @@ static void jsonb_free_ctx(void* ctx) {
 static bool jsonb_init_write(void* ctx) {
   jsonb_ctx_t* c = (jsonb_ctx_t*)ctx;
   // Reset write state for new serialization
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   return true;
 }
 
@@ -402,14 +434,8 @@ static bool jsonb_finish_write(void* ctx, uint8_t** out_data, size_t* out_size)
   if (!out_data || !out_size) {
     return false;
   }
-  // Transfer ownership of the buffer to caller
-  *out_data = c->write_buffer;
-  *out_size = c->write_size;
-  // Reset write state (buffer is now owned by caller)
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  // Transfer ownership of the buffer to caller, or a copy when it is retained
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool jsonb_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -429,6 +455,10 @@ static bool jsonb_finish_read(void* ctx) {
   return true;
 }
 
+static olib_output_buffer_t* jsonb_output_buffer(void* ctx) {
+  return &((jsonb_ctx_t*)ctx)->write;
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
@@ -447,6 +477,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_binary() {
     .finish_write = jsonb_finish_write,
     .init_read = jsonb_init_read,
     .finish_read = jsonb_finish_read,
+    .output_buffer = jsonb_output_buffer,
 
     .write_int = jsonb_write_int,
     .write_uint = jsonb_write_uint,
@@ -460,6 +491,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_binary() {
     .write_struct_end = jsonb_write_struct_end,
 
     .read_peek = jsonb_read_peek,
+    .read_value = jsonb_read_value,
     .read_int = jsonb_read_int,
     .read_uint = jsonb_read_uint,
     .read_float = jsonb_read_float,
@@ -477,6 +509,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_binary() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_JSON_BINARY);
 
   return serializer;
 }
@@ -23,7 +23,12 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include "text_parsing_utilities.h"
+#include "text_scalars.h"
+#include "json_index.h"
+#include "../olib_thread.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,12 +40,11 @@ SOFTWARE.
 // #############################################################################
 
 #define JSON_INDENT_SPACES 2
+#define JSON_INDEX_MIN_SIZE (1024 * 1024)
 
 typedef struct {
   // Write mode
-  char* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
   int indent_level;
 
   // State stack for nested containers
@@ -52,52 +56,41 @@ typedef struct {
 
   // Read mode (using shared parsing utilities)
   text_parse_ctx_t parse;
+
+  // Structural index of the input, only built for large inputs
+  size_t index_min_size;
+  size_t index_threads;
+  bool has_index;
+  json_index_t index;
+  size_t index_cursor;  // Positions before the cursor are behind the parser
+  size_t list_cursor;
+
+  bool chunk_active;  // Inside a string read by json_read_string_chunk
 } json_ctx_t;
 
 // #############################################################################
 // Write helpers
 // #############################################################################
 
-static bool json_ensure_write_capacity(json_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  char* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool json_write_str(json_ctx_t* ctx, const char* str) {
   size_t len = strlen(str);
-  if (!json_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, str, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, str, len);
+  ctx->write.size += len;
   return true;
 }
 
 static bool json_write_char(json_ctx_t* ctx, char c) {
-  if (!json_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = c;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = c;
   return true;
 }
 
 static bool json_write_indent(json_ctx_t* ctx) {
   int spaces = ctx->indent_level * JSON_INDENT_SPACES;
-  if (!json_ensure_write_capacity(ctx, spaces)) return false;
+  if (!olib_output_buffer_reserve(&ctx->write, spaces)) return false;
   for (int i = 0; i < spaces; i++) {
-    ctx->write_buffer[ctx->write_size++] = ' ';
+    ctx->write.data[ctx->write.size++] = ' ';
   }
   return true;
 }
@@ -136,9 +129,12 @@ static bool json_write_key_prefix(json_ctx_t* ctx) {
 
   if (container == 2 && ctx->pending_key) {
     // Inside struct: write "key":
+    size_t key_begin = ctx->write.size;
     if (!json_write_char(ctx, '"')) return false;
     if (!json_write_str(ctx, ctx->pending_key)) return false;
-    if (!json_write_str(ctx, "\": ")) return false;
+    if (!json_write_char(ctx, '"')) return false;
+    olib_output_buffer_mark_key(&ctx->write, key_begin);
+    if (!json_write_str(ctx, ": ")) return false;
     ctx->pending_key = NULL;
   }
   return true;
@@ -157,49 +153,45 @@ static bool json_write_value_prefix(json_ctx_t* ctx) {
     if (!json_write_newline_indent(ctx)) return false;
     if (!json_write_key_prefix(ctx)) return false;
   }
+  olib_output_buffer_mark_value(&ctx->write);
   return true;
 }
 
+// Write one character of a string value, escaped
+static inline bool json_write_escaped_char(json_ctx_t* ctx, unsigned char c) {
+  switch (c) {
+    case '"':
+      return json_write_str(ctx, "\\\"");
+    case '\\':
+      return json_write_str(ctx, "\\\\");
+    case '\b':
+      return json_write_str(ctx, "\\b");
+    case '\f':
+      return json_write_str(ctx, "\\f");
+    case '\n':
+      return json_write_str(ctx, "\\n");
+    case '\r':
+      return json_write_str(ctx, "\\r");
+    case '\t':
+      return json_write_str(ctx, "\\t");
+    default:
+      if (c < 0x20) {
+        // Control characters: use \uXXXX escape
+        char buf[8];
+        snprintf(buf, sizeof(buf), "\\u%04x", c);
+        return json_write_str(ctx, buf);
+      }
+      return json_write_char(ctx, c);
+  }
+}
+
 // Write a JSON-escaped string (with surrounding quotes)
 static bool json_write_escaped_string(json_ctx_t* ctx, const char* value) {
   if (!json_write_char(ctx, '"')) return false;
 
   if (value) {
     for (const char* p = value; *p; p++) {
-      unsigned char c = (unsigned char)*p;
-      switch (c) {
-        case '"':
-          if (!json_write_str(ctx, "\\\"")) return false;
-          break;
-        case '\\':
-          if (!json_write_str(ctx, "\\\\")) return false;
-          break;
-        case '\b':
-          if (!json_write_str(ctx, "\\b")) return false;
-          break;
-        case '\f':
-          if (!json_write_str(ctx, "\\f")) return false;
-          break;
-        case '\n':
-          if (!json_write_str(ctx, "\\n")) return false;
-          break;
-        case '\r':
-          if (!json_write_str(ctx, "\\r")) return false;
-          break;
-        case '\t':
-          if (!json_write_str(ctx, "\\t")) return false;
-          break;
-        default:
-          if (c < 0x20) {
-            // Control characters: use \uXXXX escape
-            char buf[8];
-            snprintf(buf, sizeof(buf), "\\u%04x", c);
-            if (!json_write_str(ctx, buf)) return false;
-          } else {
-            if (!json_write_char(ctx, c)) return false;
-          }
-          break;
-      }
+      if (!json_write_escaped_char(ctx, (unsigned char)*p)) return false;
     }
   }
 
@@ -216,9 +208,9 @@ static bool json_write_int(void* ctx, int64_t value) {
 
   if (!json_write_value_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%lld", (long long)value);
-  return json_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_int((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
 static bool json_write_uint(void* ctx, uint64_t value) {
@@ -226,24 +218,20 @@ static bool json_write_uint(void* ctx, uint64_t value) {
 
   if (!json_write_value_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
-  return json_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_uint((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
-static bool json_write_float(void* ctx, double value) {
-  json_ctx_t* c = (json_ctx_t*)ctx;
-
-  if (!json_write_value_prefix(c)) return false;
-
-  char buf[64];
+// Format a float the way JSON text writes it (buf must hold at least 64 bytes)
+static void json_format_float(char* buf, size_t size, double value) {
   // Handle special float values (JSON doesn't support Infinity/NaN)
   if (isnan(value)) {
-    snprintf(buf, sizeof(buf), "null");
+    snprintf(buf, size, "null");
   } else if (isinf(value)) {
-    snprintf(buf, sizeof(buf), "null");
+    snprintf(buf, size, "null");
   } else {
-    snprintf(buf, sizeof(buf), "%.17g", value);
+    snprintf(buf, size, "%.17g", value);
     // Ensure the output looks like a floating point number
     bool has_decimal = false;
     for (char* p = buf; *p; p++) {
@@ -256,6 +244,15 @@ static bool json_write_float(void* ctx, double value) {
       strcat(buf, ".0");
     }
   }
+}
+
+static bool json_write_float(void* ctx, double value) {
+  json_ctx_t* c = (json_ctx_t*)ctx;
+
+  if (!json_write_value_prefix(c)) return false;
+
+  char buf[64];
+  json_format_float(buf, sizeof(buf), value);
   return json_write_str(c, buf);
 }
 
@@ -267,6 +264,15 @@ static bool json_write_string(void* ctx, const char* value) {
   return json_write_escaped_string(c, value);
 }
 
+static bool json_write_string_chunk(void* ctx, const char* chunk, size_t size, bool first, bool last) {
+  json_ctx_t* c = (json_ctx_t*)ctx;
+  if (first && (!json_write_value_prefix(c) || !json_write_char(c, '"'))) return false;
+  for (size_t i = 0; i < size; i++) {
+    if (!json_write_escaped_char(c, (unsigned char)chunk[i])) return false;
+  }
+  return !last || json_write_char(c, '"');
+}
+
 static bool json_write_bool(void* ctx, bool value) {
   json_ctx_t* c = (json_ctx_t*)ctx;
 
@@ -374,37 +380,108 @@ static void json_skip_whitespace(text_parse_ctx_t* p) {
   }
 }
 
+// Find the index entry for a structural character at pos, or NULL when it is not indexed.
+// The parser only moves forward, so the cursor only moves forward too.
+static const size_t* json_index_find(json_ctx_t* c, size_t pos) {
+  if (!c->has_index) {
+    return NULL;
+  }
+  json_index_t* index = &c->index;
+  while (c->index_cursor < index->count && index->positions[c->index_cursor] < pos) {
+    c->index_cursor++;
+  }
+  if (c->index_cursor >= index->count || index->positions[c->index_cursor] != pos) {
+    return NULL;
+  }
+  return &index->positions[c->index_cursor];
+}
+
+// Decode the escape sequence whose backslash precedes p->pos into out, leaving p->pos on
+// its last character. Returns the number of bytes written, at most 3.
+static size_t json_decode_escape(text_parse_ctx_t* p, size_t end, char* out) {
+  char esc = p->buffer[p->pos];
+  switch (esc) {
+    case '"':  out[0] = '"'; return 1;
+    case '\\': out[0] = '\\'; return 1;
+    case '/':  out[0] = '/'; return 1;
+    case 'b':  out[0] = '\b'; return 1;
+    case 'f':  out[0] = '\f'; return 1;
+    case 'n':  out[0] = '\n'; return 1;
+    case 'r':  out[0] = '\r'; return 1;
+    case 't':  out[0] = '\t'; return 1;
+    case 'u': {
+      // Unicode escape: \uXXXX - simplified handling
+      if (p->pos + 4 >= end) {
+        return 0;
+      }
+      char hex[5] = {p->buffer[p->pos+1], p->buffer[p->pos+2],
+                     p->buffer[p->pos+3], p->buffer[p->pos+4], 0};
+      unsigned int code = (unsigned int)strtoul(hex, NULL, 16);
+      p->pos += 4;
+      if (code < 0x80) {
+        out[0] = (char)code;
+        return 1;
+      }
+      if (code < 0x800) {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+      }
+      out[0] = (char)(0xE0 | (code >> 12));
+      out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+      out[2] = (char)(0x80 | (code & 0x3F));
+      return 3;
+    }
+    default:
+      out[0] = esc;
+      return 1;
+  }
+}
+
 // Parse a JSON string, handling escape sequences
-static const char* json_parse_string(text_parse_ctx_t* p) {
+static const char* json_parse_string(json_ctx_t* c) {
+  text_parse_ctx_t* p = &c->parse;
   json_skip_whitespace(p);
 
   if (p->pos >= p->size || p->buffer[p->pos] != '"') {
     return NULL;
   }
+
+  // The closing quote is the next indexed position after the opening one, and the
+  // raw length bounds the unescaped length, so the measuring pass can be skipped
+  size_t end = p->size;
+  const size_t* open = json_index_find(c, p->pos);
+  if (open && open + 1 < c->index.positions + c->index.count && p->buffer[open[1]] == '"') {
+    end = open[1];
+  }
   p->pos++;  // Skip opening quote
 
-  // First pass: calculate length
   size_t start = p->pos;
   size_t len = 0;
-  while (p->pos < p->size && p->buffer[p->pos] != '"') {
-    if (p->buffer[p->pos] == '\\' && p->pos + 1 < p->size) {
-      p->pos++;
-      char esc = p->buffer[p->pos];
-      if (esc == 'u') {
-        // Unicode escape: \uXXXX
-        p->pos += 4;  // Skip 4 hex digits
-        len++;  // Simplified: treat as single char
+  if (end < p->size) {
+    len = end - start;
+  } else {
+    // First pass: calculate length
+    while (p->pos < p->size && p->buffer[p->pos] != '"') {
+      if (p->buffer[p->pos] == '\\' && p->pos + 1 < p->size) {
+        p->pos++;
+        char esc = p->buffer[p->pos];
+        if (esc == 'u') {
+          // Unicode escape: \uXXXX
+          p->pos += 4;  // Skip 4 hex digits
+          len++;  // Simplified: treat as single char
+        } else {
+          len++;
+        }
       } else {
         len++;
       }
-    } else {
-      len++;
+      p->pos++;
     }
-    p->pos++;
-  }
 
-  if (p->pos >= p->size) {
-    return NULL;  // Unterminated string
+    if (p->pos >= p->size) {
+      return NULL;  // Unterminated string
+    }
   }
 
   // Allocate temp string
@@ -415,43 +492,10 @@ static const char* json_parse_string(text_parse_ctx_t* p) {
   // Second pass: copy with escape handling
   p->pos = start;
   size_t out = 0;
-  while (p->pos < p->size && p->buffer[p->pos] != '"') {
+  while (p->pos < end && p->buffer[p->pos] != '"') {
     if (p->buffer[p->pos] == '\\' && p->pos + 1 < p->size) {
       p->pos++;
-      char esc = p->buffer[p->pos];
-      switch (esc) {
-        case '"':  p->temp_string[out++] = '"'; break;
-        case '\\': p->temp_string[out++] = '\\'; break;
-        case '/':  p->temp_string[out++] = '/'; break;
-        case 'b':  p->temp_string[out++] = '\b'; break;
-        case 'f':  p->temp_string[out++] = '\f'; break;
-        case 'n':  p->temp_string[out++] = '\n'; break;
-        case 'r':  p->temp_string[out++] = '\r'; break;
-        case 't':  p->temp_string[out++] = '\t'; break;
-        case 'u': {
-          // Unicode escape: \uXXXX - simplified handling
-          if (p->pos + 4 < p->size) {
-            char hex[5] = {p->buffer[p->pos+1], p->buffer[p->pos+2],
-                           p->buffer[p->pos+3], p->buffer[p->pos+4], 0};
-            unsigned int code = (unsigned int)strtoul(hex, NULL, 16);
-            if (code < 0x80) {
-              p->temp_string[out++] = (char)code;
-            } else if (code < 0x800) {
-              p->temp_string[out++] = (char)(0xC0 | (code >> 6));
-              p->temp_string[out++] = (char)(0x80 | (code & 0x3F));
-            } else {
-              p->temp_string[out++] = (char)(0xE0 | (code >> 12));
-              p->temp_string[out++] = (char)(0x80 | ((code >> 6) & 0x3F));
-              p->temp_string[out++] = (char)(0x80 | (code & 0x3F));
-            }
-            p->pos += 4;
-          }
-          break;
-        }
-        default:
-          p->temp_string[out++] = esc;
-          break;
-      }
+      out += json_decode_escape(p, end, p->temp_string + out);
     } else {
       p->temp_string[out++] = p->buffer[p->pos];
     }
@@ -514,9 +558,15 @@ static bool json_parse_number(text_parse_ctx_t* p, text_parse_number_result_t* r
   }
 
   // Parse the number
+  // Numbers are short, so copy into a stack buffer and only fall back to the
+  // temp string for unusually long literals
   size_t len = p->pos - start;
-  char* buf = olib_malloc(len + 1);
-  if (!buf) return false;
+  char stack_buf[64];
+  char* buf = stack_buf;
+  if (len >= sizeof(stack_buf)) {
+    if (!text_parse_ensure_temp(p, len)) return false;
+    buf = p->temp_string;
+  }
   memcpy(buf, p->buffer + start, len);
   buf[len] = '\0';
 
@@ -538,7 +588,6 @@ static bool json_parse_number(text_parse_ctx_t* p, text_parse_number_result_t* r
     result->float_value = (double)result->int_value;
   }
 
-  olib_free(buf);
   return true;
 }
 
@@ -658,12 +707,72 @@ static bool json_read_float(void* ctx, double* value) {
 
 static bool json_read_string(void* ctx, const char** value) {
   json_ctx_t* c = (json_ctx_t*)ctx;
-  const char* str = json_parse_string(&c->parse);
+  const char* str = json_parse_string(c);
   if (!str) return false;
   *value = str;
   return true;
 }
 
+// Whether the string from pos decodes to at most budget bytes before its closing quote.
+// Stops as soon as the budget is exceeded, so a small budget only looks a few characters ahead.
+static bool json_string_rest_fits(const text_parse_ctx_t* p, size_t pos, size_t budget) {
+  size_t out = 0;
+  while (pos < p->size && p->buffer[pos] != '"') {
+    size_t n = 1;
+    if (p->buffer[pos] == '\\' && pos + 1 < p->size) {
+      pos++;
+      if (p->buffer[pos] == 'u' && pos + 4 < p->size) {
+        char hex[5] = {p->buffer[pos+1], p->buffer[pos+2], p->buffer[pos+3], p->buffer[pos+4], 0};
+        unsigned int code = (unsigned int)strtoul(hex, NULL, 16);
+        n = code < 0x80 ? 1 : (code < 0x800 ? 2 : 3);
+        pos += 4;
+      }
+    }
+    out += n;
+    if (out > budget) return false;
+    pos++;
+  }
+  return pos < p->size;
+}
+
+static bool json_read_string_chunk(void* ctx, size_t max_size, const char** chunk, size_t* size, bool* last) {
+  json_ctx_t* c = (json_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+  if (!c->chunk_active) {
+    json_skip_whitespace(p);
+    if (p->pos >= p->size || p->buffer[p->pos] != '"') return false;
+    p->pos++;  // Skip opening quote
+    c->chunk_active = true;
+  }
+  if (!text_parse_ensure_temp(p, max_size)) return false;
+
+  // Stops short of max_size when the next escape might not fit, unless the rest of the
+  // value does, so a value of at most max_size bytes always comes in one piece
+  size_t out = 0;
+  while (p->pos < p->size && p->buffer[p->pos] != '"' && out < max_size) {
+    if (p->buffer[p->pos] == '\\' && p->pos + 1 < p->size) {
+      if (out + 3 > max_size && !json_string_rest_fits(p, p->pos, max_size - out)) break;
+      p->pos++;
+      out += json_decode_escape(p, p->size, p->temp_string + out);
+    } else {
+      p->temp_string[out++] = p->buffer[p->pos];
+    }
+    p->pos++;
+  }
+  if (p->pos >= p->size) {
+    return false;  // Unterminated string
+  }
+
+  *last = p->buffer[p->pos] == '"';
+  if (*last) {
+    p->pos++;  // Skip closing quote
+    c->chunk_active = false;
+  }
+  *chunk = p->temp_string;
+  *size = out;
+  return true;
+}
+
 static bool json_read_bool(void* ctx, bool* value) {
   json_ctx_t* c = (json_ctx_t*)ctx;
   text_parse_ctx_t* p = &c->parse;
@@ -682,6 +791,72 @@ static bool json_read_bool(void* ctx, bool* value) {
   return false;
 }
 
+static bool json_read_value(void* ctx, olib_value_t* out) {
+  json_ctx_t* c = (json_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+  json_skip_whitespace(p);
+
+  // Skip comma if present (between list/object elements)
+  if (p->pos < p->size && p->buffer[p->pos] == ',') {
+    p->pos++;
+    json_skip_whitespace(p);
+  }
+
+  if (p->pos >= p->size) {
+    return false;
+  }
+
+  char ch = p->buffer[p->pos];
+
+  if (ch == '"') {
+    out->type = OLIB_OBJECT_TYPE_STRING;
+    out->data.string_val = json_parse_string(c);
+    return out->data.string_val != NULL;
+  }
+  if (ch == '{') {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+  if (ch == '[') {
+    out->type = OLIB_OBJECT_TYPE_LIST;
+    return true;
+  }
+  if (ch == '-' || isdigit((unsigned char)ch)) {
+    // Parse once and classify from the result instead of looking ahead first
+    text_parse_number_result_t result;
+    if (!json_parse_number(p, &result)) return false;
+    if (result.is_float) {
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      out->data.float_val = result.float_value;
+    } else {
+      out->type = OLIB_OBJECT_TYPE_INT;
+      out->data.int_val = result.int_value;
+    }
+    return true;
+  }
+  if (p->pos + 4 <= p->size && strncmp(p->buffer + p->pos, "true", 4) == 0) {
+    p->pos += 4;
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = true;
+    return true;
+  }
+  if (p->pos + 5 <= p->size && strncmp(p->buffer + p->pos, "false", 5) == 0) {
+    p->pos += 5;
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = false;
+    return true;
+  }
+  if (p->pos + 4 <= p->size && strncmp(p->buffer + p->pos, "null", 4) == 0) {
+    // null - read as an int with value 0
+    p->pos += 4;
+    out->type = OLIB_OBJECT_TYPE_INT;
+    out->data.int_val = 0;
+    return true;
+  }
+
+  return false;
+}
+
 static bool json_read_list_begin(void* ctx, size_t* size) {
   json_ctx_t* c = (json_ctx_t*)ctx;
   text_parse_ctx_t* p = &c->parse;
@@ -690,6 +865,18 @@ static bool json_read_list_begin(void* ctx, size_t* size) {
   if (p->pos >= p->size || p->buffer[p->pos] != '[') {
     return false;
   }
+  // The index already counted the elements of every list
+  if (c->has_index) {
+    json_index_t* index = &c->index;
+    while (c->list_cursor < index->list_count && index->lists[c->list_cursor].pos < p->pos) {
+      c->list_cursor++;
+    }
+    if (c->list_cursor < index->list_count && index->lists[c->list_cursor].pos == p->pos) {
+      *size = index->lists[c->list_cursor].count;
+      p->pos++;  // Skip '['
+      return true;
+    }
+  }
   p->pos++;  // Skip '['
 
   // Count elements by scanning ahead (without consuming)
@@ -783,7 +970,7 @@ static bool json_read_struct_key(void* ctx, const char** key) {
   }
 
   // Read key (must be a string)
-  const char* k = json_parse_string(p);
+  const char* k = json_parse_string(c);
   if (!k) return false;
 
   // Skip colon
@@ -815,14 +1002,15 @@ static bool json_read_struct_end(void* ctx) {
 
 static void json_free_ctx(void* ctx) {
   json_ctx_t* c = (json_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   text_parse_free(&c->parse);
+  json_index_free(&c->index);
   olib_free(c);
 }
 
 static bool json_init_write(void* ctx) {
   json_ctx_t* c = (json_ctx_t*)ctx;
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   c->indent_level = 0;
   c->stack_depth = 0;
   c->pending_key = NULL;
@@ -835,41 +1023,118 @@ static bool json_finish_write(void* ctx, uint8_t** out_data, size_t* out_size) {
     return false;
   }
 
-  // Add newline and null terminator
-  if (!json_ensure_write_capacity(c, 2)) return false;
-  c->write_buffer[c->write_size++] = '\n';
-  c->write_buffer[c->write_size] = '\0';
-
-  *out_data = (uint8_t*)c->write_buffer;
-  *out_size = c->write_size;
+  // Add newline, the shared output buffer terminates and hands over the result
+  if (!olib_output_buffer_reserve(&c->write, 1)) return false;
+  c->write.data[c->write.size++] = '\n';
 
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool json_init_read(void* ctx, const uint8_t* data, size_t size) {
   json_ctx_t* c = (json_ctx_t*)ctx;
   text_parse_init(&c->parse, (const char*)data, size);
+
+  // Large inputs get a structural index, built in parallel. Without one (small
+  // input, a single CPU or out of memory) the parser scans the bytes itself.
+  c->index_cursor = 0;
+  c->list_cursor = 0;
+  c->chunk_active = false;
+  if (size >= c->index_min_size) {
+    size_t threads = c->index_threads ? c->index_threads : olib_thread_cpu_count();
+    if (threads > 1 || c->index_threads) {
+      c->has_index = json_index_build(&c->index, (const char*)data, size, threads);
+    }
+  }
   return true;
 }
 
 static bool json_finish_read(void* ctx) {
   json_ctx_t* c = (json_ctx_t*)ctx;
   text_parse_reset(&c->parse);
+  json_index_free(&c->index);
+  c->has_index = false;
   return true;
 }
 
+static olib_output_buffer_t* json_output_buffer(void* ctx) {
+  return &((json_ctx_t*)ctx)->write;
+}
+
+// #############################################################################
+// Template scalars
+// #############################################################################
+
+static bool json_template_emit(olib_stream_buffer_t* out, const char* data, size_t size) {
+  return olib_stream_buffer_append(out, data, size);
+}
+
+bool json_text_template_scalar(olib_stream_buffer_t* out, olib_object_t* value) {
+  char buf[64];
+  switch (olib_object_get_type(value)) {
+    case OLIB_OBJECT_TYPE_INT:
+      return json_template_emit(out, buf, text_format_int(buf, olib_object_get_int(value)));
+    case OLIB_OBJECT_TYPE_UINT:
+      return json_template_emit(out, buf, text_format_uint(buf, olib_object_get_uint(value)));
+    case OLIB_OBJECT_TYPE_FLOAT:
+      json_format_float(buf, sizeof(buf), olib_object_get_float(value));
+      return json_template_emit(out, buf, strlen(buf));
+    case OLIB_OBJECT_TYPE_BOOL:
+      return olib_object_get_bool(value) ? json_template_emit(out, "true", 4) : json_template_emit(out, "false", 5);
+    case OLIB_OBJECT_TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  // Same escapes as json_write_escaped_string, copying unescaped runs in one go
+  const char* str = olib_object_get_string(value);
+  if (!json_template_emit(out, "\"", 1)) return false;
+  if (str) {
+    const char* run = str;
+    for (const char* p = str; *p; p++) {
+      unsigned char c = (unsigned char)*p;
+      const char* escape;
+      switch (c) {
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\b': escape = "\\b"; break;
+        case '\f': escape = "\\f"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        default:
+          if (c >= 0x20) continue;
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          escape = buf;
+          break;
+      }
+      if (!json_template_emit(out, run, (size_t)(p - run))) return false;
+      if (!json_template_emit(out, escape, strlen(escape))) return false;
+      run = p + 1;
+    }
+    if (!json_template_emit(out, run, strlen(run))) return false;
+  }
+  return json_template_emit(out, "\"", 1);
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
 
 OLIB_API olib_serializer_t* olib_serializer_new_json_text() {
+  return olib_serializer_new_json_text_ex(NULL);
+}
+
+OLIB_API olib_serializer_t* olib_serializer_new_json_text_ex(const olib_json_text_options_t* options) {
   json_ctx_t* ctx = olib_calloc(1, sizeof(json_ctx_t));
   if (!ctx) {
     return NULL;
   }
+  ctx->index_min_size = JSON_INDEX_MIN_SIZE;
+  if (options) {
+    if (options->index_min_size) ctx->index_min_size = options->index_min_size;
+    ctx->index_threads = options->index_threads;
+  }
 
   olib_serializer_config_t config = {
     .user_data = ctx,
@@ -879,11 +1144,13 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_text() {
     .finish_write = json_finish_write,
     .init_read = json_init_read,
     .finish_read = json_finish_read,
+    .output_buffer = json_output_buffer,
 
     .write_int = json_write_int,
     .write_uint = json_write_uint,
     .write_float = json_write_float,
     .write_string = json_write_string,
+    .write_string_chunk = json_write_string_chunk,
     .write_bool = json_write_bool,
     .write_list_begin = json_write_list_begin,
     .write_list_end = json_write_list_end,
@@ -892,10 +1159,12 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_text() {
     .write_struct_end = json_write_struct_end,
 
     .read_peek = json_read_peek,
+    .read_value = json_read_value,
     .read_int = json_read_int,
     .read_uint = json_read_uint,
     .read_float = json_read_float,
     .read_string = json_read_string,
+    .read_string_chunk = json_read_string_chunk,
     .read_bool = json_read_bool,
     .read_list_begin = json_read_list_begin,
     .read_list_end = json_read_list_end,
@@ -909,6 +1178,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_json_text() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_JSON_TEXT);
 
   return serializer;
 }
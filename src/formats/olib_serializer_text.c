@@ -23,7 +23,10 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include "text_parsing_utilities.h"
+#include "text_scalars.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,9 +38,7 @@ SOFTWARE.
 
 typedef struct {
   // Write mode
-  char* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
   int indent_level;
   bool in_list;
   bool list_first_item;
@@ -53,41 +54,57 @@ typedef struct {
 // Write helpers
 // #############################################################################
 
-static bool text_ensure_write_capacity(text_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  char* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool text_write_str(text_ctx_t* ctx, const char* str) {
   size_t len = strlen(str);
-  if (!text_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, str, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, str, len);
+  ctx->write.size += len;
   return true;
 }
 
 static bool text_write_char(text_ctx_t* ctx, char c) {
-  if (!text_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = c;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = c;
   return true;
 }
 
+// Write a double-quoted string with special characters escaped
+static bool text_write_quoted(text_ctx_t* ctx, const char* str) {
+  if (!text_write_char(ctx, '"')) return false;
+  for (const char* p = str; *p; p++) {
+    switch (*p) {
+      case '"':
+        if (!text_write_str(ctx, "\\\"")) return false;
+        break;
+      case '\\':
+        if (!text_write_str(ctx, "\\\\")) return false;
+        break;
+      case '\n':
+        if (!text_write_str(ctx, "\\n")) return false;
+        break;
+      case '\r':
+        if (!text_write_str(ctx, "\\r")) return false;
+        break;
+      case '\t':
+        if (!text_write_str(ctx, "\\t")) return false;
+        break;
+      default:
+        if (!text_write_char(ctx, *p)) return false;
+        break;
+    }
+  }
+  return text_write_char(ctx, '"');
+}
+
+// Write a key bare when it is an identifier, quoted otherwise (e.g. negative map keys)
+static bool text_write_key(text_ctx_t* ctx, const char* key) {
+  bool bare = *key != '\0';
+  for (const char* p = key; *p && bare; p++) {
+    bare = text_parse_is_identifier_char(*p);
+  }
+  return bare ? text_write_str(ctx, key) : text_write_quoted(ctx, key);
+}
+
 static bool text_write_indent(text_ctx_t* ctx) {
   for (int i = 0; i < ctx->indent_level; i++) {
     if (!text_write_char(ctx, '\t')) return false;
@@ -97,17 +114,19 @@ static bool text_write_indent(text_ctx_t* ctx) {
 
 static bool text_write_key_prefix(text_ctx_t* ctx) {
   if (ctx->pending_key) {
+    size_t key_begin = ctx->write.size;
+    if (!text_write_key(ctx, ctx->pending_key)) return false;
+    olib_output_buffer_mark_key(&ctx->write, key_begin);
     if (ctx->in_struct) {
       // Inside struct: "key: "
-      if (!text_write_str(ctx, ctx->pending_key)) return false;
       if (!text_write_str(ctx, ": ")) return false;
     } else {
       // Top-level: "key "
-      if (!text_write_str(ctx, ctx->pending_key)) return false;
       if (!text_write_char(ctx, ' ')) return false;
     }
     ctx->pending_key = NULL;
   }
+  olib_output_buffer_mark_value(&ctx->write);
   return true;
 }
 
@@ -133,9 +152,9 @@ static bool text_write_int(void* ctx, int64_t value) {
 
   if (!text_write_key_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%lld", (long long)value);
-  return text_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_int((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
 static bool text_write_uint(void* ctx, uint64_t value) {
@@ -156,9 +175,9 @@ static bool text_write_uint(void* ctx, uint64_t value) {
 
   if (!text_write_key_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
-  return text_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_uint((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
 static bool text_write_float(void* ctx, double value) {
@@ -202,34 +221,7 @@ static bool text_write_string(void* ctx, const char* value) {
 
   if (!text_write_key_prefix(c)) return false;
 
-  if (!text_write_char(c, '"')) return false;
-  if (value) {
-    // Escape special characters
-    for (const char* p = value; *p; p++) {
-      switch (*p) {
-        case '"':
-          if (!text_write_str(c, "\\\"")) return false;
-          break;
-        case '\\':
-          if (!text_write_str(c, "\\\\")) return false;
-          break;
-        case '\n':
-          if (!text_write_str(c, "\\n")) return false;
-          break;
-        case '\r':
-          if (!text_write_str(c, "\\r")) return false;
-          break;
-        case '\t':
-          if (!text_write_str(c, "\\t")) return false;
-          break;
-        default:
-          if (!text_write_char(c, *p)) return false;
-          break;
-      }
-    }
-  }
-  if (!text_write_char(c, '"')) return false;
-  return true;
+  return text_write_quoted(c, value ? value : "");
 }
 
 static bool text_write_bool(void* ctx, bool value) {
@@ -428,6 +420,63 @@ static bool text_read_bool(void* ctx, bool* value) {
   return false;
 }
 
+static bool text_read_value(void* ctx, olib_value_t* out) {
+  text_ctx_t* c = (text_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+  text_parse_skip_whitespace_and_comments(p);
+
+  // Skip comma if present (between list/struct elements)
+  if (p->pos < p->size && p->buffer[p->pos] == ',') {
+    p->pos++;
+    text_parse_skip_whitespace_and_comments(p);
+  }
+
+  if (text_parse_eof(p)) {
+    return false;
+  }
+
+  char ch = text_parse_peek_raw(p);
+
+  if (ch == '"') {
+    out->type = OLIB_OBJECT_TYPE_STRING;
+    out->data.string_val = text_parse_quoted_string(p);
+    return out->data.string_val != NULL;
+  }
+  if (ch == '{') {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+  if (ch == '[') {
+    out->type = OLIB_OBJECT_TYPE_LIST;
+    return true;
+  }
+  if (ch == '-' || ch == '+' || isdigit((unsigned char)ch)) {
+    // Parse once and classify from the result instead of looking ahead first
+    text_parse_number_result_t result;
+    if (!text_parse_number(p, &result)) return false;
+    if (result.is_float) {
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      out->data.float_val = result.float_value;
+    } else {
+      out->type = OLIB_OBJECT_TYPE_INT;
+      out->data.int_val = result.int_value;
+    }
+    return true;
+  }
+  if (text_parse_match_str(p, "true")) {
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = true;
+    return true;
+  }
+  if (text_parse_match_str(p, "false")) {
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = false;
+    return true;
+  }
+
+  return false;
+}
+
 static bool text_read_list_begin(void* ctx, size_t* size) {
   text_ctx_t* c = (text_ctx_t*)ctx;
   text_parse_ctx_t* p = &c->parse;
@@ -496,8 +545,8 @@ static bool text_read_struct_key(void* ctx, const char** key) {
     return false;
   }
 
-  // Read identifier
-  const char* id = text_parse_identifier(p);
+  // Read identifier, or a quoted key for keys that are not identifiers
+  const char* id = text_parse_peek_raw(p) == '"' ? text_parse_quoted_string(p) : text_parse_identifier(p);
   if (!id) return false;
 
   // Skip colon
@@ -519,14 +568,14 @@ static bool text_read_struct_end(void* ctx) {
 
 static void text_free_ctx(void* ctx) {
   text_ctx_t* c = (text_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   text_parse_free(&c->parse);
   olib_free(c);
 }
 
 static bool text_init_write(void* ctx) {
   text_ctx_t* c = (text_ctx_t*)ctx;
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   c->indent_level = 0;
   c->in_list = false;
   c->list_first_item = true;
@@ -542,17 +591,8 @@ static bool text_finish_write(void* ctx, uint8_t** out_data, size_t* out_size) {
     return false;
   }
 
-  // Add null terminator
-  if (!text_ensure_write_capacity(c, 1)) return false;
-  c->write_buffer[c->write_size] = '\0';
-
-  *out_data = (uint8_t*)c->write_buffer;
-  *out_size = c->write_size;
-
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  // Terminated and handed over by the shared output buffer
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool text_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -567,6 +607,60 @@ static bool text_finish_read(void* ctx) {
   return true;
 }
 
+static olib_output_buffer_t* text_output_buffer(void* ctx) {
+  return &((text_ctx_t*)ctx)->write;
+}
+
+// #############################################################################
+// Template scalars
+// #############################################################################
+
+static bool text_template_emit(olib_stream_buffer_t* out, const char* data, size_t size) {
+  return olib_stream_buffer_append(out, data, size);
+}
+
+bool text_template_scalar(olib_stream_buffer_t* out, olib_object_t* value) {
+  char buf[64];
+  switch (olib_object_get_type(value)) {
+    case OLIB_OBJECT_TYPE_INT:
+      return text_template_emit(out, buf, text_format_int(buf, olib_object_get_int(value)));
+    case OLIB_OBJECT_TYPE_UINT:
+      return text_template_emit(out, buf, text_format_uint(buf, olib_object_get_uint(value)));
+    case OLIB_OBJECT_TYPE_FLOAT:
+      snprintf(buf, sizeof(buf), "%g", olib_object_get_float(value));
+      return text_template_emit(out, buf, strlen(buf));
+    case OLIB_OBJECT_TYPE_BOOL:
+      return olib_object_get_bool(value) ? text_template_emit(out, "true", 4) : text_template_emit(out, "false", 5);
+    case OLIB_OBJECT_TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  // Same escapes as text_write_string, copying unescaped runs in one go
+  const char* str = olib_object_get_string(value);
+  if (!text_template_emit(out, "\"", 1)) return false;
+  if (str) {
+    const char* run = str;
+    for (const char* p = str; *p; p++) {
+      const char* escape;
+      switch (*p) {
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        default: continue;
+      }
+      if (!text_template_emit(out, run, (size_t)(p - run))) return false;
+      if (!text_template_emit(out, escape, 2)) return false;
+      run = p + 1;
+    }
+    if (!text_template_emit(out, run, strlen(run))) return false;
+  }
+  return text_template_emit(out, "\"", 1);
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
@@ -585,6 +679,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_txt() {
     .finish_write = text_finish_write,
     .init_read = text_init_read,
     .finish_read = text_finish_read,
+    .output_buffer = text_output_buffer,
 
     .write_int = text_write_int,
     .write_uint = text_write_uint,
@@ -598,6 +693,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_txt() {
     .write_struct_end = text_write_struct_end,
 
     .read_peek = text_read_peek,
+    .read_value = text_read_value,
     .read_int = text_read_int,
     .read_uint = text_read_uint,
     .read_float = text_read_float,
@@ -615,6 +711,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_txt() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_TXT);
 
   return serializer;
 }
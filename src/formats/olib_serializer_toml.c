@@ -23,7 +23,10 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include "text_parsing_utilities.h"
+#include "text_scalars.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,9 +38,7 @@ SOFTWARE.
 
 typedef struct {
   // Write mode
-  char* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
   int nesting_level;       // Track nesting depth (0 = top-level table)
   bool in_list;
   bool list_first_item;
@@ -53,38 +54,17 @@ typedef struct {
 // Write helpers
 // #############################################################################
 
-static bool toml_ensure_write_capacity(toml_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  char* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool toml_write_str(toml_ctx_t* ctx, const char* str) {
   size_t len = strlen(str);
-  if (!toml_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, str, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, str, len);
+  ctx->write.size += len;
   return true;
 }
 
 static bool toml_write_char(toml_ctx_t* ctx, char c) {
-  if (!toml_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = c;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = c;
   return true;
 }
 
@@ -138,10 +118,13 @@ static bool toml_write_key(toml_ctx_t* ctx, const char* key) {
 // Write key prefix with " = " for inline or newline for top-level
 static bool toml_write_key_prefix(toml_ctx_t* ctx) {
   if (ctx->pending_key) {
+    size_t key_begin = ctx->write.size;
     if (!toml_write_key(ctx, ctx->pending_key)) return false;
+    olib_output_buffer_mark_key(&ctx->write, key_begin);
     if (!toml_write_str(ctx, " = ")) return false;
     ctx->pending_key = NULL;
   }
+  olib_output_buffer_mark_value(&ctx->write);
   return true;
 }
 
@@ -171,11 +154,11 @@ static bool toml_write_int(void* ctx, int64_t value) {
   if (!toml_write_item_separator(c)) return false;
   if (!toml_write_key_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%lld", (long long)value);
-  if (!toml_write_str(c, buf)) return false;
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_int((char*)c->write.data + c->write.size, value);
 
   // Add newline if at top-level table
+  olib_output_buffer_close_value(&c->write);
   if (c->nesting_level == 1 && !c->in_list && !c->in_inline_table) {
     if (!toml_write_char(c, '\n')) return false;
   }
@@ -189,11 +172,11 @@ static bool toml_write_uint(void* ctx, uint64_t value) {
   if (!toml_write_item_separator(c)) return false;
   if (!toml_write_key_prefix(c)) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
-  if (!toml_write_str(c, buf)) return false;
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_uint((char*)c->write.data + c->write.size, value);
 
   // Add newline if at top-level table
+  olib_output_buffer_close_value(&c->write);
   if (c->nesting_level == 1 && !c->in_list && !c->in_inline_table) {
     if (!toml_write_char(c, '\n')) return false;
   }
@@ -201,15 +184,10 @@ static bool toml_write_uint(void* ctx, uint64_t value) {
   return true;
 }
 
-static bool toml_write_float(void* ctx, double value) {
-  toml_ctx_t* c = (toml_ctx_t*)ctx;
-
-  if (!toml_write_item_separator(c)) return false;
-  if (!toml_write_key_prefix(c)) return false;
-
-  char buf[64];
+// Format a float the way TOML writes it (buf must hold at least 64 bytes)
+static void toml_format_float(char* buf, size_t size, double value) {
   // TOML requires a decimal point for floats, use %g but ensure decimal point
-  snprintf(buf, sizeof(buf), "%g", value);
+  snprintf(buf, size, "%g", value);
   // If there's no decimal point or exponent, add .0
   bool has_decimal = false;
   for (char* p = buf; *p; p++) {
@@ -218,12 +196,23 @@ static bool toml_write_float(void* ctx, double value) {
       break;
     }
   }
-  if (!toml_write_str(c, buf)) return false;
   if (!has_decimal) {
-    if (!toml_write_str(c, ".0")) return false;
+    strcat(buf, ".0");
   }
+}
+
+static bool toml_write_float(void* ctx, double value) {
+  toml_ctx_t* c = (toml_ctx_t*)ctx;
+
+  if (!toml_write_item_separator(c)) return false;
+  if (!toml_write_key_prefix(c)) return false;
+
+  char buf[64];
+  toml_format_float(buf, sizeof(buf), value);
+  if (!toml_write_str(c, buf)) return false;
 
   // Add newline if at top-level table
+  olib_output_buffer_close_value(&c->write);
   if (c->nesting_level == 1 && !c->in_list && !c->in_inline_table) {
     if (!toml_write_char(c, '\n')) return false;
   }
@@ -279,6 +268,7 @@ static bool toml_write_string(void* ctx, const char* value) {
   if (!toml_write_char(c, '"')) return false;
 
   // Add newline if at top-level table
+  olib_output_buffer_close_value(&c->write);
   if (c->nesting_level == 1 && !c->in_list && !c->in_inline_table) {
     if (!toml_write_char(c, '\n')) return false;
   }
@@ -295,6 +285,7 @@ static bool toml_write_bool(void* ctx, bool value) {
   if (!toml_write_str(c, value ? "true" : "false")) return false;
 
   // Add newline if at top-level table
+  olib_output_buffer_close_value(&c->write);
   if (c->nesting_level == 1 && !c->in_list && !c->in_inline_table) {
     if (!toml_write_char(c, '\n')) return false;
   }
@@ -433,8 +424,41 @@ static const char* toml_parse_key(text_parse_ctx_t* p) {
     return text_parse_single_quoted_string(p);
   }
 
-  // Bare key
-  return text_parse_identifier(p);
+  // Bare key (A-Za-z0-9_-, so negative decimal keys stay bare)
+  size_t start = p->pos;
+  while (p->pos < p->size && (text_parse_is_identifier_char(p->buffer[p->pos]) || p->buffer[p->pos] == '-')) {
+    p->pos++;
+  }
+  size_t len = p->pos - start;
+  if (len == 0) return NULL;
+
+  if (!text_parse_ensure_temp(p, len)) return NULL;
+  memcpy(p->temp_string, p->buffer + start, len);
+  p->temp_string[len] = '\0';
+  return p->temp_string;
+}
+
+// Check whether a key followed by '=' starts at the current position, without consuming it
+static bool toml_key_at(text_parse_ctx_t* p) {
+  size_t pos = p->pos;
+  char quote = p->buffer[pos];
+  if (quote == '"' || quote == '\'') {
+    for (pos++; pos < p->size && p->buffer[pos] != quote && p->buffer[pos] != '\n'; pos++) {
+      if (quote == '"' && p->buffer[pos] == '\\') pos++;
+    }
+    if (pos >= p->size || p->buffer[pos] != quote) return false;
+    pos++;
+  } else {
+    size_t start = pos;
+    while (pos < p->size && (text_parse_is_identifier_char(p->buffer[pos]) || p->buffer[pos] == '-')) {
+      pos++;
+    }
+    if (pos == start) return false;
+  }
+  while (pos < p->size && (p->buffer[pos] == ' ' || p->buffer[pos] == '\t')) {
+    pos++;
+  }
+  return pos < p->size && p->buffer[pos] == '=';
 }
 
 // Parse a TOML literal string (single quotes, no escapes except '' for ')
@@ -463,6 +487,11 @@ static olib_object_type_t toml_read_peek(void* ctx) {
 
   char ch = text_parse_peek_raw(p);
 
+  // The document root is a table even when its first key is quoted or looks like a number
+  if (c->nesting_level == 0 && toml_key_at(p)) {
+    return OLIB_OBJECT_TYPE_STRUCT;
+  }
+
   // String (basic or literal)
   if (ch == '"' || ch == '\'') {
     return OLIB_OBJECT_TYPE_STRING;
@@ -511,19 +540,8 @@ static olib_object_type_t toml_read_peek(void* ctx) {
 
   // Check if this looks like a key = value pair (implicit struct/table)
   // This handles the case where a top-level struct is serialized as key-value pairs
-  if (text_parse_is_identifier_char(ch)) {
-    size_t saved_pos = p->pos;
-    // Try to parse a key
-    const char* key = toml_parse_key(p);
-    if (key) {
-      toml_skip_whitespace_and_comments(p);
-      if (p->pos < p->size && p->buffer[p->pos] == '=') {
-        // This is a key=value pair, indicating a struct
-        p->pos = saved_pos;
-        return OLIB_OBJECT_TYPE_STRUCT;
-      }
-    }
-    p->pos = saved_pos;
+  if (text_parse_is_identifier_char(ch) && toml_key_at(p)) {
+    return OLIB_OBJECT_TYPE_STRUCT;
   }
 
   return OLIB_OBJECT_TYPE_MAX;
@@ -595,6 +613,87 @@ static bool toml_read_bool(void* ctx, bool* value) {
   return false;
 }
 
+static bool toml_read_value(void* ctx, olib_value_t* out) {
+  toml_ctx_t* c = (toml_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+  toml_skip_whitespace_and_comments(p);
+
+  // Skip comma if present (between list/inline table elements)
+  if (p->pos < p->size && p->buffer[p->pos] == ',') {
+    p->pos++;
+    toml_skip_whitespace_and_comments(p);
+  }
+
+  if (text_parse_eof(p)) {
+    return false;
+  }
+
+  char ch = text_parse_peek_raw(p);
+
+  // The document root is a table even when its first key is quoted or looks like a number
+  if (c->nesting_level == 0 && toml_key_at(p)) {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+
+  // String (basic or literal)
+  if (ch == '"' || ch == '\'') {
+    out->type = OLIB_OBJECT_TYPE_STRING;
+    out->data.string_val = ch == '"' ? text_parse_quoted_string(p) : toml_parse_literal_string(p);
+    return out->data.string_val != NULL;
+  }
+
+  // Inline table
+  if (ch == '{') {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+
+  // Array
+  if (ch == '[') {
+    out->type = OLIB_OBJECT_TYPE_LIST;
+    return true;
+  }
+
+  // Number (parsed once and classified from the result)
+  if (ch == '-' || ch == '+' || isdigit((unsigned char)ch)) {
+    text_parse_number_result_t result;
+    if (!text_parse_number(p, &result)) return false;
+    if (result.is_float) {
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      out->data.float_val = result.float_value;
+    } else {
+      out->type = OLIB_OBJECT_TYPE_INT;
+      out->data.int_val = result.int_value;
+    }
+    return true;
+  }
+
+  // Boolean (not part of a longer identifier)
+  if (ch == 't' && p->pos + 4 <= p->size && strncmp(p->buffer + p->pos, "true", 4) == 0 &&
+      (p->pos + 4 >= p->size || !text_parse_is_identifier_char(p->buffer[p->pos + 4]))) {
+    p->pos += 4;
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = true;
+    return true;
+  }
+  if (ch == 'f' && p->pos + 5 <= p->size && strncmp(p->buffer + p->pos, "false", 5) == 0 &&
+      (p->pos + 5 >= p->size || !text_parse_is_identifier_char(p->buffer[p->pos + 5]))) {
+    p->pos += 5;
+    out->type = OLIB_OBJECT_TYPE_BOOL;
+    out->data.bool_val = false;
+    return true;
+  }
+
+  // A key = value pair means an implicit (top-level) table
+  if (toml_read_peek(ctx) == OLIB_OBJECT_TYPE_STRUCT) {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+
+  return false;
+}
+
 static bool toml_read_list_begin(void* ctx, size_t* size) {
   toml_ctx_t* c = (toml_ctx_t*)ctx;
   text_parse_ctx_t* p = &c->parse;
@@ -746,14 +845,14 @@ static bool toml_read_struct_end(void* ctx) {
 
 static void toml_free_ctx(void* ctx) {
   toml_ctx_t* c = (toml_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   text_parse_free(&c->parse);
   olib_free(c);
 }
 
 static bool toml_init_write(void* ctx) {
   toml_ctx_t* c = (toml_ctx_t*)ctx;
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   c->nesting_level = 0;
   c->in_list = false;
   c->list_first_item = true;
@@ -769,17 +868,8 @@ static bool toml_finish_write(void* ctx, uint8_t** out_data, size_t* out_size) {
     return false;
   }
 
-  // Add null terminator
-  if (!toml_ensure_write_capacity(c, 1)) return false;
-  c->write_buffer[c->write_size] = '\0';
-
-  *out_data = (uint8_t*)c->write_buffer;
-  *out_size = c->write_size;
-
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  // Terminated and handed over by the shared output buffer
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool toml_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -797,6 +887,67 @@ static bool toml_finish_read(void* ctx) {
   return true;
 }
 
+static olib_output_buffer_t* toml_output_buffer(void* ctx) {
+  return &((toml_ctx_t*)ctx)->write;
+}
+
+// #############################################################################
+// Template scalars
+// #############################################################################
+
+static bool toml_template_emit(olib_stream_buffer_t* out, const char* data, size_t size) {
+  return olib_stream_buffer_append(out, data, size);
+}
+
+bool toml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value) {
+  char buf[64];
+  switch (olib_object_get_type(value)) {
+    case OLIB_OBJECT_TYPE_INT:
+      return toml_template_emit(out, buf, text_format_int(buf, olib_object_get_int(value)));
+    case OLIB_OBJECT_TYPE_UINT:
+      return toml_template_emit(out, buf, text_format_uint(buf, olib_object_get_uint(value)));
+    case OLIB_OBJECT_TYPE_FLOAT:
+      toml_format_float(buf, sizeof(buf), olib_object_get_float(value));
+      return toml_template_emit(out, buf, strlen(buf));
+    case OLIB_OBJECT_TYPE_BOOL:
+      return olib_object_get_bool(value) ? toml_template_emit(out, "true", 4) : toml_template_emit(out, "false", 5);
+    case OLIB_OBJECT_TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  // Same escapes as toml_write_string, copying unescaped runs in one go
+  const char* str = olib_object_get_string(value);
+  if (!toml_template_emit(out, "\"", 1)) return false;
+  if (str) {
+    const char* run = str;
+    for (const char* p = str; *p; p++) {
+      unsigned char c = (unsigned char)*p;
+      const char* escape;
+      switch (c) {
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\b': escape = "\\b"; break;
+        case '\f': escape = "\\f"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        default:
+          if (c >= 0x20) continue;
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          escape = buf;
+          break;
+      }
+      if (!toml_template_emit(out, run, (size_t)(p - run))) return false;
+      if (!toml_template_emit(out, escape, strlen(escape))) return false;
+      run = p + 1;
+    }
+    if (!toml_template_emit(out, run, strlen(run))) return false;
+  }
+  return toml_template_emit(out, "\"", 1);
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
@@ -815,6 +966,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_toml() {
     .finish_write = toml_finish_write,
     .init_read = toml_init_read,
     .finish_read = toml_finish_read,
+    .output_buffer = toml_output_buffer,
 
     .write_int = toml_write_int,
     .write_uint = toml_write_uint,
@@ -828,6 +980,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_toml() {
     .write_struct_end = toml_write_struct_end,
 
     .read_peek = toml_read_peek,
+    .read_value = toml_read_value,
     .read_int = toml_read_int,
     .read_uint = toml_read_uint,
     .read_float = toml_read_float,
@@ -845,6 +998,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_toml() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_TOML);
 
   return serializer;
 }
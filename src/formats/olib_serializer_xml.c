@@ -23,7 +23,10 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include "text_parsing_utilities.h"
+#include "text_scalars.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -52,9 +55,7 @@ typedef enum {
 
 typedef struct {
   // Write mode
-  char* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
   int indent_level;
   bool in_list;
   bool list_first_item;
@@ -78,38 +79,17 @@ typedef struct {
 // Write helpers
 // #############################################################################
 
-static bool xml_ensure_write_capacity(xml_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  char* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool xml_write_str(xml_ctx_t* ctx, const char* str) {
   size_t len = strlen(str);
-  if (!xml_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, str, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, str, len);
+  ctx->write.size += len;
   return true;
 }
 
 static bool xml_write_char(xml_ctx_t* ctx, char c) {
-  if (!xml_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = c;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = c;
   return true;
 }
 
@@ -182,26 +162,28 @@ static bool xml_write_struct_value_begin(xml_ctx_t* ctx, const char* type_tag) {
   if (ctx->in_struct && ctx->pending_key) {
     // Inside struct: <key name="field" type="int">value</key>
     if (!xml_write_str(ctx, "<key name=\"")) return false;
+    size_t key_begin = ctx->write.size;
     if (!xml_write_escaped(ctx, ctx->pending_key)) return false;
+    olib_output_buffer_mark_key(&ctx->write, key_begin);
     if (!xml_write_str(ctx, "\" type=\"")) return false;
     if (!xml_write_str(ctx, type_tag)) return false;
     if (!xml_write_str(ctx, "\">")) return false;
     ctx->pending_key = NULL;
-    return true;
   } else if (ctx->in_list) {
     // Inside list: <item type="int">value</item>
     if (!xml_write_str(ctx, "<item type=\"")) return false;
     if (!xml_write_str(ctx, type_tag)) return false;
     if (!xml_write_str(ctx, "\">")) return false;
-    return true;
   } else {
     // Top-level: <int>value</int>
     if (!xml_write_open_tag(ctx, type_tag)) return false;
-    return true;
   }
+  olib_output_buffer_mark_value(&ctx->write);
+  return true;
 }
 
 static bool xml_write_struct_value_end(xml_ctx_t* ctx, const char* type_tag) {
+  olib_output_buffer_close_value(&ctx->write);
   if (ctx->in_struct) {
     // Close </key>
     if (!xml_write_str(ctx, "</key>")) return false;
@@ -238,9 +220,8 @@ static bool xml_write_int(void* ctx, int64_t value) {
 
   if (!xml_write_struct_value_begin(c, "int")) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%lld", (long long)value);
-  if (!xml_write_str(c, buf)) return false;
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_int((char*)c->write.data + c->write.size, value);
 
   if (!xml_write_struct_value_end(c, "int")) return false;
   return true;
@@ -265,9 +246,8 @@ static bool xml_write_uint(void* ctx, uint64_t value) {
 
   if (!xml_write_struct_value_begin(c, "uint")) return false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
-  if (!xml_write_str(c, buf)) return false;
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_uint((char*)c->write.data + c->write.size, value);
 
   if (!xml_write_struct_value_end(c, "uint")) return false;
   return true;
@@ -370,7 +350,9 @@ static bool xml_write_list_begin(void* ctx, size_t size) {
   // Handle struct key for nested containers
   if (c->in_struct && c->pending_key) {
     if (!xml_write_str(c, "<key name=\"")) return false;
+    size_t key_begin = c->write.size;
     if (!xml_write_escaped(c, c->pending_key)) return false;
+    olib_output_buffer_mark_key(&c->write, key_begin);
     if (!xml_write_str(c, "\" type=\"list\">")) return false;
     c->pending_key = NULL;
     container_type = XML_CONTAINER_KEY;
@@ -447,7 +429,9 @@ static bool xml_write_struct_begin(void* ctx) {
   // Handle struct key for nested containers
   if (c->in_struct && c->pending_key) {
     if (!xml_write_str(c, "<key name=\"")) return false;
+    size_t key_begin = c->write.size;
     if (!xml_write_escaped(c, c->pending_key)) return false;
+    olib_output_buffer_mark_key(&c->write, key_begin);
     if (!xml_write_str(c, "\" type=\"struct\">")) return false;
     c->pending_key = NULL;
     container_type = XML_CONTAINER_KEY;
@@ -742,6 +726,16 @@ static const char* xml_parse_text_content(text_parse_ctx_t* p) {
   return p->temp_string;
 }
 
+// Skip a closing tag without touching temp_string
+static void xml_skip_close_tag(text_parse_ctx_t* p) {
+  xml_parse_skip_ws_and_comments(p);
+  if (p->pos + 1 >= p->size || p->buffer[p->pos] != '<' || p->buffer[p->pos + 1] != '/') return;
+  while (p->pos < p->size && p->buffer[p->pos] != '>') {
+    p->pos++;
+  }
+  if (p->pos < p->size) p->pos++;
+}
+
 // Skip to after a closing tag
 static bool xml_skip_to_close_tag(text_parse_ctx_t* p, const char* tag_name) {
   xml_tag_info_t info;
@@ -925,31 +919,10 @@ static bool xml_read_string(void* ctx, const char** value) {
   const char* content = xml_parse_text_content(p);
   if (!content) return false;
 
-  // Make a more permanent copy in temp_string
-  size_t len = strlen(content);
-  if (!text_parse_ensure_temp(p, len + 1)) return false;
-
-  // Content is already in temp_string from xml_parse_text_content
-  // so we need to preserve it before parsing the closing tag
-
-  // Allocate a separate buffer for the string
-  char* str_copy = olib_malloc(len + 1);
-  if (!str_copy) return false;
-  strcpy(str_copy, content);
-
-  // Skip closing tag
-  xml_tag_info_t close_info;
-  xml_parse_tag(p, &close_info);
-
-  // Copy back to temp_string for return
-  if (!text_parse_ensure_temp(p, len + 1)) {
-    olib_free(str_copy);
-    return false;
-  }
-  strcpy(p->temp_string, str_copy);
-  olib_free(str_copy);
+  // Content lives in temp_string, so skip the closing tag without parsing its name
+  xml_skip_close_tag(p);
 
-  *value = p->temp_string;
+  *value = content;
   return true;
 }
 
@@ -992,6 +965,78 @@ static bool xml_read_bool(void* ctx, bool* value) {
   return true;
 }
 
+static bool xml_read_value(void* ctx, olib_value_t* out) {
+  xml_ctx_t* c = (xml_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+
+  xml_parse_skip_ws_and_comments(p);
+
+  // The opening tag is parsed once here (unless a struct key already did); for
+  // containers it is left pending so read_list_begin / read_struct_begin skip it
+  if (!c->has_pending_type) {
+    if (p->pos >= p->size || p->buffer[p->pos] != '<') return false;
+    size_t saved_pos = p->pos;
+    xml_tag_info_t info;
+    if (!xml_parse_tag(p, &info) || info.is_closing_tag) {
+      p->pos = saved_pos;
+      return false;
+    }
+    if (strcmp(info.tag_name, "olib") == 0 || strcmp(info.tag_name, "root") == 0) {
+      c->pending_value_type = OLIB_OBJECT_TYPE_STRUCT;
+    } else {
+      c->pending_value_type = xml_get_type_from_tag(&info);
+    }
+    if (c->pending_value_type == OLIB_OBJECT_TYPE_MAX) {
+      p->pos = saved_pos;
+      return false;
+    }
+    c->pending_tag_info = info;
+    c->has_pending_type = true;
+  }
+
+  out->type = c->pending_value_type;
+  if (out->type == OLIB_OBJECT_TYPE_LIST || out->type == OLIB_OBJECT_TYPE_STRUCT) {
+    return true;
+  }
+  c->has_pending_type = false;
+
+  const char* content = xml_parse_text_content(p);
+  if (!content) return false;
+
+  switch (out->type) {
+    case OLIB_OBJECT_TYPE_INT:
+      out->data.int_val = strtoll(content, NULL, 10);
+      break;
+    case OLIB_OBJECT_TYPE_UINT:
+      out->data.uint_val = strtoull(content, NULL, 10);
+      break;
+    case OLIB_OBJECT_TYPE_FLOAT:
+      out->data.float_val = strtod(content, NULL);
+      break;
+    case OLIB_OBJECT_TYPE_STRING:
+      out->data.string_val = content;
+      break;
+    case OLIB_OBJECT_TYPE_BOOL: {
+      // Trim whitespace
+      const char* start = content;
+      while (*start == ' ' || *start == '\t' || *start == '\n' || *start == '\r') start++;
+      size_t len = strlen(start);
+      while (len > 0 && (start[len - 1] == ' ' || start[len - 1] == '\t' ||
+                         start[len - 1] == '\n' || start[len - 1] == '\r')) {
+        len--;
+      }
+      out->data.bool_val = (len == 4 && strncmp(start, "true", 4) == 0) || (len == 1 && start[0] == '1');
+      break;
+    }
+    default:
+      return false;
+  }
+
+  // Content lives in temp_string, so skip the closing tag without parsing its name
+  xml_skip_close_tag(p);
+  return true;
+}
+
 static bool xml_read_list_begin(void* ctx, size_t* size) {
   xml_ctx_t* c = (xml_ctx_t*)ctx;
   text_parse_ctx_t* p = &c->parse;
@@ -1126,14 +1171,14 @@ static bool xml_read_struct_end(void* ctx) {
 
 static void xml_free_ctx(void* ctx) {
   xml_ctx_t* c = (xml_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   text_parse_free(&c->parse);
   olib_free(c);
 }
 
 static bool xml_init_write(void* ctx) {
   xml_ctx_t* c = (xml_ctx_t*)ctx;
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   c->indent_level = 0;
   c->in_list = false;
   c->list_first_item = true;
@@ -1163,18 +1208,10 @@ static bool xml_finish_write(void* ctx, uint8_t** out_data, size_t* out_size) {
     if (!xml_write_str(c, "\n</olib>\n")) return false;
   }
 
-  // Add null terminator
-  if (!xml_ensure_write_capacity(c, 1)) return false;
-  c->write_buffer[c->write_size] = '\0';
-
-  *out_data = (uint8_t*)c->write_buffer;
-  *out_size = c->write_size;
-
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
   c->needs_root_close = false;
-  return true;
+
+  // Terminated and handed over by the shared output buffer
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool xml_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -1216,6 +1253,57 @@ static bool xml_finish_read(void* ctx) {
   return true;
 }
 
+static olib_output_buffer_t* xml_output_buffer(void* ctx) {
+  return &((xml_ctx_t*)ctx)->write;
+}
+
+// #############################################################################
+// Template scalars
+// #############################################################################
+
+static bool xml_template_emit(olib_stream_buffer_t* out, const char* data, size_t size) {
+  return olib_stream_buffer_append(out, data, size);
+}
+
+bool xml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value) {
+  char buf[64];
+  switch (olib_object_get_type(value)) {
+    case OLIB_OBJECT_TYPE_INT:
+      return xml_template_emit(out, buf, text_format_int(buf, olib_object_get_int(value)));
+    case OLIB_OBJECT_TYPE_UINT:
+      return xml_template_emit(out, buf, text_format_uint(buf, olib_object_get_uint(value)));
+    case OLIB_OBJECT_TYPE_FLOAT:
+      snprintf(buf, sizeof(buf), "%g", olib_object_get_float(value));
+      return xml_template_emit(out, buf, strlen(buf));
+    case OLIB_OBJECT_TYPE_BOOL:
+      return olib_object_get_bool(value) ? xml_template_emit(out, "true", 4) : xml_template_emit(out, "false", 5);
+    case OLIB_OBJECT_TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  // Same escapes as xml_write_escaped, the tags around the value are static
+  const char* str = olib_object_get_string(value);
+  if (!str) return true;
+  const char* run = str;
+  for (const char* p = str; *p; p++) {
+    const char* escape;
+    switch (*p) {
+      case '&': escape = "&amp;"; break;
+      case '<': escape = "&lt;"; break;
+      case '>': escape = "&gt;"; break;
+      case '"': escape = "&quot;"; break;
+      case '\'': escape = "&apos;"; break;
+      default: continue;
+    }
+    if (!xml_template_emit(out, run, (size_t)(p - run))) return false;
+    if (!xml_template_emit(out, escape, strlen(escape))) return false;
+    run = p + 1;
+  }
+  return xml_template_emit(out, run, strlen(run));
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
@@ -1234,6 +1322,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_xml() {
     .finish_write = xml_finish_write,
     .init_read = xml_init_read,
     .finish_read = xml_finish_read,
+    .output_buffer = xml_output_buffer,
 
     .write_int = xml_write_int,
     .write_uint = xml_write_uint,
@@ -1247,6 +1336,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_xml() {
     .write_struct_end = xml_write_struct_end,
 
     .read_peek = xml_read_peek,
+    .read_value = xml_read_value,
     .read_int = xml_read_int,
     .read_uint = xml_read_uint,
     .read_float = xml_read_float,
@@ -1264,6 +1354,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_xml() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_XML);
 
   return serializer;
 }
@@ -23,7 +23,10 @@ SOFTWARE.
 */
 
 #include <olib/olib_formats.h>
+#include "../olib_output_internal.h"
+#include "../olib_trace_internal.h"
 #include "text_parsing_utilities.h"
+#include "text_scalars.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,9 +39,7 @@ SOFTWARE.
 
 typedef struct {
   // Write mode
-  char* write_buffer;
-  size_t write_capacity;
-  size_t write_size;
+  olib_output_buffer_t write;
   int indent_level;
   bool in_flow_list;
   bool flow_list_first_item;
@@ -65,38 +66,17 @@ typedef struct {
 // Write helpers
 // #############################################################################
 
-static bool yaml_ensure_write_capacity(yaml_ctx_t* ctx, size_t needed) {
-  size_t required = ctx->write_size + needed;
-  if (required <= ctx->write_capacity) {
-    return true;
-  }
-
-  size_t new_capacity = ctx->write_capacity ? ctx->write_capacity * 2 : 256;
-  while (new_capacity < required) {
-    new_capacity *= 2;
-  }
-
-  char* new_buffer = olib_realloc(ctx->write_buffer, new_capacity);
-  if (!new_buffer) {
-    return false;
-  }
-
-  ctx->write_buffer = new_buffer;
-  ctx->write_capacity = new_capacity;
-  return true;
-}
-
 static bool yaml_write_str(yaml_ctx_t* ctx, const char* str) {
   size_t len = strlen(str);
-  if (!yaml_ensure_write_capacity(ctx, len)) return false;
-  memcpy(ctx->write_buffer + ctx->write_size, str, len);
-  ctx->write_size += len;
+  if (!olib_output_buffer_reserve(&ctx->write, len)) return false;
+  memcpy(ctx->write.data + ctx->write.size, str, len);
+  ctx->write.size += len;
   return true;
 }
 
 static bool yaml_write_char(yaml_ctx_t* ctx, char c) {
-  if (!yaml_ensure_write_capacity(ctx, 1)) return false;
-  ctx->write_buffer[ctx->write_size++] = c;
+  if (!olib_output_buffer_reserve(&ctx->write, 1)) return false;
+  ctx->write.data[ctx->write.size++] = c;
   return true;
 }
 
@@ -163,13 +143,49 @@ static bool yaml_needs_quoting(const char* str) {
   return false;
 }
 
+// Write a double-quoted scalar with special characters escaped
+static bool yaml_write_quoted(yaml_ctx_t* ctx, const char* str) {
+  if (!yaml_write_char(ctx, '"')) return false;
+  for (const char* p = str; *p; p++) {
+    switch (*p) {
+      case '"':
+        if (!yaml_write_str(ctx, "\\\"")) return false;
+        break;
+      case '\\':
+        if (!yaml_write_str(ctx, "\\\\")) return false;
+        break;
+      case '\n':
+        if (!yaml_write_str(ctx, "\\n")) return false;
+        break;
+      case '\r':
+        if (!yaml_write_str(ctx, "\\r")) return false;
+        break;
+      case '\t':
+        if (!yaml_write_str(ctx, "\\t")) return false;
+        break;
+      default:
+        if (!yaml_write_char(ctx, *p)) return false;
+        break;
+    }
+  }
+  return yaml_write_char(ctx, '"');
+}
+
 static bool yaml_write_key_prefix(yaml_ctx_t* ctx) {
   if (ctx->pending_key) {
-    if (!yaml_write_str(ctx, ctx->pending_key)) return false;
+    size_t key_begin = ctx->write.size;
+    // Keys that would read back as numbers, booleans or syntax are quoted like values
+    if (yaml_needs_quoting(ctx->pending_key)) {
+      if (!yaml_write_quoted(ctx, ctx->pending_key)) return false;
+    } else if (!yaml_write_str(ctx, ctx->pending_key)) {
+      return false;
+    }
+    olib_output_buffer_mark_key(&ctx->write, key_begin);
     if (!yaml_write_str(ctx, ": ")) return false;
     ctx->pending_key = NULL;
     ctx->struct_inline_value = true;
   }
+  olib_output_buffer_mark_value(&ctx->write);
   return true;
 }
 
@@ -199,9 +215,9 @@ static bool yaml_write_int(void* ctx, int64_t value) {
   if (!yaml_write_key_prefix(c)) return false;
   c->struct_inline_value = false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%lld", (long long)value);
-  return yaml_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_int((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
 static bool yaml_write_uint(void* ctx, uint64_t value) {
@@ -226,9 +242,9 @@ static bool yaml_write_uint(void* ctx, uint64_t value) {
   if (!yaml_write_key_prefix(c)) return false;
   c->struct_inline_value = false;
 
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
-  return yaml_write_str(c, buf);
+  if (!olib_output_buffer_reserve(&c->write, TEXT_FORMAT_INT_MAX)) return false;
+  c->write.size += text_format_uint((char*)c->write.data + c->write.size, value);
+  return true;
 }
 
 static bool yaml_write_float(void* ctx, double value) {
@@ -282,33 +298,7 @@ static bool yaml_write_string(void* ctx, const char* value) {
 
   // Check if we need to quote the string
   if (!value || yaml_needs_quoting(value)) {
-    if (!yaml_write_char(c, '"')) return false;
-    if (value) {
-      // Escape special characters
-      for (const char* p = value; *p; p++) {
-        switch (*p) {
-          case '"':
-            if (!yaml_write_str(c, "\\\"")) return false;
-            break;
-          case '\\':
-            if (!yaml_write_str(c, "\\\\")) return false;
-            break;
-          case '\n':
-            if (!yaml_write_str(c, "\\n")) return false;
-            break;
-          case '\r':
-            if (!yaml_write_str(c, "\\r")) return false;
-            break;
-          case '\t':
-            if (!yaml_write_str(c, "\\t")) return false;
-            break;
-          default:
-            if (!yaml_write_char(c, *p)) return false;
-            break;
-        }
-      }
-    }
-    if (!yaml_write_char(c, '"')) return false;
+    if (!yaml_write_quoted(c, value ? value : "")) return false;
   } else {
     // Unquoted string
     if (!yaml_write_str(c, value)) return false;
@@ -530,6 +520,33 @@ static void yaml_skip_block_list_prefix(yaml_ctx_t* c) {
   }
 }
 
+// Check whether the quoted scalar at pos is a mapping key ("key": value)
+static bool yaml_quoted_key_at(text_parse_ctx_t* p, size_t pos) {
+  char quote = p->buffer[pos++];
+  while (pos < p->size && p->buffer[pos] != '\n') {
+    if (quote == '"' && p->buffer[pos] == '\\') {
+      pos += 2;
+      continue;
+    }
+    if (p->buffer[pos] == quote) {
+      // A doubled single quote is an escaped quote inside the scalar
+      if (quote == '\'' && pos + 1 < p->size && p->buffer[pos + 1] == '\'') {
+        pos += 2;
+        continue;
+      }
+      pos++;
+      while (pos < p->size && (p->buffer[pos] == ' ' || p->buffer[pos] == '\t')) {
+        pos++;
+      }
+      return pos < p->size && p->buffer[pos] == ':' &&
+             (pos + 1 >= p->size || p->buffer[pos + 1] == ' ' ||
+              p->buffer[pos + 1] == '\n' || p->buffer[pos + 1] == '\r');
+    }
+    pos++;
+  }
+  return false;
+}
+
 // #############################################################################
 // Read callbacks
 // #############################################################################
@@ -586,9 +603,9 @@ static olib_object_type_t yaml_read_peek(void* ctx) {
     return OLIB_OBJECT_TYPE_STRUCT;
   }
 
-  // Quoted string
+  // Quoted string, or a quoted key opening a mapping
   if (ch == '"' || ch == '\'') {
-    return OLIB_OBJECT_TYPE_STRING;
+    return yaml_quoted_key_at(p, peek_pos) ? OLIB_OBJECT_TYPE_STRUCT : OLIB_OBJECT_TYPE_STRING;
   }
 
   // Number (possibly negative)
@@ -749,6 +766,122 @@ static bool yaml_read_bool(void* ctx, bool* value) {
   return false;
 }
 
+// Boolean keywords in the order yaml_read_bool tries them
+static const struct {
+  const char* word;
+  size_t len;
+  bool value;
+} g_yaml_bool_keywords[] = {
+  {"true", 4, true}, {"True", 4, true}, {"TRUE", 4, true},
+  {"yes", 3, true}, {"Yes", 3, true}, {"YES", 3, true},
+  {"on", 2, true}, {"On", 2, true}, {"ON", 2, true},
+  {"false", 5, false}, {"False", 5, false}, {"FALSE", 5, false},
+  {"no", 2, false}, {"No", 2, false}, {"NO", 2, false},
+  {"off", 3, false}, {"Off", 3, false}, {"OFF", 3, false},
+};
+
+static bool yaml_read_value(void* ctx, olib_value_t* out) {
+  yaml_ctx_t* c = (yaml_ctx_t*)ctx;
+  text_parse_ctx_t* p = &c->parse;
+  text_parse_skip_whitespace_and_comments(p);
+
+  // Skip comma if present (between flow list/object elements)
+  if (p->pos < p->size && p->buffer[p->pos] == ',') {
+    p->pos++;
+    text_parse_skip_whitespace_and_comments(p);
+  }
+
+  if (text_parse_eof(p)) {
+    return false;
+  }
+
+  char ch = text_parse_peek_raw(p);
+
+  // Inside a block list the value starts after "- ", which is only consumed for scalars
+  size_t peek_pos = p->pos;
+  if (c->reading_block_list && ch == '-' &&
+      p->pos + 1 < p->size && (p->buffer[p->pos + 1] == ' ' || p->buffer[p->pos + 1] == '\n')) {
+    peek_pos += 2;
+    while (peek_pos < p->size && (p->buffer[peek_pos] == ' ' || p->buffer[peek_pos] == '\t')) {
+      peek_pos++;
+    }
+    if (peek_pos >= p->size) {
+      return false;
+    }
+    ch = p->buffer[peek_pos];
+  }
+
+  // Containers are left unconsumed for read_list_begin / read_struct_begin
+  if ((ch == '-' && peek_pos + 1 < p->size && (p->buffer[peek_pos + 1] == ' ' || p->buffer[peek_pos + 1] == '\n')) ||
+      ch == '[') {
+    out->type = OLIB_OBJECT_TYPE_LIST;
+    return true;
+  }
+  if (ch == '{') {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+
+  // Quoted key opening a mapping
+  if ((ch == '"' || ch == '\'') && yaml_quoted_key_at(p, peek_pos)) {
+    out->type = OLIB_OBJECT_TYPE_STRUCT;
+    return true;
+  }
+
+  // Quoted string
+  if (ch == '"' || ch == '\'') {
+    yaml_skip_block_list_prefix(c);
+    text_parse_skip_whitespace(p);
+    out->type = OLIB_OBJECT_TYPE_STRING;
+    out->data.string_val = ch == '"' ? text_parse_quoted_string(p) : text_parse_single_quoted_string(p);
+    return out->data.string_val != NULL;
+  }
+
+  // Number (parsed once and classified from the result)
+  if (ch == '-' || ch == '+' || isdigit((unsigned char)ch)) {
+    yaml_skip_block_list_prefix(c);
+    text_parse_number_result_t result;
+    if (!text_parse_number(p, &result)) return false;
+    if (result.is_float) {
+      out->type = OLIB_OBJECT_TYPE_FLOAT;
+      out->data.float_val = result.float_value;
+    } else {
+      out->type = OLIB_OBJECT_TYPE_INT;
+      out->data.int_val = result.int_value;
+    }
+    return true;
+  }
+
+  // Boolean keywords
+  for (size_t i = 0; i < sizeof(g_yaml_bool_keywords) / sizeof(g_yaml_bool_keywords[0]); i++) {
+    if (peek_pos + g_yaml_bool_keywords[i].len <= p->size &&
+        strncmp(p->buffer + peek_pos, g_yaml_bool_keywords[i].word, g_yaml_bool_keywords[i].len) == 0) {
+      yaml_skip_block_list_prefix(c);
+      if (!text_parse_match_str(p, g_yaml_bool_keywords[i].word)) return false;
+      out->type = OLIB_OBJECT_TYPE_BOOL;
+      out->data.bool_val = g_yaml_bool_keywords[i].value;
+      return true;
+    }
+  }
+
+  // A key (colon followed by whitespace) on this line means a mapping
+  for (size_t pos = peek_pos; pos < p->size && p->buffer[pos] != '\n' && p->buffer[pos] != '#'; pos++) {
+    if (p->buffer[pos] == ':' &&
+        (pos + 1 >= p->size || p->buffer[pos + 1] == ' ' ||
+         p->buffer[pos + 1] == '\n' || p->buffer[pos + 1] == '\r')) {
+      out->type = OLIB_OBJECT_TYPE_STRUCT;
+      return true;
+    }
+  }
+
+  // Unquoted string
+  yaml_skip_block_list_prefix(c);
+  text_parse_skip_whitespace(p);
+  out->type = OLIB_OBJECT_TYPE_STRING;
+  out->data.string_val = yaml_parse_unquoted_value(p);
+  return out->data.string_val != NULL;
+}
+
 static bool yaml_read_list_begin(void* ctx, size_t* size) {
   yaml_ctx_t* c = (yaml_ctx_t*)ctx;
   yaml_skip_block_list_prefix(c);
@@ -959,14 +1092,14 @@ static bool yaml_read_struct_end(void* ctx) {
 
 static void yaml_free_ctx(void* ctx) {
   yaml_ctx_t* c = (yaml_ctx_t*)ctx;
-  if (c->write_buffer) olib_free(c->write_buffer);
+  olib_output_buffer_free(&c->write);
   text_parse_free(&c->parse);
   olib_free(c);
 }
 
 static bool yaml_init_write(void* ctx) {
   yaml_ctx_t* c = (yaml_ctx_t*)ctx;
-  c->write_size = 0;
+  olib_output_buffer_begin(&c->write);
   c->indent_level = 0;
   c->in_flow_list = false;
   c->flow_list_first_item = true;
@@ -985,17 +1118,8 @@ static bool yaml_finish_write(void* ctx, uint8_t** out_data, size_t* out_size) {
     return false;
   }
 
-  // Add null terminator
-  if (!yaml_ensure_write_capacity(c, 1)) return false;
-  c->write_buffer[c->write_size] = '\0';
-
-  *out_data = (uint8_t*)c->write_buffer;
-  *out_size = c->write_size;
-
-  c->write_buffer = NULL;
-  c->write_capacity = 0;
-  c->write_size = 0;
-  return true;
+  // Terminated and handed over by the shared output buffer
+  return olib_output_buffer_finish(&c->write, out_data, out_size);
 }
 
 static bool yaml_init_read(void* ctx, const uint8_t* data, size_t size) {
@@ -1015,6 +1139,63 @@ static bool yaml_finish_read(void* ctx) {
   return true;
 }
 
+static olib_output_buffer_t* yaml_output_buffer(void* ctx) {
+  return &((yaml_ctx_t*)ctx)->write;
+}
+
+// #############################################################################
+// Template scalars
+// #############################################################################
+
+static bool yaml_template_emit(olib_stream_buffer_t* out, const char* data, size_t size) {
+  return olib_stream_buffer_append(out, data, size);
+}
+
+bool yaml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value) {
+  char buf[64];
+  switch (olib_object_get_type(value)) {
+    case OLIB_OBJECT_TYPE_INT:
+      return yaml_template_emit(out, buf, text_format_int(buf, olib_object_get_int(value)));
+    case OLIB_OBJECT_TYPE_UINT:
+      return yaml_template_emit(out, buf, text_format_uint(buf, olib_object_get_uint(value)));
+    case OLIB_OBJECT_TYPE_FLOAT:
+      snprintf(buf, sizeof(buf), "%g", olib_object_get_float(value));
+      return yaml_template_emit(out, buf, strlen(buf));
+    case OLIB_OBJECT_TYPE_BOOL:
+      return olib_object_get_bool(value) ? yaml_template_emit(out, "true", 4) : yaml_template_emit(out, "false", 5);
+    case OLIB_OBJECT_TYPE_STRING:
+      break;
+    default:
+      return false;
+  }
+
+  // Same quoting and escapes as yaml_write_string, copying unescaped runs in one go
+  const char* str = olib_object_get_string(value);
+  if (str && !yaml_needs_quoting(str)) {
+    return yaml_template_emit(out, str, strlen(str));
+  }
+  if (!yaml_template_emit(out, "\"", 1)) return false;
+  if (str) {
+    const char* run = str;
+    for (const char* p = str; *p; p++) {
+      const char* escape;
+      switch (*p) {
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        default: continue;
+      }
+      if (!yaml_template_emit(out, run, (size_t)(p - run))) return false;
+      if (!yaml_template_emit(out, escape, 2)) return false;
+      run = p + 1;
+    }
+    if (!yaml_template_emit(out, run, strlen(run))) return false;
+  }
+  return yaml_template_emit(out, "\"", 1);
+}
+
 // #############################################################################
 // Public API
 // #############################################################################
@@ -1033,6 +1214,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_yaml() {
     .finish_write = yaml_finish_write,
     .init_read = yaml_init_read,
     .finish_read = yaml_finish_read,
+    .output_buffer = yaml_output_buffer,
 
     .write_int = yaml_write_int,
     .write_uint = yaml_write_uint,
@@ -1046,6 +1228,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_yaml() {
     .write_struct_end = yaml_write_struct_end,
 
     .read_peek = yaml_read_peek,
+    .read_value = yaml_read_value,
     .read_int = yaml_read_int,
     .read_uint = yaml_read_uint,
     .read_float = yaml_read_float,
@@ -1063,6 +1246,7 @@ OLIB_API olib_serializer_t* olib_serializer_new_yaml() {
     olib_free(ctx);
     return NULL;
   }
+  olib_serializer_set_format(serializer, OLIB_FORMAT_YAML);
 
   return serializer;
 }
@@ -35,8 +35,6 @@ void text_parse_init(text_parse_ctx_t* ctx, const char* buffer, size_t size) {
   ctx->buffer = buffer;
   ctx->size = size;
   ctx->pos = 0;
-  ctx->temp_string = NULL;
-  ctx->temp_string_capacity = 0;
 }
 
 void text_parse_reset(text_parse_ctx_t* ctx) {
@@ -381,6 +379,56 @@ const char* text_parse_single_quoted_string(text_parse_ctx_t* ctx) {
   return ctx->temp_string;
 }
 
+// #############################################################################
+// Number formatting
+// #############################################################################
+
+// Two ASCII digits for every value 0-99, so the formatter emits a pair per division
+static const char g_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+size_t text_format_uint(char* out, uint64_t value) {
+  // Fill a scratch buffer from the end, then copy the digits to the front of 'out'
+  char buf[TEXT_FORMAT_INT_MAX];
+  char* p = buf + sizeof(buf);
+
+  while (value >= 100) {
+    unsigned idx = (unsigned)(value % 100) * 2;
+    value /= 100;
+    *--p = g_digit_pairs[idx + 1];
+    *--p = g_digit_pairs[idx];
+  }
+  if (value >= 10) {
+    unsigned idx = (unsigned)value * 2;
+    *--p = g_digit_pairs[idx + 1];
+    *--p = g_digit_pairs[idx];
+  } else {
+    *--p = (char)('0' + value);
+  }
+
+  size_t len = (size_t)(buf + sizeof(buf) - p);
+  memcpy(out, p, len);
+  return len;
+}
+
+size_t text_format_int(char* out, int64_t value) {
+  if (value < 0) {
+    // Negate in unsigned arithmetic so INT64_MIN does not overflow
+    out[0] = '-';
+    return 1 + text_format_uint(out + 1, 0 - (uint64_t)value);
+  }
+  return text_format_uint(out, (uint64_t)value);
+}
+
 // #############################################################################
 // Utility functions
 // #############################################################################
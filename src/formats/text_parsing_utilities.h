@@ -45,7 +45,8 @@ typedef struct {
 // Context management
 // #############################################################################
 
-// Initialize a parsing context with the given buffer
+// Initialize a parsing context with the given buffer (keeps temp_string allocation,
+// so the context must start zeroed)
 void text_parse_init(text_parse_ctx_t* ctx, const char* buffer, size_t size);
 
 // Reset the parsing context (keeps temp_string allocation)
@@ -133,6 +134,22 @@ const char* text_parse_quoted_string(text_parse_ctx_t* ctx);
 // Returns pointer to temp_string or NULL on failure
 const char* text_parse_single_quoted_string(text_parse_ctx_t* ctx);
 
+// #############################################################################
+// Number formatting
+// #############################################################################
+
+// Largest number of characters text_format_int/text_format_uint can produce
+// ("-9223372036854775808" and "18446744073709551615" are both 20)
+#define TEXT_FORMAT_INT_MAX 20
+
+// Format an unsigned integer in decimal into 'out' (no null terminator)
+// 'out' must have room for TEXT_FORMAT_INT_MAX characters, returns the length written
+size_t text_format_uint(char* out, uint64_t value);
+
+// Format a signed integer in decimal into 'out' (no null terminator)
+// 'out' must have room for TEXT_FORMAT_INT_MAX characters, returns the length written
+size_t text_format_int(char* out, int64_t value);
+
 // #############################################################################
 // Utility functions
 // #############################################################################
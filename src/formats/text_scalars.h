@@ -0,0 +1,40 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib.h>
+#include "../olib_stream_internal.h"
+
+// Scalar encoders for olib_template. Each one appends exactly the bytes the format's
+// write callback emits for a scalar value, without the separator, indentation or key
+// that precede it. Keep them in sync with the write callbacks next to them.
+
+typedef bool (*text_scalar_fn)(olib_stream_buffer_t* out, olib_object_t* value);
+
+bool json_text_template_scalar(olib_stream_buffer_t* out, olib_object_t* value);
+bool yaml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value);
+bool xml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value);
+bool toml_template_scalar(olib_stream_buffer_t* out, olib_object_t* value);
+bool text_template_scalar(olib_stream_buffer_t* out, olib_object_t* value);
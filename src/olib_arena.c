@@ -0,0 +1,470 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// mmap flags, madvise, ftruncate and mkstemp are hidden by strict C11 on glibc
+#if defined(__linux__)
+#  define _GNU_SOURCE
+#endif
+
+#include <olib/olib_arena.h>
+#include "olib_base_internal.h"
+#include "olib_thread.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define OLIB_ARENA_SUPPORTED 1
+#else
+#  define OLIB_ARENA_SUPPORTED 0
+#endif
+
+#if OLIB_ARENA_SUPPORTED
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// Blocks are multiples of 16 bytes with an 8-byte header in front of a 16-byte aligned
+// payload. Sizes and free list links are 32-bit counts of 16-byte units.
+#define ARENA_UNIT 16
+#define ARENA_HEADER 8
+#define ARENA_MAX_UNITS UINT32_MAX
+
+// Blocks up to this many units have an exact size class, larger ones are rounded up
+// to a power of two and share a class per power
+#define ARENA_EXACT_UNITS 64
+#define ARENA_CLASSES (ARENA_EXACT_UNITS + 32)
+
+#define ARENA_DEFAULT_GROW ((size_t)64 << 20)
+#if SIZE_MAX > 0xFFFFFFFFu
+#  define ARENA_DEFAULT_RESERVE ((size_t)64 << 30)
+#else
+#  define ARENA_DEFAULT_RESERVE ((size_t)512 << 20)
+#endif
+
+typedef struct arena_header_t {
+    uint32_t units;  // Block size including the header
+    uint32_t free;   // Nonzero while the block is on a free list
+} arena_header_t;
+
+struct olib_mmap_arena_t {
+    int fd;
+    uint8_t* base;
+    size_t reserved;
+    size_t mapped;
+    size_t grow_size;
+    size_t top;    // Offset of the first byte past the last block
+    size_t dirty;  // Offset of the first byte no block ever covered, later bytes read as zero
+    size_t used;   // Bytes in live blocks
+    olib_mmap_advice_t advice;
+    uint32_t free_lists[ARENA_CLASSES];  // Payload offsets in units, 0 when empty
+};
+
+// Arena behind olib_malloc while it is in use, guarded by olib_thread_lock
+static olib_mmap_arena_t* g_arena = NULL;
+
+// Memory functions installed before the arena. They still own the blocks allocated
+// before the switch, and come back when the arena is detached.
+static olib_malloc_fn g_prev_malloc_fn = malloc;
+static olib_free_fn g_prev_free_fn = free;
+static olib_calloc_fn g_prev_calloc_fn = calloc;
+static olib_realloc_fn g_prev_realloc_fn = realloc;
+
+// #############################################################################
+// Mapping
+// #############################################################################
+
+static int arena_advice_flag(olib_mmap_advice_t advice) {
+    switch (advice) {
+        case OLIB_MMAP_ADVICE_SEQUENTIAL: return MADV_SEQUENTIAL;
+        case OLIB_MMAP_ADVICE_RANDOM: return MADV_RANDOM;
+        default: return MADV_NORMAL;
+    }
+}
+
+// Extend the file and its mapping so that the first end bytes are usable
+static bool arena_grow(olib_mmap_arena_t* arena, size_t end) {
+    if (end > arena->reserved) {
+        return false;
+    }
+    size_t new_mapped = (end + arena->grow_size - 1) / arena->grow_size * arena->grow_size;
+    if (new_mapped > arena->reserved) {
+        new_mapped = arena->reserved;
+    }
+    if (ftruncate(arena->fd, (off_t)new_mapped) != 0) {
+        return false;
+    }
+    // The new pages replace part of the PROT_NONE reservation, so addresses never move
+    void* mapped = mmap(arena->base + arena->mapped, new_mapped - arena->mapped, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, arena->fd, (off_t)arena->mapped);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapped, new_mapped - arena->mapped, arena_advice_flag(arena->advice));
+    arena->mapped = new_mapped;
+    return true;
+}
+
+static int arena_create_file(const char* directory) {
+    if (!directory) {
+        directory = getenv("TMPDIR");
+    }
+    if (!directory || !*directory) {
+        directory = "/tmp";
+    }
+    size_t len = strlen(directory);
+    char* path = (char*)malloc(len + sizeof("/olib-arena-XXXXXX"));
+    if (!path) {
+        return -1;
+    }
+    memcpy(path, directory, len);
+    memcpy(path + len, "/olib-arena-XXXXXX", sizeof("/olib-arena-XXXXXX"));
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+    free(path);
+    return fd;
+}
+
+// #############################################################################
+// Blocks
+// #############################################################################
+
+static size_t arena_class(uint32_t units) {
+    if (units <= ARENA_EXACT_UNITS) {
+        return units - 1;
+    }
+    size_t log2 = 0;
+    while (((uint64_t)1 << log2) < units) {
+        log2++;
+    }
+    return ARENA_EXACT_UNITS + log2 - 6;
+}
+
+// Units for a payload of size bytes, rounded to what its class holds (0 if too large)
+static uint32_t arena_units(size_t size) {
+    if (size > (size_t)ARENA_MAX_UNITS * ARENA_UNIT / 2) {
+        return 0;
+    }
+    uint64_t units = (size + ARENA_HEADER + ARENA_UNIT - 1) / ARENA_UNIT;
+    if (units > ARENA_EXACT_UNITS) {
+        uint64_t rounded = 1;
+        while (rounded < units) {
+            rounded <<= 1;
+        }
+        units = rounded;
+    }
+    return units > ARENA_MAX_UNITS ? 0 : (uint32_t)units;
+}
+
+static arena_header_t* arena_header(void* ptr) {
+    return (arena_header_t*)((uint8_t*)ptr - ARENA_HEADER);
+}
+
+static bool arena_owns(olib_mmap_arena_t* arena, void* ptr) {
+    return (uint8_t*)ptr > arena->base && (uint8_t*)ptr < arena->base + arena->reserved;
+}
+
+// Move the end of the last block, the mapping must already cover it
+static void arena_extend(olib_mmap_arena_t* arena, size_t end) {
+    arena->top = end;
+    if (end > arena->dirty) {
+        arena->dirty = end;
+    }
+}
+
+static void* arena_alloc(olib_mmap_arena_t* arena, size_t size, bool* fresh) {
+    uint32_t units = arena_units(size);
+    if (units == 0) {
+        return NULL;
+    }
+    size_t cls = arena_class(units);
+    uint8_t* payload;
+    if (arena->free_lists[cls]) {
+        payload = arena->base + (size_t)arena->free_lists[cls] * ARENA_UNIT;
+        memcpy(&arena->free_lists[cls], payload, sizeof(uint32_t));
+        *fresh = false;
+    } else {
+        size_t end = arena->top + (size_t)units * ARENA_UNIT;
+        if (end > arena->mapped && !arena_grow(arena, end)) {
+            return NULL;
+        }
+        payload = arena->base + arena->top + ARENA_HEADER;
+        *fresh = arena->top >= arena->dirty;
+        arena_extend(arena, end);
+    }
+    arena_header_t* header = arena_header(payload);
+    header->units = units;
+    header->free = 0;
+    arena->used += (size_t)units * ARENA_UNIT;
+    return payload;
+}
+
+static void arena_release(olib_mmap_arena_t* arena, void* ptr) {
+    arena_header_t* header = arena_header(ptr);
+    size_t cls = arena_class(header->units);
+    header->free = 1;
+    arena->used -= (size_t)header->units * ARENA_UNIT;
+
+    // Once nothing is live every block is forgotten, and the next ones start at the front
+    if (arena->used == 0) {
+        memset(arena->free_lists, 0, sizeof(arena->free_lists));
+        arena->top = ARENA_UNIT - ARENA_HEADER;
+        return;
+    }
+    // The last block gives its bytes back to the top instead of a free list
+    size_t start = (size_t)((uint8_t*)header - arena->base);
+    if (start + (size_t)header->units * ARENA_UNIT == arena->top) {
+        arena->top = start;
+        return;
+    }
+    uint32_t offset = (uint32_t)(((uint8_t*)ptr - arena->base) / ARENA_UNIT);
+    memcpy(ptr, &arena->free_lists[cls], sizeof(uint32_t));
+    arena->free_lists[cls] = offset;
+}
+
+// #############################################################################
+// Memory functions
+// #############################################################################
+
+static void* arena_malloc_fn(size_t size) {
+    bool fresh;
+    olib_thread_lock();
+    void* ptr = arena_alloc(g_arena, size, &fresh);
+    olib_thread_unlock();
+    return ptr;
+}
+
+static void arena_free_fn(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    olib_thread_lock();
+    if (arena_owns(g_arena, ptr)) {
+        arena_release(g_arena, ptr);
+        olib_thread_unlock();
+        return;
+    }
+    olib_thread_unlock();
+    g_prev_free_fn(ptr);
+}
+
+static void* arena_calloc_fn(size_t num, size_t size) {
+    if (size != 0 && num > SIZE_MAX / size) {
+        return NULL;
+    }
+    bool fresh;
+    olib_thread_lock();
+    void* ptr = arena_alloc(g_arena, num * size, &fresh);
+    olib_thread_unlock();
+    // Never-used file pages read as zero, only recycled blocks need clearing
+    if (ptr && !fresh) {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
+
+static void* arena_realloc_fn(void* ptr, size_t new_size) {
+    if (!ptr) {
+        return arena_malloc_fn(new_size);
+    }
+    olib_thread_lock();
+    if (!arena_owns(g_arena, ptr)) {
+        olib_thread_unlock();
+        return g_prev_realloc_fn(ptr, new_size);
+    }
+    olib_mmap_arena_t* arena = g_arena;
+    arena_header_t* header = arena_header(ptr);
+    uint32_t units = arena_units(new_size);
+    if (units != 0 && units <= header->units) {
+        olib_thread_unlock();
+        return ptr;
+    }
+
+    // The last block grows in place, which covers a container growing while it is built.
+    // A free block of the new size is reused first, so the top only moves when it has to.
+    uint8_t* block_end = (uint8_t*)ptr - ARENA_HEADER + (size_t)header->units * ARENA_UNIT;
+    if (units != 0 && block_end == arena->base + arena->top && !arena->free_lists[arena_class(units)]) {
+        size_t end = arena->top + (size_t)(units - header->units) * ARENA_UNIT;
+        if (end <= arena->mapped || arena_grow(arena, end)) {
+            arena->used += (size_t)(units - header->units) * ARENA_UNIT;
+            arena_extend(arena, end);
+            header->units = units;
+            olib_thread_unlock();
+            return ptr;
+        }
+    }
+
+    bool fresh;
+    void* new_ptr = arena_alloc(arena, new_size, &fresh);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, (size_t)header->units * ARENA_UNIT - ARENA_HEADER);
+        arena_release(arena, ptr);
+    }
+    olib_thread_unlock();
+    return new_ptr;
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+OLIB_API olib_mmap_arena_t* olib_mmap_arena_new(const olib_mmap_arena_options_t* options) {
+    olib_mmap_arena_options_t defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t grow_size = options->grow_size ? options->grow_size : ARENA_DEFAULT_GROW;
+    size_t reserved = options->reserve_size ? options->reserve_size : ARENA_DEFAULT_RESERVE;
+    if ((uint64_t)reserved > (uint64_t)ARENA_MAX_UNITS * ARENA_UNIT) {
+        reserved = (size_t)((uint64_t)ARENA_MAX_UNITS * ARENA_UNIT);
+    }
+    grow_size = (grow_size + page - 1) / page * page;
+    reserved = (reserved + page - 1) / page * page;
+
+    olib_mmap_arena_t* arena = (olib_mmap_arena_t*)calloc(1, sizeof(olib_mmap_arena_t));
+    if (!arena) {
+        return NULL;
+    }
+    arena->fd = arena_create_file(options->directory);
+    if (arena->fd < 0) {
+        free(arena);
+        return NULL;
+    }
+    void* base = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        close(arena->fd);
+        free(arena);
+        return NULL;
+    }
+    arena->base = (uint8_t*)base;
+    arena->reserved = reserved;
+    arena->grow_size = grow_size;
+    arena->advice = options->advice;
+    // The first header sits 8 bytes in so that payloads are 16-byte aligned and no
+    // payload has offset 0, which marks an empty free list
+    arena->top = ARENA_UNIT - ARENA_HEADER;
+    arena->dirty = arena->top;
+    return arena;
+}
+
+OLIB_API void olib_mmap_arena_free(olib_mmap_arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+    if (g_arena == arena) {
+        olib_mmap_arena_use(NULL);
+    }
+    munmap(arena->base, arena->reserved);
+    close(arena->fd);
+    free(arena);
+}
+
+OLIB_API void olib_mmap_arena_use(olib_mmap_arena_t* arena) {
+    olib_thread_lock();
+    bool attached = g_arena != NULL;
+    g_arena = arena;
+    olib_thread_unlock();
+    if (arena && !attached) {
+        olib_get_memory_fns(&g_prev_malloc_fn, &g_prev_free_fn, &g_prev_calloc_fn, &g_prev_realloc_fn);
+        olib_set_memory_fns(arena_malloc_fn, arena_free_fn, arena_calloc_fn, arena_realloc_fn);
+    } else if (!arena && attached) {
+        olib_set_memory_fns(g_prev_malloc_fn, g_prev_free_fn, g_prev_calloc_fn, g_prev_realloc_fn);
+    }
+}
+
+OLIB_API void olib_mmap_arena_advise(olib_mmap_arena_t* arena, olib_mmap_advice_t advice) {
+    if (!arena) {
+        return;
+    }
+    olib_thread_lock();
+    arena->advice = advice;
+    if (arena->mapped > 0) {
+        madvise(arena->base, arena->mapped, arena_advice_flag(advice));
+    }
+    olib_thread_unlock();
+}
+
+OLIB_API size_t olib_mmap_arena_used(olib_mmap_arena_t* arena) {
+    if (!arena) {
+        return 0;
+    }
+    olib_thread_lock();
+    size_t used = arena->used;
+    olib_thread_unlock();
+    return used;
+}
+
+OLIB_API size_t olib_mmap_arena_mapped(olib_mmap_arena_t* arena) {
+    if (!arena) {
+        return 0;
+    }
+    olib_thread_lock();
+    size_t mapped = arena->mapped;
+    olib_thread_unlock();
+    return mapped;
+}
+
+#else
+
+// #############################################################################
+// Public API (unsupported platform)
+// #############################################################################
+
+OLIB_API olib_mmap_arena_t* olib_mmap_arena_new(const olib_mmap_arena_options_t* options) {
+    (void)options;
+    return NULL;
+}
+
+OLIB_API void olib_mmap_arena_free(olib_mmap_arena_t* arena) {
+    (void)arena;
+}
+
+OLIB_API void olib_mmap_arena_use(olib_mmap_arena_t* arena) {
+    (void)arena;
+}
+
+OLIB_API void olib_mmap_arena_advise(olib_mmap_arena_t* arena, olib_mmap_advice_t advice) {
+    (void)arena;
+    (void)advice;
+}
+
+OLIB_API size_t olib_mmap_arena_used(olib_mmap_arena_t* arena) {
+    (void)arena;
+    return 0;
+}
+
+OLIB_API size_t olib_mmap_arena_mapped(olib_mmap_arena_t* arena) {
+    (void)arena;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,1215 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_arrow.h>
+#include "olib_object_internal.h"
+#include <string.h>
+
+// Arrow IPC stream encoding. Every message is a continuation marker, the metadata
+// length, a flatbuffer Message and the message body. Flatbuffers are built front
+// to back here: tables are emitted before the objects they reference, so every
+// offset points forward as the format requires, and slots are patched once the
+// referenced object has been written.
+
+// #############################################################################
+// Constants
+// #############################################################################
+
+#define ARROW_CONTINUATION      0xFFFFFFFFu
+#define ARROW_METADATA_V5       4
+
+// Message.header union
+#define ARROW_HEADER_SCHEMA       1
+#define ARROW_HEADER_DICTIONARY   2
+#define ARROW_HEADER_RECORD_BATCH 3
+
+// Field.type union
+#define ARROW_TYPE_NULL   1
+#define ARROW_TYPE_INT    2
+#define ARROW_TYPE_FLOAT  3
+#define ARROW_TYPE_BINARY 4
+#define ARROW_TYPE_UTF8   5
+#define ARROW_TYPE_BOOL   6
+
+// FloatingPoint.precision
+#define ARROW_PRECISION_SINGLE 1
+#define ARROW_PRECISION_DOUBLE 2
+
+// #############################################################################
+// Little-endian access
+// #############################################################################
+
+static uint16_t arrow_get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t arrow_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t arrow_get_u64(const uint8_t* p) {
+    return (uint64_t)arrow_get_u32(p) | ((uint64_t)arrow_get_u32(p + 4) << 32);
+}
+
+static void arrow_put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void arrow_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void arrow_put_u64(uint8_t* p, uint64_t v) {
+    arrow_put_u32(p, (uint32_t)v);
+    arrow_put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static size_t arrow_align8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+static size_t arrow_bitmap_size(size_t rows) {
+    return (rows + 7) / 8;
+}
+
+// #############################################################################
+// Output buffer
+// #############################################################################
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} arrow_buf_t;
+
+// Append count zero bytes, returns the position of the first one
+static bool arrow_buf_grow(arrow_buf_t* b, size_t count, size_t* out_pos) {
+    size_t required = b->size + count;
+    if (required > b->capacity) {
+        size_t new_capacity = b->capacity ? b->capacity : 256;
+        while (new_capacity < required) {
+            new_capacity *= 2;
+        }
+        uint8_t* new_data = olib_realloc(b->data, new_capacity);
+        if (!new_data) {
+            return false;
+        }
+        b->data = new_data;
+        b->capacity = new_capacity;
+    }
+    memset(b->data + b->size, 0, count);
+    if (out_pos) {
+        *out_pos = b->size;
+    }
+    b->size = required;
+    return true;
+}
+
+static bool arrow_buf_align(arrow_buf_t* b, size_t align) {
+    size_t pad = (align - b->size % align) % align;
+    return pad == 0 || arrow_buf_grow(b, pad, NULL);
+}
+
+static bool arrow_buf_append(arrow_buf_t* b, const void* data, size_t size) {
+    size_t pos;
+    if (!arrow_buf_grow(b, size, &pos)) {
+        return false;
+    }
+    if (size > 0) {
+        memcpy(b->data + pos, data, size);
+    }
+    return true;
+}
+
+// #############################################################################
+// Flatbuffer builder
+// #############################################################################
+
+#define ARROW_BUILD_MAX_FIELDS 6
+
+// Emit a vtable and a zeroed table whose fields have the given byte sizes
+// (0 marks an absent field). out_field_pos receives the absolute position of
+// each present field. Returns the table position in out_table.
+static bool arrow_build_table(arrow_buf_t* b, size_t field_count, const uint8_t* field_sizes,
+                           size_t* out_field_pos, size_t* out_table) {
+    uint16_t field_offsets[ARROW_BUILD_MAX_FIELDS] = {0};
+
+    // Lay fields out largest first after the vtable offset so each is naturally aligned
+    size_t table_size = 4;
+    for (size_t width = 8; width > 0; width /= 2) {
+        for (size_t i = 0; i < field_count; i++) {
+            if (field_sizes[i] != width) {
+                continue;
+            }
+            table_size = (table_size + width - 1) & ~(width - 1);
+            field_offsets[i] = (uint16_t)table_size;
+            table_size += width;
+        }
+    }
+
+    size_t vtable_size = 4 + 2 * field_count;
+    size_t vtable;
+    if (!arrow_buf_align(b, 2) || !arrow_buf_grow(b, vtable_size, &vtable)) {
+        return false;
+    }
+    arrow_put_u16(b->data + vtable, (uint16_t)vtable_size);
+    arrow_put_u16(b->data + vtable + 2, (uint16_t)table_size);
+    for (size_t i = 0; i < field_count; i++) {
+        arrow_put_u16(b->data + vtable + 4 + 2 * i, field_offsets[i]);
+    }
+
+    size_t table;
+    if (!arrow_buf_align(b, 8) || !arrow_buf_grow(b, table_size, &table)) {
+        return false;
+    }
+    arrow_put_u32(b->data + table, (uint32_t)(table - vtable));
+
+    for (size_t i = 0; i < field_count; i++) {
+        out_field_pos[i] = field_offsets[i] ? table + field_offsets[i] : 0;
+    }
+    *out_table = table;
+    return true;
+}
+
+// Point the offset slot at slot_pos to target_pos
+static void arrow_build_link(arrow_buf_t* b, size_t slot_pos, size_t target_pos) {
+    arrow_put_u32(b->data + slot_pos, (uint32_t)(target_pos - slot_pos));
+}
+
+// Emit a zeroed vector whose elements are aligned to align bytes (at least 4).
+// Returns the vector position (its length prefix) and the first element position.
+static bool arrow_build_vector(arrow_buf_t* b, size_t count, size_t elem_size, size_t align,
+                            size_t* out_vector, size_t* out_elems) {
+    while ((b->size + 4) % align != 0) {
+        if (!arrow_buf_grow(b, 1, NULL)) {
+            return false;
+        }
+    }
+    if (!arrow_buf_grow(b, 4 + count * elem_size, out_vector)) {
+        return false;
+    }
+    arrow_put_u32(b->data + *out_vector, (uint32_t)count);
+    *out_elems = *out_vector + 4;
+    return true;
+}
+
+static bool arrow_build_string(arrow_buf_t* b, const char* str, size_t* out_pos) {
+    size_t len = strlen(str);
+    if (!arrow_buf_align(b, 4) || !arrow_buf_grow(b, 4 + len + 1, out_pos)) {
+        return false;
+    }
+    arrow_put_u32(b->data + *out_pos, (uint32_t)len);
+    memcpy(b->data + *out_pos + 4, str, len);
+    return true;
+}
+
+// Emit the root offset and a Message table, returns the header slot position
+static bool arrow_build_message(arrow_buf_t* b, uint8_t header_type, uint64_t body_length, size_t* out_header_slot) {
+    static const uint8_t sizes[4] = {2, 1, 4, 8};  // version, header_type, header, bodyLength
+    size_t fields[4];
+    size_t table;
+
+    if (!arrow_buf_grow(b, 4, NULL) || !arrow_build_table(b, 4, sizes, fields, &table)) {
+        return false;
+    }
+    arrow_build_link(b, 0, table);
+    arrow_put_u16(b->data + fields[0], ARROW_METADATA_V5);
+    b->data[fields[1]] = header_type;
+    arrow_put_u64(b->data + fields[3], body_length);
+    *out_header_slot = fields[2];
+    return true;
+}
+
+// #############################################################################
+// Writer
+// #############################################################################
+
+typedef struct {
+    const char* name;
+    olib_object_type_t type;
+    size_t present;         // Rows that have this key
+    size_t validity_offset; // Body offsets of the column buffers
+    size_t values_offset;
+    size_t data_offset;
+    size_t data_size;       // Total string bytes
+    size_t next_row;        // Next row whose string offset has not been written
+    size_t data_end;        // Bytes of string data written so far
+} arrow_write_column_t;
+
+typedef struct {
+    arrow_write_column_t* columns;
+    size_t column_count;
+    size_t column_capacity;
+    size_t rows;
+} arrow_writer_t;
+
+static bool arrow_writer_is_supported(olib_object_type_t type) {
+    return type == OLIB_OBJECT_TYPE_INT || type == OLIB_OBJECT_TYPE_UINT || type == OLIB_OBJECT_TYPE_FLOAT ||
+           type == OLIB_OBJECT_TYPE_BOOL || type == OLIB_OBJECT_TYPE_STRING;
+}
+
+// Find the column for a row entry, trying the entry's own index first since
+// rows of a record list usually share their key order
+static arrow_write_column_t* arrow_writer_find(arrow_writer_t* w, size_t hint, const char* key) {
+    if (hint < w->column_count && strcmp(w->columns[hint].name, key) == 0) {
+        return &w->columns[hint];
+    }
+    for (size_t i = 0; i < w->column_count; i++) {
+        if (strcmp(w->columns[i].name, key) == 0) {
+            return &w->columns[i];
+        }
+    }
+    return NULL;
+}
+
+// First pass: collect columns and their types, count present rows and string bytes
+static bool arrow_writer_collect(arrow_writer_t* w, olib_object_t* records) {
+    w->rows = records->data.list.size;
+    for (size_t r = 0; r < w->rows; r++) {
+        olib_object_t* row = records->data.list.items[r];
+        if (row->type != OLIB_OBJECT_TYPE_STRUCT) {
+            return false;
+        }
+        for (size_t e = 0; e < row->data.object.size; e++) {
+            olib_struct_entry_t* entry = &row->data.object.entries[e];
+            olib_object_type_t type = entry->value->type;
+            if (!arrow_writer_is_supported(type)) {
+                return false;
+            }
+
+            arrow_write_column_t* col = arrow_writer_find(w, e, entry->key);
+            if (!col) {
+                if (w->column_count == w->column_capacity) {
+                    size_t new_capacity = w->column_capacity ? w->column_capacity * 2 : 8;
+                    arrow_write_column_t* new_columns =
+                        olib_realloc(w->columns, new_capacity * sizeof(arrow_write_column_t));
+                    if (!new_columns) {
+                        return false;
+                    }
+                    w->columns = new_columns;
+                    w->column_capacity = new_capacity;
+                }
+                col = &w->columns[w->column_count++];
+                memset(col, 0, sizeof(*col));
+                col->name = entry->key;
+                col->type = type;
+            } else if (col->type != type) {
+                return false;
+            }
+
+            col->present++;
+            if (type == OLIB_OBJECT_TYPE_STRING && entry->value->data.string.data) {
+                col->data_size += strlen(entry->value->data.string.data);
+            }
+        }
+    }
+    return true;
+}
+
+// Assign body offsets to every column buffer, returns the body size
+static size_t arrow_writer_layout(arrow_writer_t* w) {
+    size_t offset = 0;
+    for (size_t i = 0; i < w->column_count; i++) {
+        arrow_write_column_t* col = &w->columns[i];
+        col->validity_offset = offset;
+        if (col->present < w->rows) {
+            offset += arrow_align8(arrow_bitmap_size(w->rows));
+        }
+        col->values_offset = offset;
+        switch (col->type) {
+            case OLIB_OBJECT_TYPE_BOOL:
+                offset += arrow_align8(arrow_bitmap_size(w->rows));
+                break;
+            case OLIB_OBJECT_TYPE_STRING:
+                offset += arrow_align8((w->rows + 1) * 4);
+                col->data_offset = offset;
+                offset += arrow_align8(col->data_size);
+                break;
+            default:
+                offset += w->rows * 8;
+                break;
+        }
+    }
+    return offset;
+}
+
+static uint64_t arrow_writer_buffer_size(arrow_writer_t* w, arrow_write_column_t* col, size_t buffer) {
+    switch (buffer) {
+        case 0:  return col->present < w->rows ? arrow_bitmap_size(w->rows) : 0;
+        case 1:
+            if (col->type == OLIB_OBJECT_TYPE_BOOL) return arrow_bitmap_size(w->rows);
+            if (col->type == OLIB_OBJECT_TYPE_STRING) return (w->rows + 1) * 4;
+            return w->rows * 8;
+        default: return col->data_size;
+    }
+}
+
+static void arrow_writer_string_offsets(arrow_write_column_t* col, uint8_t* body, size_t until_row) {
+    for (; col->next_row < until_row; col->next_row++) {
+        arrow_put_u32(body + col->values_offset + col->next_row * 4, (uint32_t)col->data_end);
+    }
+}
+
+// Second pass: scatter row values into the column buffers
+static void arrow_writer_fill(arrow_writer_t* w, olib_object_t* records, uint8_t* body) {
+    for (size_t r = 0; r < w->rows; r++) {
+        olib_object_t* row = records->data.list.items[r];
+        for (size_t e = 0; e < row->data.object.size; e++) {
+            olib_struct_entry_t* entry = &row->data.object.entries[e];
+            arrow_write_column_t* col = arrow_writer_find(w, e, entry->key);
+            olib_object_t* value = entry->value;
+
+            if (col->present < w->rows) {
+                body[col->validity_offset + r / 8] |= (uint8_t)(1u << (r % 8));
+            }
+
+            uint8_t* values = body + col->values_offset;
+            switch (col->type) {
+                case OLIB_OBJECT_TYPE_INT:
+                case OLIB_OBJECT_TYPE_UINT:
+                    arrow_put_u64(values + r * 8, value->data.uint_val);
+                    break;
+                case OLIB_OBJECT_TYPE_FLOAT: {
+                    uint64_t bits;
+                    memcpy(&bits, &value->data.float_val, sizeof(bits));
+                    arrow_put_u64(values + r * 8, bits);
+                    break;
+                }
+                case OLIB_OBJECT_TYPE_BOOL:
+                    if (value->data.bool_val) {
+                        values[r / 8] |= (uint8_t)(1u << (r % 8));
+                    }
+                    break;
+                case OLIB_OBJECT_TYPE_STRING: {
+                    arrow_writer_string_offsets(col, body, r + 1);
+                    if (value->data.string.data) {
+                        size_t len = strlen(value->data.string.data);
+                        memcpy(body + col->data_offset + col->data_end, value->data.string.data, len);
+                        col->data_end += len;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Rows past the last present value still need their string offsets
+    for (size_t i = 0; i < w->column_count; i++) {
+        if (w->columns[i].type == OLIB_OBJECT_TYPE_STRING) {
+            arrow_writer_string_offsets(&w->columns[i], body, w->rows + 1);
+        }
+    }
+}
+
+static bool arrow_writer_schema(arrow_writer_t* w, arrow_buf_t* fb) {
+    size_t header_slot;
+    if (!arrow_build_message(fb, ARROW_HEADER_SCHEMA, 0, &header_slot)) {
+        return false;
+    }
+
+    // Schema: endianness (default little), fields
+    static const uint8_t schema_sizes[2] = {0, 4};
+    size_t schema_fields[2];
+    size_t schema;
+    if (!arrow_build_table(fb, 2, schema_sizes, schema_fields, &schema)) {
+        return false;
+    }
+    arrow_build_link(fb, header_slot, schema);
+
+    size_t vector, elems;
+    if (!arrow_build_vector(fb, w->column_count, 4, 4, &vector, &elems)) {
+        return false;
+    }
+    arrow_build_link(fb, schema_fields[1], vector);
+
+    for (size_t i = 0; i < w->column_count; i++) {
+        arrow_write_column_t* col = &w->columns[i];
+
+        // Field: name, nullable, type_type, type, dictionary, children
+        static const uint8_t field_sizes[6] = {4, 1, 1, 4, 0, 4};
+        size_t fields[6];
+        size_t field;
+        if (!arrow_build_table(fb, 6, field_sizes, fields, &field)) {
+            return false;
+        }
+        arrow_build_link(fb, elems + i * 4, field);
+        fb->data[fields[1]] = 1;
+
+        size_t name;
+        if (!arrow_build_string(fb, col->name, &name)) {
+            return false;
+        }
+        arrow_build_link(fb, fields[0], name);
+
+        size_t type_fields[2];
+        size_t type;
+        switch (col->type) {
+            case OLIB_OBJECT_TYPE_INT:
+            case OLIB_OBJECT_TYPE_UINT: {
+                static const uint8_t int_sizes[2] = {4, 1};  // bitWidth, is_signed
+                if (!arrow_build_table(fb, 2, int_sizes, type_fields, &type)) return false;
+                arrow_put_u32(fb->data + type_fields[0], 64);
+                fb->data[type_fields[1]] = col->type == OLIB_OBJECT_TYPE_INT;
+                fb->data[fields[2]] = ARROW_TYPE_INT;
+                break;
+            }
+            case OLIB_OBJECT_TYPE_FLOAT: {
+                static const uint8_t float_sizes[1] = {2};  // precision
+                if (!arrow_build_table(fb, 1, float_sizes, type_fields, &type)) return false;
+                arrow_put_u16(fb->data + type_fields[0], ARROW_PRECISION_DOUBLE);
+                fb->data[fields[2]] = ARROW_TYPE_FLOAT;
+                break;
+            }
+            case OLIB_OBJECT_TYPE_BOOL:
+                if (!arrow_build_table(fb, 0, NULL, type_fields, &type)) return false;
+                fb->data[fields[2]] = ARROW_TYPE_BOOL;
+                break;
+            default:
+                if (!arrow_build_table(fb, 0, NULL, type_fields, &type)) return false;
+                fb->data[fields[2]] = ARROW_TYPE_UTF8;
+                break;
+        }
+        arrow_build_link(fb, fields[3], type);
+
+        size_t children, children_elems;
+        if (!arrow_build_vector(fb, 0, 4, 4, &children, &children_elems)) {
+            return false;
+        }
+        arrow_build_link(fb, fields[5], children);
+    }
+    return true;
+}
+
+static bool arrow_writer_batch(arrow_writer_t* w, arrow_buf_t* fb, size_t body_size) {
+    size_t header_slot;
+    if (!arrow_build_message(fb, ARROW_HEADER_RECORD_BATCH, body_size, &header_slot)) {
+        return false;
+    }
+
+    // RecordBatch: length, nodes, buffers
+    static const uint8_t batch_sizes[3] = {8, 4, 4};
+    size_t batch_fields[3];
+    size_t batch;
+    if (!arrow_build_table(fb, 3, batch_sizes, batch_fields, &batch)) {
+        return false;
+    }
+    arrow_build_link(fb, header_slot, batch);
+    arrow_put_u64(fb->data + batch_fields[0], w->rows);
+
+    // FieldNode { length, null_count }
+    size_t nodes, node_elems;
+    if (!arrow_build_vector(fb, w->column_count, 16, 8, &nodes, &node_elems)) {
+        return false;
+    }
+    arrow_build_link(fb, batch_fields[1], nodes);
+    for (size_t i = 0; i < w->column_count; i++) {
+        arrow_put_u64(fb->data + node_elems + i * 16, w->rows);
+        arrow_put_u64(fb->data + node_elems + i * 16 + 8, w->rows - w->columns[i].present);
+    }
+
+    // Buffer { offset, length }: validity and values, plus data for strings
+    size_t buffer_count = 0;
+    for (size_t i = 0; i < w->column_count; i++) {
+        buffer_count += w->columns[i].type == OLIB_OBJECT_TYPE_STRING ? 3 : 2;
+    }
+    size_t buffers, buffer_elems;
+    if (!arrow_build_vector(fb, buffer_count, 16, 8, &buffers, &buffer_elems)) {
+        return false;
+    }
+    arrow_build_link(fb, batch_fields[2], buffers);
+    for (size_t i = 0; i < w->column_count; i++) {
+        arrow_write_column_t* col = &w->columns[i];
+        size_t offsets[3] = {col->validity_offset, col->values_offset, col->data_offset};
+        size_t count = col->type == OLIB_OBJECT_TYPE_STRING ? 3 : 2;
+        for (size_t b = 0; b < count; b++) {
+            arrow_put_u64(fb->data + buffer_elems, offsets[b]);
+            arrow_put_u64(fb->data + buffer_elems + 8, arrow_writer_buffer_size(w, col, b));
+            buffer_elems += 16;
+        }
+    }
+    return true;
+}
+
+// Append an encapsulated message: continuation, padded metadata length, metadata, body
+static bool arrow_write_message(arrow_buf_t* out, const arrow_buf_t* fb, const uint8_t* body, size_t body_size) {
+    size_t metadata_size = arrow_align8(fb->size);
+    size_t pos;
+    if (!arrow_buf_grow(out, 8 + metadata_size, &pos)) {
+        return false;
+    }
+    arrow_put_u32(out->data + pos, ARROW_CONTINUATION);
+    arrow_put_u32(out->data + pos + 4, (uint32_t)metadata_size);
+    memcpy(out->data + pos + 8, fb->data, fb->size);
+    return arrow_buf_append(out, body, body_size);
+}
+
+OLIB_API bool olib_arrow_write(olib_object_t* records, uint8_t** out_data, size_t* out_size) {
+    if (!records || !out_data || !out_size || records->type != OLIB_OBJECT_TYPE_LIST) {
+        return false;
+    }
+
+    arrow_writer_t w = {0};
+    arrow_buf_t fb = {0};
+    arrow_buf_t out = {0};
+    uint8_t* body = NULL;
+    bool ok = false;
+
+    if (!arrow_writer_collect(&w, records)) {
+        goto cleanup;
+    }
+
+    // String offsets are int32, larger columns would need the LargeUtf8 type
+    for (size_t i = 0; i < w.column_count; i++) {
+        if (w.columns[i].data_size > INT32_MAX) {
+            goto cleanup;
+        }
+    }
+
+    size_t body_size = arrow_writer_layout(&w);
+    body = olib_calloc(1, body_size ? body_size : 1);
+    if (!body) {
+        goto cleanup;
+    }
+    arrow_writer_fill(&w, records, body);
+
+    if (!arrow_writer_schema(&w, &fb) || !arrow_write_message(&out, &fb, NULL, 0)) {
+        goto cleanup;
+    }
+    fb.size = 0;
+    if (!arrow_writer_batch(&w, &fb, body_size) || !arrow_write_message(&out, &fb, body, body_size)) {
+        goto cleanup;
+    }
+
+    // End-of-stream marker
+    size_t eos;
+    if (!arrow_buf_grow(&out, 8, &eos)) {
+        goto cleanup;
+    }
+    arrow_put_u32(out.data + eos, ARROW_CONTINUATION);
+
+    *out_data = out.data;
+    *out_size = out.size;
+    out.data = NULL;
+    ok = true;
+
+cleanup:
+    olib_free(w.columns);
+    olib_free(fb.data);
+    olib_free(out.data);
+    olib_free(body);
+    return ok;
+}
+
+// #############################################################################
+// Flatbuffer reader
+// #############################################################################
+
+// Metadata of one message. Positions are relative to data; 0 doubles as "absent"
+// since the root offset always occupies position 0.
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+} arrow_fb_t;
+
+// Position of field index of the table at table, or 0 if absent or out of bounds
+static size_t arrow_fb_field(const arrow_fb_t* fb, size_t table, size_t index, size_t field_size) {
+    if (table == 0 || table > fb->size || fb->size - table < 4) {
+        return 0;
+    }
+    int64_t vtable = (int64_t)table - (int32_t)arrow_get_u32(fb->data + table);
+    if (vtable < 0 || (uint64_t)vtable > fb->size - 4) {
+        return 0;
+    }
+    size_t vtable_size = arrow_get_u16(fb->data + vtable);
+    if (vtable_size > fb->size - (size_t)vtable || 4 + 2 * index + 2 > vtable_size) {
+        return 0;
+    }
+    size_t offset = arrow_get_u16(fb->data + vtable + 4 + 2 * index);
+    if (offset == 0 || offset > fb->size - table || fb->size - table - offset < field_size) {
+        return 0;
+    }
+    return table + offset;
+}
+
+static uint8_t arrow_fb_u8(const arrow_fb_t* fb, size_t table, size_t index, uint8_t def) {
+    size_t pos = arrow_fb_field(fb, table, index, 1);
+    return pos ? fb->data[pos] : def;
+}
+
+static int16_t arrow_fb_i16(const arrow_fb_t* fb, size_t table, size_t index, int16_t def) {
+    size_t pos = arrow_fb_field(fb, table, index, 2);
+    return pos ? (int16_t)arrow_get_u16(fb->data + pos) : def;
+}
+
+static int32_t arrow_fb_i32(const arrow_fb_t* fb, size_t table, size_t index, int32_t def) {
+    size_t pos = arrow_fb_field(fb, table, index, 4);
+    return pos ? (int32_t)arrow_get_u32(fb->data + pos) : def;
+}
+
+static int64_t arrow_fb_i64(const arrow_fb_t* fb, size_t table, size_t index, int64_t def) {
+    size_t pos = arrow_fb_field(fb, table, index, 8);
+    return pos ? (int64_t)arrow_get_u64(fb->data + pos) : def;
+}
+
+// Follow the offset stored at pos, returns the target or 0 if out of bounds
+static size_t arrow_fb_deref(const arrow_fb_t* fb, size_t pos) {
+    size_t offset = arrow_get_u32(fb->data + pos);
+    if (offset == 0 || offset >= fb->size - pos) {
+        return 0;
+    }
+    return pos + offset;
+}
+
+static size_t arrow_fb_ref(const arrow_fb_t* fb, size_t table, size_t index) {
+    size_t pos = arrow_fb_field(fb, table, index, 4);
+    return pos ? arrow_fb_deref(fb, pos) : 0;
+}
+
+static bool arrow_fb_vector_at(const arrow_fb_t* fb, size_t vector, size_t elem_size,
+                               size_t* out_count, size_t* out_elems) {
+    if (vector == 0 || fb->size - vector < 4) {
+        return false;
+    }
+    size_t count = arrow_get_u32(fb->data + vector);
+    size_t elems = vector + 4;
+    if (count > (fb->size - elems) / elem_size) {
+        return false;
+    }
+    *out_count = count;
+    *out_elems = elems;
+    return true;
+}
+
+static bool arrow_fb_vector(const arrow_fb_t* fb, size_t table, size_t index, size_t elem_size,
+                            size_t* out_count, size_t* out_elems) {
+    return arrow_fb_vector_at(fb, arrow_fb_ref(fb, table, index), elem_size, out_count, out_elems);
+}
+
+// Null-terminated string field, or NULL if absent or malformed
+static const char* arrow_fb_string(const arrow_fb_t* fb, size_t table, size_t index) {
+    size_t count, elems;
+    if (!arrow_fb_vector(fb, table, index, 1, &count, &elems) || elems + count >= fb->size ||
+        fb->data[elems + count] != '\0') {
+        return NULL;
+    }
+    return (const char*)fb->data + elems;
+}
+
+// #############################################################################
+// Reader
+// #############################################################################
+
+// Column views never dereference this for empty batches without offsets
+static const int32_t g_arrow_empty_offsets[1] = {0};
+
+struct olib_arrow_reader_t {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;                   // Position of the next message
+    uint8_t* owned;               // Aligned copy of the input, if it was misaligned
+    olib_arrow_column_t* columns; // Schema fields, filled with buffers per batch
+    size_t column_count;
+    size_t row_count;
+    bool has_batch;
+    bool failed;
+};
+
+typedef struct {
+    arrow_fb_t fb;
+    uint8_t header_type;
+    size_t header;
+    const uint8_t* body;
+    size_t body_size;
+} arrow_message_t;
+
+// Read the next encapsulated message. Returns false at the end of the stream or
+// on error, setting reader->failed for the latter.
+static bool arrow_reader_message(olib_arrow_reader_t* r, arrow_message_t* msg) {
+    size_t remaining = r->size - r->pos;
+    if (remaining < 4) {
+        // Streams may end without an end-of-stream marker
+        r->failed = remaining != 0;
+        return false;
+    }
+
+    // Streams before format 0.15 have no continuation marker
+    size_t prefix = 4;
+    uint32_t metadata_size = arrow_get_u32(r->data + r->pos);
+    if (metadata_size == ARROW_CONTINUATION) {
+        if (remaining < 8) {
+            r->failed = true;
+            return false;
+        }
+        prefix = 8;
+        metadata_size = arrow_get_u32(r->data + r->pos + 4);
+    }
+    if (metadata_size == 0) {
+        r->pos = r->size;
+        return false;
+    }
+    if (metadata_size > remaining - prefix) {
+        r->failed = true;
+        return false;
+    }
+
+    msg->fb.data = r->data + r->pos + prefix;
+    msg->fb.size = metadata_size;
+    size_t message = metadata_size >= 4 ? arrow_fb_deref(&msg->fb, 0) : 0;
+    int64_t body_size = arrow_fb_i64(&msg->fb, message, 3, 0);
+    size_t body_pos = r->pos + prefix + metadata_size;
+    if (message == 0 || body_size < 0 || (uint64_t)body_size > r->size - body_pos) {
+        r->failed = true;
+        return false;
+    }
+
+    msg->header_type = arrow_fb_u8(&msg->fb, message, 1, 0);
+    msg->header = arrow_fb_ref(&msg->fb, message, 2);
+    msg->body = r->data + body_pos;
+    msg->body_size = (size_t)body_size;
+    r->pos = body_pos + (size_t)body_size;
+    return true;
+}
+
+static bool arrow_reader_field(const arrow_fb_t* fb, size_t field, olib_arrow_column_t* col) {
+    const char* name = arrow_fb_string(fb, field, 0);
+    col->name = name ? name : "";
+
+    // Dictionary encoded and nested fields are not supported
+    size_t children, children_elems;
+    if (arrow_fb_field(fb, field, 4, 4) ||
+        (arrow_fb_vector(fb, field, 5, 4, &children, &children_elems) && children != 0)) {
+        return false;
+    }
+
+    size_t type = arrow_fb_ref(fb, field, 3);
+    switch (arrow_fb_u8(fb, field, 2, 0)) {
+        case ARROW_TYPE_NULL:
+            col->type = OLIB_ARROW_TYPE_NULL;
+            col->bit_width = 0;
+            return true;
+        case ARROW_TYPE_INT: {
+            int32_t bit_width = arrow_fb_i32(fb, type, 0, 0);
+            if (!type || (bit_width != 8 && bit_width != 16 && bit_width != 32 && bit_width != 64)) {
+                return false;
+            }
+            col->type = arrow_fb_u8(fb, type, 1, 0) ? OLIB_ARROW_TYPE_INT : OLIB_ARROW_TYPE_UINT;
+            col->bit_width = (size_t)bit_width;
+            return true;
+        }
+        case ARROW_TYPE_FLOAT: {
+            int16_t precision = arrow_fb_i16(fb, type, 0, 0);
+            if (!type || (precision != ARROW_PRECISION_SINGLE && precision != ARROW_PRECISION_DOUBLE)) {
+                return false;
+            }
+            col->type = OLIB_ARROW_TYPE_FLOAT;
+            col->bit_width = precision == ARROW_PRECISION_SINGLE ? 32 : 64;
+            return true;
+        }
+        case ARROW_TYPE_BOOL:
+            col->type = OLIB_ARROW_TYPE_BOOL;
+            col->bit_width = 1;
+            return true;
+        case ARROW_TYPE_UTF8:
+            col->type = OLIB_ARROW_TYPE_STRING;
+            col->bit_width = 0;
+            return true;
+        case ARROW_TYPE_BINARY:
+            col->type = OLIB_ARROW_TYPE_BINARY;
+            col->bit_width = 0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool arrow_reader_schema(olib_arrow_reader_t* r) {
+    arrow_message_t msg;
+    if (!arrow_reader_message(r, &msg) || msg.header_type != ARROW_HEADER_SCHEMA || !msg.header) {
+        return false;
+    }
+
+    // Only little-endian data can be viewed in place
+    size_t count, elems;
+    if (arrow_fb_i16(&msg.fb, msg.header, 0, 0) != 0 ||
+        !arrow_fb_vector(&msg.fb, msg.header, 1, 4, &count, &elems)) {
+        return false;
+    }
+
+    r->columns = olib_calloc(count ? count : 1, sizeof(olib_arrow_column_t));
+    if (!r->columns) {
+        return false;
+    }
+    r->column_count = count;
+    for (size_t i = 0; i < count; i++) {
+        size_t field = arrow_fb_deref(&msg.fb, elems + i * 4);
+        if (!field || !arrow_reader_field(&msg.fb, field, &r->columns[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Take the next body buffer, checking that it lies within the body and is aligned for its values
+static bool arrow_reader_buffer(const arrow_message_t* msg, size_t buffers, size_t buffer_count, size_t* index,
+                                size_t min_size, size_t align, const uint8_t** out) {
+    if (*index >= buffer_count) {
+        return false;
+    }
+    size_t pos = buffers + *index * 16;
+    int64_t offset = (int64_t)arrow_get_u64(msg->fb.data + pos);
+    int64_t length = (int64_t)arrow_get_u64(msg->fb.data + pos + 8);
+    (*index)++;
+
+    if (offset < 0 || length < 0 || (uint64_t)offset > msg->body_size ||
+        (uint64_t)length > msg->body_size - (uint64_t)offset || (uint64_t)length < min_size) {
+        return false;
+    }
+    *out = msg->body + offset;
+    return ((uintptr_t)*out % align) == 0;
+}
+
+static bool arrow_reader_batch(olib_arrow_reader_t* r, const arrow_message_t* msg) {
+    const arrow_fb_t* fb = &msg->fb;
+    size_t batch = msg->header;
+    int64_t rows = arrow_fb_i64(fb, batch, 0, 0);
+    size_t node_count, nodes, buffer_count, buffers;
+
+    // Compressed bodies are not supported
+    if (!batch || rows < 0 || arrow_fb_field(fb, batch, 3, 4) ||
+        !arrow_fb_vector(fb, batch, 1, 16, &node_count, &nodes) || node_count != r->column_count ||
+        !arrow_fb_vector(fb, batch, 2, 16, &buffer_count, &buffers)) {
+        return false;
+    }
+    r->row_count = (size_t)rows;
+
+    size_t buffer = 0;
+    for (size_t i = 0; i < r->column_count; i++) {
+        olib_arrow_column_t* col = &r->columns[i];
+        int64_t length = (int64_t)arrow_get_u64(fb->data + nodes + i * 16);
+        int64_t null_count = (int64_t)arrow_get_u64(fb->data + nodes + i * 16 + 8);
+        if (length != rows || null_count < 0 || null_count > rows) {
+            return false;
+        }
+        col->length = r->row_count;
+        col->null_count = (size_t)null_count;
+        col->validity = NULL;
+        col->values = NULL;
+        col->offsets = NULL;
+
+        // Null arrays carry no buffers
+        if (col->type == OLIB_ARROW_TYPE_NULL) {
+            col->null_count = col->length;
+            continue;
+        }
+
+        // Every other type needs at least one bit of body per row, which also keeps
+        // the size computations below from overflowing
+        if (col->length / 8 > msg->body_size) {
+            return false;
+        }
+
+        const uint8_t* validity;
+        size_t bitmap_size = col->null_count ? arrow_bitmap_size(col->length) : 0;
+        if (!arrow_reader_buffer(msg, buffers, buffer_count, &buffer, bitmap_size, 1, &validity)) {
+            return false;
+        }
+        if (col->null_count) {
+            col->validity = validity;
+        }
+
+        const uint8_t* values;
+        if (col->type == OLIB_ARROW_TYPE_STRING || col->type == OLIB_ARROW_TYPE_BINARY) {
+            const uint8_t* offsets;
+            const uint8_t* bytes;
+            size_t offsets_size = col->length ? (col->length + 1) * 4 : 0;
+            if (!arrow_reader_buffer(msg, buffers, buffer_count, &buffer, offsets_size, 4, &offsets) ||
+                !arrow_reader_buffer(msg, buffers, buffer_count, &buffer, 0, 1, &bytes)) {
+                return false;
+            }
+            if (col->length == 0) {
+                col->offsets = g_arrow_empty_offsets;
+                col->values = bytes;
+                continue;
+            }
+
+            // Offsets must be non-decreasing and stay within the data buffer
+            size_t pos = buffers + (buffer - 1) * 16;
+            uint64_t data_size = arrow_get_u64(fb->data + pos + 8);
+            int32_t prev = (int32_t)arrow_get_u32(offsets);
+            if (prev < 0) {
+                return false;
+            }
+            for (size_t row = 1; row <= col->length; row++) {
+                int32_t next = (int32_t)arrow_get_u32(offsets + row * 4);
+                if (next < prev) {
+                    return false;
+                }
+                prev = next;
+            }
+            if ((uint64_t)prev > data_size) {
+                return false;
+            }
+            col->offsets = (const int32_t*)(const void*)offsets;
+            col->values = bytes;
+            continue;
+        }
+
+        size_t values_size = col->type == OLIB_ARROW_TYPE_BOOL ? arrow_bitmap_size(col->length)
+                                                                : col->length * (col->bit_width / 8);
+        size_t align = col->type == OLIB_ARROW_TYPE_BOOL ? 1 : col->bit_width / 8;
+        if (!arrow_reader_buffer(msg, buffers, buffer_count, &buffer, values_size, align, &values)) {
+            return false;
+        }
+        col->values = values;
+    }
+    return true;
+}
+
+OLIB_API olib_arrow_reader_t* olib_arrow_reader_new(const uint8_t* data, size_t size) {
+    if (!data || size == 0) {
+        return NULL;
+    }
+
+    olib_arrow_reader_t* r = olib_calloc(1, sizeof(olib_arrow_reader_t));
+    if (!r) {
+        return NULL;
+    }
+
+    // Views hand out typed pointers, so buffers must keep the 8-byte alignment
+    // the format guarantees relative to the start of the stream
+    if ((uintptr_t)data % 8 != 0) {
+        r->owned = olib_malloc(size);
+        if (!r->owned) {
+            olib_free(r);
+            return NULL;
+        }
+        memcpy(r->owned, data, size);
+        data = r->owned;
+    }
+    r->data = data;
+    r->size = size;
+
+    if (!arrow_reader_schema(r)) {
+        olib_arrow_reader_free(r);
+        return NULL;
+    }
+    return r;
+}
+
+OLIB_API void olib_arrow_reader_free(olib_arrow_reader_t* reader) {
+    if (!reader) {
+        return;
+    }
+    olib_free(reader->columns);
+    olib_free(reader->owned);
+    olib_free(reader);
+}
+
+OLIB_API size_t olib_arrow_reader_column_count(olib_arrow_reader_t* reader) {
+    return reader ? reader->column_count : 0;
+}
+
+OLIB_API const char* olib_arrow_reader_column_name(olib_arrow_reader_t* reader, size_t index) {
+    if (!reader || index >= reader->column_count) {
+        return NULL;
+    }
+    return reader->columns[index].name;
+}
+
+OLIB_API bool olib_arrow_reader_next_batch(olib_arrow_reader_t* reader) {
+    if (!reader || reader->failed) {
+        return false;
+    }
+    reader->has_batch = false;
+
+    arrow_message_t msg;
+    if (!arrow_reader_message(reader, &msg)) {
+        return false;
+    }
+    if (msg.header_type != ARROW_HEADER_RECORD_BATCH || !arrow_reader_batch(reader, &msg)) {
+        reader->failed = true;
+        return false;
+    }
+    reader->has_batch = true;
+    return true;
+}
+
+OLIB_API bool olib_arrow_reader_failed(olib_arrow_reader_t* reader) {
+    return !reader || reader->failed;
+}
+
+OLIB_API size_t olib_arrow_reader_row_count(olib_arrow_reader_t* reader) {
+    return reader && reader->has_batch ? reader->row_count : 0;
+}
+
+OLIB_API bool olib_arrow_reader_column(olib_arrow_reader_t* reader, size_t index, olib_arrow_column_t* out_column) {
+    if (!reader || !reader->has_batch || index >= reader->column_count || !out_column) {
+        return false;
+    }
+    *out_column = reader->columns[index];
+    return true;
+}
+
+// #############################################################################
+// Record list conversion
+// #############################################################################
+
+// Convert one valid row of a column, returns NULL on allocation failure
+static olib_object_t* arrow_column_value(const olib_arrow_column_t* col, size_t row) {
+    const uint8_t* values = col->values;
+    olib_object_t* obj;
+    switch (col->type) {
+        case OLIB_ARROW_TYPE_INT:
+        case OLIB_ARROW_TYPE_UINT: {
+            uint64_t bits;
+            switch (col->bit_width) {
+                case 8:  bits = values[row]; break;
+                case 16: bits = arrow_get_u16(values + row * 2); break;
+                case 32: bits = arrow_get_u32(values + row * 4); break;
+                default: bits = arrow_get_u64(values + row * 8); break;
+            }
+            if (col->type == OLIB_ARROW_TYPE_UINT) {
+                obj = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+                if (obj) obj->data.uint_val = bits;
+                return obj;
+            }
+            // Sign extend narrower values
+            if (col->bit_width < 64) {
+                uint64_t sign = (uint64_t)1 << (col->bit_width - 1);
+                bits = (bits ^ sign) - sign;
+            }
+            obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+            if (obj) obj->data.int_val = (int64_t)bits;
+            return obj;
+        }
+        case OLIB_ARROW_TYPE_FLOAT: {
+            double value;
+            if (col->bit_width == 32) {
+                uint32_t bits = arrow_get_u32(values + row * 4);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                value = f;
+            } else {
+                uint64_t bits = arrow_get_u64(values + row * 8);
+                memcpy(&value, &bits, sizeof(value));
+            }
+            obj = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+            if (obj) obj->data.float_val = value;
+            return obj;
+        }
+        case OLIB_ARROW_TYPE_BOOL:
+            obj = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
+            if (obj) obj->data.bool_val = (values[row / 8] >> (row % 8)) & 1;
+            return obj;
+        default: {
+            const uint8_t* offsets = (const uint8_t*)col->offsets;
+            uint32_t start = arrow_get_u32(offsets + row * 4);
+            uint32_t end = arrow_get_u32(offsets + row * 4 + 4);
+            obj = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+            if (obj && !olib_object_set_string_len(obj, (const char*)values + start, end - start)) {
+                olib_object_free(obj);
+                return NULL;
+            }
+            return obj;
+        }
+    }
+}
+
+// Append every row of the current batch to records
+static bool arrow_reader_append_rows(olib_arrow_reader_t* r, olib_object_t* records) {
+    if (!olib_object_list_reserve(records, records->data.list.size + r->row_count)) {
+        return false;
+    }
+    for (size_t row = 0; row < r->row_count; row++) {
+        olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+        if (!obj) {
+            return false;
+        }
+        records->data.list.items[records->data.list.size++] = obj;
+        if (!olib_object_struct_reserve(obj, r->column_count)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < r->column_count; i++) {
+            const olib_arrow_column_t* col = &r->columns[i];
+            if (col->type == OLIB_ARROW_TYPE_NULL ||
+                (col->validity && !(col->validity[row / 8] & (1u << (row % 8))))) {
+                continue;
+            }
+            olib_object_t* value = arrow_column_value(col, row);
+            if (!value) {
+                return false;
+            }
+            olib_struct_entry_t* entry = olib_object_struct_insert_entry(obj, obj->data.object.size, col->name);
+            if (!entry) {
+                olib_object_free(value);
+                return false;
+            }
+            entry->value = value;
+        }
+    }
+    return true;
+}
+
+// Struct keys are unique, so a schema naming two fields alike has no record form
+static bool arrow_reader_names_unique(const olib_arrow_reader_t* r) {
+    for (size_t i = 1; i < r->column_count; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(r->columns[i].name, r->columns[j].name) == 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+OLIB_API olib_object_t* olib_arrow_read(const uint8_t* data, size_t size) {
+    olib_arrow_reader_t* reader = olib_arrow_reader_new(data, size);
+    if (!reader) {
+        return NULL;
+    }
+    if (!arrow_reader_names_unique(reader)) {
+        olib_arrow_reader_free(reader);
+        return NULL;
+    }
+
+    olib_object_t* records = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    bool ok = records != NULL;
+    while (ok && olib_arrow_reader_next_batch(reader)) {
+        ok = arrow_reader_append_rows(reader, records);
+    }
+    if (!ok || reader->failed) {
+        olib_object_free(records);
+        records = NULL;
+    }
+
+    olib_arrow_reader_free(reader);
+    return records;
+}
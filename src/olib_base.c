@@ -22,7 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include <olib/olib_base.h>
+#include "olib_base_internal.h"
 #include <stdlib.h>
 
 // Stored function pointers for memory functions
@@ -65,4 +65,12 @@ OLIB_API void olib_set_memory_fns(
     if (realloc_fn) {
         g_realloc_fn = realloc_fn;
     }
-  }
\ No newline at end of file
+  }
+
+void olib_get_memory_fns(olib_malloc_fn* malloc_fn, olib_free_fn* free_fn, olib_calloc_fn* calloc_fn,
+                         olib_realloc_fn* realloc_fn) {
+    *malloc_fn = g_malloc_fn;
+    *free_fn = g_free_fn;
+    *calloc_fn = g_calloc_fn;
+    *realloc_fn = g_realloc_fn;
+}
@@ -0,0 +1,301 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_frozen.h>
+#include "olib_object_internal.h"
+#include "olib_output_internal.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Generated sources point getters at frozen nodes, so both layouts must stay identical
+_Static_assert(sizeof(olib_frozen_t) == sizeof(olib_object_t), "frozen node size");
+_Static_assert(offsetof(olib_frozen_t, data) == offsetof(olib_object_t, data), "frozen node data");
+_Static_assert(offsetof(olib_frozen_t, data.list.size) == offsetof(olib_object_t, data.list.size), "frozen list");
+_Static_assert(sizeof(olib_frozen_entry_t) == sizeof(olib_struct_entry_t), "frozen struct entry");
+_Static_assert(sizeof(olib_frozen_map_entry_t) == sizeof(olib_map_entry_t), "frozen map entry");
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct frozen_emitter_t {
+    olib_output_buffer_t out;
+    const char* name;
+    size_t next;  // Number of the next node, nodes are numbered children first
+    bool ok;
+} frozen_emitter_t;
+
+// Longest run of string bytes on one source line
+#define FROZEN_LINE_BYTES 96
+
+// #############################################################################
+// Text output
+// #############################################################################
+
+static void frozen_printf(frozen_emitter_t* e, const char* fmt, ...) {
+    if (!e->ok || !olib_output_buffer_reserve(&e->out, 64)) {
+        e->ok = false;
+        return;
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t room = e->out.capacity - e->out.size;
+        va_list args;
+        va_start(args, fmt);
+        int len = vsnprintf((char*)e->out.data + e->out.size, room, fmt, args);
+        va_end(args);
+        if (len < 0) {
+            break;
+        }
+        if ((size_t)len < room) {
+            e->out.size += (size_t)len;
+            return;
+        }
+        if (!olib_output_buffer_reserve(&e->out, (size_t)len + 1)) {
+            break;
+        }
+    }
+    e->ok = false;
+}
+
+// C string literal, split into concatenated pieces so lines stay short. Every byte
+// that is not printable ASCII becomes a three-digit octal escape, which cannot run
+// into a following digit the way hex escapes do.
+static void frozen_literal(frozen_emitter_t* e, const char* text) {
+    frozen_printf(e, "\"");
+    size_t run = 0;
+    for (const unsigned char* p = (const unsigned char*)text; *p && e->ok; p++) {
+        if (run == FROZEN_LINE_BYTES) {
+            frozen_printf(e, "\"\n    \"");
+            run = 0;
+        }
+        run++;
+        switch (*p) {
+            case '"':  frozen_printf(e, "\\\""); break;
+            case '\\': frozen_printf(e, "\\\\"); break;
+            case '?':  frozen_printf(e, "\\?"); break;  // Avoids trigraphs
+            case '\n': frozen_printf(e, "\\n"); break;
+            case '\t': frozen_printf(e, "\\t"); break;
+            default:
+                if (*p >= 0x20 && *p < 0x7F) {
+                    frozen_printf(e, "%c", *p);
+                } else {
+                    frozen_printf(e, "\\%03o", *p);
+                }
+                break;
+        }
+    }
+    frozen_printf(e, "\"");
+}
+
+static void frozen_int(frozen_emitter_t* e, int64_t value) {
+    if (value == INT64_MIN) {
+        frozen_printf(e, "INT64_MIN");
+    } else {
+        frozen_printf(e, "INT64_C(%" PRId64 ")", value);
+    }
+}
+
+static void frozen_float(frozen_emitter_t* e, double value) {
+    if (isnan(value)) {
+        frozen_printf(e, "NAN");
+    } else if (isinf(value)) {
+        frozen_printf(e, value < 0 ? "-HUGE_VAL" : "HUGE_VAL");
+    } else {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", value);
+        // Keep it a double constant, 1e+20 already is but 3 is not
+        frozen_printf(e, strpbrk(buffer, ".e") ? "%s" : "%s.0", buffer);
+    }
+}
+
+// #############################################################################
+// Nodes
+// #############################################################################
+
+// Emit the node and everything below it, returning its number. Children are emitted
+// first so every initializer only refers to symbols defined above it.
+static size_t frozen_node(frozen_emitter_t* e, olib_object_t* obj) {
+    size_t count = 0;
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:   count = obj->data.list.size; break;
+        case OLIB_OBJECT_TYPE_STRUCT: count = obj->data.object.size; break;
+        case OLIB_OBJECT_TYPE_MAP:    count = obj->data.map.size; break;
+        default:                      break;
+    }
+
+    size_t* children = NULL;
+    if (count > 0) {
+        children = olib_malloc(count * sizeof(size_t));
+        if (!children) {
+            e->ok = false;
+            return 0;
+        }
+        for (size_t i = 0; i < count && e->ok; i++) {
+            olib_object_t* child = obj->type == OLIB_OBJECT_TYPE_LIST     ? obj->data.list.items[i]
+                                   : obj->type == OLIB_OBJECT_TYPE_STRUCT ? obj->data.object.entries[i].value
+                                                                          : obj->data.map.entries[i].value;
+            children[i] = frozen_node(e, child);
+        }
+    }
+
+    const char* name = e->name;
+    size_t id = e->next++;
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:
+            if (count > 0) {
+                frozen_printf(e, "static const olib_frozen_t* const %s_a%zu[] = {", name, id);
+                for (size_t i = 0; i < count; i++) {
+                    frozen_printf(e, "%s&%s_n%zu", i ? ", " : "", name, children[i]);
+                }
+                frozen_printf(e, "};\n");
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_LIST(%s_a%zu, %zu);\n", name, id,
+                              name, id, count);
+            } else {
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_LIST(NULL, 0);\n", name, id);
+            }
+            break;
+
+        case OLIB_OBJECT_TYPE_STRUCT:
+            if (count > 0) {
+                frozen_printf(e, "static const olib_frozen_entry_t %s_a%zu[] = {\n", name, id);
+                for (size_t i = 0; i < count; i++) {
+                    frozen_printf(e, "    {");
+                    frozen_literal(e, obj->data.object.entries[i].key);
+                    frozen_printf(e, ", &%s_n%zu},\n", name, children[i]);
+                }
+                frozen_printf(e, "};\n");
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_STRUCT(%s_a%zu, %zu);\n", name, id,
+                              name, id, count);
+            } else {
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_STRUCT(NULL, 0);\n", name, id);
+            }
+            break;
+
+        case OLIB_OBJECT_TYPE_MAP:
+            if (count > 0) {
+                // The hash table is copied as is, it only holds entry positions
+                size_t capacity = obj->data.map.capacity;
+                frozen_printf(e, "static const struct {\n    olib_frozen_map_entry_t entries[%zu];\n", capacity);
+                frozen_printf(e, "    uint32_t slots[%zu];\n} %s_a%zu = {\n    {\n", capacity * 2, name, id);
+                for (size_t i = 0; i < count; i++) {
+                    frozen_printf(e, "        {");
+                    frozen_int(e, obj->data.map.entries[i].key);
+                    frozen_printf(e, ", &%s_n%zu},\n", name, children[i]);
+                }
+                frozen_printf(e, "    },\n    {");
+                uint32_t* slots = olib_object_map_slots(obj);
+                for (size_t i = 0; i < capacity * 2; i++) {
+                    frozen_printf(e, "%s%" PRIu32, i == 0 ? "\n        " : i % 16 ? ", " : ",\n        ", slots[i]);
+                }
+                frozen_printf(e, "\n    },\n};\n");
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_MAP(%s_a%zu.entries, %zu, %zu);\n",
+                              name, id, name, id, count, capacity);
+            } else {
+                frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_MAP(NULL, 0, 0);\n", name, id);
+            }
+            break;
+
+        case OLIB_OBJECT_TYPE_INT:
+            frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_INT(", name, id);
+            frozen_int(e, obj->data.int_val);
+            frozen_printf(e, ");\n");
+            break;
+
+        case OLIB_OBJECT_TYPE_UINT:
+            frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_UINT(UINT64_C(%" PRIu64 "));\n", name,
+                          id, obj->data.uint_val);
+            break;
+
+        case OLIB_OBJECT_TYPE_FLOAT:
+            frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_FLOAT(", name, id);
+            frozen_float(e, obj->data.float_val);
+            frozen_printf(e, ");\n");
+            break;
+
+        case OLIB_OBJECT_TYPE_STRING:
+            frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_STRING(", name, id);
+            frozen_literal(e, obj->data.string.data ? obj->data.string.data : "");
+            frozen_printf(e, ");\n");
+            break;
+
+        case OLIB_OBJECT_TYPE_BOOL:
+            frozen_printf(e, "static const olib_frozen_t %s_n%zu = OLIB_FROZEN_BOOL(%s);\n", name, id,
+                          obj->data.bool_val ? "true" : "false");
+            break;
+
+        default:
+            e->ok = false;
+            break;
+    }
+
+    olib_free(children);
+    return id;
+}
+
+static bool frozen_is_identifier(const char* name) {
+    if (!name || !(*name == '_' || (*name >= 'a' && *name <= 'z') || (*name >= 'A' && *name <= 'Z'))) {
+        return false;
+    }
+    for (const char* p = name; *p; p++) {
+        if (!(*p == '_' || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+OLIB_API bool olib_frozen_emit_c(olib_object_t* obj, const char* name, char** out_source) {
+    if (!obj || !out_source || !frozen_is_identifier(name)) {
+        return false;
+    }
+
+    frozen_emitter_t e = {0};
+    e.name = name;
+    e.ok = true;
+    olib_output_buffer_begin(&e.out);
+
+    frozen_printf(&e, "// Generated by olib_frozen_emit_c, do not edit.\n\n");
+    frozen_printf(&e, "#include <olib/olib_frozen.h>\n#include <math.h>\n\n");
+    frozen_printf(&e, "#if OLIB_FROZEN_VERSION != %d\n", OLIB_FROZEN_VERSION);
+    frozen_printf(&e, "#error \"%s was generated for another olib version, regenerate it\"\n#endif\n\n", name);
+    size_t root = frozen_node(&e, obj);
+    frozen_printf(&e, "\nolib_object_t* %s(void) {\n    return olib_frozen_object(&%s_n%zu);\n}\n", name, name, root);
+
+    uint8_t* data = NULL;
+    size_t size = 0;
+    bool ok = e.ok && olib_output_buffer_finish(&e.out, &data, &size);
+    olib_output_buffer_free(&e.out);
+    if (!ok) {
+        return false;
+    }
+    *out_source = (char*)data;
+    return true;
+}
@@ -23,6 +23,9 @@ SOFTWARE.
 */
 
 #include <olib/olib_helpers.h>
+#include "formats/binary_transcode.h"
+#include "olib_perf_internal.h"
+#include "olib_trace_internal.h"
 
 // #############################################################################
 // Format to serializer mapping
@@ -42,6 +45,72 @@ OLIB_API olib_serializer_t* olib_format_serializer(olib_format_t format) {
     }
 }
 
+// #############################################################################
+// Internal helpers
+// #############################################################################
+
+static bool olib_format_is_text(olib_format_t format) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    bool is_text = olib_serializer_is_text_based(serializer);
+    olib_serializer_free(serializer);
+    return is_text;
+}
+
+// Read the rest of a file into a new buffer (caller must free out_data with olib_free)
+static bool olib_read_file_data(FILE* file, uint8_t** out_data, size_t* out_size) {
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, start, SEEK_SET);
+    if (start < 0 || end <= start) {
+        return false;
+    }
+
+    size_t size = (size_t)(end - start);
+    uint8_t* data = olib_malloc(size);
+    if (!data) {
+        return false;
+    }
+    if (fread(data, 1, size, file) != size) {
+        olib_free(data);
+        return false;
+    }
+    *out_data = data;
+    *out_size = size;
+    return true;
+}
+
+// Read a sized buffer in any format, text formats get a null-terminated copy
+static olib_object_t* olib_read_sized(olib_format_t format, bool is_text, const uint8_t* data, size_t size) {
+    if (!is_text) {
+        return olib_format_read(format, data, size);
+    }
+    char* text = olib_malloc(size + 1);
+    if (!text) {
+        return NULL;
+    }
+    memcpy(text, data, size);
+    text[size] = '\0';
+    olib_object_t* obj = olib_format_read_string(format, text);
+    olib_free(text);
+    return obj;
+}
+
+// Pass a finished read or write to the slow operation hook
+static void olib_slow_op_end_io(olib_slow_op_scope_t* scope, olib_slow_op_kind_t kind, olib_format_t format,
+                                const uint8_t* data, size_t size, olib_object_t* tree) {
+    olib_slow_op_info_t info = {0};
+    info.kind = kind;
+    info.src_format = format;
+    info.dst_format = format;
+    if (kind == OLIB_SLOW_OP_READ) {
+        info.input_size = size;
+    } else {
+        info.output_size = size;
+    }
+    olib_slow_op_end(scope, &info, data, size, tree);
+}
+
 // #############################################################################
 // Write helpers
 // #############################################################################
@@ -57,8 +126,11 @@ OLIB_API bool olib_format_write(olib_format_t format, olib_object_t* obj, uint8_
     }
 
     // olib_serializer_write validates that the serializer is not text-based
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
     bool result = olib_serializer_write(serializer, obj, out_data, out_size);
     olib_serializer_free(serializer);
+    olib_slow_op_end_io(&scope, OLIB_SLOW_OP_WRITE, format, result ? *out_data : NULL, result ? *out_size : 0, obj);
     return result;
 }
 
@@ -73,8 +145,12 @@ OLIB_API bool olib_format_write_string(olib_format_t format, olib_object_t* obj,
     }
 
     // olib_serializer_write_string validates that the serializer is text-based
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
     bool result = olib_serializer_write_string(serializer, obj, out_string);
     olib_serializer_free(serializer);
+    olib_slow_op_end_io(&scope, OLIB_SLOW_OP_WRITE, format, (const uint8_t*)(result ? *out_string : NULL),
+                        result && olib_slow_op_uses_input(&scope) ? strlen(*out_string) : 0, obj);
     return result;
 }
 
@@ -88,7 +164,21 @@ OLIB_API bool olib_format_write_file(olib_format_t format, olib_object_t* obj, F
         return false;
     }
 
-    bool result = olib_serializer_write_file(serializer, obj, file);
+    // While timed, encode to memory first so the hook can see the output
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
+    bool result;
+    if (scope.active) {
+        uint8_t* data = NULL;
+        size_t size = 0;
+        result = olib_serializer_write_filtered(serializer, obj, NULL, &data, &size) &&
+                 fwrite(data, 1, size, file) == size;
+        olib_slow_op_end_io(&scope, OLIB_SLOW_OP_WRITE, format, data, size, obj);
+        olib_free(data);
+    } else {
+        result = olib_serializer_write_file(serializer, obj, file);
+        olib_slow_op_end_io(&scope, OLIB_SLOW_OP_WRITE, format, NULL, 0, obj);
+    }
     olib_serializer_free(serializer);
     return result;
 }
@@ -103,6 +193,17 @@ OLIB_API bool olib_format_write_file_path(olib_format_t format, olib_object_t* o
         return false;
     }
 
+    // Timed writes go through olib_format_write_file
+    if (olib_slow_op_would_time()) {
+        FILE* file = fopen(file_path, olib_serializer_is_text_based(serializer) ? "w" : "wb");
+        olib_serializer_free(serializer);
+        if (!file) {
+            return false;
+        }
+        bool result = olib_format_write_file(format, obj, file);
+        return fclose(file) == 0 && result;
+    }
+
     bool result = olib_serializer_write_file_path(serializer, obj, file_path);
     olib_serializer_free(serializer);
     return result;
@@ -123,8 +224,11 @@ OLIB_API olib_object_t* olib_format_read(olib_format_t format, const uint8_t* da
     }
 
     // olib_serializer_read validates that the serializer is not text-based
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
     olib_object_t* result = olib_serializer_read(serializer, data, size);
     olib_serializer_free(serializer);
+    olib_slow_op_end_io(&scope, OLIB_SLOW_OP_READ, format, data, size, result);
     return result;
 }
 
@@ -139,8 +243,12 @@ OLIB_API olib_object_t* olib_format_read_string(olib_format_t format, const char
     }
 
     // olib_serializer_read_string validates that the serializer is text-based
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
     olib_object_t* result = olib_serializer_read_string(serializer, string);
     olib_serializer_free(serializer);
+    olib_slow_op_end_io(&scope, OLIB_SLOW_OP_READ, format, (const uint8_t*)string,
+                        olib_slow_op_uses_input(&scope) ? strlen(string) : 0, result);
     return result;
 }
 
@@ -149,6 +257,18 @@ OLIB_API olib_object_t* olib_format_read_file(olib_format_t format, FILE* file)
         return NULL;
     }
 
+    // While timed, load the file first so the hook can see the input
+    if (olib_slow_op_would_time()) {
+        uint8_t* data = NULL;
+        size_t size = 0;
+        if (!olib_read_file_data(file, &data, &size)) {
+            return NULL;
+        }
+        olib_object_t* result = olib_read_sized(format, olib_format_is_text(format), data, size);
+        olib_free(data);
+        return result;
+    }
+
     olib_serializer_t* serializer = olib_format_serializer(format);
     if (!serializer) {
         return NULL;
@@ -169,21 +289,163 @@ OLIB_API olib_object_t* olib_format_read_file_path(olib_format_t format, const c
         return NULL;
     }
 
+    // Timed reads go through olib_format_read_file
+    if (olib_slow_op_would_time()) {
+        olib_serializer_free(serializer);
+        FILE* file = fopen(file_path, "rb");
+        if (!file) {
+            return NULL;
+        }
+        olib_object_t* result = olib_format_read_file(format, file);
+        fclose(file);
+        return result;
+    }
+
     olib_object_t* result = olib_serializer_read_file_path(serializer, file_path);
     olib_serializer_free(serializer);
     return result;
 }
 
+// #############################################################################
+// Filtered helpers
+// #############################################################################
+
+OLIB_API bool olib_format_write_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, uint8_t** out_data, size_t* out_size) {
+    if (!obj || !out_data || !out_size) {
+        return false;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+
+    bool result = olib_serializer_write_filtered(serializer, obj, chain, out_data, out_size);
+    olib_serializer_free(serializer);
+    return result;
+}
+
+OLIB_API bool olib_format_write_file_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, FILE* file) {
+    if (!obj || !file) {
+        return false;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+
+    bool result = olib_serializer_write_file_filtered(serializer, obj, chain, file);
+    olib_serializer_free(serializer);
+    return result;
+}
+
+OLIB_API bool olib_format_write_file_path_filtered(olib_format_t format, olib_object_t* obj, olib_stream_chain_t* chain, const char* file_path) {
+    if (!obj || !file_path) {
+        return false;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+
+    bool result = olib_serializer_write_file_path_filtered(serializer, obj, chain, file_path);
+    olib_serializer_free(serializer);
+    return result;
+}
+
+OLIB_API olib_object_t* olib_format_read_filtered(olib_format_t format, olib_stream_chain_t* chain, const uint8_t* data, size_t size) {
+    if (!data || size == 0) {
+        return NULL;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return NULL;
+    }
+
+    olib_object_t* result = olib_serializer_read_filtered(serializer, chain, data, size);
+    olib_serializer_free(serializer);
+    return result;
+}
+
+OLIB_API olib_object_t* olib_format_read_file_filtered(olib_format_t format, olib_stream_chain_t* chain, FILE* file) {
+    if (!file) {
+        return NULL;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return NULL;
+    }
+
+    olib_object_t* result = olib_serializer_read_file_filtered(serializer, chain, file);
+    olib_serializer_free(serializer);
+    return result;
+}
+
+OLIB_API olib_object_t* olib_format_read_file_path_filtered(olib_format_t format, olib_stream_chain_t* chain, const char* file_path) {
+    if (!file_path) {
+        return NULL;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return NULL;
+    }
+
+    olib_object_t* result = olib_serializer_read_file_path_filtered(serializer, chain, file_path);
+    olib_serializer_free(serializer);
+    return result;
+}
+
 // #############################################################################
 // Conversion helpers
 // #############################################################################
 
-OLIB_API bool olib_convert(
+// Convert a file in memory, olib_convert transcodes without a tree when it can
+static bool olib_transcode_file(olib_format_t src_format, FILE* src_file,
+                                olib_format_t dst_format, FILE* dst_file, const char* dst_path) {
+    uint8_t* data = NULL;
+    size_t size = 0;
+    if (!olib_read_file_data(src_file, &data, &size)) {
+        return false;
+    }
+
+    uint8_t* out_data = NULL;
+    size_t out_size = 0;
+    bool result = olib_convert(src_format, data, size, dst_format, &out_data, &out_size);
+    olib_free(data);
+    if (!result) {
+        return false;
+    }
+
+    // With a path, the destination is only opened once the source has been read,
+    // so converting a file onto itself works
+    if (dst_path) {
+        dst_file = fopen(dst_path, olib_format_is_text(dst_format) ? "w" : "wb");
+    }
+    result = dst_file && fwrite(out_data, 1, out_size, dst_file) == out_size;
+    if (dst_path && dst_file) {
+        result = fclose(dst_file) == 0 && result;
+    }
+    olib_free(out_data);
+    return result;
+}
+
+// Convert through the fastest available path, filling the phase timings and node
+// count of info when the call is timed
+static bool olib_convert_timed(
     olib_format_t src_format, const uint8_t* src_data, size_t src_size,
-    olib_format_t dst_format, uint8_t** out_data, size_t* out_size)
+    olib_format_t dst_format, uint8_t** out_data, size_t* out_size,
+    bool timed, olib_slow_op_info_t* info)
 {
-    if (!src_data || src_size == 0 || !out_data || !out_size) {
-        return false;
+    // The binary formats share their wire layout, skip building a tree. Packed
+    // numeric lists are not transcoded and take the tree path below.
+    if (binary_transcode_supported(src_format, dst_format) &&
+        binary_transcode(src_data, src_size, out_data, out_size)) {
+        return true;
     }
 
     // Create serializers to check if they're text-based
@@ -201,18 +463,15 @@ OLIB_API bool olib_convert(
     bool dst_is_text = olib_serializer_is_text_based(dst_ser);
     olib_serializer_free(dst_ser);
 
-    // Read from source format
-    olib_object_t* obj = NULL;
-    if (src_is_text) {
-        obj = olib_format_read_string(src_format, (const char*)src_data);
-    } else {
-        obj = olib_format_read(src_format, src_data, src_size);
-    }
+    // Read from source format, src_data is sized and need not be null-terminated
+    double read_start = timed ? olib_perf_now_ns() : 0.0;
+    olib_object_t* obj = olib_read_sized(src_format, src_is_text, src_data, src_size);
     if (!obj) {
         return false;
     }
 
     // Write to destination format
+    double write_start = timed ? olib_perf_now_ns() : 0.0;
     bool result = false;
     if (dst_is_text) {
         char* str = NULL;
@@ -224,10 +483,36 @@ OLIB_API bool olib_convert(
     } else {
         result = olib_format_write(dst_format, obj, out_data, out_size);
     }
+    if (timed) {
+        info->read_ns = write_start - read_start;
+        info->write_ns = olib_perf_now_ns() - write_start;
+        info->nodes = olib_perf_count_nodes(obj);
+    }
     olib_object_free(obj);
     return result;
 }
 
+OLIB_API bool olib_convert(
+    olib_format_t src_format, const uint8_t* src_data, size_t src_size,
+    olib_format_t dst_format, uint8_t** out_data, size_t* out_size)
+{
+    if (!src_data || src_size == 0 || !out_data || !out_size) {
+        return false;
+    }
+
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
+    olib_slow_op_info_t info = {0};
+    info.kind = OLIB_SLOW_OP_CONVERT;
+    info.src_format = src_format;
+    info.dst_format = dst_format;
+    info.input_size = src_size;
+    bool result = olib_convert_timed(src_format, src_data, src_size, dst_format, out_data, out_size, scope.active, &info);
+    info.output_size = result ? *out_size : 0;
+    olib_slow_op_end(&scope, &info, src_data, src_size, NULL);
+    return result;
+}
+
 OLIB_API bool olib_convert_string(
     olib_format_t src_format, const char* src_string,
     olib_format_t dst_format, char** out_string)
@@ -236,14 +521,27 @@ OLIB_API bool olib_convert_string(
         return false;
     }
 
+    olib_slow_op_scope_t scope;
+    olib_slow_op_begin(&scope);
+    olib_slow_op_info_t info = {0};
+    info.kind = OLIB_SLOW_OP_CONVERT;
+    info.src_format = src_format;
+    info.dst_format = dst_format;
+    info.input_size = olib_slow_op_uses_input(&scope) ? strlen(src_string) : 0;
+
     // Read from source format
+    double read_start = scope.active ? olib_perf_now_ns() : 0.0;
     olib_object_t* obj = olib_format_read_string(src_format, src_string);
-    if (!obj) {
-        return false;
-    }
 
     // Write to destination format
-    bool result = olib_format_write_string(dst_format, obj, out_string);
+    double write_start = scope.active ? olib_perf_now_ns() : 0.0;
+    bool result = obj && olib_format_write_string(dst_format, obj, out_string);
+    if (scope.active) {
+        info.read_ns = write_start - read_start;
+        info.write_ns = olib_perf_now_ns() - write_start;
+        info.output_size = result ? strlen(*out_string) : 0;
+    }
+    olib_slow_op_end(&scope, &info, (const uint8_t*)src_string, info.input_size, obj);
     olib_object_free(obj);
     return result;
 }
@@ -256,6 +554,12 @@ OLIB_API bool olib_convert_file(
         return false;
     }
 
+    // Timed and captured conversions also run in memory, so the hook sees the input and
+    // the trace records one conversion rather than a read and a write
+    if (binary_transcode_supported(src_format, dst_format) || olib_slow_op_would_time() || olib_trace_would_record()) {
+        return olib_transcode_file(src_format, src_file, dst_format, dst_file, NULL);
+    }
+
     // Read from source format
     olib_object_t* obj = olib_format_read_file(src_format, src_file);
     if (!obj) {
@@ -276,6 +580,18 @@ OLIB_API bool olib_convert_file_path(
         return false;
     }
 
+    // Timed and captured conversions also run in memory, so the hook sees the input and
+    // the trace records one conversion rather than a read and a write
+    if (binary_transcode_supported(src_format, dst_format) || olib_slow_op_would_time() || olib_trace_would_record()) {
+        FILE* src_file = fopen(src_path, "rb");
+        if (!src_file) {
+            return false;
+        }
+        bool result = olib_transcode_file(src_format, src_file, dst_format, NULL, dst_path);
+        fclose(src_file);
+        return result;
+    }
+
     // Read from source format
     olib_object_t* obj = olib_format_read_file_path(src_format, src_path);
     if (!obj) {
@@ -287,3 +603,73 @@ OLIB_API bool olib_convert_file_path(
     olib_object_free(obj);
     return result;
 }
+
+OLIB_API bool olib_convert_merge(
+    olib_format_t src_format, const uint8_t* const* src_data, const size_t* src_sizes, size_t src_count,
+    olib_format_t dst_format, uint8_t** out_data, size_t* out_size)
+{
+    if (!src_data || !src_sizes || !out_data || !out_size) {
+        return false;
+    }
+    for (size_t i = 0; i < src_count; i++) {
+        if (!src_data[i] || src_sizes[i] == 0) {
+            return false;
+        }
+    }
+
+    // Binary lists are count-prefixed element runs, splice them without a tree
+    if (binary_transcode_supported(src_format, dst_format) &&
+        binary_transcode_merge(src_data, src_sizes, src_count, out_data, out_size)) {
+        return true;
+    }
+
+    olib_serializer_t* src_ser = olib_format_serializer(src_format);
+    if (!src_ser) {
+        return false;
+    }
+    bool src_is_text = olib_serializer_is_text_based(src_ser);
+    olib_serializer_free(src_ser);
+
+    olib_serializer_t* dst_ser = olib_format_serializer(dst_format);
+    if (!dst_ser) {
+        return false;
+    }
+    bool dst_is_text = olib_serializer_is_text_based(dst_ser);
+    olib_serializer_free(dst_ser);
+
+    olib_object_t* merged = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    if (!merged) {
+        return false;
+    }
+    for (size_t i = 0; i < src_count; i++) {
+        olib_object_t* obj = olib_read_sized(src_format, src_is_text, src_data[i], src_sizes[i]);
+        if (!obj) {
+            olib_object_free(merged);
+            return false;
+        }
+        bool ok = olib_object_get_type(obj) == OLIB_OBJECT_TYPE_LIST
+                      ? olib_object_list_concat(merged, obj)
+                      : olib_object_list_push(merged, obj);
+        if (!ok || olib_object_get_type(obj) == OLIB_OBJECT_TYPE_LIST) {
+            olib_object_free(obj);
+        }
+        if (!ok) {
+            olib_object_free(merged);
+            return false;
+        }
+    }
+
+    bool result = false;
+    if (dst_is_text) {
+        char* str = NULL;
+        result = olib_format_write_string(dst_format, merged, &str);
+        if (result) {
+            *out_data = (uint8_t*)str;
+            *out_size = strlen(str);
+        }
+    } else {
+        result = olib_format_write(dst_format, merged, out_data, out_size);
+    }
+    olib_object_free(merged);
+    return result;
+}
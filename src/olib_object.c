@@ -22,42 +22,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include <olib/olib_object.h>
+#include "olib_object_internal.h"
+#include "olib_observer_internal.h"
+#include "olib_txn_internal.h"
 #include <string.h>
 
-// #############################################################################
-// Internal structures
-// #############################################################################
-
-typedef struct olib_struct_entry_t {
-    char* key;
-    olib_object_t* value;
-} olib_struct_entry_t;
-
-struct olib_object_t {
-    olib_object_type_t type;
-    union {
-        // Value types
-        int64_t int_val;
-        uint64_t uint_val;
-        double float_val;
-        char* string_val;
-        bool bool_val;
-        // List type
-        struct {
-            olib_object_t** items;
-            size_t size;
-            size_t capacity;
-        } list;
-        // Struct type
-        struct {
-            olib_struct_entry_t* entries;
-            size_t size;
-            size_t capacity;
-        } object;
-    } data;
-};
-
 // #############################################################################
 // Type to string
 // #############################################################################
@@ -70,6 +39,7 @@ static const char* g_type_strings[OLIB_OBJECT_TYPE_MAX] = {
     "float",
     "string",
     "bool",
+    "map",
 };
 
 OLIB_API const char* olib_object_type_to_string(olib_object_type_t type) {
@@ -116,14 +86,11 @@ OLIB_API olib_object_t* olib_object_dupe(olib_object_t* obj) {
             copy->data.bool_val = obj->data.bool_val;
             break;
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                size_t len = strlen(obj->data.string_val);
-                copy->data.string_val = olib_malloc(len + 1);
-                if (!copy->data.string_val) {
+            if (obj->data.string.data) {
+                if (!olib_object_set_string_len(copy, obj->data.string.data, strlen(obj->data.string.data))) {
                     olib_object_free(copy);
                     return NULL;
                 }
-                memcpy(copy->data.string_val, obj->data.string_val, len + 1);
             }
             break;
         case OLIB_OBJECT_TYPE_LIST:
@@ -169,6 +136,22 @@ OLIB_API olib_object_t* olib_object_dupe(olib_object_t* obj) {
                 }
             }
             break;
+        case OLIB_OBJECT_TYPE_MAP:
+            if (obj->data.map.size > 0) {
+                if (!olib_object_map_reserve(copy, obj->data.map.size)) {
+                    olib_object_free(copy);
+                    return NULL;
+                }
+                for (size_t i = 0; i < obj->data.map.size; i++) {
+                    olib_object_t* value = olib_object_dupe(obj->data.map.entries[i].value);
+                    if (obj->data.map.entries[i].value && !value) {
+                        olib_object_free(copy);
+                        return NULL;
+                    }
+                    olib_object_map_link(copy, obj->data.map.entries[i].key, value);
+                }
+            }
+            break;
         default:
             break;
     }
@@ -176,15 +159,11 @@ OLIB_API olib_object_t* olib_object_dupe(olib_object_t* obj) {
     return copy;
 }
 
-OLIB_API void olib_object_free(olib_object_t* obj) {
-    if (!obj) {
-        return;
-    }
-
+static void olib_object_release(olib_object_t* obj) {
     switch (obj->type) {
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                olib_free(obj->data.string_val);
+            if (obj->data.string.data) {
+                olib_free(obj->data.string.data);
             }
             break;
         case OLIB_OBJECT_TYPE_LIST:
@@ -204,13 +183,189 @@ OLIB_API void olib_object_free(olib_object_t* obj) {
                 olib_free(obj->data.object.entries);
             }
             break;
+        case OLIB_OBJECT_TYPE_MAP:
+            for (size_t i = 0; i < obj->data.map.size; i++) {
+                olib_object_free(obj->data.map.entries[i].value);
+            }
+            if (obj->data.map.entries) {
+                olib_free(obj->data.map.entries);
+            }
+            break;
         default:
             break;
     }
+}
 
+OLIB_API void olib_object_free(olib_object_t* obj) {
+    if (!obj) {
+        return;
+    }
+    if (obj->observer) {
+        olib_observer_forget(obj);
+    }
+    olib_object_release(obj);
     olib_free(obj);
 }
 
+void olib_object_reset_type(olib_object_t* obj, olib_object_type_t type) {
+    if (obj->type == type) {
+        return;
+    }
+    olib_object_release(obj);
+    memset(&obj->data, 0, sizeof(obj->data));
+    obj->type = type;
+}
+
+// #############################################################################
+// Comparison and hashing
+// #############################################################################
+
+bool olib_object_equal_head(olib_object_t* a, olib_object_t* b) {
+    if (a->type != b->type) {
+        return false;
+    }
+    switch (a->type) {
+        case OLIB_OBJECT_TYPE_INT:
+            return a->data.int_val == b->data.int_val;
+        case OLIB_OBJECT_TYPE_UINT:
+            return a->data.uint_val == b->data.uint_val;
+        case OLIB_OBJECT_TYPE_FLOAT:
+            return memcmp(&a->data.float_val, &b->data.float_val, sizeof(double)) == 0;
+        case OLIB_OBJECT_TYPE_BOOL:
+            return a->data.bool_val == b->data.bool_val;
+        case OLIB_OBJECT_TYPE_STRING:
+            return strcmp(a->data.string.data ? a->data.string.data : "", b->data.string.data ? b->data.string.data : "") == 0;
+        default:
+            return olib_object_child_count(a) == olib_object_child_count(b);
+    }
+}
+
+bool olib_object_equal_key(olib_object_t* a, olib_object_t* b, size_t index) {
+    switch (a->type) {
+        case OLIB_OBJECT_TYPE_STRUCT:
+            return strcmp(a->data.object.entries[index].key, b->data.object.entries[index].key) == 0;
+        case OLIB_OBJECT_TYPE_MAP:
+            return a->data.map.entries[index].key == b->data.map.entries[index].key;
+        default:
+            return true;
+    }
+}
+
+static uint64_t olib_object_hash_mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+static uint64_t olib_object_hash_text(const char* text) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const char* p = text; p && *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+uint64_t olib_object_hash_head(olib_object_t* obj) {
+    uint64_t hash = olib_object_hash_mix(0xCBF29CE484222325ULL, (uint64_t)obj->type);
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_INT:
+            return olib_object_hash_mix(hash, (uint64_t)obj->data.int_val);
+        case OLIB_OBJECT_TYPE_UINT:
+            return olib_object_hash_mix(hash, obj->data.uint_val);
+        case OLIB_OBJECT_TYPE_FLOAT: {
+            uint64_t bits;
+            memcpy(&bits, &obj->data.float_val, sizeof(bits));
+            return olib_object_hash_mix(hash, bits);
+        }
+        case OLIB_OBJECT_TYPE_BOOL:
+            return olib_object_hash_mix(hash, obj->data.bool_val ? 1 : 0);
+        case OLIB_OBJECT_TYPE_STRING:
+            return olib_object_hash_mix(hash, olib_object_hash_text(obj->data.string.data));
+        default:
+            return olib_object_hash_mix(hash, (uint64_t)olib_object_child_count(obj));
+    }
+}
+
+uint64_t olib_object_hash_entry(olib_object_t* obj, size_t index, uint64_t value_hash) {
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_STRUCT:
+            return olib_object_hash_mix(olib_object_hash_text(obj->data.object.entries[index].key), value_hash);
+        case OLIB_OBJECT_TYPE_MAP:
+            return olib_object_hash_mix((uint64_t)obj->data.map.entries[index].key, value_hash);
+        default:
+            return value_hash;
+    }
+}
+
+uint64_t olib_object_hash_join(uint64_t sequence, uint64_t run_sequence, size_t run_count) {
+    // sequence * BASE^run_count, by squaring
+    uint64_t factor = OLIB_OBJECT_HASH_BASE;
+    for (size_t n = run_count; n > 0; n >>= 1) {
+        if (n & 1) {
+            sequence *= factor;
+        }
+        factor *= factor;
+    }
+    return sequence + run_sequence;
+}
+
+uint64_t olib_object_hash_finish(uint64_t head, uint64_t sequence) {
+    // splitmix64 finalizer, so similar trees spread over the whole range
+    uint64_t z = olib_object_hash_mix(head, sequence);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+OLIB_API bool olib_object_equal(olib_object_t* a, olib_object_t* b) {
+    if (a == b) {
+        return true;
+    }
+    if (!a || !b || !olib_object_equal_head(a, b)) {
+        return false;
+    }
+    size_t count = olib_object_child_count(a);
+    for (size_t i = 0; i < count; i++) {
+        if (!olib_object_equal_key(a, b, i) || !olib_object_equal(olib_object_child_at(a, i), olib_object_child_at(b, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OLIB_API uint64_t olib_object_hash(olib_object_t* obj) {
+    if (!obj) {
+        return 0;
+    }
+    uint64_t sequence = 0;
+    size_t count = olib_object_child_count(obj);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value_hash = olib_object_hash(olib_object_child_at(obj, i));
+        sequence = sequence * OLIB_OBJECT_HASH_BASE + olib_object_hash_entry(obj, i, value_hash);
+    }
+    return olib_object_hash_finish(olib_object_hash_head(obj), sequence);
+}
+
+// #############################################################################
+// Observation
+// #############################################################################
+
+// Transaction logging changes to obj, NULL for unobserved nodes without a lookup
+static olib_txn_t* olib_object_txn(olib_object_t* obj) {
+    return obj->observer ? olib_txn_of(obj) : NULL;
+}
+
+// Hand a displaced child and key to the transaction log, or free them outside of one
+static void olib_object_displace(olib_txn_t* txn, olib_undo_op_t op, olib_object_t* obj, size_t index,
+                                 olib_object_t* child, char* key) {
+    if (txn) {
+        olib_txn_record(txn, op, obj, index, child, key);
+        return;
+    }
+    olib_free(key);
+    olib_object_free(child);
+}
+
 // #############################################################################
 // Helper getters
 // #############################################################################
@@ -245,7 +400,8 @@ OLIB_API bool olib_object_is_container(olib_object_t* obj) {
         return false;
     }
     return obj->type == OLIB_OBJECT_TYPE_STRUCT ||
-           obj->type == OLIB_OBJECT_TYPE_LIST;
+           obj->type == OLIB_OBJECT_TYPE_LIST ||
+           obj->type == OLIB_OBJECT_TYPE_MAP;
 }
 
 // #############################################################################
@@ -269,10 +425,14 @@ OLIB_API olib_object_t* olib_object_list_get(olib_object_t* obj, size_t index) {
     return obj->data.list.items[index];
 }
 
-static bool olib_object_list_grow(olib_object_t* obj, size_t min_capacity) {
+bool olib_object_list_reserve(olib_object_t* obj, size_t min_capacity) {
     if (obj->data.list.capacity >= min_capacity) {
         return true;
     }
+    // Requests can come from counts read off untrusted input, keep the doubling from overflowing
+    if (min_capacity > SIZE_MAX / 2 / sizeof(olib_object_t*)) {
+        return false;
+    }
     size_t new_capacity = obj->data.list.capacity ? obj->data.list.capacity * 2 : 4;
     while (new_capacity < min_capacity) {
         new_capacity *= 2;
@@ -293,8 +453,22 @@ OLIB_API bool olib_object_list_set(olib_object_t* obj, size_t index, olib_object
     if (index >= obj->data.list.size) {
         return false;
     }
-    olib_object_free(obj->data.list.items[index]);
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        return false;
+    }
+    olib_observer_change_t change;
+    bool observed = obj->observer &&
+                    olib_observer_change_begin(&change, obj, OLIB_CHANGE_SET, NULL, index, obj->data.list.items[index]);
+    olib_object_t* old = obj->data.list.items[index];
     obj->data.list.items[index] = value;
+    olib_object_displace(txn, OLIB_UNDO_LIST_SET, obj, index, old, NULL);
+    if (obj->observer) {
+        olib_observer_adopt(obj, value, index);
+    }
+    if (observed) {
+        olib_observer_change_end(&change, value);
+    }
     return true;
 }
 
@@ -305,14 +479,29 @@ OLIB_API bool olib_object_list_insert(olib_object_t* obj, size_t index, olib_obj
     if (index > obj->data.list.size) {
         return false;
     }
-    if (!olib_object_list_grow(obj, obj->data.list.size + 1)) {
+    if (!olib_object_list_reserve(obj, obj->data.list.size + 1)) {
         return false;
     }
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        return false;
+    }
+    olib_observer_change_t change;
+    bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_INSERT, NULL, index, NULL);
     for (size_t i = obj->data.list.size; i > index; i--) {
         obj->data.list.items[i] = obj->data.list.items[i - 1];
     }
     obj->data.list.items[index] = value;
     obj->data.list.size++;
+    if (txn) {
+        olib_txn_record(txn, OLIB_UNDO_LIST_INSERT, obj, index, NULL, NULL);
+    }
+    if (obj->observer) {
+        olib_observer_adopt(obj, value, index);
+    }
+    if (observed) {
+        olib_observer_change_end(&change, value);
+    }
     return true;
 }
 
@@ -323,11 +512,22 @@ OLIB_API bool olib_object_list_remove(olib_object_t* obj, size_t index) {
     if (index >= obj->data.list.size) {
         return false;
     }
-    olib_object_free(obj->data.list.items[index]);
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        return false;
+    }
+    olib_observer_change_t change;
+    bool observed = obj->observer &&
+                    olib_observer_change_begin(&change, obj, OLIB_CHANGE_REMOVE, NULL, index, obj->data.list.items[index]);
+    olib_object_t* old = obj->data.list.items[index];
     for (size_t i = index; i < obj->data.list.size - 1; i++) {
         obj->data.list.items[i] = obj->data.list.items[i + 1];
     }
     obj->data.list.size--;
+    olib_object_displace(txn, OLIB_UNDO_LIST_REMOVE, obj, index, old, NULL);
+    if (observed) {
+        olib_observer_change_end(&change, NULL);
+    }
     return true;
 }
 
@@ -348,6 +548,96 @@ OLIB_API bool olib_object_list_pop(olib_object_t* obj) {
     return olib_object_list_remove(obj, obj->data.list.size - 1);
 }
 
+// Report items that left an observed list, last first so that every index is valid when replayed
+static void olib_object_list_moved_out(olib_object_t* obj, olib_object_t** items, size_t index, size_t count) {
+    for (size_t i = count; i-- > 0;) {
+        olib_observer_change_t change;
+        if (olib_observer_change_begin(&change, obj, OLIB_CHANGE_REMOVE, NULL, index + i, items[i])) {
+            olib_observer_change_end(&change, NULL);
+        }
+        olib_observer_disown(items[i]);
+    }
+}
+
+static void olib_object_list_moved_in(olib_object_t* obj, size_t index, size_t count) {
+    for (size_t i = index; i < index + count; i++) {
+        olib_object_t* item = obj->data.list.items[i];
+        olib_observer_adopt(obj, item, i);
+        olib_observer_change_t change;
+        if (olib_observer_change_begin(&change, obj, OLIB_CHANGE_INSERT, NULL, i, NULL)) {
+            olib_observer_change_end(&change, item);
+        }
+    }
+}
+
+OLIB_API olib_object_t* olib_object_list_split(olib_object_t* obj, size_t index) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_LIST) {
+        return NULL;
+    }
+    if (index > obj->data.list.size) {
+        return NULL;
+    }
+    // Moved items leave the tree for good, which a transaction could not undo
+    if (olib_object_txn(obj)) {
+        return NULL;
+    }
+    olib_object_t* tail = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    if (!tail) {
+        return NULL;
+    }
+    size_t count = obj->data.list.size - index;
+    if (count > 0) {
+        if (!olib_object_list_reserve(tail, count)) {
+            olib_object_free(tail);
+            return NULL;
+        }
+        memcpy(tail->data.list.items, obj->data.list.items + index, count * sizeof(olib_object_t*));
+        tail->data.list.size = count;
+        obj->data.list.size = index;
+        if (obj->observer) {
+            olib_object_list_moved_out(obj, tail->data.list.items, index, count);
+        }
+    }
+    return tail;
+}
+
+OLIB_API bool olib_object_list_concat(olib_object_t* obj, olib_object_t* src) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_LIST) {
+        return false;
+    }
+    if (!src || src->type != OLIB_OBJECT_TYPE_LIST || src == obj) {
+        return false;
+    }
+    if (olib_object_txn(obj) || olib_object_txn(src)) {
+        return false;
+    }
+    size_t count = src->data.list.size;
+    if (count == 0) {
+        return true;
+    }
+    if (count > SIZE_MAX - obj->data.list.size ||
+        !olib_object_list_reserve(obj, obj->data.list.size + count)) {
+        return false;
+    }
+    memcpy(obj->data.list.items + obj->data.list.size, src->data.list.items, count * sizeof(olib_object_t*));
+    obj->data.list.size += count;
+    src->data.list.size = 0;
+    if (src->observer) {
+        olib_object_list_moved_out(src, obj->data.list.items + obj->data.list.size - count, 0, count);
+    }
+    if (obj->observer) {
+        olib_object_list_moved_in(obj, obj->data.list.size - count, count);
+    }
+    return true;
+}
+
+void olib_object_list_truncate(olib_object_t* obj, size_t size) {
+    while (obj->data.list.size > size) {
+        obj->data.list.size--;
+        olib_object_free(obj->data.list.items[obj->data.list.size]);
+    }
+}
+
 // #############################################################################
 // Struct operations
 // #############################################################################
@@ -403,10 +693,13 @@ OLIB_API olib_object_t* olib_object_struct_value_at(olib_object_t* obj, size_t i
     return obj->data.object.entries[index].value;
 }
 
-static bool olib_object_struct_grow(olib_object_t* obj, size_t min_capacity) {
+bool olib_object_struct_reserve(olib_object_t* obj, size_t min_capacity) {
     if (obj->data.object.capacity >= min_capacity) {
         return true;
     }
+    if (min_capacity > SIZE_MAX / 2 / sizeof(olib_struct_entry_t)) {
+        return false;
+    }
     size_t new_capacity = obj->data.object.capacity ? obj->data.object.capacity * 2 : 4;
     while (new_capacity < min_capacity) {
         new_capacity *= 2;
@@ -420,6 +713,35 @@ static bool olib_object_struct_grow(olib_object_t* obj, size_t min_capacity) {
     return true;
 }
 
+olib_struct_entry_t* olib_object_struct_insert_entry(olib_object_t* obj, size_t index, const char* key) {
+    if (index > obj->data.object.size) {
+        return NULL;
+    }
+    if (!olib_object_struct_reserve(obj, obj->data.object.size + 1)) {
+        return NULL;
+    }
+    size_t key_len = strlen(key);
+    char* key_copy = olib_malloc(key_len + 1);
+    if (!key_copy) {
+        return NULL;
+    }
+    memcpy(key_copy, key, key_len + 1);
+    olib_struct_entry_t* entries = obj->data.object.entries;
+    memmove(&entries[index + 1], &entries[index], (obj->data.object.size - index) * sizeof(olib_struct_entry_t));
+    entries[index].key = key_copy;
+    entries[index].value = NULL;
+    obj->data.object.size++;
+    return &entries[index];
+}
+
+void olib_object_struct_truncate(olib_object_t* obj, size_t size) {
+    while (obj->data.object.size > size) {
+        obj->data.object.size--;
+        olib_free(obj->data.object.entries[obj->data.object.size].key);
+        olib_object_free(obj->data.object.entries[obj->data.object.size].value);
+    }
+}
+
 OLIB_API bool olib_object_struct_add(olib_object_t* obj, const char* key, olib_object_t* value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_STRUCT || !key) {
         return false;
@@ -427,7 +749,7 @@ OLIB_API bool olib_object_struct_add(olib_object_t* obj, const char* key, olib_o
     if (olib_object_struct_find(obj, key)) {
         return false;
     }
-    if (!olib_object_struct_grow(obj, obj->data.object.size + 1)) {
+    if (!olib_object_struct_reserve(obj, obj->data.object.size + 1)) {
         return false;
     }
     size_t key_len = strlen(key);
@@ -436,9 +758,25 @@ OLIB_API bool olib_object_struct_add(olib_object_t* obj, const char* key, olib_o
         return false;
     }
     memcpy(key_copy, key, key_len + 1);
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        olib_free(key_copy);
+        return false;
+    }
+    olib_observer_change_t change;
+    bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_INSERT, key, 0, NULL);
     obj->data.object.entries[obj->data.object.size].key = key_copy;
     obj->data.object.entries[obj->data.object.size].value = value;
     obj->data.object.size++;
+    if (txn) {
+        olib_txn_record(txn, OLIB_UNDO_STRUCT_ADD, obj, obj->data.object.size - 1, NULL, NULL);
+    }
+    if (obj->observer) {
+        olib_observer_adopt(obj, value, obj->data.object.size - 1);
+    }
+    if (observed) {
+        olib_observer_change_end(&change, value);
+    }
     return true;
 }
 
@@ -448,8 +786,21 @@ OLIB_API bool olib_object_struct_set(olib_object_t* obj, const char* key, olib_o
     }
     olib_struct_entry_t* entry = olib_object_struct_find(obj, key);
     if (entry) {
-        olib_object_free(entry->value);
+        olib_txn_t* txn = olib_object_txn(obj);
+        if (txn && !olib_txn_reserve(txn)) {
+            return false;
+        }
+        olib_observer_change_t change;
+        bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_SET, key, 0, entry->value);
+        olib_object_t* old = entry->value;
         entry->value = value;
+        olib_object_displace(txn, OLIB_UNDO_STRUCT_SET, obj, (size_t)(entry - obj->data.object.entries), old, NULL);
+        if (obj->observer) {
+            olib_observer_adopt(obj, value, (size_t)(entry - obj->data.object.entries));
+        }
+        if (observed) {
+            olib_observer_change_end(&change, value);
+        }
         return true;
     }
     return olib_object_struct_add(obj, key, value);
@@ -461,18 +812,299 @@ OLIB_API bool olib_object_struct_remove(olib_object_t* obj, const char* key) {
     }
     for (size_t i = 0; i < obj->data.object.size; i++) {
         if (strcmp(obj->data.object.entries[i].key, key) == 0) {
-            olib_free(obj->data.object.entries[i].key);
-            olib_object_free(obj->data.object.entries[i].value);
+            olib_txn_t* txn = olib_object_txn(obj);
+            if (txn && !olib_txn_reserve(txn)) {
+                return false;
+            }
+            olib_observer_change_t change;
+            bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_REMOVE, key, 0,
+                                                                        obj->data.object.entries[i].value);
+            olib_struct_entry_t removed = obj->data.object.entries[i];
             for (size_t j = i; j < obj->data.object.size - 1; j++) {
                 obj->data.object.entries[j] = obj->data.object.entries[j + 1];
             }
             obj->data.object.size--;
+            olib_object_displace(txn, OLIB_UNDO_STRUCT_REMOVE, obj, i, removed.value, removed.key);
+            if (observed) {
+                olib_observer_change_end(&change, NULL);
+            }
             return true;
         }
     }
     return false;
 }
 
+// #############################################################################
+// Map operations
+// #############################################################################
+
+static size_t olib_object_map_hash(int64_t key) {
+    uint64_t h = (uint64_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+// Slot holding key, or the empty slot it would go into
+static size_t olib_object_map_probe(olib_object_t* obj, int64_t key) {
+    uint32_t* slots = olib_object_map_slots(obj);
+    size_t mask = obj->data.map.capacity * 2 - 1;
+    size_t pos = olib_object_map_hash(key) & mask;
+    while (slots[pos] && obj->data.map.entries[slots[pos] - 1].key != key) {
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+static void olib_object_map_rehash(olib_object_t* obj) {
+    uint32_t* slots = olib_object_map_slots(obj);
+    memset(slots, 0, obj->data.map.capacity * 2 * sizeof(uint32_t));
+    for (size_t i = 0; i < obj->data.map.size; i++) {
+        slots[olib_object_map_probe(obj, obj->data.map.entries[i].key)] = (uint32_t)i + 1;
+    }
+}
+
+OLIB_API size_t olib_object_map_size(olib_object_t* obj) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return 0;
+    }
+    return obj->data.map.size;
+}
+
+size_t olib_object_map_find(olib_object_t* obj, int64_t key) {
+    if (obj->data.map.size == 0) {
+        return SIZE_MAX;
+    }
+    uint32_t slot = olib_object_map_slots(obj)[olib_object_map_probe(obj, key)];
+    return slot ? slot - 1 : SIZE_MAX;
+}
+
+OLIB_API bool olib_object_map_has(olib_object_t* obj, int64_t key) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return false;
+    }
+    return olib_object_map_find(obj, key) != SIZE_MAX;
+}
+
+OLIB_API olib_object_t* olib_object_map_get(olib_object_t* obj, int64_t key) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return NULL;
+    }
+    size_t index = olib_object_map_find(obj, key);
+    return index != SIZE_MAX ? obj->data.map.entries[index].value : NULL;
+}
+
+OLIB_API int64_t olib_object_map_key_at(olib_object_t* obj, size_t index) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return 0;
+    }
+    if (index >= obj->data.map.size) {
+        return 0;
+    }
+    return obj->data.map.entries[index].key;
+}
+
+OLIB_API olib_object_t* olib_object_map_value_at(olib_object_t* obj, size_t index) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return NULL;
+    }
+    if (index >= obj->data.map.size) {
+        return NULL;
+    }
+    return obj->data.map.entries[index].value;
+}
+
+bool olib_object_map_reserve(olib_object_t* obj, size_t min_capacity) {
+    if (obj->data.map.capacity >= min_capacity) {
+        return true;
+    }
+    // Slots hold 32-bit entry indices
+    if (min_capacity > UINT32_MAX / 4) {
+        return false;
+    }
+    size_t new_capacity = obj->data.map.capacity ? obj->data.map.capacity * 2 : 4;
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    // The table moves with the entries, so it is rebuilt in a new block rather than reallocated
+    olib_map_entry_t* new_entries = olib_malloc(new_capacity * (sizeof(olib_map_entry_t) + 2 * sizeof(uint32_t)));
+    if (!new_entries) {
+        return false;
+    }
+    if (obj->data.map.entries) {
+        memcpy(new_entries, obj->data.map.entries, obj->data.map.size * sizeof(olib_map_entry_t));
+        olib_free(obj->data.map.entries);
+    }
+    obj->data.map.entries = new_entries;
+    obj->data.map.capacity = new_capacity;
+    olib_object_map_rehash(obj);
+    return true;
+}
+
+void olib_object_map_link(olib_object_t* obj, int64_t key, olib_object_t* value) {
+    size_t index = obj->data.map.size++;
+    obj->data.map.entries[index].key = key;
+    obj->data.map.entries[index].value = value;
+    olib_object_map_slots(obj)[olib_object_map_probe(obj, key)] = (uint32_t)index + 1;
+}
+
+void olib_object_map_unlink(olib_object_t* obj, size_t index) {
+    olib_map_entry_t* entries = obj->data.map.entries;
+    uint32_t* slots = olib_object_map_slots(obj);
+    size_t mask = obj->data.map.capacity * 2 - 1;
+    size_t hole = olib_object_map_probe(obj, entries[index].key);
+    // Backward-shift deletion: later slots of the probe run move up into the hole unless
+    // that would put them before their home slot, so no tombstones are needed
+    for (size_t pos = (hole + 1) & mask; slots[pos]; pos = (pos + 1) & mask) {
+        size_t home = olib_object_map_hash(entries[slots[pos] - 1].key) & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            slots[hole] = slots[pos];
+            hole = pos;
+        }
+    }
+    slots[hole] = 0;
+    size_t last = --obj->data.map.size;
+    if (index != last) {
+        slots[olib_object_map_probe(obj, entries[last].key)] = (uint32_t)index + 1;
+        entries[index] = entries[last];
+    }
+}
+
+void olib_object_map_swap(olib_object_t* obj, size_t a, size_t b) {
+    if (a == b) {
+        return;
+    }
+    olib_map_entry_t* entries = obj->data.map.entries;
+    uint32_t* slots = olib_object_map_slots(obj);
+    size_t slot_a = olib_object_map_probe(obj, entries[a].key);
+    size_t slot_b = olib_object_map_probe(obj, entries[b].key);
+    slots[slot_a] = (uint32_t)b + 1;
+    slots[slot_b] = (uint32_t)a + 1;
+    olib_map_entry_t tmp = entries[a];
+    entries[a] = entries[b];
+    entries[b] = tmp;
+}
+
+void olib_object_map_truncate(olib_object_t* obj, size_t size) {
+    while (obj->data.map.size > size) {
+        size_t last = obj->data.map.size - 1;
+        olib_object_t* value = obj->data.map.entries[last].value;
+        olib_object_map_unlink(obj, last);
+        olib_object_free(value);
+    }
+}
+
+OLIB_API bool olib_object_map_add(olib_object_t* obj, int64_t key, olib_object_t* value) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return false;
+    }
+    if (olib_object_map_find(obj, key) != SIZE_MAX) {
+        return false;
+    }
+    if (!olib_object_map_reserve(obj, obj->data.map.size + 1)) {
+        return false;
+    }
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        return false;
+    }
+    olib_observer_change_t change;
+    char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+    bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_INSERT,
+                                                                olib_object_map_key_text(key, key_text), 0, NULL);
+    olib_object_map_link(obj, key, value);
+    if (txn) {
+        olib_txn_record(txn, OLIB_UNDO_MAP_ADD, obj, obj->data.map.size - 1, NULL, NULL);
+    }
+    if (obj->observer) {
+        olib_observer_adopt(obj, value, obj->data.map.size - 1);
+    }
+    if (observed) {
+        olib_observer_change_end(&change, value);
+    }
+    return true;
+}
+
+OLIB_API bool olib_object_map_set(olib_object_t* obj, int64_t key, olib_object_t* value) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return false;
+    }
+    size_t index = olib_object_map_find(obj, key);
+    if (index != SIZE_MAX) {
+        olib_map_entry_t* entry = &obj->data.map.entries[index];
+        olib_txn_t* txn = olib_object_txn(obj);
+        if (txn && !olib_txn_reserve(txn)) {
+            return false;
+        }
+        olib_observer_change_t change;
+        char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+        bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_SET,
+                                                                    olib_object_map_key_text(key, key_text), 0, entry->value);
+        olib_object_t* old = entry->value;
+        entry->value = value;
+        olib_object_displace(txn, OLIB_UNDO_MAP_SET, obj, index, old, NULL);
+        if (obj->observer) {
+            olib_observer_adopt(obj, value, index);
+        }
+        if (observed) {
+            olib_observer_change_end(&change, value);
+        }
+        return true;
+    }
+    return olib_object_map_add(obj, key, value);
+}
+
+OLIB_API bool olib_object_map_remove(olib_object_t* obj, int64_t key) {
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP) {
+        return false;
+    }
+    size_t index = olib_object_map_find(obj, key);
+    if (index == SIZE_MAX) {
+        return false;
+    }
+    olib_txn_t* txn = olib_object_txn(obj);
+    if (txn && !olib_txn_reserve(txn)) {
+        return false;
+    }
+    olib_observer_change_t change;
+    char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+    bool observed = obj->observer && olib_observer_change_begin(&change, obj, OLIB_CHANGE_REMOVE,
+                                                                olib_object_map_key_text(key, key_text), 0,
+                                                                obj->data.map.entries[index].value);
+    olib_object_t* removed = obj->data.map.entries[index].value;
+    olib_object_map_unlink(obj, index);
+    if (txn) {
+        olib_txn_record_map_remove(txn, obj, index, removed, key);
+    } else {
+        olib_object_free(removed);
+    }
+    if (observed) {
+        olib_observer_change_end(&change, NULL);
+    }
+    return true;
+}
+
+static int olib_object_map_compare(const void* a, const void* b) {
+    int64_t key_a = ((const olib_map_entry_t*)a)->key;
+    int64_t key_b = ((const olib_map_entry_t*)b)->key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+OLIB_API bool olib_object_map_sort(olib_object_t* obj) {
+    // The undo log has no entry for a reordering, so sorting is refused inside a transaction
+    if (!obj || obj->type != OLIB_OBJECT_TYPE_MAP || olib_object_txn(obj)) {
+        return false;
+    }
+    if (obj->data.map.size > 1) {
+        qsort(obj->data.map.entries, obj->data.map.size, sizeof(olib_map_entry_t), olib_object_map_compare);
+        olib_object_map_rehash(obj);
+    }
+    return true;
+}
+
 // #############################################################################
 // Value getters
 // #############################################################################
@@ -491,8 +1123,8 @@ OLIB_API int64_t olib_object_get_int(olib_object_t* obj) {
         case OLIB_OBJECT_TYPE_BOOL:
             return obj->data.bool_val ? 1 : 0;
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                return strtoll(obj->data.string_val, NULL, 10);
+            if (obj->data.string.data) {
+                return strtoll(obj->data.string.data, NULL, 10);
             }
             return 0;
         default:
@@ -514,8 +1146,8 @@ OLIB_API uint64_t olib_object_get_uint(olib_object_t* obj) {
         case OLIB_OBJECT_TYPE_BOOL:
             return obj->data.bool_val ? 1 : 0;
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                return strtoull(obj->data.string_val, NULL, 10);
+            if (obj->data.string.data) {
+                return strtoull(obj->data.string.data, NULL, 10);
             }
             return 0;
         default:
@@ -537,8 +1169,8 @@ OLIB_API double olib_object_get_float(olib_object_t* obj) {
         case OLIB_OBJECT_TYPE_BOOL:
             return obj->data.bool_val ? 1.0 : 0.0;
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                return strtod(obj->data.string_val, NULL);
+            if (obj->data.string.data) {
+                return strtod(obj->data.string.data, NULL);
             }
             return 0.0;
         default:
@@ -552,7 +1184,7 @@ OLIB_API const char* olib_object_get_string(olib_object_t* obj) {
     }
     // Only return actual string values, no conversion for string getter
     if (obj->type == OLIB_OBJECT_TYPE_STRING) {
-        return obj->data.string_val;
+        return obj->data.string.data;
     }
     return NULL;
 }
@@ -571,9 +1203,9 @@ OLIB_API bool olib_object_get_bool(olib_object_t* obj) {
         case OLIB_OBJECT_TYPE_FLOAT:
             return obj->data.float_val != 0.0;
         case OLIB_OBJECT_TYPE_STRING:
-            if (obj->data.string_val) {
-                return strcmp(obj->data.string_val, "true") == 0 ||
-                       strcmp(obj->data.string_val, "1") == 0;
+            if (obj->data.string.data) {
+                return strcmp(obj->data.string.data, "true") == 0 ||
+                       strcmp(obj->data.string.data, "1") == 0;
             }
             return false;
         default:
@@ -585,11 +1217,34 @@ OLIB_API bool olib_object_get_bool(olib_object_t* obj) {
 // Value setters
 // #############################################################################
 
+// Setters of observed values log the old value in an open transaction, and report a copy
+// of the value before and after the change. Returns false if the setter must fail.
+static bool olib_object_value_change_begin(olib_object_t* obj, olib_observer_change_t* change, bool* observed) {
+    *observed = false;
+    if (!obj->observer) {
+        return true;
+    }
+    olib_txn_t* txn = olib_txn_of(obj);
+    if (txn && !olib_txn_record_value(txn, obj)) {
+        return false;
+    }
+    *observed = olib_observer_change_begin(change, obj, OLIB_CHANGE_SET, NULL, OLIB_OBSERVER_SELF, obj);
+    return true;
+}
+
 OLIB_API bool olib_object_set_int(olib_object_t* obj, int64_t value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_INT) {
         return false;
     }
+    olib_observer_change_t change;
+    bool observed;
+    if (!olib_object_value_change_begin(obj, &change, &observed)) {
+        return false;
+    }
     obj->data.int_val = value;
+    if (observed) {
+        olib_observer_change_end(&change, obj);
+    }
     return true;
 }
 
@@ -597,7 +1252,15 @@ OLIB_API bool olib_object_set_uint(olib_object_t* obj, uint64_t value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_UINT) {
         return false;
     }
+    olib_observer_change_t change;
+    bool observed;
+    if (!olib_object_value_change_begin(obj, &change, &observed)) {
+        return false;
+    }
     obj->data.uint_val = value;
+    if (observed) {
+        olib_observer_change_end(&change, obj);
+    }
     return true;
 }
 
@@ -605,7 +1268,37 @@ OLIB_API bool olib_object_set_float(olib_object_t* obj, double value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_FLOAT) {
         return false;
     }
+    olib_observer_change_t change;
+    bool observed;
+    if (!olib_object_value_change_begin(obj, &change, &observed)) {
+        return false;
+    }
     obj->data.float_val = value;
+    if (observed) {
+        olib_observer_change_end(&change, obj);
+    }
+    return true;
+}
+
+bool olib_object_set_string_len(olib_object_t* obj, const char* value, size_t len) {
+    // Reuse the current buffer when the new value fits, so rewriting a string
+    // of the same or smaller length does not allocate
+    if (obj->data.string.capacity < len + 1) {
+        char* data = olib_malloc(len + 1);
+        if (!data) {
+            return false;
+        }
+        memcpy(data, value, len);
+        data[len] = '\0';
+        if (obj->data.string.data) {
+            olib_free(obj->data.string.data);
+        }
+        obj->data.string.data = data;
+        obj->data.string.capacity = len + 1;
+        return true;
+    }
+    memmove(obj->data.string.data, value, len);
+    obj->data.string.data[len] = '\0';
     return true;
 }
 
@@ -613,25 +1306,39 @@ OLIB_API bool olib_object_set_string(olib_object_t* obj, const char* value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_STRING) {
         return false;
     }
-    if (obj->data.string_val) {
-        olib_free(obj->data.string_val);
-        obj->data.string_val = NULL;
+    olib_observer_change_t change;
+    bool observed;
+    if (!olib_object_value_change_begin(obj, &change, &observed)) {
+        return false;
     }
-    if (value) {
-        size_t len = strlen(value);
-        obj->data.string_val = olib_malloc(len + 1);
-        if (!obj->data.string_val) {
-            return false;
+    bool ok = true;
+    if (!value) {
+        if (obj->data.string.data) {
+            olib_free(obj->data.string.data);
+            obj->data.string.data = NULL;
+            obj->data.string.capacity = 0;
         }
-        memcpy(obj->data.string_val, value, len + 1);
+    } else {
+        ok = olib_object_set_string_len(obj, value, strlen(value));
     }
-    return true;
+    if (observed) {
+        olib_observer_change_end(&change, obj);
+    }
+    return ok;
 }
 
 OLIB_API bool olib_object_set_bool(olib_object_t* obj, bool value) {
     if (!obj || obj->type != OLIB_OBJECT_TYPE_BOOL) {
         return false;
     }
+    olib_observer_change_t change;
+    bool observed;
+    if (!olib_object_value_change_begin(obj, &change, &observed)) {
+        return false;
+    }
     obj->data.bool_val = value;
+    if (observed) {
+        olib_observer_change_end(&change, obj);
+    }
     return true;
 }
\ No newline at end of file
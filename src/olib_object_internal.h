@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <olib/olib_object.h>
+#include <inttypes.h>
+
+// Object layout shared between the library sources. Not part of the public API.
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct olib_struct_entry_t {
+    char* key;
+    olib_object_t* value;
+} olib_struct_entry_t;
+
+typedef struct olib_map_entry_t {
+    int64_t key;
+    olib_object_t* value;
+} olib_map_entry_t;
+
+struct olib_object_t {
+    olib_object_type_t type;
+    uint32_t observer;  // Id of the observer watching this node, 0 if none (fills the padding after type)
+    union {
+        // Value types
+        int64_t int_val;
+        uint64_t uint_val;
+        double float_val;
+        bool bool_val;
+        // String type (capacity includes the null terminator, 0 when data is NULL)
+        struct {
+            char* data;
+            size_t capacity;
+        } string;
+        // List type
+        struct {
+            olib_object_t** items;
+            size_t size;
+            size_t capacity;
+        } list;
+        // Struct type
+        struct {
+            olib_struct_entry_t* entries;
+            size_t size;
+            size_t capacity;
+        } object;
+        // Map type. The entries block also holds the hash table behind the entries,
+        // see olib_object_map_slots
+        struct {
+            olib_map_entry_t* entries;
+            size_t size;
+            size_t capacity;
+        } map;
+    } data;
+};
+
+// #############################################################################
+// Internal helpers
+// #############################################################################
+
+// Release the contents of obj and change its type, keeping the node itself.
+// Does nothing if obj already has the requested type.
+void olib_object_reset_type(olib_object_t* obj, olib_object_type_t type);
+
+// Set a string value with a known length, reusing the existing buffer when it is large enough
+bool olib_object_set_string_len(olib_object_t* obj, const char* value, size_t len);
+
+// Ensure a list or struct can hold at least min_capacity items without reallocating
+bool olib_object_list_reserve(olib_object_t* obj, size_t min_capacity);
+bool olib_object_struct_reserve(olib_object_t* obj, size_t min_capacity);
+
+// Insert a new entry with a copy of key and a NULL value at index
+olib_struct_entry_t* olib_object_struct_insert_entry(olib_object_t* obj, size_t index, const char* key);
+
+// Free entries (keys and values) past the first size entries
+void olib_object_struct_truncate(olib_object_t* obj, size_t size);
+
+// Free items past the first size items
+void olib_object_list_truncate(olib_object_t* obj, size_t size);
+
+// Hash table of a map: 2 * capacity linear-probing slots holding entry index + 1, 0 when empty
+static inline uint32_t* olib_object_map_slots(olib_object_t* obj) {
+    return (uint32_t*)(obj->data.map.entries + obj->data.map.capacity);
+}
+
+// Ensure a map can hold at least min_capacity entries without reallocating
+bool olib_object_map_reserve(olib_object_t* obj, size_t min_capacity);
+
+// Position of key in the entries, SIZE_MAX if the map has no such key
+size_t olib_object_map_find(olib_object_t* obj, int64_t key);
+
+// Append an entry for a key that is not in the map yet, the capacity must allow it
+void olib_object_map_link(olib_object_t* obj, int64_t key, olib_object_t* value);
+
+// Take the entry at index out of the map without freeing its value. The last entry
+// moves into its place.
+void olib_object_map_unlink(olib_object_t* obj, size_t index);
+
+// Exchange the positions of two entries
+void olib_object_map_swap(olib_object_t* obj, size_t a, size_t b);
+
+// Free entries past the first size entries
+void olib_object_map_truncate(olib_object_t* obj, size_t size);
+
+// Decimal text of a map key, the path segment "[key]" observers report for map entries
+#define OLIB_MAP_KEY_TEXT_SIZE 24
+static inline const char* olib_object_map_key_text(int64_t key, char* buffer) {
+    snprintf(buffer, OLIB_MAP_KEY_TEXT_SIZE, "%" PRId64, key);
+    return buffer;
+}
+
+// #############################################################################
+// Comparison and hashing
+// #############################################################################
+
+// Children of a container by position, 0 and NULL for values
+static inline size_t olib_object_child_count(olib_object_t* obj) {
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:   return obj->data.list.size;
+        case OLIB_OBJECT_TYPE_STRUCT: return obj->data.object.size;
+        case OLIB_OBJECT_TYPE_MAP:    return obj->data.map.size;
+        default:                      return 0;
+    }
+}
+
+static inline olib_object_t* olib_object_child_at(olib_object_t* obj, size_t index) {
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:   return obj->data.list.items[index];
+        case OLIB_OBJECT_TYPE_STRUCT: return obj->data.object.entries[index].value;
+        case OLIB_OBJECT_TYPE_MAP:    return obj->data.map.entries[index].value;
+        default:                      return NULL;
+    }
+}
+
+// Type, value and child count of two nodes match, children are not looked at
+bool olib_object_equal_head(olib_object_t* a, olib_object_t* b);
+
+// Keys of the entries at index match (always true for lists)
+bool olib_object_equal_key(olib_object_t* a, olib_object_t* b, size_t index);
+
+// A container hashes the sequence of its entry hashes as a polynomial, so runs of entries
+// can be hashed apart and joined: sequence = sequence * OLIB_OBJECT_HASH_BASE + entry.
+#define OLIB_OBJECT_HASH_BASE 0x100000001B3ULL
+
+// Hash of everything about a node except its children
+uint64_t olib_object_hash_head(olib_object_t* obj);
+
+// Hash of the entry at index, given the hash of its value
+uint64_t olib_object_hash_entry(olib_object_t* obj, size_t index, uint64_t value_hash);
+
+// Sequence of a run of entries appended to the sequence before it
+uint64_t olib_object_hash_join(uint64_t sequence, uint64_t run_sequence, size_t run_count);
+
+// Node hash from its head and the sequence of all its entries
+uint64_t olib_object_hash_finish(uint64_t head, uint64_t sequence);
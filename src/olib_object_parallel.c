@@ -0,0 +1,363 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "olib_object_internal.h"
+#include "olib_thread.h"
+#include <string.h>
+
+// #############################################################################
+// Splitting
+// #############################################################################
+
+#define OLIB_PARALLEL_MIN_CHILDREN 4096
+#define OLIB_PARALLEL_MIN_CHUNK 64
+#define OLIB_PARALLEL_CHUNKS_PER_THREAD 4
+#define OLIB_PARALLEL_EXIT_CHECK 64
+
+typedef enum {
+    OLIB_PARALLEL_DUPE,
+    OLIB_PARALLEL_FREE,
+    OLIB_PARALLEL_EQUAL,
+    OLIB_PARALLEL_HASH,
+} olib_parallel_op_t;
+
+typedef struct {
+    size_t threads;
+    size_t min_children;
+    olib_thread_pool_t* pool;    // Started at the first split, before that only the caller runs
+    bool pool_failed;
+    olib_thread_mutex_t* lock;   // Guards unequal
+    bool unequal;                // Set as soon as any chunk finds a difference
+} olib_parallel_t;
+
+// A run of children of one container, a and b are the source and copy, or the two sides
+typedef struct {
+    olib_parallel_t* ctx;
+    olib_parallel_op_t op;
+    olib_object_t* a;
+    olib_object_t* b;
+    size_t begin;
+    size_t end;
+    bool ok;
+    uint64_t sequence;
+} olib_parallel_chunk_t;
+
+static olib_object_t* olib_parallel_dupe(olib_parallel_t* ctx, size_t worker, olib_object_t* obj);
+static void olib_parallel_free(olib_parallel_t* ctx, size_t worker, olib_object_t* obj);
+static bool olib_parallel_equal(olib_parallel_t* ctx, size_t worker, olib_object_t* a, olib_object_t* b);
+static uint64_t olib_parallel_hash(olib_parallel_t* ctx, size_t worker, olib_object_t* obj);
+
+static bool olib_parallel_is_unequal(olib_parallel_t* ctx) {
+    if (!ctx->lock) {
+        return false;
+    }
+    olib_thread_mutex_lock(ctx->lock);
+    bool unequal = ctx->unequal;
+    olib_thread_mutex_unlock(ctx->lock);
+    return unequal;
+}
+
+static void olib_parallel_set_unequal(olib_parallel_t* ctx) {
+    if (!ctx->lock) {
+        return;
+    }
+    olib_thread_mutex_lock(ctx->lock);
+    ctx->unequal = true;
+    olib_thread_mutex_unlock(ctx->lock);
+}
+
+static bool olib_parallel_dupe_child(olib_parallel_t* ctx, size_t worker, olib_object_t* src, olib_object_t* dst, size_t index) {
+    olib_object_t* child = olib_object_child_at(src, index);
+    olib_object_t* copy = olib_parallel_dupe(ctx, worker, child);
+    switch (src->type) {
+        case OLIB_OBJECT_TYPE_LIST:
+            dst->data.list.items[index] = copy;
+            break;
+        case OLIB_OBJECT_TYPE_STRUCT: {
+            dst->data.object.entries[index].value = copy;
+            const char* key = src->data.object.entries[index].key;
+            size_t key_len = strlen(key);
+            char* key_copy = olib_malloc(key_len + 1);
+            if (!key_copy) {
+                return false;
+            }
+            memcpy(key_copy, key, key_len + 1);
+            dst->data.object.entries[index].key = key_copy;
+            break;
+        }
+        case OLIB_OBJECT_TYPE_MAP:
+            dst->data.map.entries[index].value = copy;
+            break;
+        default:
+            break;
+    }
+    return !child || copy;
+}
+
+static void olib_parallel_run(olib_parallel_t* ctx, size_t worker, olib_parallel_chunk_t* chunk) {
+    olib_object_t* a = chunk->a;
+    olib_object_t* b = chunk->b;
+    for (size_t i = chunk->begin; i < chunk->end && chunk->ok; i++) {
+        switch (chunk->op) {
+            case OLIB_PARALLEL_DUPE:
+                chunk->ok = olib_parallel_dupe_child(ctx, worker, a, b, i);
+                break;
+            case OLIB_PARALLEL_FREE:
+                if (a->type == OLIB_OBJECT_TYPE_STRUCT) {
+                    olib_free(a->data.object.entries[i].key);
+                }
+                olib_parallel_free(ctx, worker, olib_object_child_at(a, i));
+                break;
+            case OLIB_PARALLEL_EQUAL:
+                if ((i - chunk->begin) % OLIB_PARALLEL_EXIT_CHECK == 0 && olib_parallel_is_unequal(ctx)) {
+                    chunk->ok = false;
+                    break;
+                }
+                chunk->ok = olib_object_equal_key(a, b, i) &&
+                            olib_parallel_equal(ctx, worker, olib_object_child_at(a, i), olib_object_child_at(b, i));
+                if (!chunk->ok) {
+                    olib_parallel_set_unequal(ctx);
+                }
+                break;
+            case OLIB_PARALLEL_HASH: {
+                uint64_t value_hash = olib_parallel_hash(ctx, worker, olib_object_child_at(a, i));
+                chunk->sequence = chunk->sequence * OLIB_OBJECT_HASH_BASE + olib_object_hash_entry(a, i, value_hash);
+                break;
+            }
+        }
+    }
+}
+
+static void olib_parallel_task(olib_thread_pool_t* pool, size_t worker, void* task) {
+    (void)pool;
+    olib_parallel_chunk_t* chunk = (olib_parallel_chunk_t*)task;
+    olib_parallel_run(chunk->ctx, worker, chunk);
+}
+
+// Run op over every child of a, in chunks spread over the pool when a is large enough.
+// The chunks are combined in order, so the result does not depend on how a was split.
+static olib_parallel_chunk_t olib_parallel_children(olib_parallel_t* ctx, size_t worker, olib_parallel_op_t op,
+                                                    olib_object_t* a, olib_object_t* b) {
+    size_t count = olib_object_child_count(a);
+    olib_parallel_chunk_t whole = {ctx, op, a, b, 0, count, true, 0};
+    if (ctx->threads < 2 || count < ctx->min_children) {
+        olib_parallel_run(ctx, worker, &whole);
+        return whole;
+    }
+
+    // No task has been pushed before the pool exists, so only the caller can get here first
+    if (!ctx->pool && !ctx->pool_failed) {
+        ctx->pool = olib_thread_pool_new(ctx->threads);
+        ctx->pool_failed = ctx->pool == NULL;
+    }
+    size_t chunk_count = ctx->threads * OLIB_PARALLEL_CHUNKS_PER_THREAD;
+    if (chunk_count > count / OLIB_PARALLEL_MIN_CHUNK) {
+        chunk_count = count / OLIB_PARALLEL_MIN_CHUNK;
+    }
+    olib_parallel_chunk_t* chunks = ctx->pool && chunk_count > 1 ? olib_calloc(chunk_count, sizeof(olib_parallel_chunk_t)) : NULL;
+    if (!chunks) {
+        olib_parallel_run(ctx, worker, &whole);
+        return whole;
+    }
+
+    olib_thread_group_t group = {0};
+    for (size_t i = 0; i < chunk_count; i++) {
+        chunks[i] = whole;
+        chunks[i].begin = count * i / chunk_count;
+        chunks[i].end = count * (i + 1) / chunk_count;
+    }
+    for (size_t i = 1; i < chunk_count; i++) {
+        if (!olib_thread_pool_push(ctx->pool, worker, &group, olib_parallel_task, &chunks[i])) {
+            olib_parallel_run(ctx, worker, &chunks[i]);
+        }
+    }
+    olib_parallel_run(ctx, worker, &chunks[0]);
+    olib_thread_pool_wait(ctx->pool, worker, &group);
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        whole.ok = whole.ok && chunks[i].ok;
+        whole.sequence = olib_object_hash_join(whole.sequence, chunks[i].sequence, chunks[i].end - chunks[i].begin);
+    }
+    olib_free(chunks);
+    return whole;
+}
+
+// #############################################################################
+// Tree walks
+// #############################################################################
+
+static olib_object_t* olib_parallel_dupe(olib_parallel_t* ctx, size_t worker, olib_object_t* obj) {
+    if (!obj) {
+        return NULL;
+    }
+    size_t count = olib_object_child_count(obj);
+    if (count == 0) {
+        return olib_object_dupe(obj);
+    }
+
+    // Every slot exists up front so chunks can fill them in any order
+    olib_object_t* copy = olib_object_new(obj->type);
+    if (!copy) {
+        return NULL;
+    }
+    bool ok = true;
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:
+            copy->data.list.items = olib_calloc(count, sizeof(olib_object_t*));
+            ok = copy->data.list.items != NULL;
+            if (ok) {
+                copy->data.list.size = count;
+                copy->data.list.capacity = count;
+            }
+            break;
+        case OLIB_OBJECT_TYPE_STRUCT:
+            copy->data.object.entries = olib_calloc(count, sizeof(olib_struct_entry_t));
+            ok = copy->data.object.entries != NULL;
+            if (ok) {
+                copy->data.object.size = count;
+                copy->data.object.capacity = count;
+            }
+            break;
+        case OLIB_OBJECT_TYPE_MAP:
+            ok = olib_object_map_reserve(copy, count);
+            for (size_t i = 0; ok && i < count; i++) {
+                olib_object_map_link(copy, obj->data.map.entries[i].key, NULL);
+            }
+            break;
+        default:
+            break;
+    }
+    if (ok) {
+        ok = olib_parallel_children(ctx, worker, OLIB_PARALLEL_DUPE, obj, copy).ok;
+    }
+    if (!ok) {
+        // Struct keys of chunks that stopped early are still NULL
+        if (copy->type == OLIB_OBJECT_TYPE_STRUCT) {
+            for (size_t i = 0; i < copy->data.object.size; i++) {
+                if (copy->data.object.entries[i].key) {
+                    olib_free(copy->data.object.entries[i].key);
+                }
+                olib_object_free(copy->data.object.entries[i].value);
+            }
+            copy->data.object.size = 0;
+        }
+        olib_object_free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+static void olib_parallel_free(olib_parallel_t* ctx, size_t worker, olib_object_t* obj) {
+    // Observers are not thread-safe, observed trees are released node by node on this thread
+    if (!obj || obj->observer || olib_object_child_count(obj) == 0) {
+        olib_object_free(obj);
+        return;
+    }
+    olib_parallel_children(ctx, worker, OLIB_PARALLEL_FREE, obj, NULL);
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_LIST:
+            obj->data.list.size = 0;
+            break;
+        case OLIB_OBJECT_TYPE_STRUCT:
+            obj->data.object.size = 0;
+            break;
+        case OLIB_OBJECT_TYPE_MAP:
+            obj->data.map.size = 0;
+            break;
+        default:
+            break;
+    }
+    olib_object_free(obj);
+}
+
+static bool olib_parallel_equal(olib_parallel_t* ctx, size_t worker, olib_object_t* a, olib_object_t* b) {
+    if (a == b) {
+        return true;
+    }
+    if (!a || !b || !olib_object_equal_head(a, b)) {
+        return false;
+    }
+    return olib_object_child_count(a) == 0 || olib_parallel_children(ctx, worker, OLIB_PARALLEL_EQUAL, a, b).ok;
+}
+
+static uint64_t olib_parallel_hash(olib_parallel_t* ctx, size_t worker, olib_object_t* obj) {
+    if (!obj) {
+        return 0;
+    }
+    uint64_t sequence = olib_parallel_children(ctx, worker, OLIB_PARALLEL_HASH, obj, NULL).sequence;
+    return olib_object_hash_finish(olib_object_hash_head(obj), sequence);
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+static void olib_parallel_init(olib_parallel_t* ctx, const olib_parallel_config_t* config) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->threads = config && config->threads > 0 ? config->threads : olib_thread_cpu_count();
+    ctx->min_children = config && config->min_children > 0 ? config->min_children : OLIB_PARALLEL_MIN_CHILDREN;
+    if (ctx->min_children < 2) {
+        ctx->min_children = 2;
+    }
+}
+
+static void olib_parallel_finish(olib_parallel_t* ctx) {
+    olib_thread_pool_free(ctx->pool);
+    olib_thread_mutex_free(ctx->lock);
+}
+
+OLIB_API olib_object_t* olib_object_dupe_parallel(olib_object_t* obj, const olib_parallel_config_t* config) {
+    olib_parallel_t ctx;
+    olib_parallel_init(&ctx, config);
+    olib_object_t* copy = olib_parallel_dupe(&ctx, 0, obj);
+    olib_parallel_finish(&ctx);
+    return copy;
+}
+
+OLIB_API void olib_object_free_parallel(olib_object_t* obj, const olib_parallel_config_t* config) {
+    olib_parallel_t ctx;
+    olib_parallel_init(&ctx, config);
+    olib_parallel_free(&ctx, 0, obj);
+    olib_parallel_finish(&ctx);
+}
+
+OLIB_API bool olib_object_equal_parallel(olib_object_t* a, olib_object_t* b, const olib_parallel_config_t* config) {
+    olib_parallel_t ctx;
+    olib_parallel_init(&ctx, config);
+    // Without the flag every chunk still finds its own difference, only later
+    if (ctx.threads > 1) {
+        ctx.lock = olib_thread_mutex_new();
+    }
+    bool equal = olib_parallel_equal(&ctx, 0, a, b);
+    olib_parallel_finish(&ctx);
+    return equal;
+}
+
+OLIB_API uint64_t olib_object_hash_parallel(olib_object_t* obj, const olib_parallel_config_t* config) {
+    olib_parallel_t ctx;
+    olib_parallel_init(&ctx, config);
+    uint64_t hash = olib_parallel_hash(&ctx, 0, obj);
+    olib_parallel_finish(&ctx);
+    return hash;
+}
@@ -0,0 +1,642 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "olib_observer_internal.h"
+#include "olib_object_internal.h"
+#include "olib_thread.h"
+#include <stdio.h>
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// Slots of the parent map with these keys are free
+#define OBSERVER_SLOT_EMPTY ((olib_object_t*)NULL)
+#define OBSERVER_SLOT_DELETED ((olib_object_t*)&g_deleted_marker)
+
+static char g_deleted_marker;
+
+typedef struct observer_slot_t {
+    olib_object_t* node;
+    olib_object_t* parent;  // NULL for the root
+    size_t position;        // Index of node in parent when last seen, checked before use
+} observer_slot_t;
+
+struct olib_subscription_t {
+    char* prefix;
+    size_t prefix_len;
+    olib_observer_fn fn;
+    void* ctx;
+};
+
+struct olib_observer_t {
+    uint32_t id;
+    olib_object_t* root;
+
+    // Open-addressing map from every node of the tree to its parent
+    observer_slot_t* slots;
+    size_t capacity;
+    size_t count;
+    size_t deleted;
+
+    olib_subscription_t** subscriptions;
+    size_t subscription_count;
+    size_t subscription_capacity;
+
+    olib_change_t* pending;
+    size_t pending_count;
+    size_t pending_capacity;
+    size_t batch_depth;
+    olib_txn_t* txn;
+};
+
+// Observers by id - 1, guarded by olib_thread_lock
+static olib_observer_t** g_observers = NULL;
+static size_t g_observer_capacity = 0;
+
+static olib_observer_t* observer_from_id(uint32_t id) {
+    olib_thread_lock();
+    olib_observer_t* observer = id - 1 < g_observer_capacity ? g_observers[id - 1] : NULL;
+    olib_thread_unlock();
+    return observer;
+}
+
+// #############################################################################
+// Parent map
+// #############################################################################
+
+static size_t observer_hash(olib_object_t* node) {
+    uint64_t h = (uint64_t)(uintptr_t)node;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+static observer_slot_t* observer_find_slot(olib_observer_t* observer, olib_object_t* node) {
+    size_t mask = observer->capacity - 1;
+    for (size_t i = observer_hash(node) & mask;; i = (i + 1) & mask) {
+        observer_slot_t* slot = &observer->slots[i];
+        if (slot->node == node) {
+            return slot;
+        }
+        if (slot->node == OBSERVER_SLOT_EMPTY) {
+            return NULL;
+        }
+    }
+}
+
+static void observer_place(observer_slot_t* slots, size_t capacity, olib_object_t* node, olib_object_t* parent,
+                           size_t position) {
+    size_t mask = capacity - 1;
+    size_t i = observer_hash(node) & mask;
+    while (slots[i].node != OBSERVER_SLOT_EMPTY && slots[i].node != OBSERVER_SLOT_DELETED) {
+        i = (i + 1) & mask;
+    }
+    slots[i].node = node;
+    slots[i].parent = parent;
+    slots[i].position = position;
+}
+
+// Keep the map at most half full counting deleted slots
+static bool observer_reserve(olib_observer_t* observer, size_t extra) {
+    if ((observer->count + observer->deleted + extra) * 2 <= observer->capacity) {
+        return true;
+    }
+    size_t capacity = observer->capacity ? observer->capacity : 64;
+    while ((observer->count + extra) * 2 > capacity) {
+        capacity *= 2;
+    }
+    observer_slot_t* slots = olib_calloc(capacity, sizeof(observer_slot_t));
+    if (!slots) {
+        return false;
+    }
+    for (size_t i = 0; i < observer->capacity; i++) {
+        olib_object_t* node = observer->slots[i].node;
+        if (node != OBSERVER_SLOT_EMPTY && node != OBSERVER_SLOT_DELETED) {
+            observer_place(slots, capacity, node, observer->slots[i].parent, observer->slots[i].position);
+        }
+    }
+    olib_free(observer->slots);
+    observer->slots = slots;
+    observer->capacity = capacity;
+    observer->deleted = 0;
+    return true;
+}
+
+static void observer_remove_slot(olib_observer_t* observer, olib_object_t* node) {
+    observer_slot_t* slot = observer_find_slot(observer, node);
+    if (slot) {
+        slot->node = OBSERVER_SLOT_DELETED;
+        observer->count--;
+        observer->deleted++;
+    }
+}
+
+static size_t observer_count_nodes(olib_object_t* obj) {
+    size_t count = 1;
+    if (obj->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < obj->data.list.size; i++) {
+            if (obj->data.list.items[i]) {
+                count += observer_count_nodes(obj->data.list.items[i]);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < obj->data.object.size; i++) {
+            if (obj->data.object.entries[i].value) {
+                count += observer_count_nodes(obj->data.object.entries[i].value);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_MAP) {
+        for (size_t i = 0; i < obj->data.map.size; i++) {
+            if (obj->data.map.entries[i].value) {
+                count += observer_count_nodes(obj->data.map.entries[i].value);
+            }
+        }
+    }
+    return count;
+}
+
+// Mark a subtree and record its parents and positions, the map must have room for it
+static void observer_track(olib_observer_t* observer, olib_object_t* obj, olib_object_t* parent, size_t position) {
+    observer_slot_t* slot = obj->observer == observer->id ? observer_find_slot(observer, obj) : NULL;
+    if (slot) {
+        slot->parent = parent;
+        slot->position = position;
+    } else {
+        observer_place(observer->slots, observer->capacity, obj, parent, position);
+        observer->count++;
+        obj->observer = observer->id;
+    }
+    if (obj->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < obj->data.list.size; i++) {
+            if (obj->data.list.items[i]) {
+                observer_track(observer, obj->data.list.items[i], obj, i);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < obj->data.object.size; i++) {
+            if (obj->data.object.entries[i].value) {
+                observer_track(observer, obj->data.object.entries[i].value, obj, i);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_MAP) {
+        for (size_t i = 0; i < obj->data.map.size; i++) {
+            if (obj->data.map.entries[i].value) {
+                observer_track(observer, obj->data.map.entries[i].value, obj, i);
+            }
+        }
+    }
+}
+
+static void observer_untrack(olib_observer_t* observer, olib_object_t* obj) {
+    if (observer) {
+        observer_remove_slot(observer, obj);
+    }
+    obj->observer = 0;
+    if (obj->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < obj->data.list.size; i++) {
+            if (obj->data.list.items[i]) {
+                observer_untrack(observer, obj->data.list.items[i]);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < obj->data.object.size; i++) {
+            if (obj->data.object.entries[i].value) {
+                observer_untrack(observer, obj->data.object.entries[i].value);
+            }
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_MAP) {
+        for (size_t i = 0; i < obj->data.map.size; i++) {
+            if (obj->data.map.entries[i].value) {
+                observer_untrack(observer, obj->data.map.entries[i].value);
+            }
+        }
+    }
+}
+
+// #############################################################################
+// Paths
+// #############################################################################
+
+typedef struct observer_path_t {
+    char* data;
+    size_t size;
+    size_t capacity;
+} observer_path_t;
+
+static bool observer_path_append(observer_path_t* path, const char* text, size_t len) {
+    if (path->size + len + 1 > path->capacity) {
+        size_t capacity = path->capacity ? path->capacity * 2 : 64;
+        while (capacity < path->size + len + 1) {
+            capacity *= 2;
+        }
+        char* data = olib_realloc(path->data, capacity);
+        if (!data) {
+            return false;
+        }
+        path->data = data;
+        path->capacity = capacity;
+    }
+    memcpy(path->data + path->size, text, len);
+    path->size += len;
+    path->data[path->size] = '\0';
+    return true;
+}
+
+// key is the struct key, or the decimal map key for maps
+static bool observer_path_step(observer_path_t* path, olib_object_t* container, const char* key, size_t index) {
+    if (container->type == OLIB_OBJECT_TYPE_STRUCT) {
+        return (path->size == 0 || observer_path_append(path, ".", 1)) && observer_path_append(path, key, strlen(key));
+    }
+    if (container->type == OLIB_OBJECT_TYPE_MAP) {
+        return observer_path_append(path, "[", 1) && observer_path_append(path, key, strlen(key)) &&
+               observer_path_append(path, "]", 1);
+    }
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "[%zu]", index);
+    return observer_path_append(path, buffer, (size_t)len);
+}
+
+// True if a equals b or is an ancestor of it
+static bool observer_path_covers(const char* a, size_t a_len, const char* b) {
+    if (a_len == 0) {
+        return true;
+    }
+    if (strncmp(a, b, a_len) != 0) {
+        return false;
+    }
+    return b[a_len] == '\0' || b[a_len] == '.' || b[a_len] == '[';
+}
+
+static bool observer_matches(olib_subscription_t* subscription, const char* path) {
+    return observer_path_covers(subscription->prefix, subscription->prefix_len, path) ||
+           observer_path_covers(path, strlen(path), subscription->prefix);
+}
+
+static bool observer_any_match(olib_observer_t* observer, const char* path) {
+    for (size_t s = 0; s < observer->subscription_count; s++) {
+        if (observer_matches(observer->subscriptions[s], path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static olib_object_t* observer_child_at(olib_object_t* parent, size_t i) {
+    if (parent->type == OLIB_OBJECT_TYPE_LIST) {
+        return parent->data.list.items[i];
+    }
+    if (parent->type == OLIB_OBJECT_TYPE_STRUCT) {
+        return parent->data.object.entries[i].value;
+    }
+    return parent->data.map.entries[i].value;
+}
+
+static size_t observer_child_count(olib_object_t* parent) {
+    switch (parent->type) {
+        case OLIB_OBJECT_TYPE_LIST: return parent->data.list.size;
+        case OLIB_OBJECT_TYPE_STRUCT: return parent->data.object.size;
+        case OLIB_OBJECT_TYPE_MAP: return parent->data.map.size;
+        default: return 0;
+    }
+}
+
+// Where the child of a slot sits in its parent, false if it is not there. The recorded
+// position is tried first, then positions ever further from it, since inserts and
+// removes shift children by a little at a time. The position found is recorded again.
+static bool observer_locate(observer_slot_t* slot, const char** out_key, size_t* out_index, char* key_text) {
+    olib_object_t* parent = slot->parent;
+    size_t count = observer_child_count(parent);
+    if (count == 0) {
+        return false;
+    }
+    size_t hint = slot->position < count ? slot->position : count - 1;
+    size_t found = SIZE_MAX;
+    for (size_t distance = 0; found == SIZE_MAX && (distance <= hint || hint + distance < count); distance++) {
+        if (hint + distance < count && observer_child_at(parent, hint + distance) == slot->node) {
+            found = hint + distance;
+        } else if (distance > 0 && distance <= hint && observer_child_at(parent, hint - distance) == slot->node) {
+            found = hint - distance;
+        }
+    }
+    if (found == SIZE_MAX) {
+        return false;
+    }
+    slot->position = found;
+    if (parent->type == OLIB_OBJECT_TYPE_LIST) {
+        *out_index = found;
+    } else if (parent->type == OLIB_OBJECT_TYPE_STRUCT) {
+        *out_key = parent->data.object.entries[found].key;
+    } else {
+        *out_key = olib_object_map_key_text(parent->data.map.entries[found].key, key_text);
+    }
+    return true;
+}
+
+// Append the path of node, false if it cannot be built or if no subscription can match
+// the change, which is decided as soon as the path leaves every subscribed prefix
+static bool observer_build_path(olib_observer_t* observer, olib_object_t* node, observer_path_t* path) {
+    observer_slot_t* slot = observer_find_slot(observer, node);
+    if (!slot) {
+        return false;
+    }
+    if (!slot->parent) {
+        return observer_path_append(path, "", 0);
+    }
+    const char* key = NULL;
+    size_t index = 0;
+    char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+    return observer_build_path(observer, slot->parent, path) && observer_locate(slot, &key, &index, key_text) &&
+           observer_path_step(path, slot->parent, key, index) && observer_any_match(observer, path->data);
+}
+
+// #############################################################################
+// Delivery
+// #############################################################################
+
+static void observer_release_changes(olib_change_t* changes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        olib_free((char*)changes[i].path);
+        olib_object_free(changes[i].old_value);
+        olib_object_free(changes[i].new_value);
+    }
+}
+
+static void observer_deliver(olib_observer_t* observer) {
+    size_t count = observer->pending_count;
+    if (count == 0) {
+        return;
+    }
+    olib_change_t* matched = olib_malloc(count * sizeof(olib_change_t));
+    for (size_t s = 0; matched && s < observer->subscription_count; s++) {
+        olib_subscription_t* subscription = observer->subscriptions[s];
+        size_t matched_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (observer_matches(subscription, observer->pending[i].path)) {
+                matched[matched_count++] = observer->pending[i];
+            }
+        }
+        if (matched_count > 0) {
+            subscription->fn(subscription->ctx, matched, matched_count);
+        }
+    }
+    olib_free(matched);
+    observer_release_changes(observer->pending, count);
+    observer->pending_count = 0;
+}
+
+// #############################################################################
+// Mutator hooks
+// #############################################################################
+
+bool olib_observer_change_begin(olib_observer_change_t* change, olib_object_t* obj, olib_change_kind_t kind,
+                                const char* key, size_t index, olib_object_t* old_value) {
+    olib_observer_t* observer = observer_from_id(obj->observer);
+    if (!observer || observer->subscription_count == 0) {
+        return false;
+    }
+    observer_path_t path = {0};
+    bool matched = observer_build_path(observer, obj, &path) &&
+                   (index == OLIB_OBSERVER_SELF && !key ? true : observer_path_step(&path, obj, key, index)) &&
+                   observer_any_match(observer, path.data);
+    if (!matched) {
+        olib_free(path.data);
+        return false;
+    }
+    change->observer = observer;
+    change->kind = kind;
+    change->path = path.data;
+    change->old_value = olib_object_dupe(old_value);
+    return true;
+}
+
+void olib_observer_change_end(olib_observer_change_t* change, olib_object_t* new_value) {
+    olib_observer_t* observer = change->observer;
+    if (observer->pending_count == observer->pending_capacity) {
+        size_t capacity = observer->pending_capacity ? observer->pending_capacity * 2 : 8;
+        olib_change_t* pending = olib_realloc(observer->pending, capacity * sizeof(olib_change_t));
+        if (!pending) {
+            olib_free(change->path);
+            olib_object_free(change->old_value);
+            return;
+        }
+        observer->pending = pending;
+        observer->pending_capacity = capacity;
+    }
+    olib_change_t* entry = &observer->pending[observer->pending_count++];
+    entry->kind = change->kind;
+    entry->path = change->path;
+    entry->old_value = change->old_value;
+    entry->new_value = olib_object_dupe(new_value);
+    if (observer->batch_depth == 0) {
+        observer_deliver(observer);
+    }
+}
+
+void olib_observer_adopt(olib_object_t* container, olib_object_t* child, size_t index) {
+    olib_observer_t* observer = observer_from_id(container->observer);
+    if (!observer || !child) {
+        return;
+    }
+    // Without room in the map the subtree stays unobserved rather than failing the mutation
+    if (observer_reserve(observer, observer_count_nodes(child))) {
+        observer_track(observer, child, container, index);
+    }
+}
+
+void olib_observer_disown(olib_object_t* child) {
+    if (child && child->observer) {
+        observer_untrack(observer_from_id(child->observer), child);
+    }
+}
+
+void olib_observer_forget(olib_object_t* obj) {
+    olib_observer_t* observer = observer_from_id(obj->observer);
+    obj->observer = 0;
+    if (!observer) {
+        return;
+    }
+    observer_remove_slot(observer, obj);
+    if (observer->root == obj) {
+        observer->root = NULL;
+    }
+}
+
+olib_observer_t* olib_observer_of(olib_object_t* obj) {
+    return obj->observer ? observer_from_id(obj->observer) : NULL;
+}
+
+olib_object_t* olib_observer_root(olib_observer_t* observer) {
+    return observer->root;
+}
+
+olib_txn_t* olib_observer_txn(olib_observer_t* observer) {
+    return observer->txn;
+}
+
+void olib_observer_set_txn(olib_observer_t* observer, olib_txn_t* txn) {
+    observer->txn = txn;
+}
+
+size_t olib_observer_pending_mark(olib_observer_t* observer) {
+    return observer->pending_count;
+}
+
+void olib_observer_discard_pending(olib_observer_t* observer, size_t mark) {
+    if (mark < observer->pending_count) {
+        observer_release_changes(observer->pending + mark, observer->pending_count - mark);
+        observer->pending_count = mark;
+    }
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+OLIB_API olib_observer_t* olib_observer_new(olib_object_t* root) {
+    if (!root || root->observer) {
+        return NULL;
+    }
+    olib_observer_t* observer = olib_calloc(1, sizeof(olib_observer_t));
+    if (!observer) {
+        return NULL;
+    }
+    if (!observer_reserve(observer, observer_count_nodes(root))) {
+        olib_free(observer);
+        return NULL;
+    }
+
+    olib_thread_lock();
+    size_t slot = 0;
+    while (slot < g_observer_capacity && g_observers[slot]) {
+        slot++;
+    }
+    if (slot == g_observer_capacity) {
+        size_t capacity = g_observer_capacity ? g_observer_capacity * 2 : 8;
+        olib_observer_t** observers = olib_realloc(g_observers, capacity * sizeof(olib_observer_t*));
+        if (!observers) {
+            olib_thread_unlock();
+            olib_free(observer->slots);
+            olib_free(observer);
+            return NULL;
+        }
+        memset(observers + g_observer_capacity, 0, (capacity - g_observer_capacity) * sizeof(olib_observer_t*));
+        g_observers = observers;
+        g_observer_capacity = capacity;
+    }
+    g_observers[slot] = observer;
+    olib_thread_unlock();
+
+    observer->id = (uint32_t)(slot + 1);
+    observer->root = root;
+    observer_track(observer, root, NULL, 0);
+    return observer;
+}
+
+OLIB_API void olib_observer_free(olib_observer_t* observer) {
+    if (!observer) {
+        return;
+    }
+    if (observer->root) {
+        observer_untrack(NULL, observer->root);
+    }
+    olib_thread_lock();
+    g_observers[observer->id - 1] = NULL;
+    olib_thread_unlock();
+
+    observer_release_changes(observer->pending, observer->pending_count);
+    olib_free(observer->pending);
+    for (size_t i = 0; i < observer->subscription_count; i++) {
+        olib_free(observer->subscriptions[i]->prefix);
+        olib_free(observer->subscriptions[i]);
+    }
+    olib_free(observer->subscriptions);
+    olib_free(observer->slots);
+    olib_free(observer);
+}
+
+OLIB_API olib_subscription_t* olib_observer_subscribe(olib_observer_t* observer, const char* prefix,
+                                                      olib_observer_fn fn, void* ctx) {
+    if (!observer || !prefix || !fn) {
+        return NULL;
+    }
+    if (observer->subscription_count == observer->subscription_capacity) {
+        size_t capacity = observer->subscription_capacity ? observer->subscription_capacity * 2 : 4;
+        olib_subscription_t** subscriptions =
+            olib_realloc(observer->subscriptions, capacity * sizeof(olib_subscription_t*));
+        if (!subscriptions) {
+            return NULL;
+        }
+        observer->subscriptions = subscriptions;
+        observer->subscription_capacity = capacity;
+    }
+    olib_subscription_t* subscription = olib_malloc(sizeof(olib_subscription_t));
+    size_t len = strlen(prefix);
+    char* prefix_copy = olib_malloc(len + 1);
+    if (!subscription || !prefix_copy) {
+        olib_free(subscription);
+        olib_free(prefix_copy);
+        return NULL;
+    }
+    memcpy(prefix_copy, prefix, len + 1);
+    subscription->prefix = prefix_copy;
+    subscription->prefix_len = len;
+    subscription->fn = fn;
+    subscription->ctx = ctx;
+    observer->subscriptions[observer->subscription_count++] = subscription;
+    return subscription;
+}
+
+OLIB_API void olib_observer_unsubscribe(olib_observer_t* observer, olib_subscription_t* subscription) {
+    if (!observer || !subscription) {
+        return;
+    }
+    for (size_t i = 0; i < observer->subscription_count; i++) {
+        if (observer->subscriptions[i] == subscription) {
+            memmove(&observer->subscriptions[i], &observer->subscriptions[i + 1],
+                    (observer->subscription_count - i - 1) * sizeof(olib_subscription_t*));
+            observer->subscription_count--;
+            olib_free(subscription->prefix);
+            olib_free(subscription);
+            return;
+        }
+    }
+}
+
+OLIB_API void olib_observer_batch_begin(olib_observer_t* observer) {
+    if (observer) {
+        observer->batch_depth++;
+    }
+}
+
+OLIB_API void olib_observer_batch_end(olib_observer_t* observer) {
+    if (!observer || observer->batch_depth == 0) {
+        return;
+    }
+    if (--observer->batch_depth == 0) {
+        observer_deliver(observer);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_observer.h>
+#include <olib/olib_txn.h>
+
+// Hooks the object mutators call for nodes with a nonzero observer id, shared between
+// the library sources. Not part of the public API.
+
+// Passed as the index to report a change to the node itself rather than to one of its children
+#define OLIB_OBSERVER_SELF SIZE_MAX
+
+typedef struct olib_observer_change_t {
+    olib_observer_t* observer;
+    olib_change_kind_t kind;
+    char* path;
+    olib_object_t* old_value;
+} olib_observer_change_t;
+
+// Start reporting a change to obj itself (key NULL, index OLIB_OBSERVER_SELF), to the
+// struct entry key, to the map entry whose decimal key is key, or to the list item at index. old_value is copied before the caller
+// mutates anything. Returns false when no subscriber matches the path, in which case
+// olib_observer_change_end must not be called.
+bool olib_observer_change_begin(olib_observer_change_t* change, olib_object_t* obj, olib_change_kind_t kind,
+                                const char* key, size_t index, olib_object_t* old_value);
+
+// Finish a change after the mutation, copying new_value and queueing or delivering it
+void olib_observer_change_end(olib_observer_change_t* change, olib_object_t* new_value);
+
+// Track a subtree that was added under an observed container at index, the position of
+// an item, struct entry or map entry
+void olib_observer_adopt(olib_object_t* container, olib_object_t* child, size_t index);
+
+// Stop tracking a subtree that was moved out of its tree without being freed
+void olib_observer_disown(olib_object_t* child);
+
+// Stop tracking a single node that is being freed, its children are freed one by one
+void olib_observer_forget(olib_object_t* obj);
+
+// Observer watching obj, NULL if none
+olib_observer_t* olib_observer_of(olib_object_t* obj);
+
+// Root of the tree an observer watches, NULL once it was freed
+olib_object_t* olib_observer_root(olib_observer_t* observer);
+
+// Transaction open on the tree, NULL if none
+olib_txn_t* olib_observer_txn(olib_observer_t* observer);
+void olib_observer_set_txn(olib_observer_t* observer, olib_txn_t* txn);
+
+// Number of changes queued so far, and dropping the changes queued after such a mark
+size_t olib_observer_pending_mark(olib_observer_t* observer);
+void olib_observer_discard_pending(olib_observer_t* observer, size_t mark);
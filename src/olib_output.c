@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "olib_output_internal.h"
+
+// #############################################################################
+// Sizing
+// #############################################################################
+
+// Capacity of the first buffer when nothing has been written yet
+#define OLIB_OUTPUT_MIN_CAPACITY 256
+
+// Capacity predicted for the next output: the running average plus a quarter of headroom,
+// so outputs that vary a little around the average still fit without regrowing
+static size_t olib_output_predict(const olib_output_buffer_t* out) {
+    size_t predicted = out->average + out->average / 4 + 1;
+    return predicted < OLIB_OUTPUT_MIN_CAPACITY ? OLIB_OUTPUT_MIN_CAPACITY : predicted;
+}
+
+// Fold a finished output into the running average, recent outputs weigh a quarter
+static void olib_output_record(olib_output_buffer_t* out, size_t size) {
+    out->average = out->average ? out->average - out->average / 4 + size / 4 : size;
+}
+
+// Storage far larger than recent outputs is dropped instead of kept, so a single outlier
+// does not pin its memory for the lifetime of the serializer
+static bool olib_output_oversized(const olib_output_buffer_t* out, size_t capacity) {
+    return capacity / 4 > olib_output_predict(out);
+}
+
+// #############################################################################
+// Writing
+// #############################################################################
+
+void olib_output_buffer_begin(olib_output_buffer_t* out) {
+    out->size = 0;
+    if (out->data || out->average == 0) {
+        return;
+    }
+    // A failed prediction is not an error, the first write grows the buffer as usual
+    size_t capacity = olib_output_predict(out);
+    out->data = olib_malloc(capacity);
+    out->capacity = out->data ? capacity : 0;
+}
+
+bool olib_output_buffer_grow(olib_output_buffer_t* out, size_t needed) {
+    if (needed > SIZE_MAX / 2 - out->size) {
+        return false;
+    }
+    size_t required = out->size + needed;
+    size_t new_capacity = out->capacity ? out->capacity * 2 : OLIB_OUTPUT_MIN_CAPACITY;
+    while (new_capacity < required) {
+        new_capacity *= 2;
+    }
+    // Large blocks are grown by the allocator, which remaps pages instead of copying where
+    // it can (glibc moves blocks above its mmap threshold with mremap)
+    uint8_t* new_data = olib_realloc(out->data, new_capacity);
+    if (!new_data) {
+        return false;
+    }
+    out->data = new_data;
+    out->capacity = new_capacity;
+    return true;
+}
+
+bool olib_output_buffer_finish(olib_output_buffer_t* out, uint8_t** out_data, size_t* out_size) {
+    if (!out_data || !out_size) {
+        return false;
+    }
+    if (!olib_output_buffer_reserve(out, 1)) {
+        return false;
+    }
+    size_t size = out->size;
+    out->data[size] = '\0';
+    olib_output_record(out, size);
+
+    if (out->mode == OLIB_OUTPUT_RETAIN) {
+        // Keep the buffer for the next write and hand out an exact-size copy
+        uint8_t* copy = olib_malloc(size + 1);
+        if (!copy) {
+            return false;
+        }
+        memcpy(copy, out->data, size + 1);
+        if (olib_output_oversized(out, out->capacity)) {
+            olib_free(out->data);
+            out->data = NULL;
+            out->capacity = 0;
+        }
+        out->size = 0;
+        *out_data = copy;
+        *out_size = size;
+        return true;
+    }
+
+    // Transfer ownership of the buffer to the caller, remembering it in case it comes back
+    out->handed = out->data;
+    out->handed_capacity = out->capacity;
+    out->data = NULL;
+    out->capacity = 0;
+    out->size = 0;
+    *out_data = out->handed;
+    *out_size = size;
+    return true;
+}
+
+void olib_output_buffer_recycle(olib_output_buffer_t* out, uint8_t* data) {
+    if (!data) {
+        return;
+    }
+    // Only the most recent output has a known capacity, anything else is just freed
+    bool reusable = data == out->handed && !out->data && !olib_output_oversized(out, out->handed_capacity);
+    out->handed = NULL;
+    if (!reusable) {
+        olib_free(data);
+        return;
+    }
+    out->data = data;
+    out->capacity = out->handed_capacity;
+    out->size = 0;
+}
+
+void olib_output_buffer_free(olib_output_buffer_t* out) {
+    if (out->data) {
+        olib_free(out->data);
+    }
+    out->data = NULL;
+    out->size = 0;
+    out->capacity = 0;
+    out->handed = NULL;
+}
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_serializer.h>
+#include <stdint.h>
+#include <string.h>
+
+// Output buffer shared by the built-in format writers. Not part of the public API.
+
+// Write buffer of one serializer. Besides the bytes being written it remembers how large
+// recent outputs were, so a fresh buffer starts at the size the next output will likely
+// need instead of regrowing from 256 bytes, and it can keep its storage between writes
+// depending on the olib_output_mode_t
+struct olib_output_buffer_t {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    olib_output_mode_t mode;
+    size_t average;          // Running average of finished output sizes
+    uint8_t* handed;         // Last buffer handed to the caller
+    size_t handed_capacity;  // Its capacity, restored when it is recycled
+
+    // Where the writer last put key text and a scalar token, see olib_output_buffer_mark_*
+    size_t key_begin;
+    size_t key_end;
+    size_t value_begin;
+    size_t value_end;
+};
+
+// Start a new output, keeping retained storage or pre-sizing from the running average
+void olib_output_buffer_begin(olib_output_buffer_t* out);
+
+// Grow the buffer so that `needed` more bytes fit
+bool olib_output_buffer_grow(olib_output_buffer_t* out, size_t needed);
+
+// Make room for `needed` more bytes
+static inline bool olib_output_buffer_reserve(olib_output_buffer_t* out, size_t needed) {
+    if (needed <= out->capacity - out->size) {
+        return true;
+    }
+    return olib_output_buffer_grow(out, needed);
+}
+
+// Append bytes, copying inline when they fit
+static inline bool olib_output_buffer_append(olib_output_buffer_t* out, const void* data, size_t size) {
+    if (!olib_output_buffer_reserve(out, size)) {
+        return false;
+    }
+    memcpy(out->data + out->size, data, size);
+    out->size += size;
+    return true;
+}
+
+// Size attribution (olib_size_report) needs to tell key text and scalar tokens apart from
+// framing. Writers mark the key text written since key_begin, and the position where a
+// scalar's token starts. An open value runs to the end of the callback unless the writer
+// closes it before a suffix such as a closing tag.
+static inline void olib_output_buffer_mark_key(olib_output_buffer_t* out, size_t key_begin) {
+    out->key_begin = key_begin;
+    out->key_end = out->size;
+}
+
+static inline void olib_output_buffer_mark_value(olib_output_buffer_t* out) {
+    out->value_begin = out->size;
+    out->value_end = SIZE_MAX;
+}
+
+static inline void olib_output_buffer_close_value(olib_output_buffer_t* out) {
+    out->value_end = out->size;
+}
+
+// Hand the finished output to the caller according to the buffer's mode. The result is
+// always allocated with olib_malloc and NUL-terminated one past `out_size`
+bool olib_output_buffer_finish(olib_output_buffer_t* out, uint8_t** out_data, size_t* out_size);
+
+// Take back a buffer returned by olib_output_buffer_finish (takes ownership of `data`)
+void olib_output_buffer_recycle(olib_output_buffer_t* out, uint8_t* data);
+
+// Release the storage
+void olib_output_buffer_free(olib_output_buffer_t* out);
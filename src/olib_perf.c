@@ -0,0 +1,493 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// perf_event_open is reached through syscall(), which strict C11 hides
+#if defined(__linux__)
+#  define _GNU_SOURCE
+#endif
+
+#include <olib/olib_perf.h>
+#include <olib/olib_helpers.h>
+#include "olib_object_internal.h"
+#include "olib_perf_internal.h"
+#include "olib_thread.h"
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  define OLIB_PERF_HAS_EVENTS 1
+#else
+#  define OLIB_PERF_HAS_EVENTS 0
+#endif
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+struct olib_perf_t {
+    int fds[OLIB_PERF_COUNTER_MAX];  // -1 when the counter is unavailable
+    double start_ns;
+    bool running;
+};
+
+static const char* g_perf_counter_names[OLIB_PERF_COUNTER_MAX] = {
+    "cycles",
+    "instructions",
+    "branch-misses",
+    "l1d-misses",
+    "llc-misses",
+    "dtlb-misses",
+};
+
+OLIB_API const char* olib_perf_counter_to_string(olib_perf_counter_t counter) {
+    if (counter < 0 || counter >= OLIB_PERF_COUNTER_MAX) {
+        return "unknown";
+    }
+    return g_perf_counter_names[counter];
+}
+
+// #############################################################################
+// Platform layer
+// #############################################################################
+
+double olib_perf_now_ns(void) {
+    struct timespec ts;
+#if defined(__linux__)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+#if OLIB_PERF_HAS_EVENTS
+
+static uint64_t olib_perf_cache_config(uint64_t cache) {
+    return cache | ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static int olib_perf_open(olib_perf_counter_t counter) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (counter) {
+        case OLIB_PERF_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case OLIB_PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case OLIB_PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case OLIB_PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = olib_perf_cache_config(PERF_COUNT_HW_CACHE_L1D);
+            break;
+        case OLIB_PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = olib_perf_cache_config(PERF_COUNT_HW_CACHE_LL);
+            break;
+        case OLIB_PERF_DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = olib_perf_cache_config(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+        default:
+            return -1;
+    }
+
+    // Calling thread, any CPU, no group: each counter fails or succeeds on its own
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return fd < 0 ? -1 : (int)fd;
+}
+
+static void olib_perf_close(int fd) {
+    close(fd);
+}
+
+static void olib_perf_start(int fd) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+// Stop a counter and read its value, scaled up if it was multiplexed
+static bool olib_perf_stop(int fd, uint64_t* out_count) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t values[3];  // value, time enabled, time running
+    if (read(fd, values, sizeof(values)) != (ssize_t)sizeof(values) || values[2] == 0) {
+        return false;
+    }
+    *out_count = values[2] < values[1] ? (uint64_t)((double)values[0] * values[1] / values[2]) : values[0];
+    return true;
+}
+
+#else
+
+static int olib_perf_open(olib_perf_counter_t counter) {
+    (void)counter;
+    return -1;
+}
+
+static void olib_perf_close(int fd) {
+    (void)fd;
+}
+
+static void olib_perf_start(int fd) {
+    (void)fd;
+}
+
+static bool olib_perf_stop(int fd, uint64_t* out_count) {
+    (void)fd;
+    (void)out_count;
+    return false;
+}
+
+#endif
+
+// #############################################################################
+// Counter management
+// #############################################################################
+
+OLIB_API olib_perf_t* olib_perf_new(void) {
+    olib_perf_t* perf = olib_calloc(1, sizeof(olib_perf_t));
+    if (!perf) {
+        return NULL;
+    }
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        perf->fds[i] = olib_perf_open((olib_perf_counter_t)i);
+    }
+    return perf;
+}
+
+OLIB_API void olib_perf_free(olib_perf_t* perf) {
+    if (!perf) {
+        return;
+    }
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        if (perf->fds[i] >= 0) {
+            olib_perf_close(perf->fds[i]);
+        }
+    }
+    olib_free(perf);
+}
+
+OLIB_API bool olib_perf_is_available(olib_perf_t* perf, olib_perf_counter_t counter) {
+    if (!perf || counter < 0 || counter >= OLIB_PERF_COUNTER_MAX) {
+        return false;
+    }
+    return perf->fds[counter] >= 0;
+}
+
+OLIB_API bool olib_perf_begin(olib_perf_t* perf) {
+    if (!perf || perf->running) {
+        return false;
+    }
+    perf->running = true;
+    perf->start_ns = olib_perf_now_ns();
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        if (perf->fds[i] >= 0) {
+            olib_perf_start(perf->fds[i]);
+        }
+    }
+    return true;
+}
+
+OLIB_API bool olib_perf_end(olib_perf_t* perf, olib_perf_result_t* out_result) {
+    if (!perf || !perf->running || !out_result) {
+        return false;
+    }
+
+    memset(out_result, 0, sizeof(*out_result));
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        if (perf->fds[i] >= 0) {
+            out_result->available[i] = olib_perf_stop(perf->fds[i], &out_result->counts[i]);
+        }
+    }
+    out_result->wall_ns = olib_perf_now_ns() - perf->start_ns;
+    perf->running = false;
+    return true;
+}
+
+OLIB_API void olib_perf_normalize(olib_perf_result_t* result, size_t bytes, size_t nodes) {
+    if (!result) {
+        return;
+    }
+    result->bytes = bytes;
+    result->nodes = nodes;
+    for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+        double count = result->available[i] ? (double)result->counts[i] : 0.0;
+        result->per_byte[i] = bytes ? count / (double)bytes : 0.0;
+        result->per_node[i] = nodes ? count / (double)nodes : 0.0;
+    }
+}
+
+// #############################################################################
+// Phase helpers
+// #############################################################################
+
+size_t olib_perf_count_nodes(olib_object_t* obj) {
+    size_t count = 1;
+    if (obj->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < obj->data.list.size; i++) {
+            count += olib_perf_count_nodes(obj->data.list.items[i]);
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < obj->data.object.size; i++) {
+            count += olib_perf_count_nodes(obj->data.object.entries[i].value);
+        }
+    } else if (obj->type == OLIB_OBJECT_TYPE_MAP) {
+        for (size_t i = 0; i < obj->data.map.size; i++) {
+            count += olib_perf_count_nodes(obj->data.map.entries[i].value);
+        }
+    }
+    return count;
+}
+
+OLIB_API olib_object_t* olib_perf_read(
+    olib_perf_t* perf, olib_format_t format, const uint8_t* data, size_t size, olib_perf_result_t* out_result)
+{
+    if (!perf || !data || size == 0 || !out_result) {
+        return NULL;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return NULL;
+    }
+
+    // Text readers need a terminator, copy outside of the measured section
+    char* text = NULL;
+    bool is_text = olib_serializer_is_text_based(serializer);
+    if (is_text) {
+        text = olib_malloc(size + 1);
+        if (!text) {
+            olib_serializer_free(serializer);
+            return NULL;
+        }
+        memcpy(text, data, size);
+        text[size] = '\0';
+    }
+
+    olib_perf_begin(perf);
+    olib_object_t* obj = is_text ? olib_serializer_read_string(serializer, text)
+                                 : olib_serializer_read(serializer, data, size);
+    olib_perf_end(perf, out_result);
+
+    olib_free(text);
+    olib_serializer_free(serializer);
+    if (obj) {
+        olib_perf_normalize(out_result, size, olib_perf_count_nodes(obj));
+    }
+    return obj;
+}
+
+OLIB_API bool olib_perf_write(
+    olib_perf_t* perf, olib_format_t format, olib_object_t* obj,
+    uint8_t** out_data, size_t* out_size, olib_perf_result_t* out_result)
+{
+    if (!perf || !obj || !out_data || !out_size || !out_result) {
+        return false;
+    }
+
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+
+    bool is_text = olib_serializer_is_text_based(serializer);
+    char* text = NULL;
+
+    olib_perf_begin(perf);
+    bool ok = is_text ? olib_serializer_write_string(serializer, obj, &text)
+                      : olib_serializer_write(serializer, obj, out_data, out_size);
+    olib_perf_end(perf, out_result);
+    olib_serializer_free(serializer);
+
+    if (!ok) {
+        return false;
+    }
+    if (is_text) {
+        *out_data = (uint8_t*)text;
+        *out_size = strlen(text);
+    }
+    olib_perf_normalize(out_result, *out_size, olib_perf_count_nodes(obj));
+    return true;
+}
+
+// #############################################################################
+// Slow operation hook
+// #############################################################################
+
+// Guarded by olib_thread_lock
+static olib_slow_op_config_t g_slow_op_config;
+static double g_slow_op_last_ns;
+static bool g_slow_op_reported;
+static uint64_t g_slow_op_dropped;
+
+// Set while a hook is installed, read without the lock
+static bool g_slow_op_installed;
+
+// Timed helper calls on this thread, only the outermost one is reported
+static OLIB_THREAD_LOCAL int g_slow_op_depth;
+
+OLIB_API void olib_set_slow_op_hook(const olib_slow_op_config_t* config) {
+    olib_thread_lock();
+    if (config && config->callback) {
+        g_slow_op_config = *config;
+    } else {
+        memset(&g_slow_op_config, 0, sizeof(g_slow_op_config));
+    }
+    g_slow_op_reported = false;
+    g_slow_op_dropped = 0;
+    olib_thread_flag_set(&g_slow_op_installed, g_slow_op_config.callback != NULL);
+    olib_thread_unlock();
+}
+
+OLIB_API uint64_t olib_slow_op_dropped(void) {
+    olib_thread_lock();
+    uint64_t dropped = g_slow_op_dropped;
+    olib_thread_unlock();
+    return dropped;
+}
+
+bool olib_slow_op_would_time(void) {
+    if (g_slow_op_depth > 0 || !olib_thread_flag_get(&g_slow_op_installed)) {
+        return false;
+    }
+    olib_thread_lock();
+    bool installed = g_slow_op_config.callback != NULL;
+    olib_thread_unlock();
+    return installed;
+}
+
+void olib_slow_op_begin(olib_slow_op_scope_t* scope) {
+    olib_trace_begin(&scope->trace);
+    scope->active = olib_slow_op_would_time();
+    scope->start_ns = 0.0;
+    if (scope->active) {
+        g_slow_op_depth++;
+        scope->start_ns = olib_perf_now_ns();
+    }
+}
+
+bool olib_slow_op_uses_input(const olib_slow_op_scope_t* scope) {
+    return scope->active || scope->trace.active;
+}
+
+static uint64_t olib_slow_op_fingerprint(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Decide whether to report under the lock, so concurrent calls share one rate limit
+static bool olib_slow_op_should_report(olib_slow_op_info_t* info, olib_object_t* tree, olib_slow_op_config_t* out_config) {
+    olib_thread_lock();
+    olib_slow_op_config_t config = g_slow_op_config;
+    olib_thread_unlock();
+    if (!config.callback) {
+        return false;
+    }
+
+    bool slow = config.threshold_ns > 0.0 && info->total_ns >= config.threshold_ns;
+    if (tree && info->nodes == 0 && (slow || config.node_threshold > 0)) {
+        info->nodes = olib_perf_count_nodes(tree);
+    }
+    slow = slow || (config.node_threshold > 0 && info->nodes >= config.node_threshold);
+    if (!slow) {
+        return false;
+    }
+
+    double now = olib_perf_now_ns();
+    olib_thread_lock();
+    bool allowed = !g_slow_op_reported || now - g_slow_op_last_ns >= config.min_interval_ns;
+    if (allowed) {
+        g_slow_op_reported = true;
+        g_slow_op_last_ns = now;
+    } else {
+        g_slow_op_dropped++;
+    }
+    olib_thread_unlock();
+
+    *out_config = config;
+    return allowed;
+}
+
+static void olib_slow_op_report(olib_slow_op_scope_t* scope, olib_slow_op_info_t* info,
+                                const uint8_t* data, size_t size, olib_object_t* tree) {
+    info->total_ns = olib_perf_now_ns() - scope->start_ns;
+    if (info->kind == OLIB_SLOW_OP_READ) {
+        info->read_ns = info->total_ns;
+    } else if (info->kind == OLIB_SLOW_OP_WRITE) {
+        info->write_ns = info->total_ns;
+    }
+
+    // The hook stays nested while it runs, helpers it calls are not reported
+    olib_slow_op_config_t config;
+    if (olib_slow_op_should_report(info, tree, &config)) {
+        if (!data) {
+            size = 0;
+        }
+        info->fingerprint = olib_slow_op_fingerprint(data, size);
+        info->prefix = size > 0 && config.max_prefix > 0 ? data : NULL;
+        info->prefix_size = info->prefix ? (size < config.max_prefix ? size : config.max_prefix) : 0;
+        config.callback(info, config.user_data);
+    }
+    g_slow_op_depth--;
+}
+
+void olib_slow_op_end(olib_slow_op_scope_t* scope, olib_slow_op_info_t* info,
+                      const uint8_t* data, size_t size, olib_object_t* tree) {
+    if (scope->active) {
+        olib_slow_op_report(scope, info, data, size, tree);
+    }
+
+    // Captured after the timing, so recording does not count towards the call
+    switch (info->kind) {
+        case OLIB_SLOW_OP_READ:
+            olib_trace_end(&scope->trace, OLIB_TRACE_READ, info->src_format, info->dst_format, data, size, NULL);
+            break;
+        case OLIB_SLOW_OP_WRITE:
+            olib_trace_end(&scope->trace, OLIB_TRACE_WRITE, info->src_format, info->dst_format, NULL, 0, tree);
+            break;
+        default:
+            olib_trace_end(&scope->trace, OLIB_TRACE_CONVERT, info->src_format, info->dst_format, data, size, NULL);
+            break;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_perf.h>
+#include "olib_trace_internal.h"
+
+// Timing and slow operation hook plumbing shared between the library sources. Not part of the public API.
+
+typedef struct olib_slow_op_scope_t {
+    double start_ns;
+    bool active;               // Hook installed and not nested in another timed call
+    olib_trace_scope_t trace;  // Capture of the same call
+} olib_slow_op_scope_t;
+
+// Monotonic clock where the platform has one
+double olib_perf_now_ns(void);
+
+// Objects in a tree, including obj itself
+size_t olib_perf_count_nodes(olib_object_t* obj);
+
+// Whether olib_slow_op_begin would start an active scope on this thread
+bool olib_slow_op_would_time(void);
+
+// Start timing and capturing a helper call. Every begin must be paired with olib_slow_op_end.
+void olib_slow_op_begin(olib_slow_op_scope_t* scope);
+
+// Whether olib_slow_op_end will look at the input, so its size is worth computing
+bool olib_slow_op_uses_input(const olib_slow_op_scope_t* scope);
+
+// Finish a helper call and pass it to the hook when it crossed a threshold. total_ns is
+// filled in, and read_ns or write_ns for plain reads and writes. nodes is counted from
+// tree unless already set. data is what the fingerprint and prefix cover. The call is
+// also recorded when a trace capture is running.
+void olib_slow_op_end(olib_slow_op_scope_t* scope, olib_slow_op_info_t* info,
+                      const uint8_t* data, size_t size, olib_object_t* tree);
@@ -0,0 +1,592 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_schema.h>
+#include "olib_object_internal.h"
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// Most elements a decoded list may have when its elements take no bytes
+#define SCHEMA_MAX_EMPTY_ITEMS ((size_t)1 << 20)
+
+typedef struct olib_schema_field_t {
+    char* key;
+    size_t key_len;
+    olib_schema_t* schema;
+    bool optional;
+    size_t bit;  // Presence bit, optional fields only
+} olib_schema_field_t;
+
+struct olib_schema_t {
+    olib_object_type_t type;
+    olib_schema_t* element;  // LIST only, NULL until set
+    olib_schema_field_t* fields;
+    size_t field_count;
+    size_t field_capacity;
+    size_t optional_count;
+    size_t min_size;  // Smallest possible encoding, bounds list counts when decoding
+};
+
+// #############################################################################
+// Building
+// #############################################################################
+
+static size_t schema_scalar_min_size(olib_object_type_t type) {
+    switch (type) {
+        case OLIB_OBJECT_TYPE_FLOAT: return 8;
+        case OLIB_OBJECT_TYPE_STRUCT: return 0;
+        default: return 1;
+    }
+}
+
+// Recompute presence bits and the minimum size after fields changed
+static void schema_struct_update(olib_schema_t* schema) {
+    size_t bit = 0;
+    size_t min_size = 0;
+    for (size_t i = 0; i < schema->field_count; i++) {
+        olib_schema_field_t* field = &schema->fields[i];
+        if (field->optional) {
+            field->bit = bit++;
+        } else {
+            min_size += field->schema->min_size;
+        }
+    }
+    schema->optional_count = bit;
+    schema->min_size = min_size + (bit + 7) / 8;
+}
+
+static olib_schema_field_t* schema_struct_find(olib_schema_t* schema, const char* key) {
+    for (size_t i = 0; i < schema->field_count; i++) {
+        if (strcmp(schema->fields[i].key, key) == 0) {
+            return &schema->fields[i];
+        }
+    }
+    return NULL;
+}
+
+OLIB_API olib_schema_t* olib_schema_new(olib_object_type_t type) {
+    // Maps have no schema-bound encoding, their keys are data rather than layout
+    if (type < 0 || type >= OLIB_OBJECT_TYPE_MAX || type == OLIB_OBJECT_TYPE_MAP) {
+        return NULL;
+    }
+    olib_schema_t* schema = olib_malloc(sizeof(olib_schema_t));
+    if (!schema) {
+        return NULL;
+    }
+    memset(schema, 0, sizeof(olib_schema_t));
+    schema->type = type;
+    schema->min_size = schema_scalar_min_size(type);
+    return schema;
+}
+
+OLIB_API void olib_schema_free(olib_schema_t* schema) {
+    if (!schema) {
+        return;
+    }
+    olib_schema_free(schema->element);
+    for (size_t i = 0; i < schema->field_count; i++) {
+        olib_free(schema->fields[i].key);
+        olib_schema_free(schema->fields[i].schema);
+    }
+    olib_free(schema->fields);
+    olib_free(schema);
+}
+
+OLIB_API bool olib_schema_struct_add(olib_schema_t* schema, const char* key, olib_schema_t* field, bool optional) {
+    if (!schema || schema->type != OLIB_OBJECT_TYPE_STRUCT || !key || !field || field == schema) {
+        return false;
+    }
+    if (schema_struct_find(schema, key)) {
+        return false;
+    }
+    if (schema->field_count == schema->field_capacity) {
+        size_t new_capacity = schema->field_capacity ? schema->field_capacity * 2 : 4;
+        olib_schema_field_t* new_fields = olib_realloc(schema->fields, new_capacity * sizeof(olib_schema_field_t));
+        if (!new_fields) {
+            return false;
+        }
+        schema->fields = new_fields;
+        schema->field_capacity = new_capacity;
+    }
+    size_t key_len = strlen(key);
+    char* key_copy = olib_malloc(key_len + 1);
+    if (!key_copy) {
+        return false;
+    }
+    memcpy(key_copy, key, key_len + 1);
+
+    olib_schema_field_t* entry = &schema->fields[schema->field_count++];
+    entry->key = key_copy;
+    entry->key_len = key_len;
+    entry->schema = field;
+    entry->optional = optional;
+    entry->bit = 0;
+    schema_struct_update(schema);
+    return true;
+}
+
+OLIB_API bool olib_schema_list_set_element(olib_schema_t* schema, olib_schema_t* element) {
+    if (!schema || schema->type != OLIB_OBJECT_TYPE_LIST || !element || element == schema) {
+        return false;
+    }
+    if (schema->element != element) {
+        olib_schema_free(schema->element);
+        schema->element = element;
+    }
+    return true;
+}
+
+// Merge src into dst so dst accepts everything either one accepts
+static bool schema_merge(olib_schema_t* dst, olib_schema_t* src) {
+    if (dst->type != src->type) {
+        return false;
+    }
+    if (dst->type == OLIB_OBJECT_TYPE_LIST) {
+        if (!src->element) {
+            return true;
+        }
+        if (!dst->element) {
+            dst->element = src->element;
+            src->element = NULL;
+            return true;
+        }
+        return schema_merge(dst->element, src->element);
+    }
+    if (dst->type != OLIB_OBJECT_TYPE_STRUCT) {
+        return true;
+    }
+
+    for (size_t i = 0; i < dst->field_count; i++) {
+        olib_schema_field_t* field = &dst->fields[i];
+        olib_schema_field_t* other = schema_struct_find(src, field->key);
+        if (!other) {
+            field->optional = true;
+        } else if (!schema_merge(field->schema, other->schema)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < src->field_count; i++) {
+        olib_schema_field_t* other = &src->fields[i];
+        if (schema_struct_find(dst, other->key)) {
+            continue;
+        }
+        if (!olib_schema_struct_add(dst, other->key, other->schema, true)) {
+            return false;
+        }
+        other->schema = NULL;  // Now owned by dst
+    }
+    schema_struct_update(dst);
+    return true;
+}
+
+OLIB_API olib_schema_t* olib_schema_from_object(olib_object_t* example) {
+    if (!example) {
+        return NULL;
+    }
+    olib_schema_t* schema = olib_schema_new(example->type);
+    if (!schema) {
+        return NULL;
+    }
+
+    if (example->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < example->data.list.size; i++) {
+            olib_schema_t* item = olib_schema_from_object(example->data.list.items[i]);
+            bool ok = item != NULL;
+            if (ok && !schema->element) {
+                schema->element = item;
+                item = NULL;
+            } else if (ok) {
+                ok = schema_merge(schema->element, item);
+            }
+            olib_schema_free(item);
+            if (!ok) {
+                olib_schema_free(schema);
+                return NULL;
+            }
+        }
+    } else if (example->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < example->data.object.size; i++) {
+            olib_struct_entry_t* entry = &example->data.object.entries[i];
+            olib_schema_t* field = olib_schema_from_object(entry->value);
+            if (!field || !olib_schema_struct_add(schema, entry->key, field, false)) {
+                olib_schema_free(field);
+                olib_schema_free(schema);
+                return NULL;
+            }
+        }
+    }
+    return schema;
+}
+
+// #############################################################################
+// Inspection
+// #############################################################################
+
+OLIB_API olib_object_type_t olib_schema_get_type(olib_schema_t* schema) {
+    return schema ? schema->type : OLIB_OBJECT_TYPE_MAX;
+}
+
+OLIB_API size_t olib_schema_struct_size(olib_schema_t* schema) {
+    return schema ? schema->field_count : 0;
+}
+
+OLIB_API const char* olib_schema_struct_key_at(olib_schema_t* schema, size_t index) {
+    if (!schema || index >= schema->field_count) {
+        return NULL;
+    }
+    return schema->fields[index].key;
+}
+
+OLIB_API olib_schema_t* olib_schema_struct_field_at(olib_schema_t* schema, size_t index) {
+    if (!schema || index >= schema->field_count) {
+        return NULL;
+    }
+    return schema->fields[index].schema;
+}
+
+OLIB_API bool olib_schema_struct_optional_at(olib_schema_t* schema, size_t index) {
+    if (!schema || index >= schema->field_count) {
+        return false;
+    }
+    return schema->fields[index].optional;
+}
+
+OLIB_API olib_schema_t* olib_schema_list_element(olib_schema_t* schema) {
+    return schema ? schema->element : NULL;
+}
+
+// #############################################################################
+// Encoding
+// #############################################################################
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} schema_writer_t;
+
+static bool schema_reserve(schema_writer_t* w, size_t extra) {
+    if (extra <= w->capacity - w->size) {
+        return true;
+    }
+    if (extra > SIZE_MAX / 2 - w->size) {
+        return false;
+    }
+    size_t new_capacity = w->capacity ? w->capacity * 2 : 64;
+    while (new_capacity < w->size + extra) {
+        new_capacity *= 2;
+    }
+    uint8_t* new_data = olib_realloc(w->data, new_capacity);
+    if (!new_data) {
+        return false;
+    }
+    w->data = new_data;
+    w->capacity = new_capacity;
+    return true;
+}
+
+static bool schema_write_varint(schema_writer_t* w, uint64_t value) {
+    if (!schema_reserve(w, 10)) {
+        return false;
+    }
+    while (value >= 0x80) {
+        w->data[w->size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    w->data[w->size++] = (uint8_t)value;
+    return true;
+}
+
+static bool schema_encode_value(schema_writer_t* w, olib_schema_t* schema, olib_object_t* obj);
+
+static bool schema_encode_struct(schema_writer_t* w, olib_schema_t* schema, olib_object_t* obj) {
+    size_t bitmap_size = (schema->optional_count + 7) / 8;
+    if (!schema_reserve(w, bitmap_size)) {
+        return false;
+    }
+    size_t bitmap = w->size;
+    if (bitmap_size > 0) {
+        memset(w->data + bitmap, 0, bitmap_size);
+        w->size += bitmap_size;
+    }
+
+    // Objects usually keep their keys in schema order, check the next entry first
+    size_t cursor = 0;
+    size_t found = 0;
+    for (size_t i = 0; i < schema->field_count; i++) {
+        olib_schema_field_t* field = &schema->fields[i];
+        olib_object_t* value = NULL;
+        if (cursor < obj->data.object.size && strcmp(obj->data.object.entries[cursor].key, field->key) == 0) {
+            value = obj->data.object.entries[cursor++].value;
+        } else {
+            value = olib_object_struct_get(obj, field->key);
+        }
+
+        if (!value) {
+            if (!field->optional) {
+                return false;
+            }
+            continue;
+        }
+        if (field->optional) {
+            w->data[bitmap + field->bit / 8] |= (uint8_t)(1u << (field->bit % 8));
+        }
+        if (!schema_encode_value(w, field->schema, value)) {
+            return false;
+        }
+        found++;
+    }
+    // Keys the schema does not know would be lost
+    return found == obj->data.object.size;
+}
+
+static bool schema_encode_value(schema_writer_t* w, olib_schema_t* schema, olib_object_t* obj) {
+    if (!obj || obj->type != schema->type) {
+        return false;
+    }
+    switch (schema->type) {
+        case OLIB_OBJECT_TYPE_INT: {
+            uint64_t value = (uint64_t)obj->data.int_val;
+            return schema_write_varint(w, (value << 1) ^ (0 - (value >> 63)));
+        }
+        case OLIB_OBJECT_TYPE_UINT:
+            return schema_write_varint(w, obj->data.uint_val);
+        case OLIB_OBJECT_TYPE_FLOAT: {
+            uint64_t bits;
+            memcpy(&bits, &obj->data.float_val, sizeof(bits));
+            if (!schema_reserve(w, 8)) {
+                return false;
+            }
+            for (int i = 0; i < 8; i++) {
+                w->data[w->size++] = (uint8_t)(bits >> (8 * i));
+            }
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_BOOL:
+            if (!schema_reserve(w, 1)) {
+                return false;
+            }
+            w->data[w->size++] = obj->data.bool_val ? 1 : 0;
+            return true;
+        case OLIB_OBJECT_TYPE_STRING: {
+            const char* str = obj->data.string.data ? obj->data.string.data : "";
+            size_t len = strlen(str);
+            if (!schema_write_varint(w, len) || !schema_reserve(w, len)) {
+                return false;
+            }
+            memcpy(w->data + w->size, str, len);
+            w->size += len;
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_LIST: {
+            size_t count = obj->data.list.size;
+            if (count > 0 && !schema->element) {
+                return false;
+            }
+            if (!schema_write_varint(w, count)) {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (!schema_encode_value(w, schema->element, obj->data.list.items[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_STRUCT:
+            return schema_encode_struct(w, schema, obj);
+        default:
+            return false;
+    }
+}
+
+OLIB_API bool olib_schema_encode(olib_schema_t* schema, olib_object_t* obj, uint8_t** out_data, size_t* out_size) {
+    if (!schema || !obj || !out_data || !out_size) {
+        return false;
+    }
+    schema_writer_t w = {0};
+    if (!schema_encode_value(&w, schema, obj)) {
+        olib_free(w.data);
+        return false;
+    }
+    // Keep the result non-NULL for values that encode to nothing
+    if (!w.data && !schema_reserve(&w, 1)) {
+        return false;
+    }
+    *out_data = w.data;
+    *out_size = w.size;
+    return true;
+}
+
+// #############################################################################
+// Decoding
+// #############################################################################
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+} schema_reader_t;
+
+static bool schema_read_varint(schema_reader_t* r, uint64_t* out_value) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->size) {
+            return false;
+        }
+        uint8_t byte = r->data[r->pos++];
+        // The tenth byte only has room for the top bit
+        if (shift == 63 && byte > 1) {
+            return false;
+        }
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *out_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decode into obj, which already has the schema's type
+static bool schema_decode_value(schema_reader_t* r, olib_schema_t* schema, olib_object_t* obj) {
+    switch (schema->type) {
+        case OLIB_OBJECT_TYPE_INT: {
+            uint64_t value;
+            if (!schema_read_varint(r, &value)) {
+                return false;
+            }
+            obj->data.int_val = (int64_t)((value >> 1) ^ (0 - (value & 1)));
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_UINT:
+            return schema_read_varint(r, &obj->data.uint_val);
+        case OLIB_OBJECT_TYPE_FLOAT: {
+            if (r->size - r->pos < 8) {
+                return false;
+            }
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; i++) {
+                bits |= (uint64_t)r->data[r->pos + i] << (8 * i);
+            }
+            r->pos += 8;
+            memcpy(&obj->data.float_val, &bits, sizeof(bits));
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_BOOL:
+            if (r->pos >= r->size) {
+                return false;
+            }
+            obj->data.bool_val = r->data[r->pos++] != 0;
+            return true;
+        case OLIB_OBJECT_TYPE_STRING: {
+            uint64_t len;
+            if (!schema_read_varint(r, &len) || len > r->size - r->pos) {
+                return false;
+            }
+            if (!olib_object_set_string_len(obj, (const char*)r->data + r->pos, (size_t)len)) {
+                return false;
+            }
+            r->pos += (size_t)len;
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_LIST: {
+            uint64_t count;
+            if (!schema_read_varint(r, &count)) {
+                return false;
+            }
+            if (count == 0) {
+                return true;
+            }
+            // Every element takes at least min_size bytes, so a count cannot force a huge
+            // allocation. Elements that encode to nothing, such as empty structs, are capped.
+            size_t min_size = schema->element ? schema->element->min_size : 0;
+            size_t limit = min_size ? (r->size - r->pos) / min_size : SCHEMA_MAX_EMPTY_ITEMS;
+            if (!schema->element || count > limit) {
+                return false;
+            }
+            if (!olib_object_list_reserve(obj, (size_t)count)) {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++) {
+                olib_object_t* item = olib_object_new(schema->element->type);
+                if (!item) {
+                    return false;
+                }
+                obj->data.list.items[obj->data.list.size++] = item;
+                if (!schema_decode_value(r, schema->element, item)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case OLIB_OBJECT_TYPE_STRUCT: {
+            size_t bitmap_size = (schema->optional_count + 7) / 8;
+            if (r->size - r->pos < bitmap_size) {
+                return false;
+            }
+            const uint8_t* bitmap = r->data + r->pos;
+            r->pos += bitmap_size;
+            if (!olib_object_struct_reserve(obj, schema->field_count)) {
+                return false;
+            }
+            for (size_t i = 0; i < schema->field_count; i++) {
+                olib_schema_field_t* field = &schema->fields[i];
+                if (field->optional && !(bitmap[field->bit / 8] & (1u << (field->bit % 8)))) {
+                    continue;
+                }
+                olib_struct_entry_t* entry = olib_object_struct_insert_entry(obj, obj->data.object.size, field->key);
+                if (!entry) {
+                    return false;
+                }
+                entry->value = olib_object_new(field->schema->type);
+                if (!entry->value || !schema_decode_value(r, field->schema, entry->value)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+OLIB_API olib_object_t* olib_schema_decode(olib_schema_t* schema, const uint8_t* data, size_t size) {
+    if (!schema || (!data && size > 0)) {
+        return NULL;
+    }
+    olib_object_t* obj = olib_object_new(schema->type);
+    if (!obj) {
+        return NULL;
+    }
+    schema_reader_t r = {data, size, 0};
+    if (!schema_decode_value(&r, schema, obj)) {
+        olib_object_free(obj);
+        return NULL;
+    }
+    return obj;
+}
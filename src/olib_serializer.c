@@ -23,6 +23,11 @@ SOFTWARE.
 */
 
 #include <olib/olib_serializer.h>
+#include "olib_object_internal.h"
+#include "olib_output_internal.h"
+#include "olib_serializer_internal.h"
+#include "olib_stream_internal.h"
+#include "olib_trace_internal.h"
 #include <string.h>
 
 // #############################################################################
@@ -31,8 +36,20 @@ SOFTWARE.
 
 struct olib_serializer_t {
     olib_serializer_config_t config;
+
+    // Streaming strings, see olib_serializer_set_string_sink / _source
+    olib_string_sink_fn sink;
+    void* sink_ctx;
+    size_t sink_chunk_size;
+    olib_string_source_fn source;
+    void* source_ctx;
+
+    olib_format_t format;  // Built-in format, OLIB_FORMAT_MAX for custom serializers
 };
 
+// Smallest sink piece, leaves room for any multi-byte sequence a format decodes at once
+#define OLIB_STRING_CHUNK_MIN 16
+
 // #############################################################################
 // Serializer management
 // #############################################################################
@@ -48,6 +65,7 @@ OLIB_API olib_serializer_t* olib_serializer_new(olib_serializer_config_t* config
     }
 
     serializer->config = *config;
+    serializer->format = OLIB_FORMAT_MAX;
 
     if (serializer->config.init_ctx) {
         serializer->config.init_ctx(serializer->config.user_data);
@@ -74,10 +92,146 @@ OLIB_API bool olib_serializer_is_text_based(olib_serializer_t* serializer) {
     return serializer->config.text_based;
 }
 
+void olib_serializer_set_format(olib_serializer_t* serializer, olib_format_t format) {
+    serializer->format = format;
+}
+
+olib_format_t olib_serializer_get_format(olib_serializer_t* serializer) {
+    return serializer->format;
+}
+
+// #############################################################################
+// Output buffer
+// #############################################################################
+
+olib_serializer_config_t* olib_serializer_get_config(olib_serializer_t* serializer) {
+    return &serializer->config;
+}
+
+olib_output_buffer_t* olib_serializer_get_output(olib_serializer_t* serializer) {
+    if (!serializer->config.output_buffer) {
+        return NULL;
+    }
+    return serializer->config.output_buffer(serializer->config.user_data);
+}
+
+bool olib_serializer_finish_borrowed(olib_serializer_t* serializer, uint8_t** out_data, size_t* out_size) {
+    olib_output_buffer_t* out = olib_serializer_get_output(serializer);
+    if (!out) {
+        return serializer->config.finish_write(serializer->config.user_data, out_data, out_size);
+    }
+    olib_output_mode_t mode = out->mode;
+    out->mode = OLIB_OUTPUT_HANDOFF;
+    bool result = serializer->config.finish_write(serializer->config.user_data, out_data, out_size);
+    out->mode = mode;
+    return result;
+}
+
+void olib_serializer_release_output(olib_serializer_t* serializer, uint8_t* data) {
+    olib_output_buffer_t* out = olib_serializer_get_output(serializer);
+    if (out) {
+        olib_output_buffer_recycle(out, data);
+    } else {
+        olib_free(data);
+    }
+}
+
+OLIB_API bool olib_serializer_set_output_mode(olib_serializer_t* serializer, olib_output_mode_t mode) {
+    if (!serializer || (mode != OLIB_OUTPUT_HANDOFF && mode != OLIB_OUTPUT_RETAIN)) {
+        return false;
+    }
+    olib_output_buffer_t* out = olib_serializer_get_output(serializer);
+    if (!out) {
+        return false;
+    }
+    out->mode = mode;
+    return true;
+}
+
+OLIB_API void olib_serializer_recycle_output(olib_serializer_t* serializer, void* data) {
+    if (!data) {
+        return;
+    }
+    if (!serializer) {
+        olib_free(data);
+        return;
+    }
+    olib_serializer_release_output(serializer, (uint8_t*)data);
+}
+
+OLIB_API bool olib_serializer_set_string_sink(olib_serializer_t* serializer, size_t chunk_size, olib_string_sink_fn fn,
+                                              void* ctx) {
+    if (!serializer || (fn && chunk_size < OLIB_STRING_CHUNK_MIN)) {
+        return false;
+    }
+    serializer->sink = fn;
+    serializer->sink_ctx = ctx;
+    serializer->sink_chunk_size = chunk_size;
+    return true;
+}
+
+OLIB_API bool olib_serializer_set_string_source(olib_serializer_t* serializer, olib_string_source_fn fn, void* ctx) {
+    if (!serializer) {
+        return false;
+    }
+    serializer->source = fn;
+    serializer->source_ctx = ctx;
+    return true;
+}
+
 // #############################################################################
 // Internal write helpers
 // #############################################################################
 
+// Write an empty string node with the value supplied by the string source
+static bool olib_serializer_write_streamed(olib_serializer_t* serializer, olib_object_t* obj) {
+    olib_serializer_config_t* cfg = &serializer->config;
+    void* ctx = cfg->user_data;
+    const char* chunk;
+    size_t size;
+    bool last;
+
+    if (cfg->write_string_chunk) {
+        bool first = true;
+        do {
+            if (!serializer->source(serializer->source_ctx, obj, &chunk, &size, &last)) return false;
+            if (!cfg->write_string_chunk(ctx, chunk, size, first, last)) return false;
+            first = false;
+        } while (!last);
+        return true;
+    }
+
+    // Serializers without write_string_chunk get the pieces joined
+    if (!cfg->write_string) return false;
+    char* joined = NULL;
+    size_t length = 0;
+    size_t capacity = 0;
+    bool ok = true;
+    do {
+        ok = serializer->source(serializer->source_ctx, obj, &chunk, &size, &last);
+        if (ok && length + size + 1 > capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 256;
+            while (new_capacity < length + size + 1) new_capacity *= 2;
+            char* grown = olib_realloc(joined, new_capacity);
+            ok = grown != NULL;
+            if (ok) {
+                joined = grown;
+                capacity = new_capacity;
+            }
+        }
+        if (ok && size > 0) {
+            memcpy(joined + length, chunk, size);
+            length += size;
+        }
+    } while (ok && !last);
+    if (ok) {
+        if (joined) joined[length] = '\0';
+        ok = cfg->write_string(ctx, joined ? joined : "");
+    }
+    if (joined) olib_free(joined);
+    return ok;
+}
+
 static bool olib_serializer_write_object(olib_serializer_t* serializer, olib_object_t* obj) {
     if (!serializer || !obj) {
         return false;
@@ -99,9 +253,14 @@ static bool olib_serializer_write_object(olib_serializer_t* serializer, olib_obj
             if (!cfg->write_float) return false;
             return cfg->write_float(ctx, olib_object_get_float(obj));
 
-        case OLIB_OBJECT_TYPE_STRING:
+        case OLIB_OBJECT_TYPE_STRING: {
+            const char* value = olib_object_get_string(obj);
+            if (serializer->source && (!value || !*value)) {
+                return olib_serializer_write_streamed(serializer, obj);
+            }
             if (!cfg->write_string) return false;
-            return cfg->write_string(ctx, olib_object_get_string(obj));
+            return cfg->write_string(ctx, value);
+        }
 
         case OLIB_OBJECT_TYPE_BOOL:
             if (!cfg->write_bool) return false;
@@ -130,6 +289,27 @@ static bool olib_serializer_write_object(olib_serializer_t* serializer, olib_obj
             }
             return cfg->write_struct_end(ctx);
         }
+
+        case OLIB_OBJECT_TYPE_MAP: {
+            size_t size = olib_object_map_size(obj);
+            if (cfg->write_map_begin && cfg->write_map_key && cfg->write_map_end) {
+                if (!cfg->write_map_begin(ctx, size)) return false;
+                for (size_t i = 0; i < size; i++) {
+                    if (!cfg->write_map_key(ctx, olib_object_map_key_at(obj, i))) return false;
+                    if (!olib_serializer_write_object(serializer, olib_object_map_value_at(obj, i))) return false;
+                }
+                return cfg->write_map_end(ctx);
+            }
+            // Formats without native maps get a struct keyed by the decimal keys
+            if (!cfg->write_struct_begin || !cfg->write_struct_key || !cfg->write_struct_end) return false;
+            if (!cfg->write_struct_begin(ctx)) return false;
+            char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+            for (size_t i = 0; i < size; i++) {
+                if (!cfg->write_struct_key(ctx, olib_object_map_key_text(olib_object_map_key_at(obj, i), key_text))) return false;
+                if (!olib_serializer_write_object(serializer, olib_object_map_value_at(obj, i))) return false;
+            }
+            return cfg->write_struct_end(ctx);
+        }
         default:
             return false;
     }
@@ -139,6 +319,98 @@ static bool olib_serializer_write_object(olib_serializer_t* serializer, olib_obj
 // Internal read helpers
 // #############################################################################
 
+// Reads the next value: scalars are decoded, containers are only classified.
+// Prefers the fused read_value callback and falls back to read_peek + read_*.
+static bool olib_serializer_read_value(olib_serializer_t* serializer, olib_value_t* out) {
+    olib_serializer_config_t* cfg = &serializer->config;
+    void* ctx = cfg->user_data;
+
+    // With a string sink, strings are left unconsumed (string_val NULL) for
+    // olib_serializer_fill_string to take in pieces
+    if (serializer->sink && cfg->read_string_chunk && cfg->read_peek &&
+        cfg->read_peek(ctx) == OLIB_OBJECT_TYPE_STRING) {
+        out->type = OLIB_OBJECT_TYPE_STRING;
+        out->data.string_val = NULL;
+        return true;
+    }
+    if (cfg->read_value) {
+        return cfg->read_value(ctx, out);
+    }
+    if (!cfg->read_peek) {
+        return false;
+    }
+
+    out->type = cfg->read_peek(ctx);
+    switch (out->type) {
+        case OLIB_OBJECT_TYPE_INT:
+            return cfg->read_int && cfg->read_int(ctx, &out->data.int_val);
+        case OLIB_OBJECT_TYPE_UINT:
+            return cfg->read_uint && cfg->read_uint(ctx, &out->data.uint_val);
+        case OLIB_OBJECT_TYPE_FLOAT:
+            return cfg->read_float && cfg->read_float(ctx, &out->data.float_val);
+        case OLIB_OBJECT_TYPE_STRING:
+            return cfg->read_string && cfg->read_string(ctx, &out->data.string_val);
+        case OLIB_OBJECT_TYPE_BOOL:
+            return cfg->read_bool && cfg->read_bool(ctx, &out->data.bool_val);
+        case OLIB_OBJECT_TYPE_LIST:
+        case OLIB_OBJECT_TYPE_STRUCT:
+        case OLIB_OBJECT_TYPE_MAP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Fill a string node from a value read by olib_serializer_read_value. Values longer than the
+// sink's chunk size go to the sink instead and the node is left empty.
+static bool olib_serializer_fill_string(olib_serializer_t* serializer, olib_object_t* obj, const char* value) {
+    olib_serializer_config_t* cfg = &serializer->config;
+    size_t max_size = serializer->sink_chunk_size;
+    if (value) {
+        size_t len = strlen(value);
+        if (!serializer->sink || len <= max_size) {
+            return olib_object_set_string_len(obj, value, len);
+        }
+        // Decoded in one piece by a serializer without read_string_chunk
+        if (obj->data.string.data) obj->data.string.data[0] = '\0';
+        for (size_t offset = 0;; offset += max_size) {
+            size_t size = len - offset < max_size ? len - offset : max_size;
+            bool last = offset + size == len;
+            if (!serializer->sink(serializer->sink_ctx, obj, value + offset, size, last)) return false;
+            if (last) return true;
+        }
+    }
+
+    const char* chunk;
+    size_t size;
+    bool last;
+    if (!cfg->read_string_chunk(cfg->user_data, max_size, &chunk, &size, &last)) return false;
+    if (last) {
+        return olib_object_set_string_len(obj, chunk, size);
+    }
+    if (obj->data.string.data) obj->data.string.data[0] = '\0';
+    for (;;) {
+        if (!serializer->sink(serializer->sink_ctx, obj, chunk, size, last)) return false;
+        if (last) return true;
+        if (!cfg->read_string_chunk(cfg->user_data, max_size, &chunk, &size, &last)) return false;
+    }
+}
+
+// Store a decoded map entry, a duplicate key overwrites the earlier value like map_set
+static bool olib_serializer_map_put(olib_object_t* map, int64_t key, olib_object_t* value) {
+    size_t index = olib_object_map_find(map, key);
+    if (index != SIZE_MAX) {
+        olib_object_free(map->data.map.entries[index].value);
+        map->data.map.entries[index].value = value;
+        return true;
+    }
+    if (!olib_object_map_reserve(map, map->data.map.size + 1)) {
+        return false;
+    }
+    olib_object_map_link(map, key, value);
+    return true;
+}
+
 static olib_object_t* olib_serializer_read_object(olib_serializer_t* serializer) {
     if (!serializer) {
         return NULL;
@@ -147,63 +419,50 @@ static olib_object_t* olib_serializer_read_object(olib_serializer_t* serializer)
     olib_serializer_config_t* cfg = &serializer->config;
     void* ctx = cfg->user_data;
 
-    if (!cfg->read_peek) {
+    olib_value_t value;
+    if (!olib_serializer_read_value(serializer, &value)) {
         return NULL;
     }
 
-    olib_object_type_t type = cfg->read_peek(ctx);
     olib_object_t* obj = NULL;
 
-    switch (type) {
-        case OLIB_OBJECT_TYPE_INT: {
-            if (!cfg->read_int) return NULL;
-            int64_t value;
-            if (!cfg->read_int(ctx, &value)) return NULL;
+    switch (value.type) {
+        case OLIB_OBJECT_TYPE_INT:
             obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
             if (!obj) return NULL;
-            olib_object_set_int(obj, value);
+            olib_object_set_int(obj, value.data.int_val);
             return obj;
-        }
 
-        case OLIB_OBJECT_TYPE_UINT: {
-            if (!cfg->read_uint) return NULL;
-            uint64_t value;
-            if (!cfg->read_uint(ctx, &value)) return NULL;
+        case OLIB_OBJECT_TYPE_UINT:
             obj = olib_object_new(OLIB_OBJECT_TYPE_UINT);
             if (!obj) return NULL;
-            olib_object_set_uint(obj, value);
+            olib_object_set_uint(obj, value.data.uint_val);
             return obj;
-        }
 
-        case OLIB_OBJECT_TYPE_FLOAT: {
-            if (!cfg->read_float) return NULL;
-            double value;
-            if (!cfg->read_float(ctx, &value)) return NULL;
+        case OLIB_OBJECT_TYPE_FLOAT:
             obj = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
             if (!obj) return NULL;
-            olib_object_set_float(obj, value);
+            olib_object_set_float(obj, value.data.float_val);
             return obj;
-        }
 
-        case OLIB_OBJECT_TYPE_STRING: {
-            if (!cfg->read_string) return NULL;
-            const char* value;
-            if (!cfg->read_string(ctx, &value)) return NULL;
+        case OLIB_OBJECT_TYPE_STRING:
             obj = olib_object_new(OLIB_OBJECT_TYPE_STRING);
             if (!obj) return NULL;
-            olib_object_set_string(obj, value);
+            if (serializer->sink) {
+                if (!olib_serializer_fill_string(serializer, obj, value.data.string_val)) {
+                    olib_object_free(obj);
+                    return NULL;
+                }
+                return obj;
+            }
+            olib_object_set_string(obj, value.data.string_val);
             return obj;
-        }
 
-        case OLIB_OBJECT_TYPE_BOOL: {
-            if (!cfg->read_bool) return NULL;
-            bool value;
-            if (!cfg->read_bool(ctx, &value)) return NULL;
+        case OLIB_OBJECT_TYPE_BOOL:
             obj = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
             if (!obj) return NULL;
-            olib_object_set_bool(obj, value);
+            olib_object_set_bool(obj, value.data.bool_val);
             return obj;
-        }
 
         case OLIB_OBJECT_TYPE_LIST: {
             if (!cfg->read_list_begin || !cfg->read_list_end) return NULL;
@@ -237,31 +496,55 @@ static olib_object_t* olib_serializer_read_object(olib_serializer_t* serializer)
             if (!obj) return NULL;
             const char* key;
             while (cfg->read_struct_key(ctx, &key)) {
-                // Make a copy of the key since it may point to a temporary buffer
-                // that gets overwritten when reading the value
-                size_t key_len = strlen(key);
-                char* key_copy = olib_malloc(key_len + 1);
-                if (!key_copy) {
-                    olib_object_free(obj);
-                    return NULL;
+                // The key may point to a temporary buffer that gets overwritten when
+                // reading the value, so it is looked up or copied into its entry first.
+                // A duplicate key overwrites the earlier value like struct_set.
+                olib_struct_entry_t* entry = NULL;
+                for (size_t i = 0; i < obj->data.object.size; i++) {
+                    if (strcmp(obj->data.object.entries[i].key, key) == 0) {
+                        entry = &obj->data.object.entries[i];
+                        break;
+                    }
                 }
-                memcpy(key_copy, key, key_len + 1);
-                
+                if (!entry) {
+                    entry = olib_object_struct_insert_entry(obj, obj->data.object.size, key);
+                    if (!entry) {
+                        olib_object_free(obj);
+                        return NULL;
+                    }
+                }
+
                 olib_object_t* value = olib_serializer_read_object(serializer);
                 if (!value) {
-                    olib_free(key_copy);
                     olib_object_free(obj);
                     return NULL;
                 }
-                if (!olib_object_struct_set(obj, key_copy, value)) {
-                    olib_free(key_copy);
-                    olib_object_free(value);
+                olib_object_free(entry->value);
+                entry->value = value;
+            }
+            if (!cfg->read_struct_end(ctx)) {
+                olib_object_free(obj);
+                return NULL;
+            }
+            return obj;
+        }
+
+        case OLIB_OBJECT_TYPE_MAP: {
+            if (!cfg->read_map_begin || !cfg->read_map_key || !cfg->read_map_end) return NULL;
+            size_t size;
+            if (!cfg->read_map_begin(ctx, &size)) return NULL;
+            obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+            if (!obj) return NULL;
+            for (size_t i = 0; i < size; i++) {
+                int64_t key;
+                olib_object_t* item = cfg->read_map_key(ctx, &key) ? olib_serializer_read_object(serializer) : NULL;
+                if (!item || !olib_serializer_map_put(obj, key, item)) {
+                    olib_object_free(item);
                     olib_object_free(obj);
                     return NULL;
                 }
-                olib_free(key_copy);
             }
-            if (!cfg->read_struct_end(ctx)) {
+            if (!cfg->read_map_end(ctx)) {
                 olib_object_free(obj);
                 return NULL;
             }
@@ -273,6 +556,188 @@ static olib_object_t* olib_serializer_read_object(olib_serializer_t* serializer)
     }
 }
 
+// #############################################################################
+// Internal read-into helpers
+// #############################################################################
+
+// Reads the next value into an existing node. Nodes, string buffers and container
+// arrays are reused wherever the incoming data has the same shape as the tree, so
+// only the parts that differ are allocated or freed.
+static bool olib_serializer_read_object_into(olib_serializer_t* serializer, olib_object_t* obj) {
+    olib_serializer_config_t* cfg = &serializer->config;
+    void* ctx = cfg->user_data;
+
+    olib_value_t value;
+    if (!olib_serializer_read_value(serializer, &value)) {
+        return false;
+    }
+
+    olib_object_type_t type = value.type;
+
+    switch (type) {
+        case OLIB_OBJECT_TYPE_INT:
+            olib_object_reset_type(obj, type);
+            obj->data.int_val = value.data.int_val;
+            return true;
+
+        case OLIB_OBJECT_TYPE_UINT:
+            olib_object_reset_type(obj, type);
+            obj->data.uint_val = value.data.uint_val;
+            return true;
+
+        case OLIB_OBJECT_TYPE_FLOAT:
+            olib_object_reset_type(obj, type);
+            obj->data.float_val = value.data.float_val;
+            return true;
+
+        case OLIB_OBJECT_TYPE_STRING:
+            olib_object_reset_type(obj, type);
+            return olib_serializer_fill_string(serializer, obj, value.data.string_val);
+
+        case OLIB_OBJECT_TYPE_BOOL:
+            olib_object_reset_type(obj, type);
+            obj->data.bool_val = value.data.bool_val;
+            return true;
+
+        case OLIB_OBJECT_TYPE_LIST: {
+            if (!cfg->read_list_begin || !cfg->read_list_end) return false;
+            size_t size;
+            if (!cfg->read_list_begin(ctx, &size)) return false;
+            olib_object_reset_type(obj, type);
+            for (size_t i = 0; i < size; i++) {
+                if (i < obj->data.list.size) {
+                    if (!olib_serializer_read_object_into(serializer, obj->data.list.items[i])) return false;
+                    continue;
+                }
+                olib_object_t* item = olib_serializer_read_object(serializer);
+                if (!item) return false;
+                if (!olib_object_list_push(obj, item)) {
+                    olib_object_free(item);
+                    return false;
+                }
+            }
+            olib_object_list_truncate(obj, size);
+            return cfg->read_list_end(ctx);
+        }
+
+        case OLIB_OBJECT_TYPE_STRUCT: {
+            if (!cfg->read_struct_begin || !cfg->read_struct_key || !cfg->read_struct_end) return false;
+            if (!cfg->read_struct_begin(ctx)) return false;
+            olib_object_reset_type(obj, type);
+            size_t index = 0;
+            const char* key;
+            while (cfg->read_struct_key(ctx, &key)) {
+                // The key points into a temporary buffer, so it is only compared
+                // (or copied for new entries) before the value is read
+                olib_struct_entry_t* entries = obj->data.object.entries;
+                olib_struct_entry_t* entry = NULL;
+                if (index < obj->data.object.size && strcmp(entries[index].key, key) == 0) {
+                    entry = &entries[index++];
+                } else {
+                    // A later match is moved into place to keep the document order, an
+                    // earlier one is a duplicate key and gets overwritten like struct_set
+                    for (size_t j = 0; j < obj->data.object.size; j++) {
+                        if (j == index || strcmp(entries[j].key, key) != 0) {
+                            continue;
+                        }
+                        if (j > index) {
+                            olib_struct_entry_t tmp = entries[index];
+                            entries[index] = entries[j];
+                            entries[j] = tmp;
+                            entry = &entries[index++];
+                        } else {
+                            entry = &entries[j];
+                        }
+                        break;
+                    }
+                    if (!entry) {
+                        entry = olib_object_struct_insert_entry(obj, index, key);
+                        if (!entry) return false;
+                        index++;
+                    }
+                }
+                if (entry->value) {
+                    if (!olib_serializer_read_object_into(serializer, entry->value)) return false;
+                } else {
+                    entry->value = olib_serializer_read_object(serializer);
+                    if (!entry->value) return false;
+                }
+            }
+            olib_object_struct_truncate(obj, index);
+            return cfg->read_struct_end(ctx);
+        }
+
+        case OLIB_OBJECT_TYPE_MAP: {
+            if (!cfg->read_map_begin || !cfg->read_map_key || !cfg->read_map_end) return false;
+            size_t size;
+            if (!cfg->read_map_begin(ctx, &size)) return false;
+            olib_object_reset_type(obj, type);
+            // Entries seen so far are swapped to the front in document order, the rest are
+            // dropped at the end like vanished struct keys
+            size_t index = 0;
+            for (size_t i = 0; i < size; i++) {
+                int64_t key;
+                if (!cfg->read_map_key(ctx, &key)) return false;
+                size_t found = olib_object_map_find(obj, key);
+                if (found == SIZE_MAX) {
+                    if (!olib_object_map_reserve(obj, obj->data.map.size + 1)) return false;
+                    olib_object_map_link(obj, key, NULL);
+                    found = obj->data.map.size - 1;
+                }
+                if (found >= index) {
+                    olib_object_map_swap(obj, found, index);
+                    found = index++;
+                }
+                olib_map_entry_t* entry = &obj->data.map.entries[found];
+                if (entry->value) {
+                    if (!olib_serializer_read_object_into(serializer, entry->value)) return false;
+                } else {
+                    entry->value = olib_serializer_read_object(serializer);
+                    if (!entry->value) return false;
+                }
+            }
+            olib_object_map_truncate(obj, index);
+            return cfg->read_map_end(ctx);
+        }
+
+        default:
+            return false;
+    }
+}
+
+// #############################################################################
+// Top-level calls
+// #############################################################################
+
+// Start a write and encode the whole tree, finish_write is left to the caller
+static bool olib_serializer_write_root(olib_serializer_t* serializer, olib_object_t* obj) {
+    if (serializer->config.init_write) {
+        if (!serializer->config.init_write(serializer->config.user_data)) {
+            return false;
+        }
+    }
+    olib_trace_scope_t trace;
+    olib_trace_begin(&trace);
+    bool result = olib_serializer_write_object(serializer, obj);
+    olib_trace_end(&trace, OLIB_TRACE_WRITE, serializer->format, serializer->format, NULL, 0, obj);
+    return result;
+}
+
+// Decode a whole buffer
+static olib_object_t* olib_serializer_read_root(olib_serializer_t* serializer, const uint8_t* data, size_t size) {
+    olib_trace_scope_t trace;
+    olib_trace_begin(&trace);
+    olib_object_t* result = NULL;
+    if (!serializer->config.init_read || serializer->config.init_read(serializer->config.user_data, data, size)) {
+        result = olib_serializer_read_object(serializer);
+        if (serializer->config.finish_read) {
+            serializer->config.finish_read(serializer->config.user_data);
+        }
+    }
+    olib_trace_end(&trace, OLIB_TRACE_READ, serializer->format, serializer->format, data, size, NULL);
+    return result;
+}
+
 // #############################################################################
 // Public write functions
 // #############################################################################
@@ -285,12 +750,7 @@ OLIB_API bool olib_serializer_write(olib_serializer_t* serializer, olib_object_t
     if (serializer->config.text_based) {
         return false;
     }
-    if (serializer->config.init_write) {
-        if (!serializer->config.init_write(serializer->config.user_data)) {
-            return false;
-        }
-    }
-    if (!olib_serializer_write_object(serializer, obj)) {
+    if (!olib_serializer_write_root(serializer, obj)) {
         return false;
     }
     if (serializer->config.finish_write) {
@@ -307,12 +767,7 @@ OLIB_API bool olib_serializer_write_string(olib_serializer_t* serializer, olib_o
     if (!serializer->config.text_based) {
         return false;
     }
-    if (serializer->config.init_write) {
-        if (!serializer->config.init_write(serializer->config.user_data)) {
-            return false;
-        }
-    }
-    if (!olib_serializer_write_object(serializer, obj)) {
+    if (!olib_serializer_write_root(serializer, obj)) {
         return false;
     }
     if (serializer->config.finish_write && out_string) {
@@ -321,6 +776,12 @@ OLIB_API bool olib_serializer_write_string(olib_serializer_t* serializer, olib_o
         if (!serializer->config.finish_write(serializer->config.user_data, &data, &size)) {
             return false;
         }
+        // The shared output buffer is already terminated, and keeping the block unchanged
+        // lets it be recycled
+        if (olib_serializer_get_output(serializer)) {
+            *out_string = (char*)data;
+            return true;
+        }
         // Add null terminator for string output
         char* str = olib_realloc(data, size + 1);
         if (!str) {
@@ -337,22 +798,17 @@ OLIB_API bool olib_serializer_write_file(olib_serializer_t* serializer, olib_obj
     if (!serializer || !obj || !file) {
         return false;
     }
-    if (serializer->config.init_write) {
-        if (!serializer->config.init_write(serializer->config.user_data)) {
-            return false;
-        }
-    }
-    if (!olib_serializer_write_object(serializer, obj)) {
+    if (!olib_serializer_write_root(serializer, obj)) {
         return false;
     }
     if (serializer->config.finish_write) {
         uint8_t* data;
         size_t size;
-        if (!serializer->config.finish_write(serializer->config.user_data, &data, &size)) {
+        if (!olib_serializer_finish_borrowed(serializer, &data, &size)) {
             return false;
         }
         size_t written = fwrite(data, 1, size, file);
-        olib_free(data);
+        olib_serializer_release_output(serializer, data);
         return written == size;
     }
     return true;
@@ -384,16 +840,7 @@ OLIB_API olib_object_t* olib_serializer_read(olib_serializer_t* serializer, cons
     if (serializer->config.text_based) {
         return NULL;
     }
-    if (serializer->config.init_read) {
-        if (!serializer->config.init_read(serializer->config.user_data, data, size)) {
-            return NULL;
-        }
-    }
-    olib_object_t* result = olib_serializer_read_object(serializer);
-    if (serializer->config.finish_read) {
-        serializer->config.finish_read(serializer->config.user_data);
-    }
-    return result;
+    return olib_serializer_read_root(serializer, data, size);
 }
 
 OLIB_API olib_object_t* olib_serializer_read_string(olib_serializer_t* serializer, const char* string) {
@@ -404,15 +851,23 @@ OLIB_API olib_object_t* olib_serializer_read_string(olib_serializer_t* serialize
     if (!serializer->config.text_based) {
         return NULL;
     }
-    if (serializer->config.init_read) {
-        if (!serializer->config.init_read(serializer->config.user_data, (const uint8_t*)string, strlen(string))) {
-            return NULL;
-        }
+    return olib_serializer_read_root(serializer, (const uint8_t*)string, strlen(string));
+}
+
+OLIB_API bool olib_serializer_read_into(olib_serializer_t* serializer, const uint8_t* data, size_t size, olib_object_t* existing) {
+    if (!serializer || !data || size == 0 || !existing) {
+        return false;
     }
-    olib_object_t* result = olib_serializer_read_object(serializer);
-    if (serializer->config.finish_read) {
-        serializer->config.finish_read(serializer->config.user_data);
+    olib_trace_scope_t trace;
+    olib_trace_begin(&trace);
+    bool result = false;
+    if (!serializer->config.init_read || serializer->config.init_read(serializer->config.user_data, data, size)) {
+        result = olib_serializer_read_object_into(serializer, existing);
+        if (serializer->config.finish_read) {
+            serializer->config.finish_read(serializer->config.user_data);
+        }
     }
+    olib_trace_end(&trace, OLIB_TRACE_READ, serializer->format, serializer->format, data, size, NULL);
     return result;
 }
 
@@ -437,16 +892,7 @@ OLIB_API olib_object_t* olib_serializer_read_file(olib_serializer_t* serializer,
         olib_free(data);
         return NULL;
     }
-    if (serializer->config.init_read) {
-        if (!serializer->config.init_read(serializer->config.user_data, data, size)) {
-            olib_free(data);
-            return NULL;
-        }
-    }
-    olib_object_t* result = olib_serializer_read_object(serializer);
-    if (serializer->config.finish_read) {
-        serializer->config.finish_read(serializer->config.user_data);
-    }
+    olib_object_t* result = olib_serializer_read_root(serializer, data, size);
     olib_free(data);
     return result;
 }
@@ -464,3 +910,144 @@ OLIB_API olib_object_t* olib_serializer_read_file_path(olib_serializer_t* serial
     fclose(file);
     return result;
 }
+
+// #############################################################################
+// Filtered I/O
+// #############################################################################
+
+// Run the encoder into a buffer, regardless of text_based. Borrowed output is released with
+// olib_serializer_release_output
+static bool olib_serializer_encode(olib_serializer_t* serializer, olib_object_t* obj, bool borrowed, uint8_t** out_data, size_t* out_size) {
+    if (!olib_serializer_write_root(serializer, obj)) {
+        return false;
+    }
+    if (!serializer->config.finish_write) {
+        return false;
+    }
+    if (borrowed) {
+        return olib_serializer_finish_borrowed(serializer, out_data, out_size);
+    }
+    return serializer->config.finish_write(serializer->config.user_data, out_data, out_size);
+}
+
+// Run the decoder over a buffer, regardless of text_based
+static olib_object_t* olib_serializer_decode(olib_serializer_t* serializer, const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+    return olib_serializer_read_root(serializer, data, size);
+}
+
+OLIB_API bool olib_serializer_write_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, uint8_t** out_data, size_t* out_size) {
+    if (!serializer || !obj || !out_data || !out_size) {
+        return false;
+    }
+    uint8_t* data;
+    size_t size;
+    if (!chain) {
+        return olib_serializer_encode(serializer, obj, false, out_data, out_size);
+    }
+    if (!olib_serializer_encode(serializer, obj, true, &data, &size)) {
+        return false;
+    }
+    bool result = olib_stream_chain_apply(chain, data, size, out_data, out_size);
+    olib_serializer_release_output(serializer, data);
+    return result;
+}
+
+OLIB_API bool olib_serializer_write_file_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, FILE* file) {
+    if (!serializer || !obj || !file) {
+        return false;
+    }
+    uint8_t* data;
+    size_t size;
+    if (!olib_serializer_encode(serializer, obj, true, &data, &size)) {
+        return false;
+    }
+    bool result;
+    if (chain) {
+        result = olib_stream_chain_begin(chain, olib_stream_file_emit, file) &&
+                 olib_stream_chain_write(chain, data, size) &&
+                 olib_stream_chain_end(chain);
+    } else {
+        result = fwrite(data, 1, size, file) == size;
+    }
+    olib_serializer_release_output(serializer, data);
+    return result;
+}
+
+OLIB_API bool olib_serializer_write_file_path_filtered(olib_serializer_t* serializer, olib_object_t* obj, olib_stream_chain_t* chain, const char* file_path) {
+    if (!serializer || !obj || !file_path) {
+        return false;
+    }
+    FILE* file = fopen(file_path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool result = olib_serializer_write_file_filtered(serializer, obj, chain, file);
+    if (fclose(file) != 0) {
+        result = false;
+    }
+    return result;
+}
+
+OLIB_API olib_object_t* olib_serializer_read_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, const uint8_t* data, size_t size) {
+    if (!serializer || !data || size == 0) {
+        return NULL;
+    }
+    if (!chain) {
+        return olib_serializer_decode(serializer, data, size);
+    }
+    uint8_t* decoded;
+    size_t decoded_size;
+    if (!olib_stream_chain_apply(chain, data, size, &decoded, &decoded_size)) {
+        return NULL;
+    }
+    olib_object_t* result = olib_serializer_decode(serializer, decoded, decoded_size);
+    olib_free(decoded);
+    return result;
+}
+
+OLIB_API olib_object_t* olib_serializer_read_file_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, FILE* file) {
+    if (!serializer || !file) {
+        return NULL;
+    }
+    uint8_t* block = olib_malloc(OLIB_STREAM_BLOCK_SIZE);
+    if (!block) {
+        return NULL;
+    }
+    // Pull the file through the chain block by block, only the decoded bytes are kept
+    olib_stream_buffer_t buffer = {0};
+    bool ok = !chain || olib_stream_chain_begin(chain, olib_stream_buffer_emit, &buffer);
+    while (ok) {
+        size_t read = fread(block, 1, OLIB_STREAM_BLOCK_SIZE, file);
+        if (read > 0) {
+            ok = chain ? olib_stream_chain_write(chain, block, read) : olib_stream_buffer_emit(&buffer, block, read);
+        }
+        if (read < OLIB_STREAM_BLOCK_SIZE) {
+            ok = ok && !ferror(file);
+            break;
+        }
+    }
+    if (ok && chain) {
+        ok = olib_stream_chain_end(chain);
+    }
+    olib_free(block);
+
+    olib_object_t* result = ok ? olib_serializer_decode(serializer, buffer.data, buffer.size) : NULL;
+    olib_free(buffer.data);
+    return result;
+}
+
+OLIB_API olib_object_t* olib_serializer_read_file_path_filtered(olib_serializer_t* serializer, olib_stream_chain_t* chain, const char* file_path) {
+    if (!serializer || !file_path) {
+        return NULL;
+    }
+    FILE* file = fopen(file_path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    olib_object_t* result = olib_serializer_read_file_filtered(serializer, chain, file);
+    fclose(file);
+    return result;
+}
@@ -0,0 +1,42 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_serializer.h>
+
+// Serializer internals shared between the library sources. Not part of the public API.
+
+// Callbacks the serializer was created with
+olib_serializer_config_t* olib_serializer_get_config(olib_serializer_t* serializer);
+
+// Shared write buffer of a built-in format, NULL for custom serializers
+olib_output_buffer_t* olib_serializer_get_output(olib_serializer_t* serializer);
+
+// Finish a write whose result the library consumes itself. A retained buffer is handed off
+// rather than copied, olib_serializer_release_output gives it back afterwards
+bool olib_serializer_finish_borrowed(olib_serializer_t* serializer, uint8_t** out_data, size_t* out_size);
+
+// Release output produced by olib_serializer_finish_borrowed
+void olib_serializer_release_output(olib_serializer_t* serializer, uint8_t* data);
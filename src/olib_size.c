@@ -0,0 +1,488 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_size.h>
+#include "olib_object_internal.h"
+#include "olib_output_internal.h"
+#include "olib_serializer_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct {
+    olib_size_entry_t entry;
+    size_t parent;   // SIZE_MAX for the root
+    size_t segment;  // Offset of the last path segment
+    bool item;       // Last segment is a collapsed list index or map key
+} olib_size_node_t;
+
+struct olib_size_report_t {
+    olib_size_node_t* nodes;  // Parents come before their children
+    size_t count;
+    size_t capacity;
+    uint32_t* slots;  // Open addressing over (parent, segment), node index + 1
+    size_t slot_count;
+    uint64_t total;
+    uint64_t class_totals[OLIB_SIZE_CLASS_MAX];
+    olib_size_entry_t** ranked;
+};
+
+typedef struct {
+    olib_size_report_t* report;
+    olib_serializer_config_t* cfg;
+    olib_output_buffer_t* out;
+    bool text_based;
+    bool failed;  // Out of memory while adding paths
+} olib_size_walk_t;
+
+static const char* g_size_class_names[OLIB_SIZE_CLASS_MAX] = {
+    "key",
+    "value",
+    "framing",
+    "whitespace",
+};
+
+OLIB_API const char* olib_size_class_to_string(olib_size_class_t size_class) {
+    if (size_class < 0 || size_class >= OLIB_SIZE_CLASS_MAX) {
+        return "unknown";
+    }
+    return g_size_class_names[size_class];
+}
+
+// #############################################################################
+// Paths
+// #############################################################################
+
+static uint64_t olib_size_path_hash(size_t parent, const char* segment, bool item) {
+    uint64_t hash = 0xCBF29CE484222325ULL ^ ((uint64_t)parent * 0x9E3779B97F4A7C15ULL);
+    if (item) {
+        return hash ^ 0x5BD1E995ULL;
+    }
+    for (const char* p = segment; *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static bool olib_size_rehash(olib_size_report_t* report, size_t slot_count) {
+    uint32_t* slots = olib_calloc(slot_count, sizeof(uint32_t));
+    if (!slots) {
+        return false;
+    }
+    for (size_t i = 0; i < report->count; i++) {
+        olib_size_node_t* node = &report->nodes[i];
+        uint64_t hash = olib_size_path_hash(node->parent, node->entry.path + node->segment, node->item);
+        size_t pos = (size_t)hash & (slot_count - 1);
+        while (slots[pos]) {
+            pos = (pos + 1) & (slot_count - 1);
+        }
+        slots[pos] = (uint32_t)i + 1;
+    }
+    if (report->slots) {
+        olib_free(report->slots);
+    }
+    report->slots = slots;
+    report->slot_count = slot_count;
+    return true;
+}
+
+// Node of the path below parent, created on first use. key is NULL for a collapsed list
+// index or map key.
+static size_t olib_size_child(olib_size_walk_t* walk, size_t parent, const char* key) {
+    olib_size_report_t* report = walk->report;
+    bool item = key == NULL;
+    uint64_t hash = olib_size_path_hash(parent, key, item);
+    size_t mask = report->slot_count - 1;
+    size_t pos = (size_t)hash & mask;
+    for (; report->slots[pos]; pos = (pos + 1) & mask) {
+        olib_size_node_t* node = &report->nodes[report->slots[pos] - 1];
+        if (node->parent == parent && node->item == item &&
+            (item || strcmp(node->entry.path + node->segment, key) == 0)) {
+            return report->slots[pos] - 1;
+        }
+    }
+
+    if (report->count == report->capacity) {
+        size_t capacity = report->capacity * 2;
+        olib_size_node_t* nodes = olib_realloc(report->nodes, capacity * sizeof(olib_size_node_t));
+        if (!nodes) {
+            walk->failed = true;
+            return parent;
+        }
+        report->nodes = nodes;
+        report->capacity = capacity;
+    }
+
+    // "parent.key", "key" below the root and "parent[]" for items
+    const char* parent_path = report->nodes[parent].entry.path;
+    size_t parent_len = strlen(parent_path);
+    const char* segment = item ? "[]" : key;
+    size_t separator = !item && parent_len > 0 ? 1 : 0;
+    size_t segment_len = strlen(segment);
+    char* path = olib_malloc(parent_len + separator + segment_len + 1);
+    if (!path) {
+        walk->failed = true;
+        return parent;
+    }
+    memcpy(path, parent_path, parent_len);
+    if (separator) {
+        path[parent_len] = '.';
+    }
+    memcpy(path + parent_len + separator, segment, segment_len + 1);
+
+    size_t index = report->count++;
+    olib_size_node_t* node = &report->nodes[index];
+    memset(node, 0, sizeof(*node));
+    node->entry.path = path;
+    node->parent = parent;
+    node->segment = parent_len + separator;
+    node->item = item;
+    report->slots[pos] = (uint32_t)index + 1;
+    if (report->count * 2 > report->slot_count && !olib_size_rehash(report, report->slot_count * 2)) {
+        walk->failed = true;
+    }
+    return index;
+}
+
+// #############################################################################
+// Attribution
+// #############################################################################
+
+static bool olib_size_is_space(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Forget the marks of the previous callback, returns where the next one starts writing
+static size_t olib_size_begin(olib_size_walk_t* walk) {
+    walk->out->key_begin = 0;
+    walk->out->key_end = 0;
+    walk->out->value_begin = SIZE_MAX;
+    walk->out->value_end = SIZE_MAX;
+    return walk->out->size;
+}
+
+// Charge the bytes written since before to a node. Marked key text and, for scalars, the
+// marked token are keys and values, the rest is whitespace or framing. Scalars of writers
+// that mark no token count as value entirely.
+static void olib_size_account(olib_size_walk_t* walk, size_t index, size_t before, bool scalar) {
+    olib_output_buffer_t* out = walk->out;
+    uint64_t* bytes = walk->report->nodes[index].entry.bytes;
+    bool unmarked = out->value_begin == SIZE_MAX;
+    for (size_t i = before; i < out->size; i++) {
+        if (i >= out->key_begin && i < out->key_end) {
+            bytes[OLIB_SIZE_KEY]++;
+        } else if (scalar && !unmarked && i >= out->value_begin && i < out->value_end) {
+            bytes[OLIB_SIZE_VALUE]++;
+        } else if (walk->text_based && olib_size_is_space(out->data[i])) {
+            bytes[OLIB_SIZE_WHITESPACE]++;
+        } else if (scalar && unmarked) {
+            bytes[OLIB_SIZE_VALUE]++;
+        } else {
+            bytes[OLIB_SIZE_FRAMING]++;
+        }
+    }
+}
+
+// #############################################################################
+// Walk
+// #############################################################################
+
+// Same traversal as the serializer's writer, with every callback measured
+static bool olib_size_write(olib_size_walk_t* walk, olib_object_t* obj, size_t index) {
+    if (!obj || walk->failed) {
+        return false;
+    }
+    olib_serializer_config_t* cfg = walk->cfg;
+    void* ctx = cfg->user_data;
+    walk->report->nodes[index].entry.count++;
+
+    size_t before = olib_size_begin(walk);
+    bool ok;
+    switch (olib_object_get_type(obj)) {
+        case OLIB_OBJECT_TYPE_INT:
+            ok = cfg->write_int && cfg->write_int(ctx, olib_object_get_int(obj));
+            break;
+        case OLIB_OBJECT_TYPE_UINT:
+            ok = cfg->write_uint && cfg->write_uint(ctx, olib_object_get_uint(obj));
+            break;
+        case OLIB_OBJECT_TYPE_FLOAT:
+            ok = cfg->write_float && cfg->write_float(ctx, olib_object_get_float(obj));
+            break;
+        case OLIB_OBJECT_TYPE_STRING:
+            ok = cfg->write_string && cfg->write_string(ctx, olib_object_get_string(obj));
+            break;
+        case OLIB_OBJECT_TYPE_BOOL:
+            ok = cfg->write_bool && cfg->write_bool(ctx, olib_object_get_bool(obj));
+            break;
+
+        case OLIB_OBJECT_TYPE_LIST: {
+            if (!cfg->write_list_begin || !cfg->write_list_end) return false;
+            size_t size = olib_object_list_size(obj);
+            size_t list_start = before;
+            uint64_t list_bytes[OLIB_SIZE_CLASS_MAX];
+            memcpy(list_bytes, walk->report->nodes[index].entry.bytes, sizeof(list_bytes));
+            if (!cfg->write_list_begin(ctx, size)) return false;
+            olib_size_account(walk, index, before, false);
+
+            size_t item = size > 0 ? olib_size_child(walk, index, NULL) : index;
+            uint64_t item_bytes[OLIB_SIZE_CLASS_MAX];
+            memcpy(item_bytes, walk->report->nodes[item].entry.bytes, sizeof(item_bytes));
+            for (size_t i = 0; i < size; i++) {
+                if (!olib_size_write(walk, olib_object_list_get(obj, i), item)) return false;
+            }
+
+            before = olib_size_begin(walk);
+            if (!cfg->write_list_end(ctx)) return false;
+            if (walk->out->size >= before) {
+                olib_size_account(walk, index, before, false);
+                return true;
+            }
+            // The writer rewrote the finished list in a denser form (packed numbers). Its
+            // elements are the marked value, they replace what the items were charged.
+            memcpy(walk->report->nodes[index].entry.bytes, list_bytes, sizeof(list_bytes));
+            memcpy(walk->report->nodes[item].entry.bytes, item_bytes, sizeof(item_bytes));
+            olib_output_buffer_t* out = walk->out;
+            size_t value_begin = out->value_begin < out->size ? out->value_begin : out->size;
+            walk->report->nodes[index].entry.bytes[OLIB_SIZE_FRAMING] += value_begin - list_start;
+            walk->report->nodes[item].entry.bytes[OLIB_SIZE_VALUE] += out->size - value_begin;
+            return true;
+        }
+
+        case OLIB_OBJECT_TYPE_STRUCT: {
+            if (!cfg->write_struct_begin || !cfg->write_struct_key || !cfg->write_struct_end) return false;
+            if (!cfg->write_struct_begin(ctx)) return false;
+            olib_size_account(walk, index, before, false);
+            size_t size = olib_object_struct_size(obj);
+            for (size_t i = 0; i < size; i++) {
+                const char* key = olib_object_struct_key_at(obj, i);
+                size_t child = olib_size_child(walk, index, key);
+                before = olib_size_begin(walk);
+                if (!cfg->write_struct_key(ctx, key)) return false;
+                olib_size_account(walk, child, before, false);
+                if (!olib_size_write(walk, olib_object_struct_value_at(obj, i), child)) return false;
+            }
+            before = olib_size_begin(walk);
+            ok = cfg->write_struct_end(ctx);
+            olib_size_account(walk, index, before, false);
+            return ok;
+        }
+
+        case OLIB_OBJECT_TYPE_MAP: {
+            size_t size = olib_object_map_size(obj);
+            size_t item = size > 0 ? olib_size_child(walk, index, NULL) : index;
+            bool native = cfg->write_map_begin && cfg->write_map_key && cfg->write_map_end;
+            if (!native && (!cfg->write_struct_begin || !cfg->write_struct_key || !cfg->write_struct_end)) return false;
+            if (!(native ? cfg->write_map_begin(ctx, size) : cfg->write_struct_begin(ctx))) return false;
+            olib_size_account(walk, index, before, false);
+            char key_text[OLIB_MAP_KEY_TEXT_SIZE];
+            for (size_t i = 0; i < size; i++) {
+                int64_t key = olib_object_map_key_at(obj, i);
+                before = olib_size_begin(walk);
+                if (!(native ? cfg->write_map_key(ctx, key) : cfg->write_struct_key(ctx, olib_object_map_key_text(key, key_text)))) return false;
+                olib_size_account(walk, item, before, false);
+                if (!olib_size_write(walk, olib_object_map_value_at(obj, i), item)) return false;
+            }
+            before = olib_size_begin(walk);
+            ok = native ? cfg->write_map_end(ctx) : cfg->write_struct_end(ctx);
+            olib_size_account(walk, index, before, false);
+            return ok;
+        }
+        default:
+            return false;
+    }
+    olib_size_account(walk, index, before, true);
+    return ok;
+}
+
+// #############################################################################
+// Report
+// #############################################################################
+
+static int olib_size_compare(const void* a, const void* b) {
+    const olib_size_entry_t* x = *(const olib_size_entry_t* const*)a;
+    const olib_size_entry_t* y = *(const olib_size_entry_t* const*)b;
+    if (x->total != y->total) {
+        return x->total > y->total ? -1 : 1;
+    }
+    return strcmp(x->path, y->path);
+}
+
+// Totals, subtree sums and the ranking once the walk is done
+static bool olib_size_finish(olib_size_report_t* report) {
+    for (size_t i = 0; i < report->count; i++) {
+        olib_size_entry_t* entry = &report->nodes[i].entry;
+        entry->total = 0;
+        for (int c = 0; c < OLIB_SIZE_CLASS_MAX; c++) {
+            entry->total += entry->bytes[c];
+            report->class_totals[c] += entry->bytes[c];
+        }
+        entry->subtree = entry->total;
+        report->total += entry->total;
+    }
+    for (size_t i = report->count; i-- > 1;) {
+        report->nodes[report->nodes[i].parent].entry.subtree += report->nodes[i].entry.subtree;
+    }
+
+    report->ranked = olib_malloc(report->count * sizeof(olib_size_entry_t*));
+    if (!report->ranked) {
+        return false;
+    }
+    for (size_t i = 0; i < report->count; i++) {
+        report->ranked[i] = &report->nodes[i].entry;
+    }
+    qsort(report->ranked, report->count, sizeof(olib_size_entry_t*), olib_size_compare);
+    return true;
+}
+
+OLIB_API olib_size_report_t* olib_size_report_new(olib_serializer_t* serializer, olib_object_t* obj) {
+    if (!serializer || !obj) {
+        return NULL;
+    }
+    olib_output_buffer_t* out = olib_serializer_get_output(serializer);
+    olib_serializer_config_t* cfg = olib_serializer_get_config(serializer);
+    if (!out || !cfg->finish_write) {
+        return NULL;
+    }
+
+    olib_size_report_t* report = olib_calloc(1, sizeof(olib_size_report_t));
+    if (!report) {
+        return NULL;
+    }
+    report->capacity = 64;
+    report->nodes = olib_calloc(report->capacity, sizeof(olib_size_node_t));
+    char* root_path = olib_calloc(1, 1);
+    if (!report->nodes || !root_path || !olib_size_rehash(report, 128)) {
+        if (root_path) {
+            olib_free(root_path);
+        }
+        olib_size_report_free(report);
+        return NULL;
+    }
+    report->count = 1;
+    report->nodes[0].entry.path = root_path;
+    report->nodes[0].parent = SIZE_MAX;
+
+    olib_size_walk_t walk = {report, cfg, out, cfg->text_based, false};
+    bool ok = !cfg->init_write || cfg->init_write(cfg->user_data);
+    if (ok) {
+        // Preamble such as a document header
+        olib_size_begin(&walk);
+        olib_size_account(&walk, 0, 0, false);
+        ok = olib_size_write(&walk, obj, 0);
+    }
+
+    // Whatever the writer adds when it finishes (closing markup, a final newline) is the root's
+    size_t written = out->size;
+    uint8_t* data = NULL;
+    size_t size = 0;
+    ok = olib_serializer_finish_borrowed(serializer, &data, &size) && ok && !walk.failed;
+    if (ok) {
+        uint64_t* bytes = report->nodes[0].entry.bytes;
+        for (size_t i = written; i < size; i++) {
+            bytes[walk.text_based && olib_size_is_space(data[i]) ? OLIB_SIZE_WHITESPACE : OLIB_SIZE_FRAMING]++;
+        }
+    }
+    if (data) {
+        olib_serializer_release_output(serializer, data);
+    }
+    if (!ok || !olib_size_finish(report)) {
+        olib_size_report_free(report);
+        return NULL;
+    }
+    return report;
+}
+
+OLIB_API void olib_size_report_free(olib_size_report_t* report) {
+    if (!report) {
+        return;
+    }
+    if (report->nodes) {
+        for (size_t i = 0; i < report->count; i++) {
+            olib_free((void*)report->nodes[i].entry.path);
+        }
+        olib_free(report->nodes);
+    }
+    if (report->slots) {
+        olib_free(report->slots);
+    }
+    if (report->ranked) {
+        olib_free(report->ranked);
+    }
+    olib_free(report);
+}
+
+OLIB_API uint64_t olib_size_report_total(olib_size_report_t* report) {
+    return report ? report->total : 0;
+}
+
+OLIB_API uint64_t olib_size_report_class_total(olib_size_report_t* report, olib_size_class_t size_class) {
+    if (!report || size_class < 0 || size_class >= OLIB_SIZE_CLASS_MAX) {
+        return 0;
+    }
+    return report->class_totals[size_class];
+}
+
+OLIB_API size_t olib_size_report_count(olib_size_report_t* report) {
+    return report ? report->count : 0;
+}
+
+OLIB_API const olib_size_entry_t* olib_size_report_get(olib_size_report_t* report, size_t index) {
+    if (!report || index >= report->count) {
+        return NULL;
+    }
+    return report->ranked[index];
+}
+
+OLIB_API bool olib_size_report_print(olib_size_report_t* report, FILE* file, size_t limit) {
+    if (!report || !file) {
+        return false;
+    }
+    double total = report->total > 0 ? (double)report->total : 1.0;
+    fprintf(file, "Encoded size: %llu bytes (", (unsigned long long)report->total);
+    for (int c = 0; c < OLIB_SIZE_CLASS_MAX; c++) {
+        fprintf(file, "%s%s %llu", c > 0 ? ", " : "", g_size_class_names[c], (unsigned long long)report->class_totals[c]);
+    }
+    fprintf(file, ")\n\n");
+
+    fprintf(file, "%12s %7s %10s %10s %10s %10s %10s %12s  %s\n",
+            "bytes", "share", "count", "key", "value", "framing", "whitespace", "subtree", "path");
+    size_t rows = limit > 0 && limit < report->count ? limit : report->count;
+    for (size_t i = 0; i < rows; i++) {
+        const olib_size_entry_t* entry = report->ranked[i];
+        fprintf(file, "%12llu %6.2f%% %10llu %10llu %10llu %10llu %10llu %12llu  %s\n",
+                (unsigned long long)entry->total, 100.0 * (double)entry->total / total,
+                (unsigned long long)entry->count,
+                (unsigned long long)entry->bytes[OLIB_SIZE_KEY], (unsigned long long)entry->bytes[OLIB_SIZE_VALUE],
+                (unsigned long long)entry->bytes[OLIB_SIZE_FRAMING], (unsigned long long)entry->bytes[OLIB_SIZE_WHITESPACE],
+                (unsigned long long)entry->subtree, entry->path[0] ? entry->path : "(root)");
+    }
+    if (rows < report->count) {
+        fprintf(file, "... %zu more paths\n", report->count - rows);
+    }
+    return !ferror(file);
+}
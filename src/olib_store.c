@@ -0,0 +1,1110 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// mmap flags, msync, ftruncate and dirent are hidden by strict C11 on glibc
+#if defined(__linux__)
+#  define _GNU_SOURCE
+#endif
+
+#include <olib/olib_store.h>
+#include <olib/olib_formats.h>
+#include <olib/olib_serializer.h>
+#include "olib_thread.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#  include <dirent.h>
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define OLIB_STORE_SUPPORTED 1
+#else
+#  define OLIB_STORE_SUPPORTED 0
+#endif
+
+#if OLIB_STORE_SUPPORTED
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// On-disk layout, all integers in host byte order:
+//   seg-NNNNNNNN  32-byte header, then records padded to 8 bytes
+//   index         64-byte header, then a power-of-two table of 24-byte entries
+#define STORE_SEGMENT_MAGIC "OLIBSEG1"
+#define STORE_INDEX_MAGIC "OLIBIDX1"
+#define STORE_RECORD_MAGIC 0x4345524Fu  // "OREC"
+#define STORE_TOMBSTONE UINT32_MAX
+
+#define STORE_DEFAULT_SEGMENT ((size_t)64 << 20)
+#define STORE_MIN_SEGMENT ((size_t)4096)
+#define STORE_DEFAULT_RATIO 0.5
+#define STORE_MIN_CAPACITY 1024
+
+// Index slots with these hashes are free, real hashes are forced above them
+#define STORE_SLOT_EMPTY 0
+#define STORE_SLOT_DELETED 1
+
+typedef struct store_segment_header_t {
+    char magic[8];
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t end;  // Offset past the last complete record
+    uint64_t reserved2;
+} store_segment_header_t;
+
+typedef struct store_record_header_t {
+    uint32_t magic;
+    uint32_t id_len;
+    uint32_t value_len;  // STORE_TOMBSTONE for a delete
+    uint32_t checksum;   // FNV-1a of id and value, checked when the index is rebuilt
+} store_record_header_t;
+
+typedef struct store_index_header_t {
+    char magic[8];
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t deleted;  // Slots marked STORE_SLOT_DELETED
+    uint32_t clean;    // Set on close, a store opened without it rebuilds its index
+    uint32_t reserved;
+    uint8_t padding[24];
+} store_index_header_t;
+
+typedef struct store_index_entry_t {
+    uint64_t hash;
+    uint32_t segment;
+    uint32_t size;  // Record size including header and padding
+    uint64_t offset;
+} store_index_entry_t;
+
+typedef struct store_segment_t {
+    uint32_t id;
+    int fd;
+    uint8_t* data;
+    size_t size;    // Mapped bytes, the whole file
+    uint64_t live;  // Bytes of records the index points to
+} store_segment_t;
+
+struct olib_store_t {
+    char* directory;
+    size_t segment_size;
+    double compact_ratio;
+    bool manual_compaction;
+    olib_thread_mutex_t* mutex;
+    olib_serializer_t* serializer;
+
+    int index_fd;
+    uint8_t* index_data;
+    size_t index_size;
+
+    store_segment_t** segments;  // Sorted by id, the last one is appended to
+    size_t segment_count;
+    size_t segment_capacity;
+    uint32_t next_segment_id;
+
+    olib_thread_t* compactor;
+    bool compactor_running;
+    bool closing;
+};
+
+// Where a document lives, resolved from its index entry
+typedef struct store_location_t {
+    store_segment_t* segment;
+    uint64_t offset;
+    size_t slot;  // Position in the caller's batch
+} store_location_t;
+
+// #############################################################################
+// Helpers
+// #############################################################################
+
+static uint64_t store_hash(const char* id, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)id[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash > STORE_SLOT_DELETED ? hash : hash + 2;
+}
+
+static uint32_t store_checksum(const uint8_t* data, size_t size, uint32_t hash) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static size_t store_record_size(uint32_t id_len, uint32_t value_len) {
+    size_t size = sizeof(store_record_header_t) + id_len + (value_len == STORE_TOMBSTONE ? 0 : value_len);
+    return (size + 7) & ~(size_t)7;
+}
+
+static size_t store_page_align(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+static char* store_path(olib_store_t* store, const char* name) {
+    size_t dir_len = strlen(store->directory);
+    size_t name_len = strlen(name);
+    char* path = olib_malloc(dir_len + name_len + 2);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, store->directory, dir_len);
+    path[dir_len] = '/';
+    memcpy(path + dir_len + 1, name, name_len + 1);
+    return path;
+}
+
+static void store_segment_name(uint32_t id, char name[32]) {
+    snprintf(name, 32, "seg-%08u", (unsigned)id);
+}
+
+static store_index_header_t* store_index_header(olib_store_t* store) {
+    return (store_index_header_t*)store->index_data;
+}
+
+static store_index_entry_t* store_index_entries(olib_store_t* store) {
+    return (store_index_entry_t*)(store->index_data + sizeof(store_index_header_t));
+}
+
+static store_segment_header_t* store_segment_header(store_segment_t* segment) {
+    return (store_segment_header_t*)segment->data;
+}
+
+static store_record_header_t* store_record(store_segment_t* segment, uint64_t offset) {
+    return (store_record_header_t*)(segment->data + offset);
+}
+
+// #############################################################################
+// Segments
+// #############################################################################
+
+static store_segment_t* store_find_segment(olib_store_t* store, uint32_t id) {
+    size_t lo = 0;
+    size_t hi = store->segment_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (store->segments[mid]->id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < store->segment_count && store->segments[lo]->id == id ? store->segments[lo] : NULL;
+}
+
+static bool store_push_segment(olib_store_t* store, store_segment_t* segment) {
+    if (store->segment_count == store->segment_capacity) {
+        size_t capacity = store->segment_capacity ? store->segment_capacity * 2 : 8;
+        store_segment_t** segments = olib_realloc(store->segments, capacity * sizeof(store_segment_t*));
+        if (!segments) {
+            return false;
+        }
+        store->segments = segments;
+        store->segment_capacity = capacity;
+    }
+    // Segments are opened in any order but created in id order, keep the array sorted
+    size_t pos = store->segment_count;
+    while (pos > 0 && store->segments[pos - 1]->id > segment->id) {
+        store->segments[pos] = store->segments[pos - 1];
+        pos--;
+    }
+    store->segments[pos] = segment;
+    store->segment_count++;
+    return true;
+}
+
+static void store_close_segment(store_segment_t* segment) {
+    munmap(segment->data, segment->size);
+    close(segment->fd);
+    olib_free(segment);
+}
+
+// Map an existing segment file, NULL if it is not a valid segment
+static store_segment_t* store_map_segment(int fd, uint32_t id) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(store_segment_header_t)) {
+        return NULL;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    store_segment_header_t* header = (store_segment_header_t*)data;
+    if (memcmp(header->magic, STORE_SEGMENT_MAGIC, 8) != 0 || header->id != id) {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    store_segment_t* segment = olib_calloc(1, sizeof(store_segment_t));
+    if (!segment) {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    segment->id = id;
+    segment->fd = fd;
+    segment->data = (uint8_t*)data;
+    segment->size = (size_t)st.st_size;
+    if (header->end < sizeof(store_segment_header_t) || header->end > segment->size) {
+        header->end = sizeof(store_segment_header_t);
+    }
+    return segment;
+}
+
+// Create and map a new segment that holds at least min_size bytes of records
+static store_segment_t* store_new_segment(olib_store_t* store, size_t min_size) {
+    size_t size = store->segment_size;
+    if (size < sizeof(store_segment_header_t) + min_size) {
+        size = store_page_align(sizeof(store_segment_header_t) + min_size);
+    }
+    char name[32];
+    store_segment_name(store->next_segment_id, name);
+    char* path = store_path(store, name);
+    if (!path) {
+        return NULL;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    olib_free(path);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    store_segment_t* segment = olib_calloc(1, sizeof(store_segment_t));
+    if (!segment) {
+        munmap(data, size);
+        close(fd);
+        return NULL;
+    }
+    segment->id = store->next_segment_id++;
+    segment->fd = fd;
+    segment->data = (uint8_t*)data;
+    segment->size = size;
+
+    store_segment_header_t* header = store_segment_header(segment);
+    header->id = segment->id;
+    header->end = sizeof(store_segment_header_t);
+    memcpy(header->magic, STORE_SEGMENT_MAGIC, 8);
+
+    if (!store_push_segment(store, segment)) {
+        store_close_segment(segment);
+        return NULL;
+    }
+    return segment;
+}
+
+// Reserve size bytes at the end of the active segment, rolling to a new one if needed.
+// The caller fills the record and then commits it with store_commit.
+static uint8_t* store_reserve(olib_store_t* store, size_t size, store_segment_t** out_segment, uint64_t* out_offset) {
+    store_segment_t* segment = store->segment_count ? store->segments[store->segment_count - 1] : NULL;
+    if (!segment || store_segment_header(segment)->end + size > segment->size) {
+        segment = store_new_segment(store, size);
+        if (!segment) {
+            return NULL;
+        }
+    }
+    *out_segment = segment;
+    *out_offset = store_segment_header(segment)->end;
+    return segment->data + *out_offset;
+}
+
+static void store_commit(store_segment_t* segment, size_t size) {
+    store_segment_header(segment)->end += size;
+}
+
+// Remove a segment that no index entry points to anymore, along with its file
+static void store_drop_segment(olib_store_t* store, size_t pos) {
+    store_segment_t* segment = store->segments[pos];
+    char name[32];
+    store_segment_name(segment->id, name);
+    char* path = store_path(store, name);
+    store_close_segment(segment);
+    if (path) {
+        unlink(path);
+        olib_free(path);
+    }
+    memmove(&store->segments[pos], &store->segments[pos + 1], (store->segment_count - pos - 1) * sizeof(store_segment_t*));
+    store->segment_count--;
+}
+
+// #############################################################################
+// Index
+// #############################################################################
+
+static bool store_map_index(olib_store_t* store, size_t size) {
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, store->index_fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    store->index_data = (uint8_t*)data;
+    store->index_size = size;
+    return true;
+}
+
+static size_t store_index_bytes(uint64_t capacity) {
+    return sizeof(store_index_header_t) + (size_t)capacity * sizeof(store_index_entry_t);
+}
+
+// True if the entry points to a record stored under id
+static bool store_entry_matches(olib_store_t* store, store_index_entry_t* entry, const char* id, uint32_t id_len) {
+    store_segment_t* segment = store_find_segment(store, entry->segment);
+    if (!segment) {
+        return false;
+    }
+    store_record_header_t* record = store_record(segment, entry->offset);
+    return record->id_len == id_len && memcmp(record + 1, id, id_len) == 0;
+}
+
+// Slot holding id, or NULL. If insert_slot is given it receives the slot a new entry
+// for id should go into.
+static store_index_entry_t* store_index_find(olib_store_t* store, uint64_t hash, const char* id, uint32_t id_len,
+                                             store_index_entry_t** insert_slot) {
+    store_index_header_t* header = store_index_header(store);
+    store_index_entry_t* entries = store_index_entries(store);
+    uint64_t mask = header->capacity - 1;
+    store_index_entry_t* first_free = NULL;
+    for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+        store_index_entry_t* entry = &entries[i];
+        if (entry->hash == STORE_SLOT_EMPTY) {
+            if (insert_slot) {
+                *insert_slot = first_free ? first_free : entry;
+            }
+            return NULL;
+        }
+        if (entry->hash == STORE_SLOT_DELETED) {
+            if (!first_free) {
+                first_free = entry;
+            }
+        } else if (entry->hash == hash && store_entry_matches(store, entry, id, id_len)) {
+            return entry;
+        }
+    }
+}
+
+// Resize the table to capacity and reinsert every live entry, which also purges deleted slots
+static bool store_index_rehash(olib_store_t* store, uint64_t capacity) {
+    store_index_header_t* header = store_index_header(store);
+    uint64_t count = header->count;
+    store_index_entry_t* live = olib_malloc((size_t)(count ? count : 1) * sizeof(store_index_entry_t));
+    if (!live) {
+        return false;
+    }
+    store_index_entry_t* entries = store_index_entries(store);
+    size_t n = 0;
+    for (uint64_t i = 0; i < header->capacity; i++) {
+        if (entries[i].hash > STORE_SLOT_DELETED) {
+            live[n++] = entries[i];
+        }
+    }
+
+    size_t size = store_index_bytes(capacity);
+    if (size != store->index_size) {
+        store_index_header_t saved = *header;
+        munmap(store->index_data, store->index_size);
+        store->index_data = NULL;
+        if (ftruncate(store->index_fd, (off_t)size) != 0 || !store_map_index(store, size)) {
+            // Put the old table back, the entries are still in live
+            if (ftruncate(store->index_fd, (off_t)store_index_bytes(saved.capacity)) != 0 ||
+                !store_map_index(store, store_index_bytes(saved.capacity))) {
+                olib_free(live);
+                return false;
+            }
+            capacity = saved.capacity;
+        }
+        header = store_index_header(store);
+        *header = saved;
+    }
+
+    header->capacity = capacity;
+    header->deleted = 0;
+    entries = store_index_entries(store);
+    memset(entries, 0, (size_t)capacity * sizeof(store_index_entry_t));
+    uint64_t mask = capacity - 1;
+    for (size_t j = 0; j < n; j++) {
+        uint64_t i = live[j].hash & mask;
+        while (entries[i].hash != STORE_SLOT_EMPTY) {
+            i = (i + 1) & mask;
+        }
+        entries[i] = live[j];
+    }
+    olib_free(live);
+    return true;
+}
+
+// Keep the table at most 70% full counting deleted slots
+static bool store_index_reserve(olib_store_t* store) {
+    store_index_header_t* header = store_index_header(store);
+    if ((header->count + header->deleted + 1) * 10 <= header->capacity * 7) {
+        return true;
+    }
+    uint64_t capacity = header->capacity;
+    if ((header->count + 1) * 20 > capacity * 7) {
+        capacity *= 2;
+    }
+    return store_index_rehash(store, capacity);
+}
+
+// Point id at a record, adjusting the live bytes of the old and new segment
+static bool store_index_set(olib_store_t* store, const char* id, uint32_t id_len, store_segment_t* segment,
+                            uint64_t offset, uint32_t size) {
+    if (!store_index_reserve(store)) {
+        return false;
+    }
+    uint64_t hash = store_hash(id, id_len);
+    store_index_entry_t* slot = NULL;
+    store_index_entry_t* entry = store_index_find(store, hash, id, id_len, &slot);
+    store_index_header_t* header = store_index_header(store);
+    if (entry) {
+        store_segment_t* old = store_find_segment(store, entry->segment);
+        if (old) {
+            old->live -= entry->size;
+        }
+    } else {
+        entry = slot;
+        if (entry->hash == STORE_SLOT_DELETED) {
+            header->deleted--;
+        }
+        header->count++;
+    }
+    entry->hash = hash;
+    entry->segment = segment->id;
+    entry->size = size;
+    entry->offset = offset;
+    segment->live += size;
+    return true;
+}
+
+static bool store_index_remove(olib_store_t* store, const char* id, uint32_t id_len) {
+    store_index_entry_t* entry = store_index_find(store, store_hash(id, id_len), id, id_len, NULL);
+    if (!entry) {
+        return false;
+    }
+    store_segment_t* segment = store_find_segment(store, entry->segment);
+    if (segment) {
+        segment->live -= entry->size;
+    }
+    entry->hash = STORE_SLOT_DELETED;
+    store_index_header(store)->count--;
+    store_index_header(store)->deleted++;
+    return true;
+}
+
+// Start an empty table, then replay every segment in order
+static bool store_index_rebuild(olib_store_t* store) {
+    if (store->index_data) {
+        munmap(store->index_data, store->index_size);
+        store->index_data = NULL;
+    }
+    size_t size = store_index_bytes(STORE_MIN_CAPACITY);
+    // Truncating to zero first clears a stale table
+    if (ftruncate(store->index_fd, 0) != 0 || ftruncate(store->index_fd, (off_t)size) != 0 ||
+        !store_map_index(store, size)) {
+        return false;
+    }
+    store_index_header_t* header = store_index_header(store);
+    memcpy(header->magic, STORE_INDEX_MAGIC, 8);
+    header->capacity = STORE_MIN_CAPACITY;
+
+    for (size_t s = 0; s < store->segment_count; s++) {
+        store_segment_t* segment = store->segments[s];
+        segment->live = 0;
+        store_segment_header_t* seg_header = store_segment_header(segment);
+        uint64_t offset = sizeof(store_segment_header_t);
+        while (offset + sizeof(store_record_header_t) <= seg_header->end) {
+            store_record_header_t* record = store_record(segment, offset);
+            size_t record_size = store_record_size(record->id_len, record->value_len);
+            if (record->magic != STORE_RECORD_MAGIC || offset + record_size > seg_header->end) {
+                break;
+            }
+            const char* id = (const char*)(record + 1);
+            size_t value_len = record->value_len == STORE_TOMBSTONE ? 0 : record->value_len;
+            uint32_t checksum = store_checksum((const uint8_t*)id, record->id_len + value_len, 0x811c9dc5u);
+            if (checksum != record->checksum) {
+                break;
+            }
+            bool ok = record->value_len == STORE_TOMBSTONE
+                          ? (store_index_remove(store, id, record->id_len), true)
+                          : store_index_set(store, id, record->id_len, segment, offset, (uint32_t)record_size);
+            if (!ok) {
+                return false;
+            }
+            offset += record_size;
+        }
+        // Anything past the last valid record is a torn write, later appends overwrite it
+        seg_header->end = offset;
+    }
+    return true;
+}
+
+// #############################################################################
+// Records
+// #############################################################################
+
+static bool store_append(olib_store_t* store, const char* id, uint32_t id_len, const uint8_t* value,
+                         uint32_t value_len, store_segment_t** out_segment, uint64_t* out_offset, size_t* out_size) {
+    size_t size = store_record_size(id_len, value_len);
+    uint8_t* dst = store_reserve(store, size, out_segment, out_offset);
+    if (!dst) {
+        return false;
+    }
+    size_t stored_len = value_len == STORE_TOMBSTONE ? 0 : value_len;
+    store_record_header_t* record = (store_record_header_t*)dst;
+    record->magic = STORE_RECORD_MAGIC;
+    record->id_len = id_len;
+    record->value_len = value_len;
+    memcpy(dst + sizeof(store_record_header_t), id, id_len);
+    if (stored_len) {
+        memcpy(dst + sizeof(store_record_header_t) + id_len, value, stored_len);
+    }
+    record->checksum = store_checksum(dst + sizeof(store_record_header_t), id_len + stored_len, 0x811c9dc5u);
+    store_commit(*out_segment, size);
+    *out_size = size;
+    return true;
+}
+
+static olib_object_t* store_decode(olib_store_t* store, store_segment_t* segment, uint64_t offset) {
+    store_record_header_t* record = store_record(segment, offset);
+    const uint8_t* value = (const uint8_t*)(record + 1) + record->id_len;
+    return olib_serializer_read(store->serializer, value, record->value_len);
+}
+
+static bool store_lookup(olib_store_t* store, const char* id, store_location_t* out) {
+    size_t id_len = strlen(id);
+    if (id_len > UINT32_MAX) {
+        return false;
+    }
+    store_index_entry_t* entry = store_index_find(store, store_hash(id, id_len), id, (uint32_t)id_len, NULL);
+    if (!entry) {
+        return false;
+    }
+    out->segment = store_find_segment(store, entry->segment);
+    out->offset = entry->offset;
+    return out->segment != NULL;
+}
+
+// #############################################################################
+// Compaction
+// #############################################################################
+
+static bool store_is_candidate(olib_store_t* store, store_segment_t* segment) {
+    uint64_t used = store_segment_header(segment)->end - sizeof(store_segment_header_t);
+    return used > 0 && (double)(used - segment->live) >= store->compact_ratio * (double)used;
+}
+
+// Sealed segment that should be compacted next, or segment_count if there is none
+static size_t store_next_candidate(olib_store_t* store) {
+    for (size_t i = 0; i + 1 < store->segment_count; i++) {
+        if (store_is_candidate(store, store->segments[i])) {
+            return i;
+        }
+    }
+    return store->segment_count;
+}
+
+// Copy the live records of a sealed segment to the active one, then delete it.
+// A tombstone is only carried over while an older segment may still hold a put it
+// hides, and while no newer put for its id exists.
+static bool store_compact_segment(olib_store_t* store, size_t pos) {
+    store_segment_t* segment = store->segments[pos];
+    bool oldest = pos == 0;
+    uint64_t end = store_segment_header(segment)->end;
+    uint64_t offset = sizeof(store_segment_header_t);
+    while (offset < end) {
+        store_record_header_t* record = store_record(segment, offset);
+        size_t size = store_record_size(record->id_len, record->value_len);
+        const char* id = (const char*)(record + 1);
+        store_index_entry_t* entry = store_index_find(store, store_hash(id, record->id_len), id, record->id_len, NULL);
+        bool keep = record->value_len == STORE_TOMBSTONE
+                        ? !oldest && !entry
+                        : entry && entry->segment == segment->id && entry->offset == offset;
+        if (keep) {
+            store_segment_t* dst_segment;
+            uint64_t dst_offset;
+            uint8_t* dst = store_reserve(store, size, &dst_segment, &dst_offset);
+            if (!dst) {
+                return false;
+            }
+            memcpy(dst, record, size);
+            store_commit(dst_segment, size);
+            if (entry) {
+                entry->segment = dst_segment->id;
+                entry->offset = dst_offset;
+                segment->live -= size;
+                dst_segment->live += size;
+            }
+        }
+        offset += size;
+    }
+    store_drop_segment(store, pos);
+    return true;
+}
+
+static void store_compactor_main(void* ctx, size_t index) {
+    (void)index;
+    olib_store_t* store = (olib_store_t*)ctx;
+    for (;;) {
+        // One segment per lock hold, so reads and writes interleave with compaction.
+        // Closing waits for the remaining candidates too.
+        olib_thread_mutex_lock(store->mutex);
+        size_t pos = store_next_candidate(store);
+        if (pos == store->segment_count || !store_compact_segment(store, pos)) {
+            store->compactor_running = false;
+            olib_thread_mutex_unlock(store->mutex);
+            return;
+        }
+        olib_thread_mutex_unlock(store->mutex);
+    }
+}
+
+// Called with the mutex held after opening and after every write
+static void store_maybe_compact(olib_store_t* store) {
+    if (store->manual_compaction || store->compactor_running || store->closing ||
+        store_next_candidate(store) == store->segment_count) {
+        return;
+    }
+    // A previous compactor cleared compactor_running, so it is about to return
+    olib_thread_join(store->compactor);
+    store->compactor = olib_thread_start(store_compactor_main, store);
+    store->compactor_running = store->compactor != NULL;
+}
+
+// #############################################################################
+// Opening
+// #############################################################################
+
+static bool store_open_segments(olib_store_t* store) {
+    DIR* dir = opendir(store->directory);
+    if (!dir) {
+        return false;
+    }
+    struct dirent* ent;
+    bool ok = true;
+    while (ok && (ent = readdir(dir)) != NULL) {
+        unsigned id;
+        char tail;
+        if (sscanf(ent->d_name, "seg-%8u%c", &id, &tail) != 1) {
+            continue;
+        }
+        if (id >= store->next_segment_id) {
+            store->next_segment_id = id + 1;
+        }
+        char* path = store_path(store, ent->d_name);
+        int fd = path ? open(path, O_RDWR) : -1;
+        olib_free(path);
+        if (fd < 0) {
+            ok = false;
+            break;
+        }
+        // Files without a valid header never got a record, they are left for the next
+        // segment with that id to overwrite
+        store_segment_t* segment = store_map_segment(fd, id);
+        if (!segment) {
+            close(fd);
+            continue;
+        }
+        if (!store_push_segment(store, segment)) {
+            store_close_segment(segment);
+            ok = false;
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+
+static bool store_open_index(olib_store_t* store) {
+    char* path = store_path(store, "index");
+    if (!path) {
+        return false;
+    }
+    store->index_fd = open(path, O_RDWR | O_CREAT, 0644);
+    olib_free(path);
+    if (store->index_fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    bool valid = fstat(store->index_fd, &st) == 0 && (size_t)st.st_size >= sizeof(store_index_header_t) &&
+                 store_map_index(store, (size_t)st.st_size);
+    if (valid) {
+        store_index_header_t* header = store_index_header(store);
+        uint64_t capacity = header->capacity;
+        valid = memcmp(header->magic, STORE_INDEX_MAGIC, 8) == 0 && header->clean && capacity >= STORE_MIN_CAPACITY &&
+                (capacity & (capacity - 1)) == 0 && store_index_bytes(capacity) == store->index_size;
+    }
+
+    if (valid) {
+        // Live bytes per segment are not stored, they follow from the entries
+        store_index_header_t* header = store_index_header(store);
+        store_index_entry_t* entries = store_index_entries(store);
+        for (uint64_t i = 0; i < header->capacity; i++) {
+            if (entries[i].hash > STORE_SLOT_DELETED) {
+                store_segment_t* segment = store_find_segment(store, entries[i].segment);
+                if (!segment) {
+                    valid = false;
+                    break;
+                }
+                segment->live += entries[i].size;
+            }
+        }
+    }
+    if (!valid && !store_index_rebuild(store)) {
+        return false;
+    }
+
+    // Until close marks it clean again, a crash makes the next open rebuild
+    store_index_header(store)->clean = 0;
+    msync(store->index_data, sizeof(store_index_header_t), MS_SYNC);
+    return true;
+}
+
+static void store_release(olib_store_t* store) {
+    for (size_t i = 0; i < store->segment_count; i++) {
+        store_close_segment(store->segments[i]);
+    }
+    olib_free(store->segments);
+    if (store->index_data) {
+        munmap(store->index_data, store->index_size);
+    }
+    if (store->index_fd >= 0) {
+        close(store->index_fd);
+    }
+    olib_serializer_free(store->serializer);
+    olib_thread_mutex_free(store->mutex);
+    olib_free(store->directory);
+    olib_free(store);
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+OLIB_API olib_store_t* olib_store_open(const char* directory, const olib_store_options_t* options) {
+    if (!directory) {
+        return NULL;
+    }
+    olib_store_options_t defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        return NULL;
+    }
+
+    olib_store_t* store = olib_calloc(1, sizeof(olib_store_t));
+    if (!store) {
+        return NULL;
+    }
+    store->index_fd = -1;
+    store->next_segment_id = 1;
+    store->segment_size = options->segment_size ? options->segment_size : STORE_DEFAULT_SEGMENT;
+    if (store->segment_size < STORE_MIN_SEGMENT) {
+        store->segment_size = STORE_MIN_SEGMENT;
+    }
+    store->segment_size = store_page_align(store->segment_size);
+    store->compact_ratio = options->compact_ratio > 0.0 ? options->compact_ratio : STORE_DEFAULT_RATIO;
+    store->manual_compaction = options->manual_compaction;
+
+    size_t dir_len = strlen(directory);
+    store->directory = olib_malloc(dir_len + 1);
+    store->mutex = olib_thread_mutex_new();
+    store->serializer = olib_serializer_new_binary();
+    if (!store->directory || !store->mutex || !store->serializer) {
+        store_release(store);
+        return NULL;
+    }
+    memcpy(store->directory, directory, dir_len + 1);
+
+    if (!store_open_segments(store) || !store_open_index(store)) {
+        store_release(store);
+        return NULL;
+    }
+
+    // Dead records left by earlier sessions are reclaimed even if this one never writes
+    olib_thread_mutex_lock(store->mutex);
+    store_maybe_compact(store);
+    olib_thread_mutex_unlock(store->mutex);
+    return store;
+}
+
+OLIB_API void olib_store_close(olib_store_t* store) {
+    if (!store) {
+        return;
+    }
+    // No new compactor starts, a running one finishes every candidate first
+    olib_thread_mutex_lock(store->mutex);
+    store->closing = true;
+    olib_thread_mutex_unlock(store->mutex);
+    olib_thread_join(store->compactor);
+
+    if (olib_store_sync(store)) {
+        store_index_header(store)->clean = 1;
+        msync(store->index_data, sizeof(store_index_header_t), MS_SYNC);
+    }
+    store_release(store);
+}
+
+OLIB_API bool olib_store_put(olib_store_t* store, const char* id, olib_object_t* obj) {
+    if (!store || !id || !obj) {
+        return false;
+    }
+    size_t id_len = strlen(id);
+    if (id_len >= UINT32_MAX) {
+        return false;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    uint8_t* value = NULL;
+    size_t value_len = 0;
+    bool ok = olib_serializer_write(store->serializer, obj, &value, &value_len) && value_len < STORE_TOMBSTONE;
+    store_segment_t* segment;
+    uint64_t offset;
+    size_t size;
+    ok = ok && store_append(store, id, (uint32_t)id_len, value, (uint32_t)value_len, &segment, &offset, &size);
+    ok = ok && size <= UINT32_MAX && store_index_set(store, id, (uint32_t)id_len, segment, offset, (uint32_t)size);
+    if (ok) {
+        store_maybe_compact(store);
+    }
+    olib_thread_mutex_unlock(store->mutex);
+    olib_free(value);
+    return ok;
+}
+
+OLIB_API olib_object_t* olib_store_get(olib_store_t* store, const char* id) {
+    if (!store || !id) {
+        return NULL;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    store_location_t location;
+    olib_object_t* obj = store_lookup(store, id, &location) ? store_decode(store, location.segment, location.offset) : NULL;
+    olib_thread_mutex_unlock(store->mutex);
+    return obj;
+}
+
+OLIB_API bool olib_store_delete(olib_store_t* store, const char* id) {
+    if (!store || !id) {
+        return false;
+    }
+    size_t id_len = strlen(id);
+    if (id_len >= UINT32_MAX) {
+        return false;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    bool ok = store_index_find(store, store_hash(id, id_len), id, (uint32_t)id_len, NULL) != NULL;
+    if (ok) {
+        // The tombstone goes in before the entry is dropped, so the index never
+        // claims less than the segments replay to
+        store_segment_t* segment;
+        uint64_t offset;
+        size_t size;
+        ok = store_append(store, id, (uint32_t)id_len, NULL, STORE_TOMBSTONE, &segment, &offset, &size) &&
+             store_index_remove(store, id, (uint32_t)id_len);
+    }
+    if (ok) {
+        store_maybe_compact(store);
+    }
+    olib_thread_mutex_unlock(store->mutex);
+    return ok;
+}
+
+static int store_location_compare(const void* a, const void* b) {
+    const store_location_t* la = (const store_location_t*)a;
+    const store_location_t* lb = (const store_location_t*)b;
+    if (la->segment->id != lb->segment->id) {
+        return la->segment->id < lb->segment->id ? -1 : 1;
+    }
+    if (la->offset != lb->offset) {
+        return la->offset < lb->offset ? -1 : 1;
+    }
+    return 0;
+}
+
+OLIB_API size_t olib_store_get_batch(olib_store_t* store, const char* const* ids, size_t count, olib_object_t** out) {
+    if (!out) {
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = NULL;
+    }
+    if (!store || !ids || count == 0) {
+        return 0;
+    }
+    store_location_t* locations = olib_malloc(count * sizeof(store_location_t));
+    if (!locations) {
+        return 0;
+    }
+
+    olib_thread_mutex_lock(store->mutex);
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] && store_lookup(store, ids[i], &locations[found])) {
+            locations[found++].slot = i;
+        }
+    }
+    // Decoding in file order turns scattered page faults into a forward sweep
+    qsort(locations, found, sizeof(store_location_t), store_location_compare);
+    size_t decoded = 0;
+    for (size_t i = 0; i < found; i++) {
+        out[locations[i].slot] = store_decode(store, locations[i].segment, locations[i].offset);
+        if (out[locations[i].slot]) {
+            decoded++;
+        }
+    }
+    olib_thread_mutex_unlock(store->mutex);
+
+    olib_free(locations);
+    return decoded;
+}
+
+OLIB_API size_t olib_store_count(olib_store_t* store) {
+    if (!store) {
+        return 0;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    size_t count = (size_t)store_index_header(store)->count;
+    olib_thread_mutex_unlock(store->mutex);
+    return count;
+}
+
+OLIB_API size_t olib_store_segment_count(olib_store_t* store) {
+    if (!store) {
+        return 0;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    size_t count = store->segment_count;
+    olib_thread_mutex_unlock(store->mutex);
+    return count;
+}
+
+OLIB_API size_t olib_store_compact(olib_store_t* store) {
+    if (!store) {
+        return 0;
+    }
+    size_t compacted = 0;
+    olib_thread_mutex_lock(store->mutex);
+    for (;;) {
+        size_t pos = store_next_candidate(store);
+        if (pos == store->segment_count || !store_compact_segment(store, pos)) {
+            break;
+        }
+        compacted++;
+    }
+    olib_thread_mutex_unlock(store->mutex);
+    return compacted;
+}
+
+OLIB_API bool olib_store_sync(olib_store_t* store) {
+    if (!store) {
+        return false;
+    }
+    olib_thread_mutex_lock(store->mutex);
+    bool ok = true;
+    for (size_t i = 0; i < store->segment_count; i++) {
+        store_segment_t* segment = store->segments[i];
+        ok = msync(segment->data, (size_t)store_segment_header(segment)->end, MS_SYNC) == 0 && ok;
+    }
+    ok = msync(store->index_data, store->index_size, MS_SYNC) == 0 && ok;
+    olib_thread_mutex_unlock(store->mutex);
+    return ok;
+}
+
+#else
+
+// #############################################################################
+// Public API (unsupported platform)
+// #############################################################################
+
+OLIB_API olib_store_t* olib_store_open(const char* directory, const olib_store_options_t* options) {
+    (void)directory;
+    (void)options;
+    return NULL;
+}
+
+OLIB_API void olib_store_close(olib_store_t* store) {
+    (void)store;
+}
+
+OLIB_API bool olib_store_put(olib_store_t* store, const char* id, olib_object_t* obj) {
+    (void)store;
+    (void)id;
+    (void)obj;
+    return false;
+}
+
+OLIB_API olib_object_t* olib_store_get(olib_store_t* store, const char* id) {
+    (void)store;
+    (void)id;
+    return NULL;
+}
+
+OLIB_API bool olib_store_delete(olib_store_t* store, const char* id) {
+    (void)store;
+    (void)id;
+    return false;
+}
+
+OLIB_API size_t olib_store_get_batch(olib_store_t* store, const char* const* ids, size_t count, olib_object_t** out) {
+    (void)store;
+    (void)ids;
+    if (out) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = NULL;
+        }
+    }
+    return 0;
+}
+
+OLIB_API size_t olib_store_count(olib_store_t* store) {
+    (void)store;
+    return 0;
+}
+
+OLIB_API size_t olib_store_segment_count(olib_store_t* store) {
+    (void)store;
+    return 0;
+}
+
+OLIB_API size_t olib_store_compact(olib_store_t* store) {
+    (void)store;
+    return 0;
+}
+
+OLIB_API bool olib_store_sync(olib_store_t* store) {
+    (void)store;
+    return false;
+}
+
+#endif
@@ -0,0 +1,497 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_stream.h>
+#include "olib_stream_internal.h"
+#include <stdio.h>
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+struct olib_stream_filter_t {
+    olib_stream_filter_config_t config;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    // Where the output goes during a stream: the next filter or the chain sink
+    olib_stream_filter_t* next;
+    olib_stream_chain_t* chain;
+};
+
+struct olib_stream_chain_t {
+    olib_stream_filter_t** filters;
+    size_t size;
+    size_t capacity;
+    olib_stream_emit_fn sink;
+    void* sink_ctx;
+    bool running;
+};
+
+// #############################################################################
+// Sinks
+// #############################################################################
+
+bool olib_stream_buffer_emit(void* emit_ctx, const uint8_t* data, size_t size) {
+    olib_stream_buffer_t* buffer = (olib_stream_buffer_t*)emit_ctx;
+    if (size > buffer->capacity - buffer->size) {
+        if (size > SIZE_MAX / 2 - buffer->size) {
+            return false;
+        }
+        size_t new_capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (new_capacity < buffer->size + size) {
+            new_capacity *= 2;
+        }
+        uint8_t* new_data = olib_realloc(buffer->data, new_capacity);
+        if (!new_data) {
+            return false;
+        }
+        buffer->data = new_data;
+        buffer->capacity = new_capacity;
+    }
+    if (size > 0) {
+        memcpy(buffer->data + buffer->size, data, size);
+        buffer->size += size;
+    }
+    return true;
+}
+
+bool olib_stream_file_emit(void* emit_ctx, const uint8_t* data, size_t size) {
+    return fwrite(data, 1, size, (FILE*)emit_ctx) == size;
+}
+
+// #############################################################################
+// Filters
+// #############################################################################
+
+OLIB_API olib_stream_filter_t* olib_stream_filter_new(olib_stream_filter_config_t* config) {
+    if (!config || !config->process) {
+        return NULL;
+    }
+    olib_stream_filter_t* filter = olib_calloc(1, sizeof(olib_stream_filter_t));
+    if (!filter) {
+        return NULL;
+    }
+    filter->config = *config;
+    return filter;
+}
+
+OLIB_API void olib_stream_filter_free(olib_stream_filter_t* filter) {
+    if (!filter) {
+        return;
+    }
+    if (filter->config.free_ctx) {
+        filter->config.free_ctx(filter->config.user_data);
+    }
+    olib_free(filter);
+}
+
+OLIB_API uint64_t olib_stream_filter_bytes_in(olib_stream_filter_t* filter) {
+    return filter ? filter->bytes_in : 0;
+}
+
+OLIB_API uint64_t olib_stream_filter_bytes_out(olib_stream_filter_t* filter) {
+    return filter ? filter->bytes_out : 0;
+}
+
+// Emit callback handed to every filter, forwards to the next stage
+static bool stream_emit(void* emit_ctx, const uint8_t* data, size_t size);
+
+static bool stream_push(olib_stream_filter_t* filter, const uint8_t* data, size_t size) {
+    filter->bytes_in += size;
+    return filter->config.process(filter->config.user_data, data, size, stream_emit, filter);
+}
+
+static bool stream_emit(void* emit_ctx, const uint8_t* data, size_t size) {
+    olib_stream_filter_t* filter = (olib_stream_filter_t*)emit_ctx;
+    if (size == 0) {
+        return true;
+    }
+    filter->bytes_out += size;
+    if (filter->next) {
+        return stream_push(filter->next, data, size);
+    }
+    return filter->chain->sink(filter->chain->sink_ctx, data, size);
+}
+
+// #############################################################################
+// Built-in filters
+// #############################################################################
+
+static bool counter_process(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx) {
+    (void)ctx;
+    return emit(emit_ctx, data, size);
+}
+
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_counter() {
+    olib_stream_filter_config_t config = {
+        .process = counter_process,
+    };
+    return olib_stream_filter_new(&config);
+}
+
+typedef struct {
+    uint32_t table[256];
+    uint32_t crc;
+} crc32_ctx_t;
+
+static bool crc32_reset(void* ctx) {
+    ((crc32_ctx_t*)ctx)->crc = 0xFFFFFFFFu;
+    return true;
+}
+
+static bool crc32_process(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx) {
+    crc32_ctx_t* c = (crc32_ctx_t*)ctx;
+    uint32_t crc = c->crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = c->table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    c->crc = crc;
+    return emit(emit_ctx, data, size);
+}
+
+static void crc32_free(void* ctx) {
+    olib_free(ctx);
+}
+
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_crc32() {
+    crc32_ctx_t* ctx = olib_malloc(sizeof(crc32_ctx_t));
+    if (!ctx) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++) {
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+        }
+        ctx->table[i] = value;
+    }
+    crc32_reset(ctx);
+
+    olib_stream_filter_config_t config = {
+        .user_data = ctx,
+        .free_ctx = crc32_free,
+        .reset = crc32_reset,
+        .process = crc32_process,
+    };
+    olib_stream_filter_t* filter = olib_stream_filter_new(&config);
+    if (!filter) {
+        olib_free(ctx);
+    }
+    return filter;
+}
+
+OLIB_API uint32_t olib_stream_filter_crc32_value(olib_stream_filter_t* filter) {
+    if (!filter || filter->config.process != crc32_process) {
+        return 0;
+    }
+    return ((crc32_ctx_t*)filter->config.user_data)->crc ^ 0xFFFFFFFFu;
+}
+
+static const char g_base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Shared by both directions: bytes carried over between blocks and an output chunk
+typedef struct {
+    uint8_t pending[4];
+    size_t pending_size;
+    bool padded;  // Decoder saw '=', only whitespace may follow
+    uint8_t out[4096];
+} base64_ctx_t;
+
+static bool base64_reset(void* ctx) {
+    base64_ctx_t* c = (base64_ctx_t*)ctx;
+    c->pending_size = 0;
+    c->padded = false;
+    return true;
+}
+
+static void base64_free(void* ctx) {
+    olib_free(ctx);
+}
+
+static void base64_encode_group(const uint8_t* in, size_t size, uint8_t* out) {
+    uint32_t group = (uint32_t)in[0] << 16;
+    if (size > 1) group |= (uint32_t)in[1] << 8;
+    if (size > 2) group |= in[2];
+    out[0] = (uint8_t)g_base64_alphabet[(group >> 18) & 0x3F];
+    out[1] = (uint8_t)g_base64_alphabet[(group >> 12) & 0x3F];
+    out[2] = size > 1 ? (uint8_t)g_base64_alphabet[(group >> 6) & 0x3F] : '=';
+    out[3] = size > 2 ? (uint8_t)g_base64_alphabet[group & 0x3F] : '=';
+}
+
+static bool base64_encode_process(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx) {
+    base64_ctx_t* c = (base64_ctx_t*)ctx;
+    size_t out_size = 0;
+    size_t i = 0;
+
+    // Complete the group left over from the previous block
+    while (c->pending_size > 0 && c->pending_size < 3 && i < size) {
+        c->pending[c->pending_size++] = data[i++];
+    }
+    if (c->pending_size == 3) {
+        base64_encode_group(c->pending, 3, c->out);
+        out_size = 4;
+        c->pending_size = 0;
+    }
+
+    for (; size - i >= 3; i += 3) {
+        if (out_size == sizeof(c->out)) {
+            if (!emit(emit_ctx, c->out, out_size)) return false;
+            out_size = 0;
+        }
+        base64_encode_group(data + i, 3, c->out + out_size);
+        out_size += 4;
+    }
+    while (i < size) {
+        c->pending[c->pending_size++] = data[i++];
+    }
+    return emit(emit_ctx, c->out, out_size);
+}
+
+static bool base64_encode_finish(void* ctx, olib_stream_emit_fn emit, void* emit_ctx) {
+    base64_ctx_t* c = (base64_ctx_t*)ctx;
+    if (c->pending_size == 0) {
+        return true;
+    }
+    base64_encode_group(c->pending, c->pending_size, c->out);
+    c->pending_size = 0;
+    return emit(emit_ctx, c->out, 4);
+}
+
+static int base64_value(uint8_t ch) {
+    if (ch >= 'A' && ch <= 'Z') return ch - 'A';
+    if (ch >= 'a' && ch <= 'z') return ch - 'a' + 26;
+    if (ch >= '0' && ch <= '9') return ch - '0' + 52;
+    if (ch == '+') return 62;
+    if (ch == '/') return 63;
+    return -1;
+}
+
+static bool base64_decode_process(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx) {
+    base64_ctx_t* c = (base64_ctx_t*)ctx;
+    size_t out_size = 0;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t ch = data[i];
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            continue;
+        }
+        if (c->padded && ch != '=') {
+            return false;
+        }
+        if (ch != '=' && base64_value(ch) < 0) {
+            return false;
+        }
+        // Padding can only fill the last two places of a group
+        if (ch == '=' && c->pending_size < 2) {
+            return false;
+        }
+        if (ch == '=') {
+            c->padded = true;
+        }
+        c->pending[c->pending_size++] = ch;
+        if (c->pending_size < 4) {
+            continue;
+        }
+
+        if (out_size + 3 > sizeof(c->out)) {
+            if (!emit(emit_ctx, c->out, out_size)) return false;
+            out_size = 0;
+        }
+        uint32_t group = 0;
+        size_t bytes = 3;
+        for (int k = 0; k < 4; k++) {
+            if (c->pending[k] == '=') {
+                bytes = k == 2 ? 1 : 2;
+                if (k == 2 && c->pending[3] != '=') return false;
+                group <<= 6 * (4 - k);
+                break;
+            }
+            group = (group << 6) | (uint32_t)base64_value(c->pending[k]);
+        }
+        c->out[out_size++] = (uint8_t)(group >> 16);
+        if (bytes > 1) c->out[out_size++] = (uint8_t)(group >> 8);
+        if (bytes > 2) c->out[out_size++] = (uint8_t)group;
+        c->pending_size = 0;
+    }
+    return emit(emit_ctx, c->out, out_size);
+}
+
+static bool base64_decode_finish(void* ctx, olib_stream_emit_fn emit, void* emit_ctx) {
+    (void)emit;
+    (void)emit_ctx;
+    // Input must end on a whole group
+    return ((base64_ctx_t*)ctx)->pending_size == 0;
+}
+
+static olib_stream_filter_t* base64_filter_new(bool encode) {
+    base64_ctx_t* ctx = olib_calloc(1, sizeof(base64_ctx_t));
+    if (!ctx) {
+        return NULL;
+    }
+    olib_stream_filter_config_t config = {
+        .user_data = ctx,
+        .free_ctx = base64_free,
+        .reset = base64_reset,
+        .process = encode ? base64_encode_process : base64_decode_process,
+        .finish = encode ? base64_encode_finish : base64_decode_finish,
+    };
+    olib_stream_filter_t* filter = olib_stream_filter_new(&config);
+    if (!filter) {
+        olib_free(ctx);
+    }
+    return filter;
+}
+
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_base64_encode() {
+    return base64_filter_new(true);
+}
+
+OLIB_API olib_stream_filter_t* olib_stream_filter_new_base64_decode() {
+    return base64_filter_new(false);
+}
+
+// #############################################################################
+// Chains
+// #############################################################################
+
+OLIB_API olib_stream_chain_t* olib_stream_chain_new() {
+    return olib_calloc(1, sizeof(olib_stream_chain_t));
+}
+
+OLIB_API void olib_stream_chain_free(olib_stream_chain_t* chain) {
+    if (!chain) {
+        return;
+    }
+    for (size_t i = 0; i < chain->size; i++) {
+        olib_stream_filter_free(chain->filters[i]);
+    }
+    olib_free(chain->filters);
+    olib_free(chain);
+}
+
+OLIB_API bool olib_stream_chain_push(olib_stream_chain_t* chain, olib_stream_filter_t* filter) {
+    if (!chain || !filter || filter->chain || chain->running) {
+        return false;
+    }
+    if (chain->size == chain->capacity) {
+        size_t new_capacity = chain->capacity ? chain->capacity * 2 : 4;
+        olib_stream_filter_t** new_filters = olib_realloc(chain->filters, new_capacity * sizeof(olib_stream_filter_t*));
+        if (!new_filters) {
+            return false;
+        }
+        chain->filters = new_filters;
+        chain->capacity = new_capacity;
+    }
+    filter->chain = chain;
+    if (chain->size > 0) {
+        chain->filters[chain->size - 1]->next = filter;
+    }
+    chain->filters[chain->size++] = filter;
+    return true;
+}
+
+OLIB_API size_t olib_stream_chain_size(olib_stream_chain_t* chain) {
+    return chain ? chain->size : 0;
+}
+
+OLIB_API olib_stream_filter_t* olib_stream_chain_get(olib_stream_chain_t* chain, size_t index) {
+    if (!chain || index >= chain->size) {
+        return NULL;
+    }
+    return chain->filters[index];
+}
+
+OLIB_API bool olib_stream_chain_begin(olib_stream_chain_t* chain, olib_stream_emit_fn sink, void* sink_ctx) {
+    if (!chain || !sink) {
+        return false;
+    }
+    chain->sink = sink;
+    chain->sink_ctx = sink_ctx;
+    chain->running = true;
+    for (size_t i = 0; i < chain->size; i++) {
+        olib_stream_filter_t* filter = chain->filters[i];
+        filter->bytes_in = 0;
+        filter->bytes_out = 0;
+        if (filter->config.reset && !filter->config.reset(filter->config.user_data)) {
+            chain->running = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+OLIB_API bool olib_stream_chain_write(olib_stream_chain_t* chain, const uint8_t* data, size_t size) {
+    if (!chain || !chain->running || (!data && size > 0)) {
+        return false;
+    }
+    while (size > 0) {
+        size_t block = size < OLIB_STREAM_BLOCK_SIZE ? size : OLIB_STREAM_BLOCK_SIZE;
+        bool ok = chain->size > 0 ? stream_push(chain->filters[0], data, block)
+                                  : chain->sink(chain->sink_ctx, data, block);
+        if (!ok) {
+            chain->running = false;
+            return false;
+        }
+        data += block;
+        size -= block;
+    }
+    return true;
+}
+
+OLIB_API bool olib_stream_chain_end(olib_stream_chain_t* chain) {
+    if (!chain || !chain->running) {
+        return false;
+    }
+    chain->running = false;
+    // Each flush can emit into the filters after it, so go front to back
+    for (size_t i = 0; i < chain->size; i++) {
+        olib_stream_filter_t* filter = chain->filters[i];
+        if (filter->config.finish && !filter->config.finish(filter->config.user_data, stream_emit, filter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OLIB_API bool olib_stream_chain_apply(olib_stream_chain_t* chain, const uint8_t* data, size_t size, uint8_t** out_data, size_t* out_size) {
+    if (!chain || (!data && size > 0) || !out_data || !out_size) {
+        return false;
+    }
+    olib_stream_buffer_t buffer = {0};
+    bool ok = olib_stream_chain_begin(chain, olib_stream_buffer_emit, &buffer) &&
+              olib_stream_chain_write(chain, data, size) &&
+              olib_stream_chain_end(chain);
+    // Keep the result non-NULL for empty output
+    if (ok && !buffer.data) {
+        buffer.data = olib_malloc(1);
+        ok = buffer.data != NULL;
+    }
+    if (!ok) {
+        olib_free(buffer.data);
+        return false;
+    }
+    *out_data = buffer.data;
+    *out_size = buffer.size;
+    return true;
+}
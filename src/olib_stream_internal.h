@@ -0,0 +1,53 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_stream.h>
+#include <string.h>
+
+// Stream sinks shared between the library sources. Not part of the public API.
+
+// Growable memory sink for olib_stream_chain_begin
+typedef struct olib_stream_buffer_t {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} olib_stream_buffer_t;
+
+// olib_stream_emit_fn appending to an olib_stream_buffer_t
+bool olib_stream_buffer_emit(void* emit_ctx, const uint8_t* data, size_t size);
+
+// Append to an olib_stream_buffer_t, copying inline when the data fits
+static inline bool olib_stream_buffer_append(olib_stream_buffer_t* buffer, const void* data, size_t size) {
+    if (size <= buffer->capacity - buffer->size) {
+        memcpy(buffer->data + buffer->size, data, size);
+        buffer->size += size;
+        return true;
+    }
+    return olib_stream_buffer_emit(buffer, (const uint8_t*)data, size);
+}
+
+// olib_stream_emit_fn writing to a FILE*
+bool olib_stream_file_emit(void* emit_ctx, const uint8_t* data, size_t size);
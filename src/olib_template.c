@@ -0,0 +1,356 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_template.h>
+#include <olib/olib_helpers.h>
+#include "olib_object_internal.h"
+#include "olib_stream_internal.h"
+#include "formats/text_scalars.h"
+#include <stdlib.h>
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct olib_template_slot_t {
+    size_t index;   // Position of the scalar in a preorder walk of the shape
+    size_t offset;  // Start of the sample value in the sample output
+    size_t size;    // Length of the sample value
+} olib_template_slot_t;
+
+struct olib_template_t {
+    text_scalar_fn scalar;
+    olib_object_t* shape;     // Copy of the shape, keys and types are checked on render
+    uint8_t* statics;         // Static fragments back to back
+    size_t statics_size;
+    size_t* fragment_ends;    // End of the fragment emitted before slot i, in statics
+    size_t* slot_order;       // Preorder index of the value emitted after fragment i
+    size_t slot_count;
+};
+
+// Slot values are gathered on the stack up to this count, larger templates allocate
+#define OLIB_TEMPLATE_STACK_SLOTS 64
+
+// #############################################################################
+// Compiling
+// #############################################################################
+
+static text_scalar_fn template_scalar_fn(olib_format_t format) {
+    switch (format) {
+        case OLIB_FORMAT_JSON_TEXT: return json_text_template_scalar;
+        case OLIB_FORMAT_YAML: return yaml_template_scalar;
+        case OLIB_FORMAT_XML: return xml_template_scalar;
+        case OLIB_FORMAT_TOML: return toml_template_scalar;
+        case OLIB_FORMAT_TXT: return text_template_scalar;
+        default: return NULL;
+    }
+}
+
+static bool template_is_scalar(olib_object_type_t type) {
+    return type == OLIB_OBJECT_TYPE_INT || type == OLIB_OBJECT_TYPE_UINT || type == OLIB_OBJECT_TYPE_FLOAT ||
+           type == OLIB_OBJECT_TYPE_STRING || type == OLIB_OBJECT_TYPE_BOOL;
+}
+
+// Collect the scalars of obj in preorder, fails on missing children
+static bool template_collect(olib_object_t* obj, olib_object_t*** slots, size_t* count, size_t* capacity) {
+    if (!obj) {
+        return false;
+    }
+    if (template_is_scalar(obj->type)) {
+        if (*count == *capacity) {
+            size_t new_capacity = *capacity ? *capacity * 2 : 16;
+            olib_object_t** new_slots = olib_realloc(*slots, new_capacity * sizeof(olib_object_t*));
+            if (!new_slots) {
+                return false;
+            }
+            *slots = new_slots;
+            *capacity = new_capacity;
+        }
+        (*slots)[(*count)++] = obj;
+        return true;
+    }
+    if (obj->type == OLIB_OBJECT_TYPE_LIST) {
+        for (size_t i = 0; i < obj->data.list.size; i++) {
+            if (!template_collect(obj->data.list.items[i], slots, count, capacity)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (obj->type == OLIB_OBJECT_TYPE_STRUCT) {
+        for (size_t i = 0; i < obj->data.object.size; i++) {
+            if (!template_collect(obj->data.object.entries[i].value, slots, count, capacity)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+// Set one of two sample values. The samples of a type differ, so the first byte where
+// two writes differ lies inside the changed slot.
+static bool template_set_sample(olib_object_t* obj, bool alternate) {
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_INT: return olib_object_set_int(obj, alternate ? 2 : 1);
+        case OLIB_OBJECT_TYPE_UINT: return olib_object_set_uint(obj, alternate ? 2 : 1);
+        case OLIB_OBJECT_TYPE_FLOAT: return olib_object_set_float(obj, alternate ? 2.5 : 1.5);
+        case OLIB_OBJECT_TYPE_STRING: return olib_object_set_string(obj, alternate ? "b" : "a");
+        case OLIB_OBJECT_TYPE_BOOL: return olib_object_set_bool(obj, !alternate);
+        default: return false;
+    }
+}
+
+static int template_slot_compare(const void* a, const void* b) {
+    const olib_template_slot_t* sa = (const olib_template_slot_t*)a;
+    const olib_template_slot_t* sb = (const olib_template_slot_t*)b;
+    return (sa->offset > sb->offset) - (sa->offset < sb->offset);
+}
+
+// Find where slot sits in base by writing the shape again with its alternate sample
+static bool template_locate_slot(olib_template_t* tmpl, olib_serializer_t* serializer, olib_object_t* slot,
+                                 const char* base, size_t base_size, olib_template_slot_t* out) {
+    // Encode both samples to know their length and how many leading bytes they share
+    olib_stream_buffer_t samples = {0};
+    bool ok = tmpl->scalar(&samples, slot);
+    size_t sample_size = samples.size;
+    ok = ok && template_set_sample(slot, true) && tmpl->scalar(&samples, slot);
+    size_t alternate_size = samples.size - sample_size;
+
+    char* variant = NULL;
+    ok = ok && olib_serializer_write_string(serializer, tmpl->shape, &variant);
+    ok = template_set_sample(slot, false) && ok;
+    if (ok) {
+        size_t shared = 0;
+        while (shared < sample_size && shared < alternate_size &&
+               samples.data[shared] == samples.data[sample_size + shared]) {
+            shared++;
+        }
+        size_t variant_size = strlen(variant);
+        size_t diff = 0;
+        while (diff < base_size && diff < variant_size && base[diff] == variant[diff]) {
+            diff++;
+        }
+        ok = diff >= shared && diff - shared + sample_size <= base_size &&
+             memcmp(base + diff - shared, samples.data, sample_size) == 0;
+        out->offset = diff - shared;
+        out->size = sample_size;
+    }
+    olib_free(variant);
+    olib_free(samples.data);
+    return ok;
+}
+
+static bool template_build(olib_template_t* tmpl, olib_format_t format, olib_object_t** slots) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+    olib_template_slot_t* located = olib_calloc(tmpl->slot_count ? tmpl->slot_count : 1, sizeof(olib_template_slot_t));
+    char* base = NULL;
+    bool ok = located != NULL;
+    for (size_t i = 0; ok && i < tmpl->slot_count; i++) {
+        ok = template_set_sample(slots[i], false);
+    }
+    ok = ok && olib_serializer_write_string(serializer, tmpl->shape, &base);
+    size_t base_size = ok ? strlen(base) : 0;
+
+    // One extra write per slot, compiling is meant to happen once per shape
+    for (size_t i = 0; ok && i < tmpl->slot_count; i++) {
+        located[i].index = i;
+        ok = template_locate_slot(tmpl, serializer, slots[i], base, base_size, &located[i]);
+    }
+
+    // The writer may emit values out of tree order (TOML writes tables last)
+    if (ok && tmpl->slot_count > 1) {
+        qsort(located, tmpl->slot_count, sizeof(olib_template_slot_t), template_slot_compare);
+    }
+
+    if (ok) {
+        tmpl->statics = olib_malloc(base_size ? base_size : 1);
+        tmpl->fragment_ends = olib_malloc((tmpl->slot_count + 1) * sizeof(size_t));
+        tmpl->slot_order = olib_malloc((tmpl->slot_count + 1) * sizeof(size_t));
+        ok = tmpl->statics && tmpl->fragment_ends && tmpl->slot_order;
+    }
+    size_t position = 0;
+    for (size_t i = 0; ok && i < tmpl->slot_count; i++) {
+        if (located[i].offset < position) {
+            ok = false;
+            break;
+        }
+        size_t fragment = located[i].offset - position;
+        memcpy(tmpl->statics + tmpl->statics_size, base + position, fragment);
+        tmpl->statics_size += fragment;
+        tmpl->fragment_ends[i] = tmpl->statics_size;
+        tmpl->slot_order[i] = located[i].index;
+        position = located[i].offset + located[i].size;
+    }
+    if (ok) {
+        memcpy(tmpl->statics + tmpl->statics_size, base + position, base_size - position);
+        tmpl->statics_size += base_size - position;
+    }
+
+    olib_free(base);
+    olib_free(located);
+    olib_serializer_free(serializer);
+    return ok;
+}
+
+OLIB_API olib_template_t* olib_template_compile(olib_object_t* shape, olib_format_t format) {
+    text_scalar_fn scalar = template_scalar_fn(format);
+    if (!shape || !scalar) {
+        return NULL;
+    }
+    olib_template_t* tmpl = olib_calloc(1, sizeof(olib_template_t));
+    if (!tmpl) {
+        return NULL;
+    }
+    tmpl->scalar = scalar;
+    tmpl->shape = olib_object_dupe(shape);
+
+    olib_object_t** slots = NULL;
+    size_t capacity = 0;
+    bool ok = tmpl->shape && template_collect(tmpl->shape, &slots, &tmpl->slot_count, &capacity) &&
+              template_build(tmpl, format, slots);
+    olib_free(slots);
+    if (!ok) {
+        olib_template_free(tmpl);
+        return NULL;
+    }
+    return tmpl;
+}
+
+OLIB_API void olib_template_free(olib_template_t* tmpl) {
+    if (!tmpl) {
+        return;
+    }
+    olib_object_free(tmpl->shape);
+    olib_free(tmpl->statics);
+    olib_free(tmpl->fragment_ends);
+    olib_free(tmpl->slot_order);
+    olib_free(tmpl);
+}
+
+OLIB_API size_t olib_template_slot_count(olib_template_t* tmpl) {
+    return tmpl ? tmpl->slot_count : 0;
+}
+
+// #############################################################################
+// Rendering
+// #############################################################################
+
+// Check that values has the shape and gather its scalars in preorder
+static bool template_match(olib_object_t* shape, olib_object_t* values, olib_object_t** slots, size_t* count) {
+    if (!values || values->type != shape->type) {
+        return false;
+    }
+    switch (shape->type) {
+        case OLIB_OBJECT_TYPE_LIST:
+            if (values->data.list.size != shape->data.list.size) {
+                return false;
+            }
+            for (size_t i = 0; i < shape->data.list.size; i++) {
+                if (!template_match(shape->data.list.items[i], values->data.list.items[i], slots, count)) {
+                    return false;
+                }
+            }
+            return true;
+        case OLIB_OBJECT_TYPE_STRUCT:
+            if (values->data.object.size != shape->data.object.size) {
+                return false;
+            }
+            for (size_t i = 0; i < shape->data.object.size; i++) {
+                olib_struct_entry_t* expected = &shape->data.object.entries[i];
+                olib_struct_entry_t* actual = &values->data.object.entries[i];
+                if (strcmp(expected->key, actual->key) != 0 ||
+                    !template_match(expected->value, actual->value, slots, count)) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            slots[(*count)++] = values;
+            return true;
+    }
+}
+
+static bool template_render_buffer(olib_template_t* tmpl, olib_object_t* values, olib_stream_buffer_t* out) {
+    olib_object_t* stack_slots[OLIB_TEMPLATE_STACK_SLOTS];
+    olib_object_t** slots = stack_slots;
+    if (tmpl->slot_count > OLIB_TEMPLATE_STACK_SLOTS) {
+        slots = olib_malloc(tmpl->slot_count * sizeof(olib_object_t*));
+        if (!slots) {
+            return false;
+        }
+    }
+    size_t count = 0;
+    bool ok = template_match(tmpl->shape, values, slots, &count);
+
+    // Room for the fragments plus a typical scalar per slot, longer values grow the buffer
+    if (ok) {
+        out->capacity = tmpl->statics_size + tmpl->slot_count * 16 + 1;
+        out->data = olib_malloc(out->capacity);
+        ok = out->data != NULL;
+    }
+    size_t position = 0;
+    for (size_t i = 0; ok && i < tmpl->slot_count; i++) {
+        ok = olib_stream_buffer_append(out, tmpl->statics + position, tmpl->fragment_ends[i] - position) &&
+             tmpl->scalar(out, slots[tmpl->slot_order[i]]);
+        position = tmpl->fragment_ends[i];
+    }
+    ok = ok && olib_stream_buffer_append(out, tmpl->statics + position, tmpl->statics_size - position) &&
+         olib_stream_buffer_append(out, "", 1);
+
+    if (slots != stack_slots) {
+        olib_free(slots);
+    }
+    if (!ok) {
+        olib_free(out->data);
+        return false;
+    }
+    out->size--;
+    return true;
+}
+
+OLIB_API bool olib_template_render(olib_template_t* tmpl, olib_object_t* values, uint8_t** out_data, size_t* out_size) {
+    if (!tmpl || !values || !out_data || !out_size) {
+        return false;
+    }
+    olib_stream_buffer_t buffer = {0};
+    if (!template_render_buffer(tmpl, values, &buffer)) {
+        return false;
+    }
+    *out_data = buffer.data;
+    *out_size = buffer.size;
+    return true;
+}
+
+OLIB_API bool olib_template_render_string(olib_template_t* tmpl, olib_object_t* values, char** out_string) {
+    if (!out_string) {
+        return false;
+    }
+    size_t size = 0;
+    return olib_template_render(tmpl, values, (uint8_t**)out_string, &size);
+}
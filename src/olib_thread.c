@@ -0,0 +1,429 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "olib_thread.h"
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#  include <sched.h>
+#  include <unistd.h>
+#endif
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct {
+    void (*fn)(void* ctx, size_t index);
+    void* ctx;
+    size_t index;
+} olib_thread_job_t;
+
+#if defined(_WIN32)
+static DWORD WINAPI olib_thread_main(LPVOID arg) {
+    olib_thread_job_t* job = (olib_thread_job_t*)arg;
+    job->fn(job->ctx, job->index);
+    return 0;
+}
+typedef HANDLE olib_thread_handle_t;
+#else
+static void* olib_thread_main(void* arg) {
+    olib_thread_job_t* job = (olib_thread_job_t*)arg;
+    job->fn(job->ctx, job->index);
+    return NULL;
+}
+typedef pthread_t olib_thread_handle_t;
+#endif
+
+struct olib_thread_t {
+    olib_thread_job_t job;
+    olib_thread_handle_t handle;
+};
+
+struct olib_thread_mutex_t {
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+#if defined(_WIN32)
+static SRWLOCK g_olib_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t g_olib_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// #############################################################################
+// Threads
+// #############################################################################
+
+size_t olib_thread_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+void olib_thread_parallel_for(size_t count, void (*fn)(void* ctx, size_t index), void* ctx) {
+    if (count == 0) {
+        return;
+    }
+    olib_thread_job_t* jobs = count > 1 ? olib_malloc(count * sizeof(olib_thread_job_t)) : NULL;
+    olib_thread_handle_t* threads = count > 1 ? olib_malloc(count * sizeof(olib_thread_handle_t)) : NULL;
+    bool* started = count > 1 ? olib_calloc(count, sizeof(bool)) : NULL;
+    if (!jobs || !threads || !started) {
+        olib_free(jobs);
+        olib_free(threads);
+        olib_free(started);
+        for (size_t i = 0; i < count; i++) {
+            fn(ctx, i);
+        }
+        return;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        jobs[i].fn = fn;
+        jobs[i].ctx = ctx;
+        jobs[i].index = i;
+#if defined(_WIN32)
+        threads[i] = CreateThread(NULL, 0, olib_thread_main, &jobs[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = pthread_create(&threads[i], NULL, olib_thread_main, &jobs[i]) == 0;
+#endif
+    }
+    fn(ctx, 0);
+    for (size_t i = 1; i < count; i++) {
+        if (!started[i]) {
+            fn(ctx, i);
+            continue;
+        }
+#if defined(_WIN32)
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    olib_free(jobs);
+    olib_free(threads);
+    olib_free(started);
+}
+
+olib_thread_t* olib_thread_start(void (*fn)(void* ctx, size_t index), void* ctx) {
+    olib_thread_t* thread = olib_malloc(sizeof(olib_thread_t));
+    if (!thread) {
+        return NULL;
+    }
+    thread->job.fn = fn;
+    thread->job.ctx = ctx;
+    thread->job.index = 0;
+#if defined(_WIN32)
+    thread->handle = CreateThread(NULL, 0, olib_thread_main, &thread->job, 0, NULL);
+    bool started = thread->handle != NULL;
+#else
+    bool started = pthread_create(&thread->handle, NULL, olib_thread_main, &thread->job) == 0;
+#endif
+    if (!started) {
+        olib_free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void olib_thread_join(olib_thread_t* thread) {
+    if (!thread) {
+        return;
+    }
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    olib_free(thread);
+}
+
+// #############################################################################
+// Locks
+// #############################################################################
+
+void olib_thread_lock(void) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&g_olib_lock);
+#else
+    pthread_mutex_lock(&g_olib_lock);
+#endif
+}
+
+void olib_thread_unlock(void) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&g_olib_lock);
+#else
+    pthread_mutex_unlock(&g_olib_lock);
+#endif
+}
+
+olib_thread_mutex_t* olib_thread_mutex_new(void) {
+    olib_thread_mutex_t* mutex = olib_malloc(sizeof(olib_thread_mutex_t));
+    if (!mutex) {
+        return NULL;
+    }
+#if defined(_WIN32)
+    InitializeSRWLock(&mutex->lock);
+#else
+    if (pthread_mutex_init(&mutex->lock, NULL) != 0) {
+        olib_free(mutex);
+        return NULL;
+    }
+#endif
+    return mutex;
+}
+
+void olib_thread_mutex_free(olib_thread_mutex_t* mutex) {
+    if (!mutex) {
+        return;
+    }
+#if !defined(_WIN32)
+    pthread_mutex_destroy(&mutex->lock);
+#endif
+    olib_free(mutex);
+}
+
+void olib_thread_mutex_lock(olib_thread_mutex_t* mutex) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void olib_thread_mutex_unlock(olib_thread_mutex_t* mutex) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+// #############################################################################
+// Work-stealing pool
+// #############################################################################
+
+typedef struct {
+    olib_thread_task_fn fn;
+    void* task;
+    olib_thread_group_t* group;
+} olib_thread_task_t;
+
+typedef struct {
+    olib_thread_pool_t* pool;
+    size_t index;
+    olib_thread_t* thread;       // NULL for worker 0 and workers that failed to start
+    olib_thread_mutex_t* lock;   // Guards the deque
+    olib_thread_task_t* tasks;   // Deque, [head, tail) are queued
+    size_t head;
+    size_t tail;
+    size_t capacity;
+} olib_thread_worker_t;
+
+struct olib_thread_pool_t {
+    olib_thread_worker_t* workers;
+    size_t count;
+    olib_thread_mutex_t* lock;  // Guards the groups and stopping
+    bool stopping;
+};
+
+void olib_thread_yield(void) {
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// Take the newest task of the worker's own deque, or the oldest task of another worker
+static bool olib_thread_pool_take(olib_thread_pool_t* pool, size_t worker, olib_thread_task_t* out_task) {
+    for (size_t i = 0; i < pool->count; i++) {
+        olib_thread_worker_t* victim = &pool->workers[(worker + i) % pool->count];
+        olib_thread_mutex_lock(victim->lock);
+        bool found = victim->head < victim->tail;
+        if (found) {
+            *out_task = i == 0 ? victim->tasks[--victim->tail] : victim->tasks[victim->head++];
+            if (victim->head == victim->tail) {
+                victim->head = 0;
+                victim->tail = 0;
+            }
+        }
+        olib_thread_mutex_unlock(victim->lock);
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void olib_thread_pool_run(olib_thread_pool_t* pool, size_t worker, olib_thread_task_t* task) {
+    task->fn(pool, worker, task->task);
+    olib_thread_mutex_lock(pool->lock);
+    task->group->pending--;
+    olib_thread_mutex_unlock(pool->lock);
+}
+
+static void olib_thread_pool_main(void* ctx, size_t index) {
+    (void)index;
+    olib_thread_worker_t* worker = (olib_thread_worker_t*)ctx;
+    olib_thread_pool_t* pool = worker->pool;
+    for (;;) {
+        olib_thread_mutex_lock(pool->lock);
+        bool stopping = pool->stopping;
+        olib_thread_mutex_unlock(pool->lock);
+        if (stopping) {
+            return;
+        }
+        olib_thread_task_t task;
+        if (olib_thread_pool_take(pool, worker->index, &task)) {
+            olib_thread_pool_run(pool, worker->index, &task);
+        } else {
+            olib_thread_yield();
+        }
+    }
+}
+
+olib_thread_pool_t* olib_thread_pool_new(size_t threads) {
+    olib_thread_pool_t* pool = olib_calloc(1, sizeof(olib_thread_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->count = threads > 0 ? threads : 1;
+    pool->workers = olib_calloc(pool->count, sizeof(olib_thread_worker_t));
+    pool->lock = olib_thread_mutex_new();
+    bool ok = pool->workers && pool->lock;
+    for (size_t i = 0; ok && i < pool->count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pool->workers[i].lock = olib_thread_mutex_new();
+        ok = pool->workers[i].lock != NULL;
+    }
+    if (!ok) {
+        if (pool->workers) {
+            for (size_t i = 0; i < pool->count; i++) {
+                olib_thread_mutex_free(pool->workers[i].lock);
+            }
+            olib_free(pool->workers);
+        }
+        olib_thread_mutex_free(pool->lock);
+        olib_free(pool);
+        return NULL;
+    }
+
+    // Workers that fail to start leave an empty deque that nobody pushes to
+    for (size_t i = 1; i < pool->count; i++) {
+        pool->workers[i].thread = olib_thread_start(olib_thread_pool_main, &pool->workers[i]);
+    }
+    return pool;
+}
+
+void olib_thread_pool_free(olib_thread_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+    olib_thread_mutex_lock(pool->lock);
+    pool->stopping = true;
+    olib_thread_mutex_unlock(pool->lock);
+    // Workers still running may steal from any deque, so every lock outlives every worker
+    for (size_t i = 0; i < pool->count; i++) {
+        olib_thread_join(pool->workers[i].thread);
+    }
+    for (size_t i = 0; i < pool->count; i++) {
+        olib_thread_mutex_free(pool->workers[i].lock);
+        if (pool->workers[i].tasks) {
+            olib_free(pool->workers[i].tasks);
+        }
+    }
+    olib_free(pool->workers);
+    olib_thread_mutex_free(pool->lock);
+    olib_free(pool);
+}
+
+bool olib_thread_pool_push(olib_thread_pool_t* pool, size_t worker, olib_thread_group_t* group,
+                           olib_thread_task_fn fn, void* task) {
+    olib_thread_mutex_lock(pool->lock);
+    group->pending++;
+    olib_thread_mutex_unlock(pool->lock);
+
+    olib_thread_worker_t* self = &pool->workers[worker];
+    olib_thread_mutex_lock(self->lock);
+    bool ok = true;
+    if (self->tail == self->capacity) {
+        size_t capacity = self->capacity > 0 ? self->capacity * 2 : 64;
+        olib_thread_task_t* tasks = olib_realloc(self->tasks, capacity * sizeof(olib_thread_task_t));
+        ok = tasks != NULL;
+        if (ok) {
+            self->tasks = tasks;
+            self->capacity = capacity;
+        }
+    }
+    if (ok) {
+        olib_thread_task_t* slot = &self->tasks[self->tail++];
+        slot->fn = fn;
+        slot->task = task;
+        slot->group = group;
+    }
+    olib_thread_mutex_unlock(self->lock);
+
+    if (!ok) {
+        olib_thread_mutex_lock(pool->lock);
+        group->pending--;
+        olib_thread_mutex_unlock(pool->lock);
+    }
+    return ok;
+}
+
+void olib_thread_pool_wait(olib_thread_pool_t* pool, size_t worker, olib_thread_group_t* group) {
+    for (;;) {
+        olib_thread_mutex_lock(pool->lock);
+        bool done = group->pending == 0;
+        olib_thread_mutex_unlock(pool->lock);
+        if (done) {
+            return;
+        }
+        olib_thread_task_t task;
+        if (olib_thread_pool_take(pool, worker, &task)) {
+            olib_thread_pool_run(pool, worker, &task);
+        } else {
+            olib_thread_yield();
+        }
+    }
+}
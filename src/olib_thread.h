@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_base.h>
+
+// Minimal fork/join threading shared between the library sources. Not part of the public API.
+
+#if defined(_MSC_VER)
+#  define OLIB_THREAD_LOCAL __declspec(thread)
+#else
+#  define OLIB_THREAD_LOCAL _Thread_local
+#endif
+
+// Number of online CPUs (at least 1)
+size_t olib_thread_cpu_count(void);
+
+// Run fn(ctx, i) for every i in [0, count), one thread per index, and wait for all of them.
+// Index 0 runs on the calling thread. Indices whose thread fails to start run on the
+// calling thread afterwards, so every index always runs exactly once.
+void olib_thread_parallel_for(size_t count, void (*fn)(void* ctx, size_t index), void* ctx);
+
+// Start fn(ctx, 0) on a new thread, NULL if the thread could not be started.
+// Every started thread must be joined, which also frees it.
+typedef struct olib_thread_t olib_thread_t;
+olib_thread_t* olib_thread_start(void (*fn)(void* ctx, size_t index), void* ctx);
+void olib_thread_join(olib_thread_t* thread);
+
+// Library-wide lock for small pieces of global state, not reentrant
+void olib_thread_lock(void);
+void olib_thread_unlock(void);
+
+// Flag read without a lock, so a hot path can skip the lock while a feature is off. Accesses
+// are relaxed: a reader may see a change late, so the state the flag stands for is still
+// read under the lock once the flag is seen set.
+static inline bool olib_thread_flag_get(const bool* flag) {
+#if defined(_MSC_VER)
+    return *(const volatile bool*)flag;
+#else
+    return __atomic_load_n(flag, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void olib_thread_flag_set(bool* flag, bool value) {
+#if defined(_MSC_VER)
+    *(volatile bool*)flag = value;
+#else
+    __atomic_store_n(flag, value, __ATOMIC_RELAXED);
+#endif
+}
+
+// Lock owned by one object, not reentrant
+typedef struct olib_thread_mutex_t olib_thread_mutex_t;
+olib_thread_mutex_t* olib_thread_mutex_new(void);
+void olib_thread_mutex_free(olib_thread_mutex_t* mutex);
+void olib_thread_mutex_lock(olib_thread_mutex_t* mutex);
+void olib_thread_mutex_unlock(olib_thread_mutex_t* mutex);
+
+// Give up the rest of the time slice
+void olib_thread_yield(void);
+
+// Work-stealing pool for fork/join over irregular work. Every worker owns a deque: it pushes
+// and pops its own tasks at the back, idle workers steal from the front of the others. Worker
+// 0 is the thread that created the pool, it only runs tasks while waiting for a group.
+typedef struct olib_thread_pool_t olib_thread_pool_t;
+
+// Tasks pushed together and waited for together
+typedef struct olib_thread_group_t {
+    size_t pending;  // Tasks not finished yet, guarded by the pool
+} olib_thread_group_t;
+
+typedef void (*olib_thread_task_fn)(olib_thread_pool_t* pool, size_t worker, void* task);
+
+// Start threads - 1 workers, NULL if the pool could not be allocated
+olib_thread_pool_t* olib_thread_pool_new(size_t threads);
+
+// Stop and join the workers. Every group must have been waited for.
+void olib_thread_pool_free(olib_thread_pool_t* pool);
+
+// Queue fn(task) on the calling worker's deque as part of group. task must stay valid until
+// the group has been waited for. Returns false when the task could not be queued, the caller
+// then runs it itself.
+bool olib_thread_pool_push(olib_thread_pool_t* pool, size_t worker, olib_thread_group_t* group,
+                           olib_thread_task_fn fn, void* task);
+
+// Run tasks on the calling worker, its own first, until every task of group has finished
+void olib_thread_pool_wait(olib_thread_pool_t* pool, size_t worker, olib_thread_group_t* group);
@@ -0,0 +1,834 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <olib/olib_trace.h>
+#include <olib/olib_helpers.h>
+#include "olib_perf_internal.h"
+#include "olib_thread.h"
+#include "olib_trace_internal.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+// File layout: the magic and version, then one record after another:
+//   u8 op, u8 src_format, u8 dst_format, varint size, size bytes of data
+static const uint8_t g_trace_magic[4] = {'O', 'L', 'T', 'R'};
+#define OLIB_TRACE_VERSION 1
+
+// Header of one record, three bytes and the longest varint
+#define OLIB_TRACE_RECORD_HEADER_MAX 13
+
+struct olib_trace_t {
+    olib_trace_record_t* records;
+    size_t count;
+    uint8_t* payload;  // Data of every record, each null-terminated
+};
+
+static const char* g_trace_op_names[OLIB_TRACE_OP_MAX] = {
+    "read",
+    "write",
+    "convert",
+};
+
+OLIB_API const char* olib_trace_op_to_string(olib_trace_op_t op) {
+    if (op < 0 || op >= OLIB_TRACE_OP_MAX) {
+        return "unknown";
+    }
+    return g_trace_op_names[op];
+}
+
+// #############################################################################
+// Anonymization
+// #############################################################################
+
+static uint64_t olib_trace_hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t hash = 0xCBF29CE484222325ULL ^ seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// splitmix64, seeded from the value so equal values are rewritten the same way
+static uint64_t olib_trace_next(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Replace letters and digits in place, keeping their case and class. Punctuation,
+// whitespace and the structure of UTF-8 sequences are kept, so the text escapes and
+// tokenizes the same way.
+static void olib_trace_scramble(uint8_t* text, size_t size, uint64_t seed) {
+    uint64_t state = olib_trace_hash(text, size, seed);
+    for (size_t i = 0; i < size; i++) {
+        uint8_t c = text[i];
+        uint64_t r = olib_trace_next(&state);
+        if (c >= 'a' && c <= 'z') {
+            text[i] = (uint8_t)('a' + r % 26);
+        } else if (c >= 'A' && c <= 'Z') {
+            text[i] = (uint8_t)('A' + r % 26);
+        } else if (c >= '0' && c <= '9') {
+            text[i] = (uint8_t)('0' + r % 10);
+        } else if ((c & 0xC0) == 0x80 && i > 0) {
+            // The byte after these leads has a narrower range, leave it alone to stay valid UTF-8
+            uint8_t prev = text[i - 1];
+            bool restricted = prev == 0xE0 || prev == 0xED || prev == 0xF0 || prev == 0xF4;
+            if (!restricted) {
+                text[i] = (uint8_t)(0x80 | (r & 0x3F));
+            }
+        }
+    }
+}
+
+static uint64_t olib_trace_pow10(int digits) {
+    uint64_t value = 1;
+    for (int i = 0; i < digits; i++) {
+        value *= 10;
+    }
+    return value;
+}
+
+// Random magnitude with the same number of decimal digits, at most limit
+static uint64_t olib_trace_scramble_magnitude(uint64_t magnitude, uint64_t limit, uint64_t seed) {
+    if (magnitude == 0) {
+        return 0;
+    }
+    int digits = 1;
+    while (digits < 20 && magnitude >= olib_trace_pow10(digits)) {
+        digits++;
+    }
+    uint64_t low = olib_trace_pow10(digits - 1);
+    uint64_t high = digits < 20 ? olib_trace_pow10(digits) - 1 : UINT64_MAX;
+    if (high > limit) {
+        high = limit;
+    }
+    uint64_t state = olib_trace_hash(&magnitude, sizeof(magnitude), seed);
+    return low + olib_trace_next(&state) % (high - low + 1);
+}
+
+static int64_t olib_trace_scramble_int(int64_t value, uint64_t seed) {
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    uint64_t scrambled = olib_trace_scramble_magnitude(magnitude, (uint64_t)INT64_MAX, seed ^ (value < 0));
+    return value < 0 ? -(int64_t)scrambled : (int64_t)scrambled;
+}
+
+// Same sign, exponent and number of significant digits in the shortest form that reads back.
+// Writers printing %g keep the length. JSON text prints all 17 digits of a value without an
+// exact short decimal, so a scrambled value may print longer there than the original did.
+static double olib_trace_scramble_float(double value, uint64_t seed) {
+    if (!isfinite(value) || value == 0.0) {
+        return value;
+    }
+    char text[32];
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, NULL) == value) {
+            break;
+        }
+    }
+
+    uint64_t state = olib_trace_hash(&value, sizeof(value), seed);
+    bool leading = true;
+    for (char* p = text; *p && *p != 'e' && *p != 'E'; p++) {
+        if (*p < '0' || *p > '9') {
+            continue;
+        }
+        if (leading && *p == '0') {
+            continue;
+        }
+        uint64_t r = olib_trace_next(&state);
+        *p = leading ? (char)('1' + r % 9) : (char)('0' + r % 10);
+        leading = false;
+    }
+    double scrambled = strtod(text, NULL);
+    return isfinite(scrambled) ? scrambled : value;
+}
+
+// Scrambled copy of a string (caller must free with olib_free)
+static char* olib_trace_scramble_string(const char* value, uint64_t seed) {
+    size_t size = strlen(value);
+    char* copy = olib_malloc(size + 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, value, size + 1);
+    olib_trace_scramble((uint8_t*)copy, size, seed);
+    return copy;
+}
+
+// Copy of a tree with the same shape and rewritten values. Booleans and map keys are kept.
+static olib_object_t* olib_trace_anonymize(olib_object_t* obj, uint64_t seed) {
+    olib_object_type_t type = olib_object_get_type(obj);
+    olib_object_t* copy = olib_object_new(type);
+    if (!copy) {
+        return NULL;
+    }
+
+    bool ok = true;
+    switch (type) {
+        case OLIB_OBJECT_TYPE_INT:
+            ok = olib_object_set_int(copy, olib_trace_scramble_int(olib_object_get_int(obj), seed));
+            break;
+        case OLIB_OBJECT_TYPE_UINT:
+            ok = olib_object_set_uint(copy, olib_trace_scramble_magnitude(olib_object_get_uint(obj), UINT64_MAX, seed));
+            break;
+        case OLIB_OBJECT_TYPE_FLOAT:
+            ok = olib_object_set_float(copy, olib_trace_scramble_float(olib_object_get_float(obj), seed));
+            break;
+        case OLIB_OBJECT_TYPE_BOOL:
+            ok = olib_object_set_bool(copy, olib_object_get_bool(obj));
+            break;
+        case OLIB_OBJECT_TYPE_STRING: {
+            char* value = olib_trace_scramble_string(olib_object_get_string(obj), seed);
+            ok = value && olib_object_set_string(copy, value);
+            olib_free(value);
+            break;
+        }
+        case OLIB_OBJECT_TYPE_LIST:
+            for (size_t i = 0; ok && i < olib_object_list_size(obj); i++) {
+                olib_object_t* child = olib_trace_anonymize(olib_object_list_get(obj, i), seed);
+                ok = child && olib_object_list_push(copy, child);
+                if (!ok) {
+                    olib_object_free(child);
+                }
+            }
+            break;
+        case OLIB_OBJECT_TYPE_STRUCT:
+            for (size_t i = 0; ok && i < olib_object_struct_size(obj); i++) {
+                // Distinct keys must stay distinct, so collisions are scrambled again with another seed
+                const char* key_src = olib_object_struct_key_at(obj, i);
+                char* key = NULL;
+                for (uint64_t attempt = 0; attempt < 64; attempt++) {
+                    olib_free(key);
+                    key = olib_trace_scramble_string(key_src, seed + attempt);
+                    if (!key || !olib_object_struct_has(copy, key)) {
+                        break;
+                    }
+                }
+                olib_object_t* child = olib_trace_anonymize(olib_object_struct_value_at(obj, i), seed);
+                ok = key && child && olib_object_struct_add(copy, key, child);
+                if (!ok) {
+                    olib_object_free(child);
+                }
+                olib_free(key);
+            }
+            break;
+        case OLIB_OBJECT_TYPE_MAP:
+            for (size_t i = 0; ok && i < olib_object_map_size(obj); i++) {
+                olib_object_t* child = olib_trace_anonymize(olib_object_map_value_at(obj, i), seed);
+                ok = child && olib_object_map_set(copy, olib_object_map_key_at(obj, i), child);
+                if (!ok) {
+                    olib_object_free(child);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (!ok) {
+        olib_object_free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+// #############################################################################
+// Record encoding
+// #############################################################################
+
+static bool olib_trace_format_is_text(olib_format_t format) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    bool is_text = olib_serializer_is_text_based(serializer);
+    olib_serializer_free(serializer);
+    return is_text;
+}
+
+// Encode a tree in a format (caller must free out_data with olib_free)
+static bool olib_trace_encode(olib_format_t format, olib_object_t* tree, uint8_t** out_data, size_t* out_size) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer) {
+        return false;
+    }
+    bool result;
+    if (olib_serializer_is_text_based(serializer)) {
+        char* text = NULL;
+        result = olib_serializer_write_string(serializer, tree, &text);
+        *out_data = (uint8_t*)text;
+        *out_size = result ? strlen(text) : 0;
+    } else {
+        result = olib_serializer_write(serializer, tree, out_data, out_size);
+    }
+    olib_serializer_free(serializer);
+    return result;
+}
+
+// Decode input in a format, text formats get a null-terminated copy
+static olib_object_t* olib_trace_decode(olib_format_t format, const uint8_t* data, size_t size) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    if (!serializer || size == 0) {
+        olib_serializer_free(serializer);
+        return NULL;
+    }
+    olib_object_t* result = NULL;
+    if (olib_serializer_is_text_based(serializer)) {
+        char* text = olib_malloc(size + 1);
+        if (text) {
+            memcpy(text, data, size);
+            text[size] = '\0';
+            result = olib_serializer_read_string(serializer, text);
+            olib_free(text);
+        }
+    } else {
+        result = olib_serializer_read(serializer, data, size);
+    }
+    olib_serializer_free(serializer);
+    return result;
+}
+
+// Input rewritten for the trace (caller must free out_data with olib_free). Input that does
+// not parse is scrambled byte by byte instead, which keeps its size and punctuation.
+static bool olib_trace_anonymize_input(olib_format_t format, const uint8_t* data, size_t size, uint64_t seed,
+                                       uint8_t** out_data, size_t* out_size) {
+    olib_object_t* tree = olib_trace_decode(format, data, size);
+    olib_object_t* anonymized = tree ? olib_trace_anonymize(tree, seed) : NULL;
+    bool result = anonymized && olib_trace_encode(format, anonymized, out_data, out_size);
+    olib_object_free(anonymized);
+    olib_object_free(tree);
+    if (result || tree) {
+        return result;
+    }
+
+    uint8_t* copy = olib_malloc(size > 0 ? size : 1);
+    if (!copy) {
+        return false;
+    }
+    memcpy(copy, data, size);
+    olib_trace_scramble(copy, size, seed);
+    *out_data = copy;
+    *out_size = size;
+    return true;
+}
+
+static size_t olib_trace_put_varint(uint8_t* out, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (uint8_t)value;
+    return size;
+}
+
+static bool olib_trace_get_varint(const uint8_t* data, size_t size, size_t* pos, uint64_t* out_value) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && *pos < size; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *out_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// #############################################################################
+// Capture
+// #############################################################################
+
+// Guarded by olib_thread_lock
+static FILE* g_trace_file;
+static olib_trace_capture_config_t g_trace_config;
+static uint64_t g_trace_bytes;
+static uint64_t g_trace_count;
+static bool g_trace_full;
+static bool g_trace_failed;
+
+// Set while records are accepted (file open and not full), read without the lock
+static bool g_trace_capturing;
+
+// Traced calls on this thread, only the outermost one is recorded
+static OLIB_THREAD_LOCAL int g_trace_depth;
+
+OLIB_API bool olib_trace_capture_start(const char* file_path, const olib_trace_capture_config_t* config) {
+    if (!file_path) {
+        return false;
+    }
+    FILE* file = fopen(file_path, "wb");
+    if (!file) {
+        return false;
+    }
+    uint8_t header[5];
+    memcpy(header, g_trace_magic, sizeof(g_trace_magic));
+    header[4] = OLIB_TRACE_VERSION;
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        fclose(file);
+        return false;
+    }
+
+    olib_thread_lock();
+    FILE* previous = g_trace_file;
+    g_trace_file = file;
+    if (config) {
+        g_trace_config = *config;
+    } else {
+        memset(&g_trace_config, 0, sizeof(g_trace_config));
+    }
+    g_trace_bytes = sizeof(header);
+    g_trace_count = 0;
+    g_trace_full = false;
+    g_trace_failed = false;
+    olib_thread_flag_set(&g_trace_capturing, true);
+    olib_thread_unlock();
+
+    if (previous) {
+        fclose(previous);
+    }
+    return true;
+}
+
+OLIB_API bool olib_trace_capture_stop(void) {
+    olib_thread_lock();
+    FILE* file = g_trace_file;
+    bool failed = g_trace_failed;
+    g_trace_file = NULL;
+    olib_thread_flag_set(&g_trace_capturing, false);
+    olib_thread_unlock();
+
+    if (!file) {
+        return false;
+    }
+    return fclose(file) == 0 && !failed;
+}
+
+OLIB_API uint64_t olib_trace_capture_count(void) {
+    olib_thread_lock();
+    uint64_t count = g_trace_count;
+    olib_thread_unlock();
+    return count;
+}
+
+bool olib_trace_would_record(void) {
+    return g_trace_depth == 0 && olib_thread_flag_get(&g_trace_capturing);
+}
+
+void olib_trace_begin(olib_trace_scope_t* scope) {
+    scope->active = false;
+    if (g_trace_depth > 0 || !olib_thread_flag_get(&g_trace_capturing)) {
+        return;
+    }
+    olib_thread_lock();
+    scope->active = g_trace_file != NULL && !g_trace_full;
+    olib_thread_unlock();
+    if (scope->active) {
+        g_trace_depth++;
+    }
+}
+
+// Append one record, records that would cross max_bytes end the capture
+static void olib_trace_append(olib_trace_op_t op, olib_format_t src_format, olib_format_t dst_format,
+                              const uint8_t* data, size_t size) {
+    uint8_t header[OLIB_TRACE_RECORD_HEADER_MAX];
+    header[0] = (uint8_t)op;
+    header[1] = (uint8_t)src_format;
+    header[2] = (uint8_t)dst_format;
+    size_t header_size = 3 + olib_trace_put_varint(header + 3, size);
+
+    olib_thread_lock();
+    if (g_trace_file && !g_trace_full) {
+        uint64_t max_bytes = g_trace_config.max_bytes;
+        if (max_bytes > 0 && g_trace_bytes + header_size + size > max_bytes) {
+            g_trace_full = true;
+            olib_thread_flag_set(&g_trace_capturing, false);
+        } else if (fwrite(header, 1, header_size, g_trace_file) != header_size ||
+                   fwrite(data, 1, size, g_trace_file) != size) {
+            g_trace_failed = true;
+        } else {
+            g_trace_bytes += header_size + size;
+            g_trace_count++;
+        }
+    }
+    olib_thread_unlock();
+}
+
+void olib_trace_end(olib_trace_scope_t* scope, olib_trace_op_t op, olib_format_t src_format, olib_format_t dst_format,
+                    const uint8_t* data, size_t size, olib_object_t* tree) {
+    if (!scope->active) {
+        return;
+    }
+    bool known = src_format >= 0 && src_format < OLIB_FORMAT_MAX && dst_format >= 0 && dst_format < OLIB_FORMAT_MAX;
+
+    olib_thread_lock();
+    bool anonymize = g_trace_config.anonymize;
+    uint64_t seed = g_trace_config.seed;
+    olib_thread_unlock();
+
+    // Recording stays nested, so the encoding below is not traced itself
+    uint8_t* owned = NULL;
+    size_t owned_size = 0;
+    bool ok = false;
+    if (known && op == OLIB_TRACE_WRITE) {
+        olib_object_t* anonymized = tree && anonymize ? olib_trace_anonymize(tree, seed) : NULL;
+        olib_object_t* source = anonymize ? anonymized : tree;
+        ok = source && olib_trace_encode(OLIB_FORMAT_BINARY, source, &owned, &owned_size);
+        olib_object_free(anonymized);
+        data = owned;
+        size = owned_size;
+    } else if (known && data && size > 0) {
+        ok = true;
+        if (anonymize) {
+            ok = olib_trace_anonymize_input(src_format, data, size, seed, &owned, &owned_size);
+            data = owned;
+            size = owned_size;
+        }
+    }
+
+    if (ok) {
+        olib_trace_append(op, src_format, dst_format, data, size);
+    }
+    olib_free(owned);
+    g_trace_depth--;
+}
+
+// #############################################################################
+// Reading traces
+// #############################################################################
+
+// Read a whole file into a new buffer (caller must free out_data with olib_free)
+static bool olib_trace_read_file(const char* file_path, uint8_t** out_data, size_t* out_size) {
+    FILE* file = fopen(file_path, "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (end <= 0) {
+        fclose(file);
+        return false;
+    }
+    size_t size = (size_t)end;
+    uint8_t* data = olib_malloc(size);
+    bool result = data && fread(data, 1, size, file) == size;
+    fclose(file);
+    if (!result) {
+        olib_free(data);
+        return false;
+    }
+    *out_data = data;
+    *out_size = size;
+    return true;
+}
+
+// Walk the records of a file. With a trace, fill its records and payload, otherwise only
+// count them and the payload bytes. A truncated last record (a capture that was cut off)
+// ends the walk.
+static bool olib_trace_parse(const uint8_t* data, size_t size, olib_trace_t* trace, size_t* out_count,
+                             size_t* out_payload_size) {
+    size_t pos = sizeof(g_trace_magic) + 1;
+    size_t count = 0;
+    size_t payload_size = 0;
+    while (pos + 3 < size) {
+        olib_trace_op_t op = (olib_trace_op_t)data[pos];
+        olib_format_t src_format = (olib_format_t)data[pos + 1];
+        olib_format_t dst_format = (olib_format_t)data[pos + 2];
+        if (op >= OLIB_TRACE_OP_MAX || src_format >= OLIB_FORMAT_MAX || dst_format >= OLIB_FORMAT_MAX) {
+            return false;
+        }
+        pos += 3;
+        uint64_t record_size;
+        if (!olib_trace_get_varint(data, size, &pos, &record_size) || record_size > size - pos) {
+            break;
+        }
+
+        if (trace) {
+            uint8_t* copy = trace->payload + payload_size;
+            memcpy(copy, data + pos, (size_t)record_size);
+            copy[record_size] = '\0';
+            olib_trace_record_t* record = &trace->records[count];
+            record->op = op;
+            record->src_format = src_format;
+            record->dst_format = dst_format;
+            record->data = copy;
+            record->size = (size_t)record_size;
+        }
+        pos += (size_t)record_size;
+        payload_size += (size_t)record_size + 1;
+        count++;
+    }
+    *out_count = count;
+    *out_payload_size = payload_size;
+    return true;
+}
+
+OLIB_API olib_trace_t* olib_trace_load(const char* file_path) {
+    if (!file_path) {
+        return NULL;
+    }
+    uint8_t* data;
+    size_t size;
+    if (!olib_trace_read_file(file_path, &data, &size)) {
+        return NULL;
+    }
+
+    size_t count = 0;
+    size_t payload_size = 0;
+    bool valid = size > sizeof(g_trace_magic) && memcmp(data, g_trace_magic, sizeof(g_trace_magic)) == 0 &&
+                 data[sizeof(g_trace_magic)] == OLIB_TRACE_VERSION &&
+                 olib_trace_parse(data, size, NULL, &count, &payload_size);
+    olib_trace_t* trace = valid ? olib_calloc(1, sizeof(olib_trace_t)) : NULL;
+    if (!trace) {
+        olib_free(data);
+        return NULL;
+    }
+
+    trace->records = olib_calloc(count > 0 ? count : 1, sizeof(olib_trace_record_t));
+    trace->payload = olib_malloc(payload_size > 0 ? payload_size : 1);
+    if (!trace->records || !trace->payload) {
+        olib_free(data);
+        olib_trace_free(trace);
+        return NULL;
+    }
+    olib_trace_parse(data, size, trace, &trace->count, &payload_size);
+    olib_free(data);
+    return trace;
+}
+
+OLIB_API void olib_trace_free(olib_trace_t* trace) {
+    if (!trace) {
+        return;
+    }
+    olib_free(trace->records);
+    olib_free(trace->payload);
+    olib_free(trace);
+}
+
+OLIB_API size_t olib_trace_size(olib_trace_t* trace) {
+    return trace ? trace->count : 0;
+}
+
+OLIB_API bool olib_trace_get(olib_trace_t* trace, size_t index, olib_trace_record_t* out_record) {
+    if (!trace || !out_record || index >= trace->count) {
+        return false;
+    }
+    *out_record = trace->records[index];
+    return true;
+}
+
+// #############################################################################
+// Replay
+// #############################################################################
+
+typedef struct olib_trace_worker_t {
+    olib_trace_t* trace;
+    const bool* text;          // Whether each format is text-based
+    size_t iterations;
+    olib_object_t** trees;     // Decoded trees of the write records, NULL for the rest
+    double* latencies;         // One per call, in call order
+    size_t ops;
+    size_t failures;
+    size_t ops_by_kind[OLIB_TRACE_OP_MAX];
+    uint64_t bytes;
+} olib_trace_worker_t;
+
+// Run one record through the helpers, returns whether it succeeded and the bytes it moved
+static bool olib_trace_replay_one(olib_trace_worker_t* worker, size_t index, uint64_t* out_bytes) {
+    const olib_trace_record_t* record = &worker->trace->records[index];
+    switch (record->op) {
+        case OLIB_TRACE_READ: {
+            olib_object_t* obj = worker->text[record->src_format]
+                                     ? olib_format_read_string(record->src_format, (const char*)record->data)
+                                     : olib_format_read(record->src_format, record->data, record->size);
+            *out_bytes = record->size;
+            olib_object_free(obj);
+            return obj != NULL;
+        }
+        case OLIB_TRACE_WRITE: {
+            olib_object_t* tree = worker->trees[index];
+            uint8_t* data = NULL;
+            size_t size = 0;
+            bool result = false;
+            if (tree && worker->text[record->dst_format]) {
+                char* text = NULL;
+                result = olib_format_write_string(record->dst_format, tree, &text);
+                size = result ? strlen(text) : 0;
+                data = (uint8_t*)text;
+            } else if (tree) {
+                result = olib_format_write(record->dst_format, tree, &data, &size);
+            }
+            *out_bytes = size;
+            olib_free(data);
+            return result;
+        }
+        case OLIB_TRACE_CONVERT: {
+            uint8_t* data = NULL;
+            size_t size = 0;
+            bool result = olib_convert(record->src_format, record->data, record->size, record->dst_format, &data, &size);
+            *out_bytes = record->size;
+            olib_free(data);
+            return result;
+        }
+        default:
+            return false;
+    }
+}
+
+static void olib_trace_replay_worker(void* ctx, size_t index) {
+    olib_trace_worker_t* worker = &((olib_trace_worker_t*)ctx)[index];
+    size_t count = worker->trace->count;
+    for (size_t pass = 0; pass < worker->iterations; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            uint64_t bytes = 0;
+            double start = olib_perf_now_ns();
+            bool result = olib_trace_replay_one(worker, i, &bytes);
+            worker->latencies[worker->ops++] = olib_perf_now_ns() - start;
+            worker->ops_by_kind[worker->trace->records[i].op]++;
+            worker->bytes += bytes;
+            if (!result) {
+                worker->failures++;
+            }
+        }
+    }
+}
+
+static int olib_trace_compare_latency(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted latencies
+static double olib_trace_percentile(const double* sorted, size_t count, double fraction) {
+    double exact = fraction * (double)count;
+    size_t rank = (size_t)exact;
+    if ((double)rank < exact) {
+        rank++;
+    }
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void olib_trace_replay_free_workers(olib_trace_worker_t* workers, size_t thread_count, size_t record_count) {
+    for (size_t t = 0; t < thread_count; t++) {
+        if (workers[t].trees) {
+            for (size_t i = 0; i < record_count; i++) {
+                olib_object_free(workers[t].trees[i]);
+            }
+        }
+        olib_free(workers[t].trees);
+        olib_free(workers[t].latencies);
+    }
+    olib_free(workers);
+}
+
+OLIB_API bool olib_trace_replay(olib_trace_t* trace, const olib_trace_replay_config_t* config,
+                                olib_trace_replay_result_t* out_result) {
+    if (!trace || !out_result) {
+        return false;
+    }
+    size_t thread_count = config && config->threads > 1 ? config->threads : 1;
+    size_t iterations = config && config->iterations > 1 ? config->iterations : 1;
+    size_t count = trace->count;
+    memset(out_result, 0, sizeof(*out_result));
+
+    bool text[OLIB_FORMAT_MAX];
+    for (int format = 0; format < OLIB_FORMAT_MAX; format++) {
+        text[format] = olib_trace_format_is_text((olib_format_t)format);
+    }
+
+    // Each thread gets its own trees, decoded before the clock starts
+    olib_trace_worker_t* workers = olib_calloc(thread_count, sizeof(olib_trace_worker_t));
+    if (!workers) {
+        return false;
+    }
+    for (size_t t = 0; t < thread_count; t++) {
+        olib_trace_worker_t* worker = &workers[t];
+        worker->trace = trace;
+        worker->text = text;
+        worker->iterations = iterations;
+        worker->trees = olib_calloc(count > 0 ? count : 1, sizeof(olib_object_t*));
+        worker->latencies = olib_malloc((count > 0 ? count : 1) * iterations * sizeof(double));
+        if (!worker->trees || !worker->latencies) {
+            olib_trace_replay_free_workers(workers, thread_count, count);
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (trace->records[i].op == OLIB_TRACE_WRITE) {
+                worker->trees[i] = olib_trace_decode(OLIB_FORMAT_BINARY, trace->records[i].data, trace->records[i].size);
+            }
+        }
+    }
+
+    double start = olib_perf_now_ns();
+    olib_thread_parallel_for(thread_count, olib_trace_replay_worker, workers);
+    out_result->wall_ns = olib_perf_now_ns() - start;
+
+    // Merge every thread's calls for the percentiles
+    size_t total = count * iterations * thread_count;
+    double* latencies = olib_malloc((total > 0 ? total : 1) * sizeof(double));
+    if (!latencies) {
+        olib_trace_replay_free_workers(workers, thread_count, count);
+        return false;
+    }
+    double sum = 0.0;
+    for (size_t t = 0; t < thread_count; t++) {
+        olib_trace_worker_t* worker = &workers[t];
+        memcpy(latencies + out_result->ops, worker->latencies, worker->ops * sizeof(double));
+        for (size_t i = 0; i < worker->ops; i++) {
+            sum += worker->latencies[i];
+        }
+        out_result->ops += worker->ops;
+        out_result->failures += worker->failures;
+        out_result->bytes += worker->bytes;
+        for (int kind = 0; kind < OLIB_TRACE_OP_MAX; kind++) {
+            out_result->ops_by_kind[kind] += worker->ops_by_kind[kind];
+        }
+    }
+    olib_trace_replay_free_workers(workers, thread_count, count);
+
+    if (out_result->ops > 0) {
+        qsort(latencies, out_result->ops, sizeof(double), olib_trace_compare_latency);
+        out_result->mean_ns = sum / (double)out_result->ops;
+        out_result->p50_ns = olib_trace_percentile(latencies, out_result->ops, 0.50);
+        out_result->p90_ns = olib_trace_percentile(latencies, out_result->ops, 0.90);
+        out_result->p99_ns = olib_trace_percentile(latencies, out_result->ops, 0.99);
+        out_result->p999_ns = olib_trace_percentile(latencies, out_result->ops, 0.999);
+        out_result->max_ns = latencies[out_result->ops - 1];
+    }
+    if (out_result->wall_ns > 0.0) {
+        out_result->ops_per_sec = (double)out_result->ops * 1e9 / out_result->wall_ns;
+        out_result->bytes_per_sec = (double)out_result->bytes * 1e9 / out_result->wall_ns;
+    }
+    olib_free(latencies);
+    return true;
+}
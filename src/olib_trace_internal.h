@@ -0,0 +1,49 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_trace.h>
+
+// Trace capture plumbing shared between the library sources. Not part of the public API.
+
+typedef struct olib_trace_scope_t {
+    bool active;  // Capture running and not nested in another traced call
+} olib_trace_scope_t;
+
+// Start a traced call. Every begin must be paired with olib_trace_end.
+void olib_trace_begin(olib_trace_scope_t* scope);
+
+// Whether a traced call starting now would be recorded (capture running, not nested)
+bool olib_trace_would_record(void);
+
+// Record a finished call. data is the input of reads and conversions, tree the object
+// written. Calls in a format outside olib_format_t are not recorded.
+void olib_trace_end(olib_trace_scope_t* scope, olib_trace_op_t op, olib_format_t src_format, olib_format_t dst_format,
+                    const uint8_t* data, size_t size, olib_object_t* tree);
+
+// Format a built-in serializer was created for, so direct calls on it can be traced.
+// Serializers start out as OLIB_FORMAT_MAX.
+void olib_serializer_set_format(olib_serializer_t* serializer, olib_format_t format);
+olib_format_t olib_serializer_get_format(olib_serializer_t* serializer);
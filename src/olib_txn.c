@@ -0,0 +1,307 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "olib_txn_internal.h"
+#include "olib_object_internal.h"
+#include "olib_observer_internal.h"
+#include <string.h>
+
+// #############################################################################
+// Internal structures
+// #############################################################################
+
+typedef struct txn_entry_t {
+    olib_undo_op_t op;
+    olib_object_t* obj;
+    size_t index;          // For value entries, nonzero when old.string is in use
+    olib_object_t* child;  // Displaced child, owned by the log
+    union {
+        int64_t int_val;  // Also the key of a removed map entry
+        uint64_t uint_val;
+        double float_val;
+        bool bool_val;
+        char* string;  // Copy of the old string, NULL if it had none
+        char* key;     // Key of a removed struct entry
+    } old;
+} txn_entry_t;
+
+struct olib_txn_t {
+    olib_observer_t* observer;
+    size_t pending_mark;
+    txn_entry_t* entries;
+    size_t count;
+    size_t capacity;
+};
+
+// #############################################################################
+// Logging
+// #############################################################################
+
+olib_txn_t* olib_txn_of(olib_object_t* obj) {
+    if (!obj->observer) {
+        return NULL;
+    }
+    olib_observer_t* observer = olib_observer_of(obj);
+    return observer ? olib_observer_txn(observer) : NULL;
+}
+
+bool olib_txn_reserve(olib_txn_t* txn) {
+    if (txn->count < txn->capacity) {
+        return true;
+    }
+    size_t capacity = txn->capacity ? txn->capacity * 2 : 16;
+    txn_entry_t* entries = olib_realloc(txn->entries, capacity * sizeof(txn_entry_t));
+    if (!entries) {
+        return false;
+    }
+    txn->entries = entries;
+    txn->capacity = capacity;
+    return true;
+}
+
+bool olib_txn_record_value(olib_txn_t* txn, olib_object_t* obj) {
+    if (!olib_txn_reserve(txn)) {
+        return false;
+    }
+    txn_entry_t* entry = &txn->entries[txn->count];
+    entry->op = OLIB_UNDO_VALUE;
+    entry->obj = obj;
+    entry->index = 0;
+    entry->child = NULL;
+    switch (obj->type) {
+        case OLIB_OBJECT_TYPE_INT:
+            entry->old.int_val = obj->data.int_val;
+            break;
+        case OLIB_OBJECT_TYPE_UINT:
+            entry->old.uint_val = obj->data.uint_val;
+            break;
+        case OLIB_OBJECT_TYPE_FLOAT:
+            entry->old.float_val = obj->data.float_val;
+            break;
+        case OLIB_OBJECT_TYPE_BOOL:
+            entry->old.bool_val = obj->data.bool_val;
+            break;
+        case OLIB_OBJECT_TYPE_STRING:
+            entry->index = 1;
+            entry->old.string = NULL;
+            if (obj->data.string.data) {
+                size_t len = strlen(obj->data.string.data);
+                entry->old.string = olib_malloc(len + 1);
+                if (!entry->old.string) {
+                    return false;
+                }
+                memcpy(entry->old.string, obj->data.string.data, len + 1);
+            }
+            break;
+        default:
+            return false;
+    }
+    txn->count++;
+    return true;
+}
+
+void olib_txn_record(olib_txn_t* txn, olib_undo_op_t op, olib_object_t* obj, size_t index, olib_object_t* old_child,
+                     char* old_key) {
+    txn_entry_t* entry = &txn->entries[txn->count++];
+    entry->op = op;
+    entry->obj = obj;
+    entry->index = index;
+    entry->child = old_child;
+    entry->old.key = old_key;
+}
+
+void olib_txn_record_map_remove(olib_txn_t* txn, olib_object_t* obj, size_t index, olib_object_t* old_child,
+                                int64_t old_key) {
+    txn_entry_t* entry = &txn->entries[txn->count++];
+    entry->op = OLIB_UNDO_MAP_REMOVE;
+    entry->obj = obj;
+    entry->index = index;
+    entry->child = old_child;
+    entry->old.int_val = old_key;
+}
+
+// #############################################################################
+// Undo
+// #############################################################################
+
+// Capacities never shrink, so putting back a removed item or entry always fits
+static void txn_undo(txn_entry_t* entry) {
+    olib_object_t* obj = entry->obj;
+    size_t index = entry->index;
+    switch (entry->op) {
+        case OLIB_UNDO_VALUE:
+            switch (obj->type) {
+                case OLIB_OBJECT_TYPE_INT:
+                    obj->data.int_val = entry->old.int_val;
+                    break;
+                case OLIB_OBJECT_TYPE_UINT:
+                    obj->data.uint_val = entry->old.uint_val;
+                    break;
+                case OLIB_OBJECT_TYPE_FLOAT:
+                    obj->data.float_val = entry->old.float_val;
+                    break;
+                case OLIB_OBJECT_TYPE_BOOL:
+                    obj->data.bool_val = entry->old.bool_val;
+                    break;
+                case OLIB_OBJECT_TYPE_STRING:
+                    olib_free(obj->data.string.data);
+                    obj->data.string.data = entry->old.string;
+                    obj->data.string.capacity = entry->old.string ? strlen(entry->old.string) + 1 : 0;
+                    entry->old.string = NULL;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case OLIB_UNDO_LIST_SET: {
+            olib_object_t* current = obj->data.list.items[index];
+            obj->data.list.items[index] = entry->child;
+            olib_object_free(current);
+            break;
+        }
+        case OLIB_UNDO_LIST_INSERT: {
+            olib_object_t* current = obj->data.list.items[index];
+            memmove(&obj->data.list.items[index], &obj->data.list.items[index + 1],
+                    (obj->data.list.size - index - 1) * sizeof(olib_object_t*));
+            obj->data.list.size--;
+            olib_object_free(current);
+            break;
+        }
+        case OLIB_UNDO_LIST_REMOVE:
+            memmove(&obj->data.list.items[index + 1], &obj->data.list.items[index],
+                    (obj->data.list.size - index) * sizeof(olib_object_t*));
+            obj->data.list.items[index] = entry->child;
+            obj->data.list.size++;
+            break;
+        case OLIB_UNDO_STRUCT_SET: {
+            olib_object_t* current = obj->data.object.entries[index].value;
+            obj->data.object.entries[index].value = entry->child;
+            olib_object_free(current);
+            break;
+        }
+        case OLIB_UNDO_STRUCT_ADD: {
+            olib_struct_entry_t* entries = obj->data.object.entries;
+            olib_free(entries[index].key);
+            olib_object_free(entries[index].value);
+            memmove(&entries[index], &entries[index + 1], (obj->data.object.size - index - 1) * sizeof(olib_struct_entry_t));
+            obj->data.object.size--;
+            break;
+        }
+        case OLIB_UNDO_STRUCT_REMOVE: {
+            olib_struct_entry_t* entries = obj->data.object.entries;
+            memmove(&entries[index + 1], &entries[index], (obj->data.object.size - index) * sizeof(olib_struct_entry_t));
+            entries[index].key = entry->old.key;
+            entries[index].value = entry->child;
+            obj->data.object.size++;
+            entry->old.key = NULL;
+            break;
+        }
+        case OLIB_UNDO_MAP_SET: {
+            olib_object_t* current = obj->data.map.entries[index].value;
+            obj->data.map.entries[index].value = entry->child;
+            olib_object_free(current);
+            break;
+        }
+        case OLIB_UNDO_MAP_ADD: {
+            olib_object_t* current = obj->data.map.entries[index].value;
+            olib_object_map_unlink(obj, index);
+            olib_object_free(current);
+            break;
+        }
+        case OLIB_UNDO_MAP_REMOVE:
+            // Append the entry again and swap it with the one that took its place
+            olib_object_map_link(obj, entry->old.int_val, entry->child);
+            olib_object_map_swap(obj, index, obj->data.map.size - 1);
+            break;
+    }
+    // The restored child is back in the tree
+    entry->child = NULL;
+}
+
+// Free what an entry still owns. The node an entry points to may already be gone, since
+// it can sit inside a child released by an earlier entry.
+static void txn_release(txn_entry_t* entry) {
+    olib_object_free(entry->child);
+    if (entry->op == OLIB_UNDO_VALUE && entry->index) {
+        olib_free(entry->old.string);
+    } else if (entry->op == OLIB_UNDO_STRUCT_REMOVE) {
+        olib_free(entry->old.key);
+    }
+}
+
+static void txn_end(olib_txn_t* txn) {
+    olib_observer_set_txn(txn->observer, NULL);
+    for (size_t i = 0; i < txn->count; i++) {
+        txn_release(&txn->entries[i]);
+    }
+    olib_observer_batch_end(txn->observer);
+    olib_free(txn->entries);
+    olib_free(txn);
+}
+
+// #############################################################################
+// Public API
+// #############################################################################
+
+OLIB_API olib_txn_t* olib_txn_begin(olib_object_t* root) {
+    if (!root) {
+        return NULL;
+    }
+    // The observer's marking tells the mutators which nodes belong to the tree
+    olib_observer_t* observer = olib_observer_of(root);
+    if (!observer || olib_observer_txn(observer) || olib_observer_root(observer) != root) {
+        return NULL;
+    }
+    olib_txn_t* txn = olib_calloc(1, sizeof(olib_txn_t));
+    if (!txn) {
+        return NULL;
+    }
+    txn->observer = observer;
+    olib_observer_batch_begin(observer);
+    txn->pending_mark = olib_observer_pending_mark(observer);
+    olib_observer_set_txn(observer, txn);
+    return txn;
+}
+
+OLIB_API void olib_txn_commit(olib_txn_t* txn) {
+    if (txn) {
+        txn_end(txn);
+    }
+}
+
+OLIB_API void olib_txn_rollback(olib_txn_t* txn) {
+    if (!txn) {
+        return;
+    }
+    // Undo steps go straight to the nodes, so neither the log nor subscribers see them
+    for (size_t i = txn->count; i-- > 0;) {
+        txn_undo(&txn->entries[i]);
+    }
+    olib_observer_discard_pending(txn->observer, txn->pending_mark);
+    txn_end(txn);
+}
+
+OLIB_API size_t olib_txn_undo_count(olib_txn_t* txn) {
+    return txn ? txn->count : 0;
+}
@@ -0,0 +1,62 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <olib/olib_txn.h>
+
+// Undo logging hooks the object mutators call, shared between the library sources. Not
+// part of the public API.
+
+typedef enum olib_undo_op_t {
+    OLIB_UNDO_VALUE,          // Old scalar value of the node
+    OLIB_UNDO_LIST_SET,       // Item at index replaced, the old item is kept
+    OLIB_UNDO_LIST_INSERT,    // Item inserted at index
+    OLIB_UNDO_LIST_REMOVE,    // Item removed from index, the item is kept
+    OLIB_UNDO_STRUCT_SET,     // Value of entry index replaced, the old value is kept
+    OLIB_UNDO_STRUCT_ADD,     // Entry appended at index
+    OLIB_UNDO_STRUCT_REMOVE,  // Entry removed from index, its key and value are kept
+    OLIB_UNDO_MAP_SET,        // Value of entry index replaced, the old value is kept
+    OLIB_UNDO_MAP_ADD,        // Entry appended at index
+    OLIB_UNDO_MAP_REMOVE,     // Entry removed from index and the last entry moved there, its key and value are kept
+} olib_undo_op_t;
+
+// Transaction open on the observer of obj, NULL if none or if obj is not observed
+olib_txn_t* olib_txn_of(olib_object_t* obj);
+
+// Make room for one undo entry before a container mutation, false if the mutation must fail
+bool olib_txn_reserve(olib_txn_t* txn);
+
+// Log the old value of obj before a setter changes it, false if the setter must fail
+bool olib_txn_record_value(olib_txn_t* txn, olib_object_t* obj);
+
+// Log a container mutation after olib_txn_reserve succeeded. The transaction takes
+// ownership of old_child and old_key.
+void olib_txn_record(olib_txn_t* txn, olib_undo_op_t op, olib_object_t* obj, size_t index, olib_object_t* old_child,
+                     char* old_key);
+
+// Log a map entry removal after olib_txn_reserve succeeded. The transaction takes
+// ownership of old_child.
+void olib_txn_record_map_remove(olib_txn_t* txn, olib_object_t* obj, size_t index, olib_object_t* old_child,
+                                int64_t old_key);
@@ -0,0 +1,414 @@
+#include "test_utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// Allocation counts are pinned for the core operations so that a change adding
+// allocations per node or per key fails here. Budgets are upper bounds, lower them
+// when an optimization removes allocations.
+
+// =============================================================================
+// Counting Allocator
+// =============================================================================
+
+struct AllocStats {
+  size_t allocs = 0;    // malloc, calloc and realloc(NULL)
+  size_t reallocs = 0;  // realloc of an existing block
+  size_t frees = 0;
+
+  size_t total() const { return allocs + reallocs; }
+};
+
+static AllocStats g_stats;
+
+static void* budget_malloc(size_t size) {
+  g_stats.allocs++;
+  return malloc(size);
+}
+
+static void budget_free(void* ptr) {
+  if (ptr) g_stats.frees++;
+  free(ptr);
+}
+
+static void* budget_calloc(size_t num, size_t size) {
+  g_stats.allocs++;
+  return calloc(num, size);
+}
+
+static void* budget_realloc(void* ptr, size_t new_size) {
+  if (ptr) {
+    g_stats.reallocs++;
+  } else {
+    g_stats.allocs++;
+  }
+  return realloc(ptr, new_size);
+}
+
+// Counts the allocations made while it is alive
+class AllocCounter {
+ public:
+  AllocCounter() {
+    g_stats = AllocStats();
+    olib_set_memory_fns(budget_malloc, budget_free, budget_calloc, budget_realloc);
+  }
+  ~AllocCounter() { stop(); }
+
+  AllocStats stop() {
+    if (active_) {
+      olib_set_memory_fns(nullptr, nullptr, nullptr, nullptr);
+      active_ = false;
+      result_ = g_stats;
+    }
+    return result_;
+  }
+
+ private:
+  bool active_ = true;
+  AllocStats result_;
+};
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+// Blocks a tree needs at minimum: one per object, string, key and non-empty container array
+static size_t tree_block_floor(olib_object_t* obj) {
+  size_t blocks = 1;
+  switch (olib_object_get_type(obj)) {
+    case OLIB_OBJECT_TYPE_STRING:
+      if (olib_object_get_string(obj)) blocks++;
+      break;
+    case OLIB_OBJECT_TYPE_LIST: {
+      size_t size = olib_object_list_size(obj);
+      if (size > 0) blocks++;
+      for (size_t i = 0; i < size; i++) {
+        blocks += tree_block_floor(olib_object_list_get(obj, i));
+      }
+      break;
+    }
+    case OLIB_OBJECT_TYPE_STRUCT: {
+      size_t size = olib_object_struct_size(obj);
+      if (size > 0) blocks++;
+      for (size_t i = 0; i < size; i++) {
+        blocks += 1 + tree_block_floor(olib_object_struct_value_at(obj, i));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return blocks;
+}
+
+// Struct with `count` string fields, and a list of `count` ints
+static olib_object_t* create_wide_object(int count) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* fields = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* values = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < count; i++) {
+    std::string key = "field_" + std::to_string(i);
+    olib_object_t* str = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(str, ("value " + std::to_string(i)).c_str());
+    olib_object_struct_add(fields, key.c_str(), str);
+
+    olib_object_t* num = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(num, i * 7);
+    olib_object_list_push(values, num);
+  }
+  olib_object_struct_add(root, "fields", fields);
+  olib_object_struct_add(root, "values", values);
+  return root;
+}
+
+// Write with an existing serializer, text formats through write_string
+static bool write_with(olib_serializer_t* ser, olib_object_t* obj, uint8_t** out_data, size_t* out_size) {
+  if (!olib_serializer_is_text_based(ser)) {
+    return olib_serializer_write(ser, obj, out_data, out_size);
+  }
+  char* str = nullptr;
+  if (!olib_serializer_write_string(ser, obj, &str)) {
+    return false;
+  }
+  *out_data = (uint8_t*)str;
+  *out_size = strlen(str);
+  return true;
+}
+
+static std::string load_sample(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string text = buffer.str();
+  // Checkouts with CRLF line endings parse the same, keep the input identical anyway
+  text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+  return text;
+}
+
+// =============================================================================
+// Parsing
+// =============================================================================
+
+TEST(AllocBudget, ParseSampleFiles) {
+  struct Sample {
+    const char* path;
+    olib_format_t format;
+    size_t budget;
+  };
+  const Sample samples[] = {
+      {"samples/example1.json", OLIB_FORMAT_JSON_TEXT, 52},
+      {"samples/example2.json", OLIB_FORMAT_JSON_TEXT, 70},
+      {"samples/example1.yaml", OLIB_FORMAT_YAML, 52},
+      {"samples/example2.yaml", OLIB_FORMAT_YAML, 70},
+      {"samples/example1.xml", OLIB_FORMAT_XML, 52},
+      {"samples/example2.xml", OLIB_FORMAT_XML, 70},
+      {"samples/example1.toml", OLIB_FORMAT_TOML, 52},
+      {"samples/example2.toml", OLIB_FORMAT_TOML, 70},
+      {"samples/example1.txt", OLIB_FORMAT_TXT, 52},
+      {"samples/example2.txt", OLIB_FORMAT_TXT, 70},
+  };
+
+  for (const Sample& sample : samples) {
+    std::string text = load_sample(sample.path);
+    ASSERT_FALSE(text.empty()) << sample.path;
+
+    AllocCounter counter;
+    olib_object_t* obj = olib_format_read_string(sample.format, text.c_str());
+    AllocStats stats = counter.stop();
+    ASSERT_NE(obj, nullptr) << sample.path;
+
+    EXPECT_LE(stats.total(), sample.budget) << sample.path;
+    EXPECT_GE(stats.allocs, tree_block_floor(obj)) << sample.path;
+    // Everything but the tree itself is released before returning
+    EXPECT_EQ(stats.allocs - stats.frees, tree_block_floor(obj)) << sample.path;
+
+    olib_object_free(obj);
+  }
+}
+
+TEST(AllocBudget, ParseCostPerNode) {
+  // Doubling the input may only add the blocks of the new nodes plus container growth
+  olib_object_t* small = create_wide_object(64);
+  olib_object_t* large = create_wide_object(128);
+  size_t extra_blocks = tree_block_floor(large) - tree_block_floor(small);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+    uint8_t* small_data = nullptr;
+    size_t small_size = 0;
+    uint8_t* large_data = nullptr;
+    size_t large_size = 0;
+    ASSERT_TRUE(write_any_format(format, small, &small_data, &small_size)) << "format " << f;
+    ASSERT_TRUE(write_any_format(format, large, &large_data, &large_size)) << "format " << f;
+
+    AllocCounter small_counter;
+    olib_object_t* small_obj = read_any_format(format, small_data, small_size);
+    AllocStats small_stats = small_counter.stop();
+
+    AllocCounter large_counter;
+    olib_object_t* large_obj = read_any_format(format, large_data, large_size);
+    AllocStats large_stats = large_counter.stop();
+
+    ASSERT_NE(small_obj, nullptr) << "format " << f;
+    ASSERT_NE(large_obj, nullptr) << "format " << f;
+    EXPECT_LE(large_stats.total() - small_stats.total(), extra_blocks + 4) << "format " << f;
+
+    olib_object_free(large_obj);
+    olib_object_free(small_obj);
+    olib_free(large_data);
+    olib_free(small_data);
+  }
+
+  olib_object_free(large);
+  olib_object_free(small);
+}
+
+// =============================================================================
+// Writing
+// =============================================================================
+
+TEST(AllocBudget, WriteIsIndependentOfNodeCount) {
+  // Writers only grow their output buffer, doubling the tree adds at most a few reallocs
+  olib_object_t* small = create_wide_object(64);
+  olib_object_t* large = create_wide_object(128);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+    uint8_t* small_data = nullptr;
+    size_t small_size = 0;
+    uint8_t* large_data = nullptr;
+    size_t large_size = 0;
+
+    AllocCounter small_counter;
+    ASSERT_TRUE(write_any_format(format, small, &small_data, &small_size)) << "format " << f;
+    AllocStats small_stats = small_counter.stop();
+
+    AllocCounter large_counter;
+    ASSERT_TRUE(write_any_format(format, large, &large_data, &large_size)) << "format " << f;
+    AllocStats large_stats = large_counter.stop();
+
+    EXPECT_LE(small_stats.total(), 24u) << "format " << f;
+    EXPECT_LE(large_stats.total() - small_stats.total(), 2u) << "format " << f;
+
+    olib_free(large_data);
+    olib_free(small_data);
+  }
+
+  olib_object_free(large);
+  olib_object_free(small);
+}
+
+TEST(AllocBudget, RepeatedWritesPredictOutputSize) {
+  // Later writes start from a buffer sized after the earlier outputs instead of regrowing
+  olib_object_t* obj = create_wide_object(512);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_serializer_t* ser = olib_format_serializer((olib_format_t)f);
+    ASSERT_NE(ser, nullptr) << "format " << f;
+    for (int i = 0; i < 4; i++) {
+      uint8_t* data = nullptr;
+      size_t size = 0;
+      AllocCounter counter;
+      ASSERT_TRUE(write_with(ser, obj, &data, &size)) << "format " << f;
+      AllocStats stats = counter.stop();
+      if (i > 0) {
+        EXPECT_EQ(stats.reallocs, 0u) << "format " << f << " write " << i;
+      }
+      olib_free(data);
+    }
+    olib_serializer_free(ser);
+  }
+
+  olib_object_free(obj);
+}
+
+TEST(AllocBudget, RetainedOutputIsCopiedOut) {
+  olib_object_t* obj = create_wide_object(512);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+    uint8_t* expected = nullptr;
+    size_t expected_size = 0;
+    ASSERT_TRUE(write_any_format(format, obj, &expected, &expected_size)) << "format " << f;
+
+    olib_serializer_t* ser = olib_format_serializer(format);
+    ASSERT_TRUE(olib_serializer_set_output_mode(ser, OLIB_OUTPUT_RETAIN)) << "format " << f;
+    for (int i = 0; i < 3; i++) {
+      uint8_t* data = nullptr;
+      size_t size = 0;
+      AllocCounter counter;
+      ASSERT_TRUE(write_with(ser, obj, &data, &size)) << "format " << f;
+      AllocStats stats = counter.stop();
+      ASSERT_EQ(size, expected_size) << "format " << f;
+      EXPECT_EQ(memcmp(data, expected, size), 0) << "format " << f;
+      if (i > 0) {
+        // Only the exact-size copy handed to the caller
+        EXPECT_EQ(stats.allocs, 1u) << "format " << f;
+        EXPECT_EQ(stats.reallocs, 0u) << "format " << f;
+      }
+      olib_free(data);
+    }
+    olib_serializer_free(ser);
+    olib_free(expected);
+  }
+
+  olib_object_free(obj);
+}
+
+TEST(AllocBudget, RecycledOutputIsReused) {
+  olib_object_t* obj = create_wide_object(512);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_serializer_t* ser = olib_format_serializer((olib_format_t)f);
+    ASSERT_NE(ser, nullptr) << "format " << f;
+    uint8_t* previous = nullptr;
+    for (int i = 0; i < 3; i++) {
+      uint8_t* data = nullptr;
+      size_t size = 0;
+      AllocCounter counter;
+      ASSERT_TRUE(write_with(ser, obj, &data, &size)) << "format " << f;
+      AllocStats stats = counter.stop();
+      if (i > 0) {
+        // The buffer handed back is swapped in, the write allocates nothing for its output
+        EXPECT_EQ(data, previous) << "format " << f;
+        EXPECT_EQ(stats.total(), 0u) << "format " << f;
+      }
+      previous = data;
+      olib_serializer_recycle_output(ser, data);
+    }
+    olib_serializer_free(ser);
+  }
+
+  // Serializers without a shared output buffer just free recycled output
+  olib_serializer_config_t config = {};
+  olib_serializer_t* custom = olib_serializer_new(&config);
+  EXPECT_FALSE(olib_serializer_set_output_mode(custom, OLIB_OUTPUT_RETAIN));
+  olib_serializer_recycle_output(custom, olib_malloc(16));
+  olib_serializer_free(custom);
+
+  olib_object_free(obj);
+}
+
+// =============================================================================
+// Dupe and Free
+// =============================================================================
+
+TEST(AllocBudget, DupeAllocatesExactlyTheTree) {
+  olib_object_t* original = create_wide_object(256);
+  olib_object_struct_add(original, "mixed", create_test_object());
+
+  AllocCounter counter;
+  olib_object_t* copy = olib_object_dupe(original);
+  AllocStats stats = counter.stop();
+
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(stats.allocs, tree_block_floor(original));
+  EXPECT_EQ(stats.reallocs, 0u);
+  EXPECT_EQ(stats.frees, 0u);
+
+  olib_object_free(copy);
+  olib_object_free(original);
+}
+
+TEST(AllocBudget, FreeReleasesEveryBlock) {
+  olib_object_t* obj = create_wide_object(256);
+  size_t blocks = tree_block_floor(obj);
+
+  AllocCounter counter;
+  olib_object_free(obj);
+  AllocStats stats = counter.stop();
+
+  EXPECT_EQ(stats.total(), 0u);
+  EXPECT_EQ(stats.frees, blocks);
+}
+
+// =============================================================================
+// Struct Updates
+// =============================================================================
+
+TEST(AllocBudget, StructSetOnLargeStruct) {
+  olib_object_t* obj = create_wide_object(1024);
+  olib_object_t* fields = olib_object_struct_get(obj, "fields");
+  ASSERT_EQ(olib_object_struct_size(fields), 1024u);
+
+  // Replacing a value keeps the key and the entry array
+  olib_object_t* replacement = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  AllocCounter replace_counter;
+  EXPECT_TRUE(olib_object_struct_set(fields, "field_512", replacement));
+  AllocStats replace_stats = replace_counter.stop();
+  EXPECT_EQ(replace_stats.total(), 0u);
+  EXPECT_EQ(replace_stats.frees, 2u);  // Old string object and its data
+
+  // New keys cost the key copy plus amortized growth of the entry array
+  AllocCounter add_counter;
+  for (int i = 0; i < 1024; i++) {
+    std::string key = "added_" + std::to_string(i);
+    olib_object_struct_set(fields, key.c_str(), nullptr);
+  }
+  AllocStats add_stats = add_counter.stop();
+  EXPECT_EQ(add_stats.allocs, 1024u);
+  EXPECT_LE(add_stats.reallocs, 1u);
+
+  olib_object_free(obj);
+}
@@ -0,0 +1,259 @@
+#include "test_utils.h"
+#include <cstdlib>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+// Create an arena or skip the test where file-mapped arenas are not available
+#define NEW_ARENA_OR_SKIP(arena, options)                                  \
+  olib_mmap_arena_t* arena = olib_mmap_arena_new(options);                 \
+  if (!arena) {                                                            \
+    GTEST_SKIP() << "file-mapped arenas are not supported on this platform"; \
+  }
+
+static olib_object_t* create_records(int count) {
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < count; i++) {
+    olib_object_t* record = create_test_object();
+    olib_object_t* label = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(label, ("record number " + std::to_string(i)).c_str());
+    olib_object_struct_add(record, "label", label);
+    olib_object_list_push(list, record);
+  }
+  return list;
+}
+
+// =============================================================================
+// Allocation
+// =============================================================================
+
+TEST(MmapArena, ParsedTreeLivesInArena) {
+  olib_object_t* original = create_records(500);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, original, &data, &size));
+
+  NEW_ARENA_OR_SKIP(arena, nullptr);
+  olib_mmap_arena_use(arena);
+  olib_object_t* parsed = olib_format_read(OLIB_FORMAT_BINARY, data, size);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_GT(olib_mmap_arena_used(arena), size);
+  EXPECT_GE(olib_mmap_arena_mapped(arena), olib_mmap_arena_used(arena));
+
+  ASSERT_EQ(olib_object_list_size(parsed), 500u);
+  verify_test_object(olib_object_list_get(parsed, 0));
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(olib_object_list_get(parsed, 499), "label")),
+               "record number 499");
+
+  // Converting inside the arena works on arena blocks only
+  char* json = nullptr;
+  ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, parsed, &json));
+  olib_object_t* reparsed = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json);
+  ASSERT_NE(reparsed, nullptr);
+  EXPECT_EQ(olib_object_list_size(reparsed), 500u);
+
+  olib_object_free(reparsed);
+  olib_free(json);
+  olib_object_free(parsed);
+  EXPECT_EQ(olib_mmap_arena_used(arena), 0u);
+
+  olib_mmap_arena_use(nullptr);
+  olib_mmap_arena_free(arena);
+  olib_free(data);
+  olib_object_free(original);
+}
+
+TEST(MmapArena, GrowsInSteps) {
+  olib_mmap_arena_options_t options = {};
+  options.grow_size = 64 * 1024;
+  options.advice = OLIB_MMAP_ADVICE_SEQUENTIAL;
+  NEW_ARENA_OR_SKIP(arena, &options);
+  olib_mmap_arena_use(arena);
+
+  olib_object_t* records = create_records(2000);
+  EXPECT_GT(olib_mmap_arena_mapped(arena), 4 * options.grow_size);
+  EXPECT_EQ(olib_mmap_arena_mapped(arena) % options.grow_size, 0u);
+  olib_mmap_arena_advise(arena, OLIB_MMAP_ADVICE_RANDOM);
+
+  olib_object_t* copy = olib_object_dupe(records);
+  ASSERT_NE(copy, nullptr);
+  for (int i = 0; i < 2000; i += 250) {
+    olib_object_t* record = olib_object_list_get(copy, (size_t)i);
+    verify_test_object(record);
+  }
+
+  // Freed blocks are reused before the mapping grows again
+  olib_object_free(copy);
+  size_t mapped = olib_mmap_arena_mapped(arena);
+  copy = olib_object_dupe(records);
+  EXPECT_EQ(olib_mmap_arena_mapped(arena), mapped);
+
+  olib_object_free(copy);
+  olib_object_free(records);
+  olib_mmap_arena_use(nullptr);
+  olib_mmap_arena_free(arena);
+}
+
+TEST(MmapArena, RepeatedRoundsStayBounded) {
+  olib_mmap_arena_options_t options = {};
+  options.grow_size = 64 * 1024;
+  NEW_ARENA_OR_SKIP(arena, &options);
+  olib_mmap_arena_use(arena);
+  olib_object_t* records = create_records(200);
+
+  // A buffer that grows at the top, then a tree allocated behind it. With records kept
+  // alive the arena is never empty, so freed blocks have to be found again. The mapping
+  // settles after the first rounds.
+  size_t settled = 0;
+  for (int round = 0; round < 10; round++) {
+    uint8_t* buffer = (uint8_t*)olib_malloc(16);
+    for (size_t size = 32; size <= 1024 * 1024; size *= 2) {
+      buffer = (uint8_t*)olib_realloc(buffer, size);
+      ASSERT_NE(buffer, nullptr);
+      buffer[size - 1] = 1;
+    }
+    olib_object_t* copy = olib_object_dupe(records);
+    ASSERT_NE(copy, nullptr);
+    olib_free(buffer);
+    olib_object_free(copy);
+    if (round == 1) {
+      settled = olib_mmap_arena_mapped(arena);
+    }
+  }
+  EXPECT_EQ(olib_mmap_arena_mapped(arena), settled);
+
+  // Once the arena is empty it starts over from the front
+  olib_object_free(records);
+  EXPECT_EQ(olib_mmap_arena_used(arena), 0u);
+  size_t mapped = olib_mmap_arena_mapped(arena);
+  for (int round = 0; round < 10; round++) {
+    olib_object_t* again = create_records(200);
+    uint8_t* cleared = (uint8_t*)olib_calloc(1, 4096);
+    ASSERT_NE(cleared, nullptr);
+    for (size_t i = 0; i < 4096; i++) {
+      ASSERT_EQ(cleared[i], 0u) << "round " << round << " byte " << i;
+    }
+    memset(cleared, 0xAB, 4096);
+    olib_free(cleared);
+    olib_object_free(again);
+  }
+  EXPECT_EQ(olib_mmap_arena_mapped(arena), mapped);
+
+  olib_mmap_arena_use(nullptr);
+  olib_mmap_arena_free(arena);
+}
+
+TEST(MmapArena, ReserveLimitFailsCleanly) {
+  olib_mmap_arena_options_t options = {};
+  options.reserve_size = 256 * 1024;
+  options.grow_size = 64 * 1024;
+  NEW_ARENA_OR_SKIP(arena, &options);
+
+  olib_object_t* original = create_records(5000);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, original, &data, &size));
+
+  olib_mmap_arena_use(arena);
+  EXPECT_EQ(olib_malloc(options.reserve_size), nullptr);
+  EXPECT_EQ(olib_format_read(OLIB_FORMAT_BINARY, data, size), nullptr);
+  EXPECT_EQ(olib_mmap_arena_used(arena), 0u);
+  olib_mmap_arena_use(nullptr);
+
+  olib_mmap_arena_free(arena);
+  olib_free(data);
+  olib_object_free(original);
+}
+
+TEST(MmapArena, ForeignBlocksGoBackToTheHeap) {
+  olib_object_t* before = create_test_object();
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+
+  NEW_ARENA_OR_SKIP(arena, nullptr);
+  olib_mmap_arena_use(arena);
+
+  // Growing a heap array stays on the heap, new nodes go to the arena
+  for (int i = 0; i < 100; i++) {
+    olib_object_list_push(list, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  }
+  EXPECT_GT(olib_mmap_arena_used(arena), 0u);
+  olib_object_free(before);
+  olib_object_free(list);
+  EXPECT_EQ(olib_mmap_arena_used(arena), 0u);
+
+  // Recycled blocks are cleared by calloc
+  void* block = olib_malloc(100);
+  memset(block, 0xAB, 100);
+  olib_free(block);
+  uint8_t* cleared = (uint8_t*)olib_calloc(1, 100);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(cleared[i], 0);
+  }
+  olib_free(cleared);
+
+  olib_mmap_arena_free(arena);
+  // Freeing the arena in use restores the heap
+  olib_object_t* after = create_test_object();
+  verify_test_object(after);
+  olib_object_free(after);
+}
+
+static size_t g_custom_allocs;
+static size_t g_custom_frees;
+
+static void* custom_malloc(size_t size) {
+  g_custom_allocs++;
+  return malloc(size);
+}
+
+static void custom_free(void* ptr) {
+  if (ptr) {
+    g_custom_frees++;
+  }
+  free(ptr);
+}
+
+static void* custom_calloc(size_t num, size_t size) {
+  g_custom_allocs++;
+  return calloc(num, size);
+}
+
+static void* custom_realloc(void* ptr, size_t size) {
+  g_custom_allocs++;
+  return realloc(ptr, size);
+}
+
+TEST(MmapArena, DetachRestoresPreviousFunctions) {
+  NEW_ARENA_OR_SKIP(arena, nullptr);
+  g_custom_allocs = 0;
+  g_custom_frees = 0;
+  olib_set_memory_fns(custom_malloc, custom_free, custom_calloc, custom_realloc);
+  olib_object_free(create_test_object());
+  size_t allocs = g_custom_allocs;
+  size_t frees = g_custom_frees;
+  ASSERT_GT(frees, 0u);
+  olib_object_t* before = create_test_object();
+
+  // Blocks from before the switch go back to the custom functions
+  olib_mmap_arena_use(arena);
+  olib_object_t* inside = create_test_object();
+  EXPECT_EQ(g_custom_allocs, 2 * allocs);
+  olib_object_free(before);
+  EXPECT_EQ(g_custom_frees, 2 * frees);
+  olib_object_free(inside);
+  EXPECT_EQ(g_custom_frees, 2 * frees);
+  EXPECT_EQ(olib_mmap_arena_used(arena), 0u);
+
+  olib_mmap_arena_use(nullptr);
+  olib_object_free(create_test_object());
+  EXPECT_EQ(g_custom_allocs, 3 * allocs);
+  EXPECT_EQ(g_custom_frees, 3 * frees);
+
+  // Freeing the arena in use restores them too
+  olib_mmap_arena_use(arena);
+  olib_mmap_arena_free(arena);
+  olib_free(olib_malloc(16));
+  EXPECT_EQ(g_custom_allocs, 3 * allocs + 1);
+  olib_set_memory_fns(malloc, free, calloc, realloc);
+}
@@ -0,0 +1,367 @@
+#include "test_utils.h"
+#include <vector>
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static olib_object_t* make_record(int64_t id, const char* name, double score, bool active) {
+  olib_object_t* row = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+
+  olib_object_t* id_obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(id_obj, id);
+  olib_object_struct_set(row, "id", id_obj);
+
+  if (name) {
+    olib_object_t* name_obj = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(name_obj, name);
+    olib_object_struct_set(row, "name", name_obj);
+  }
+
+  olib_object_t* score_obj = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+  olib_object_set_float(score_obj, score);
+  olib_object_struct_set(row, "score", score_obj);
+
+  olib_object_t* active_obj = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
+  olib_object_set_bool(active_obj, active);
+  olib_object_struct_set(row, "active", active_obj);
+
+  return row;
+}
+
+static olib_object_t* make_records() {
+  olib_object_t* records = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(records, make_record(1, "alice", 1.5, true));
+  olib_object_list_push(records, make_record(-2, nullptr, -0.25, false));
+  olib_object_list_push(records, make_record(INT64_MIN, "", 1e300, true));
+
+  olib_object_t* total = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_set_uint(total, UINT64_MAX);
+  olib_object_struct_set(olib_object_list_get(records, 2), "total", total);
+  return records;
+}
+
+// Stream written by pyarrow 26: int8, uint16, float32 and utf8 columns with nulls
+static const uint8_t g_pyarrow_stream[] = {
+    0xff, 0xff, 0xff, 0xff, 0x10, 0x01, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00,
+    0x0c, 0x00, 0x06, 0x00, 0x05, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0xa8, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00,
+    0x30, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x78, 0xff, 0xff, 0xff, 0x00, 0x00, 0x01, 0x05,
+    0x10, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x73, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0xa0, 0xff, 0xff, 0xff, 0x00, 0x00, 0x01, 0x03, 0x10, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x66, 0x33, 0x32, 0x00,
+    0x00, 0x00, 0x06, 0x00, 0x08, 0x00, 0x06, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0xd0, 0xff, 0xff, 0xff, 0x00, 0x00, 0x01, 0x02, 0x10, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x75, 0x31, 0x36, 0x00,
+    0x00, 0x00, 0x06, 0x00, 0x08, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x14, 0x00, 0x08, 0x00, 0x06, 0x00, 0x07, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x10, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x69, 0x38, 0x00, 0x00,
+    0x08, 0x00, 0x0c, 0x00, 0x08, 0x00, 0x07, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x28, 0x01, 0x00, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x16, 0x00, 0x06, 0x00, 0x05, 0x00,
+    0x08, 0x00, 0x0c, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x03, 0x04, 0x00, 0x18, 0x00, 0x00, 0x00,
+    0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x18, 0x00, 0x0c, 0x00,
+    0x04, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x00, 0x00, 0xac, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x3f, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x61, 0x63, 0x63, 0x63, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+};
+
+// =============================================================================
+// Record List Round Trip
+// =============================================================================
+
+TEST(Arrow, RoundTripRecords) {
+  olib_object_t* records = make_records();
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+  EXPECT_EQ(size % 8, 0u);
+
+  olib_object_t* parsed = olib_arrow_read(data, size);
+  ASSERT_NE(parsed, nullptr);
+  ASSERT_EQ(olib_object_list_size(parsed), 3u);
+
+  olib_object_t* row0 = olib_object_list_get(parsed, 0);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(row0, "id")), 1);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(row0, "name")), "alice");
+  EXPECT_DOUBLE_EQ(olib_object_get_float(olib_object_struct_get(row0, "score")), 1.5);
+  EXPECT_TRUE(olib_object_get_bool(olib_object_struct_get(row0, "active")));
+  EXPECT_FALSE(olib_object_struct_has(row0, "total"));
+
+  // Missing keys become nulls, which are left out when reading back
+  olib_object_t* row1 = olib_object_list_get(parsed, 1);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(row1, "id")), -2);
+  EXPECT_FALSE(olib_object_struct_has(row1, "name"));
+  EXPECT_FALSE(olib_object_get_bool(olib_object_struct_get(row1, "active")));
+
+  olib_object_t* row2 = olib_object_list_get(parsed, 2);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(row2, "id")), INT64_MIN);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(row2, "name")), "");
+  EXPECT_DOUBLE_EQ(olib_object_get_float(olib_object_struct_get(row2, "score")), 1e300);
+  EXPECT_EQ(olib_object_get_type(olib_object_struct_get(row2, "total")), OLIB_OBJECT_TYPE_UINT);
+  EXPECT_EQ(olib_object_get_uint(olib_object_struct_get(row2, "total")), UINT64_MAX);
+
+  olib_free(data);
+  olib_object_free(parsed);
+  olib_object_free(records);
+}
+
+TEST(Arrow, RoundTripEmptyList) {
+  olib_object_t* records = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+
+  olib_object_t* parsed = olib_arrow_read(data, size);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_EQ(olib_object_get_type(parsed), OLIB_OBJECT_TYPE_LIST);
+  EXPECT_EQ(olib_object_list_size(parsed), 0u);
+
+  olib_free(data);
+  olib_object_free(parsed);
+  olib_object_free(records);
+}
+
+TEST(Arrow, WriteRejectsNonRecordLists) {
+  uint8_t* data = nullptr;
+  size_t size = 0;
+
+  // Not a list
+  olib_object_t* row = make_record(1, "a", 0.0, true);
+  EXPECT_FALSE(olib_arrow_write(row, &data, &size));
+
+  // List of non-structs
+  olib_object_t* ints = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(ints, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  EXPECT_FALSE(olib_arrow_write(ints, &data, &size));
+
+  // Nested value
+  olib_object_t* nested = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* nested_row = make_record(1, "a", 0.0, true);
+  olib_object_struct_set(nested_row, "tags", olib_object_new(OLIB_OBJECT_TYPE_LIST));
+  olib_object_list_push(nested, nested_row);
+  EXPECT_FALSE(olib_arrow_write(nested, &data, &size));
+
+  // Column changes type between rows
+  olib_object_t* mixed = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(mixed, make_record(1, "a", 0.0, true));
+  olib_object_t* mixed_row = make_record(2, "b", 0.0, true);
+  olib_object_t* id = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(id, "two");
+  olib_object_struct_set(mixed_row, "id", id);
+  olib_object_list_push(mixed, mixed_row);
+  EXPECT_FALSE(olib_arrow_write(mixed, &data, &size));
+
+  olib_object_free(row);
+  olib_object_free(ints);
+  olib_object_free(nested);
+  olib_object_free(mixed);
+}
+
+// =============================================================================
+// Column Views
+// =============================================================================
+
+TEST(Arrow, ColumnViews) {
+  olib_object_t* records = make_records();
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+
+  olib_arrow_reader_t* reader = olib_arrow_reader_new(data, size);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(olib_arrow_reader_column_count(reader), 5u);
+  EXPECT_STREQ(olib_arrow_reader_column_name(reader, 0), "id");
+  EXPECT_STREQ(olib_arrow_reader_column_name(reader, 4), "total");
+
+  ASSERT_TRUE(olib_arrow_reader_next_batch(reader));
+  ASSERT_EQ(olib_arrow_reader_row_count(reader), 3u);
+
+  olib_arrow_column_t id;
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 0, &id));
+  EXPECT_EQ(id.type, OLIB_ARROW_TYPE_INT);
+  EXPECT_EQ(id.bit_width, 64u);
+  EXPECT_EQ(id.null_count, 0u);
+  EXPECT_EQ(id.validity, nullptr);
+  const int64_t* ids = (const int64_t*)id.values;
+  EXPECT_EQ(ids[0], 1);
+  EXPECT_EQ(ids[1], -2);
+  EXPECT_EQ(ids[2], INT64_MIN);
+
+  // The views point into the caller's buffer
+  EXPECT_GE((const uint8_t*)id.values, data);
+  EXPECT_LT((const uint8_t*)id.values, data + size);
+
+  olib_arrow_column_t name;
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 1, &name));
+  EXPECT_EQ(name.type, OLIB_ARROW_TYPE_STRING);
+  EXPECT_EQ(name.null_count, 1u);
+  ASSERT_NE(name.validity, nullptr);
+  EXPECT_EQ(name.validity[0] & 0x7, 0x5);
+  EXPECT_EQ(name.offsets[0], 0);
+  EXPECT_EQ(name.offsets[1], 5);
+  EXPECT_EQ(name.offsets[2], 5);
+  EXPECT_EQ(name.offsets[3], 5);
+  EXPECT_EQ(std::string((const char*)name.values, 5), "alice");
+
+  olib_arrow_column_t active;
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 3, &active));
+  EXPECT_EQ(active.type, OLIB_ARROW_TYPE_BOOL);
+  EXPECT_EQ(((const uint8_t*)active.values)[0] & 0x7, 0x5);
+
+  olib_arrow_column_t total;
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 4, &total));
+  EXPECT_EQ(total.type, OLIB_ARROW_TYPE_UINT);
+  EXPECT_EQ(total.null_count, 2u);
+  EXPECT_EQ(((const uint64_t*)total.values)[2], UINT64_MAX);
+
+  EXPECT_FALSE(olib_arrow_reader_next_batch(reader));
+  EXPECT_FALSE(olib_arrow_reader_failed(reader));
+
+  olib_arrow_reader_free(reader);
+  olib_free(data);
+  olib_object_free(records);
+}
+
+TEST(Arrow, ReadsMisalignedInput) {
+  olib_object_t* records = make_records();
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+
+  std::vector<uint8_t> shifted(size + 1);
+  memcpy(shifted.data() + 1, data, size);
+
+  olib_object_t* parsed = olib_arrow_read(shifted.data() + 1, size);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_EQ(olib_object_list_size(parsed), 3u);
+
+  olib_free(data);
+  olib_object_free(parsed);
+  olib_object_free(records);
+}
+
+// =============================================================================
+// Interop and Malformed Input
+// =============================================================================
+
+TEST(Arrow, ReadsPyarrowStream) {
+  olib_arrow_reader_t* reader = olib_arrow_reader_new(g_pyarrow_stream, sizeof(g_pyarrow_stream));
+  ASSERT_NE(reader, nullptr);
+  ASSERT_TRUE(olib_arrow_reader_next_batch(reader));
+
+  olib_arrow_column_t column;
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 0, &column));
+  EXPECT_EQ(column.type, OLIB_ARROW_TYPE_INT);
+  EXPECT_EQ(column.bit_width, 8u);
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 1, &column));
+  EXPECT_EQ(column.type, OLIB_ARROW_TYPE_UINT);
+  EXPECT_EQ(column.bit_width, 16u);
+  ASSERT_TRUE(olib_arrow_reader_column(reader, 2, &column));
+  EXPECT_EQ(column.type, OLIB_ARROW_TYPE_FLOAT);
+  EXPECT_EQ(column.bit_width, 32u);
+  olib_arrow_reader_free(reader);
+
+  olib_object_t* parsed = olib_arrow_read(g_pyarrow_stream, sizeof(g_pyarrow_stream));
+  ASSERT_NE(parsed, nullptr);
+  ASSERT_EQ(olib_object_list_size(parsed), 3u);
+
+  olib_object_t* row1 = olib_object_list_get(parsed, 1);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(row1, "i8")), -2);
+  EXPECT_EQ(olib_object_get_uint(olib_object_struct_get(row1, "u16")), 65535u);
+  EXPECT_FALSE(olib_object_struct_has(row1, "f32"));
+  EXPECT_FALSE(olib_object_struct_has(row1, "s"));
+
+  olib_object_t* row2 = olib_object_list_get(parsed, 2);
+  EXPECT_FALSE(olib_object_struct_has(row2, "i8"));
+  EXPECT_FLOAT_EQ((float)olib_object_get_float(olib_object_struct_get(row2, "f32")), 2.0f);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(row2, "s")), "ccc");
+
+  olib_object_free(parsed);
+}
+
+TEST(Arrow, ReadRejectsDuplicateFieldNames) {
+  olib_object_t* records = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* row = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* first = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(first, 1);
+  olib_object_struct_set(row, "colA", first);
+  olib_object_t* second = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(second, 2);
+  olib_object_struct_set(row, "colB", second);
+  olib_object_list_push(records, row);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+
+  // Rename the second field in the schema so both are called colA
+  bool renamed = false;
+  for (size_t i = 0; i + 4 <= size && !renamed; i++) {
+    if (memcmp(data + i, "colB", 4) == 0) {
+      data[i + 3] = 'A';
+      renamed = true;
+    }
+  }
+  ASSERT_TRUE(renamed);
+
+  // One key would shadow the other in a struct, the column views still read both
+  EXPECT_EQ(olib_arrow_read(data, size), nullptr);
+  olib_arrow_reader_t* reader = olib_arrow_reader_new(data, size);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(olib_arrow_reader_column_count(reader), 2u);
+  EXPECT_STREQ(olib_arrow_reader_column_name(reader, 0), "colA");
+  EXPECT_STREQ(olib_arrow_reader_column_name(reader, 1), "colA");
+  olib_arrow_reader_free(reader);
+
+  olib_free(data);
+  olib_object_free(records);
+}
+
+TEST(Arrow, RejectsTruncatedStreams) {
+  olib_object_t* records = make_records();
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_arrow_write(records, &data, &size));
+
+  // Dropping the end-of-stream marker is allowed, cutting into a message is not
+  olib_object_t* parsed = olib_arrow_read(data, size - 8);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_EQ(olib_object_list_size(parsed), 3u);
+  olib_object_free(parsed);
+
+  for (size_t cut = size - 9; cut > 0; cut--) {
+    parsed = olib_arrow_read(data, cut);
+    if (parsed) {
+      // Only a cut right after the schema message can still parse
+      EXPECT_EQ(olib_object_list_size(parsed), 0u) << "cut at " << cut;
+      olib_object_free(parsed);
+    }
+  }
+
+  olib_free(data);
+  olib_object_free(records);
+}
@@ -0,0 +1,143 @@
+#include "test_utils.h"
+#include <string>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+static std::string to_json(olib_object_t* obj) {
+  char* str = nullptr;
+  EXPECT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &str));
+  std::string result = str ? str : "";
+  olib_free(str);
+  return result;
+}
+
+static std::string emit(olib_object_t* obj, const char* name) {
+  char* source = nullptr;
+  EXPECT_TRUE(olib_frozen_emit_c(obj, name, &source));
+  std::string result = source ? source : "";
+  olib_free(source);
+  return result;
+}
+
+// The layout olib_frozen_emit_c generates for {"name": "olib", "ports": [80, 443], "debug": true}
+static const olib_frozen_t demo_n0 = OLIB_FROZEN_STRING("olib");
+static const olib_frozen_t demo_n1 = OLIB_FROZEN_INT(INT64_C(80));
+static const olib_frozen_t demo_n2 = OLIB_FROZEN_INT(INT64_C(443));
+static const olib_frozen_t* const demo_a3[] = {&demo_n1, &demo_n2};
+static const olib_frozen_t demo_n3 = OLIB_FROZEN_LIST(demo_a3, 2);
+static const olib_frozen_t demo_n4 = OLIB_FROZEN_BOOL(true);
+static const olib_frozen_t demo_n5 = OLIB_FROZEN_LIST(NULL, 0);
+static const olib_frozen_entry_t demo_a6[] = {
+    {"name", &demo_n0},
+    {"ports", &demo_n3},
+    {"debug", &demo_n4},
+    {"empty", &demo_n5},
+};
+static const olib_frozen_t demo_n6 = OLIB_FROZEN_STRUCT(demo_a6, 4);
+
+// =============================================================================
+// Frozen Nodes
+// =============================================================================
+
+TEST(Frozen, GettersReadStaticNodes) {
+  olib_object_t* root = olib_frozen_object(&demo_n6);
+
+  EXPECT_EQ(olib_object_get_type(root), OLIB_OBJECT_TYPE_STRUCT);
+  EXPECT_EQ(olib_object_struct_size(root), 4u);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(root, "name")), "olib");
+  EXPECT_TRUE(olib_object_get_bool(olib_object_struct_get(root, "debug")));
+
+  olib_object_t* ports = olib_object_struct_get(root, "ports");
+  ASSERT_EQ(olib_object_list_size(ports), 2u);
+  EXPECT_EQ(olib_object_get_int(olib_object_list_get(ports, 1)), 443);
+  EXPECT_EQ(olib_object_list_size(olib_object_struct_get(root, "empty")), 0u);
+}
+
+TEST(Frozen, DupeAndWriteMatchTheSource) {
+  olib_object_t* source = olib_format_read_string(OLIB_FORMAT_JSON_TEXT,
+                                                  "{\"name\": \"olib\", \"ports\": [80, 443], \"debug\": true, \"empty\": []}");
+  ASSERT_NE(source, nullptr);
+  olib_object_t* root = olib_frozen_object(&demo_n6);
+  EXPECT_EQ(to_json(root), to_json(source));
+
+  // A dupe is a regular, mutable tree
+  olib_object_t* copy = olib_object_dupe(root);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(olib_object_struct_set(copy, "name", olib_object_new(OLIB_OBJECT_TYPE_STRING)));
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(root, "name")), "olib");
+
+  olib_object_free(copy);
+  olib_object_free(source);
+}
+
+// =============================================================================
+// Emitting C Source
+// =============================================================================
+
+TEST(Frozen, EmitMatchesHandWrittenLayout) {
+  olib_object_t* source = olib_format_read_string(OLIB_FORMAT_JSON_TEXT,
+                                                  "{\"name\": \"olib\", \"ports\": [80, 443], \"debug\": true, \"empty\": []}");
+  ASSERT_NE(source, nullptr);
+  std::string code = emit(source, "demo");
+
+  EXPECT_NE(code.find("#include <olib/olib_frozen.h>"), std::string::npos);
+  EXPECT_NE(code.find("static const olib_frozen_t demo_n0 = OLIB_FROZEN_STRING(\"olib\");"), std::string::npos);
+  EXPECT_NE(code.find("static const olib_frozen_t* const demo_a3[] = {&demo_n1, &demo_n2};"), std::string::npos);
+  EXPECT_NE(code.find("static const olib_frozen_t demo_n5 = OLIB_FROZEN_LIST(NULL, 0);"), std::string::npos);
+  EXPECT_NE(code.find("    {\"ports\", &demo_n3},"), std::string::npos);
+  EXPECT_NE(code.find("static const olib_frozen_t demo_n6 = OLIB_FROZEN_STRUCT(demo_a6, 4);"), std::string::npos);
+  EXPECT_NE(code.find("olib_object_t* demo(void) {\n    return olib_frozen_object(&demo_n6);"), std::string::npos);
+
+  olib_object_free(source);
+}
+
+TEST(Frozen, EmitEscapesAndScalars) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* text = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(text, "a\"b\\c?\?=\n\xC3\xA9");
+  olib_object_list_push(root, text);
+  olib_object_t* min = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(min, INT64_MIN);
+  olib_object_list_push(root, min);
+  olib_object_t* whole = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+  olib_object_set_float(whole, 3.0);
+  olib_object_list_push(root, whole);
+  olib_object_t* big = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_set_uint(big, UINT64_MAX);
+  olib_object_list_push(root, big);
+
+  std::string code = emit(root, "values");
+  EXPECT_NE(code.find("OLIB_FROZEN_STRING(\"a\\\"b\\\\c\\?\\?=\\n\\303\\251\")"), std::string::npos);
+  EXPECT_NE(code.find("OLIB_FROZEN_INT(INT64_MIN)"), std::string::npos);
+  EXPECT_NE(code.find("OLIB_FROZEN_FLOAT(3.0)"), std::string::npos);
+  EXPECT_NE(code.find("OLIB_FROZEN_UINT(UINT64_C(18446744073709551615))"), std::string::npos);
+
+  olib_object_free(root);
+}
+
+TEST(Frozen, EmitMapCopiesHashTable) {
+  olib_object_t* map = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  for (int64_t key = 0; key < 3; key++) {
+    olib_object_map_add(map, key * 7, olib_object_new(OLIB_OBJECT_TYPE_BOOL));
+  }
+  std::string code = emit(map, "ids");
+  EXPECT_NE(code.find("olib_frozen_map_entry_t entries[4];"), std::string::npos);
+  EXPECT_NE(code.find("uint32_t slots[8];"), std::string::npos);
+  EXPECT_NE(code.find("{INT64_C(14), &ids_n2},"), std::string::npos);
+  EXPECT_NE(code.find("OLIB_FROZEN_MAP(ids_a3.entries, 3, 4)"), std::string::npos);
+  olib_object_free(map);
+}
+
+TEST(Frozen, EmitRejectsInvalidNames) {
+  olib_object_t* obj = create_test_object();
+  char* source = nullptr;
+  EXPECT_FALSE(olib_frozen_emit_c(obj, nullptr, &source));
+  EXPECT_FALSE(olib_frozen_emit_c(obj, "", &source));
+  EXPECT_FALSE(olib_frozen_emit_c(obj, "9lives", &source));
+  EXPECT_FALSE(olib_frozen_emit_c(obj, "has-dash", &source));
+  EXPECT_FALSE(olib_frozen_emit_c(nullptr, "name", &source));
+  EXPECT_EQ(source, nullptr);
+  olib_object_free(obj);
+}
@@ -1,4 +1,5 @@
 #include "test_utils.h"
+#include <filesystem>
 
 // =============================================================================
 // Format Serializer Factory Tests
@@ -193,3 +194,158 @@ TEST(Conversion, JsonToTxt) {
   olib_object_free(original);
   olib_object_free(parsed);
 }
+
+TEST(Conversion, BinaryToJsonBinaryMatchesTreePath) {
+  olib_object_t* original = create_test_object();
+  olib_object_t* nested = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(nested, olib_object_new(OLIB_OBJECT_TYPE_STRUCT));
+  olib_object_list_push(nested, olib_object_new(OLIB_OBJECT_TYPE_LIST));
+  olib_object_struct_set(original, "nested_empty", nested);
+
+  uint8_t* binary = nullptr;
+  size_t binary_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, original, &binary, &binary_size));
+  uint8_t* expected = nullptr;
+  size_t expected_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_JSON_BINARY, original, &expected, &expected_size));
+
+  uint8_t* jsonb = nullptr;
+  size_t jsonb_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_BINARY, binary, binary_size, OLIB_FORMAT_JSON_BINARY, &jsonb, &jsonb_size));
+  ASSERT_EQ(jsonb_size, expected_size);
+  EXPECT_EQ(memcmp(jsonb, expected, expected_size), 0);
+
+  uint8_t* back = nullptr;
+  size_t back_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_JSON_BINARY, jsonb, jsonb_size, OLIB_FORMAT_BINARY, &back, &back_size));
+  ASSERT_EQ(back_size, binary_size);
+  EXPECT_EQ(memcmp(back, binary, binary_size), 0);
+
+  olib_object_t* parsed = olib_format_read(OLIB_FORMAT_JSON_BINARY, jsonb, jsonb_size);
+  verify_test_object(parsed);
+
+  olib_free(binary);
+  olib_free(expected);
+  olib_free(jsonb);
+  olib_free(back);
+  olib_object_free(original);
+  olib_object_free(parsed);
+}
+
+TEST(Conversion, BinaryTranscodeNormalizesAndValidates) {
+  // struct { "b": bool(2) } followed by trailing bytes
+  const uint8_t input[] = {
+      0x07, 0x01, 0x00, 0x00, 0x00, 'b', 0x05, 0x02, 0x00, 0x00, 0x00, 0x00, 0xAA, 0xBB};
+
+  uint8_t* out = nullptr;
+  size_t out_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_BINARY, input, sizeof(input), OLIB_FORMAT_JSON_BINARY, &out, &out_size));
+  ASSERT_EQ(out_size, sizeof(input) - 2);
+  EXPECT_EQ(out[7], 1);
+  EXPECT_EQ(memcmp(out, input, 7), 0);
+  olib_free(out);
+
+  // Every truncation cuts into the value
+  for (size_t cut = 1; cut < sizeof(input) - 2; cut++) {
+    out = nullptr;
+    EXPECT_FALSE(olib_convert(OLIB_FORMAT_BINARY, input, cut, OLIB_FORMAT_JSON_BINARY, &out, &out_size))
+        << "cut at " << cut;
+  }
+
+  // Unknown tag and a list count past the end of the data
+  const uint8_t bad_tag[] = {0x09};
+  EXPECT_FALSE(olib_convert(OLIB_FORMAT_BINARY, bad_tag, sizeof(bad_tag), OLIB_FORMAT_JSON_BINARY, &out, &out_size));
+  const uint8_t long_list[] = {0x06, 0xFF, 0xFF, 0xFF, 0xFF, 0x05, 0x01};
+  EXPECT_FALSE(
+      olib_convert(OLIB_FORMAT_BINARY, long_list, sizeof(long_list), OLIB_FORMAT_JSON_BINARY, &out, &out_size));
+}
+
+TEST(Conversion, BinaryToJsonBinaryFilePath) {
+  olib_object_t* original = create_test_object();
+  std::string src_str = (std::filesystem::temp_directory_path() / "olib_transcode_src.bin").string();
+  std::string dst_str = (std::filesystem::temp_directory_path() / "olib_transcode_dst.jsonb").string();
+  const char* src_path = src_str.c_str();
+  const char* dst_path = dst_str.c_str();
+  ASSERT_TRUE(olib_format_write_file_path(OLIB_FORMAT_BINARY, original, src_path));
+
+  EXPECT_TRUE(olib_convert_file_path(OLIB_FORMAT_BINARY, src_path, OLIB_FORMAT_JSON_BINARY, dst_path));
+  olib_object_t* parsed = olib_format_read_file_path(OLIB_FORMAT_JSON_BINARY, dst_path);
+  verify_test_object(parsed);
+
+  // Converting a file onto itself reads it fully first
+  EXPECT_TRUE(olib_convert_file_path(OLIB_FORMAT_JSON_BINARY, dst_path, OLIB_FORMAT_BINARY, dst_path));
+  olib_object_t* reparsed = olib_format_read_file_path(OLIB_FORMAT_BINARY, dst_path);
+  verify_test_object(reparsed);
+
+  remove(src_path);
+  remove(dst_path);
+  olib_object_free(original);
+  olib_object_free(parsed);
+  olib_object_free(reparsed);
+}
+
+TEST(Conversion, MergeSplicesBinaryLikeTreePath) {
+  // Two lists and a scalar, the scalar becomes one element
+  olib_object_t* first = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(first, create_test_object());
+  olib_object_t* second = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* value = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(value, 7);
+  olib_object_list_push(second, value);
+  olib_object_list_push(second, create_test_object());
+  olib_object_t* scalar = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(scalar, "tail");
+
+  uint8_t* parts[3] = {};
+  size_t sizes[3] = {};
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, first, &parts[0], &sizes[0]));
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, second, &parts[1], &sizes[1]));
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, scalar, &parts[2], &sizes[2]));
+
+  uint8_t* spliced = nullptr;
+  size_t spliced_size = 0;
+  ASSERT_TRUE(olib_convert_merge(OLIB_FORMAT_BINARY, parts, sizes, 3, OLIB_FORMAT_JSON_BINARY, &spliced, &spliced_size));
+
+  // Same bytes as merging the trees and writing the result
+  olib_object_t* expected = olib_object_dupe(first);
+  olib_object_t* second_copy = olib_object_dupe(second);
+  ASSERT_TRUE(olib_object_list_concat(expected, second_copy));
+  ASSERT_TRUE(olib_object_list_push(expected, olib_object_dupe(scalar)));
+  uint8_t* tree = nullptr;
+  size_t tree_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_JSON_BINARY, expected, &tree, &tree_size));
+  ASSERT_EQ(spliced_size, tree_size);
+  EXPECT_EQ(memcmp(spliced, tree, tree_size), 0);
+
+  // Text output goes through the tree path
+  uint8_t* merged_json = nullptr;
+  size_t merged_json_size = 0;
+  ASSERT_TRUE(olib_convert_merge(OLIB_FORMAT_BINARY, parts, sizes, 3, OLIB_FORMAT_JSON_TEXT, &merged_json, &merged_json_size));
+  olib_object_t* from_text = read_any_format(OLIB_FORMAT_JSON_TEXT, merged_json, merged_json_size);
+  EXPECT_EQ(olib_object_list_size(from_text), 4u);
+
+  olib_object_t* merged = olib_format_read(OLIB_FORMAT_JSON_BINARY, spliced, spliced_size);
+  ASSERT_EQ(olib_object_list_size(merged), 4u);
+  verify_test_object(olib_object_list_get(merged, 0));
+  EXPECT_EQ(olib_object_get_int(olib_object_list_get(merged, 1)), 7);
+  verify_test_object(olib_object_list_get(merged, 2));
+  EXPECT_STREQ(olib_object_get_string(olib_object_list_get(merged, 3)), "tail");
+
+  // A truncated input fails the whole merge
+  sizes[1]--;
+  uint8_t* out = nullptr;
+  size_t out_size = 0;
+  EXPECT_FALSE(olib_convert_merge(OLIB_FORMAT_BINARY, parts, sizes, 3, OLIB_FORMAT_BINARY, &out, &out_size));
+
+  for (uint8_t* part : parts) olib_free(part);
+  olib_free(spliced);
+  olib_free(merged_json);
+  olib_free(tree);
+  olib_object_free(from_text);
+  olib_object_free(expected);
+  olib_object_free(second_copy);
+  olib_object_free(merged);
+  olib_object_free(first);
+  olib_object_free(second);
+  olib_object_free(scalar);
+}
@@ -1,9 +1,9 @@
-#include <gtest/gtest.h>
-#include <olib.h>
+#include "test_utils.h"
 #include <cstdlib>
 
 static int g_malloc_count = 0;
 static int g_free_count = 0;
+static int g_realloc_count = 0;
 
 static void* test_malloc(size_t size)
 {
@@ -25,6 +25,7 @@ static void* test_calloc(size_t num, size_t size)
 
 static void* test_realloc(void* ptr, size_t new_size)
 {
+    g_realloc_count++;
     return realloc(ptr, new_size);
 }
 
@@ -110,3 +111,43 @@ TEST(Memory, DefaultAllocatorsWork)
 
     olib_object_free(obj);
 }
+
+TEST(Memory, ReadIntoSteadyStateDoesNotAllocate)
+{
+    // Lists of structs are avoided because the TOML writer cannot express them
+    olib_object_t* original = create_test_object();
+    olib_object_t* names = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    for (int i = 0; i < 16; i++) {
+        olib_object_t* name = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+        olib_object_set_string(name, "item name");
+        olib_object_list_push(names, name);
+    }
+    olib_object_struct_add(original, "names", names);
+
+    for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+        olib_format_t format = (olib_format_t)f;
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        ASSERT_TRUE(write_any_format(format, original, &data, &size)) << "format " << f;
+
+        olib_serializer_t* ser = olib_format_serializer(format);
+        olib_object_t* tree = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+        ASSERT_TRUE(olib_serializer_read_into(ser, data, size, tree)) << "format " << f;
+
+        g_malloc_count = 0;
+        g_realloc_count = 0;
+        olib_set_memory_fns(test_malloc, test_free, test_calloc, test_realloc);
+        bool ok = olib_serializer_read_into(ser, data, size, tree);
+        olib_set_memory_fns(nullptr, nullptr, nullptr, nullptr);
+
+        EXPECT_TRUE(ok) << "format " << f;
+        EXPECT_EQ(g_malloc_count, 0) << "format " << f;
+        EXPECT_EQ(g_realloc_count, 0) << "format " << f;
+
+        olib_object_free(tree);
+        olib_serializer_free(ser);
+        olib_free(data);
+    }
+
+    olib_object_free(original);
+}
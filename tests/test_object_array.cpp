@@ -134,3 +134,39 @@ TEST(ObjectList, OutOfBoundsGet)
 
     olib_object_free(arr);
 }
+
+TEST(ObjectList, SplitAndConcat)
+{
+    olib_object_t* arr = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    for (int i = 0; i < 5; i++) {
+        olib_object_t* val = olib_object_new(OLIB_OBJECT_TYPE_INT);
+        olib_object_set_int(val, i);
+        olib_object_list_push(arr, val);
+    }
+
+    // Split past the end should fail, split at the end gives an empty list
+    EXPECT_EQ(olib_object_list_split(arr, 6), nullptr);
+    olib_object_t* empty = olib_object_list_split(arr, 5);
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(olib_object_list_size(empty), 0u);
+    EXPECT_EQ(olib_object_list_size(arr), 5u);
+
+    olib_object_t* tail = olib_object_list_split(arr, 2);
+    ASSERT_NE(tail, nullptr);
+    EXPECT_EQ(olib_object_list_size(arr), 2u);
+    EXPECT_EQ(olib_object_list_size(tail), 3u);
+    EXPECT_EQ(olib_object_get_int(olib_object_list_get(tail, 0)), 2);
+
+    EXPECT_FALSE(olib_object_list_concat(arr, arr));
+    EXPECT_TRUE(olib_object_list_concat(arr, empty));
+    EXPECT_TRUE(olib_object_list_concat(arr, tail));
+    EXPECT_EQ(olib_object_list_size(tail), 0u);
+    ASSERT_EQ(olib_object_list_size(arr), 5u);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(olib_object_get_int(olib_object_list_get(arr, i)), i);
+    }
+
+    olib_object_free(empty);
+    olib_object_free(tail);
+    olib_object_free(arr);
+}
@@ -0,0 +1,325 @@
+#include <gtest/gtest.h>
+#include <olib.h>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static olib_object_t* new_int(int64_t value)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(obj, value);
+    return obj;
+}
+
+TEST(ObjectMap, EmptyMap)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    ASSERT_NE(obj, nullptr);
+
+    EXPECT_EQ(olib_object_map_size(obj), 0u);
+    EXPECT_FALSE(olib_object_map_has(obj, 1));
+    EXPECT_EQ(olib_object_map_get(obj, 1), nullptr);
+    EXPECT_EQ(olib_object_map_value_at(obj, 0), nullptr);
+    EXPECT_FALSE(olib_object_map_remove(obj, 1));
+    EXPECT_STREQ(olib_object_type_to_string(OLIB_OBJECT_TYPE_MAP), "map");
+
+    olib_object_free(obj);
+}
+
+TEST(ObjectMap, AddGetSetRemove)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+
+    EXPECT_TRUE(olib_object_map_add(obj, 42, new_int(1)));
+    EXPECT_TRUE(olib_object_map_add(obj, -7, new_int(2)));
+    EXPECT_TRUE(olib_object_map_add(obj, (int64_t)UINT64_MAX, new_int(3)));
+
+    olib_object_t* dup = new_int(4);
+    EXPECT_FALSE(olib_object_map_add(obj, 42, dup));  // Should fail
+    olib_object_free(dup);
+
+    EXPECT_EQ(olib_object_map_size(obj), 3u);
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(obj, 42)), 1);
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(obj, -7)), 2);
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(obj, (int64_t)UINT64_MAX)), 3);
+
+    EXPECT_TRUE(olib_object_map_set(obj, 42, new_int(5)));
+    EXPECT_EQ(olib_object_map_size(obj), 3u);
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(obj, 42)), 5);
+
+    EXPECT_TRUE(olib_object_map_remove(obj, -7));
+    EXPECT_FALSE(olib_object_map_has(obj, -7));
+    EXPECT_EQ(olib_object_map_size(obj), 2u);
+
+    // Wrong types are rejected
+    olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+    olib_object_t* val = new_int(0);
+    EXPECT_FALSE(olib_object_map_add(list, 1, val));
+    EXPECT_EQ(olib_object_map_size(list), 0u);
+    olib_object_free(val);
+    olib_object_free(list);
+
+    olib_object_free(obj);
+}
+
+TEST(ObjectMap, MatchesStdMapUnderChurn)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    std::map<int64_t, int64_t> expected;
+    std::mt19937_64 rng(1234);
+
+    for (int i = 0; i < 20000; i++) {
+        // A small key range keeps probe runs long and removals frequent
+        int64_t key = (int64_t)(rng() % 2048) - 1024;
+        switch (rng() % 3) {
+            case 0:
+                EXPECT_EQ(olib_object_map_remove(obj, key), expected.erase(key) == 1);
+                break;
+            default:
+                ASSERT_TRUE(olib_object_map_set(obj, key, new_int(i)));
+                expected[key] = i;
+                break;
+        }
+    }
+
+    ASSERT_EQ(olib_object_map_size(obj), expected.size());
+    for (const auto& [key, value] : expected) {
+        olib_object_t* item = olib_object_map_get(obj, key);
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(olib_object_get_int(item), value);
+    }
+    for (size_t i = 0; i < olib_object_map_size(obj); i++) {
+        EXPECT_EQ(olib_object_map_get(obj, olib_object_map_key_at(obj, i)), olib_object_map_value_at(obj, i));
+    }
+
+    olib_object_free(obj);
+}
+
+TEST(ObjectMap, SortOrdersByKey)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    const int64_t keys[] = {30, -5, 12, 7, -100, 0};
+    for (int64_t key : keys) {
+        olib_object_map_add(obj, key, new_int(key * 2));
+    }
+
+    EXPECT_EQ(olib_object_map_key_at(obj, 0), 30);  // Insertion order before sorting
+    ASSERT_TRUE(olib_object_map_sort(obj));
+
+    const int64_t sorted[] = {-100, -5, 0, 7, 12, 30};
+    for (size_t i = 0; i < 6; i++) {
+        EXPECT_EQ(olib_object_map_key_at(obj, i), sorted[i]);
+        EXPECT_EQ(olib_object_get_int(olib_object_map_value_at(obj, i)), sorted[i] * 2);
+        // Lookups still work after the entries moved
+        EXPECT_EQ(olib_object_get_int(olib_object_map_get(obj, sorted[i])), sorted[i] * 2);
+    }
+
+    olib_object_free(obj);
+}
+
+TEST(ObjectMap, Dupe)
+{
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    for (int64_t key = 0; key < 100; key++) {
+        olib_object_map_add(obj, key * 1000003, new_int(key));
+    }
+
+    olib_object_t* copy = olib_object_dupe(obj);
+    ASSERT_NE(copy, nullptr);
+    olib_object_free(obj);
+
+    ASSERT_EQ(olib_object_map_size(copy), 100u);
+    for (int64_t key = 0; key < 100; key++) {
+        EXPECT_EQ(olib_object_get_int(olib_object_map_get(copy, key * 1000003)), key);
+    }
+
+    olib_object_free(copy);
+}
+
+// =============================================================================
+// Serialization
+// =============================================================================
+
+static olib_object_t* create_test_map()
+{
+    olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+    olib_object_t* map = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    olib_object_map_add(map, 17, new_int(1));
+    olib_object_map_add(map, -3, new_int(2));
+    olib_object_map_add(map, INT64_MAX, new_int(3));
+    olib_object_struct_add(root, "ids", map);
+    return root;
+}
+
+TEST(ObjectMap, BinaryRoundTripKeepsMap)
+{
+    olib_object_t* root = create_test_map();
+
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, root, &data, &size));
+    olib_object_t* back = olib_format_read(OLIB_FORMAT_BINARY, data, size);
+    olib_free(data);
+    ASSERT_NE(back, nullptr);
+
+    olib_object_t* map = olib_object_struct_get(back, "ids");
+    ASSERT_EQ(olib_object_get_type(map), OLIB_OBJECT_TYPE_MAP);
+    ASSERT_EQ(olib_object_map_size(map), 3u);
+    EXPECT_EQ(olib_object_map_key_at(map, 0), 17);
+    EXPECT_EQ(olib_object_map_key_at(map, 1), -3);
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(map, INT64_MAX)), 3);
+
+    // Reading into the existing tree reuses the map, follows the new order and drops vanished keys
+    olib_object_t* next = olib_object_struct_get(root, "ids");
+    olib_object_map_remove(next, -3);
+    olib_object_map_add(next, 5, new_int(4));
+    olib_object_map_sort(next);
+    ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, root, &data, &size));
+    olib_serializer_t* serializer = olib_serializer_new_binary();
+    EXPECT_TRUE(olib_serializer_read_into(serializer, data, size, back));
+    olib_serializer_free(serializer);
+    olib_free(data);
+    EXPECT_EQ(olib_object_struct_get(back, "ids"), map);
+    ASSERT_EQ(olib_object_map_size(map), 3u);
+    EXPECT_EQ(olib_object_map_key_at(map, 0), 5);
+    EXPECT_EQ(olib_object_map_key_at(map, 1), 17);
+    EXPECT_EQ(olib_object_map_key_at(map, 2), INT64_MAX);
+    EXPECT_FALSE(olib_object_map_has(map, -3));
+    EXPECT_EQ(olib_object_get_int(olib_object_map_get(map, 5)), 4);
+
+    olib_object_free(back);
+    olib_object_free(root);
+}
+
+TEST(ObjectMap, TextFormatsWriteStruct)
+{
+    olib_object_t* root = create_test_map();
+
+    char* text = nullptr;
+    ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, root, &text));
+    olib_object_t* back = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, text);
+    olib_free(text);
+    ASSERT_NE(back, nullptr);
+
+    olib_object_t* ids = olib_object_struct_get(back, "ids");
+    ASSERT_EQ(olib_object_get_type(ids), OLIB_OBJECT_TYPE_STRUCT);
+    EXPECT_EQ(olib_object_get_int(olib_object_struct_get(ids, "17")), 1);
+    EXPECT_EQ(olib_object_get_int(olib_object_struct_get(ids, "-3")), 2);
+    EXPECT_EQ(olib_object_get_int(olib_object_struct_get(ids, "9223372036854775807")), 3);
+
+    olib_object_free(back);
+    olib_object_free(root);
+}
+
+TEST(ObjectMap, TextFormatsRoundTripKeys)
+{
+    // Every text format reads the decimal keys back, including negative ones, for maps at
+    // the root and nested in another map
+    const olib_format_t formats[] = {OLIB_FORMAT_JSON_TEXT, OLIB_FORMAT_YAML, OLIB_FORMAT_XML, OLIB_FORMAT_TOML, OLIB_FORMAT_TXT};
+    const int64_t keys[] = {5, -5, 0, INT64_MIN, INT64_MAX};
+
+    olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    for (size_t i = 0; i < 5; i++) {
+        olib_object_map_add(root, keys[i], new_int((int64_t)i));
+    }
+    olib_object_t* inner = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    olib_object_map_add(inner, -7, new_int(7));
+    olib_object_t* outer = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    olib_object_map_add(outer, -1, inner);
+    olib_object_map_add(root, 1, outer);
+
+    for (olib_format_t format : formats) {
+        SCOPED_TRACE(testing::Message() << "format " << (int)format);
+        char* text = nullptr;
+        ASSERT_TRUE(olib_format_write_string(format, root, &text));
+        olib_object_t* back = olib_format_read_string(format, text);
+        olib_free(text);
+        ASSERT_NE(back, nullptr);
+        ASSERT_EQ(olib_object_get_type(back), OLIB_OBJECT_TYPE_STRUCT);
+
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(back, "5")), 0);
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(back, "-5")), 1);
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(back, "0")), 2);
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(back, "-9223372036854775808")), 3);
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(back, "9223372036854775807")), 4);
+        olib_object_t* nested = olib_object_struct_get(olib_object_struct_get(back, "1"), "-1");
+        EXPECT_EQ(olib_object_get_int(olib_object_struct_get(nested, "-7")), 7);
+
+        olib_object_free(back);
+    }
+
+    olib_object_free(root);
+}
+
+TEST(ObjectMap, CorruptCountRejected)
+{
+    // Map tag followed by a huge varint count and nothing else
+    const uint8_t data[] = {0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+    EXPECT_EQ(olib_format_read(OLIB_FORMAT_BINARY, data, sizeof(data)), nullptr);
+}
+
+// =============================================================================
+// Transactions and Observers
+// =============================================================================
+
+TEST(ObjectMap, RollbackRestoresOrder)
+{
+    olib_object_t* root = create_test_map();
+    olib_object_t* map = olib_object_struct_get(root, "ids");
+    olib_observer_t* observer = olib_observer_new(root);
+    olib_txn_t* txn = olib_txn_begin(root);
+    ASSERT_NE(txn, nullptr);
+
+    EXPECT_TRUE(olib_object_map_remove(map, 17));
+    EXPECT_TRUE(olib_object_map_add(map, 99, new_int(4)));
+    EXPECT_TRUE(olib_object_map_set(map, -3, new_int(5)));
+    EXPECT_FALSE(olib_object_map_sort(map));
+    olib_txn_rollback(txn);
+
+    const int64_t keys[] = {17, -3, INT64_MAX};
+    ASSERT_EQ(olib_object_map_size(map), 3u);
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(olib_object_map_key_at(map, i), keys[i]);
+        EXPECT_EQ(olib_object_get_int(olib_object_map_value_at(map, i)), (int64_t)i + 1);
+    }
+    EXPECT_FALSE(olib_object_map_has(map, 99));
+
+    olib_observer_free(observer);
+    olib_object_free(root);
+}
+
+struct MapPaths {
+    std::vector<std::string> paths;
+};
+
+static void record_paths(void* ctx, const olib_change_t* changes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        ((MapPaths*)ctx)->paths.push_back(changes[i].path);
+    }
+}
+
+TEST(ObjectMap, ObserverPathsUseKeys)
+{
+    olib_object_t* root = create_test_map();
+    olib_object_t* map = olib_object_struct_get(root, "ids");
+    olib_observer_t* observer = olib_observer_new(root);
+    ASSERT_NE(observer, nullptr);
+    MapPaths recorded;
+    olib_observer_subscribe(observer, "ids[-3]", record_paths, &recorded);
+
+    olib_object_set_int(olib_object_map_get(map, -3), 7);
+    olib_object_set_int(olib_object_map_get(map, 17), 8);
+    EXPECT_TRUE(olib_object_map_set(map, -3, new_int(9)));
+    EXPECT_TRUE(olib_object_map_remove(map, -3));
+
+    ASSERT_EQ(recorded.paths.size(), 3u);
+    for (const std::string& path : recorded.paths) {
+        EXPECT_EQ(path, "ids[-3]");
+    }
+
+    olib_observer_free(observer);
+    olib_object_free(root);
+}
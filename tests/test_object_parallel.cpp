@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <olib.h>
+#include <string>
+#include "test_utils.h"
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+// A wide list of structs, each holding a map and a nested list, so every container type
+// is large enough to be split with a small min_children
+static olib_object_t* create_wide_tree(size_t width) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (size_t i = 0; i < width; i++) {
+    olib_object_t* item = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+    olib_object_t* id = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(id, (int64_t)i);
+    olib_object_struct_set(item, "id", id);
+    olib_object_t* name = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(name, ("item-" + std::to_string(i)).c_str());
+    olib_object_struct_set(item, "name", name);
+    olib_object_t* ratio = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+    olib_object_set_float(ratio, (double)i / 7.0);
+    olib_object_struct_set(item, "ratio", ratio);
+    olib_object_t* scores = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+    for (int64_t k = 0; k < 8; k++) {
+      olib_object_t* score = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+      olib_object_set_uint(score, (uint64_t)(i * k));
+      olib_object_map_set(scores, k * 3 - 5, score);
+    }
+    olib_object_struct_set(item, "scores", scores);
+    olib_object_list_push(root, item);
+  }
+  olib_object_t* big_map = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  for (size_t i = 0; i < width; i++) {
+    olib_object_t* flag = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
+    olib_object_set_bool(flag, i % 3 == 0);
+    olib_object_map_set(big_map, (int64_t)(i * 11), flag);
+  }
+  olib_object_list_push(root, big_map);
+  return root;
+}
+
+static const olib_parallel_config_t k_split_config = {4, 16};
+
+// =============================================================================
+// Equality and hashing
+// =============================================================================
+
+TEST(ObjectParallel, EqualAndHash) {
+  olib_object_t* a = create_test_object();
+  olib_object_t* b = create_test_object();
+  EXPECT_TRUE(olib_object_equal(a, b));
+  EXPECT_EQ(olib_object_hash(a), olib_object_hash(b));
+  EXPECT_TRUE(olib_object_equal(nullptr, nullptr));
+  EXPECT_FALSE(olib_object_equal(a, nullptr));
+  EXPECT_EQ(olib_object_hash(nullptr), 0u);
+
+  olib_object_set_int(olib_object_struct_get(b, "int_val"), 43);
+  EXPECT_FALSE(olib_object_equal(a, b));
+  EXPECT_NE(olib_object_hash(a), olib_object_hash(b));
+
+  olib_object_free(a);
+  olib_object_free(b);
+}
+
+TEST(ObjectParallel, EqualIsOrderSensitive) {
+  olib_object_t* a = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  olib_object_t* b = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  olib_object_map_set(a, 1, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  olib_object_map_set(a, 2, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  olib_object_map_set(b, 2, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  olib_object_map_set(b, 1, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  EXPECT_FALSE(olib_object_equal(a, b));
+
+  olib_object_map_sort(b);
+  EXPECT_TRUE(olib_object_equal(a, b));
+  EXPECT_EQ(olib_object_hash(a), olib_object_hash(b));
+
+  olib_object_free(a);
+  olib_object_free(b);
+}
+
+// =============================================================================
+// Parallel variants
+// =============================================================================
+
+TEST(ObjectParallel, DupeMatchesSerial) {
+  olib_object_t* tree = create_wide_tree(5000);
+  olib_object_t* copy = olib_object_dupe_parallel(tree, &k_split_config);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(olib_object_equal(tree, copy));
+
+  // Children keep their order
+  olib_object_t* item = olib_object_list_get(copy, 1234);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(item, "id")), 1234);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(item, "name")), "item-1234");
+
+  // The copy is deep and its maps still look keys up
+  olib_object_t* big_map = olib_object_list_get(copy, 5000);
+  EXPECT_TRUE(olib_object_get_bool(olib_object_map_get(big_map, 33)));
+  olib_object_set_int(olib_object_struct_get(item, "id"), -1);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(olib_object_list_get(tree, 1234), "id")), 1234);
+
+  olib_object_free_parallel(copy, &k_split_config);
+  olib_object_free_parallel(tree, &k_split_config);
+}
+
+TEST(ObjectParallel, EqualAndHashMatchSerial) {
+  olib_object_t* a = create_wide_tree(5000);
+  olib_object_t* b = olib_object_dupe(a);
+
+  EXPECT_TRUE(olib_object_equal_parallel(a, b, &k_split_config));
+  uint64_t hash = olib_object_hash(a);
+  EXPECT_EQ(olib_object_hash_parallel(a, &k_split_config), hash);
+  olib_parallel_config_t other = {3, 100};
+  EXPECT_EQ(olib_object_hash_parallel(a, &other), hash);
+
+  // A difference deep inside one chunk
+  olib_object_set_uint(olib_object_map_get(olib_object_struct_get(olib_object_list_get(b, 4321), "scores"), 4), 1);
+  EXPECT_FALSE(olib_object_equal_parallel(a, b, &k_split_config));
+  EXPECT_FALSE(olib_object_equal(a, b));
+  EXPECT_EQ(olib_object_hash_parallel(b, &k_split_config), olib_object_hash(b));
+  EXPECT_NE(olib_object_hash_parallel(b, &k_split_config), hash);
+
+  olib_object_free(a);
+  olib_object_free(b);
+}
+
+TEST(ObjectParallel, SmallTreesAndDefaults) {
+  olib_object_t* tree = create_test_object();
+  olib_object_t* copy = olib_object_dupe_parallel(tree, nullptr);
+  ASSERT_NE(copy, nullptr);
+  verify_test_object(copy);
+  EXPECT_TRUE(olib_object_equal_parallel(tree, copy, nullptr));
+  EXPECT_EQ(olib_object_hash_parallel(copy, nullptr), olib_object_hash(tree));
+
+  olib_parallel_config_t serial = {1, 0};
+  olib_object_t* serial_copy = olib_object_dupe_parallel(tree, &serial);
+  EXPECT_TRUE(olib_object_equal(tree, serial_copy));
+  olib_object_free_parallel(serial_copy, &serial);
+
+  EXPECT_EQ(olib_object_dupe_parallel(nullptr, nullptr), nullptr);
+  olib_object_free_parallel(nullptr, nullptr);
+
+  olib_object_free_parallel(copy, nullptr);
+  olib_object_free(tree);
+}
@@ -0,0 +1,314 @@
+#include "test_utils.h"
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+// Copy of a delivered change that outlives the callback
+struct RecordedChange {
+  olib_change_kind_t kind;
+  std::string path;
+  std::string old_json;
+  std::string new_json;
+};
+
+struct Recorder {
+  std::vector<RecordedChange> changes;
+  std::vector<size_t> batch_sizes;
+};
+
+static std::string to_json(olib_object_t* obj) {
+  if (!obj) return "";
+  char* str = nullptr;
+  EXPECT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &str));
+  std::string result = str ? str : "";
+  olib_free(str);
+  // Compact enough for comparisons
+  std::string compact;
+  for (char c : result) {
+    if (c != ' ' && c != '\n') compact += c;
+  }
+  return compact;
+}
+
+static void record_changes(void* ctx, const olib_change_t* changes, size_t count) {
+  Recorder* recorder = (Recorder*)ctx;
+  recorder->batch_sizes.push_back(count);
+  for (size_t i = 0; i < count; i++) {
+    recorder->changes.push_back({changes[i].kind, changes[i].path, to_json(changes[i].old_value),
+                                 to_json(changes[i].new_value)});
+  }
+}
+
+static olib_object_t* new_int(int64_t value) {
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(obj, value);
+  return obj;
+}
+
+// =============================================================================
+// Change Events
+// =============================================================================
+
+TEST(Observer, ValueSetReportsOldAndNew) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+  ASSERT_NE(observer, nullptr);
+  Recorder recorder;
+  ASSERT_NE(olib_observer_subscribe(observer, "", record_changes, &recorder), nullptr);
+
+  olib_object_set_int(olib_object_struct_get(root, "int_val"), 7);
+  olib_object_set_string(olib_object_struct_get(root, "string_val"), "changed");
+  olib_object_set_int(olib_object_struct_get(olib_object_struct_get(root, "nested"), "nested_int"), 1);
+  olib_object_set_int(olib_object_list_get(olib_object_struct_get(root, "list_val"), 2), 5);
+
+  ASSERT_EQ(recorder.changes.size(), 4u);
+  EXPECT_EQ(recorder.changes[0].kind, OLIB_CHANGE_SET);
+  EXPECT_EQ(recorder.changes[0].path, "int_val");
+  EXPECT_EQ(recorder.changes[0].old_json, "-42");
+  EXPECT_EQ(recorder.changes[0].new_json, "7");
+  EXPECT_EQ(recorder.changes[1].path, "string_val");
+  EXPECT_EQ(recorder.changes[1].new_json, "\"changed\"");
+  EXPECT_EQ(recorder.changes[2].path, "nested.nested_int");
+  EXPECT_EQ(recorder.changes[2].old_json, "999");
+  EXPECT_EQ(recorder.changes[3].path, "list_val[2]");
+  EXPECT_EQ(recorder.changes[3].old_json, "200");
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Observer, ContainerMutations) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+  Recorder recorder;
+  olib_observer_subscribe(observer, "", record_changes, &recorder);
+
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  olib_object_list_insert(list, 0, new_int(-1));
+  olib_object_list_set(list, 1, new_int(11));
+  olib_object_list_pop(list);
+  olib_object_struct_add(root, "added", new_int(3));
+  olib_object_struct_set(root, "added", new_int(4));
+  olib_object_struct_remove(root, "added");
+
+  ASSERT_EQ(recorder.changes.size(), 6u);
+  EXPECT_EQ(recorder.changes[0].kind, OLIB_CHANGE_INSERT);
+  EXPECT_EQ(recorder.changes[0].path, "list_val[0]");
+  EXPECT_EQ(recorder.changes[0].old_json, "");
+  EXPECT_EQ(recorder.changes[0].new_json, "-1");
+  EXPECT_EQ(recorder.changes[1].kind, OLIB_CHANGE_SET);
+  EXPECT_EQ(recorder.changes[1].path, "list_val[1]");
+  EXPECT_EQ(recorder.changes[1].old_json, "0");
+  EXPECT_EQ(recorder.changes[1].new_json, "11");
+  EXPECT_EQ(recorder.changes[2].kind, OLIB_CHANGE_REMOVE);
+  EXPECT_EQ(recorder.changes[2].path, "list_val[3]");
+  EXPECT_EQ(recorder.changes[2].old_json, "200");
+  EXPECT_EQ(recorder.changes[3].kind, OLIB_CHANGE_INSERT);
+  EXPECT_EQ(recorder.changes[3].path, "added");
+  EXPECT_EQ(recorder.changes[4].kind, OLIB_CHANGE_SET);
+  EXPECT_EQ(recorder.changes[4].old_json, "3");
+  EXPECT_EQ(recorder.changes[4].new_json, "4");
+  EXPECT_EQ(recorder.changes[5].kind, OLIB_CHANGE_REMOVE);
+  EXPECT_EQ(recorder.changes[5].old_json, "4");
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Observer, AddedSubtreesAreTrackedAndMovedOnesAreNot) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* items = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_struct_add(root, "items", items);
+  olib_observer_t* observer = olib_observer_new(root);
+  Recorder recorder;
+  olib_observer_subscribe(observer, "items", record_changes, &recorder);
+
+  // A subtree added after the observer was created reports its own changes
+  olib_object_t* item = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_struct_add(item, "count", new_int(0));
+  olib_object_list_push(items, item);
+  for (int i = 0; i < 4; i++) {
+    olib_object_list_push(items, new_int(i));
+  }
+  recorder.changes.clear();
+  olib_object_list_insert(items, 0, new_int(100));
+  olib_object_set_int(olib_object_struct_get(item, "count"), 9);
+  ASSERT_EQ(recorder.changes.size(), 2u);
+  EXPECT_EQ(recorder.changes[1].path, "items[1].count");
+
+  // Split items leave the tree, concatenated ones join it
+  recorder.changes.clear();
+  olib_object_t* tail = olib_object_list_split(items, 4);
+  ASSERT_EQ(recorder.changes.size(), 2u);
+  EXPECT_EQ(recorder.changes[0].path, "items[5]");
+  EXPECT_EQ(recorder.changes[1].path, "items[4]");
+  olib_object_set_int(olib_object_list_get(tail, 0), 50);
+  EXPECT_EQ(recorder.changes.size(), 2u);
+
+  recorder.changes.clear();
+  ASSERT_TRUE(olib_object_list_concat(items, tail));
+  ASSERT_EQ(recorder.changes.size(), 2u);
+  EXPECT_EQ(recorder.changes[0].kind, OLIB_CHANGE_INSERT);
+  EXPECT_EQ(recorder.changes[0].path, "items[4]");
+  EXPECT_EQ(recorder.changes[0].new_json, "50");
+  olib_object_set_int(olib_object_list_get(items, 5), 60);
+  ASSERT_EQ(recorder.changes.size(), 3u);
+  EXPECT_EQ(recorder.changes[2].path, "items[5]");
+
+  olib_object_free(tail);
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+// =============================================================================
+// Subscriptions
+// =============================================================================
+
+TEST(Observer, PrefixMatching) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* user = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_struct_add(user, "name", olib_object_new(OLIB_OBJECT_TYPE_STRING));
+  olib_object_struct_add(user, "age", new_int(30));
+  olib_object_struct_add(root, "user", user);
+  olib_object_struct_add(root, "username", olib_object_new(OLIB_OBJECT_TYPE_STRING));
+
+  olib_observer_t* observer = olib_observer_new(root);
+  Recorder user_recorder;
+  Recorder name_recorder;
+  olib_subscription_t* user_sub = olib_observer_subscribe(observer, "user", record_changes, &user_recorder);
+  olib_observer_subscribe(observer, "user.name", record_changes, &name_recorder);
+
+  olib_object_set_string(olib_object_struct_get(root, "username"), "ignored");
+  olib_object_set_int(olib_object_struct_get(user, "age"), 31);
+  olib_object_set_string(olib_object_struct_get(user, "name"), "ada");
+  EXPECT_EQ(user_recorder.changes.size(), 2u);
+  ASSERT_EQ(name_recorder.changes.size(), 1u);
+  EXPECT_EQ(name_recorder.changes[0].new_json, "\"ada\"");
+
+  // Replacing an ancestor reaches subscribers below it
+  olib_object_struct_set(root, "user", olib_object_new(OLIB_OBJECT_TYPE_STRUCT));
+  ASSERT_EQ(name_recorder.changes.size(), 2u);
+  EXPECT_EQ(name_recorder.changes[1].path, "user");
+
+  olib_observer_unsubscribe(observer, user_sub);
+  olib_object_struct_add(olib_object_struct_get(root, "user"), "name", olib_object_new(OLIB_OBJECT_TYPE_STRING));
+  EXPECT_EQ(user_recorder.changes.size(), 3u);
+  EXPECT_EQ(name_recorder.changes.size(), 3u);
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Observer, BatchesDeliverOnce) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+  Recorder recorder;
+  olib_observer_subscribe(observer, "list_val", record_changes, &recorder);
+
+  olib_observer_batch_begin(observer);
+  olib_observer_batch_begin(observer);
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  for (int i = 0; i < 10; i++) {
+    olib_object_list_push(list, new_int(i));
+  }
+  olib_object_set_int(olib_object_struct_get(root, "int_val"), 0);
+  olib_observer_batch_end(observer);
+  EXPECT_TRUE(recorder.batch_sizes.empty());
+  olib_observer_batch_end(observer);
+
+  ASSERT_EQ(recorder.batch_sizes.size(), 1u);
+  EXPECT_EQ(recorder.batch_sizes[0], 10u);
+  EXPECT_EQ(recorder.changes.back().path, "list_val[12]");
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+// =============================================================================
+// Lifetime
+// =============================================================================
+
+TEST(Observer, OneObserverPerTree) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+  ASSERT_NE(observer, nullptr);
+  EXPECT_EQ(olib_observer_new(root), nullptr);
+  EXPECT_EQ(olib_observer_new(olib_object_struct_get(root, "nested")), nullptr);
+
+  // Freeing the observer releases every node of the tree
+  olib_observer_free(observer);
+  observer = olib_observer_new(olib_object_struct_get(root, "nested"));
+  ASSERT_NE(observer, nullptr);
+  olib_observer_free(observer);
+
+  // Freeing the tree first leaves the observer without a root
+  observer = olib_observer_new(root);
+  olib_object_free(root);
+  olib_observer_free(observer);
+}
+
+TEST(Observer, MutationsWithoutSubscribersAllocateNothing) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+
+  static size_t allocs;
+  allocs = 0;
+  olib_set_memory_fns(
+      [](size_t size) { allocs++; return malloc(size); }, free,
+      [](size_t num, size_t size) { allocs++; return calloc(num, size); },
+      [](void* ptr, size_t size) { allocs++; return realloc(ptr, size); });
+  for (int i = 0; i < 100; i++) {
+    olib_object_set_int(olib_object_struct_get(root, "int_val"), i);
+    olib_object_set_int(olib_object_list_get(olib_object_struct_get(root, "list_val"), 1), i);
+  }
+  olib_set_memory_fns(malloc, free, calloc, realloc);
+  EXPECT_EQ(allocs, 0u);
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Observer, PathsFollowShiftedChildren) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* items = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 10000; i++) {
+    olib_object_list_push(items, new_int(i));
+  }
+  olib_object_struct_add(root, "items", items);
+  olib_object_t* map = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  for (int i = 0; i < 10; i++) {
+    olib_object_map_add(map, i, new_int(i));
+  }
+  olib_object_struct_add(root, "map", map);
+  olib_observer_t* observer = olib_observer_new(root);
+  Recorder recorder;
+  olib_observer_subscribe(observer, "", record_changes, &recorder);
+
+  olib_object_t* item = olib_object_list_get(items, 9000);
+  olib_object_set_int(item, -1);
+  olib_object_list_insert(items, 0, new_int(-2));
+  olib_object_set_int(item, -3);
+  olib_object_list_remove(items, 5);
+  olib_object_list_remove(items, 0);
+  olib_object_set_int(item, -4);
+
+  // Removing a map entry moves the last one into its place
+  olib_object_t* last = olib_object_map_get(map, 9);
+  olib_object_map_remove(map, 2);
+  olib_object_set_int(last, -5);
+
+  std::vector<std::string> paths;
+  for (const RecordedChange& change : recorder.changes) {
+    if (change.kind == OLIB_CHANGE_SET) {
+      paths.push_back(change.path);
+    }
+  }
+  const std::vector<std::string> expected = {"items[9000]", "items[9001]", "items[8999]", "map[9]"};
+  EXPECT_EQ(paths, expected);
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
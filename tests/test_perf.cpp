@@ -0,0 +1,259 @@
+#include "test_utils.h"
+#include <filesystem>
+#include <vector>
+
+// Counters may be unavailable on the machine running the tests (virtual machines,
+// containers, non-Linux), so these tests only check what holds either way.
+
+// =============================================================================
+// Counter Management
+// =============================================================================
+
+TEST(Perf, CounterNames) {
+  EXPECT_STREQ(olib_perf_counter_to_string(OLIB_PERF_CYCLES), "cycles");
+  EXPECT_STREQ(olib_perf_counter_to_string(OLIB_PERF_DTLB_MISSES), "dtlb-misses");
+  EXPECT_STREQ(olib_perf_counter_to_string(OLIB_PERF_COUNTER_MAX), "unknown");
+}
+
+TEST(Perf, BeginEnd) {
+  olib_perf_t* perf = olib_perf_new();
+  ASSERT_NE(perf, nullptr);
+
+  olib_perf_result_t result;
+  EXPECT_FALSE(olib_perf_end(perf, &result));
+
+  ASSERT_TRUE(olib_perf_begin(perf));
+  EXPECT_FALSE(olib_perf_begin(perf));
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < 100000; i++) {
+    sum = sum + (uint64_t)i;
+  }
+  ASSERT_TRUE(olib_perf_end(perf, &result));
+  EXPECT_GE(result.wall_ns, 0.0);
+
+  for (int i = 0; i < OLIB_PERF_COUNTER_MAX; i++) {
+    if (!olib_perf_is_available(perf, (olib_perf_counter_t)i)) {
+      EXPECT_FALSE(result.available[i]);
+      EXPECT_EQ(result.counts[i], 0u);
+    }
+  }
+  if (result.available[OLIB_PERF_INSTRUCTIONS]) {
+    EXPECT_GT(result.counts[OLIB_PERF_INSTRUCTIONS], 100000u);
+  }
+
+  olib_perf_free(perf);
+}
+
+TEST(Perf, Normalize) {
+  olib_perf_result_t result = {};
+  result.available[OLIB_PERF_CYCLES] = true;
+  result.counts[OLIB_PERF_CYCLES] = 1000;
+  result.counts[OLIB_PERF_INSTRUCTIONS] = 500;  // Not available, must be ignored
+
+  olib_perf_normalize(&result, 250, 10);
+  EXPECT_EQ(result.bytes, 250u);
+  EXPECT_EQ(result.nodes, 10u);
+  EXPECT_DOUBLE_EQ(result.per_byte[OLIB_PERF_CYCLES], 4.0);
+  EXPECT_DOUBLE_EQ(result.per_node[OLIB_PERF_CYCLES], 100.0);
+  EXPECT_DOUBLE_EQ(result.per_byte[OLIB_PERF_INSTRUCTIONS], 0.0);
+
+  olib_perf_normalize(&result, 0, 0);
+  EXPECT_DOUBLE_EQ(result.per_byte[OLIB_PERF_CYCLES], 0.0);
+  EXPECT_DOUBLE_EQ(result.per_node[OLIB_PERF_CYCLES], 0.0);
+}
+
+// =============================================================================
+// Phase Helpers
+// =============================================================================
+
+TEST(Perf, MeasureReadAndWrite) {
+  olib_perf_t* perf = olib_perf_new();
+  ASSERT_NE(perf, nullptr);
+  olib_object_t* original = create_test_object();
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    olib_perf_result_t write_result;
+    ASSERT_TRUE(olib_perf_write(perf, format, original, &data, &size, &write_result)) << "format " << f;
+    EXPECT_EQ(write_result.bytes, size) << "format " << f;
+
+    olib_perf_result_t read_result;
+    olib_object_t* parsed = olib_perf_read(perf, format, data, size, &read_result);
+    ASSERT_NE(parsed, nullptr) << "format " << f;
+    verify_test_object(parsed);
+    EXPECT_EQ(read_result.bytes, size) << "format " << f;
+    EXPECT_EQ(read_result.nodes, write_result.nodes) << "format " << f;
+    EXPECT_GT(read_result.nodes, 1u);
+
+    olib_object_free(parsed);
+    olib_free(data);
+  }
+
+  olib_object_free(original);
+  olib_perf_free(perf);
+}
+
+// =============================================================================
+// Slow Operation Hook
+// =============================================================================
+
+// The node threshold makes reports deterministic, wall time may read as 0 on coarse clocks
+struct SlowOpLog {
+  std::vector<olib_slow_op_info_t> infos;
+  std::vector<std::string> prefixes;
+};
+
+static void record_slow_op(const olib_slow_op_info_t* info, void* user_data) {
+  SlowOpLog* log = (SlowOpLog*)user_data;
+  log->infos.push_back(*info);
+  log->prefixes.emplace_back((const char*)info->prefix, info->prefix_size);
+}
+
+static uint64_t fnv1a(const void* data, size_t size) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= ((const uint8_t*)data)[i];
+    hash *= 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+TEST(SlowOpHook, ReportsReadsWritesAndConversions) {
+  SlowOpLog log;
+  olib_slow_op_config_t config = {};
+  config.callback = record_slow_op;
+  config.user_data = &log;
+  config.node_threshold = 2;
+  config.max_prefix = 8;
+  olib_set_slow_op_hook(&config);
+
+  olib_object_t* original = create_test_object();
+  char* json = nullptr;
+  ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, original, &json));
+  ASSERT_EQ(log.infos.size(), 1u);
+  EXPECT_EQ(log.infos[0].kind, OLIB_SLOW_OP_WRITE);
+  EXPECT_EQ(log.infos[0].output_size, strlen(json));
+  EXPECT_EQ(log.infos[0].fingerprint, fnv1a(json, strlen(json)));
+  EXPECT_EQ(log.prefixes[0], std::string(json, 8));
+  EXPECT_GT(log.infos[0].nodes, 2u);
+
+  olib_object_t* parsed = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json);
+  ASSERT_EQ(log.infos.size(), 2u);
+  EXPECT_EQ(log.infos[1].kind, OLIB_SLOW_OP_READ);
+  EXPECT_EQ(log.infos[1].src_format, OLIB_FORMAT_JSON_TEXT);
+  EXPECT_EQ(log.infos[1].input_size, strlen(json));
+  EXPECT_EQ(log.infos[1].fingerprint, fnv1a(json, strlen(json)));
+  EXPECT_EQ(log.infos[1].nodes, log.infos[0].nodes);
+  EXPECT_DOUBLE_EQ(log.infos[1].read_ns, log.infos[1].total_ns);
+
+  // The read and write inside a conversion are not reported separately
+  uint8_t* binary = nullptr;
+  size_t binary_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_JSON_TEXT, (const uint8_t*)json, strlen(json), OLIB_FORMAT_BINARY,
+                           &binary, &binary_size));
+  ASSERT_EQ(log.infos.size(), 3u);
+  EXPECT_EQ(log.infos[2].kind, OLIB_SLOW_OP_CONVERT);
+  EXPECT_EQ(log.infos[2].dst_format, OLIB_FORMAT_BINARY);
+  EXPECT_EQ(log.infos[2].output_size, binary_size);
+  EXPECT_EQ(log.infos[2].nodes, log.infos[0].nodes);
+  EXPECT_GE(log.infos[2].total_ns, log.infos[2].read_ns + log.infos[2].write_ns);
+
+  // Files are loaded first, so the hook still sees the bytes
+  std::string path = (std::filesystem::temp_directory_path() / "olib_slow_op.bin").string();
+  ASSERT_TRUE(olib_format_write_file_path(OLIB_FORMAT_BINARY, original, path.c_str()));
+  ASSERT_EQ(log.infos.size(), 4u);
+  olib_object_t* from_file = olib_format_read_file_path(OLIB_FORMAT_BINARY, path.c_str());
+  verify_test_object(from_file);
+  ASSERT_EQ(log.infos.size(), 5u);
+  uint8_t* written = nullptr;
+  size_t written_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, original, &written, &written_size));
+  EXPECT_EQ(log.infos[4].input_size, written_size);
+  EXPECT_EQ(log.infos[4].fingerprint, fnv1a(written, written_size));
+  olib_free(written);
+  ASSERT_EQ(log.infos.size(), 6u);
+  remove(path.c_str());
+
+  // Small trees stay below the threshold
+  olib_object_t* small = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  uint8_t* small_data = nullptr;
+  size_t small_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, small, &small_data, &small_size));
+  EXPECT_EQ(log.infos.size(), 6u);
+
+  olib_set_slow_op_hook(nullptr);
+  olib_object_free(olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json));
+  EXPECT_EQ(log.infos.size(), 6u);
+
+  olib_free(small_data);
+  olib_object_free(small);
+  olib_object_free(from_file);
+  olib_free(binary);
+  olib_object_free(parsed);
+  olib_free(json);
+  olib_object_free(original);
+}
+
+TEST(SlowOpHook, ConvertsTextFiles) {
+  SlowOpLog log;
+  olib_slow_op_config_t config = {};
+  config.callback = record_slow_op;
+  config.user_data = &log;
+  config.node_threshold = 2;
+  olib_set_slow_op_hook(&config);
+
+  // The file is loaded without a terminator, the text reader must stop at its size
+  std::string src = (std::filesystem::temp_directory_path() / "olib_slow_op_src.json").string();
+  std::string dst = (std::filesystem::temp_directory_path() / "olib_slow_op_dst.yaml").string();
+  olib_object_t* original = create_test_object();
+  ASSERT_TRUE(olib_format_write_file_path(OLIB_FORMAT_JSON_TEXT, original, src.c_str()));
+  log.infos.clear();
+  ASSERT_TRUE(olib_convert_file_path(OLIB_FORMAT_JSON_TEXT, src.c_str(), OLIB_FORMAT_YAML, dst.c_str()));
+  ASSERT_EQ(log.infos.size(), 1u);
+  EXPECT_EQ(log.infos[0].kind, OLIB_SLOW_OP_CONVERT);
+  EXPECT_EQ(log.infos[0].input_size, (size_t)std::filesystem::file_size(src));
+
+  FILE* in = fopen(src.c_str(), "rb");
+  FILE* out = fopen(dst.c_str(), "w");
+  ASSERT_TRUE(in && out);
+  ASSERT_TRUE(olib_convert_file(OLIB_FORMAT_JSON_TEXT, in, OLIB_FORMAT_YAML, out));
+  fclose(in);
+  fclose(out);
+  EXPECT_EQ(log.infos.size(), 2u);
+
+  olib_set_slow_op_hook(nullptr);
+  olib_object_t* converted = olib_format_read_file_path(OLIB_FORMAT_YAML, dst.c_str());
+  verify_test_object(converted);
+  olib_object_free(converted);
+  olib_object_free(original);
+  remove(src.c_str());
+  remove(dst.c_str());
+}
+
+TEST(SlowOpHook, RateLimit) {
+  SlowOpLog log;
+  olib_slow_op_config_t config = {};
+  config.callback = record_slow_op;
+  config.user_data = &log;
+  config.node_threshold = 1;
+  config.min_interval_ns = 3600e9;
+  olib_set_slow_op_hook(&config);
+
+  olib_object_t* obj = create_test_object();
+  for (int i = 0; i < 5; i++) {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, obj, &data, &size));
+    olib_free(data);
+  }
+  EXPECT_EQ(log.infos.size(), 1u);
+  EXPECT_EQ(log.infos[0].prefix, nullptr);
+  EXPECT_EQ(olib_slow_op_dropped(), 4u);
+
+  olib_set_slow_op_hook(nullptr);
+  EXPECT_EQ(olib_slow_op_dropped(), 0u);
+  olib_object_free(obj);
+}
@@ -0,0 +1,284 @@
+#include "test_utils.h"
+#include <vector>
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+// Objects are the same if their binary encodings match
+static bool same_object(olib_object_t* a, olib_object_t* b) {
+  uint8_t* a_data = nullptr;
+  uint8_t* b_data = nullptr;
+  size_t a_size = 0;
+  size_t b_size = 0;
+  bool ok = olib_format_write(OLIB_FORMAT_BINARY, a, &a_data, &a_size) &&
+            olib_format_write(OLIB_FORMAT_BINARY, b, &b_data, &b_size) && a_size == b_size &&
+            memcmp(a_data, b_data, a_size) == 0;
+  olib_free(a_data);
+  olib_free(b_data);
+  return ok;
+}
+
+static olib_object_t* make_event(int64_t id, const char* user, bool with_score) {
+  olib_object_t* event = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+
+  olib_object_t* id_obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(id_obj, id);
+  olib_object_struct_set(event, "id", id_obj);
+
+  olib_object_t* user_obj = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(user_obj, user);
+  olib_object_struct_set(event, "user", user_obj);
+
+  if (with_score) {
+    olib_object_t* score_obj = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+    olib_object_set_float(score_obj, id * 0.5);
+    olib_object_struct_set(event, "score", score_obj);
+  }
+  return event;
+}
+
+// =============================================================================
+// Round trips
+// =============================================================================
+
+TEST(Schema, FromObjectRoundTrip) {
+  olib_object_t* original = create_test_object();
+  olib_schema_t* schema = olib_schema_from_object(original);
+  ASSERT_NE(schema, nullptr);
+  EXPECT_EQ(olib_schema_get_type(schema), OLIB_OBJECT_TYPE_STRUCT);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(schema, original, &data, &size));
+
+  // No tags and no keys, so it must beat the tagged binary format
+  uint8_t* tagged = nullptr;
+  size_t tagged_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, original, &tagged, &tagged_size));
+  EXPECT_LT(size * 2, tagged_size);
+
+  olib_object_t* decoded = olib_schema_decode(schema, data, size);
+  verify_test_object(decoded);
+  EXPECT_TRUE(same_object(original, decoded));
+
+  olib_free(data);
+  olib_free(tagged);
+  olib_object_free(decoded);
+  olib_object_free(original);
+  olib_schema_free(schema);
+}
+
+TEST(Schema, ListElementsMergeIntoOptionalFields) {
+  olib_object_t* events = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(events, make_event(1, "alice", true));
+  olib_object_list_push(events, make_event(-2, "bob", false));
+  olib_object_list_push(events, make_event(INT64_MIN, "", true));
+
+  olib_schema_t* schema = olib_schema_from_object(events);
+  ASSERT_NE(schema, nullptr);
+  olib_schema_t* element = olib_schema_list_element(schema);
+  ASSERT_EQ(olib_schema_struct_size(element), 3u);
+  EXPECT_STREQ(olib_schema_struct_key_at(element, 2), "score");
+  EXPECT_FALSE(olib_schema_struct_optional_at(element, 0));
+  EXPECT_FALSE(olib_schema_struct_optional_at(element, 1));
+  EXPECT_TRUE(olib_schema_struct_optional_at(element, 2));
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(schema, events, &data, &size));
+  olib_object_t* decoded = olib_schema_decode(schema, data, size);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_TRUE(same_object(events, decoded));
+  EXPECT_FALSE(olib_object_struct_has(olib_object_list_get(decoded, 1), "score"));
+
+  olib_free(data);
+  olib_object_free(decoded);
+  olib_object_free(events);
+  olib_schema_free(schema);
+}
+
+TEST(Schema, ListOfEmptyStructs) {
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 3; i++) {
+    olib_object_list_push(list, olib_object_new(OLIB_OBJECT_TYPE_STRUCT));
+  }
+
+  // The elements take no bytes, only the count is written
+  olib_schema_t* schema = olib_schema_from_object(list);
+  ASSERT_NE(schema, nullptr);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(schema, list, &data, &size));
+  EXPECT_EQ(size, 1u);
+
+  olib_object_t* decoded = olib_schema_decode(schema, data, size);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(olib_object_list_size(decoded), 3u);
+  EXPECT_TRUE(same_object(list, decoded));
+
+  // A huge count of empty elements is still refused
+  const uint8_t huge[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+  EXPECT_EQ(olib_schema_decode(schema, huge, sizeof(huge)), nullptr);
+
+  olib_free(data);
+  olib_object_free(decoded);
+  olib_object_free(list);
+  olib_schema_free(schema);
+}
+
+TEST(Schema, BuiltSchemaWireLayout) {
+  olib_schema_t* schema = olib_schema_new(OLIB_OBJECT_TYPE_STRUCT);
+  ASSERT_TRUE(olib_schema_struct_add(schema, "id", olib_schema_new(OLIB_OBJECT_TYPE_INT), false));
+  ASSERT_TRUE(olib_schema_struct_add(schema, "tag", olib_schema_new(OLIB_OBJECT_TYPE_STRING), true));
+  olib_schema_t* values = olib_schema_new(OLIB_OBJECT_TYPE_LIST);
+  ASSERT_TRUE(olib_schema_list_set_element(values, olib_schema_new(OLIB_OBJECT_TYPE_UINT)));
+  ASSERT_TRUE(olib_schema_struct_add(schema, "values", values, false));
+  ASSERT_TRUE(olib_schema_struct_add(schema, "ok", olib_schema_new(OLIB_OBJECT_TYPE_BOOL), true));
+
+  olib_schema_t* duplicate = olib_schema_new(OLIB_OBJECT_TYPE_INT);
+  EXPECT_FALSE(olib_schema_struct_add(schema, "id", duplicate, false));
+  olib_schema_free(duplicate);
+
+  // Keys in a different order than the schema, "tag" absent
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* ok = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
+  olib_object_set_bool(ok, true);
+  olib_object_struct_set(obj, "ok", ok);
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* big = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_set_uint(big, 300);
+  olib_object_list_push(list, big);
+  olib_object_struct_set(obj, "values", list);
+  olib_object_t* id = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(id, -3);
+  olib_object_struct_set(obj, "id", id);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(schema, obj, &data, &size));
+  // bitmap (ok = bit 1), id -3 zigzag, count 1, 300 varint, ok
+  const std::vector<uint8_t> expected = {0x02, 0x05, 0x01, 0xAC, 0x02, 0x01};
+  EXPECT_EQ(std::vector<uint8_t>(data, data + size), expected);
+
+  olib_object_t* decoded = olib_schema_decode(schema, data, size);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(olib_object_struct_size(decoded), 3u);
+  EXPECT_FALSE(olib_object_struct_has(decoded, "tag"));
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(decoded, "id")), -3);
+  EXPECT_EQ(olib_object_get_uint(olib_object_list_get(olib_object_struct_get(decoded, "values"), 0)), 300u);
+  EXPECT_TRUE(olib_object_get_bool(olib_object_struct_get(decoded, "ok")));
+
+  olib_free(data);
+  olib_object_free(decoded);
+  olib_object_free(obj);
+  olib_schema_free(schema);
+}
+
+TEST(Schema, ScalarBoundaries) {
+  const int64_t ints[] = {0, -1, 1, 63, -64, 64, INT64_MAX, INT64_MIN};
+  olib_schema_t* int_schema = olib_schema_new(OLIB_OBJECT_TYPE_INT);
+  for (int64_t value : ints) {
+    olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(obj, value);
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_schema_encode(int_schema, obj, &data, &size));
+    EXPECT_LE(size, 10u);
+    olib_object_t* decoded = olib_schema_decode(int_schema, data, size);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(olib_object_get_int(decoded), value);
+    olib_free(data);
+    olib_object_free(decoded);
+    olib_object_free(obj);
+  }
+  olib_schema_free(int_schema);
+
+  olib_schema_t* uint_schema = olib_schema_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_set_uint(obj, UINT64_MAX);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(uint_schema, obj, &data, &size));
+  EXPECT_EQ(size, 10u);
+  olib_object_t* decoded = olib_schema_decode(uint_schema, data, size);
+  EXPECT_EQ(olib_object_get_uint(decoded), UINT64_MAX);
+
+  // An eleventh varint byte or a tenth byte past the top bit overflows
+  const uint8_t overflow[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02};
+  EXPECT_EQ(olib_schema_decode(uint_schema, overflow, sizeof(overflow)), nullptr);
+
+  olib_free(data);
+  olib_object_free(decoded);
+  olib_object_free(obj);
+  olib_schema_free(uint_schema);
+}
+
+// =============================================================================
+// Validation
+// =============================================================================
+
+TEST(Schema, EncodeRejectsMismatches) {
+  olib_object_t* event = make_event(1, "alice", true);
+  olib_schema_t* schema = olib_schema_from_object(event);
+  ASSERT_NE(schema, nullptr);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+
+  // Required field missing
+  olib_object_t* missing = make_event(2, "bob", false);
+  EXPECT_FALSE(olib_schema_encode(schema, missing, &data, &size));
+
+  // Key the schema does not know
+  olib_object_t* extra = make_event(3, "carol", true);
+  olib_object_struct_set(extra, "extra", olib_object_new(OLIB_OBJECT_TYPE_BOOL));
+  EXPECT_FALSE(olib_schema_encode(schema, extra, &data, &size));
+
+  // Type change
+  olib_object_t* retyped = make_event(4, "dave", true);
+  olib_object_struct_set(retyped, "id", olib_object_new(OLIB_OBJECT_TYPE_UINT));
+  EXPECT_FALSE(olib_schema_encode(schema, retyped, &data, &size));
+
+  // A list schema without an element only matches empty lists
+  olib_schema_t* list_schema = olib_schema_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  ASSERT_TRUE(olib_schema_encode(list_schema, list, &data, &size));
+  EXPECT_EQ(size, 1u);
+  olib_free(data);
+  olib_object_list_push(list, olib_object_new(OLIB_OBJECT_TYPE_INT));
+  EXPECT_FALSE(olib_schema_encode(list_schema, list, &data, &size));
+
+  // Elements of different types cannot share a schema
+  olib_object_list_push(list, olib_object_new(OLIB_OBJECT_TYPE_STRING));
+  EXPECT_EQ(olib_schema_from_object(list), nullptr);
+
+  olib_object_free(list);
+  olib_object_free(missing);
+  olib_object_free(extra);
+  olib_object_free(retyped);
+  olib_object_free(event);
+  olib_schema_free(list_schema);
+  olib_schema_free(schema);
+}
+
+TEST(Schema, DecodeRejectsTruncatedInput) {
+  olib_object_t* events = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(events, make_event(1, "alice", true));
+  olib_object_list_push(events, make_event(2, "bob", false));
+  olib_schema_t* schema = olib_schema_from_object(events);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_schema_encode(schema, events, &data, &size));
+
+  for (size_t cut = 0; cut < size; cut++) {
+    EXPECT_EQ(olib_schema_decode(schema, data, cut), nullptr) << "cut at " << cut;
+  }
+
+  // A count larger than the remaining bytes fails before allocating
+  const uint8_t huge[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x00};
+  EXPECT_EQ(olib_schema_decode(schema, huge, sizeof(huge)), nullptr);
+
+  olib_free(data);
+  olib_object_free(events);
+  olib_schema_free(schema);
+}
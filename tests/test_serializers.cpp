@@ -1,4 +1,5 @@
 #include "test_utils.h"
+#include <vector>
 
 // =============================================================================
 // JSON Text Serializer Tests
@@ -63,6 +64,60 @@ TEST(SerializerJsonText, SpecialCharacters) {
   olib_serializer_free(ser);
 }
 
+// Parse the same JSON with and without the structural index and compare the binary encodings
+static void expect_indexed_parse_matches(const std::string& json, size_t threads) {
+  olib_json_text_options_t indexed_options = {};
+  indexed_options.index_min_size = 1;
+  indexed_options.index_threads = threads;
+  olib_json_text_options_t plain_options = {};
+  plain_options.index_min_size = SIZE_MAX;
+  olib_serializer_t* indexed = olib_serializer_new_json_text_ex(&indexed_options);
+  olib_serializer_t* plain = olib_serializer_new_json_text_ex(&plain_options);
+
+  olib_object_t* a = olib_serializer_read_string(indexed, json.c_str());
+  olib_object_t* b = olib_serializer_read_string(plain, json.c_str());
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  uint8_t* a_data = nullptr;
+  uint8_t* b_data = nullptr;
+  size_t a_size = 0;
+  size_t b_size = 0;
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, a, &a_data, &a_size));
+  ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, b, &b_data, &b_size));
+  ASSERT_EQ(a_size, b_size);
+  EXPECT_EQ(memcmp(a_data, b_data, a_size), 0);
+
+  olib_free(a_data);
+  olib_free(b_data);
+  olib_object_free(a);
+  olib_object_free(b);
+  olib_serializer_free(indexed);
+  olib_serializer_free(plain);
+}
+
+TEST(SerializerJsonText, StructuralIndexMatchesScanningParser) {
+  // Structural characters and escapes inside strings, empty and scalar-only lists
+  expect_indexed_parse_matches(
+      R"({"a": "x,[]{}:\"y\\", "b": [], "c": [ ], "d": [1, 2.5, true, null], "e": [[], [[]], {"k": [","]}],)"
+      R"( "f": "\u0041\"", "g\"": {"h": ["]", "[", "\\"]}})",
+      4);
+
+  // A document spanning several 256 KiB chunks, with long backslash runs and
+  // strings crossing the chunk boundaries
+  const size_t chunk = 256 * 1024;
+  std::string json = "[";
+  for (int i = 0; i < 20000; i++) {
+    if (i > 0) json += ",";
+    json += "{\"id\": " + std::to_string(i) + ", \"tags\": [\"a,b\", \"[c]\"], \"path\": \"";
+    json += std::string((size_t)(i % 7) * 2, '\\');
+    json += "\\\"\", \"v\": [" + std::to_string(i * 0.25) + ", " + std::to_string(-i) + "]}";
+  }
+  json += ", \"" + std::string(3 * chunk, 'x') + "\"]";
+  ASSERT_GT(json.size(), 4u * chunk);
+  expect_indexed_parse_matches(json, 4);
+  expect_indexed_parse_matches(json, 3);
+}
+
 // =============================================================================
 // JSON Binary Serializer Tests
 // =============================================================================
@@ -216,6 +271,133 @@ TEST(SerializerBinary, EdgeCases) {
   olib_serializer_free(ser);
 }
 
+static olib_object_t* make_telemetry(size_t samples) {
+  olib_object_t* doc = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* timestamps = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* values = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (size_t i = 0; i < samples; i++) {
+    olib_object_t* ts = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(ts, 1700000000000 + (int64_t)i * 1000 + (i % 7 == 0 ? 1 : 0));
+    olib_object_list_push(timestamps, ts);
+    olib_object_t* value = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+    olib_object_set_float(value, 20.0 + (double)(i / 16) * 0.5);
+    olib_object_list_push(values, value);
+  }
+  olib_object_struct_set(doc, "ts", timestamps);
+  olib_object_struct_set(doc, "values", values);
+  return doc;
+}
+
+static olib_object_t* make_number_list(olib_object_type_t type, const std::vector<uint64_t>& bits) {
+  olib_object_t* list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (uint64_t b : bits) {
+    olib_object_t* item = olib_object_new(type);
+    if (type == OLIB_OBJECT_TYPE_INT) olib_object_set_int(item, (int64_t)b);
+    if (type == OLIB_OBJECT_TYPE_UINT) olib_object_set_uint(item, b);
+    if (type == OLIB_OBJECT_TYPE_FLOAT) {
+      double d;
+      memcpy(&d, &b, sizeof(d));
+      olib_object_set_float(item, d);
+    }
+    olib_object_list_push(list, item);
+  }
+  return list;
+}
+
+TEST(SerializerBinary, PackedNumericListsRoundTrip) {
+  olib_binary_options_t options = {};
+  options.pack_numeric_lists = true;
+  olib_serializer_t* packed_ser = olib_serializer_new_binary_ex(&options);
+  olib_serializer_t* plain_ser = olib_serializer_new_binary();
+  ASSERT_NE(packed_ser, nullptr);
+
+  olib_object_t* doc = make_telemetry(4096);
+  // Extremes wrap the deltas, special floats keep their exact bits
+  const uint64_t nan_bits = 0x7FF8000000000001ULL;
+  const uint64_t neg_zero = 0x8000000000000000ULL;
+  const uint64_t inf_bits = 0x7FF0000000000000ULL;
+  std::vector<uint64_t> extremes = {0, (uint64_t)INT64_MIN, (uint64_t)INT64_MAX, 1, (uint64_t)-1, 0, 0, 42, 43, 45};
+  std::vector<uint64_t> floats = {nan_bits, neg_zero, inf_bits, 0, 0x3FF0000000000000ULL, 0x3FF0000000000001ULL,
+                                  0x3FF0000000000001ULL, 0xC000000000000000ULL, 1};
+  olib_object_struct_set(doc, "ints", make_number_list(OLIB_OBJECT_TYPE_INT, extremes));
+  olib_object_struct_set(doc, "uints", make_number_list(OLIB_OBJECT_TYPE_UINT, extremes));
+  olib_object_struct_set(doc, "floats", make_number_list(OLIB_OBJECT_TYPE_FLOAT, floats));
+  // Mixed and short lists stay plain
+  olib_object_t* mixed = make_number_list(OLIB_OBJECT_TYPE_INT, {1, 2, 3, 4, 5, 6, 7, 8});
+  olib_object_list_push(mixed, olib_object_new(OLIB_OBJECT_TYPE_UINT));
+  olib_object_struct_set(doc, "mixed", mixed);
+  olib_object_struct_set(doc, "short", make_number_list(OLIB_OBJECT_TYPE_INT, {1, 2, 3}));
+  olib_object_t* nested = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(nested, make_number_list(OLIB_OBJECT_TYPE_UINT, {9, 8, 7, 6, 5, 4, 3, 2, 1}));
+  olib_object_struct_set(doc, "nested", nested);
+
+  uint8_t* packed = nullptr;
+  size_t packed_size = 0;
+  uint8_t* plain = nullptr;
+  size_t plain_size = 0;
+  ASSERT_TRUE(olib_serializer_write(packed_ser, doc, &packed, &packed_size));
+  ASSERT_TRUE(olib_serializer_write(plain_ser, doc, &plain, &plain_size));
+  EXPECT_LT(packed_size * 5, plain_size);
+
+  // Any binary serializer reads packed lists back to the same tree
+  olib_object_t* parsed = olib_serializer_read(plain_ser, packed, packed_size);
+  ASSERT_NE(parsed, nullptr);
+  uint8_t* reparsed = nullptr;
+  size_t reparsed_size = 0;
+  ASSERT_TRUE(olib_serializer_write(plain_ser, parsed, &reparsed, &reparsed_size));
+  ASSERT_EQ(reparsed_size, plain_size);
+  EXPECT_EQ(memcmp(reparsed, plain, plain_size), 0);
+
+  // Reading into an existing tree and converting to JSON binary expand them too
+  olib_object_t* tree = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  EXPECT_TRUE(olib_serializer_read_into(plain_ser, packed, packed_size, tree));
+  EXPECT_EQ(olib_object_list_size(olib_object_struct_get(tree, "ts")), 4096u);
+  uint8_t* converted = nullptr;
+  size_t converted_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_BINARY, packed, packed_size, OLIB_FORMAT_JSON_BINARY, &converted, &converted_size));
+  ASSERT_EQ(converted_size, plain_size);
+  EXPECT_EQ(memcmp(converted, plain, plain_size), 0);
+
+  olib_free(packed);
+  olib_free(plain);
+  olib_free(reparsed);
+  olib_free(converted);
+  olib_object_free(doc);
+  olib_object_free(parsed);
+  olib_object_free(tree);
+  olib_serializer_free(packed_ser);
+  olib_serializer_free(plain_ser);
+}
+
+TEST(SerializerBinary, PackedListRejectsMalformedInput) {
+  olib_binary_options_t options = {};
+  options.pack_numeric_lists = true;
+  olib_serializer_t* ser = olib_serializer_new_binary_ex(&options);
+  std::vector<uint64_t> values;
+  for (uint64_t i = 0; i < 16; i++) values.push_back(0x4000000000000000ULL + i * 12345);
+
+  for (olib_object_type_t type : {OLIB_OBJECT_TYPE_INT, OLIB_OBJECT_TYPE_FLOAT}) {
+    olib_object_t* list = make_number_list(type, values);
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_serializer_write(ser, list, &data, &size));
+    ASSERT_EQ(data[0], 0x08);
+
+    for (size_t cut = 0; cut < size; cut++) {
+      EXPECT_EQ(olib_serializer_read(ser, data, cut), nullptr) << "cut at " << cut;
+    }
+    // A count the payload cannot hold
+    std::vector<uint8_t> bad(data, data + size);
+    bad[2] = 0xFF;
+    bad[3] = 0xFF;
+    EXPECT_EQ(olib_serializer_read(ser, bad.data(), bad.size()), nullptr);
+
+    olib_free(data);
+    olib_object_free(list);
+  }
+  olib_serializer_free(ser);
+}
+
 // =============================================================================
 // Plain Text Serializer Tests
 // =============================================================================
@@ -286,6 +468,94 @@ TEST_P(SerializerFormatTest, RoundTrip) {
   olib_serializer_free(ser);
 }
 
+TEST_P(SerializerFormatTest, ReadIntoExistingTree) {
+  olib_format_t format = GetParam();
+  olib_serializer_t* ser = olib_format_serializer(format);
+  ASSERT_NE(ser, nullptr);
+
+  olib_object_t* original = create_test_object();
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(write_any_format(format, original, &data, &size));
+
+  // Read into an empty tree, then again into the populated one
+  olib_object_t* tree = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  ASSERT_TRUE(olib_serializer_read_into(ser, data, size, tree));
+  verify_test_object(tree);
+  ASSERT_TRUE(olib_serializer_read_into(ser, data, size, tree));
+  verify_test_object(tree);
+
+  olib_free(data);
+  olib_object_free(tree);
+  olib_object_free(original);
+  olib_serializer_free(ser);
+}
+
+TEST_P(SerializerFormatTest, IntegerDigitBoundaries) {
+  olib_format_t format = GetParam();
+
+  // Every digit count from 1 to 20, on both sides of each power of ten
+  std::vector<int64_t> ints = {0, -1, INT64_MAX, INT64_MIN, INT64_MIN + 1};
+  std::vector<uint64_t> uints = {0, UINT64_MAX, (uint64_t)INT64_MAX + 1};
+  uint64_t pow10 = 1;
+  for (int i = 0; i < 19; i++) {
+    pow10 *= 10;
+    if (pow10 <= (uint64_t)INT64_MAX) {
+      ints.push_back((int64_t)pow10 - 1);
+      ints.push_back(-(int64_t)pow10);
+    }
+    uints.push_back(pow10 - 1);
+    uints.push_back(pow10);
+  }
+
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* int_list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_t* uint_list = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int64_t v : ints) {
+    olib_object_t* item = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(item, v);
+    olib_object_list_push(int_list, item);
+  }
+  for (uint64_t v : uints) {
+    olib_object_t* item = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+    olib_object_set_uint(item, v);
+    olib_object_list_push(uint_list, item);
+  }
+  olib_object_struct_set(root, "ints", int_list);
+  olib_object_struct_set(root, "uints", uint_list);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(write_any_format(format, root, &data, &size));
+  olib_object_t* parsed = read_any_format(format, data, size);
+  ASSERT_NE(parsed, nullptr);
+
+  // Text formats may read small unsigned values back as signed, so compare by value
+  olib_object_t* parsed_ints = olib_object_struct_get(parsed, "ints");
+  ASSERT_EQ(olib_object_list_size(parsed_ints), ints.size());
+  for (size_t i = 0; i < ints.size(); i++) {
+    olib_object_t* item = olib_object_list_get(parsed_ints, i);
+    ASSERT_EQ(olib_object_get_type(item), OLIB_OBJECT_TYPE_INT) << "index " << i;
+    EXPECT_EQ(olib_object_get_int(item), ints[i]);
+  }
+
+  olib_object_t* parsed_uints = olib_object_struct_get(parsed, "uints");
+  ASSERT_EQ(olib_object_list_size(parsed_uints), uints.size());
+  for (size_t i = 0; i < uints.size(); i++) {
+    olib_object_t* item = olib_object_list_get(parsed_uints, i);
+    if (olib_object_get_type(item) == OLIB_OBJECT_TYPE_INT) {
+      EXPECT_EQ((uint64_t)olib_object_get_int(item), uints[i]);
+    } else {
+      ASSERT_EQ(olib_object_get_type(item), OLIB_OBJECT_TYPE_UINT) << "index " << i;
+      EXPECT_EQ(olib_object_get_uint(item), uints[i]);
+    }
+  }
+
+  olib_free(data);
+  olib_object_free(parsed);
+  olib_object_free(root);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     AllFormats,
     SerializerFormatTest,
@@ -297,3 +567,163 @@ INSTANTIATE_TEST_SUITE_P(
         OLIB_FORMAT_BINARY,
         OLIB_FORMAT_TOML,
         OLIB_FORMAT_TXT));
+
+// =============================================================================
+// Read Into Existing Tree
+// =============================================================================
+
+static bool read_json_into(olib_serializer_t* ser, const char* json, olib_object_t* tree) {
+  return olib_serializer_read_into(ser, (const uint8_t*)json, strlen(json), tree);
+}
+
+TEST(SerializerReadInto, ReusesMatchingNodes) {
+  olib_serializer_t* ser = olib_serializer_new_json_text();
+  olib_object_t* tree = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+
+  ASSERT_TRUE(read_json_into(ser, R"({"name": "a long enough name", "id": 1, "tags": ["x", "y"]})", tree));
+  olib_object_t* name = olib_object_struct_get(tree, "name");
+  olib_object_t* tags = olib_object_struct_get(tree, "tags");
+  const char* name_buffer = olib_object_get_string(name);
+
+  ASSERT_TRUE(read_json_into(ser, R"({"name": "shorter", "id": 2, "tags": ["z", "w"]})", tree));
+  EXPECT_EQ(olib_object_struct_get(tree, "name"), name);
+  EXPECT_EQ(olib_object_struct_get(tree, "tags"), tags);
+  EXPECT_EQ(olib_object_get_string(name), name_buffer);
+  EXPECT_STREQ(olib_object_get_string(name), "shorter");
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(tree, "id")), 2);
+  EXPECT_STREQ(olib_object_get_string(olib_object_list_get(tags, 0)), "z");
+
+  olib_object_free(tree);
+  olib_serializer_free(ser);
+}
+
+TEST(SerializerReadInto, HandlesShapeChanges) {
+  olib_serializer_t* ser = olib_serializer_new_json_text();
+  olib_object_t* tree = olib_object_new(OLIB_OBJECT_TYPE_INT);
+
+  ASSERT_TRUE(read_json_into(ser, R"({"a": 1, "b": [1, 2, 3], "c": "x"})", tree));
+  ASSERT_TRUE(read_json_into(ser, R"({"c": 2.5, "a": "now a string", "b": [4], "d": {"e": true}})", tree));
+
+  ASSERT_EQ(olib_object_get_type(tree), OLIB_OBJECT_TYPE_STRUCT);
+  ASSERT_EQ(olib_object_struct_size(tree), 4u);
+  EXPECT_STREQ(olib_object_struct_key_at(tree, 0), "c");
+  EXPECT_STREQ(olib_object_struct_key_at(tree, 1), "a");
+  EXPECT_STREQ(olib_object_struct_key_at(tree, 2), "b");
+  EXPECT_STREQ(olib_object_struct_key_at(tree, 3), "d");
+  EXPECT_DOUBLE_EQ(olib_object_get_float(olib_object_struct_get(tree, "c")), 2.5);
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(tree, "a")), "now a string");
+  EXPECT_EQ(olib_object_list_size(olib_object_struct_get(tree, "b")), 1u);
+  EXPECT_TRUE(olib_object_get_bool(olib_object_struct_get(olib_object_struct_get(tree, "d"), "e")));
+
+  // Dropping keys and changing the root type
+  ASSERT_TRUE(read_json_into(ser, R"({"a": 1})", tree));
+  EXPECT_EQ(olib_object_struct_size(tree), 1u);
+  ASSERT_TRUE(read_json_into(ser, R"([1, 2])", tree));
+  EXPECT_EQ(olib_object_get_type(tree), OLIB_OBJECT_TYPE_LIST);
+  EXPECT_EQ(olib_object_list_size(tree), 2u);
+
+  EXPECT_FALSE(read_json_into(ser, R"({"a": )", tree));
+
+  olib_object_free(tree);
+  olib_serializer_free(ser);
+}
+
+// =============================================================================
+// Custom Reader: read_value vs read_peek
+// =============================================================================
+
+// Minimal reader over a fixed token stream: a list of [int, "str", true]
+struct TokenReader {
+  size_t pos = 0;
+  int peek_calls = 0;
+  int value_calls = 0;
+};
+
+static const olib_object_type_t g_tokens[] = {
+    OLIB_OBJECT_TYPE_LIST, OLIB_OBJECT_TYPE_INT, OLIB_OBJECT_TYPE_STRING, OLIB_OBJECT_TYPE_BOOL};
+
+static olib_object_type_t token_peek(void* ctx) {
+  TokenReader* r = (TokenReader*)ctx;
+  r->peek_calls++;
+  return r->pos < 4 ? g_tokens[r->pos] : OLIB_OBJECT_TYPE_MAX;
+}
+
+static bool token_read_int(void* ctx, int64_t* value) {
+  ((TokenReader*)ctx)->pos++;
+  *value = 7;
+  return true;
+}
+
+static bool token_read_string(void* ctx, const char** value) {
+  ((TokenReader*)ctx)->pos++;
+  *value = "seven";
+  return true;
+}
+
+static bool token_read_bool(void* ctx, bool* value) {
+  ((TokenReader*)ctx)->pos++;
+  *value = true;
+  return true;
+}
+
+static bool token_read_value(void* ctx, olib_value_t* out) {
+  TokenReader* r = (TokenReader*)ctx;
+  r->value_calls++;
+  if (r->pos >= 4) return false;
+  out->type = g_tokens[r->pos];
+  switch (out->type) {
+    case OLIB_OBJECT_TYPE_INT: return token_read_int(ctx, &out->data.int_val);
+    case OLIB_OBJECT_TYPE_STRING: return token_read_string(ctx, &out->data.string_val);
+    case OLIB_OBJECT_TYPE_BOOL: return token_read_bool(ctx, &out->data.bool_val);
+    default: return true;
+  }
+}
+
+static bool token_list_begin(void* ctx, size_t* size) {
+  ((TokenReader*)ctx)->pos++;
+  *size = 3;
+  return true;
+}
+
+static bool token_list_end(void* ctx) {
+  (void)ctx;
+  return true;
+}
+
+static void read_tokens(bool with_read_value, TokenReader* reader) {
+  olib_serializer_config_t config = {};
+  config.user_data = reader;
+  config.read_peek = token_peek;
+  config.read_value = with_read_value ? token_read_value : nullptr;
+  config.read_int = token_read_int;
+  config.read_string = token_read_string;
+  config.read_bool = token_read_bool;
+  config.read_list_begin = token_list_begin;
+  config.read_list_end = token_list_end;
+
+  olib_serializer_t* ser = olib_serializer_new(&config);
+  ASSERT_NE(ser, nullptr);
+  const uint8_t dummy = 0;
+  olib_object_t* obj = olib_serializer_read(ser, &dummy, 1);
+  ASSERT_NE(obj, nullptr);
+  ASSERT_EQ(olib_object_list_size(obj), 3u);
+  EXPECT_EQ(olib_object_get_int(olib_object_list_get(obj, 0)), 7);
+  EXPECT_STREQ(olib_object_get_string(olib_object_list_get(obj, 1)), "seven");
+  EXPECT_TRUE(olib_object_get_bool(olib_object_list_get(obj, 2)));
+  olib_object_free(obj);
+  olib_serializer_free(ser);
+}
+
+TEST(SerializerCustom, PeekFallbackWithoutReadValue) {
+  TokenReader reader;
+  read_tokens(false, &reader);
+  EXPECT_EQ(reader.peek_calls, 4);
+  EXPECT_EQ(reader.value_calls, 0);
+}
+
+TEST(SerializerCustom, PrefersReadValue) {
+  TokenReader reader;
+  read_tokens(true, &reader);
+  EXPECT_EQ(reader.peek_calls, 0);
+  EXPECT_EQ(reader.value_calls, 4);
+}
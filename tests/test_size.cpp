@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <olib.h>
+#include <string>
+#include "test_utils.h"
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static const olib_size_entry_t* find_entry(olib_size_report_t* report, const char* path) {
+  for (size_t i = 0; i < olib_size_report_count(report); i++) {
+    const olib_size_entry_t* entry = olib_size_report_get(report, i);
+    if (strcmp(entry->path, path) == 0) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+// =============================================================================
+// Attribution
+// =============================================================================
+
+TEST(SizeReport, TotalsMatchEncodedSize) {
+  olib_object_t* obj = create_test_object();
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(write_any_format(format, obj, &data, &size)) << "format " << f;
+    olib_free(data);
+
+    olib_serializer_t* ser = olib_format_serializer(format);
+    olib_size_report_t* report = olib_size_report_new(ser, obj);
+    ASSERT_NE(report, nullptr) << "format " << f;
+    EXPECT_EQ(olib_size_report_total(report), size) << "format " << f;
+
+    uint64_t sum = 0;
+    for (int c = 0; c < OLIB_SIZE_CLASS_MAX; c++) {
+      sum += olib_size_report_class_total(report, (olib_size_class_t)c);
+    }
+    EXPECT_EQ(sum, size);
+    EXPECT_GT(olib_size_report_class_total(report, OLIB_SIZE_KEY), 0u) << "format " << f;
+    EXPECT_GT(olib_size_report_class_total(report, OLIB_SIZE_VALUE), 0u) << "format " << f;
+
+    // Ranked largest first, and the root's subtree covers everything
+    for (size_t i = 1; i < olib_size_report_count(report); i++) {
+      EXPECT_GE(olib_size_report_get(report, i - 1)->total, olib_size_report_get(report, i)->total);
+    }
+    EXPECT_EQ(find_entry(report, "")->subtree, size);
+
+    olib_size_report_free(report);
+    olib_serializer_free(ser);
+  }
+  olib_object_free(obj);
+}
+
+TEST(SizeReport, JsonClasses) {
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* name = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(name, "ab");
+  olib_object_struct_add(obj, "name", name);
+  olib_object_t* tags = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 3; i++) {
+    olib_object_t* tag = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(tag, i + 7);
+    olib_object_list_push(tags, tag);
+  }
+  olib_object_struct_add(obj, "tags", tags);
+
+  olib_serializer_t* ser = olib_serializer_new_json_text();
+  olib_size_report_t* report = olib_size_report_new(ser, obj);
+  ASSERT_NE(report, nullptr);
+
+  // "name": "ab"
+  const olib_size_entry_t* entry = find_entry(report, "name");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->count, 1u);
+  EXPECT_EQ(entry->bytes[OLIB_SIZE_KEY], 6u);
+  EXPECT_EQ(entry->bytes[OLIB_SIZE_VALUE], 4u);
+
+  // Indices collapse into one path
+  entry = find_entry(report, "tags[]");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->count, 3u);
+  EXPECT_EQ(entry->bytes[OLIB_SIZE_KEY], 0u);
+  EXPECT_EQ(entry->bytes[OLIB_SIZE_VALUE], 3u);
+  EXPECT_GT(entry->bytes[OLIB_SIZE_WHITESPACE], 0u);
+  EXPECT_EQ(find_entry(report, "tags")->subtree, find_entry(report, "tags")->total + entry->total);
+  EXPECT_EQ(find_entry(report, "tags[0]"), nullptr);
+
+  olib_size_report_free(report);
+  olib_serializer_free(ser);
+  olib_object_free(obj);
+}
+
+TEST(SizeReport, PackedListsAndMaps) {
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* samples = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 200; i++) {
+    olib_object_t* sample = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    olib_object_set_int(sample, i % 10);
+    olib_object_list_push(samples, sample);
+  }
+  olib_object_struct_add(obj, "samples", samples);
+  olib_object_t* users = olib_object_new(OLIB_OBJECT_TYPE_MAP);
+  for (int64_t i = 0; i < 20; i++) {
+    olib_object_t* user = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(user, ("user-" + std::to_string(i)).c_str());
+    olib_object_map_set(users, i * 1000, user);
+  }
+  olib_object_struct_add(obj, "users", users);
+
+  for (int f = 0; f < OLIB_FORMAT_MAX; f++) {
+    olib_format_t format = (olib_format_t)f;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(write_any_format(format, obj, &data, &size));
+    olib_free(data);
+
+    olib_serializer_t* ser = olib_format_serializer(format);
+    olib_size_report_t* report = olib_size_report_new(ser, obj);
+    ASSERT_NE(report, nullptr) << "format " << f;
+    EXPECT_EQ(olib_size_report_total(report), size) << "format " << f;
+    ASSERT_NE(find_entry(report, "samples[]"), nullptr);
+    EXPECT_EQ(find_entry(report, "samples[]")->count, 200u);
+    ASSERT_NE(find_entry(report, "users[]"), nullptr);
+    EXPECT_EQ(find_entry(report, "users[]")->count, 20u);
+    EXPECT_GT(find_entry(report, "users[]")->bytes[OLIB_SIZE_KEY], 0u) << "format " << f;
+
+    olib_size_report_free(report);
+    olib_serializer_free(ser);
+  }
+
+  // Packed lists are rewritten at their end, the packed elements still land on the items
+  olib_binary_options_t options = {};
+  options.pack_numeric_lists = true;
+  olib_serializer_t* ser = olib_serializer_new_binary_ex(&options);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(olib_serializer_write(ser, obj, &data, &size));
+  olib_serializer_recycle_output(ser, data);
+  olib_size_report_t* report = olib_size_report_new(ser, obj);
+  ASSERT_NE(report, nullptr);
+  EXPECT_EQ(olib_size_report_total(report), size);
+  const olib_size_entry_t* entry = find_entry(report, "samples[]");
+  EXPECT_LT(entry->total, 200u * 2);
+  EXPECT_EQ(entry->bytes[OLIB_SIZE_FRAMING], 0u);
+  EXPECT_GT(find_entry(report, "samples")->bytes[OLIB_SIZE_FRAMING], 5u);
+  olib_size_report_free(report);
+  olib_serializer_free(ser);
+  olib_object_free(obj);
+}
+
+TEST(SizeReport, PrintAndCustomSerializers) {
+  olib_object_t* obj = create_test_object();
+  olib_serializer_t* ser = olib_serializer_new_yaml();
+  olib_size_report_t* report = olib_size_report_new(ser, obj);
+  ASSERT_NE(report, nullptr);
+
+  FILE* file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(olib_size_report_print(report, file, 3));
+  rewind(file);
+  char line[256];
+  ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+  EXPECT_EQ(std::string(line).rfind("Encoded size: ", 0), 0u);
+  fclose(file);
+  olib_size_report_free(report);
+  olib_serializer_free(ser);
+
+  // Writers without the shared output buffer cannot be measured
+  olib_serializer_config_t config = {};
+  olib_serializer_t* custom = olib_serializer_new(&config);
+  EXPECT_EQ(olib_size_report_new(custom, obj), nullptr);
+  olib_serializer_free(custom);
+  olib_object_free(obj);
+}
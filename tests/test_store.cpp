@@ -0,0 +1,282 @@
+#include "test_utils.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+// Fresh directory under the system temp path, removed when the test ends
+class StoreDir {
+ public:
+  explicit StoreDir(const char* name) {
+    path_ = (std::filesystem::temp_directory_path() / ("olib-test-" + std::string(name))).string();
+    std::filesystem::remove_all(path_);
+  }
+  ~StoreDir() { std::filesystem::remove_all(path_); }
+  const char* path() const { return path_.c_str(); }
+
+ private:
+  std::string path_;
+};
+
+// Open a store or skip the test where stores are not available
+#define OPEN_STORE_OR_SKIP(store, dir, options)                          \
+  olib_store_t* store = olib_store_open((dir).path(), options);          \
+  if (!store) {                                                          \
+    GTEST_SKIP() << "document stores are not supported on this platform"; \
+  }
+
+static olib_object_t* create_document(int number) {
+  olib_object_t* doc = create_test_object();
+  olib_object_t* label = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(label, ("document " + std::to_string(number)).c_str());
+  olib_object_struct_add(doc, "label", label);
+  return doc;
+}
+
+static std::string doc_id(int number) { return "doc:" + std::to_string(number); }
+
+static void expect_document(olib_object_t* doc, int number) {
+  ASSERT_NE(doc, nullptr) << "document " << number;
+  verify_test_object(doc);
+  EXPECT_EQ(olib_object_get_string(olib_object_struct_get(doc, "label")), "document " + std::to_string(number));
+}
+
+static void put_documents(olib_store_t* store, int first, int count) {
+  for (int i = first; i < first + count; i++) {
+    olib_object_t* doc = create_document(i);
+    ASSERT_TRUE(olib_store_put(store, doc_id(i).c_str(), doc));
+    olib_object_free(doc);
+  }
+}
+
+// =============================================================================
+// Documents
+// =============================================================================
+
+TEST(Store, PutGetDelete) {
+  StoreDir dir("put-get-delete");
+  OPEN_STORE_OR_SKIP(store, dir, nullptr);
+
+  put_documents(store, 0, 100);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  for (int i = 0; i < 100; i++) {
+    olib_object_t* doc = olib_store_get(store, doc_id(i).c_str());
+    expect_document(doc, i);
+    olib_object_free(doc);
+  }
+  EXPECT_EQ(olib_store_get(store, "missing"), nullptr);
+
+  // Replacing keeps the count, the latest version wins
+  olib_object_t* replacement = create_document(1000);
+  ASSERT_TRUE(olib_store_put(store, doc_id(7).c_str(), replacement));
+  olib_object_free(replacement);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  olib_object_t* doc = olib_store_get(store, doc_id(7).c_str());
+  expect_document(doc, 1000);
+  olib_object_free(doc);
+
+  EXPECT_TRUE(olib_store_delete(store, doc_id(7).c_str()));
+  EXPECT_FALSE(olib_store_delete(store, doc_id(7).c_str()));
+  EXPECT_EQ(olib_store_get(store, doc_id(7).c_str()), nullptr);
+  EXPECT_EQ(olib_store_count(store), 99u);
+
+  olib_store_close(store);
+}
+
+TEST(Store, GetBatch) {
+  StoreDir dir("get-batch");
+  OPEN_STORE_OR_SKIP(store, dir, nullptr);
+  put_documents(store, 0, 50);
+
+  std::vector<std::string> names = {doc_id(42), "missing", doc_id(3), doc_id(17), doc_id(0)};
+  std::vector<const char*> ids;
+  for (const std::string& name : names) {
+    ids.push_back(name.c_str());
+  }
+  ids.push_back(nullptr);
+
+  std::vector<olib_object_t*> docs(ids.size());
+  EXPECT_EQ(olib_store_get_batch(store, ids.data(), ids.size(), docs.data()), 4u);
+  expect_document(docs[0], 42);
+  EXPECT_EQ(docs[1], nullptr);
+  expect_document(docs[2], 3);
+  expect_document(docs[3], 17);
+  expect_document(docs[4], 0);
+  EXPECT_EQ(docs[5], nullptr);
+
+  for (olib_object_t* doc : docs) {
+    olib_object_free(doc);
+  }
+  olib_store_close(store);
+}
+
+// =============================================================================
+// Persistence
+// =============================================================================
+
+TEST(Store, ReopenKeepsDocuments) {
+  StoreDir dir("reopen");
+  {
+    OPEN_STORE_OR_SKIP(store, dir, nullptr);
+    // Enough ids to grow the index past its initial capacity
+    put_documents(store, 0, 3000);
+    for (int i = 0; i < 3000; i += 3) {
+      ASSERT_TRUE(olib_store_delete(store, doc_id(i).c_str()));
+    }
+    olib_store_close(store);
+  }
+
+  // Twice: once from the saved index, once rebuilt from the segments alone
+  for (int pass = 0; pass < 2; pass++) {
+    if (pass == 1) {
+      std::filesystem::remove(std::filesystem::path(dir.path()) / "index");
+    }
+    olib_store_t* store = olib_store_open(dir.path(), nullptr);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(olib_store_count(store), 2000u) << "pass " << pass;
+    for (int i = 0; i < 3000; i += 7) {
+      olib_object_t* doc = olib_store_get(store, doc_id(i).c_str());
+      if (i % 3 == 0) {
+        EXPECT_EQ(doc, nullptr) << "document " << i;
+      } else {
+        expect_document(doc, i);
+      }
+      olib_object_free(doc);
+    }
+    olib_store_close(store);
+  }
+}
+
+// =============================================================================
+// Compaction
+// =============================================================================
+
+TEST(Store, ManualCompaction) {
+  StoreDir dir("manual-compaction");
+  olib_store_options_t options = {};
+  options.segment_size = 16 * 1024;
+  options.manual_compaction = true;
+  OPEN_STORE_OR_SKIP(store, dir, &options);
+
+  // Rewrite the same ids until most segments hold only dead records
+  for (int round = 0; round < 5; round++) {
+    put_documents(store, 0, 200);
+  }
+  for (int i = 100; i < 200; i++) {
+    ASSERT_TRUE(olib_store_delete(store, doc_id(i).c_str()));
+  }
+  size_t before = olib_store_segment_count(store);
+  ASSERT_GT(before, 4u);
+
+  EXPECT_GT(olib_store_compact(store), 0u);
+  EXPECT_LT(olib_store_segment_count(store), before);
+  EXPECT_EQ(olib_store_compact(store), 0u);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  olib_store_close(store);
+
+  // Deletes stay deleted when the index is rebuilt from the compacted segments
+  std::filesystem::remove(std::filesystem::path(dir.path()) / "index");
+  store = olib_store_open(dir.path(), &options);
+  ASSERT_NE(store, nullptr);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  for (int i = 0; i < 200; i++) {
+    olib_object_t* doc = olib_store_get(store, doc_id(i).c_str());
+    if (i < 100) {
+      expect_document(doc, i);
+    } else {
+      EXPECT_EQ(doc, nullptr) << "document " << i;
+    }
+    olib_object_free(doc);
+  }
+  olib_store_close(store);
+}
+
+TEST(Store, BackgroundCompaction) {
+  StoreDir dir("background-compaction");
+  olib_store_options_t options = {};
+  options.segment_size = 64 * 1024;
+  OPEN_STORE_OR_SKIP(store, dir, &options);
+
+  for (int round = 0; round < 20; round++) {
+    put_documents(store, 0, 100);
+    // Reads keep working while segments move underneath
+    olib_object_t* doc = olib_store_get(store, doc_id(round).c_str());
+    expect_document(doc, round);
+    olib_object_free(doc);
+  }
+  olib_store_close(store);
+
+  store = olib_store_open(dir.path(), &options);
+  ASSERT_NE(store, nullptr);
+  // 20 rounds of overwrites would need far more segments without compaction
+  EXPECT_LT(olib_store_segment_count(store), 20u);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  for (int i = 0; i < 100; i++) {
+    olib_object_t* doc = olib_store_get(store, doc_id(i).c_str());
+    expect_document(doc, i);
+    olib_object_free(doc);
+  }
+  olib_store_close(store);
+}
+
+TEST(Store, ShortSessionsCompact) {
+  StoreDir dir("short-sessions");
+  olib_store_options_t options = {};
+  options.segment_size = 16 * 1024;
+  options.manual_compaction = true;
+  OPEN_STORE_OR_SKIP(store, dir, &options);
+  olib_store_close(store);
+
+  // A backlog of dead records left by sessions that never compacted
+  for (int session = 0; session < 10; session++) {
+    store = olib_store_open(dir.path(), &options);
+    ASSERT_NE(store, nullptr);
+    put_documents(store, 0, 100);
+    olib_store_close(store);
+  }
+
+  // Opening picks the backlog up, and every session finishes what it started
+  options.manual_compaction = false;
+  size_t backlog = 0;
+  for (int session = 0; session < 30; session++) {
+    store = olib_store_open(dir.path(), &options);
+    ASSERT_NE(store, nullptr);
+    if (session == 0) {
+      backlog = olib_store_segment_count(store);
+    }
+    put_documents(store, session % 100, 20);
+    olib_store_close(store);
+  }
+
+  options.manual_compaction = true;
+  store = olib_store_open(dir.path(), &options);
+  ASSERT_NE(store, nullptr);
+  EXPECT_LT(olib_store_segment_count(store) * 4, backlog);
+  EXPECT_EQ(olib_store_compact(store), 0u);
+  EXPECT_EQ(olib_store_count(store), 100u);
+  olib_store_close(store);
+}
+
+TEST(Store, LargeDocumentGetsItsOwnSegment) {
+  StoreDir dir("large-document");
+  olib_store_options_t options = {};
+  options.segment_size = 4096;
+  OPEN_STORE_OR_SKIP(store, dir, &options);
+
+  olib_object_t* big = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 50; i++) {
+    olib_object_list_push(big, create_document(i));
+  }
+  ASSERT_TRUE(olib_store_put(store, "big", big));
+  olib_object_t* doc = olib_store_get(store, "big");
+  ASSERT_NE(doc, nullptr);
+  EXPECT_EQ(olib_object_list_size(doc), 50u);
+  expect_document(olib_object_list_get(doc, 49), 49);
+
+  olib_object_free(doc);
+  olib_object_free(big);
+  olib_store_close(store);
+}
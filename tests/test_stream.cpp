@@ -0,0 +1,187 @@
+#include "test_utils.h"
+#include <filesystem>
+#include <vector>
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static olib_stream_chain_t* make_chain(std::initializer_list<olib_stream_filter_t*> filters) {
+  olib_stream_chain_t* chain = olib_stream_chain_new();
+  for (olib_stream_filter_t* filter : filters) {
+    EXPECT_TRUE(olib_stream_chain_push(chain, filter));
+  }
+  return chain;
+}
+
+static std::string run_chain(olib_stream_chain_t* chain, const std::string& input, bool* ok = nullptr) {
+  uint8_t* out = nullptr;
+  size_t out_size = 0;
+  bool result = olib_stream_chain_apply(chain, (const uint8_t*)input.data(), input.size(), &out, &out_size);
+  if (ok) {
+    *ok = result;
+  } else {
+    EXPECT_TRUE(result);
+  }
+  std::string str = result ? std::string((const char*)out, out_size) : std::string();
+  olib_free(out);
+  return str;
+}
+
+// =============================================================================
+// Built-in filters
+// =============================================================================
+
+TEST(Stream, Base64KnownVectors) {
+  olib_stream_chain_t* encode = make_chain({olib_stream_filter_new_base64_encode()});
+  olib_stream_chain_t* decode = make_chain({olib_stream_filter_new_base64_decode()});
+
+  const char* vectors[][2] = {{"", ""},         {"f", "Zg=="},         {"fo", "Zm8="},        {"foo", "Zm9v"},
+                              {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}};
+  for (auto& vector : vectors) {
+    EXPECT_EQ(run_chain(encode, vector[0]), vector[1]);
+    EXPECT_EQ(run_chain(decode, vector[1]), vector[0]);
+  }
+
+  // Whitespace is skipped when decoding
+  EXPECT_EQ(run_chain(decode, "Zm9v\r\nYmFy\n"), "foobar");
+
+  olib_stream_chain_free(encode);
+  olib_stream_chain_free(decode);
+}
+
+TEST(Stream, Base64RejectsInvalidInput) {
+  olib_stream_chain_t* decode = make_chain({olib_stream_filter_new_base64_decode()});
+
+  const char* invalid[] = {"Zm9", "Zm9v!", "Z===", "Zg==Zg==", "Zg=a", "=Zg="};
+  for (const char* input : invalid) {
+    bool ok = true;
+    run_chain(decode, input, &ok);
+    EXPECT_FALSE(ok) << input;
+  }
+
+  olib_stream_chain_free(decode);
+}
+
+TEST(Stream, Crc32AndCounters) {
+  olib_stream_filter_t* crc = olib_stream_filter_new_crc32();
+  olib_stream_filter_t* encode = olib_stream_filter_new_base64_encode();
+  olib_stream_filter_t* counter = olib_stream_filter_new_counter();
+  olib_stream_chain_t* chain = make_chain({crc, encode, counter});
+  EXPECT_EQ(olib_stream_chain_size(chain), 3u);
+  EXPECT_EQ(olib_stream_chain_get(chain, 1), encode);
+
+  run_chain(chain, "123456789");
+  EXPECT_EQ(olib_stream_filter_crc32_value(crc), 0xCBF43926u);
+  EXPECT_EQ(olib_stream_filter_bytes_in(crc), 9u);
+  EXPECT_EQ(olib_stream_filter_bytes_out(encode), 12u);
+  EXPECT_EQ(olib_stream_filter_bytes_in(counter), 12u);
+
+  // Every stream starts from a clean state
+  run_chain(chain, "");
+  EXPECT_EQ(olib_stream_filter_crc32_value(crc), 0u);
+  EXPECT_EQ(olib_stream_filter_bytes_in(counter), 0u);
+
+  // Only crc32 filters report a value, and filters belong to one chain
+  EXPECT_EQ(olib_stream_filter_crc32_value(counter), 0u);
+  olib_stream_chain_t* other = olib_stream_chain_new();
+  EXPECT_FALSE(olib_stream_chain_push(other, crc));
+
+  olib_stream_chain_free(other);
+  olib_stream_chain_free(chain);
+}
+
+TEST(Stream, LargeInputAcrossBlocks) {
+  // Sizes that leave one and two bytes over at every block boundary
+  std::string input;
+  for (size_t i = 0; i < OLIB_STREAM_BLOCK_SIZE * 3 + 7; i++) {
+    input.push_back((char)(i * 131 + (i >> 8)));
+  }
+  olib_stream_chain_t* chain =
+      make_chain({olib_stream_filter_new_base64_encode(), olib_stream_filter_new_base64_decode()});
+  olib_stream_chain_t* encode = make_chain({olib_stream_filter_new_base64_encode()});
+
+  EXPECT_EQ(run_chain(chain, input), input);
+  EXPECT_EQ(run_chain(encode, input).size(), (input.size() + 2) / 3 * 4);
+
+  olib_stream_chain_free(chain);
+  olib_stream_chain_free(encode);
+}
+
+// =============================================================================
+// Custom filters
+// =============================================================================
+
+static bool xor_process(void* ctx, const uint8_t* data, size_t size, olib_stream_emit_fn emit, void* emit_ctx) {
+  uint8_t key = *(uint8_t*)ctx;
+  std::vector<uint8_t> out(data, data + size);
+  for (uint8_t& byte : out) {
+    byte ^= key;
+  }
+  return emit(emit_ctx, out.data(), out.size());
+}
+
+TEST(Stream, CustomFilter) {
+  uint8_t key = 0x5A;
+  olib_stream_filter_config_t config = {};
+  config.user_data = &key;
+  config.process = xor_process;
+
+  olib_stream_chain_t* chain = make_chain({olib_stream_filter_new(&config), olib_stream_filter_new(&config)});
+  EXPECT_EQ(run_chain(chain, "hello"), "hello");
+  olib_stream_chain_free(chain);
+
+  // A filter without process is rejected
+  config.process = nullptr;
+  EXPECT_EQ(olib_stream_filter_new(&config), nullptr);
+}
+
+// =============================================================================
+// Serializer integration
+// =============================================================================
+
+TEST(Stream, FilteredSerializerRoundTrip) {
+  olib_object_t* original = create_test_object();
+  olib_format_t formats[] = {OLIB_FORMAT_BINARY, OLIB_FORMAT_JSON_TEXT, OLIB_FORMAT_YAML};
+
+  for (olib_format_t format : formats) {
+    olib_stream_chain_t* write_chain = make_chain({olib_stream_filter_new_crc32(), olib_stream_filter_new_base64_encode()});
+    olib_stream_chain_t* read_chain = make_chain({olib_stream_filter_new_base64_decode(), olib_stream_filter_new_crc32()});
+
+    // Memory
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_format_write_filtered(format, original, write_chain, &data, &size));
+    for (size_t i = 0; i < size; i++) {
+      EXPECT_TRUE(isalnum(data[i]) || data[i] == '+' || data[i] == '/' || data[i] == '=');
+    }
+    olib_object_t* parsed = olib_format_read_filtered(format, read_chain, data, size);
+    verify_test_object(parsed);
+    EXPECT_EQ(olib_stream_filter_crc32_value(olib_stream_chain_get(read_chain, 1)),
+              olib_stream_filter_crc32_value(olib_stream_chain_get(write_chain, 0)));
+    olib_object_free(parsed);
+    olib_free(data);
+
+    // File
+    std::string path_str = (std::filesystem::temp_directory_path() / "olib_stream_filtered.b64").string();
+    ASSERT_TRUE(olib_format_write_file_path_filtered(format, original, write_chain, path_str.c_str()));
+    parsed = olib_format_read_file_path_filtered(format, read_chain, path_str.c_str());
+    verify_test_object(parsed);
+    olib_object_free(parsed);
+    remove(path_str.c_str());
+
+    olib_stream_chain_free(write_chain);
+    olib_stream_chain_free(read_chain);
+  }
+
+  // A NULL chain passes data through unchanged
+  uint8_t* plain = nullptr;
+  size_t plain_size = 0;
+  ASSERT_TRUE(olib_format_write_filtered(OLIB_FORMAT_BINARY, original, nullptr, &plain, &plain_size));
+  olib_object_t* parsed = olib_format_read(OLIB_FORMAT_BINARY, plain, plain_size);
+  verify_test_object(parsed);
+  olib_object_free(parsed);
+  olib_free(plain);
+
+  olib_object_free(original);
+}
@@ -0,0 +1,295 @@
+#include "test_utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+// Collects the pieces delivered to a string sink
+struct Sink {
+  std::vector<std::string> values;
+  std::vector<olib_object_t*> nodes;
+  size_t max_chunk = 0;
+  bool open = false;
+};
+
+static bool collect(void* ctx, olib_object_t* node, const char* chunk, size_t size, bool last) {
+  Sink* sink = (Sink*)ctx;
+  if (!sink->open) {
+    sink->values.emplace_back();
+    sink->nodes.push_back(node);
+    sink->open = true;
+  }
+  sink->values.back().append(chunk, size);
+  sink->max_chunk = std::max(sink->max_chunk, size);
+  sink->open = !last;
+  return true;
+}
+
+// Serves one string in pieces of a fixed size to every node asking for one
+struct Source {
+  std::string value;
+  size_t piece = 7;
+  size_t offset = 0;
+  size_t calls = 0;
+};
+
+static bool serve(void* ctx, olib_object_t*, const char** chunk, size_t* size, bool* last) {
+  Source* source = (Source*)ctx;
+  source->calls++;
+  size_t n = std::min(source->piece, source->value.size() - source->offset);
+  *chunk = source->value.data() + source->offset;
+  *size = n;
+  source->offset += n;
+  *last = source->offset == source->value.size();
+  if (*last) source->offset = 0;
+  return true;
+}
+
+// A payload with characters JSON has to escape spread over every chunk boundary
+static std::string make_payload(size_t size) {
+  std::string payload;
+  const char* pattern = "payload \"quoted\" \\ line\n\ttab \xC3\xA9 ";
+  while (payload.size() < size) payload += pattern;
+  payload.resize(size);
+  // Do not cut the two-byte character in half
+  if ((unsigned char)payload.back() == 0xC3) payload.back() = '.';
+  return payload;
+}
+
+// Write or read with a configured serializer, text or binary
+static bool write_with(olib_serializer_t* serializer, olib_object_t* obj, uint8_t** data, size_t* size) {
+  if (!olib_serializer_is_text_based(serializer)) {
+    return olib_serializer_write(serializer, obj, data, size);
+  }
+  char* str = nullptr;
+  if (!olib_serializer_write_string(serializer, obj, &str)) return false;
+  *data = (uint8_t*)str;
+  *size = strlen(str);
+  return true;
+}
+
+static olib_object_t* read_with(olib_serializer_t* serializer, const uint8_t* data, size_t size) {
+  if (!olib_serializer_is_text_based(serializer)) {
+    return olib_serializer_read(serializer, data, size);
+  }
+  return olib_serializer_read_string(serializer, std::string((const char*)data, size).c_str());
+}
+
+static bool is_empty(olib_object_t* obj) {
+  const char* value = olib_object_get_string(obj);
+  return !value || !*value;
+}
+
+static olib_object_t* make_document(const std::string& payload) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* blob = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(blob, payload.c_str());
+  olib_object_struct_add(root, "blob", blob);
+  olib_object_t* name = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(name, "short");
+  olib_object_struct_add(root, "name", name);
+  return root;
+}
+
+// =============================================================================
+// Reading
+// =============================================================================
+
+class StringSinkTest : public ::testing::TestWithParam<olib_format_t> {};
+
+TEST_P(StringSinkTest, LongValuesGoToTheSink) {
+  std::string payload = make_payload(5000);
+  olib_object_t* doc = make_document(payload);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(write_any_format(GetParam(), doc, &data, &size));
+
+  olib_serializer_t* serializer = olib_format_serializer(GetParam());
+  Sink sink;
+  ASSERT_TRUE(olib_serializer_set_string_sink(serializer, 64, collect, &sink));
+  olib_object_t* back = read_with(serializer, data, size);
+  ASSERT_NE(back, nullptr);
+
+  ASSERT_EQ(sink.values.size(), 1u);
+  EXPECT_EQ(sink.values[0], payload);
+  EXPECT_LE(sink.max_chunk, 64u);
+  EXPECT_FALSE(sink.open);
+  EXPECT_EQ(sink.nodes[0], olib_object_struct_get(back, "blob"));
+  EXPECT_TRUE(is_empty(olib_object_struct_get(back, "blob")));
+  EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(back, "name")), "short");
+
+  // Reading into the same tree streams the value again
+  sink = Sink();
+  if (olib_serializer_is_text_based(serializer)) {
+    std::string text((const char*)data, size);
+    EXPECT_TRUE(olib_serializer_read_into(serializer, (const uint8_t*)text.c_str(), size, back));
+  } else {
+    EXPECT_TRUE(olib_serializer_read_into(serializer, data, size, back));
+  }
+  ASSERT_EQ(sink.values.size(), 1u);
+  EXPECT_EQ(sink.values[0], payload);
+
+  olib_object_free(back);
+  olib_serializer_free(serializer);
+  olib_free(data);
+  olib_object_free(doc);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, StringSinkTest,
+                         ::testing::Values(OLIB_FORMAT_BINARY, OLIB_FORMAT_JSON_TEXT, OLIB_FORMAT_YAML));
+
+TEST(StringSink, ValueOfChunkSizeWithEscapeIsStored) {
+  // 14 plain bytes and \n decode to 15 bytes, the escape starts within 3 bytes of the end
+  std::string value = "abcdefghijklmn\n";
+  olib_object_t* doc = make_document(value);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(write_any_format(OLIB_FORMAT_JSON_TEXT, doc, &data, &size));
+
+  olib_serializer_t* serializer = olib_format_serializer(OLIB_FORMAT_JSON_TEXT);
+  Sink sink;
+  ASSERT_TRUE(olib_serializer_set_string_sink(serializer, 16, collect, &sink));
+  olib_object_t* back = read_with(serializer, data, size);
+  ASSERT_NE(back, nullptr);
+  EXPECT_TRUE(sink.values.empty());
+  EXPECT_EQ(olib_object_get_string(olib_object_struct_get(back, "blob")), value);
+  olib_object_free(back);
+
+  // Two bytes more go to the sink
+  value = "abcdefghijklmno\n\t";
+  olib_object_free(doc);
+  olib_free(data);
+  doc = make_document(value);
+  ASSERT_TRUE(write_any_format(OLIB_FORMAT_JSON_TEXT, doc, &data, &size));
+  back = read_with(serializer, data, size);
+  ASSERT_NE(back, nullptr);
+  ASSERT_EQ(sink.values.size(), 1u);
+  EXPECT_EQ(sink.values[0], value);
+  EXPECT_LE(sink.max_chunk, 16u);
+  EXPECT_TRUE(is_empty(olib_object_struct_get(back, "blob")));
+
+  olib_object_free(back);
+  olib_serializer_free(serializer);
+  olib_free(data);
+  olib_object_free(doc);
+}
+
+TEST(StringSink, RejectsTinyChunks) {
+  olib_serializer_t* serializer = olib_serializer_new_binary();
+  Sink sink;
+  EXPECT_FALSE(olib_serializer_set_string_sink(serializer, 8, collect, &sink));
+  EXPECT_TRUE(olib_serializer_set_string_sink(serializer, 16, collect, &sink));
+  EXPECT_TRUE(olib_serializer_set_string_sink(serializer, 0, nullptr, nullptr));
+  olib_serializer_free(serializer);
+}
+
+static size_t g_largest = 0;
+static void* track_malloc(size_t size) {
+  g_largest = std::max(g_largest, size);
+  return malloc(size);
+}
+static void* track_calloc(size_t num, size_t size) {
+  g_largest = std::max(g_largest, num * size);
+  return calloc(num, size);
+}
+static void* track_realloc(void* ptr, size_t size) {
+  g_largest = std::max(g_largest, size);
+  return realloc(ptr, size);
+}
+
+TEST(StringSink, NoAllocationHoldsTheValue) {
+  std::string payload = make_payload(1 << 20);
+  olib_object_t* doc = make_document(payload);
+  for (olib_format_t format : {OLIB_FORMAT_BINARY, OLIB_FORMAT_JSON_TEXT}) {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(write_any_format(format, doc, &data, &size));
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    Sink sink;
+    olib_serializer_set_string_sink(serializer, 4096, collect, &sink);
+
+    g_largest = 0;
+    olib_set_memory_fns(track_malloc, free, track_calloc, track_realloc);
+    olib_object_t* back = read_with(serializer, data, size);
+    olib_set_memory_fns(malloc, free, calloc, realloc);
+
+    ASSERT_NE(back, nullptr);
+    EXPECT_EQ(sink.values[0], payload);
+    EXPECT_LT(g_largest, 64u * 1024u) << (int)format;
+    olib_object_free(back);
+    olib_serializer_free(serializer);
+    olib_free(data);
+  }
+  olib_object_free(doc);
+}
+
+// =============================================================================
+// Writing
+// =============================================================================
+
+TEST(StringSource, FillsEmptyNodes) {
+  std::string payload = make_payload(3000);
+  olib_object_t* doc = make_document("");
+
+  for (olib_format_t format : {OLIB_FORMAT_BINARY, OLIB_FORMAT_JSON_TEXT, OLIB_FORMAT_YAML}) {
+    olib_serializer_t* serializer = olib_format_serializer(format);
+    Source source;
+    source.value = payload;
+    ASSERT_TRUE(olib_serializer_set_string_source(serializer, serve, &source));
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(write_with(serializer, doc, &data, &size));
+    EXPECT_EQ(source.calls, (payload.size() + source.piece - 1) / source.piece);
+    olib_serializer_free(serializer);
+
+    // The output is a regular document holding the streamed value
+    olib_object_t* back = read_any_format(format, data, size);
+    ASSERT_NE(back, nullptr) << (int)format;
+    EXPECT_EQ(olib_object_get_string(olib_object_struct_get(back, "blob")), payload);
+    EXPECT_STREQ(olib_object_get_string(olib_object_struct_get(back, "name")), "short");
+    olib_object_free(back);
+    olib_free(data);
+  }
+  olib_object_free(doc);
+}
+
+TEST(StringSource, SinkToSourceRoundTrip) {
+  std::string payload = make_payload(10000);
+  olib_object_t* doc = make_document(payload);
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  ASSERT_TRUE(write_any_format(OLIB_FORMAT_JSON_TEXT, doc, &data, &size));
+
+  olib_serializer_t* reader = olib_serializer_new_json_text();
+  Sink sink;
+  olib_serializer_set_string_sink(reader, 256, collect, &sink);
+  olib_object_t* skeleton = read_with(reader, data, size);
+  ASSERT_NE(skeleton, nullptr);
+  ASSERT_EQ(sink.values.size(), 1u);
+
+  // Convert to binary without the value ever entering the tree
+  olib_serializer_t* writer = olib_serializer_new_binary();
+  Source source;
+  source.value = sink.values[0];
+  source.piece = 1000;
+  olib_serializer_set_string_source(writer, serve, &source);
+  uint8_t* binary = nullptr;
+  size_t binary_size = 0;
+  ASSERT_TRUE(olib_serializer_write(writer, skeleton, &binary, &binary_size));
+
+  olib_object_t* back = olib_format_read(OLIB_FORMAT_BINARY, binary, binary_size);
+  ASSERT_NE(back, nullptr);
+  EXPECT_EQ(olib_object_get_string(olib_object_struct_get(back, "blob")), payload);
+
+  olib_object_free(back);
+  olib_free(binary);
+  olib_serializer_free(writer);
+  olib_object_free(skeleton);
+  olib_serializer_free(reader);
+  olib_free(data);
+  olib_object_free(doc);
+}
@@ -0,0 +1,195 @@
+#include "test_utils.h"
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+static const olib_format_t kTemplateFormats[] = {
+    OLIB_FORMAT_JSON_TEXT, OLIB_FORMAT_YAML, OLIB_FORMAT_XML, OLIB_FORMAT_TOML, OLIB_FORMAT_TXT,
+};
+
+// Response-like shape: scalars at the top level, a nested struct and lists of both kinds
+static olib_object_t* create_response(int64_t id, const char* name, double score, bool active) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+
+  olib_object_t* id_val = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(id_val, id);
+  olib_object_struct_add(root, "id", id_val);
+
+  olib_object_t* name_val = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(name_val, name);
+  olib_object_struct_add(root, "name", name_val);
+
+  olib_object_t* score_val = olib_object_new(OLIB_OBJECT_TYPE_FLOAT);
+  olib_object_set_float(score_val, score);
+  olib_object_struct_add(root, "score", score_val);
+
+  olib_object_t* user = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* active_val = olib_object_new(OLIB_OBJECT_TYPE_BOOL);
+  olib_object_set_bool(active_val, active);
+  olib_object_struct_add(user, "active", active_val);
+  olib_object_t* visits = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+  olib_object_set_uint(visits, (uint64_t)id * 3);
+  olib_object_struct_add(user, "visits", visits);
+  olib_object_struct_add(root, "user", user);
+
+  olib_object_t* tags = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 3; i++) {
+    olib_object_t* tag = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+    olib_object_set_string(tag, (std::string(name) + " #" + std::to_string(i)).c_str());
+    olib_object_list_push(tags, tag);
+  }
+  olib_object_struct_add(root, "tags", tags);
+
+  olib_object_t* counts = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 12; i++) {
+    olib_object_t* count = olib_object_new(OLIB_OBJECT_TYPE_INT);
+    // Wraps for the extreme ids, computed unsigned to stay defined
+    olib_object_set_int(count, (int64_t)((uint64_t)id * (uint64_t)i - 5));
+    olib_object_list_push(counts, count);
+  }
+  olib_object_struct_add(root, "counts", counts);
+
+  return root;
+}
+
+static std::string write_reference(olib_format_t format, olib_object_t* obj) {
+  char* str = nullptr;
+  EXPECT_TRUE(olib_format_write_string(format, obj, &str)) << "format " << format;
+  std::string result = str ? str : "";
+  olib_free(str);
+  return result;
+}
+
+static std::string render(olib_template_t* tmpl, olib_object_t* values) {
+  uint8_t* data = nullptr;
+  size_t size = 0;
+  EXPECT_TRUE(olib_template_render(tmpl, values, &data, &size));
+  std::string result = data ? std::string((const char*)data, size) : "";
+  if (data) {
+    EXPECT_EQ(data[size], '\0');
+  }
+  olib_free(data);
+  return result;
+}
+
+// =============================================================================
+// Rendering
+// =============================================================================
+
+TEST(Template, RenderMatchesSerializer) {
+  // Values that exercise escaping, YAML quoting, float formatting and sign handling
+  struct Values {
+    int64_t id;
+    const char* name;
+    double score;
+    bool active;
+  };
+  const Values cases[] = {
+      {1, "plain", 0.5, true},
+      {-42, "quote \" back\\slash\ttab\nnewline", -1e300, false},
+      {INT64_MAX, "<xml> & 'apos'", 3.0, true},
+      {7, "true", 1234567.891, false},
+      {0, "", 2.0, true},
+      {99, "key: value # comment", 1e-7, false},
+      {12, "ctrl \x01\x1f end", 100.0, true},
+  };
+
+  olib_object_t* shape = create_response(0, "shape", 0.0, false);
+  for (olib_format_t format : kTemplateFormats) {
+    olib_template_t* tmpl = olib_template_compile(shape, format);
+    ASSERT_NE(tmpl, nullptr) << "format " << format;
+    EXPECT_EQ(olib_template_slot_count(tmpl), 20u);
+
+    for (const Values& v : cases) {
+      olib_object_t* values = create_response(v.id, v.name, v.score, v.active);
+      EXPECT_EQ(render(tmpl, values), write_reference(format, values)) << "format " << format << " name " << v.name;
+      olib_object_free(values);
+    }
+    olib_template_free(tmpl);
+  }
+  olib_object_free(shape);
+}
+
+TEST(Template, RenderedOutputReadsBack) {
+  olib_object_t* shape = create_test_object();
+  olib_template_t* tmpl = olib_template_compile(shape, OLIB_FORMAT_JSON_TEXT);
+  ASSERT_NE(tmpl, nullptr);
+
+  char* str = nullptr;
+  ASSERT_TRUE(olib_template_render_string(tmpl, shape, &str));
+  olib_object_t* parsed = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, str);
+  verify_test_object(parsed);
+
+  olib_object_free(parsed);
+  olib_free(str);
+  olib_template_free(tmpl);
+  olib_object_free(shape);
+}
+
+TEST(Template, LargeShapeUsesHeapSlots) {
+  olib_object_t* shape = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* items = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 200; i++) {
+    olib_object_t* item = olib_object_new(OLIB_OBJECT_TYPE_UINT);
+    olib_object_set_uint(item, (uint64_t)i);
+    olib_object_list_push(items, item);
+  }
+  olib_object_struct_add(shape, "items", items);
+
+  olib_template_t* tmpl = olib_template_compile(shape, OLIB_FORMAT_YAML);
+  ASSERT_NE(tmpl, nullptr);
+  EXPECT_EQ(olib_template_slot_count(tmpl), 200u);
+  EXPECT_EQ(render(tmpl, shape), write_reference(OLIB_FORMAT_YAML, shape));
+
+  olib_template_free(tmpl);
+  olib_object_free(shape);
+}
+
+// =============================================================================
+// Errors
+// =============================================================================
+
+TEST(Template, RejectsMismatchedValues) {
+  olib_object_t* shape = create_response(0, "shape", 0.0, false);
+  olib_template_t* tmpl = olib_template_compile(shape, OLIB_FORMAT_JSON_TEXT);
+  ASSERT_NE(tmpl, nullptr);
+
+  uint8_t* data = nullptr;
+  size_t size = 0;
+
+  // Scalar type differs
+  olib_object_t* values = create_response(1, "a", 1.0, true);
+  olib_object_t* wrong_type = olib_object_new(OLIB_OBJECT_TYPE_STRING);
+  olib_object_set_string(wrong_type, "1");
+  olib_object_struct_set(values, "id", wrong_type);
+  EXPECT_FALSE(olib_template_render(tmpl, values, &data, &size));
+  olib_object_free(values);
+
+  // List size differs
+  values = create_response(1, "a", 1.0, true);
+  olib_object_list_pop(olib_object_struct_get(values, "counts"));
+  EXPECT_FALSE(olib_template_render(tmpl, values, &data, &size));
+  olib_object_free(values);
+
+  // Key differs
+  values = create_response(1, "a", 1.0, true);
+  olib_object_t* user = olib_object_struct_get(values, "user");
+  olib_object_t* visits = olib_object_dupe(olib_object_struct_get(user, "visits"));
+  olib_object_struct_remove(user, "visits");
+  olib_object_struct_add(user, "views", visits);
+  EXPECT_FALSE(olib_template_render(tmpl, values, &data, &size));
+  olib_object_free(values);
+
+  EXPECT_EQ(data, nullptr);
+  olib_template_free(tmpl);
+  olib_object_free(shape);
+}
+
+TEST(Template, BinaryFormatsAreNotSupported) {
+  olib_object_t* shape = create_test_object();
+  EXPECT_EQ(olib_template_compile(shape, OLIB_FORMAT_BINARY), nullptr);
+  EXPECT_EQ(olib_template_compile(shape, OLIB_FORMAT_JSON_BINARY), nullptr);
+  EXPECT_EQ(olib_template_compile(nullptr, OLIB_FORMAT_JSON_TEXT), nullptr);
+  olib_object_free(shape);
+}
@@ -0,0 +1,304 @@
+#include "test_utils.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+static std::string trace_path(const char* name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static std::vector<olib_trace_record_t> load_records(olib_trace_t* trace) {
+  std::vector<olib_trace_record_t> records(olib_trace_size(trace));
+  for (size_t i = 0; i < records.size(); i++) {
+    EXPECT_TRUE(olib_trace_get(trace, i, &records[i]));
+  }
+  return records;
+}
+
+// Same types, container sizes, string lengths and integer digit counts
+static void expect_same_shape(olib_object_t* a, olib_object_t* b) {
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_EQ(olib_object_get_type(a), olib_object_get_type(b));
+  switch (olib_object_get_type(a)) {
+    case OLIB_OBJECT_TYPE_STRUCT:
+      ASSERT_EQ(olib_object_struct_size(a), olib_object_struct_size(b));
+      for (size_t i = 0; i < olib_object_struct_size(a); i++) {
+        EXPECT_EQ(strlen(olib_object_struct_key_at(a, i)), strlen(olib_object_struct_key_at(b, i)));
+        expect_same_shape(olib_object_struct_value_at(a, i), olib_object_struct_value_at(b, i));
+      }
+      break;
+    case OLIB_OBJECT_TYPE_LIST:
+      ASSERT_EQ(olib_object_list_size(a), olib_object_list_size(b));
+      for (size_t i = 0; i < olib_object_list_size(a); i++) {
+        expect_same_shape(olib_object_list_get(a, i), olib_object_list_get(b, i));
+      }
+      break;
+    case OLIB_OBJECT_TYPE_STRING:
+      EXPECT_EQ(strlen(olib_object_get_string(a)), strlen(olib_object_get_string(b)));
+      break;
+    case OLIB_OBJECT_TYPE_INT:
+      EXPECT_EQ(std::to_string(olib_object_get_int(a)).size(), std::to_string(olib_object_get_int(b)).size());
+      break;
+    case OLIB_OBJECT_TYPE_BOOL:
+      EXPECT_EQ(olib_object_get_bool(a), olib_object_get_bool(b));
+      break;
+    default:
+      break;
+  }
+}
+
+// =============================================================================
+// Capture
+// =============================================================================
+
+TEST(TraceCapture, RecordsHelpersAndSerializerCalls) {
+  std::string path = trace_path("olib_trace_calls.oltr");
+  olib_object_t* obj = create_test_object();
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), nullptr));
+
+  char* json = nullptr;
+  ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &json));
+  olib_object_t* parsed = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json);
+  ASSERT_NE(parsed, nullptr);
+
+  // The read and write inside the conversion are part of one record
+  uint8_t* converted = nullptr;
+  size_t converted_size = 0;
+  ASSERT_TRUE(olib_convert(OLIB_FORMAT_JSON_TEXT, (const uint8_t*)json, strlen(json), OLIB_FORMAT_BINARY,
+                           &converted, &converted_size));
+
+  olib_serializer_t* binary = olib_serializer_new_binary();
+  olib_object_t* direct = olib_serializer_read(binary, converted, converted_size);
+  ASSERT_NE(direct, nullptr);
+  olib_serializer_free(binary);
+
+  EXPECT_EQ(olib_trace_capture_count(), 4u);
+  ASSERT_TRUE(olib_trace_capture_stop());
+  EXPECT_FALSE(olib_trace_capture_stop());
+
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  std::vector<olib_trace_record_t> records = load_records(trace);
+  ASSERT_EQ(records.size(), 4u);
+
+  EXPECT_EQ(records[0].op, OLIB_TRACE_WRITE);
+  EXPECT_EQ(records[0].dst_format, OLIB_FORMAT_JSON_TEXT);
+  olib_object_t* written = read_any_format(OLIB_FORMAT_BINARY, records[0].data, records[0].size);
+  verify_test_object(written);
+  olib_object_free(written);
+
+  EXPECT_EQ(records[1].op, OLIB_TRACE_READ);
+  EXPECT_EQ(records[1].src_format, OLIB_FORMAT_JSON_TEXT);
+  EXPECT_STREQ((const char*)records[1].data, json);
+
+  EXPECT_EQ(records[2].op, OLIB_TRACE_CONVERT);
+  EXPECT_EQ(records[2].src_format, OLIB_FORMAT_JSON_TEXT);
+  EXPECT_EQ(records[2].dst_format, OLIB_FORMAT_BINARY);
+  EXPECT_EQ(records[2].size, strlen(json));
+
+  EXPECT_EQ(records[3].op, OLIB_TRACE_READ);
+  EXPECT_EQ(records[3].src_format, OLIB_FORMAT_BINARY);
+  ASSERT_EQ(records[3].size, converted_size);
+  EXPECT_EQ(memcmp(records[3].data, converted, converted_size), 0);
+
+  olib_trace_free(trace);
+  olib_free(converted);
+  olib_free(json);
+  olib_object_free(direct);
+  olib_object_free(parsed);
+  olib_object_free(obj);
+  std::filesystem::remove(path);
+}
+
+TEST(TraceCapture, AnonymizeKeepsShape) {
+  std::string path = trace_path("olib_trace_anonymize.oltr");
+  const char* json =
+      "{\"customer\": {\"name\": \"Ada Lovelace\", \"email\": \"ada@example.com\", \"id\": 81234, "
+      "\"balance\": -1520.25, \"active\": true}, \"tags\": [\"vip\", \"vip\", \"beta\"], \"n\": -7}";
+  olib_object_t* original = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json);
+  ASSERT_NE(original, nullptr);
+
+  olib_trace_capture_config_t config = {};
+  config.anonymize = true;
+  config.seed = 1234;
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), &config));
+  olib_object_free(olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json));
+  olib_object_free(olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json));
+  char* text = nullptr;
+  ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_YAML, original, &text));
+  olib_free(text);
+  ASSERT_TRUE(olib_trace_capture_stop());
+
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  std::vector<olib_trace_record_t> records = load_records(trace);
+  ASSERT_EQ(records.size(), 3u);
+
+  // Equal inputs are rewritten the same way
+  ASSERT_EQ(records[0].size, records[1].size);
+  EXPECT_EQ(memcmp(records[0].data, records[1].data, records[0].size), 0);
+  EXPECT_EQ(strstr((const char*)records[0].data, "Lovelace"), nullptr);
+  EXPECT_EQ(strstr((const char*)records[0].data, "customer"), nullptr);
+
+  olib_object_t* rewritten = olib_format_read_string(OLIB_FORMAT_JSON_TEXT, (const char*)records[0].data);
+  expect_same_shape(original, rewritten);
+  olib_object_t* tags = olib_object_struct_value_at(rewritten, 1);
+  EXPECT_STREQ(olib_object_get_string(olib_object_list_get(tags, 0)),
+               olib_object_get_string(olib_object_list_get(tags, 1)));
+  olib_object_t* customer = olib_object_struct_value_at(rewritten, 0);
+  EXPECT_STRNE(olib_object_get_string(olib_object_struct_value_at(customer, 0)), "Ada Lovelace");
+  EXPECT_LT(olib_object_get_float(olib_object_struct_value_at(customer, 3)), 0.0);
+  EXPECT_NE(strchr(olib_object_get_string(olib_object_struct_value_at(customer, 1)), '@'), nullptr);
+  olib_object_free(rewritten);
+
+  olib_object_t* written = read_any_format(OLIB_FORMAT_BINARY, records[2].data, records[2].size);
+  expect_same_shape(original, written);
+  olib_object_free(written);
+
+  olib_trace_free(trace);
+  olib_object_free(original);
+  std::filesystem::remove(path);
+}
+
+TEST(TraceCapture, FileConversionsAreOneRecord) {
+  std::string path = trace_path("olib_trace_files.oltr");
+  std::string src_path = trace_path("olib_trace_files_src.json");
+  std::string dst_path = trace_path("olib_trace_files_dst.yaml");
+  olib_object_t* obj = create_test_object();
+  ASSERT_TRUE(olib_format_write_file_path(OLIB_FORMAT_JSON_TEXT, obj, src_path.c_str()));
+  size_t src_size = (size_t)std::filesystem::file_size(src_path);
+
+  // Conversions through files replay as the conversion, not as a read and a write
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), nullptr));
+  ASSERT_TRUE(olib_convert_file_path(OLIB_FORMAT_JSON_TEXT, src_path.c_str(), OLIB_FORMAT_YAML, dst_path.c_str()));
+  FILE* src_file = fopen(src_path.c_str(), "rb");
+  ASSERT_NE(src_file, nullptr);
+  FILE* dst_file = fopen(dst_path.c_str(), "w");
+  ASSERT_NE(dst_file, nullptr);
+  EXPECT_TRUE(olib_convert_file(OLIB_FORMAT_JSON_TEXT, src_file, OLIB_FORMAT_YAML, dst_file));
+  fclose(src_file);
+  fclose(dst_file);
+  ASSERT_TRUE(olib_trace_capture_stop());
+
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  std::vector<olib_trace_record_t> records = load_records(trace);
+  ASSERT_EQ(records.size(), 2u);
+  for (const olib_trace_record_t& record : records) {
+    EXPECT_EQ(record.op, OLIB_TRACE_CONVERT);
+    EXPECT_EQ(record.src_format, OLIB_FORMAT_JSON_TEXT);
+    EXPECT_EQ(record.dst_format, OLIB_FORMAT_YAML);
+    EXPECT_EQ(record.size, src_size);
+  }
+  olib_object_t* converted = olib_format_read_file_path(OLIB_FORMAT_YAML, dst_path.c_str());
+  verify_test_object(converted);
+  olib_object_free(converted);
+
+  olib_trace_free(trace);
+  olib_object_free(obj);
+  std::filesystem::remove(path);
+  std::filesystem::remove(src_path);
+  std::filesystem::remove(dst_path);
+}
+
+TEST(TraceCapture, MaxBytesEndsTheCapture) {
+  std::string path = trace_path("olib_trace_limit.oltr");
+  olib_object_t* obj = create_test_object();
+  olib_trace_capture_config_t config = {};
+  config.max_bytes = 512;
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), &config));
+  for (int i = 0; i < 20; i++) {
+    char* json = nullptr;
+    ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &json));
+    olib_free(json);
+  }
+  uint64_t count = olib_trace_capture_count();
+  ASSERT_TRUE(olib_trace_capture_stop());
+  EXPECT_GT(count, 0u);
+  EXPECT_LT(count, 20u);
+  EXPECT_LE(std::filesystem::file_size(path), 512u);
+
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  EXPECT_EQ(olib_trace_size(trace), count);
+  olib_trace_free(trace);
+  olib_object_free(obj);
+  std::filesystem::remove(path);
+}
+
+// =============================================================================
+// Loading and Replay
+// =============================================================================
+
+TEST(TraceLoad, RejectsGarbageAndKeepsCompleteRecords) {
+  std::string path = trace_path("olib_trace_load.oltr");
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "not a trace";
+  }
+  EXPECT_EQ(olib_trace_load(path.c_str()), nullptr);
+  EXPECT_EQ(olib_trace_load(nullptr), nullptr);
+
+  olib_object_t* obj = create_test_object();
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), nullptr));
+  for (int i = 0; i < 3; i++) {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(olib_format_write(OLIB_FORMAT_BINARY, obj, &data, &size));
+    olib_free(data);
+  }
+  ASSERT_TRUE(olib_trace_capture_stop());
+
+  // A capture cut off mid-record keeps the records before it
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  EXPECT_EQ(olib_trace_size(trace), 2u);
+  olib_trace_record_t record;
+  EXPECT_FALSE(olib_trace_get(trace, 2, &record));
+  olib_trace_free(trace);
+  olib_object_free(obj);
+  std::filesystem::remove(path);
+}
+
+TEST(TraceReplay, ReplaysEveryRecordOnEachThread) {
+  std::string path = trace_path("olib_trace_replay.oltr");
+  olib_object_t* obj = create_test_object();
+  ASSERT_TRUE(olib_trace_capture_start(path.c_str(), nullptr));
+  char* json = nullptr;
+  ASSERT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &json));
+  olib_object_free(olib_format_read_string(OLIB_FORMAT_JSON_TEXT, json));
+  char* yaml = nullptr;
+  ASSERT_TRUE(olib_convert_string(OLIB_FORMAT_JSON_TEXT, json, OLIB_FORMAT_YAML, &yaml));
+  olib_object_free(olib_format_read_string(OLIB_FORMAT_XML, "<broken"));
+  ASSERT_TRUE(olib_trace_capture_stop());
+  olib_free(yaml);
+  olib_free(json);
+
+  olib_trace_t* trace = olib_trace_load(path.c_str());
+  ASSERT_NE(trace, nullptr);
+  ASSERT_EQ(olib_trace_size(trace), 4u);
+
+  olib_trace_replay_config_t config = {3, 2};
+  olib_trace_replay_result_t result;
+  ASSERT_TRUE(olib_trace_replay(trace, &config, &result));
+  EXPECT_EQ(result.ops, 24u);
+  EXPECT_EQ(result.failures, 6u);  // The broken XML fails on every pass
+  EXPECT_EQ(result.ops_by_kind[OLIB_TRACE_READ], 12u);
+  EXPECT_EQ(result.ops_by_kind[OLIB_TRACE_WRITE], 6u);
+  EXPECT_EQ(result.ops_by_kind[OLIB_TRACE_CONVERT], 6u);
+  EXPECT_GT(result.bytes, 0u);
+  EXPECT_GT(result.ops_per_sec, 0.0);
+  EXPECT_LE(result.p50_ns, result.p90_ns);
+  EXPECT_LE(result.p90_ns, result.p99_ns);
+  EXPECT_LE(result.p99_ns, result.p999_ns);
+  EXPECT_LE(result.p999_ns, result.max_ns);
+
+  ASSERT_TRUE(olib_trace_replay(trace, nullptr, &result));
+  EXPECT_EQ(result.ops, 4u);
+
+  olib_trace_free(trace);
+  olib_object_free(obj);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,294 @@
+#include "test_utils.h"
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Helper Functions
+// =============================================================================
+
+static std::string to_json(olib_object_t* obj) {
+  char* str = nullptr;
+  EXPECT_TRUE(olib_format_write_string(OLIB_FORMAT_JSON_TEXT, obj, &str));
+  std::string result = str ? str : "";
+  olib_free(str);
+  return result;
+}
+
+static olib_object_t* new_int(int64_t value) {
+  olib_object_t* obj = olib_object_new(OLIB_OBJECT_TYPE_INT);
+  olib_object_set_int(obj, value);
+  return obj;
+}
+
+// A multi-step update touching every kind of mutation
+static void apply_update(olib_object_t* root) {
+  olib_object_set_int(olib_object_struct_get(root, "int_val"), 1);
+  olib_object_set_uint(olib_object_struct_get(root, "uint_val"), 2);
+  olib_object_set_float(olib_object_struct_get(root, "float_val"), 3.5);
+  olib_object_set_string(olib_object_struct_get(root, "string_val"), "a much longer replacement string");
+  olib_object_set_string(olib_object_struct_get(root, "string_val"), nullptr);
+  olib_object_set_bool(olib_object_struct_get(root, "bool_val"), false);
+
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  olib_object_list_push(list, new_int(300));
+  olib_object_list_insert(list, 0, new_int(-100));
+  olib_object_list_set(list, 2, new_int(111));
+  olib_object_list_remove(list, 1);
+  olib_object_list_pop(list);
+
+  // A node added, changed and removed again within the update
+  olib_object_t* extra = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_struct_add(root, "extra", extra);
+  olib_object_struct_add(extra, "count", new_int(0));
+  olib_object_set_int(olib_object_struct_get(extra, "count"), 5);
+  olib_object_struct_remove(root, "extra");
+
+  olib_object_t* nested = olib_object_struct_get(root, "nested");
+  olib_object_set_int(olib_object_struct_get(nested, "nested_int"), 0);
+  olib_object_struct_set(nested, "nested_int", new_int(7));
+  olib_object_struct_set(nested, "added", new_int(8));
+  olib_object_struct_remove(root, "uint_val");
+  olib_object_struct_set(root, "list_val", olib_object_new(OLIB_OBJECT_TYPE_LIST));
+}
+
+// =============================================================================
+// Commit and Rollback
+// =============================================================================
+
+TEST(Txn, RollbackRestoresTree) {
+  olib_object_t* root = create_test_object();
+  std::string before = to_json(root);
+  olib_object_t* nested = olib_object_struct_get(root, "nested");
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  olib_observer_t* observer = olib_observer_new(root);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+  apply_update(root);
+  EXPECT_NE(to_json(root), before);
+  EXPECT_EQ(olib_txn_undo_count(txn), 20u);
+  olib_txn_rollback(txn);
+
+  EXPECT_EQ(to_json(root), before);
+  verify_test_object(root);
+  // The original nodes are back in place, not copies of them
+  EXPECT_EQ(olib_object_struct_get(root, "nested"), nested);
+  EXPECT_EQ(olib_object_struct_get(root, "list_val"), list);
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Txn, CommitKeepsChanges) {
+  olib_object_t* root = create_test_object();
+  olib_object_t* expected = create_test_object();
+  apply_update(expected);
+  olib_observer_t* observer = olib_observer_new(root);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+  apply_update(root);
+  olib_txn_commit(txn);
+  EXPECT_EQ(to_json(root), to_json(expected));
+
+  // The tree is released, so a new transaction can start and split works again
+  txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+  olib_txn_commit(txn);
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  olib_object_list_push(list, new_int(1));
+  olib_object_t* tail = olib_object_list_split(list, 0);
+  ASSERT_NE(tail, nullptr);
+
+  olib_object_free(tail);
+  olib_object_free(expected);
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Txn, Restrictions) {
+  olib_object_t* root = create_test_object();
+  olib_object_t* other = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(other, new_int(1));
+
+  // The tree needs an observer
+  EXPECT_EQ(olib_txn_begin(root), nullptr);
+  olib_observer_t* observer = olib_observer_new(root);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+  EXPECT_EQ(olib_txn_begin(root), nullptr);
+  EXPECT_EQ(olib_txn_begin(olib_object_struct_get(root, "nested")), nullptr);
+
+  olib_object_t* list = olib_object_struct_get(root, "list_val");
+  EXPECT_EQ(olib_object_list_split(list, 1), nullptr);
+  EXPECT_FALSE(olib_object_list_concat(list, other));
+  EXPECT_FALSE(olib_object_list_concat(other, list));
+  EXPECT_EQ(olib_object_list_size(list), 3u);
+  EXPECT_EQ(olib_txn_undo_count(txn), 0u);
+
+  olib_txn_rollback(txn);
+  verify_test_object(root);
+  olib_object_free(other);
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+TEST(Txn, NodesOutsideTheTree) {
+  olib_object_t* root = create_test_object();
+  olib_object_t* other = create_test_object();
+  olib_object_t* early = new_int(1);
+  olib_observer_t* observer = olib_observer_new(root);
+  std::string before = to_json(root);
+  std::string other_before = to_json(other);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+
+  // Built before the transaction and added during it, only the insertion is logged
+  olib_object_set_int(early, 2);
+  olib_object_struct_add(root, "early", early);
+  olib_object_set_int(early, 3);
+
+  // Temporaries and other trees are not logged
+  olib_object_t* temp = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  olib_object_list_push(temp, new_int(3));
+  olib_object_free(temp);
+  olib_object_set_int(olib_object_struct_get(other, "int_val"), 4);
+  EXPECT_EQ(olib_txn_undo_count(txn), 2u);
+
+  olib_txn_rollback(txn);
+  EXPECT_EQ(to_json(root), before);
+  EXPECT_NE(to_json(other), other_before);
+  olib_observer_free(observer);
+  olib_object_free(other);
+  olib_object_free(root);
+}
+
+TEST(Txn, ParallelDupeInsideTransaction) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* items = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 64; i++) {
+    olib_object_list_push(items, create_test_object());
+  }
+  olib_object_struct_add(root, "items", items);
+  olib_observer_t* observer = olib_observer_new(root);
+  std::string before = to_json(root);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  ASSERT_NE(txn, nullptr);
+  // Nodes freed during the transaction leave addresses the copy's nodes may reuse
+  olib_object_struct_remove(olib_object_list_get(items, 0), "nested");
+  olib_object_list_set(items, 1, new_int(1));
+  olib_object_t* temp = create_test_object();
+  olib_object_free(temp);
+  size_t logged = olib_txn_undo_count(txn);
+
+  // The copy is built on the worker threads and is not part of the tree
+  const olib_parallel_config_t config = {4, 8};
+  olib_object_t* copy = olib_object_dupe_parallel(items, &config);
+  ASSERT_NE(copy, nullptr);
+  for (size_t i = 2; i < olib_object_list_size(copy); i++) {
+    olib_object_t* item = olib_object_list_get(copy, i);
+    olib_object_set_int(olib_object_struct_get(item, "int_val"), (int64_t)i);
+    olib_object_struct_remove(item, "nested");
+  }
+  EXPECT_EQ(olib_txn_undo_count(txn), logged);
+
+  olib_txn_rollback(txn);
+  EXPECT_EQ(to_json(root), before);
+  ASSERT_EQ(olib_object_list_size(copy), 64u);
+  EXPECT_EQ(olib_object_get_int(olib_object_struct_get(olib_object_list_get(copy, 63), "int_val")), 63);
+  EXPECT_EQ(olib_object_struct_get(olib_object_list_get(copy, 63), "nested"), nullptr);
+  EXPECT_EQ(olib_object_struct_get(olib_object_list_get(copy, 0), "nested"), nullptr);
+
+  olib_object_free(copy);
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+// =============================================================================
+// Cost
+// =============================================================================
+
+static size_t g_allocs;
+
+static void* count_malloc(size_t size) {
+  g_allocs++;
+  return malloc(size);
+}
+
+static void* count_calloc(size_t num, size_t size) {
+  g_allocs++;
+  return calloc(num, size);
+}
+
+static void* count_realloc(void* ptr, size_t size) {
+  g_allocs++;
+  return realloc(ptr, size);
+}
+
+TEST(Txn, CostFollowsTheEdit) {
+  olib_object_t* root = olib_object_new(OLIB_OBJECT_TYPE_STRUCT);
+  olib_object_t* items = olib_object_new(OLIB_OBJECT_TYPE_LIST);
+  for (int i = 0; i < 10000; i++) {
+    olib_object_t* item = create_test_object();
+    olib_object_list_push(items, item);
+  }
+  olib_object_struct_add(root, "items", items);
+  // The transaction uses the observer's marking of the tree
+  olib_observer_t* observer = olib_observer_new(root);
+
+  g_allocs = 0;
+  olib_set_memory_fns(count_malloc, free, count_calloc, count_realloc);
+  olib_txn_t* txn = olib_txn_begin(root);
+  olib_object_set_int(olib_object_struct_get(olib_object_list_get(items, 5000), "int_val"), 1);
+  olib_object_list_remove(items, 9999);
+  olib_object_struct_remove(olib_object_list_get(items, 0), "nested");
+  EXPECT_EQ(olib_txn_undo_count(txn), 3u);
+  olib_txn_rollback(txn);
+  olib_set_memory_fns(malloc, free, calloc, realloc);
+
+  // The transaction, its log and nothing per node of the tree
+  EXPECT_LE(g_allocs, 4u);
+  EXPECT_EQ(olib_object_list_size(items), 10000u);
+  verify_test_object(olib_object_list_get(items, 0));
+  verify_test_object(olib_object_list_get(items, 5000));
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
+
+// =============================================================================
+// Observers
+// =============================================================================
+
+static void count_batches(void* ctx, const olib_change_t* changes, size_t count) {
+  (void)changes;
+  std::vector<size_t>* batches = (std::vector<size_t>*)ctx;
+  batches->push_back(count);
+}
+
+TEST(Txn, ObserversSeeCommittedChangesOnly) {
+  olib_object_t* root = create_test_object();
+  olib_observer_t* observer = olib_observer_new(root);
+  std::vector<size_t> batches;
+  olib_observer_subscribe(observer, "", count_batches, &batches);
+
+  olib_txn_t* txn = olib_txn_begin(root);
+  apply_update(root);
+  olib_txn_rollback(txn);
+  EXPECT_TRUE(batches.empty());
+
+  txn = olib_txn_begin(root);
+  apply_update(root);
+  olib_txn_commit(txn);
+  ASSERT_EQ(batches.size(), 1u);
+  EXPECT_EQ(batches[0], 20u);
+
+  // Changes are tracked again afterwards
+  olib_object_set_int(olib_object_struct_get(root, "int_val"), 9);
+  EXPECT_EQ(batches.size(), 2u);
+
+  olib_observer_free(observer);
+  olib_object_free(root);
+}
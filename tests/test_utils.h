@@ -70,3 +70,39 @@ inline void verify_test_object(olib_object_t* obj)
     ASSERT_NE(nested, nullptr);
     EXPECT_EQ(olib_object_get_int(olib_object_struct_get(nested, "nested_int")), 999);
 }
+
+// Helper function to serialize an object in any format (text formats without the null terminator)
+inline bool write_any_format(olib_format_t format, olib_object_t* obj, uint8_t** out_data, size_t* out_size)
+{
+    olib_serializer_t* ser = olib_format_serializer(format);
+    if (!ser) return false;
+    bool ok;
+    if (olib_serializer_is_text_based(ser)) {
+        char* str = nullptr;
+        ok = olib_serializer_write_string(ser, obj, &str);
+        if (ok) {
+            *out_data = (uint8_t*)str;
+            *out_size = strlen(str);
+        }
+    } else {
+        ok = olib_serializer_write(ser, obj, out_data, out_size);
+    }
+    olib_serializer_free(ser);
+    return ok;
+}
+
+// Read data produced by write_any_format back with the matching serializer
+inline olib_object_t* read_any_format(olib_format_t format, const uint8_t* data, size_t size)
+{
+    olib_serializer_t* ser = olib_format_serializer(format);
+    if (!ser) return nullptr;
+    olib_object_t* obj;
+    if (olib_serializer_is_text_based(ser)) {
+        std::string str((const char*)data, size);
+        obj = olib_serializer_read_string(ser, str.c_str());
+    } else {
+        obj = olib_serializer_read(ser, data, size);
+    }
+    olib_serializer_free(ser);
+    return obj;
+}